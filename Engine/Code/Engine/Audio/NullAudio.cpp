@@ -0,0 +1,100 @@
+//---------------------------------------------------------------------------
+//Null AudioSystem for the Headless configuration, built instead of TheAudio.cpp so fmod never links.
+//Every call succeeds silently: sounds resolve to MISSING_SOUND_ID and channels/instances to nullptr.
+//---------------------------------------------------------------------------
+#include "Engine/Audio/TheAudio.hpp"
+
+
+//---------------------------------------------------------------------------
+AudioSystem* g_theAudio = nullptr;
+
+
+//---------------------------------------------------------------------------
+AudioSystem::AudioSystem()
+	: m_fmodSystem( nullptr )
+	, m_fmodLowLevelSystem( nullptr )
+{
+}
+
+
+//---------------------------------------------------------------------------
+AudioSystem::~AudioSystem()
+{
+}
+
+
+//---------------------------------------------------------------------------
+void AudioSystem::InitializeFMOD()
+{
+}
+
+
+//---------------------------------------------------------------------------
+SoundID AudioSystem::CreateOrGetSound( const std::string& /*soundFileName*/ )
+{
+	return MISSING_SOUND_ID;
+}
+
+
+//---------------------------------------------------------------------------
+AudioChannelHandle AudioSystem::PlaySound( SoundID /*soundID*/, float /*volumeLevel = 1.f*/, bool /*loop = false*/ )
+{
+	return nullptr;
+}
+
+
+//---------------------------------------------------------------------------
+void AudioSystem::StopChannel( AudioChannelHandle /*channel*/ )
+{
+}
+
+
+//---------------------------------------------------------------------------
+bool AudioSystem::isPlaying( AudioChannelHandle /*channel*/ )
+{
+	return false;
+}
+
+
+//---------------------------------------------------------------------------
+void AudioSystem::Update()
+{
+}
+
+
+//---------------------------------------------------------------------------
+void AudioSystem::LoadBankFile( const char* /*bankFilename*/ )
+{
+}
+
+
+//---------------------------------------------------------------------------
+FMOD::Studio::EventInstance* AudioSystem::CreateEventInstance( const char* /*eventPath*/ )
+{
+	return nullptr;
+}
+
+
+//---------------------------------------------------------------------------
+void AudioSystem::StartOrRestartEventInstance( FMOD::Studio::EventInstance* /*inst*/ )
+{
+}
+
+
+//---------------------------------------------------------------------------
+void AudioSystem::SetListenerAttributes( int /*listenerIndex*/, FMOD_3D_ATTRIBUTES* /*attribs*/ )
+{
+}
+
+
+//---------------------------------------------------------------------------
+void AudioSystem::ValidateResult( FMOD_RESULT /*result*/ )
+{
+}
+
+
+//---------------------------------------------------------------------------
+FMOD::Studio::EventInstance* AudioSystem::CreateEventInstanceAtPosition( const char* /*eventPath*/, const Vector3f& /*pos*/ )
+{
+	return nullptr;
+}
@@ -19,6 +19,9 @@
 #if defined(_WIN32) || defined(_WIN64)
 	#define PLATFORM_WINDOWS
 #endif
+#if defined(__linux__)
+	#define PLATFORM_LINUX
+#endif
 
 #ifdef PLATFORM_WINDOWS
 	#define LOGGER_OUTPUT_TO_VSDEBUGGER
@@ -45,6 +48,26 @@
 #define PROFILER_MODE					PROFILER_FULL_FRAME_SAMPLING
 //--
 
+
+//Asset Cooking
+#define XML_COOKING_ENABLED //Comment out to always parse the source XML.
+#define COOKED_XML_DIRECTORY			"Data/Cooked"
+#define TEXTURE_ATLASING_ENABLED //Comment out to draw every SpriteResource from its own Texture again.
+#define COOKED_ATLAS_DIRECTORY			"Data/Cooked/Atlases"
+//--
+
+
+//Console
+#define CONSOLE_HISTORY_MAX_LINES			32768
+#define CONSOLE_HISTORY_TEXT_ARENA_BYTES	( 4 * 1024 * 1024 ) //Only lines added within the newest half of this are kept.
+#define CONSOLE_HISTORY_TRIGRAM_POSTINGS	( 1024 * 1024 ) //8 bytes each, about 30 per typical line: lines whose postings are overwritten drop off too.
+//--
+
+
+//SIMD Math
+//#define MATH_DISABLE_SIMD //Uncomment to run Vec4 and Matrix44 on their plain float fallback, e.g. to compare against it.
+//--
+
 /* Examples of Other Settings
 	#ifdef __MSC_VER 
 		#ifdef (_WIN32)
@@ -2,6 +2,8 @@
 #include "Engine/Concurrency/Thread.hpp"
 #include "Engine/EngineCommon.hpp"
 #include "Engine/Concurrency/ConcurrencyUtils.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/RandomStream.hpp"
 #include "Engine/Time/Time.hpp"
 #include "Engine/Time/Stopwatch.hpp"
 
@@ -30,7 +32,28 @@ static void GenericJobWorkerThreadEntry( void* )
 
 
 //--------------------------------------------------------------------------------------------------------------
-STATIC void JobSystem::Startup( int numWorkerThreads )
+static void IOJobWorkerThreadEntry( void* )
+{
+	JobCategory categories[ 3 ] = { JOB_CATEGORY_IO, JOB_CATEGORY_GENERIC, JOB_CATEGORY_GENERIC_SLOW };
+	JobConsumer::CreateAndRunUntilShutdown( categories, 3 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static int ResolveNumThreads( int requestedNumThreads )
+{
+	int actualNumThreads = abs( requestedNumThreads );
+	if ( requestedNumThreads < 0 ) //Negative parameter means " # cores minus however many I specified ".
+		actualNumThreads = SystemGetCoreCount() - actualNumThreads;
+	if ( actualNumThreads <= 0 )
+		actualNumThreads = 1; //Always at least one created.
+
+	return actualNumThreads;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void JobSystem::Startup( int numWorkerThreads, int numIOWorkerThreads /*= 1*/ )
 {
 	m_isRunning = true;
 
@@ -38,29 +61,56 @@ STATIC void JobSystem::Startup( int numWorkerThreads )
 	for ( int categoryIndex = 0; categoryIndex < NUM_JOB_CATEGORIES; categoryIndex++ )
 		m_categoryQueues[ categoryIndex ] = new JobQueue();
 
-	//Spin up threads.
-	int actualNumWorkerThreads = abs( numWorkerThreads );
-	if ( numWorkerThreads < 0 ) //Negative parameter means " # cores minus however many I specified ".
-		actualNumWorkerThreads = SystemGetCoreCount() - actualNumWorkerThreads;
-	if ( actualNumWorkerThreads <= 0 )
-		actualNumWorkerThreads = 1; //Always at least one created.
+	//Initialize job pool before any thread can release into it.
+	m_jobPool.Init( MAX_NUM_JOBS );
 
-	for ( int threadIndex = 0; threadIndex < actualNumWorkerThreads; threadIndex++ )
+	//Spin up threads. IO workers are part of the total, not on top of it, so the two never oversubscribe the cores between them.
+	int actualNumWorkerThreads = ResolveNumThreads( numWorkerThreads );
+	m_numIOWorkerThreads = GetMin( ResolveNumThreads( numIOWorkerThreads ), actualNumWorkerThreads );
+	for ( int threadIndex = m_numIOWorkerThreads; threadIndex < actualNumWorkerThreads; threadIndex++ )
 		m_threads.push_back( new Thread( GenericJobWorkerThreadEntry ) );
 
-	//Initialize job pool.
-	m_jobPool.Init( MAX_NUM_JOBS );
+	for ( int threadIndex = 0; threadIndex < m_numIOWorkerThreads; threadIndex++ )
+		m_threads.push_back( new Thread( IOJobWorkerThreadEntry ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void JobSystem::Shutdown()
+{
+	m_isRunning = false;
+	SignalWork(); //Else workers asleep in WaitForWork never see it.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void RunJobCallback( Job* job )
+{
+	//Seeded per job rather than per thread, so its draws are the same whichever worker runs it, or the order workers first drew in.
+	RandomStream& threadStream = RandomStream::GetThreadLocal();
+	RandomStream callerStream = threadStream; //Waiting threads help run jobs, so theirs has to pick back up where it was after.
+	threadStream.Seed( RandomStream::GetSeedForWorkItem( job->randomWorkItemIndex ) );
+
+	job->jobCallback( job );
+
+	threadStream = callerStream;
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 Job* JobSystem::CreateJob( JobCategory jobType, JobCallback* jobFunc )
 {
-	Job* newJob = m_jobPool.Allocate();
+	Job* newJob = m_jobPool.TryAllocate();
+	bool isPooled = ( newJob != nullptr );
+	if ( !isPooled ) //Rather than die mid-frame, hand back a one-off the caller's thread will run itself.
+		newJob = new Job();
+
+	newJob->isPooled = isPooled;
+	newJob->randomWorkItemIndex = RandomStream::GetNextWorkItemIndex(); //Jobs made by jobs are numbered in whatever order they raced in.
 	newJob->refCount = 0;
 	newJob->jobType = jobType;
 	newJob->jobCallback = jobFunc;
-	newJob->jobData.Initialize( malloc( JOB_DATA_BUFFER_SIZE ), JOB_DATA_BUFFER_SIZE );
+	newJob->jobData.Initialize( newJob->jobDataStorage, Job::JOB_DATA_BUFFER_SIZE );
 
 	AcquireJob( newJob );
 
@@ -79,7 +129,15 @@ void JobSystem::DetachJob( Job* job )
 void JobSystem::DispatchJob( Job* job )
 {
 	AcquireJob( job );
+	if ( !job->isPooled ) //Done by the time this returns, so the Detach or Wait that follows just releases it.
+	{
+		RunJobCallback( job );
+		ReleaseJob( job );
+		return;
+	}
+
 	m_categoryQueues[ job->jobType ]->Enqueue( job );
+	SignalWork();
 }
 
 
@@ -93,19 +151,47 @@ void JobSystem::WaitOnJobsForCompletion( const std::vector<Job*>& jobs )
 //--------------------------------------------------------------------------------------------------------------
 void JobSystem::WaitOnJobForCompletion( Job* job )
 {
-	JobConsumer* interimConsumer;
 	JobCategory interimConsumerCategories[] = { JOB_CATEGORY_GENERIC };
-	interimConsumer = JobConsumer::Create( interimConsumerCategories, 1 );
+	JobConsumer interimConsumer( interimConsumerCategories, 1 );
 
-	while ( job->refCount >= JOB_REFCOUNT_CREATED_AND_DISPATCHED ) //Until complete (refCount of 1), run interim jobs.
-		JobConsumer::RunOneJob( interimConsumer );
-
-	delete interimConsumer;
+	while ( job->refCount >= JOB_REFCOUNT_CREATED_AND_DISPATCHED ) //Until complete (refCount of 1), run interim jobs, else sleep until something changes.
+	{
+		if ( !interimConsumer.TryConsumingOneJob() )
+			WaitForWork( interimConsumer, job );
+	}
 
 	ReleaseJob( job );
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void JobSystem::WaitForWork( const JobConsumer& consumer, const Job* jobToAwait /*= nullptr*/ )
+{
+	std::unique_lock< std::mutex > lock( m_signalMutex );
+	for ( ;; )
+	{
+		//Rechecked under the lock SignalWork takes, so a dispatch or completion between the check and the wait can't be missed.
+		if ( !m_isRunning || consumer.HasQueuedJobs() )
+			return;
+
+		if ( ( jobToAwait != nullptr ) && ( jobToAwait->refCount < JOB_REFCOUNT_CREATED_AND_DISPATCHED ) )
+			return;
+
+		m_signal.wait( lock );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void JobSystem::SignalWork()
+{
+	{
+		std::lock_guard< std::mutex > lock( m_signalMutex );
+	}
+	m_signal.notify_all();
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 void JobSystem::AcquireJob( Job* job )
 {
@@ -116,9 +202,13 @@ void JobSystem::AcquireJob( Job* job )
 //--------------------------------------------------------------------------------------------------------------
 void JobSystem::ReleaseJob( Job* job )
 {
-	--job->refCount; 
-	if ( job->refCount == JOB_REFCOUNT_UNREFERENCED )
+	if ( --job->refCount != JOB_REFCOUNT_UNREFERENCED ) //Atomic, since a DetachJob can race the worker's release.
+		return;
+
+	if ( job->isPooled )
 		m_jobPool.Delete( job );
+	else
+		delete job;
 }
 
 
@@ -126,19 +216,38 @@ void JobSystem::ReleaseJob( Job* job )
 STATIC void JobConsumer::CreateAndRunUntilShutdown( JobCategory orderedFilterCategories[], size_t numCategories )
 {
 	JobConsumer* consumer = JobConsumer::Create( orderedFilterCategories, numCategories );
-	JobConsumer::RunJobsUntilShutdown( consumer ); //Cleanup handled internally.
+	JobConsumer::RunJobsUntilShutdown( consumer );
+	delete consumer;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+JobConsumer::JobConsumer( JobCategory orderedFilterCategories[], size_t numCategories )
+	: m_numQueues( 0 )
+{
+	ASSERT_OR_DIE( numCategories <= NUM_JOB_CATEGORIES, "JobConsumer given more categories than exist!" );
+	for ( size_t index = 0; index < numCategories; index++ )
+		m_queues[ m_numQueues++ ] = JobSystem::Instance()->GetJobQueueForCategory( orderedFilterCategories[ index ] );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 STATIC JobConsumer* JobConsumer::Create( JobCategory orderedFilterCategories[], size_t numCategories )
 {
-	JobConsumer* consumer = new JobConsumer();
+	return new JobConsumer( orderedFilterCategories, numCategories );
+}
 
-	for ( size_t index = 0; index < numCategories; index++ )
-		consumer->m_queues.push_back( JobSystem::Instance()->GetJobQueueForCategory( orderedFilterCategories[ index ] ) );
 
-	return consumer;
+//--------------------------------------------------------------------------------------------------------------
+bool JobConsumer::HasQueuedJobs() const
+{
+	for ( size_t queueIndex = 0; queueIndex < m_numQueues; queueIndex++ )
+	{
+		if ( !m_queues[ queueIndex ]->IsEmpty() )
+			return true;
+	}
+
+	return false;
 }
 
 
@@ -146,9 +255,9 @@ STATIC JobConsumer* JobConsumer::Create( JobCategory orderedFilterCategories[],
 bool JobConsumer::TryConsumingOneJob()
 {
 	Job* job;
-	for each ( JobQueue* jobQueue in m_queues ) //Enforces an alternating order of job category access.
+	for ( size_t queueIndex = 0; queueIndex < m_numQueues; queueIndex++ ) //Enforces an alternating order of job category access.
 	{
-		if ( jobQueue->Dequeue( &job ) )
+		if ( m_queues[ queueIndex ]->Dequeue( &job ) )
 		{
 			ProcessJob( job ); //Runs the job--i.e. its callback--and release job when done--calling whatever callback is set for when the job has finished.
 			return true;
@@ -164,7 +273,7 @@ STATIC void JobConsumer::RunJobsUntilShutdown( JobConsumer* consumer )
 	while ( JobSystem::Instance()->IsRunning() )
 	{
 		consumer->TryConsumingAllJobs();
-		Thread::ThreadSleep( std::chrono::milliseconds( 100 ) );
+		JobSystem::Instance()->WaitForWork( *consumer );
 	}
 	consumer->TryConsumingAllJobs(); //Re-runs the above loop one last time, in case we were told to stop while messages are still queued.
 }
@@ -201,7 +310,7 @@ STATIC void JobConsumer::RunOneJob( JobConsumer* consumer )
 	if ( JobSystem::Instance()->IsRunning() )
 	{
 		if ( !consumer->TryConsumingOneJob() )
-			Thread::ThreadSleep( std::chrono::milliseconds( 100 ) );
+			JobSystem::Instance()->WaitForWork( *consumer );
 	}
 }
 
@@ -209,8 +318,9 @@ STATIC void JobConsumer::RunOneJob( JobConsumer* consumer )
 //--------------------------------------------------------------------------------------------------------------
 void JobConsumer::ProcessJob( Job* job )
 {
-	job->jobCallback( job ); 
+	RunJobCallback( job ); 
 	JobSystem::Instance()->ReleaseJob( job );
+	JobSystem::Instance()->SignalWork(); //Wakes any WaitOnJobForCompletion on this job.
 
 	//May want to have a second callback set for when the job has finished.
 }
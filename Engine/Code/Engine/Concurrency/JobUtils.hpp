@@ -4,8 +4,12 @@
 #include "Engine/Memory/ObjectPool.hpp"
 #include "Engine/Memory/CBuffer.hpp"
 #include "Engine/Concurrency/ThreadSafeQueue.hpp"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 struct Job;
 class Thread;
+class JobConsumer;
 typedef ThreadSafeQueue<Job*> JobQueue;
 typedef void( JobCallback )( Job* job );
 
@@ -24,7 +28,7 @@ enum JobCategory //"Where" the job should run, e.g. don't want rendering GENERIC
 {
 	JOB_CATEGORY_GENERIC = 0,
 	JOB_CATEGORY_GENERIC_SLOW, //May take multiple frames to complete.
-//	JOB_CATEGORY_IO,
+	JOB_CATEGORY_IO, //File reads and decodes, only run by the dedicated IO threads so they never hold up gameplay jobs.
 //	JOB_CATEGORY_RENDERING,
 	NUM_JOB_CATEGORIES
 };
@@ -36,11 +40,14 @@ struct Job //The benefit of a job system over just spawning a thread per job: CR
 {
 	//Important: jobs need to remain the same size for the JobSystem::m_jobPool object pool allocator.
 	JobCategory jobType;
-	int refCount; //Start at 2. Releases one from the thread that completes its work, and the other either immediately from DetachJob or on completion in WaitOnJob.
+	bool isPooled; //False for the rare job made after the pool ran dry, which DispatchJob runs inline instead.
+	unsigned int randomWorkItemIndex; //Seeds the running thread's RandomStream for this job, see RandomStream::GetSeedForWorkItem.
+	std::atomic<int> refCount; //Start at 2. Releases one from the thread that completes its work, and the other either immediately from DetachJob or on completion in WaitOnJob.
 
 	JobCallback* jobCallback; //Note: best to send jobs for anything that can be thought of as an array of elements updated independently, e.g. particle list.
 	CBuffer jobData;
 	static const size_t JOB_DATA_BUFFER_SIZE = 128;
+	byte_t jobDataStorage[ JOB_DATA_BUFFER_SIZE ]; //What jobData writes into, so creating a job never hits the heap.
 
 	template < typename T > T Write( const T& data ) 
 	{ 
@@ -58,10 +65,13 @@ class JobSystem
 public:
 	static JobSystem* Instance();
 
-	void Startup( int numWorkerThreads ); //e.g. -2 workers for "as many as possible, minus two".
-		//This is a polling job system, as opposed to a workload-balancing job system which would likely be slower.
+	void Startup( int numWorkerThreads, int numIOWorkerThreads = 1 ); //e.g. -2 workers for "as many as possible, minus two".
+		//Idle workers block on a condition variable until a job is dispatched, rather than polling.
+		//IO workers come out of numWorkerThreads, count negatives the same way, and take JOB_CATEGORY_IO first.
+		//With none queued they fall back to generic jobs, so once startup's decodes finish no core sits idle.
 	bool IsRunning() const { return m_isRunning; }
-	void Shutdown() { m_isRunning = false; } //Stops all threads, letting remaining jobs empty out like for Logger.
+	int GetNumIOWorkerThreads() const { return m_numIOWorkerThreads; }
+	void Shutdown(); //Stops all threads, letting remaining jobs empty out like for Logger.
 
 	Job* CreateJob( JobCategory jobType, JobCallback* jobFunc );
 	void DispatchJob( Job* job ); //AKA "QueueJobToBeRunByJobConsumer". After this, call either DetachJob or WaitOnJob(s).
@@ -74,17 +84,23 @@ public:
 
 	void ReleaseJob( Job* job ); //Else JobConsumer can't get at it.
 
+	//For JobConsumer: sleeps until one of its queues has a job, jobToAwait completes, or Shutdown.
+	void WaitForWork( const JobConsumer& consumer, const Job* jobToAwait = nullptr );
+	void SignalWork(); //Wakes every WaitForWork to recheck, after a dispatch or a completion.
+
 private:
 	void AcquireJob( Job* job );
 
-	bool m_isRunning;
+	std::atomic<bool> m_isRunning;
+	std::mutex m_signalMutex;
+	std::condition_variable m_signal;
 	static JobSystem* s_theJobSystem;
 	JobQueue* m_categoryQueues[ NUM_JOB_CATEGORIES ];
 	std::vector< Thread* > m_threads; //Does it need to be thread-safe?
+	int m_numIOWorkerThreads;
 	ObjectPool<Job> m_jobPool;
 
-	static const int MAX_NUM_JOBS							= 100;
-	static const int JOB_DATA_BUFFER_SIZE					= 128; //In bytes.
+	static const int MAX_NUM_JOBS							= 1024; //Per-frame users (sprite recording, entity updates, dynamics, cloth) can have a few hundred in flight.
 	static const int JOB_REFCOUNT_UNREFERENCED				= 0;
 	static const int JOB_REFCOUNT_CREATED					= 1;
 	static const int JOB_REFCOUNT_DISPATCHED				= 1;
@@ -96,14 +112,18 @@ private:
 class JobConsumer //These are NOT shared, make one per thread. Jobs are created/detached by game code apart through JobSystem, game shouldn't see JobConsumer underneath.
 	//If the category queues are checkout lanes, these are the staff manning them. ONLY JobConsumers can pull jobs off queues, a thread makes a local one in JobSystem::Startup().
 {
+	friend class JobSystem; //WaitOnJobForCompletion consumes through a stack-local one.
+
 public:
+	JobConsumer( JobCategory orderedFilterCategories[], size_t numCategories );
 	static void CreateAndRunUntilShutdown( JobCategory orderedFilterCategories[], size_t numCategories ); //Prefer this unless you need special exit handling (see WaitForJob).
 	static JobConsumer* Create( JobCategory orderedFilterCategories[], size_t numCategories );
 
 	//These run-prefixed functions differ from try-prefixed because they check JobSystem::IsRunning.
 	static void RunJobsUntilShutdown( JobConsumer* consumer );
 	static void RunJobsForMilliseconds( JobConsumer* consumer, float ms );
-	static void RunOneJob( JobConsumer* consumer );
+	static void RunOneJob( JobConsumer* consumer ); //Waits for one to be dispatched if none are queued.
+	bool HasQueuedJobs() const;
 
 
 private:
@@ -111,6 +131,7 @@ private:
 	void TryConsumingAllJobs() { while ( TryConsumingOneJob() ); } //Spins until Consume() returns false, then ThreadYield() is hit in Create().
 	bool TryConsumingOneJob();
 
-	std::vector< JobQueue* > m_queues; //ONLY the ones sent in by the ctor, and the order these are checked == its consumer order in ctor.
+	JobQueue* m_queues[ NUM_JOB_CATEGORIES ]; //ONLY the ones sent in by the ctor, and the order these are checked == its consumer order in ctor.
 		//These consumers use the SAME queue, and it is thread-safe, so multiple consumers can just grab off the top.
+	size_t m_numQueues;
 };
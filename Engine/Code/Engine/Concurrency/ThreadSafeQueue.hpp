@@ -38,6 +38,14 @@ public:
 		}
 		criticalSection.Unlock();
 
+		return result;
+	}
+	bool IsEmpty()
+	{
+		criticalSection.Lock();
+		bool result = this->empty();
+		criticalSection.Unlock();
+
 		return result;
 	}
 };
\ No newline at end of file
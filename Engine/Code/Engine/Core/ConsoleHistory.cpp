@@ -0,0 +1,470 @@
+#include "Engine/Core/ConsoleHistory.hpp"
+
+
+#include "Engine/EngineCommon.hpp"
+#include "Engine/Core/Command.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Memory/Memory.hpp"
+#include "Engine/Time/Time.hpp"
+#include <string.h>
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const unsigned int INTERN_PROBE_LENGTH = 4; //The intern table is only a cache: past this, a line just gets its own copy.
+static const size_t MAX_HISTORY_LINE_LENGTH = 0xFFFF; //Longer lines are cut, as are any longer than half the arena.
+static const int DEFAULT_CONSOLE_HISTORY_TEST_LINES = 10000000;
+static const int NUM_FULL_CONSOLE_HISTORY_TEST_CHECKPOINTS = 10;
+static const unsigned int TRIGRAM_BUCKET_BITS = 14;
+static const unsigned int NUM_TRIGRAM_BUCKETS = 1 << TRIGRAM_BUCKET_BITS;
+static const size_t TRIGRAM_LENGTH = 3;
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline unsigned char GetAsLowercaseAscii( char ch )
+{
+	unsigned char uch = static_cast<unsigned char>( ch );
+	return ( uch >= 'A' && uch <= 'Z' ) ? static_cast<unsigned char>( uch + ( 'a' - 'A' ) ) : uch;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static uint32_t HashText( const char* text, size_t textLength )
+{
+	uint32_t hash = 2166136261u; //FNV-1a.
+	for ( size_t charIndex = 0; charIndex < textLength; charIndex++ )
+	{
+		hash ^= static_cast<unsigned char>( text[ charIndex ] );
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline uint16_t GetTrigramBucket( const char* trigramStart )
+{
+	uint32_t trigram = GetAsLowercaseAscii( trigramStart[ 0 ] ) | ( GetAsLowercaseAscii( trigramStart[ 1 ] ) << 8 ) | ( GetAsLowercaseAscii( trigramStart[ 2 ] ) << 16 );
+	return static_cast<uint16_t>( ( trigram * 2654435761u ) >> ( 32 - TRIGRAM_BUCKET_BITS ) ); //Knuth's multiplicative hash, top bits.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool ContainsIgnoringCase( const char* text, size_t textLength, const char* term, size_t termLength )
+{
+	if ( termLength == 0 )
+		return true;
+	if ( termLength > textLength )
+		return false;
+
+	const unsigned char firstTermChar = GetAsLowercaseAscii( term[ 0 ] );
+	for ( size_t startIndex = 0; startIndex + termLength <= textLength; startIndex++ )
+	{
+		if ( GetAsLowercaseAscii( text[ startIndex ] ) != firstTermChar )
+			continue;
+
+		size_t matchLength = 1;
+		while ( ( matchLength < termLength ) && ( GetAsLowercaseAscii( text[ startIndex + matchLength ] ) == GetAsLowercaseAscii( term[ matchLength ] ) ) )
+			++matchLength;
+		if ( matchLength == termLength )
+			return true;
+	}
+	return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+ConsoleHistory::ConsoleHistory( unsigned int maxLines, unsigned int textArenaBytes, unsigned int maxTrigramPostings )
+	: m_maxLines( ( maxLines > 0 ) ? maxLines : 1 )
+	, m_oldestLineSlot( 0 )
+	, m_numLines( 0 )
+	, m_nextLineNumber( 1 )
+	, m_textArenaSize( 1024 )
+	, m_textArenaHead( 0 )
+	, m_internTableSize( 1 )
+	, m_numInternedLines( 0 )
+	, m_postingRingSize( 1024 )
+	, m_postingHead( 0 )
+{
+	while ( m_textArenaSize < textArenaBytes )
+		m_textArenaSize <<= 1;
+	while ( m_internTableSize < m_maxLines )
+		m_internTableSize <<= 1;
+	while ( m_postingRingSize < maxTrigramPostings )
+		m_postingRingSize <<= 1;
+
+	m_lines = new HistoryLine[ m_maxLines ];
+	m_textArena = new char[ static_cast<size_t>( m_textArenaSize ) ];
+	m_internTable = new InternEntry[ m_internTableSize ];
+	memset( m_internTable, 0, sizeof( InternEntry ) * m_internTableSize );
+
+	m_postings = new TrigramPosting[ static_cast<size_t>( m_postingRingSize ) ];
+	m_postingBuckets = new uint16_t[ static_cast<size_t>( m_postingRingSize ) ];
+	m_bucketHeads = new uint64_t[ NUM_TRIGRAM_BUCKETS ];
+	m_bucketNumPostings = new uint32_t[ NUM_TRIGRAM_BUCKETS ];
+	memset( m_bucketHeads, 0, sizeof( uint64_t ) * NUM_TRIGRAM_BUCKETS );
+	memset( m_bucketNumPostings, 0, sizeof( uint32_t ) * NUM_TRIGRAM_BUCKETS );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+ConsoleHistory::~ConsoleHistory()
+{
+	delete[] m_lines;
+	delete[] m_textArena;
+	delete[] m_internTable;
+	delete[] m_postings;
+	delete[] m_postingBuckets;
+	delete[] m_bucketHeads;
+	delete[] m_bucketNumPostings;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ConsoleHistory::AddLine( const char* text, const Rgba& color )
+{
+	size_t textLength = strlen( text );
+	const size_t maxTextLength = static_cast<size_t>( m_textArenaSize / 2 ) - 1;
+	const size_t maxIndexedLength = static_cast<size_t>( m_postingRingSize / 2 ); //So a line never overwrites its own postings.
+	if ( textLength > MAX_HISTORY_LINE_LENGTH )
+		textLength = MAX_HISTORY_LINE_LENGTH;
+	if ( textLength > maxTextLength )
+		textLength = maxTextLength;
+	if ( textLength > maxIndexedLength )
+		textLength = maxIndexedLength;
+
+	uint64_t textPosition = FindOrAddText( text, static_cast<uint16_t>( textLength ) );
+	uint64_t firstPostingPosition = m_postingHead;
+	AddTrigramPostings( text, textLength, m_nextLineNumber );
+
+	//Lines older than half an arena may share text that's about to be written over: see the class comment.
+	//Likewise a line whose first posting was just overwritten is no longer fully indexed.
+	while ( ( m_numLines > 0 ) && ( ( GetLine( 0 ).arenaHeadWhenAdded + ( m_textArenaSize / 2 ) < m_textArenaHead ) ||
+									!IsPostingLive( GetLine( 0 ).firstPostingPosition ) ) )
+		RemoveOldestLine();
+	if ( m_numLines == m_maxLines )
+		RemoveOldestLine();
+
+	unsigned int slot = ( m_oldestLineSlot + m_numLines ) % m_maxLines;
+	HistoryLine& line = m_lines[ slot ];
+	line.textPosition = textPosition;
+	line.arenaHeadWhenAdded = m_textArenaHead;
+	line.firstPostingPosition = firstPostingPosition;
+	line.lineNumber = m_nextLineNumber++;
+	line.textLength = static_cast<uint16_t>( textLength );
+	line.color = color;
+	++m_numLines;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ConsoleHistory::AddTrigramPostings( const char* text, size_t textLength, uint32_t lineNumber )
+{
+	const uint64_t postingMask = m_postingRingSize - 1;
+	for ( size_t charIndex = 0; charIndex + TRIGRAM_LENGTH <= textLength; charIndex++ )
+	{
+		uint16_t bucket = GetTrigramBucket( &text[ charIndex ] );
+		uint64_t previousPosition = m_bucketHeads[ bucket ] - 1; //Only meaningful when the list isn't empty.
+		bool hasPrevious = ( m_bucketHeads[ bucket ] != 0 ) && IsPostingLive( previousPosition );
+		if ( hasPrevious && ( m_postings[ previousPosition & postingMask ].lineNumber == lineNumber ) )
+			continue; //A repeat within this line: lists hold each line once.
+
+		uint64_t position = m_postingHead++;
+		uint64_t slot = position & postingMask;
+		if ( position >= m_postingRingSize )
+			--m_bucketNumPostings[ m_postingBuckets[ slot ] ]; //Overwriting the oldest posting of all.
+		hasPrevious = hasPrevious && IsPostingLive( previousPosition ); //Unless that was the one just overwritten.
+
+		TrigramPosting& posting = m_postings[ slot ];
+		posting.lineNumber = lineNumber;
+		posting.distanceToPrevious = hasPrevious ? static_cast<uint32_t>( position - previousPosition ) : 0;
+		m_postingBuckets[ slot ] = bucket;
+		m_bucketHeads[ bucket ] = position + 1;
+		++m_bucketNumPostings[ bucket ];
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+uint64_t ConsoleHistory::FindOrAddText( const char* text, uint16_t textLength )
+{
+	const uint32_t hash = HashText( text, textLength );
+	const unsigned int internMask = m_internTableSize - 1;
+	const uint64_t arenaMask = m_textArenaSize - 1;
+
+	InternEntry* entryToReplace = nullptr;
+	for ( unsigned int probe = 0; probe < INTERN_PROBE_LENGTH; probe++ )
+	{
+		InternEntry& entry = m_internTable[ ( hash + probe ) & internMask ];
+		if ( ( entry.textLength == 0 ) || !IsTextLive( entry.textPosition ) )
+		{
+			if ( entryToReplace == nullptr )
+				entryToReplace = &entry;
+			continue;
+		}
+
+		if ( ( entry.hash == hash ) && ( entry.textLength == textLength ) && ( memcmp( &m_textArena[ entry.textPosition & arenaMask ], text, textLength ) == 0 ) )
+		{
+			++m_numInternedLines;
+			return entry.textPosition;
+		}
+	}
+
+	//Not interned: append it, never split across the arena's end, so every line can be read back as one C string.
+	uint64_t arenaOffset = m_textArenaHead & arenaMask;
+	if ( arenaOffset + textLength + 1 > m_textArenaSize )
+		m_textArenaHead += m_textArenaSize - arenaOffset;
+
+	uint64_t textPosition = m_textArenaHead;
+	char* textInArena = &m_textArena[ textPosition & arenaMask ];
+	memcpy( textInArena, text, textLength );
+	textInArena[ textLength ] = '\0';
+	m_textArenaHead += textLength + 1;
+
+	if ( entryToReplace == nullptr )
+		entryToReplace = &m_internTable[ hash & internMask ];
+	entryToReplace->textPosition = textPosition;
+	entryToReplace->hash = hash;
+	entryToReplace->textLength = textLength; //So empty lines leave the entry empty: not worth interning.
+
+	return textPosition;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ConsoleHistory::RemoveOldestLine()
+{
+	m_oldestLineSlot = ( m_oldestLineSlot + 1 ) % m_maxLines;
+	--m_numLines;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ConsoleHistory::Clear()
+{
+	m_oldestLineSlot = 0;
+	m_numLines = 0;
+	memset( m_internTable, 0, sizeof( InternEntry ) * m_internTableSize );
+
+	m_postingHead = 0; //Nothing can reach the old postings now, so they're overwritten without being counted out.
+	memset( m_bucketHeads, 0, sizeof( uint64_t ) * NUM_TRIGRAM_BUCKETS );
+	memset( m_bucketNumPostings, 0, sizeof( uint32_t ) * NUM_TRIGRAM_BUCKETS );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+const char* ConsoleHistory::GetLineText( unsigned int lineIndex ) const
+{
+	return &m_textArena[ GetLine( lineIndex ).textPosition & ( m_textArenaSize - 1 ) ];
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ConsoleHistory::DoesLineContain( unsigned int lineIndex, const char* term ) const
+{
+	const HistoryLine& line = GetLine( lineIndex );
+	return ContainsIgnoringCase( &m_textArena[ line.textPosition & ( m_textArenaSize - 1 ) ], line.textLength, term, strlen( term ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int ConsoleHistory::FindLines( const char* term, unsigned int* out_lineIndices, unsigned int maxResults ) const
+{
+	size_t termLength = strlen( term );
+	unsigned int numMatches = 0;
+	if ( termLength < TRIGRAM_LENGTH )
+	{
+		for ( unsigned int lineIndex = m_numLines; lineIndex-- > 0; )
+		{
+			if ( !DoesLineContain( lineIndex, term ) )
+				continue;
+
+			if ( numMatches < maxResults )
+				out_lineIndices[ numMatches ] = lineIndex;
+			++numMatches;
+		}
+		return numMatches;
+	}
+
+	//Any line containing the term is on every one of its trigrams' lists, so the shortest of them will do.
+	uint16_t shortestBucket = GetTrigramBucket( term );
+	for ( size_t charIndex = 1; charIndex + TRIGRAM_LENGTH <= termLength; charIndex++ )
+	{
+		uint16_t bucket = GetTrigramBucket( &term[ charIndex ] );
+		if ( m_bucketNumPostings[ bucket ] < m_bucketNumPostings[ shortestBucket ] )
+			shortestBucket = bucket;
+	}
+	if ( m_bucketHeads[ shortestBucket ] == 0 )
+		return 0;
+
+	const uint64_t postingMask = m_postingRingSize - 1;
+	const uint32_t oldestLineNumber = GetOldestLineNumber();
+	uint64_t position = m_bucketHeads[ shortestBucket ] - 1;
+	while ( IsPostingLive( position ) )
+	{
+		const TrigramPosting& posting = m_postings[ position & postingMask ];
+		if ( posting.lineNumber < oldestLineNumber )
+			break; //Newest first, so the rest of the list dropped off too.
+
+		unsigned int lineIndex = posting.lineNumber - oldestLineNumber;
+		if ( DoesLineContain( lineIndex, term ) )
+		{
+			if ( numMatches < maxResults )
+				out_lineIndices[ numMatches ] = lineIndex;
+			++numMatches;
+		}
+
+		if ( posting.distanceToPrevious == 0 )
+			break;
+		position -= posting.distanceToPrevious;
+	}
+
+	return numMatches;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+size_t ConsoleHistory::GetMemoryFootprintBytes() const
+{
+	return sizeof( HistoryLine ) * m_maxLines + static_cast<size_t>( m_textArenaSize ) + sizeof( InternEntry ) * m_internTableSize
+		+ ( sizeof( TrigramPosting ) + sizeof( uint16_t ) ) * static_cast<size_t>( m_postingRingSize ) + ( sizeof( uint64_t ) + sizeof( uint32_t ) ) * NUM_TRIGRAM_BUCKETS;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+int GetMinConsoleHistoryTestLines()
+{
+	return CONSOLE_HISTORY_MAX_LINES * NUM_FULL_CONSOLE_HISTORY_TEST_CHECKPOINTS; //So the full checkpoints land at least a ring's worth apart.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool RunConsoleHistoryTest( int numLinesToAdd )
+{
+	//One checkpoint while the ring is still half empty, then NUM_FULL_CHECKPOINTS spread over the rest, each at least a ring's worth apart.
+	const int NUM_FULL_CHECKPOINTS = NUM_FULL_CONSOLE_HISTORY_TEST_CHECKPOINTS;
+	const int NUM_CHECKPOINTS = NUM_FULL_CHECKPOINTS + 1;
+	const int PREFILL_CHECKPOINT_LINES = CONSOLE_HISTORY_MAX_LINES / 2;
+
+	//Same sizes as the console's own, filled with its usual kinds of output: numbered lines that never repeat, a few
+	//that always do, and a rare one for searches to find among the rest.
+	ConsoleHistory* history = new ConsoleHistory( CONSOLE_HISTORY_MAX_LINES, CONSOLE_HISTORY_TEXT_ARENA_BYTES, CONSOLE_HISTORY_TRIGRAM_POSTINGS );
+	const char* RARE_TERM = "checkpoint marker";
+	const char* COMMON_TERM = "TILE_4";
+	const unsigned int MAX_RESULTS = 32;
+	unsigned int results[ MAX_RESULTS ];
+
+	int linesAtCheckpoints[ NUM_CHECKPOINTS ];
+	unsigned int keptLinesAtCheckpoints[ NUM_CHECKPOINTS ];
+	unsigned int allocatedBytesAtCheckpoints[ NUM_CHECKPOINTS ];
+	double rareSearchMsAtCheckpoints[ NUM_CHECKPOINTS ];
+	double commonSearchMsAtCheckpoints[ NUM_CHECKPOINTS ];
+	unsigned int rareMatchesAtCheckpoints[ NUM_CHECKPOINTS ];
+	unsigned int commonMatchesAtCheckpoints[ NUM_CHECKPOINTS ];
+	linesAtCheckpoints[ 0 ] = PREFILL_CHECKPOINT_LINES;
+	for ( int index = 1; index < NUM_CHECKPOINTS; index++ )
+		linesAtCheckpoints[ index ] = static_cast<int>( ( static_cast<long long>( numLinesToAdd ) * index ) / NUM_FULL_CHECKPOINTS );
+	int checkpointIndex = 0;
+
+	char lineBuffer[ 256 ];
+	double startSeconds = GetCurrentTimeSeconds();
+	for ( int lineIndex = 0; lineIndex < numLinesToAdd; lineIndex++ )
+	{
+		if ( ( lineIndex % 1000 ) == 999 )
+			snprintf( lineBuffer, sizeof( lineBuffer ), "Checkpoint marker %d reached", lineIndex / 1000 );
+		else switch ( lineIndex % 4 )
+		{
+			case 0: snprintf( lineBuffer, sizeof( lineBuffer ), "Frame %d: %d entities updated in %.3f ms", lineIndex, lineIndex % 977, ( lineIndex % 1013 ) * .01f ); break;
+			case 1: snprintf( lineBuffer, sizeof( lineBuffer ), "Loaded texture Data/Images/Tile_%d.png", lineIndex % 64 ); break;
+			case 2: snprintf( lineBuffer, sizeof( lineBuffer ), "Physics step took too long, clamping" ); break;
+			default: snprintf( lineBuffer, sizeof( lineBuffer ), "Sound channel %d stopped", lineIndex % 32 ); break;
+		}
+		history->AddLine( lineBuffer, Rgba::WHITE );
+
+		if ( ( checkpointIndex < NUM_CHECKPOINTS ) && ( ( lineIndex + 1 ) == linesAtCheckpoints[ checkpointIndex ] ) )
+		{
+			keptLinesAtCheckpoints[ checkpointIndex ] = history->GetNumLines();
+			allocatedBytesAtCheckpoints[ checkpointIndex ] = MemoryAnalytics::GetCurrentTotalAllocatedBytes();
+
+			double searchStartSeconds = GetCurrentTimeSeconds();
+			rareMatchesAtCheckpoints[ checkpointIndex ] = history->FindLines( RARE_TERM, results, MAX_RESULTS );
+			rareSearchMsAtCheckpoints[ checkpointIndex ] = ( GetCurrentTimeSeconds() - searchStartSeconds ) * 1000.0;
+
+			searchStartSeconds = GetCurrentTimeSeconds();
+			commonMatchesAtCheckpoints[ checkpointIndex ] = history->FindLines( COMMON_TERM, results, MAX_RESULTS );
+			commonSearchMsAtCheckpoints[ checkpointIndex ] = ( GetCurrentTimeSeconds() - searchStartSeconds ) * 1000.0;
+
+			++checkpointIndex;
+		}
+	}
+	double addSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	//The index may only skip lines that can't match: compare against testing every kept line's text directly.
+	unsigned int numRareMatchesByScan = 0;
+	unsigned int numCommonMatchesByScan = 0;
+	for ( unsigned int lineIndex = 0; lineIndex < history->GetNumLines(); lineIndex++ )
+	{
+		const char* text = history->GetLineText( lineIndex );
+		if ( ContainsIgnoringCase( text, strlen( text ), RARE_TERM, strlen( RARE_TERM ) ) )
+			++numRareMatchesByScan;
+		if ( ContainsIgnoringCase( text, strlen( text ), COMMON_TERM, strlen( COMMON_TERM ) ) )
+			++numCommonMatchesByScan;
+	}
+
+	g_theConsole->Printf( "ConsoleHistoryTest: %d lines in %.2f s (%.0f ns per line), %u kept, %u interned, %u KB fixed footprint", numLinesToAdd, addSeconds,
+						  addSeconds * 1000000000.0 / numLinesToAdd, history->GetNumLines(), history->GetNumInternedLines(), static_cast<unsigned int>( history->GetMemoryFootprintBytes() / 1024 ) );
+	double worstSearchMs = 0.0;
+	for ( int index = 0; index < NUM_CHECKPOINTS; index++ )
+	{
+		g_theConsole->Printf( "  After %d lines (%u kept): %u bytes allocated, \"%s\" %.3f ms (%u matches), \"%s\" %.3f ms (%u matches)",
+							  linesAtCheckpoints[ index ], keptLinesAtCheckpoints[ index ], allocatedBytesAtCheckpoints[ index ], RARE_TERM, rareSearchMsAtCheckpoints[ index ],
+							  rareMatchesAtCheckpoints[ index ], COMMON_TERM, commonSearchMsAtCheckpoints[ index ], commonMatchesAtCheckpoints[ index ] );
+		worstSearchMs = ( rareSearchMsAtCheckpoints[ index ] > worstSearchMs ) ? rareSearchMsAtCheckpoints[ index ] : worstSearchMs;
+		worstSearchMs = ( commonSearchMsAtCheckpoints[ index ] > worstSearchMs ) ? commonSearchMsAtCheckpoints[ index ] : worstSearchMs;
+	}
+
+	//Before the ring fills, nothing has dropped off, so the index must find every marker added so far.
+	bool isPrefillExact = ( keptLinesAtCheckpoints[ 0 ] == static_cast<unsigned int>( PREFILL_CHECKPOINT_LINES ) ) &&
+						  ( rareMatchesAtCheckpoints[ 0 ] == static_cast<unsigned int>( PREFILL_CHECKPOINT_LINES / 1000 ) );
+
+	//Everything is allocated up front, so memory measured while the ring is half empty must match the end, allowing a little slack for other threads.
+	const int MAX_ALLOCATED_BYTES_DRIFT = 64 * 1024;
+	int allocatedBytesDrift = static_cast<int>( allocatedBytesAtCheckpoints[ NUM_CHECKPOINTS - 1 ] - allocatedBytesAtCheckpoints[ 0 ] );
+	bool isMemoryFlat = ( allocatedBytesDrift <= MAX_ALLOCATED_BYTES_DRIFT ) && ( allocatedBytesDrift >= -MAX_ALLOCATED_BYTES_DRIFT );
+
+	//Every search must take under a millisecond, and once the ring is full, adding lines may not slow them down.
+	const double MAX_SEARCH_MS = 1.0;
+	double firstFullSearchMs = rareSearchMsAtCheckpoints[ 1 ] + commonSearchMsAtCheckpoints[ 1 ];
+	double lastSearchMs = rareSearchMsAtCheckpoints[ NUM_CHECKPOINTS - 1 ] + commonSearchMsAtCheckpoints[ NUM_CHECKPOINTS - 1 ];
+	bool isSearchFast = ( worstSearchMs < MAX_SEARCH_MS );
+	bool isSearchBounded = ( lastSearchMs <= ( firstFullSearchMs * 2.0 ) + .25 );
+	bool doesIndexMatchScan = ( rareMatchesAtCheckpoints[ NUM_CHECKPOINTS - 1 ] == numRareMatchesByScan ) && ( commonMatchesAtCheckpoints[ NUM_CHECKPOINTS - 1 ] == numCommonMatchesByScan );
+
+	g_theConsole->Printf( "ConsoleHistoryTest: %u of %d lines kept and %u markers found before the ring filled: %s", keptLinesAtCheckpoints[ 0 ], PREFILL_CHECKPOINT_LINES,
+						  rareMatchesAtCheckpoints[ 0 ], isPrefillExact ? "PASS" : "FAIL" );
+	g_theConsole->Printf( "ConsoleHistoryTest: allocated bytes drifted %d between the half-full and last checkpoints: %s", allocatedBytesDrift, isMemoryFlat ? "PASS" : "FAIL" );
+	g_theConsole->Printf( "ConsoleHistoryTest: worst single search %.3f ms, limit %.3f ms: %s", worstSearchMs, MAX_SEARCH_MS, isSearchFast ? "PASS" : "FAIL" );
+	g_theConsole->Printf( "ConsoleHistoryTest: search %.3f ms at first full checkpoint, %.3f ms at last: %s", firstFullSearchMs, lastSearchMs, isSearchBounded ? "PASS" : "FAIL" );
+	g_theConsole->Printf( "ConsoleHistoryTest: index found %u \"%s\" and %u \"%s\" lines, full scan %u and %u: %s", rareMatchesAtCheckpoints[ NUM_CHECKPOINTS - 1 ], RARE_TERM,
+						  commonMatchesAtCheckpoints[ NUM_CHECKPOINTS - 1 ], COMMON_TERM, numRareMatchesByScan, numCommonMatchesByScan, doesIndexMatchScan ? "PASS" : "FAIL" );
+	bool didPass = isPrefillExact && isMemoryFlat && isSearchFast && isSearchBounded && doesIndexMatchScan;
+	g_theConsole->Printf( "ConsoleHistoryTest: %s", didPass ? "PASS" : "FAIL" );
+
+	delete history;
+	return didPass;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ConsoleHistoryTest( Command& args )
+{
+	const int MIN_TEST_LINES = GetMinConsoleHistoryTestLines();
+	int numLinesToAdd;
+	args.GetNextInt( &numLinesToAdd, DEFAULT_CONSOLE_HISTORY_TEST_LINES );
+	if ( numLinesToAdd < MIN_TEST_LINES )
+	{
+		g_theConsole->Printf( "Usage: ConsoleHistoryTest [numLines >= %d, default %d]", MIN_TEST_LINES, DEFAULT_CONSOLE_HISTORY_TEST_LINES );
+		return;
+	}
+
+	RunConsoleHistoryTest( numLinesToAdd );
+}
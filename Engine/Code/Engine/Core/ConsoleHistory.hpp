@@ -0,0 +1,108 @@
+#pragma once
+
+
+#include "Engine/Renderer/Rgba.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+
+//--------------------------------------------------------------------------------------------------------------
+class Command;
+
+
+//--------------------------------------------------------------------------------------------------------------
+//TheConsole's scrollback: a fixed ring of lines whose text sits in one fixed ring arena, so a soak run's output costs
+//the same memory and frame time after an hour as after a minute. All memory comes from the constructor; AddLine never
+//allocates. Once either ring is full, the oldest lines drop off.
+//
+//Text is interned: a line repeating one still in the arena's newer half points at the existing copy instead of adding
+//another. Only lines added within the last half an arena are kept, which is what keeps those shared copies alive.
+//
+//Searches go through a trigram index built as lines are added: per hashed, lowercased 3-character window, a posting list
+//of the lines containing it, newest first. Postings sit in their own fixed ring, one per distinct trigram per line, and a
+//line drops off once its postings are overwritten, as with its text. FindLines walks only the shortest list among its
+//term's trigrams and checks those lines' text, so it never touches lines sharing none of the rarest trigram. Terms under
+//3 characters have no trigram and scan every line. Matching ignores ASCII case, like the console's Find always has.
+class ConsoleHistory
+{
+public:
+	ConsoleHistory( unsigned int maxLines, unsigned int textArenaBytes, unsigned int maxTrigramPostings ); //The last two round up to powers of two.
+	~ConsoleHistory();
+	ConsoleHistory( const ConsoleHistory& copy ) = delete;
+
+	void AddLine( const char* text, const Rgba& color );
+	void Clear(); //Line numbers keep counting up from where they were.
+
+	//Line 0 is the oldest kept, GetNumLines() - 1 the newest. Indices shift down as old lines drop off.
+	unsigned int GetNumLines() const { return m_numLines; }
+	const char* GetLineText( unsigned int lineIndex ) const;
+	unsigned int GetLineNumber( unsigned int lineIndex ) const { return GetLine( lineIndex ).lineNumber; } //1 for the first line ever added.
+	const Rgba& GetLineColor( unsigned int lineIndex ) const { return GetLine( lineIndex ).color; }
+	bool DoesLineContain( unsigned int lineIndex, const char* term ) const;
+
+	//Newest first. Returns how many lines match in all, though at most maxResults indices are written out.
+	unsigned int FindLines( const char* term, unsigned int* out_lineIndices, unsigned int maxResults ) const;
+
+	size_t GetMemoryFootprintBytes() const;
+	unsigned int GetNumInternedLines() const { return m_numInternedLines; } //How many lines reused text, since construction.
+
+
+private:
+	struct HistoryLine
+	{
+		uint64_t textPosition; //Into the arena, counting every byte ever written, so staleness is a subtraction.
+		uint64_t arenaHeadWhenAdded;
+		uint64_t firstPostingPosition; //Into the posting ring, counted the same way. Its postings follow contiguously.
+		uint32_t lineNumber;
+		uint16_t textLength; //Not counting the terminator, which is stored too.
+		Rgba color;
+	};
+
+	struct InternEntry
+	{
+		uint64_t textPosition;
+		uint32_t hash;
+		uint16_t textLength; //0 marks an empty entry.
+	};
+
+	struct TrigramPosting
+	{
+		uint32_t lineNumber;
+		uint32_t distanceToPrevious; //Back to the next older posting in the same list. 0 ends the list.
+	};
+
+	const HistoryLine& GetLine( unsigned int lineIndex ) const { return m_lines[ ( m_oldestLineSlot + lineIndex ) % m_maxLines ]; }
+	bool IsTextLive( uint64_t textPosition ) const { return ( textPosition + ( m_textArenaSize / 2 ) ) >= m_textArenaHead; }
+	bool IsPostingLive( uint64_t postingPosition ) const { return ( postingPosition + m_postingRingSize ) >= m_postingHead; }
+	uint32_t GetOldestLineNumber() const { return m_nextLineNumber - m_numLines; } //Kept lines are always consecutively numbered.
+	uint64_t FindOrAddText( const char* text, uint16_t textLength );
+	void AddTrigramPostings( const char* text, size_t textLength, uint32_t lineNumber );
+	void RemoveOldestLine();
+
+	HistoryLine* m_lines;
+	unsigned int m_maxLines;
+	unsigned int m_oldestLineSlot;
+	unsigned int m_numLines;
+	uint32_t m_nextLineNumber;
+
+	char* m_textArena;
+	uint64_t m_textArenaSize;
+	uint64_t m_textArenaHead;
+
+	InternEntry* m_internTable;
+	unsigned int m_internTableSize;
+	unsigned int m_numInternedLines;
+
+	TrigramPosting* m_postings;
+	uint16_t* m_postingBuckets; //Which list each ring slot's posting is in, to shorten that list's count when it's overwritten.
+	uint64_t m_postingRingSize;
+	uint64_t m_postingHead;
+	uint64_t* m_bucketHeads; //Position + 1 of each list's newest posting, 0 for none.
+	uint32_t* m_bucketNumPostings; //Live postings per list, including lines since dropped for the line cap: only used to pick the shortest.
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+int GetMinConsoleHistoryTestLines();
+bool RunConsoleHistoryTest( int numLinesToAdd ); //numLinesToAdd: at least GetMinConsoleHistoryTestLines(). True if every check passed.
+void ConsoleHistoryTest( Command& args ); //ConsoleHistoryTest [numLines = 10M]: memory stays flat and searches stay fast as lines pour in.
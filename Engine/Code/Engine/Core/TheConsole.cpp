@@ -5,6 +5,7 @@
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/EngineCommon.hpp"
 #include "Engine/Core/Command.hpp"
+#include "Engine/Time/Time.hpp"
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -21,21 +22,6 @@ void TheConsole::CleanupEntries()
 }
 
 
-//--------------------------------------------------------------------------------------------------------------
-std::string TheConsole::RemoveLineNumber( const std::string& storedLineWithLineNumber )
-{
-	std::string manipStr = storedLineWithLineNumber;
-
-	size_t colonPos = manipStr.find_first_of( ':' );
-	if ( colonPos == std::string::npos )
-		return storedLineWithLineNumber;
-
-	manipStr.erase( manipStr.begin(), manipStr.begin() + colonPos + 2 ); //Remove up to the :, the :, and the space that follows it.
-
-	return manipStr;
-}
-
-
 //--------------------------------------------------------------------------------------------------------------
 void ShowHelp( Command& /*args*/ )
 {
@@ -115,10 +101,51 @@ void FindString( Command& args )
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void GrepHistory( Command& args )
+{
+	std::string phraseToSearch = args.GetArgsString();
+	if ( phraseToSearch == "" )
+	{
+		g_theConsole->Printf( "Usage: grep <unquoted phrase>, to list the newest lines containing it, ignoring case." );
+		return;
+	}
+
+	//One more than shown, since the newest line is this command's own echo, skipped below.
+	const unsigned int MAX_MATCHES_SHOWN = 20;
+	unsigned int matchingLineIndices[ MAX_MATCHES_SHOWN + 1 ];
+	const ConsoleHistory& history = g_theConsole->GetHistory();
+	double startSeconds = GetCurrentTimeSeconds();
+	unsigned int numMatches = history.FindLines( phraseToSearch.c_str(), matchingLineIndices, MAX_MATCHES_SHOWN + 1 );
+	double searchMs = ( GetCurrentTimeSeconds() - startSeconds ) * 1000.0;
+
+	unsigned int firstShown = 0;
+	if ( ( numMatches > 0 ) && ( matchingLineIndices[ 0 ] == history.GetNumLines() - 1 ) )
+	{
+		++firstShown;
+		--numMatches;
+	}
+
+	//Copy them out before printing anything: each Printf adds a line, which can push old ones out and shift indices.
+	std::vector< std::string > matchingLines;
+	unsigned int numIndicesWritten = ( firstShown + numMatches < MAX_MATCHES_SHOWN + 1 ) ? firstShown + numMatches : MAX_MATCHES_SHOWN + 1;
+	for ( unsigned int matchIndex = firstShown; matchIndex < numIndicesWritten && matchingLines.size() < MAX_MATCHES_SHOWN; ++matchIndex )
+	{
+		unsigned int lineIndex = matchingLineIndices[ matchIndex ];
+		matchingLines.push_back( Stringf( "  %u: %s", history.GetLineNumber( lineIndex ), history.GetLineText( lineIndex ) ) );
+	}
+
+	g_theConsole->Printf( "%u of %u lines match (%.3f ms), newest first:", numMatches, history.GetNumLines(), searchMs );
+	for ( const std::string& matchingLine : matchingLines )
+		g_theConsole->Printf( "%s", matchingLine.c_str() );
+	if ( numMatches > matchingLines.size() )
+		g_theConsole->Printf( "  ...and %u older.", numMatches - (unsigned int)matchingLines.size() );
+}
+
+
 //-----------------------------------------------------------------------------------------------
 void TheConsole::Printf( const char* messageFormat, ... )
 {
-	static unsigned int numInvocation = 0;
 	//Duplicating code from DebuggerPrintf() because it appears I'd need to do the same thing just to pass it to Stringf().
 	
 	const int MESSAGE_MAX_LENGTH = 2048;
@@ -129,13 +156,10 @@ void TheConsole::Printf( const char* messageFormat, ... )
 	va_end( variableArgumentList );
 	messageLiteral[ MESSAGE_MAX_LENGTH - 1 ] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
 
-	TODO( "Make it push back a bool--probably turn into m_storedText into a container of structs--that flag whether up/down skips it." );
-	std::string finalMessage = std::to_string( ++numInvocation );
-	finalMessage += ": ";
-	finalMessage += messageLiteral;
-	m_storedText.push_back( std::pair< std::string, Rgba>( finalMessage, m_currentColor ) );
+	TODO( "Make it store a flag per line--probably in ConsoleHistory's line records--for whether up/down skips it." );
+	m_history.AddLine( messageLiteral, m_currentColor ); //Numbered as it's drawn, so repeated messages can share their text.
 
-	unsigned int indexOfNewestStoredText = ( m_storedText.size() > 0 ) ? m_storedText.size() - 1 : 0;
+	unsigned int indexOfNewestStoredText = ( m_history.GetNumLines() > 0 ) ? m_history.GetNumLines() - 1 : 0;
 	m_bottommostLogIndexToRender = indexOfNewestStoredText;
 }
 
@@ -177,7 +201,7 @@ void TheConsole::Render() //Recall up is +y.
 	//Sizes for the log: for each stored line of text add heightOfOneLinePx under the max, at which point cut the log off.
 	Vector2f currentLogBoxBottomRight = Vector2f( currentPromptBoxBottomRight.x, m_currentPromptBoxTopLeft.y + ( spacingPx * 2.f ) );
 	float totalHeightOfLinesInLogPx = 0.f;
-	for ( m_maxStoredLinesToShow = 0; m_maxStoredLinesToShow < m_storedText.size(); m_maxStoredLinesToShow++ )
+	for ( m_maxStoredLinesToShow = 0; m_maxStoredLinesToShow < m_history.GetNumLines(); m_maxStoredLinesToShow++ )
 	{
 		if ( totalHeightOfLinesInLogPx + heightOfOneLinePx < m_maxConsoleHeightAsScreenPercentage )
 			totalHeightOfLinesInLogPx += heightOfOneLinePx;
@@ -215,21 +239,28 @@ void TheConsole::Render() //Recall up is +y.
 void TheConsole::RenderPreviousTextEntries( float consoleX, float spacingPx, float heightOfOneLinePx )
 {
 	//Print text from earlier stored entries: walk from the oldest one shown to the end, iterating forward.
-	if ( m_maxStoredLinesToShow <= 0 )
+	//Only these lines are touched, however much history sits above them.
+	if ( m_maxStoredLinesToShow <= 0 || m_history.GetNumLines() == 0 )
 		return; //No stored text lines to print.
 
-	CommandHistory::const_iterator storedTextIterEnd = m_storedText.cbegin() + m_bottommostLogIndexToRender - 0; //This is the newest, bottom-most stored text line shown. 
-		//The +1 is to end the loop after rendering the last line itself.
-	CommandHistory::const_iterator storedTextIterStart = ( m_bottommostLogIndexToRender < (int)m_maxStoredLinesToShow - 1 ) ?
-		m_storedText.cbegin() :
-		storedTextIterEnd - ( m_maxStoredLinesToShow - 1 ); //-1 to convert a size to an index.
+	int lastLineIndex = m_bottommostLogIndexToRender; //This is the newest, bottom-most stored text line shown.
+	if ( lastLineIndex >= (int)m_history.GetNumLines() )
+		lastLineIndex = m_history.GetNumLines() - 1;
+	int firstLineIndex = ( lastLineIndex < (int)m_maxStoredLinesToShow - 1 ) ?
+		0 :
+		lastLineIndex - ( m_maxStoredLinesToShow - 1 ); //-1 to convert a size to an index.
 
 	Vector2f positionInLog = Vector2f( consoleX + spacingPx * 2.f, m_currentLogBoxTopLeft.y - spacingPx );
+	byte_t searchResultAlpha = static_cast<byte_t>( RangeMap( m_caretAlphaCounter, 0.f, 1.f, 0.f, 255.f ) );
 
-	for ( auto storedTextIter = storedTextIterStart; storedTextIter <= storedTextIterEnd; ++storedTextIter )
+	for ( int lineIndex = firstLineIndex; lineIndex <= lastLineIndex; ++lineIndex )
 	{
-		std::pair< std::string, Rgba > storedLine = *storedTextIter;
-		g_theRenderer->DrawTextProportional2D( positionInLog, storedLine.first, m_currentScale, m_currentFont, storedLine.second );
+		Rgba lineColor = m_history.GetLineColor( lineIndex );
+		if ( m_shouldPulseSearchResult && m_searchResultToPulse != "" && m_history.DoesLineContain( lineIndex, m_searchResultToPulse.c_str() ) )
+			lineColor.alphaOpacity = searchResultAlpha;
+
+		std::string numberedLine = Stringf( "%u: %s", m_history.GetLineNumber( lineIndex ), m_history.GetLineText( lineIndex ) );
+		g_theRenderer->DrawTextProportional2D( positionInLog, numberedLine, m_currentScale, m_currentFont, lineColor );
 		positionInLog.y -= heightOfOneLinePx; //Move caret down to next line.
 	}
 }
@@ -284,24 +315,11 @@ void TheConsole::Update( float deltaSeconds )
 		{
 			if ( mouseWheelDelta < 0 && m_bottommostLogIndexToRender - 1 >= 0 )
 				m_bottommostLogIndexToRender--;
-			else if ( mouseWheelDelta > 0 && m_maxStoredLinesToShow + m_bottommostLogIndexToRender + 1 <= (int)m_storedText.size() )
+			else if ( mouseWheelDelta > 0 && m_maxStoredLinesToShow + m_bottommostLogIndexToRender + 1 <= (int)m_history.GetNumLines() )
 				m_bottommostLogIndexToRender++;
 		}
 
-		//Search result pulse update.
-		if ( m_shouldPulseSearchResult && m_searchResultToPulse != "" )
-		{
-			auto storedTextIterEnd = m_storedText.end();
-			for ( auto storedTextIter = m_storedText.begin(); storedTextIter != storedTextIterEnd; ++storedTextIter )
-			{
-				std::pair< std::string, Rgba >& currentLine = *storedTextIter;
-				std::string currentLineLowercase = GetAsLowercase( currentLine.first );
-				if ( currentLineLowercase.find( m_searchResultToPulse ) != std::string::npos )
-				{
-					currentLine.second.alphaOpacity = static_cast<unsigned char>( RangeMap( m_caretAlphaCounter, 0.f, 1.f, 0.f, 255.f ) );
-				}
-			}
-		}
+		//Search results pulse in RenderPreviousTextEntries, which only tests the lines it draws.
 	}
 
 }
@@ -339,28 +357,26 @@ void TheConsole::UpdatePromptForKeydown( unsigned char ch )
 		if ( m_replacerPos - 1 >= 0 )
 		{
 			m_replacerPos--;
-			m_currentPromptString = m_storedText[ m_replacerPos ].first;
+			m_currentPromptString = m_history.GetLineText( m_replacerPos );
 		}
 		else
 		{
-			if ( m_storedText.size() > 0 )
-				m_currentPromptString = m_storedText[ m_replacerPos ].first;
+			if ( m_history.GetNumLines() > 0 )
+				m_currentPromptString = m_history.GetLineText( m_replacerPos );
 		}
-		m_currentPromptString = RemoveLineNumber( m_currentPromptString );
 		m_caretPosInInputString = m_currentPromptString.size();
 		break;
 	case VK_DOWN:
-		if ( m_replacerPos + 1 < (int)m_storedText.size() )
+		if ( m_replacerPos + 1 < (int)m_history.GetNumLines() )
 		{
 			m_replacerPos++;
-			m_currentPromptString = m_storedText[ m_replacerPos ].first;
+			m_currentPromptString = m_history.GetLineText( m_replacerPos );
 		}
 		else
 		{
-			if ( m_storedText.size() > 0 )
-				m_currentPromptString = m_storedText[ m_replacerPos ].first;
+			if ( m_history.GetNumLines() > 0 )
+				m_currentPromptString = m_history.GetLineText( m_replacerPos );
 		}
-		m_currentPromptString = RemoveLineNumber( m_currentPromptString );
 		m_caretPosInInputString = m_currentPromptString.size();
 		break;
 	//Scrollable history.
@@ -385,7 +401,7 @@ void TheConsole::RaiseShownLines()
 //--------------------------------------------------------------------------------------------------------------
 void TheConsole::LowerShownLines()
 {
-	if ( m_bottommostLogIndexToRender + 1 < (int)m_storedText.size() )
+	if ( m_bottommostLogIndexToRender + 1 < (int)m_history.GetNumLines() )
 		m_bottommostLogIndexToRender++;
 }
 
@@ -393,21 +409,7 @@ void TheConsole::LowerShownLines()
 //--------------------------------------------------------------------------------------------------------------
 void TheConsole::ShouldPulseSearchResults( bool newVal, const std::string& term )
 {
-	if ( m_searchResultToPulse != "" &&  m_searchResultToPulse != term )
-	{
-		//Cleanup transparencies.
-		auto storedTextIterEnd = m_storedText.end();
-		for ( auto storedTextIter = m_storedText.begin(); storedTextIter != storedTextIterEnd; ++storedTextIter )
-		{
-			std::pair< std::string, Rgba >& currentLine = *storedTextIter;
-			std::string currentLineLowercase = GetAsLowercase( currentLine.first );
-			if ( currentLineLowercase.find( m_searchResultToPulse ) != std::string::npos )
-			{
-				currentLine.second.alphaOpacity = 255;
-			}
-		}
-	}
-
+	//Nothing to clean up: the pulse is applied as lines are drawn, never stored into them.
 	m_shouldPulseSearchResult = newVal; 
 	m_searchResultToPulse = GetAsLowercase( term );
 }
@@ -432,7 +434,7 @@ void TheConsole::UpdatePromptForChar( unsigned char ch )
 				Printf( m_currentPromptString.c_str() );
 				RunCommand( m_currentPromptString );
 			}
-			unsigned int indexOfNewestStoredText = ( m_storedText.size() > 0 ) ? m_storedText.size() - 1 : 0;
+			unsigned int indexOfNewestStoredText = ( m_history.GetNumLines() > 0 ) ? m_history.GetNumLines() - 1 : 0;
 			m_replacerPos = indexOfNewestStoredText;
 			m_currentPromptString = "";
 			m_caretPosInInputString = 0;
@@ -8,6 +8,8 @@
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Renderer/TheRenderer.hpp"
 #include "Engine/Memory/UntrackedAllocator.hpp"
+#include "Engine/Core/ConsoleHistory.hpp"
+#include "Engine/BuildConfig.hpp"
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -41,10 +43,7 @@ void ClearLog( Command& args );
 void CloseConsole( Command& args );
 void SetColor( Command& args );
 void FindString( Command& args );
-
-
-//--------------------------------------------------------------------------------------------------------------
-typedef std::vector< std::pair< std::string, Rgba > > CommandHistory;
+void GrepHistory( Command& args );
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -56,7 +55,8 @@ public:
 				bool showPromptBox = true,
 				const Rgba& textColor = Rgba(), bool isVisible = false, float textScale = .25f,
 				double maxConsoleHeightCoverageNormalized = 0.3, BitmapFont* font = g_theRenderer->GetDefaultFont() )
-		: m_currentColor( textColor )
+		: m_history( CONSOLE_HISTORY_MAX_LINES, CONSOLE_HISTORY_TEXT_ARENA_BYTES, CONSOLE_HISTORY_TRIGRAM_POSTINGS )
+		, m_currentColor( textColor )
 		, m_isVisible( isVisible )
 		, m_currentScale( textScale )
 		, m_consoleX( consoleX )
@@ -81,6 +81,7 @@ public:
 		RegisterCommand( "Close", CloseConsole );
 		RegisterCommand( "SetConsoleColor", SetColor );
 		RegisterCommand( "Find", FindString );
+		RegisterCommand( "Grep", GrepHistory );
 	}
 	void RegisterCommand( const std::string& name, ConsoleCommandCallback* cb );
 	void RunCommand( const std::string& fullCommandString );
@@ -101,7 +102,8 @@ public:
 	void LowerShownLines();
 	void RaiseShownLines();
 
-	void ClearConsoleLog() { m_storedText.clear(); m_replacerPos = 0; }
+	void ClearConsoleLog() { m_history.Clear(); m_replacerPos = 0; m_bottommostLogIndexToRender = 0; }
+	const ConsoleHistory& GetHistory() const { return m_history; }
 	void ShouldPulseSearchResults( bool newVal, const std::string& term );
 	void AttemptAutocomplete( const ConsoleCommandRegistryMap::iterator* indexOfLastResult = nullptr );
 	void ShowPrompt() { m_showPromptBox = true; }
@@ -109,12 +111,11 @@ public:
 	void HidePrompt() { m_showPromptBox = false; }
 
 	void CleanupEntries();
-	std::string RemoveLineNumber( const std::string& storedLineWithLineNumber );
 	static Rgba DEFAULT_COLOR;
 
 private:
 
-	CommandHistory m_storedText;
+	ConsoleHistory m_history;
 
 	Vector2f m_currentLogBoxTopLeft;
 	Vector2f m_currentPromptBoxTopLeft;
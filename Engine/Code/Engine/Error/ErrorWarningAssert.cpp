@@ -12,6 +12,7 @@
 //-----------------------------------------------------------------------------------------------
 #include "Engine/Error/ErrorWarningAssert.hpp"
 #include "Engine/String/StringUtils.hpp"
+#include "Engine/Memory/Callstack.hpp"
 #include <stdarg.h>
 #include <iostream>
 
@@ -221,6 +222,7 @@ __declspec( noreturn ) void FatalError( const char* filePath, const char* functi
 	DebuggerPrintf( "RUN-TIME FATAL ERROR on line %i of %s, in %s()\n", lineNum, fileName, functionName );
 	DebuggerPrintf( "%s(%d): %s\n", filePath, lineNum, errorMessage.c_str() ); // Use this specific format so Visual Studio users can double-click to jump to file-and-line of error
 	DebuggerPrintf( "==============================================================================\n\n" );
+	Callstack::PrintHumanReadableCallstackToDebugger( Callstack::FetchAndAllocate( 1 ) ); // Skip FatalError itself
 
 	if( isDebuggerPresent )
 	{
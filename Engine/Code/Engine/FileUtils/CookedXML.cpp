@@ -0,0 +1,242 @@
+#include "Engine/FileUtils/CookedXML.hpp"
+
+#include "Engine/EngineCommon.hpp"
+#include "Engine/FileUtils/FileUtils.hpp"
+#include "Engine/FileUtils/XMLStreamReader.hpp"
+#include "Engine/Core/Logger.hpp"
+#include <sys/stat.h>
+#include <stdint.h>
+
+#ifdef PLATFORM_WINDOWS
+	#include <direct.h>
+#else
+	#include <sys/types.h>
+#endif
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const uint32_t COOKED_XML_MAGIC = 0x4C4D5843; //"CXML" read little-endian.
+static CookedXMLStats s_cookedXMLStats;
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct CookedXMLSourceStamp
+{
+	CookedXMLSourceStamp() : lastWriteTime( 0 ), fileSize( 0 ) {}
+	bool operator==( const CookedXMLSourceStamp& other ) const { return lastWriteTime == other.lastWriteTime && fileSize == other.fileSize; }
+	bool operator!=( const CookedXMLSourceStamp& other ) const { return !( *this == other ); }
+
+	int64_t lastWriteTime;
+	int64_t fileSize;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool GetSourceStamp( const std::string& filePath, CookedXMLSourceStamp& out_stamp )
+{
+#ifdef PLATFORM_WINDOWS
+	struct __stat64 fileInfo;
+	if ( _stat64( filePath.c_str(), &fileInfo ) != 0 )
+		return false;
+#else
+	struct stat fileInfo;
+	if ( stat( filePath.c_str(), &fileInfo ) != 0 )
+		return false;
+#endif
+
+	out_stamp.lastWriteTime = fileInfo.st_mtime;
+	out_stamp.fileSize = fileInfo.st_size;
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static uint32_t AppendToStringPool( std::vector< char >& stringPool, const StringView& str )
+{
+	uint32_t offset = static_cast<uint32_t>( stringPool.size() );
+	stringPool.insert( stringPool.end(), str.begin(), str.end() );
+	return offset;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void AppendRecord( std::vector< CookedXMLRecord >& records, std::vector< char >& stringPool, CookedXMLRecordType type, const StringView& name, const StringView& value )
+{
+	CookedXMLRecord record;
+	record.m_type = type;
+	record.m_nameLength = static_cast<uint32_t>( name.size() );
+	record.m_nameOffset = AppendToStringPool( stringPool, name );
+	record.m_valueLength = static_cast<uint32_t>( value.size() );
+	record.m_valueOffset = AppendToStringPool( stringPool, value );
+	records.push_back( record );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool LoadCookedXML( const std::string& xmlFilePath, std::vector< unsigned char >& out_cookedBlob )
+{
+	if ( !LoadBinaryFileIntoBuffer( GetCookedXMLPathForSource( xmlFilePath ), out_cookedBlob ) || out_cookedBlob.size() < sizeof( CookedXMLHeader ) )
+	{
+		++s_cookedXMLStats.numCacheMisses;
+		return false;
+	}
+
+	const CookedXMLHeader* header = reinterpret_cast<const CookedXMLHeader*>( out_cookedBlob.data() ); //Blobs are cooked LITTLE_ENDIAN on the same kind of machine that reads them.
+	CookedXMLSourceStamp cookedStamp;
+	cookedStamp.lastWriteTime = header->m_sourceLastWriteTime;
+	cookedStamp.fileSize = header->m_sourceFileSize;
+
+	CookedXMLSourceStamp sourceStamp;
+	bool sourceExists = GetSourceStamp( xmlFilePath, sourceStamp );
+	bool isStale = sourceExists && ( sourceStamp != cookedStamp ); //No source at all is fine, that's a cooked-only data build.
+
+	if ( header->m_magic != COOKED_XML_MAGIC || header->m_formatVersion != COOKED_XML_FORMAT_VERSION || isStale || !ValidateCookedXML( out_cookedBlob ) )
+	{
+		++s_cookedXMLStats.numCacheMisses;
+		return false;
+	}
+
+	++s_cookedXMLStats.numCacheHits;
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool CookXMLStream( XMLStreamReader& sourceReader, const std::string& xmlFilePath, std::vector< unsigned char >& out_cookedBlob )
+{
+	std::vector< CookedXMLRecord > records;
+	std::vector< char > stringPool;
+	for ( ;; )
+	{
+		XMLStreamToken token = sourceReader.ReadNext();
+		if ( token == XML_TOKEN_ERROR )
+		{
+			++s_cookedXMLStats.numCookFailures;
+			return false;
+		}
+
+		if ( token == XML_TOKEN_END_OF_DOCUMENT )
+			break;
+
+		if ( token == XML_TOKEN_START_ELEMENT )
+		{
+			AppendRecord( records, stringPool, COOKED_XML_RECORD_START_ELEMENT, sourceReader.GetName(), StringView() );
+			for ( int attributeIndex = 0; attributeIndex < sourceReader.GetNumAttributes(); attributeIndex++ )
+				AppendRecord( records, stringPool, COOKED_XML_RECORD_ATTRIBUTE, sourceReader.GetAttributeName( attributeIndex ), sourceReader.GetAttributeValue( attributeIndex ) );
+		}
+		else if ( token == XML_TOKEN_END_ELEMENT )
+		{
+			AppendRecord( records, stringPool, COOKED_XML_RECORD_END_ELEMENT, sourceReader.GetName(), StringView() );
+		}
+		else if ( token == XML_TOKEN_TEXT )
+		{
+			AppendRecord( records, stringPool, COOKED_XML_RECORD_TEXT, StringView(), sourceReader.GetText() );
+		}
+	}
+
+	CookedXMLSourceStamp sourceStamp;
+	GetSourceStamp( xmlFilePath, sourceStamp );
+
+	CookedXMLHeader header;
+	header.m_magic = COOKED_XML_MAGIC;
+	header.m_formatVersion = COOKED_XML_FORMAT_VERSION;
+	header.m_sourceLastWriteTime = sourceStamp.lastWriteTime;
+	header.m_sourceFileSize = sourceStamp.fileSize;
+	header.m_numRecords = static_cast<uint32_t>( records.size() );
+	header.m_stringPoolSize = static_cast<uint32_t>( stringPool.size() );
+
+	size_t numRecordBytes = records.size() * sizeof( CookedXMLRecord );
+	out_cookedBlob.resize( sizeof( CookedXMLHeader ) + numRecordBytes + stringPool.size() );
+	memcpy( out_cookedBlob.data(), &header, sizeof( CookedXMLHeader ) );
+	if ( numRecordBytes > 0 )
+		memcpy( out_cookedBlob.data() + sizeof( CookedXMLHeader ), records.data(), numRecordBytes );
+	if ( !stringPool.empty() )
+		memcpy( out_cookedBlob.data() + sizeof( CookedXMLHeader ) + numRecordBytes, stringPool.data(), stringPool.size() );
+
+#ifdef PLATFORM_WINDOWS
+	_mkdir( COOKED_XML_DIRECTORY ); //Fails harmlessly when it already exists.
+#else
+	mkdir( COOKED_XML_DIRECTORY, 0755 );
+#endif
+
+	//The blob's still good to replay this launch even if it can't be saved for the next.
+	if ( !SaveBufferToBinaryFile( GetCookedXMLPathForSource( xmlFilePath ), out_cookedBlob ) )
+	{
+		++s_cookedXMLStats.numCookFailures;
+		Logger::PrintfWithTag( "CookedXML", "Failed to cook %s, it will be parsed again next launch.", xmlFilePath.c_str() );
+	}
+	else Logger::PrintfWithTag( "CookedXML", "Recooked %s.", xmlFilePath.c_str() );
+
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ValidateCookedXML( const std::vector< unsigned char >& cookedBlob )
+{
+	if ( cookedBlob.size() < sizeof( CookedXMLHeader ) )
+		return false;
+
+	const CookedXMLHeader* header = reinterpret_cast<const CookedXMLHeader*>( cookedBlob.data() );
+	uint64_t expectedSize = sizeof( CookedXMLHeader ) + (uint64_t)header->m_numRecords * sizeof( CookedXMLRecord ) + header->m_stringPoolSize;
+	if ( expectedSize != cookedBlob.size() )
+		return false;
+
+	const CookedXMLRecord* records = reinterpret_cast<const CookedXMLRecord*>( header + 1 );
+	int depth = 0;
+	int numAttributesOnElement = 0;
+	bool canTakeAttribute = false;
+	for ( uint32_t recordIndex = 0; recordIndex < header->m_numRecords; recordIndex++ )
+	{
+		const CookedXMLRecord& record = records[ recordIndex ];
+		if ( (uint64_t)record.m_nameOffset + record.m_nameLength > header->m_stringPoolSize
+			|| (uint64_t)record.m_valueOffset + record.m_valueLength > header->m_stringPoolSize )
+			return false;
+
+		switch ( record.m_type )
+		{
+		case COOKED_XML_RECORD_START_ELEMENT:
+			++depth;
+			numAttributesOnElement = 0;
+			canTakeAttribute = true;
+			break;
+		case COOKED_XML_RECORD_ATTRIBUTE:
+			if ( !canTakeAttribute || ++numAttributesOnElement > XMLStreamReader::MAX_ATTRIBUTES_PER_ELEMENT )
+				return false;
+			break;
+		case COOKED_XML_RECORD_END_ELEMENT:
+			if ( --depth < 0 )
+				return false;
+			canTakeAttribute = false;
+			break;
+		case COOKED_XML_RECORD_TEXT:
+			canTakeAttribute = false;
+			break;
+		default:
+			return false;
+		}
+	}
+
+	return depth == 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+std::string GetCookedXMLPathForSource( const std::string& xmlFilePath )
+{
+	std::string flattenedName = xmlFilePath;
+	for ( char& c : flattenedName )
+	{
+		if ( c == '/' || c == '\\' || c == ':' )
+			c = '.';
+	}
+
+	return Stringf( "%s/%s.cooked", COOKED_XML_DIRECTORY, flattenedName.c_str() );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+const CookedXMLStats& GetCookedXMLStats()
+{
+	return s_cookedXMLStats;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+
+//-----------------------------------------------------------------------------
+class XMLStreamReader;
+
+
+//-----------------------------------------------------------------------------
+//Cooked XML: the token stream XMLStreamReader would produce for a file, written under COOKED_XML_DIRECTORY the first time it's read.
+//Each blob is stamped with its format version and the source's size and last-write time, so a stale or
+//mismatched blob is silently recooked. Otherwise XMLStreamReader::OpenFileCooked replays its records in place:
+//no tokenizing, entity decoding or DOM, and names and values are StringViews into the blob's string pool.
+//
+//Layout: CookedXMLHeader, then m_numRecords CookedXMLRecords in document order, then m_stringPoolSize bytes of chars.
+//A START_ELEMENT record is followed by one ATTRIBUTE record per attribute. Values stay text, parsed by FromChars on read.
+//-----------------------------------------------------------------------------
+static const unsigned int COOKED_XML_FORMAT_VERSION = 2; //Bump on any layout change below to invalidate every blob.
+
+
+//-----------------------------------------------------------------------------
+enum CookedXMLRecordType
+{
+	COOKED_XML_RECORD_START_ELEMENT,
+	COOKED_XML_RECORD_ATTRIBUTE,
+	COOKED_XML_RECORD_END_ELEMENT,
+	COOKED_XML_RECORD_TEXT,
+	NUM_COOKED_XML_RECORD_TYPES
+};
+
+
+//-----------------------------------------------------------------------------
+struct CookedXMLHeader
+{
+	uint32_t m_magic;
+	uint32_t m_formatVersion;
+	int64_t m_sourceLastWriteTime;
+	int64_t m_sourceFileSize;
+	uint32_t m_numRecords;
+	uint32_t m_stringPoolSize;
+};
+
+
+//-----------------------------------------------------------------------------
+struct CookedXMLRecord
+{
+	uint32_t m_type; //CookedXMLRecordType.
+	uint32_t m_nameOffset; //Element or attribute name, as an offset into the string pool.
+	uint32_t m_nameLength;
+	uint32_t m_valueOffset; //Attribute value or text.
+	uint32_t m_valueLength;
+};
+
+
+//-----------------------------------------------------------------------------
+struct CookedXMLStats
+{
+	CookedXMLStats() : numCacheHits( 0 ), numCacheMisses( 0 ), numCookFailures( 0 ) {}
+
+	unsigned int numCacheHits;
+	unsigned int numCacheMisses; //Stale, missing, or corrupt blobs that fell back to the XML path.
+	unsigned int numCookFailures;
+};
+
+
+//-----------------------------------------------------------------------------
+bool				LoadCookedXML( const std::string& xmlFilePath, std::vector< unsigned char >& out_cookedBlob ); //False if missing, stale, or corrupt.
+bool				CookXMLStream( XMLStreamReader& sourceReader, const std::string& xmlFilePath, std::vector< unsigned char >& out_cookedBlob ); //Reads sourceReader to its end, then writes the blob to disk.
+bool				ValidateCookedXML( const std::vector< unsigned char >& cookedBlob ); //Offsets in range and elements balanced, so replay needn't check.
+std::string			GetCookedXMLPathForSource( const std::string& xmlFilePath );
+const CookedXMLStats& GetCookedXMLStats();
@@ -141,4 +141,31 @@ unsigned int CountFilesInDirectory( const std::string& relativeDirectoryPath, co
 	_findclose( searchHandle );
 
 	return foundFiles;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Modded off EnumerateFilesInDirectory.
+std::vector< std::string > EnumerateSubdirectoriesInDirectory( const std::string& relativeDirectoryPath )
+{
+	std::string					searchPathPattern = relativeDirectoryPath + "/*";
+	std::vector< std::string > foundDirectories;
+
+	int error = 0;
+	struct _finddata_t fileInfo;
+	intptr_t searchHandle = _findfirst( searchPathPattern.c_str(), &fileInfo );
+	while ( searchHandle != -1 && !error )
+	{
+		bool		isDirectory = fileInfo.attrib & _A_SUBDIR ? true : false;
+		bool		isHidden = fileInfo.attrib & _A_HIDDEN ? true : false;
+		bool		isSelfOrParent = ( strcmp( fileInfo.name, "." ) == 0 ) || ( strcmp( fileInfo.name, ".." ) == 0 );
+
+		if ( isDirectory && !isHidden && !isSelfOrParent )
+			foundDirectories.push_back( Stringf( "%s/%s", relativeDirectoryPath.c_str(), fileInfo.name ) );
+
+		error = _findnext( searchHandle, &fileInfo );
+	}
+	_findclose( searchHandle );
+
+	return foundDirectories;
 }
\ No newline at end of file
@@ -12,4 +12,5 @@ bool LoadFloatsFromTextFileIntoBuffer( const std::string& filePath, std::vector<
 bool SaveBufferToBinaryFile( const std::string& filePath, const std::vector< unsigned char >& buffer );
 bool SaveFloatsToTextFile( const std::string& filePath, const std::vector < float > & buffer );
 std::vector< std::string > EnumerateFilesInDirectory( const std::string& relativeDirectoryPath, const std::string& filePattern );
-unsigned int CountFilesInDirectory( const std::string& relativeDirectoryPath, const std::string& filePattern );
\ No newline at end of file
+unsigned int CountFilesInDirectory( const std::string& relativeDirectoryPath, const std::string& filePattern );
+std::vector< std::string > EnumerateSubdirectoriesInDirectory( const std::string& relativeDirectoryPath ); //Immediate children only, no "." or "..".
\ No newline at end of file
@@ -0,0 +1,759 @@
+#include "Engine/FileUtils/XMLStreamReader.hpp"
+#include "Engine/FileUtils/CookedXML.hpp"
+#include "Engine/FileUtils/FileUtils.hpp"
+#include "Engine/EngineCommon.hpp"
+#include "Engine/FileUtils/XMLUtils.hpp"
+#include "Engine/Core/Command.hpp"
+#include "Engine/Core/TheConsole.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline bool IsXMLWhitespace( char c )
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline bool IsXMLNameChar( char c )
+{
+	return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || ( c >= '0' && c <= '9' )
+		|| c == '_' || c == '-' || c == '.' || c == ':' || ( c & 0x80 ) != 0; //Let UTF-8 names through untouched.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline bool StartsWith( const char* cursor, const char* end, const char* prefix )
+{
+	while ( *prefix != '\0' )
+	{
+		if ( cursor >= end || *cursor != *prefix )
+			return false;
+
+		++cursor;
+		++prefix;
+	}
+
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static char* EncodeUTF8( unsigned int codePoint, char* out )
+{
+	if ( codePoint < 0x80 )
+	{
+		*out++ = (char)codePoint;
+	}
+	else if ( codePoint < 0x800 )
+	{
+		*out++ = (char)( 0xC0 | ( codePoint >> 6 ) );
+		*out++ = (char)( 0x80 | ( codePoint & 0x3F ) );
+	}
+	else if ( codePoint < 0x10000 )
+	{
+		*out++ = (char)( 0xE0 | ( codePoint >> 12 ) );
+		*out++ = (char)( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) );
+		*out++ = (char)( 0x80 | ( codePoint & 0x3F ) );
+	}
+	else
+	{
+		*out++ = (char)( 0xF0 | ( codePoint >> 18 ) );
+		*out++ = (char)( 0x80 | ( ( codePoint >> 12 ) & 0x3F ) );
+		*out++ = (char)( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) );
+		*out++ = (char)( 0x80 | ( codePoint & 0x3F ) );
+	}
+
+	return out;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+XMLStreamReader::XMLStreamReader()
+	: m_cursor( nullptr )
+	, m_end( nullptr )
+	, m_token( XML_TOKEN_END_OF_DOCUMENT )
+	, m_depth( 0 )
+	, m_lineNumber( 0 )
+	, m_hasPendingEndElement( false )
+	, m_errorMessage( nullptr )
+	, m_numAttributes( 0 )
+	, m_cookedRecord( nullptr )
+	, m_cookedRecordsEnd( nullptr )
+	, m_cookedStringPool( nullptr )
+{
+	m_openElementNames.reserve( INITIAL_MAX_DEPTH );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool XMLStreamReader::OpenFile( const std::string& filePath )
+{
+	m_buffer.clear();
+	if ( !LoadBinaryFileIntoBuffer( filePath, m_buffer ) )
+	{
+		BeginDocument();
+		SetError( "Could not open file" );
+		return false;
+	}
+
+	BeginDocument();
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void XMLStreamReader::OpenBuffer( const char* data, size_t numBytes )
+{
+	m_buffer.assign( (const unsigned char*)data, (const unsigned char*)data + numBytes );
+	BeginDocument();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool XMLStreamReader::OpenFileCooked( const std::string& filePath )
+{
+#ifdef XML_COOKING_ENABLED
+	if ( LoadCookedXML( filePath, m_buffer ) )
+	{
+		BeginCookedDocument();
+		return true;
+	}
+
+	if ( !OpenFile( filePath ) )
+		return false;
+
+	std::vector< unsigned char > cookedBlob;
+	if ( !CookXMLStream( *this, filePath, cookedBlob ) )
+	{
+		OpenFile( filePath ); //Rewound, so the caller's reads hit the parse error where the source has it.
+		return true;
+	}
+
+	m_buffer.swap( cookedBlob );
+	BeginCookedDocument();
+	return true;
+#else
+	return OpenFile( filePath );
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void XMLStreamReader::BeginCookedDocument()
+{
+	BeginDocument();
+
+	const CookedXMLHeader* header = reinterpret_cast<const CookedXMLHeader*>( m_buffer.data() );
+	m_cookedRecord = reinterpret_cast<const CookedXMLRecord*>( header + 1 );
+	m_cookedRecordsEnd = m_cookedRecord + header->m_numRecords;
+	m_cookedStringPool = reinterpret_cast<const char*>( m_cookedRecordsEnd );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void XMLStreamReader::BeginDocument()
+{
+	m_buffer.push_back( '\0' ); //Not part of the document, just lets the lookahead checks peek one past safely.
+
+	m_cursor = (char*)m_buffer.data();
+	m_end = m_cursor + m_buffer.size() - 1;
+	if ( StartsWith( m_cursor, m_end, "\xEF\xBB\xBF" ) ) //UTF-8 BOM.
+		m_cursor += 3;
+
+	m_token = XML_TOKEN_NONE;
+	m_name = StringView();
+	m_text = StringView();
+	m_depth = 0;
+	m_lineNumber = 0;
+	m_hasPendingEndElement = false;
+	m_errorMessage = nullptr;
+	m_openElementNames.clear();
+	m_numAttributes = 0;
+	m_cookedRecord = nullptr;
+	m_cookedRecordsEnd = nullptr;
+	m_cookedStringPool = nullptr;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+XMLStreamToken XMLStreamReader::SetError( const char* errorMessage )
+{
+	//Counting lines as we go would tax every token for the sake of the rare bad file, so count once here instead.
+	m_lineNumber = 1;
+	for ( const char* scan = (const char*)m_buffer.data(); scan < m_cursor; ++scan )
+	{
+		if ( *scan == '\n' )
+			++m_lineNumber;
+	}
+
+	m_errorMessage = errorMessage;
+	m_token = XML_TOKEN_ERROR;
+	return m_token;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+XMLStreamToken XMLStreamReader::ReadNext()
+{
+	if ( m_token == XML_TOKEN_ERROR || m_token == XML_TOKEN_END_OF_DOCUMENT )
+		return m_token;
+
+	if ( m_cookedRecord != nullptr )
+		return ReadNextCookedRecord();
+
+	if ( m_hasPendingEndElement ) //Second half of <Tag/>, keeps m_name.
+	{
+		m_hasPendingEndElement = false;
+		m_numAttributes = 0;
+		m_token = XML_TOKEN_END_ELEMENT;
+		return m_token;
+	}
+
+	if ( m_token == XML_TOKEN_END_ELEMENT ) //Depth of an END is its element's, so only leave it now.
+	{
+		--m_depth;
+		m_openElementNames.pop_back();
+	}
+
+	m_numAttributes = 0;
+	m_text = StringView();
+
+	for ( ;; )
+	{
+		if ( m_cursor >= m_end )
+		{
+			if ( m_depth > 0 )
+				return SetError( "Unexpected end of document inside an element" );
+
+			m_token = XML_TOKEN_END_OF_DOCUMENT;
+			return m_token;
+		}
+
+		if ( *m_cursor != '<' )
+		{
+			if ( ParseText() )
+				return m_token;
+
+			continue;
+		}
+
+		if ( StartsWith( m_cursor, m_end, "<!--" ) )
+		{
+			if ( !SkipPast( "-->" ) )
+				return SetError( "Unterminated comment" );
+		}
+		else if ( StartsWith( m_cursor, m_end, "<![CDATA[" ) )
+		{
+			char* cdataStart = m_cursor + 9;
+			m_cursor = cdataStart;
+			if ( !SkipPast( "]]>" ) )
+				return SetError( "Unterminated CDATA section" );
+
+			m_text = StringView( cdataStart, ( m_cursor - 3 ) - cdataStart ); //CDATA is raw, no entity decoding.
+			m_token = XML_TOKEN_TEXT;
+			return m_token;
+		}
+		else if ( StartsWith( m_cursor, m_end, "<?" ) )
+		{
+			if ( !SkipPast( "?>" ) )
+				return SetError( "Unterminated processing instruction" );
+		}
+		else if ( StartsWith( m_cursor, m_end, "<!" ) ) //DOCTYPE, without internal subsets.
+		{
+			if ( !SkipPast( ">" ) )
+				return SetError( "Unterminated declaration" );
+		}
+		else if ( StartsWith( m_cursor, m_end, "</" ) )
+		{
+			if ( !ParseEndElement() )
+				return m_token;
+
+			m_token = XML_TOKEN_END_ELEMENT;
+			return m_token;
+		}
+		else
+		{
+			if ( !ParseStartElement() )
+				return m_token;
+
+			m_token = XML_TOKEN_START_ELEMENT;
+			return m_token;
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+XMLStreamToken XMLStreamReader::ReadNextCookedRecord()
+{
+	if ( m_token == XML_TOKEN_END_ELEMENT )
+		--m_depth;
+
+	m_numAttributes = 0;
+	m_text = StringView();
+
+	if ( m_cookedRecord == m_cookedRecordsEnd )
+	{
+		m_token = XML_TOKEN_END_OF_DOCUMENT;
+		return m_token;
+	}
+
+	//ValidateCookedXML already range checked every offset and balanced the elements, so nothing's checked here.
+	const CookedXMLRecord& record = *m_cookedRecord++;
+	switch ( record.m_type )
+	{
+	case COOKED_XML_RECORD_START_ELEMENT:
+		m_name = StringView( m_cookedStringPool + record.m_nameOffset, record.m_nameLength );
+		while ( m_cookedRecord != m_cookedRecordsEnd && m_cookedRecord->m_type == COOKED_XML_RECORD_ATTRIBUTE )
+		{
+			m_attributeNames[ m_numAttributes ] = StringView( m_cookedStringPool + m_cookedRecord->m_nameOffset, m_cookedRecord->m_nameLength );
+			m_attributeValues[ m_numAttributes ] = StringView( m_cookedStringPool + m_cookedRecord->m_valueOffset, m_cookedRecord->m_valueLength );
+			++m_numAttributes;
+			++m_cookedRecord;
+		}
+		++m_depth;
+		m_token = XML_TOKEN_START_ELEMENT;
+		break;
+	case COOKED_XML_RECORD_END_ELEMENT:
+		m_name = StringView( m_cookedStringPool + record.m_nameOffset, record.m_nameLength );
+		m_token = XML_TOKEN_END_ELEMENT;
+		break;
+	default: //Text, since attributes are taken with their element.
+		m_text = StringView( m_cookedStringPool + record.m_valueOffset, record.m_valueLength );
+		m_token = XML_TOKEN_TEXT;
+		break;
+	}
+
+	return m_token;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool XMLStreamReader::ReadToNextStartElement( const StringView& name /*= StringView()*/ )
+{
+	for ( ;; )
+	{
+		XMLStreamToken token = ReadNext();
+		if ( token == XML_TOKEN_ERROR || token == XML_TOKEN_END_OF_DOCUMENT )
+			return false;
+
+		if ( token == XML_TOKEN_START_ELEMENT && ( name.IsNull() || m_name == name ) )
+			return true;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool XMLStreamReader::ReadToNextChildElement( int parentDepth, const StringView& name /*= StringView()*/ )
+{
+	for ( ;; )
+	{
+		XMLStreamToken token = ReadNext();
+		if ( token == XML_TOKEN_ERROR || token == XML_TOKEN_END_OF_DOCUMENT )
+			return false;
+
+		if ( token == XML_TOKEN_END_ELEMENT && m_depth <= parentDepth )
+			return false;
+
+		if ( token == XML_TOKEN_START_ELEMENT && m_depth == parentDepth + 1 && ( name.IsNull() || m_name == name ) )
+			return true;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void XMLStreamReader::SkipElement()
+{
+	if ( m_token != XML_TOKEN_START_ELEMENT )
+		return;
+
+	const int elementDepth = m_depth;
+	for ( ;; )
+	{
+		XMLStreamToken token = ReadNext();
+		if ( token == XML_TOKEN_ERROR || token == XML_TOKEN_END_OF_DOCUMENT )
+			return;
+
+		if ( token == XML_TOKEN_END_ELEMENT && m_depth == elementDepth )
+			return;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+StringView XMLStreamReader::GetAttribute( const StringView& attributeName ) const
+{
+	for ( int attributeIndex = 0; attributeIndex < m_numAttributes; attributeIndex++ )
+	{
+		if ( m_attributeNames[ attributeIndex ] == attributeName )
+			return m_attributeValues[ attributeIndex ];
+	}
+
+	return StringView();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool XMLStreamReader::SkipPast( const char* terminator )
+{
+	while ( m_cursor < m_end )
+	{
+		if ( StartsWith( m_cursor, m_end, terminator ) )
+		{
+			m_cursor += strlen( terminator );
+			return true;
+		}
+		++m_cursor;
+	}
+
+	return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void XMLStreamReader::SkipWhitespace()
+{
+	while ( m_cursor < m_end && IsXMLWhitespace( *m_cursor ) )
+		++m_cursor;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+StringView XMLStreamReader::ParseName()
+{
+	char* nameStart = m_cursor;
+	while ( m_cursor < m_end && IsXMLNameChar( *m_cursor ) )
+		++m_cursor;
+
+	return StringView( nameStart, m_cursor - nameStart );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool XMLStreamReader::ParseStartElement()
+{
+	++m_cursor; //'<'
+	m_name = ParseName();
+	if ( m_name.IsEmpty() )
+	{
+		SetError( "Expected element name after '<'" );
+		return false;
+	}
+
+	for ( ;; )
+	{
+		SkipWhitespace();
+		if ( m_cursor >= m_end )
+		{
+			SetError( "Unterminated start tag" );
+			return false;
+		}
+
+		if ( *m_cursor == '>' )
+		{
+			++m_cursor;
+			break;
+		}
+
+		if ( StartsWith( m_cursor, m_end, "/>" ) )
+		{
+			m_cursor += 2;
+			m_hasPendingEndElement = true;
+			break;
+		}
+
+		StringView attributeName = ParseName();
+		if ( attributeName.IsEmpty() )
+		{
+			SetError( "Expected attribute name" );
+			return false;
+		}
+
+		SkipWhitespace();
+		if ( m_cursor >= m_end || *m_cursor != '=' )
+		{
+			SetError( "Expected '=' after attribute name" );
+			return false;
+		}
+		++m_cursor;
+
+		SkipWhitespace();
+		if ( m_cursor >= m_end || ( *m_cursor != '"' && *m_cursor != '\'' ) )
+		{
+			SetError( "Expected quoted attribute value" );
+			return false;
+		}
+
+		const char quote = *m_cursor++;
+		char* valueStart = m_cursor;
+		while ( m_cursor < m_end && *m_cursor != quote )
+			++m_cursor;
+
+		if ( m_cursor >= m_end )
+		{
+			SetError( "Unterminated attribute value" );
+			return false;
+		}
+
+		char* valueEnd = m_cursor++;
+		if ( m_numAttributes >= MAX_ATTRIBUTES_PER_ELEMENT )
+		{
+			SetError( "Too many attributes on one element, raise MAX_ATTRIBUTES_PER_ELEMENT" );
+			return false;
+		}
+
+		m_attributeNames[ m_numAttributes ] = attributeName;
+		m_attributeValues[ m_numAttributes ] = DecodeEntitiesInPlace( valueStart, valueEnd );
+		++m_numAttributes;
+	}
+
+	++m_depth;
+	m_openElementNames.push_back( m_name ); //Names are never decoded in place, so this stays valid.
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool XMLStreamReader::ParseEndElement()
+{
+	m_cursor += 2; //"</"
+	m_name = ParseName();
+
+	SkipWhitespace();
+	if ( m_cursor >= m_end || *m_cursor != '>' )
+	{
+		SetError( "Malformed end tag" );
+		return false;
+	}
+	++m_cursor;
+
+	if ( m_depth <= 0 )
+	{
+		SetError( "End tag with no open element" );
+		return false;
+	}
+
+	if ( m_name != m_openElementNames.back() )
+	{
+		SetError( "End tag doesn't match the open element's start tag" );
+		return false;
+	}
+
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool XMLStreamReader::ParseText()
+{
+	char* textStart = m_cursor;
+	while ( m_cursor < m_end && *m_cursor != '<' )
+		++m_cursor;
+
+	StringView trimmed = StringView( textStart, m_cursor - textStart ).GetTrimmed();
+	if ( trimmed.IsEmpty() ) //Indentation between tags.
+		return false;
+
+	char* trimmedStart = textStart + ( trimmed.begin() - textStart );
+	m_text = DecodeEntitiesInPlace( trimmedStart, trimmedStart + trimmed.size() );
+	m_token = XML_TOKEN_TEXT;
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Every entity is at least as long as what it decodes to, so this can safely write over its own input.
+StringView XMLStreamReader::DecodeEntitiesInPlace( char* first, char* last )
+{
+	char* read = first;
+	while ( read < last && *read != '&' )
+		++read;
+
+	if ( read == last ) //Common case, nothing to rewrite.
+		return StringView( first, last - first );
+
+	char* write = read;
+	while ( read < last )
+	{
+		if ( *read != '&' )
+		{
+			*write++ = *read++;
+			continue;
+		}
+
+		char* semicolon = read + 1;
+		while ( semicolon < last && *semicolon != ';' )
+			++semicolon;
+
+		if ( semicolon >= last ) //Stray '&': keep it, as XMLParser does.
+		{
+			*write++ = *read++;
+			continue;
+		}
+
+		StringView entity( read + 1, semicolon - ( read + 1 ) );
+		if ( entity == "lt" )
+			*write++ = '<';
+		else if ( entity == "gt" )
+			*write++ = '>';
+		else if ( entity == "amp" )
+			*write++ = '&';
+		else if ( entity == "quot" )
+			*write++ = '"';
+		else if ( entity == "apos" )
+			*write++ = '\'';
+		else if ( entity.size() > 1 && entity[ 0 ] == '#' )
+		{
+			bool isHex = ( entity[ 1 ] == 'x' || entity[ 1 ] == 'X' );
+			unsigned int codePoint = 0;
+			for ( size_t charIndex = isHex ? 2 : 1; charIndex < entity.size(); charIndex++ )
+			{
+				char c = entity[ charIndex ];
+				unsigned int digit;
+				if ( c >= '0' && c <= '9' )
+					digit = (unsigned int)( c - '0' );
+				else if ( isHex && c >= 'a' && c <= 'f' )
+					digit = (unsigned int)( c - 'a' + 10 );
+				else if ( isHex && c >= 'A' && c <= 'F' )
+					digit = (unsigned int)( c - 'A' + 10 );
+				else
+					break;
+
+				codePoint = codePoint * ( isHex ? 16 : 10 ) + digit;
+				if ( codePoint > 0x10FFFF )
+					break;
+			}
+
+			write = EncodeUTF8( ( codePoint <= 0x10FFFF ) ? codePoint : (unsigned int)'?', write );
+		}
+		else //Unknown named entity, leave it as written.
+		{
+			while ( read <= semicolon )
+				*write++ = *read++;
+			continue;
+		}
+
+		read = semicolon + 1;
+	}
+
+	return StringView( first, write - first );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const char* XML_STREAM_TEST_DOCUMENT =
+	"<?xml version=\"1.0\"?>\n"
+	"<!-- Skipped. -->\n"
+	"<Root label=\"Salt &amp; Pepper\" glyphs='&#65;&#x42;&lt;'>\n"
+	"\t<Item/>\n"
+	"\t<Text>x &lt; y<![CDATA[<raw&amp;>]]></Text>\n"
+	"\t<Bullet speed=\"fast\" count=\"3x\" delay=\" 0.5 \"/>\n"
+	"</Root>\n";
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Reads the document through to its end, true if the reader stopped on an error rather than finishing.
+static bool DoesStreamReadFail( const char* document )
+{
+	XMLStreamReader reader;
+	reader.OpenBuffer( document, strlen( document ) );
+
+	XMLStreamToken token;
+	do
+	{
+		token = reader.ReadNext();
+	} while ( token != XML_TOKEN_ERROR && token != XML_TOKEN_END_OF_DOCUMENT );
+
+	return token == XML_TOKEN_ERROR;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool RunXMLStreamReaderTest()
+{
+	struct ExpectedToken { XMLStreamToken m_token; const char* m_nameOrText; int m_depth; };
+	const ExpectedToken expectedTokens[] =
+	{
+		{ XML_TOKEN_START_ELEMENT, "Root", 1 },
+		{ XML_TOKEN_START_ELEMENT, "Item", 2 },
+		{ XML_TOKEN_END_ELEMENT, "Item", 2 },
+		{ XML_TOKEN_START_ELEMENT, "Text", 2 },
+		{ XML_TOKEN_TEXT, "x < y", 2 },
+		{ XML_TOKEN_TEXT, "<raw&amp;>", 2 },
+		{ XML_TOKEN_END_ELEMENT, "Text", 2 },
+		{ XML_TOKEN_START_ELEMENT, "Bullet", 2 },
+		{ XML_TOKEN_END_ELEMENT, "Bullet", 2 },
+		{ XML_TOKEN_END_ELEMENT, "Root", 1 },
+		{ XML_TOKEN_END_OF_DOCUMENT, "", 0 },
+	};
+	const int numExpectedTokens = sizeof( expectedTokens ) / sizeof( expectedTokens[ 0 ] );
+
+	XMLResults parseResults;
+	XMLNode rootNode = XMLNode::parseString( XML_STREAM_TEST_DOCUMENT, "Root", &parseResults );
+
+	XMLStreamReader reader;
+	reader.OpenBuffer( XML_STREAM_TEST_DOCUMENT, strlen( XML_STREAM_TEST_DOCUMENT ) );
+	bool areTokensRight = true;
+	bool doAttributesMatchXMLNode = ( parseResults.error == eXMLErrorNone );
+	for ( int tokenIndex = 0; tokenIndex < numExpectedTokens; tokenIndex++ )
+	{
+		const ExpectedToken& expected = expectedTokens[ tokenIndex ];
+		XMLStreamToken token = reader.ReadNext();
+		StringView nameOrText = ( token == XML_TOKEN_TEXT ) ? reader.GetText() : reader.GetName();
+		if ( ( token != expected.m_token ) || ( reader.GetDepth() != expected.m_depth ) || ( ( token != XML_TOKEN_END_OF_DOCUMENT ) && ( nameOrText != expected.m_nameOrText ) ) )
+		{
+			g_theConsole->Printf( "XMLStreamReaderTest: token %d was %d \"%s\" at depth %d, expected %d \"%s\" at depth %d%s%s", tokenIndex, token, nameOrText.ToString().c_str(),
+								  reader.GetDepth(), expected.m_token, expected.m_nameOrText, expected.m_depth, ( token == XML_TOKEN_ERROR ) ? ": " : "", ( token == XML_TOKEN_ERROR ) ? reader.GetErrorMessage() : "" );
+			areTokensRight = false;
+			break;
+		}
+
+		if ( ( token == XML_TOKEN_START_ELEMENT ) && ( reader.GetName() == "Root" ) && doAttributesMatchXMLNode )
+		{
+			doAttributesMatchXMLNode = ( reader.GetAttribute( "label" ) == StringView( rootNode.getAttribute( "label" ) ) )
+				&& ( reader.GetAttribute( "glyphs" ) == StringView( rootNode.getAttribute( "glyphs" ) ) );
+		}
+	}
+	g_theConsole->Printf( "XMLStreamReaderTest: tokens, entities and CDATA: %s", areTokensRight ? "PASS" : "FAIL" );
+	g_theConsole->Printf( "XMLStreamReaderTest: decoded attributes match XMLNode's: %s", doAttributesMatchXMLNode ? "PASS" : "FAIL" );
+
+	const char* malformedDocuments[] = { "<a></b>", "<a><b></a></b>", "<a><b></b>", "</a>", "<a><b/></A>" };
+	bool areMalformedRejected = true;
+	for ( const char* malformedDocument : malformedDocuments )
+	{
+		if ( !DoesStreamReadFail( malformedDocument ) )
+		{
+			g_theConsole->Printf( "XMLStreamReaderTest: %s was read without an error", malformedDocument );
+			areMalformedRejected = false;
+		}
+	}
+	bool isWellFormedAccepted = !DoesStreamReadFail( "<a><b><a/></b><b></b></a>" );
+	g_theConsole->Printf( "XMLStreamReaderTest: mismatched and unclosed tags error, nested same names don't: %s", ( areMalformedRejected && isWellFormedAccepted ) ? "PASS" : "FAIL" );
+
+	//The literal-name overload parses with FromChars, the std::string one with atof/atoi: malformed text must still come out the same.
+	bool doOverloadsAgree = false;
+	if ( parseResults.error == eXMLErrorNone )
+	{
+		XMLNode bulletNode = rootNode.getChildNode( "Bullet" );
+		doOverloadsAgree = ( ReadXMLAttribute( bulletNode, "speed", 1.f ) == ReadXMLAttribute( bulletNode, std::string( "speed" ), 1.f ) )
+			&& ( ReadXMLAttribute( bulletNode, "count", 7 ) == ReadXMLAttribute( bulletNode, std::string( "count" ), 7 ) )
+			&& ( ReadXMLAttribute( bulletNode, "delay", 1.f ) == ReadXMLAttribute( bulletNode, std::string( "delay" ), 1.f ) )
+			&& ( ReadXMLAttribute( bulletNode, "missing", 2.f ) == ReadXMLAttribute( bulletNode, std::string( "missing" ), 2.f ) );
+	}
+	g_theConsole->Printf( "XMLStreamReaderTest: ReadXMLAttribute gives the same for literal and std::string names on malformed values: %s", doOverloadsAgree ? "PASS" : "FAIL" );
+
+	if ( parseResults.error == eXMLErrorNone )
+		DestroyXMLDocument( rootNode );
+
+	bool didPass = areTokensRight && doAttributesMatchXMLNode && areMalformedRejected && isWellFormedAccepted && doOverloadsAgree;
+	g_theConsole->Printf( "XMLStreamReaderTest: %s", didPass ? "PASS" : "FAIL" );
+	return didPass;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void XMLStreamReaderTest( Command& )
+{
+	RunXMLStreamReaderTest();
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+
+#include "Engine/String/StringView.hpp"
+#include "Engine/String/FromChars.hpp"
+#include <vector>
+
+
+//-----------------------------------------------------------------------------
+struct CookedXMLRecord;
+
+
+//-----------------------------------------------------------------------------
+enum XMLStreamToken
+{
+	XML_TOKEN_NONE,
+	XML_TOKEN_START_ELEMENT, //Name and attributes valid until the next ReadNext().
+	XML_TOKEN_END_ELEMENT, //Also sent right after START_ELEMENT for self-closing <Tag/>.
+	XML_TOKEN_TEXT, //Non-whitespace character data or CDATA, entities already decoded.
+	XML_TOKEN_END_OF_DOCUMENT,
+	XML_TOKEN_ERROR
+};
+
+
+//-----------------------------------------------------------------------------
+//Pull-mode reader for definition files too large to want a whole XMLNode DOM for.
+//Owns one copy of the file and tokenizes it in place, so names, attributes and text come back as StringViews into it:
+//nothing is allocated per element. Comments, <?...?> and <!DOCTYPE> are skipped. Not a validating parser, but end tags
+//must match their start tags.
+//
+//	XMLStreamReader reader;
+//	reader.OpenFile( "Data/XML/Bullets.xml" );
+//	while ( reader.ReadToNextStartElement( "Bullet" ) )
+//		float speed = reader.ReadAttribute( "speed", 1.f );
+//
+//Or to walk one element's children, as the definition loaders do:
+//	int parentDepth = reader.GetDepth();
+//	while ( reader.ReadToNextChildElement( parentDepth, "Spawn" ) )
+//		...
+class XMLStreamReader
+{
+public:
+	XMLStreamReader();
+	bool OpenFile( const std::string& filePath );
+	void OpenBuffer( const char* data, size_t numBytes ); //Copies, since tokenizing decodes entities in place.
+	bool OpenFileCooked( const std::string& filePath ); //Replays the file's cooked records, recooking them first if stale. See CookedXML.hpp.
+
+	XMLStreamToken ReadNext();
+	bool ReadToNextStartElement( const StringView& name = StringView() ); //Any name if null. Returns false at end of document or on error.
+	bool ReadToNextChildElement( int parentDepth, const StringView& name = StringView() ); //Skips deeper elements. False once the parent ends, or on error.
+	void SkipElement(); //Call on START_ELEMENT to jump past its matching END_ELEMENT.
+
+	XMLStreamToken GetToken() const { return m_token; }
+	StringView GetName() const { return m_name; }
+	StringView GetText() const { return m_text; }
+	int GetDepth() const { return m_depth; } //Of the current element, root == 1.
+	int GetLineNumber() const { return m_lineNumber; } //Only tracked for errors, 0 otherwise.
+	const char* GetErrorMessage() const { return m_errorMessage; }
+
+	int GetNumAttributes() const { return m_numAttributes; }
+	StringView GetAttributeName( int attributeIndex ) const { return m_attributeNames[ attributeIndex ]; }
+	StringView GetAttributeValue( int attributeIndex ) const { return m_attributeValues[ attributeIndex ]; }
+	StringView GetAttribute( const StringView& attributeName ) const; //IsNull() if absent.
+
+	template < typename ValueType > ValueType ReadAttribute( const char* attributeName, const ValueType& defaultValue ) const
+	{
+		StringView valueText = GetAttribute( attributeName );
+		ValueType outValue = defaultValue;
+		if ( valueText.IsNull() || !ParseFromStringView( valueText, outValue ) )
+			return defaultValue;
+
+		return outValue;
+	}
+
+	static const int MAX_ATTRIBUTES_PER_ELEMENT = 32;
+	static const int INITIAL_MAX_DEPTH = 32; //Reserved up front: only deeper nesting allocates.
+
+
+private:
+	void BeginDocument();
+	void BeginCookedDocument(); //m_buffer holds a validated cooked blob.
+	XMLStreamToken ReadNextCookedRecord();
+	XMLStreamToken SetError( const char* errorMessage );
+	bool SkipPast( const char* terminator );
+	bool ParseStartElement();
+	bool ParseEndElement();
+	bool ParseText(); //False if it was only whitespace.
+	StringView ParseName();
+	StringView DecodeEntitiesInPlace( char* first, char* last );
+	void SkipWhitespace();
+
+	std::vector< unsigned char > m_buffer; //Null-terminated copy of the document, tokenized in place.
+	char* m_cursor;
+	char* m_end;
+
+	XMLStreamToken m_token;
+	StringView m_name;
+	StringView m_text;
+	int m_depth;
+	int m_lineNumber;
+	bool m_hasPendingEndElement; //For self-closing tags.
+	const char* m_errorMessage;
+
+	std::vector< StringView > m_openElementNames; //One per depth, for matching end tags. Kept across documents, so only grows.
+
+	const CookedXMLRecord* m_cookedRecord; //Next to replay, or null when tokenizing source XML.
+	const CookedXMLRecord* m_cookedRecordsEnd;
+	const char* m_cookedStringPool;
+
+	int m_numAttributes;
+	StringView m_attributeNames[ MAX_ATTRIBUTES_PER_ELEMENT ];
+	StringView m_attributeValues[ MAX_ATTRIBUTES_PER_ELEMENT ];
+};
+
+
+//-----------------------------------------------------------------------------
+class Command;
+bool RunXMLStreamReaderTest(); //Runs XMLStreamReaderTest's cases, false on any failure.
+void XMLStreamReaderTest( Command& args ); //XMLStreamReaderTest: tokens, entities, tag mismatches, and attribute parsing against the XMLNode path.
@@ -119,6 +119,35 @@ std::string GetXMLAttributeAsString( const XMLNode& node, const std::string& att
 
 
 
+///------------------------------------------------------------------
+/// Same lookup order as GetXMLAttributeAsString, minus the copies:
+/// the view points into the node's own strings and lives as long as it does.
+///------------------------------------------------------------------
+StringView GetXMLAttributeAsStringView( const XMLNode& node, const char* attributeName )
+{
+	XMLCSTR attributeValue = node.getAttribute( attributeName );
+	if ( attributeValue != nullptr )
+	{
+		node.markUsed();
+		return StringView( attributeValue );
+	}
+
+	XMLNode childNode = node.getChildNode( attributeName );
+	if ( childNode.hasText() )
+	{
+		node.markUsed();
+		return StringView( childNode.getText() );
+	}
+	else if ( !childNode.isEmpty() )
+	{
+		node.markUsed();
+		return GetXMLAttributeAsStringView( childNode, "value" );
+	}
+
+	return StringView();
+}
+
+
 ///----------------------------------------------------------
 /// Retrieves the childNode with the specified name at the 
 /// specified position of the parent.  Returns true if the child
@@ -10,6 +10,7 @@
 #include <string>
 #include "ThirdParty/Parsers/xmlparser/xmlParser.h"
 #include "Engine/String/StringUtils.hpp"
+#include "Engine/String/FromChars.hpp"
 
 
 //================================================================================================================================
@@ -19,6 +20,7 @@ std::string			GetXMLErrorDescForErrorCode( XMLError xmlErrorCode );
 bool				GetXMLNodeByNameSearchingFromPosition( const XMLNode& parentNode, const std::string& childName, int& position_inout, XMLNode& childNode_out );
 std::string			GetXMLAttributeAsString( const XMLNode& node, const std::string& attributeName, bool& wasAttributePresent_out );
 void				DestroyXMLDocument( XMLNode& xmlDocumentToDestroy );
+StringView			GetXMLAttributeAsStringView( const XMLNode& node, const char* attributeName ); //IsNull() if absent. Views xmlParser's own storage.
 
 
 ///-----------------------------------------------------------------------------------
@@ -51,6 +53,39 @@ ValueType ReadXMLAttribute( const XMLNode& node, const std::string& propertyName
 }
 
 
+///-----------------------------------------------------------------------------------
+/// What the std::string overload above would make of text FromChars rejects.
+/// Rgba and Vector3f never had a string ctor, so they keep the default instead.
+///-----------------------------------------------------------------------------------
+template< typename ValueType >
+void SetTypeFromMalformedXMLText( ValueType& outValue, const StringView& valueText )
+{
+	SetTypeFromUnwrappedString( outValue, valueText.ToString() );
+}
+inline void SetTypeFromMalformedXMLText( Rgba&, const StringView& ) {}
+inline void SetTypeFromMalformedXMLText( Vector3f&, const StringView& ) {}
+
+
+///-----------------------------------------------------------------------------------
+/// Allocation-free overload, picked over the std::string one above whenever the name's a literal/char*.
+/// Parses straight out of the node with FromChars. Text FromChars rejects goes through the std::string path's
+/// conversion instead, so malformed values give exactly what they always did (e.g. atof's 0), not defaultValue.
+///-----------------------------------------------------------------------------------
+template< typename ValueType >
+ValueType ReadXMLAttribute( const XMLNode& node, const char* attributeName, const ValueType& defaultValue )
+{
+	StringView	valueText = GetXMLAttributeAsStringView( node, attributeName );
+	if ( valueText.IsNull() )
+		return defaultValue;
+
+	ValueType	outValue = defaultValue;
+	if ( !ParseFromStringView( valueText, outValue ) )
+		SetTypeFromMalformedXMLText( outValue, valueText );
+
+	return outValue;
+}
+
+
 ///-----------------------------------------------------------------------------------
 ///
 ///-----------------------------------------------------------------------------------
@@ -0,0 +1,330 @@
+#include "Engine/Math/AABB2Tree.hpp"
+
+
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Error/ErrorWarningAssert.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Everything in the tree keeps mins <= maxs, so unlike DoAABBsOverlap these skip re-sorting the corners.
+static inline bool DoNormalizedBoundsOverlap( const AABB2f& a, const AABB2f& b )
+{
+	return ( a.mins.x <= b.maxs.x ) && ( b.mins.x <= a.maxs.x ) && ( a.mins.y <= b.maxs.y ) && ( b.mins.y <= a.maxs.y );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline bool DoesBoundsContain( const AABB2f& outer, const AABB2f& inner )
+{
+	return ( outer.mins.x <= inner.mins.x ) && ( outer.mins.y <= inner.mins.y ) && ( inner.maxs.x <= outer.maxs.x ) && ( inner.maxs.y <= outer.maxs.y );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline AABB2f GetBoundsUnion( const AABB2f& a, const AABB2f& b )
+{
+	return AABB2f( GetMin( a.mins.x, b.mins.x ), GetMin( a.mins.y, b.mins.y ), GetMax( a.maxs.x, b.maxs.x ), GetMax( a.maxs.y, b.maxs.y ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline float GetBoundsPerimeter( const AABB2f& bounds ) //The 2D stand-in for surface area in the insertion cost.
+{
+	return 2.f * ( ( bounds.maxs.x - bounds.mins.x ) + ( bounds.maxs.y - bounds.mins.y ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+AABB2Tree::AABB2Tree( float fatMargin )
+	: m_rootNode( NULL_PROXY )
+	, m_firstFreeNode( NULL_PROXY )
+	, m_numProxies( 0 )
+	, m_fatMargin( fatMargin )
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+int AABB2Tree::CreateProxy( const AABB2f& bounds, void* userData )
+{
+	int proxyID = AllocateNode();
+
+	Node& leaf = m_nodes[ proxyID ];
+	leaf.m_bounds = AABB2f( bounds.mins.x - m_fatMargin, bounds.mins.y - m_fatMargin, bounds.maxs.x + m_fatMargin, bounds.maxs.y + m_fatMargin );
+	leaf.m_userData = userData;
+	leaf.m_height = 0;
+
+	InsertLeaf( proxyID );
+	++m_numProxies;
+	return proxyID;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AABB2Tree::DestroyProxy( int proxyID )
+{
+	ASSERT_RETURN( ( proxyID >= 0 ) && ( proxyID < (int)m_nodes.size() ) && m_nodes[ proxyID ].IsLeaf() );
+
+	RemoveLeaf( proxyID );
+	FreeNode( proxyID );
+	--m_numProxies;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool AABB2Tree::MoveProxy( int proxyID, const AABB2f& newBounds )
+{
+	Node& leaf = m_nodes[ proxyID ];
+	if ( DoesBoundsContain( leaf.m_bounds, newBounds ) )
+		return false;
+
+	RemoveLeaf( proxyID );
+	m_nodes[ proxyID ].m_bounds = AABB2f( newBounds.mins.x - m_fatMargin, newBounds.mins.y - m_fatMargin, newBounds.maxs.x + m_fatMargin, newBounds.maxs.y + m_fatMargin );
+	InsertLeaf( proxyID );
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AABB2Tree::Clear()
+{
+	m_nodes.clear();
+	m_rootNode = NULL_PROXY;
+	m_firstFreeNode = NULL_PROXY;
+	m_numProxies = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AABB2Tree::Query( const AABB2f& bounds, AABB2TreeQueryCallback* callback, void* context ) const
+{
+	if ( m_rootNode == NULL_PROXY )
+		return;
+
+	m_queryStack.clear();
+	m_queryStack.push_back( m_rootNode );
+	while ( !m_queryStack.empty() )
+	{
+		const Node& node = m_nodes[ m_queryStack.back() ];
+		m_queryStack.pop_back();
+
+		if ( !DoNormalizedBoundsOverlap( node.m_bounds, bounds ) )
+			continue;
+
+		if ( node.IsLeaf() )
+		{
+			callback( node.m_userData, context );
+			continue;
+		}
+
+		m_queryStack.push_back( node.m_child1 );
+		m_queryStack.push_back( node.m_child2 );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+int AABB2Tree::AllocateNode()
+{
+	int nodeIndex;
+	if ( m_firstFreeNode != NULL_PROXY )
+	{
+		nodeIndex = m_firstFreeNode;
+		m_firstFreeNode = m_nodes[ nodeIndex ].m_parentOrNextFree;
+	}
+	else
+	{
+		nodeIndex = (int)m_nodes.size();
+		m_nodes.push_back( Node() );
+	}
+
+	Node& node = m_nodes[ nodeIndex ];
+	node.m_userData = nullptr;
+	node.m_parentOrNextFree = NULL_PROXY;
+	node.m_child1 = NULL_PROXY;
+	node.m_child2 = NULL_PROXY;
+	node.m_height = 0;
+	return nodeIndex;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AABB2Tree::FreeNode( int nodeIndex )
+{
+	m_nodes[ nodeIndex ].m_parentOrNextFree = m_firstFreeNode;
+	m_nodes[ nodeIndex ].m_height = -1;
+	m_firstFreeNode = nodeIndex;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AABB2Tree::InsertLeaf( int leafIndex )
+{
+	if ( m_rootNode == NULL_PROXY )
+	{
+		m_rootNode = leafIndex;
+		m_nodes[ leafIndex ].m_parentOrNextFree = NULL_PROXY;
+		return;
+	}
+
+	//Walk down to the sibling that grows the tree's total perimeter least: either pair with this node, or push the leaf into its cheaper child.
+	AABB2f leafBounds = m_nodes[ leafIndex ].m_bounds;
+	int siblingIndex = m_rootNode;
+	while ( !m_nodes[ siblingIndex ].IsLeaf() )
+	{
+		const Node& node = m_nodes[ siblingIndex ];
+		float perimeter = GetBoundsPerimeter( node.m_bounds );
+		float combinedPerimeter = GetBoundsPerimeter( GetBoundsUnion( node.m_bounds, leafBounds ) );
+
+		float costToPairHere = 2.f * combinedPerimeter;
+		float inheritedCost = 2.f * ( combinedPerimeter - perimeter ); //Every ancestor below here grows by this much, whichever child we descend into.
+
+		float childCosts[ 2 ];
+		int children[ 2 ] = { node.m_child1, node.m_child2 };
+		for ( unsigned int childIndex = 0; childIndex < 2; childIndex++ )
+		{
+			const Node& child = m_nodes[ children[ childIndex ] ];
+			float childCombinedPerimeter = GetBoundsPerimeter( GetBoundsUnion( child.m_bounds, leafBounds ) );
+			childCosts[ childIndex ] = inheritedCost + ( child.IsLeaf() ? childCombinedPerimeter : ( childCombinedPerimeter - GetBoundsPerimeter( child.m_bounds ) ) );
+		}
+
+		if ( ( costToPairHere < childCosts[ 0 ] ) && ( costToPairHere < childCosts[ 1 ] ) )
+			break;
+
+		siblingIndex = ( childCosts[ 0 ] < childCosts[ 1 ] ) ? children[ 0 ] : children[ 1 ];
+	}
+
+	//Replace the sibling with a new branch holding it and the leaf.
+	int oldParentIndex = m_nodes[ siblingIndex ].m_parentOrNextFree;
+	int newParentIndex = AllocateNode(); //May grow m_nodes, so no Node references are held across it.
+
+	Node& newParent = m_nodes[ newParentIndex ];
+	newParent.m_parentOrNextFree = oldParentIndex;
+	newParent.m_bounds = GetBoundsUnion( leafBounds, m_nodes[ siblingIndex ].m_bounds );
+	newParent.m_height = m_nodes[ siblingIndex ].m_height + 1;
+	newParent.m_child1 = siblingIndex;
+	newParent.m_child2 = leafIndex;
+	m_nodes[ siblingIndex ].m_parentOrNextFree = newParentIndex;
+	m_nodes[ leafIndex ].m_parentOrNextFree = newParentIndex;
+
+	if ( oldParentIndex == NULL_PROXY )
+		m_rootNode = newParentIndex;
+	else if ( m_nodes[ oldParentIndex ].m_child1 == siblingIndex )
+		m_nodes[ oldParentIndex ].m_child1 = newParentIndex;
+	else
+		m_nodes[ oldParentIndex ].m_child2 = newParentIndex;
+
+	RefitAncestors( m_nodes[ leafIndex ].m_parentOrNextFree );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AABB2Tree::RemoveLeaf( int leafIndex )
+{
+	if ( leafIndex == m_rootNode )
+	{
+		m_rootNode = NULL_PROXY;
+		return;
+	}
+
+	//The leaf's parent branch goes too, its other child taking its place.
+	int parentIndex = m_nodes[ leafIndex ].m_parentOrNextFree;
+	int grandparentIndex = m_nodes[ parentIndex ].m_parentOrNextFree;
+	int siblingIndex = ( m_nodes[ parentIndex ].m_child1 == leafIndex ) ? m_nodes[ parentIndex ].m_child2 : m_nodes[ parentIndex ].m_child1;
+
+	m_nodes[ siblingIndex ].m_parentOrNextFree = grandparentIndex;
+	FreeNode( parentIndex );
+
+	if ( grandparentIndex == NULL_PROXY )
+	{
+		m_rootNode = siblingIndex;
+		return;
+	}
+
+	if ( m_nodes[ grandparentIndex ].m_child1 == parentIndex )
+		m_nodes[ grandparentIndex ].m_child1 = siblingIndex;
+	else
+		m_nodes[ grandparentIndex ].m_child2 = siblingIndex;
+
+	RefitAncestors( grandparentIndex );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AABB2Tree::RefitAncestors( int nodeIndex )
+{
+	while ( nodeIndex != NULL_PROXY )
+	{
+		nodeIndex = Balance( nodeIndex );
+
+		Node& node = m_nodes[ nodeIndex ];
+		const Node& child1 = m_nodes[ node.m_child1 ];
+		const Node& child2 = m_nodes[ node.m_child2 ];
+		node.m_bounds = GetBoundsUnion( child1.m_bounds, child2.m_bounds );
+		node.m_height = 1 + GetMax( child1.m_height, child2.m_height );
+
+		nodeIndex = node.m_parentOrNextFree;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+int AABB2Tree::Balance( int indexA )
+{
+	//If one of A's children, B or C, is over 1 taller than the other, the taller rotates up into A's place and A takes its taller child's place.
+	Node& A = m_nodes[ indexA ];
+	if ( A.IsLeaf() || ( A.m_height < 2 ) )
+		return indexA;
+
+	int indexB = A.m_child1;
+	int indexC = A.m_child2;
+	Node& B = m_nodes[ indexB ];
+	Node& C = m_nodes[ indexC ];
+	int heightDifference = C.m_height - B.m_height;
+	if ( ( heightDifference <= 1 ) && ( heightDifference >= -1 ) )
+		return indexA;
+
+	//Name the taller child "up" and its children F and G, mirrored when B is the taller.
+	bool isRotatingUpC = ( heightDifference > 1 );
+	int indexUp = isRotatingUpC ? indexC : indexB;
+	int indexShort = isRotatingUpC ? indexB : indexC;
+	Node& up = m_nodes[ indexUp ];
+	Node& shorter = m_nodes[ indexShort ];
+	int indexF = up.m_child1;
+	int indexG = up.m_child2;
+	Node& F = m_nodes[ indexF ];
+	Node& G = m_nodes[ indexG ];
+
+	//Swap A and up.
+	up.m_child1 = indexA;
+	up.m_parentOrNextFree = A.m_parentOrNextFree;
+	A.m_parentOrNextFree = indexUp;
+
+	if ( up.m_parentOrNextFree == NULL_PROXY )
+		m_rootNode = indexUp;
+	else if ( m_nodes[ up.m_parentOrNextFree ].m_child1 == indexA )
+		m_nodes[ up.m_parentOrNextFree ].m_child1 = indexUp;
+	else
+		m_nodes[ up.m_parentOrNextFree ].m_child2 = indexUp;
+
+	//The taller of F and G stays under up, the shorter goes to A where up was.
+	bool keepsF = ( F.m_height > G.m_height );
+	int indexKept = keepsF ? indexF : indexG;
+	int indexMoved = keepsF ? indexG : indexF;
+	Node& kept = m_nodes[ indexKept ];
+	Node& moved = m_nodes[ indexMoved ];
+
+	up.m_child2 = indexKept;
+	if ( isRotatingUpC )
+		A.m_child2 = indexMoved;
+	else
+		A.m_child1 = indexMoved;
+	moved.m_parentOrNextFree = indexA;
+
+	A.m_bounds = GetBoundsUnion( shorter.m_bounds, moved.m_bounds );
+	A.m_height = 1 + GetMax( shorter.m_height, moved.m_height );
+	up.m_bounds = GetBoundsUnion( A.m_bounds, kept.m_bounds );
+	up.m_height = 1 + GetMax( A.m_height, kept.m_height );
+
+	return indexUp;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+
+#include <vector>
+#include "Engine/EngineCommon.hpp"
+
+
+//-----------------------------------------------------------------------------
+typedef void ( AABB2TreeQueryCallback )( void* userData, void* context );
+
+
+//-----------------------------------------------------------------------------
+//Dynamic bounding volume tree: each proxy is a leaf holding a fattened copy of its bounds, and each branch the union of its two children's.
+//Insertion picks the sibling by least added perimeter and rotates to keep the tree height-balanced, so insert, remove and query are O(log n).
+//Fattening means a proxy that moves a little stays inside its leaf, making MoveProxy only an overlap test until it leaves.
+class AABB2Tree
+{
+public:
+	static const int NULL_PROXY = -1;
+
+	AABB2Tree( float fatMargin );
+
+	int CreateProxy( const AABB2f& bounds, void* userData ); //Returns the id to move or destroy it by, stable until destroyed.
+	void DestroyProxy( int proxyID );
+	bool MoveProxy( int proxyID, const AABB2f& newBounds ); //Returns whether it left its fat bounds and had to be reinserted.
+	void Clear();
+
+	void Query( const AABB2f& bounds, AABB2TreeQueryCallback* callback, void* context ) const; //Calls back with each proxy whose fat bounds overlap, in no particular order.
+
+	void* GetUserData( int proxyID ) const { return m_nodes[ proxyID ].m_userData; }
+	const AABB2f& GetFatBounds( int proxyID ) const { return m_nodes[ proxyID ].m_bounds; }
+	unsigned int GetNumProxies() const { return m_numProxies; }
+	int GetHeight() const { return ( m_rootNode == NULL_PROXY ) ? 0 : m_nodes[ m_rootNode ].m_height; }
+
+
+private:
+	struct Node
+	{
+		bool IsLeaf() const { return m_child1 == NULL_PROXY; }
+
+		AABB2f m_bounds; //Fattened for leaves.
+		void* m_userData; //Leaves only.
+		int m_parentOrNextFree; //The parent while in the tree, the next free node while in m_nodes' free list.
+		int m_child1;
+		int m_child2;
+		int m_height; //0 for leaves, -1 while free.
+	};
+
+	int AllocateNode();
+	void FreeNode( int nodeIndex );
+	void InsertLeaf( int leafIndex );
+	void RemoveLeaf( int leafIndex );
+	void RefitAncestors( int nodeIndex ); //Rebalances and recomputes the bounds and heights from nodeIndex up to the root.
+	int Balance( int nodeIndex ); //Returns the node now in nodeIndex's place.
+
+	std::vector< Node > m_nodes;
+	int m_rootNode;
+	int m_firstFreeNode;
+	unsigned int m_numProxies;
+	float m_fatMargin;
+	mutable std::vector< int > m_queryStack; //Kept to not allocate per Query, so Query is main thread only.
+};
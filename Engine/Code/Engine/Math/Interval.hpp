@@ -31,6 +31,7 @@ struct Interval
 	IntervalElement maxInclusive;
 
 	inline IntervalElement GetRandomElement() const;
+	inline IntervalElement GetRandomElement( RandomStream& randomStream ) const { return randomStream.GetElementInRange( minInclusive, maxInclusive ); }
 	inline IntervalElement Get( float t ) { return Lerp( minInclusive, maxInclusive, ClampFloatZeroToOne( t ) ); }
 };
 
@@ -43,14 +44,14 @@ template < typename IntervalElement > std::string Interval<IntervalElement>::ToS
 
 
 //--------------------------------------------------------------------------------------------------------------
-template <> std::string Interval<float>::ToString() const
+template <> inline std::string Interval<float>::ToString() const
 {
 	return Stringf( "%f~%f", minInclusive, maxInclusive );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-template <> std::string Interval<int>::ToString() const
+template <> inline std::string Interval<int>::ToString() const
 {
 	return Stringf( "%d~%d", minInclusive, maxInclusive );
 }
@@ -6,6 +6,7 @@
 #include "Engine/Math/Vector2.hpp"
 #include "Engine/Math/Vector3.hpp"
 #include "Engine/Math/Vector4.hpp"
+#include "Engine/Math/RandomStream.hpp"
 
 //-----------------------------------------------------------------------------------------------
 // Constants
@@ -113,7 +114,8 @@ float SmoothStop( float inputZeroToOne );
 
 
 //-----------------------------------------------------------------------------------------------
-// Random number utilities
+// Random number utilities: draw from the calling thread's RandomStream, so they're safe in jobs, and reseeded per job so they replay.
+//	Use a RandomStream directly to seed for replays or to fill many values at once.
 //
 float GetRandomFloatZeroTo( float maximum );
 template <typename T> T GetRandomElementInRange( T minInclusive, T maxInclusive );
@@ -389,65 +391,42 @@ inline float SmoothStop( float inputZeroToOne )
 //-----------------------------------------------------------------------------------------------
 inline int GetRandomIntInRange( int minValueInclusive, int maxValueInclusive )
 {
-	TODO( "Use a faster, better random number generator." );
-	TODO( "Use more bits for higher-range numbers." );
-	return minValueInclusive + rand() % ( 1 + maxValueInclusive - minValueInclusive );
+	return RandomStream::GetThreadLocal().GetIntInRange( minValueInclusive, maxValueInclusive );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 inline int GetRandomIntLessThan( int maxValueNotInclusive )
 {
-	TODO( "Use a faster, better random number generator." );
-	TODO( "Use more bits for higher-range numbers." );
-	return rand() % maxValueNotInclusive;
+	return RandomStream::GetThreadLocal().GetIntLessThan( maxValueNotInclusive );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 inline float GetRandomFloatZeroTo( float maximumInclusive )
 {
-	TODO( "Use a faster, better random number generator." );
-	const float oneOverRandMax = 1.f / static_cast< float >( RAND_MAX / maximumInclusive );
-	return static_cast< float >( rand() ) * oneOverRandMax;
+	return RandomStream::GetThreadLocal().GetFloatZeroTo( maximumInclusive );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 template <typename T> inline T GetRandomElementInRange( T minInclusive, T maxInclusive )
 {
-	TODO( "Use a faster, better random number generator." );
-	const float randomZeroToOne = GetRandomFloatZeroTo( 1.f );
-	return minInclusive + static_cast<T>( ( maxInclusive - minInclusive ) * randomZeroToOne );
-}
-
-
-//-----------------------------------------------------------------------------------------------
-template <> inline Vector2f GetRandomElementInRange( Vector2f minInclusive, Vector2f maxInclusive )
-{
-	TODO( "Use a faster, better random number generator." );
-	const float randomZeroToOneX = GetRandomFloatZeroTo( 1.f );
-	const float randomZeroToOneY = GetRandomFloatZeroTo( 1.f );
-	return minInclusive + Vector2f( ( maxInclusive.x - minInclusive.x ) * randomZeroToOneX, ( maxInclusive.y - minInclusive.y ) * randomZeroToOneY );
+	return RandomStream::GetThreadLocal().GetElementInRange( minInclusive, maxInclusive );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 inline float GetRandomFloatInRange( float minimumInclusive, float maximumInclusive )
 {
-	TODO( "Use a faster, better random number generator." );
-	const float randomZeroToOne = GetRandomFloatZeroTo( 1.f );
-	return minimumInclusive + ( randomZeroToOne * ( maximumInclusive - minimumInclusive ) );
+	return RandomStream::GetThreadLocal().GetFloatInRange( minimumInclusive, maximumInclusive );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 inline bool GetRandomChance( float probabilityOfReturningTrue )
 {
-	if( probabilityOfReturningTrue >= 1.f )
-		return true;
-
-	return GetRandomFloatZeroTo( 1.f ) < probabilityOfReturningTrue;
+	return RandomStream::GetThreadLocal().GetChance( probabilityOfReturningTrue );
 }
 
 
@@ -0,0 +1,524 @@
+#include "Engine/Math/Matrix44.hpp"
+
+
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/RandomStream.hpp"
+#include "Engine/Core/Command.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Time/Time.hpp"
+#include "Engine/EngineCommon.hpp"
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC const Matrix44 Matrix44::IDENTITY = Matrix44(
+	1.f, 0.f, 0.f, 0.f,
+	0.f, 1.f, 0.f, 0.f,
+	0.f, 0.f, 1.f, 0.f,
+	0.f, 0.f, 0.f, 1.f
+);
+static_assert( sizeof( Matrix44 ) == sizeof( float ) * 16, "Matrix44 arrays must upload to the card as-is, with no padding or extra members!" );
+static const int DEFAULT_MATRIX_BENCHMARK_ITERATIONS = 1000000;
+static const float MAX_INVERSE_TEST_RESIDUAL = .0001f;
+
+
+//--------------------------------------------------------------------------------------------------------------
+Matrix44::Matrix44( const float values[ 16 ] )
+{
+	memcpy( m_data, values, sizeof( m_data ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Matrix44::Matrix44( float in0, float in1, float in2, float in3, float in4, float in5, float in6, float in7,
+					float in8, float in9, float in10, float in11, float in12, float in13, float in14, float in15 )
+{
+	m_data[ 0 ] = in0;		m_data[ 1 ] = in1;		m_data[ 2 ] = in2;		m_data[ 3 ] = in3;
+	m_data[ 4 ] = in4;		m_data[ 5 ] = in5;		m_data[ 6 ] = in6;		m_data[ 7 ] = in7;
+	m_data[ 8 ] = in8;		m_data[ 9 ] = in9;		m_data[ 10 ] = in10;	m_data[ 11 ] = in11;
+	m_data[ 12 ] = in12;	m_data[ 13 ] = in13;	m_data[ 14 ] = in14;	m_data[ 15 ] = in15;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Matrix44::Matrix44( const Matrix4x4f& matrix )
+{
+	memcpy( m_data, matrix.m_data, sizeof( m_data ) );
+
+	//A COLUMN_MAJOR Matrix4x4f treats vectors as columns (M * v), so its data is this one's transpose.
+	if ( matrix.GetOrdering() == COLUMN_MAJOR )
+		Transpose();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Matrix4x4f Matrix44::GetAsMatrix4x4f( Ordering ordering /*= ROW_MAJOR*/ ) const
+{
+	if ( ordering == COLUMN_MAJOR )
+		return Matrix4x4f( GetTranspose().m_data, COLUMN_MAJOR );
+
+	return Matrix4x4f( m_data, ROW_MAJOR );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Matrix44 Matrix44::operator*( const Matrix44& rhs ) const
+{
+	//Row i of the product is row i of this, transformed by rhs. Load everything first so out can alias either side.
+	Vec4 rhsRow0 = rhs.GetRow( 0 );
+	Vec4 rhsRow1 = rhs.GetRow( 1 );
+	Vec4 rhsRow2 = rhs.GetRow( 2 );
+	Vec4 rhsRow3 = rhs.GetRow( 3 );
+
+	Matrix44 product;
+	for ( unsigned int rowIndex = 0; rowIndex < 4; rowIndex++ )
+	{
+		Vec4 lhsRow = GetRow( rowIndex );
+		product.SetRow( rowIndex, ( ( ( rhsRow0 * lhsRow.SplatX() ) + ( rhsRow1 * lhsRow.SplatY() ) ) + ( rhsRow2 * lhsRow.SplatZ() ) ) + ( rhsRow3 * lhsRow.SplatW() ) );
+	}
+	return product;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Matrix44 Matrix44::GetTranspose() const
+{
+	Matrix44 transpose( *this );
+	transpose.Transpose();
+	return transpose;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Matrix44::Transpose()
+{
+	Vec4 row0 = GetRow( 0 );
+	Vec4 row1 = GetRow( 1 );
+	Vec4 row2 = GetRow( 2 );
+	Vec4 row3 = GetRow( 3 );
+	TransposeVec4s( row0, row1, row2, row3 );
+	SetRow( 0, row0 );
+	SetRow( 1, row1 );
+	SetRow( 2, row2 );
+	SetRow( 3, row3 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool Matrix44::GetInverse( Matrix44& out_inverse ) const
+{
+	//Cramer's rule, sharing the 2x2 determinants of the top two rows (s) and bottom two rows (c) across all 16 cofactors.
+	const float* m = m_data;
+	float s0 = ( m[ 0 ] * m[ 5 ] ) - ( m[ 4 ] * m[ 1 ] );
+	float s1 = ( m[ 0 ] * m[ 6 ] ) - ( m[ 4 ] * m[ 2 ] );
+	float s2 = ( m[ 0 ] * m[ 7 ] ) - ( m[ 4 ] * m[ 3 ] );
+	float s3 = ( m[ 1 ] * m[ 6 ] ) - ( m[ 5 ] * m[ 2 ] );
+	float s4 = ( m[ 1 ] * m[ 7 ] ) - ( m[ 5 ] * m[ 3 ] );
+	float s5 = ( m[ 2 ] * m[ 7 ] ) - ( m[ 6 ] * m[ 3 ] );
+
+	float c5 = ( m[ 10 ] * m[ 15 ] ) - ( m[ 14 ] * m[ 11 ] );
+	float c4 = ( m[ 9 ] * m[ 15 ] ) - ( m[ 13 ] * m[ 11 ] );
+	float c3 = ( m[ 9 ] * m[ 14 ] ) - ( m[ 13 ] * m[ 10 ] );
+	float c2 = ( m[ 8 ] * m[ 15 ] ) - ( m[ 12 ] * m[ 11 ] );
+	float c1 = ( m[ 8 ] * m[ 14 ] ) - ( m[ 12 ] * m[ 10 ] );
+	float c0 = ( m[ 8 ] * m[ 13 ] ) - ( m[ 12 ] * m[ 9 ] );
+
+	float determinant = ( s0 * c5 ) - ( s1 * c4 ) + ( s2 * c3 ) + ( s3 * c2 ) - ( s4 * c1 ) + ( s5 * c0 );
+	if ( determinant == 0.f )
+		return false;
+	float oneOverDeterminant = 1.f / determinant;
+
+	out_inverse = Matrix44(
+		( ( m[ 5 ] * c5 ) - ( m[ 6 ] * c4 ) + ( m[ 7 ] * c3 ) ) * oneOverDeterminant,
+		( -( m[ 1 ] * c5 ) + ( m[ 2 ] * c4 ) - ( m[ 3 ] * c3 ) ) * oneOverDeterminant,
+		( ( m[ 13 ] * s5 ) - ( m[ 14 ] * s4 ) + ( m[ 15 ] * s3 ) ) * oneOverDeterminant,
+		( -( m[ 9 ] * s5 ) + ( m[ 10 ] * s4 ) - ( m[ 11 ] * s3 ) ) * oneOverDeterminant,
+
+		( -( m[ 4 ] * c5 ) + ( m[ 6 ] * c2 ) - ( m[ 7 ] * c1 ) ) * oneOverDeterminant,
+		( ( m[ 0 ] * c5 ) - ( m[ 2 ] * c2 ) + ( m[ 3 ] * c1 ) ) * oneOverDeterminant,
+		( -( m[ 12 ] * s5 ) + ( m[ 14 ] * s2 ) - ( m[ 15 ] * s1 ) ) * oneOverDeterminant,
+		( ( m[ 8 ] * s5 ) - ( m[ 10 ] * s2 ) + ( m[ 11 ] * s1 ) ) * oneOverDeterminant,
+
+		( ( m[ 4 ] * c4 ) - ( m[ 5 ] * c2 ) + ( m[ 7 ] * c0 ) ) * oneOverDeterminant,
+		( -( m[ 0 ] * c4 ) + ( m[ 1 ] * c2 ) - ( m[ 3 ] * c0 ) ) * oneOverDeterminant,
+		( ( m[ 12 ] * s4 ) - ( m[ 13 ] * s2 ) + ( m[ 15 ] * s0 ) ) * oneOverDeterminant,
+		( -( m[ 8 ] * s4 ) + ( m[ 9 ] * s2 ) - ( m[ 11 ] * s0 ) ) * oneOverDeterminant,
+
+		( -( m[ 4 ] * c3 ) + ( m[ 5 ] * c1 ) - ( m[ 6 ] * c0 ) ) * oneOverDeterminant,
+		( ( m[ 0 ] * c3 ) - ( m[ 1 ] * c1 ) + ( m[ 2 ] * c0 ) ) * oneOverDeterminant,
+		( -( m[ 12 ] * s3 ) + ( m[ 13 ] * s1 ) - ( m[ 14 ] * s0 ) ) * oneOverDeterminant,
+		( ( m[ 8 ] * s3 ) - ( m[ 9 ] * s1 ) + ( m[ 10 ] * s0 ) ) * oneOverDeterminant
+	);
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool Matrix44::GetAffineInverse( Matrix44& out_inverse ) const
+{
+	//Invert the upper 3x3 by its cofactors: each row's cross product with the next two is a column of the inverse, times 1/det.
+	Vec4 row0 = GetRow( 0 );
+	Vec4 row1 = GetRow( 1 );
+	Vec4 row2 = GetRow( 2 );
+	Vec4 inverseColumn0 = CrossProduct3( row1, row2 );
+	Vec4 inverseColumn1 = CrossProduct3( row2, row0 );
+	Vec4 inverseColumn2 = CrossProduct3( row0, row1 );
+
+	float determinant = DotProduct3( row0, inverseColumn0 );
+	if ( determinant == 0.f )
+		return false;
+	float oneOverDeterminant = 1.f / determinant;
+
+	Vec4 inverseRow0 = inverseColumn0 * oneOverDeterminant;
+	Vec4 inverseRow1 = inverseColumn1 * oneOverDeterminant;
+	Vec4 inverseRow2 = inverseColumn2 * oneOverDeterminant;
+	Vec4 inverseRow3( 0.f );
+	TransposeVec4s( inverseRow0, inverseRow1, inverseRow2, inverseRow3 ); //The cross products' w were 0, so column 3 comes out 0 too.
+
+	//Undo the translation last: it moved points after the 3x3 did, so it's un-moved before the inverse 3x3.
+	Vec4 translation = GetRow( 3 );
+	Vec4 inverseTranslation = -( ( ( inverseRow0 * translation.SplatX() ) + ( inverseRow1 * translation.SplatY() ) ) + ( inverseRow2 * translation.SplatZ() ) );
+
+	out_inverse.SetRow( 0, inverseRow0 );
+	out_inverse.SetRow( 1, inverseRow1 );
+	out_inverse.SetRow( 2, inverseRow2 );
+	out_inverse.SetRow( 3, inverseTranslation );
+	out_inverse.m_data[ 15 ] = 1.f;
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Vector3f Matrix44::TransformPoint( const Vector3f& point ) const
+{
+	return ( ( ( GetRow( 0 ) * Vec4( point.x ) ) + ( GetRow( 1 ) * Vec4( point.y ) ) ) + ( GetRow( 2 ) * Vec4( point.z ) ) + GetRow( 3 ) ).GetAsVector3f();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Vector3f Matrix44::TransformDirection( const Vector3f& direction ) const
+{
+	return Transform( Vec4( direction, 0.f ) ).GetAsVector3f();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Matrix44::TransformVectors( const Vector4f* vectors, unsigned int numVectors, Vector4f* out_vectors ) const
+{
+	Vec4 row0 = GetRow( 0 );
+	Vec4 row1 = GetRow( 1 );
+	Vec4 row2 = GetRow( 2 );
+	Vec4 row3 = GetRow( 3 );
+	for ( unsigned int vectorIndex = 0; vectorIndex < numVectors; vectorIndex++ )
+	{
+		Vec4 vector( vectors[ vectorIndex ] );
+		Vec4 transformed = ( ( ( row0 * vector.SplatX() ) + ( row1 * vector.SplatY() ) ) + ( row2 * vector.SplatZ() ) ) + ( row3 * vector.SplatW() );
+		transformed.Store( &out_vectors[ vectorIndex ].x );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Matrix44::TransformPoints( const Vector3f* points, unsigned int numPoints, Vector3f* out_points ) const
+{
+	Vec4 row0 = GetRow( 0 );
+	Vec4 row1 = GetRow( 1 );
+	Vec4 row2 = GetRow( 2 );
+	Vec4 row3 = GetRow( 3 );
+	for ( unsigned int pointIndex = 0; pointIndex < numPoints; pointIndex++ )
+	{
+		const Vector3f& point = points[ pointIndex ];
+		Vec4 transformed = ( ( ( row0 * Vec4( point.x ) ) + ( row1 * Vec4( point.y ) ) ) + ( row2 * Vec4( point.z ) ) ) + row3; //w = 1's term is row3 exactly.
+		transformed.StoreXYZ( &out_points[ pointIndex ].x );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Matrix44::TransformDirections( const Vector3f* directions, unsigned int numDirections, Vector3f* out_directions ) const
+{
+	Vec4 row0 = GetRow( 0 );
+	Vec4 row1 = GetRow( 1 );
+	Vec4 row2 = GetRow( 2 );
+	Vec4 row3TimesZero = GetRow( 3 ) * Vec4( 0.f ); //Kept rather than dropped: it's -0s and NaNs exactly where TransformVector's would be.
+	for ( unsigned int directionIndex = 0; directionIndex < numDirections; directionIndex++ )
+	{
+		const Vector3f& direction = directions[ directionIndex ];
+		Vec4 transformed = ( ( ( row0 * Vec4( direction.x ) ) + ( row1 * Vec4( direction.y ) ) ) + ( row2 * Vec4( direction.z ) ) ) + row3TimesZero;
+		transformed.StoreXYZ( &out_directions[ directionIndex ].x );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static Matrix4x4f MakeRandomMatrix4x4f( RandomStream& random, Ordering ordering )
+{
+	Matrix4x4f matrix( ordering );
+	for ( unsigned int index = 0; index < 16; index++ )
+		matrix.m_data[ index ] = random.GetFloatInRange( -10.f, 10.f );
+	return matrix;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static Matrix44 MakeRandomAffineMatrix44( RandomStream& random )
+{
+	//Rotation, nonuniform scale and translation, like a scene node's transform.
+	Vec4 iDir( random.GetUnitVector3D(), 0.f );
+	Vec4 kDir( CrossProduct( iDir.GetAsVector3f(), random.GetUnitVector3D() ), 0.f );
+	kDir = kDir * ( 1.f / sqrtf( DotProduct3( kDir, kDir ) ) );
+	Vec4 jDir = CrossProduct3( kDir, iDir );
+
+	Matrix44 matrix;
+	matrix.SetRow( 0, iDir * random.GetFloatInRange( .1f, 10.f ) );
+	matrix.SetRow( 1, jDir * random.GetFloatInRange( .1f, 10.f ) );
+	matrix.SetRow( 2, kDir * random.GetFloatInRange( .1f, 10.f ) );
+	matrix.SetRow( 3, Vec4( random.GetFloatInRange( -100.f, 100.f ), random.GetFloatInRange( -100.f, 100.f ), random.GetFloatInRange( -100.f, 100.f ), 1.f ) );
+	return matrix;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static float CalcMaxDifference( const float* values, const float* expectedValues, unsigned int numFloats ) //Relative to the expected value, once it's past 1.
+{
+	float maxDifference = 0.f;
+	for ( unsigned int index = 0; index < numFloats; index++ )
+		maxDifference = GetMax( maxDifference, fabsf( values[ index ] - expectedValues[ index ] ) / GetMax( 1.f, fabsf( expectedValues[ index ] ) ) );
+	return maxDifference;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool ReportMatrixTest( const char* testName, unsigned int numMismatches, unsigned int numCases )
+{
+	g_theConsole->Printf( "Matrix44Test: %s, %u cases, %u differ from Matrix4x4f: %s", testName, numCases, numMismatches, ( numMismatches == 0 ) ? "PASS" : "FAIL" );
+	return ( numMismatches == 0 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool RunMatrix44Test()
+{
+	const unsigned int numCases = 10000;
+	RandomStream random( 44 );
+	bool didPass = true;
+
+	//Multiplies: ROW_MAJOR products match directly, COLUMN_MAJOR ones match with the operands swapped, as mult's comment says.
+	unsigned int numRowMajorMismatches = 0;
+	unsigned int numColumnMajorMismatches = 0;
+	unsigned int numRoundTripMismatches = 0;
+	for ( unsigned int caseIndex = 0; caseIndex < numCases; caseIndex++ )
+	{
+		Matrix4x4f lhs = MakeRandomMatrix4x4f( random, ROW_MAJOR );
+		Matrix4x4f rhs = MakeRandomMatrix4x4f( random, ROW_MAJOR );
+		Matrix44 product = Matrix44( lhs ) * Matrix44( rhs );
+		if ( memcmp( product.m_data, ( lhs * rhs ).m_data, sizeof( product.m_data ) ) != 0 )
+			++numRowMajorMismatches;
+
+		lhs.ToggleOrdering();
+		rhs.ToggleOrdering();
+		product = Matrix44( rhs ) * Matrix44( lhs );
+		if ( memcmp( product.m_data, Matrix44( lhs * rhs ).m_data, sizeof( product.m_data ) ) != 0 )
+			++numColumnMajorMismatches;
+
+		Matrix4x4f roundTrip = Matrix44( lhs ).GetAsMatrix4x4f( lhs.GetOrdering() );
+		if ( ( roundTrip.GetOrdering() != lhs.GetOrdering() ) || ( memcmp( roundTrip.m_data, lhs.m_data, sizeof( lhs.m_data ) ) != 0 ) )
+			++numRoundTripMismatches;
+	}
+	didPass &= ReportMatrixTest( "ROW_MAJOR multiply", numRowMajorMismatches, numCases );
+	didPass &= ReportMatrixTest( "COLUMN_MAJOR multiply", numColumnMajorMismatches, numCases );
+	didPass &= ReportMatrixTest( "conversion round trip", numRoundTripMismatches, numCases );
+
+	//Transforms, single and batched, against TransformVector in both orderings.
+	const unsigned int numVectors = 1023;
+	std::vector< Vector4f > vectors( numVectors );
+	std::vector< Vector3f > points( numVectors );
+	std::vector< Vector3f > directions( numVectors );
+	for ( unsigned int vectorIndex = 0; vectorIndex < numVectors; vectorIndex++ )
+	{
+		vectors[ vectorIndex ] = Vector4f( random.GetFloatInRange( -100.f, 100.f ), random.GetFloatInRange( -100.f, 100.f ), random.GetFloatInRange( -100.f, 100.f ), random.GetFloatInRange( -2.f, 2.f ) );
+		points[ vectorIndex ] = vectors[ vectorIndex ].xyz();
+		directions[ vectorIndex ] = vectors[ vectorIndex ].xyz();
+	}
+	unsigned int numTransformMismatches = 0;
+	for ( int ordering = ROW_MAJOR; ordering < NUM_ORDERINGS; ordering++ )
+	{
+		Matrix4x4f matrix = MakeRandomMatrix4x4f( random, static_cast<Ordering>( ordering ) );
+		Matrix44 fastMatrix( matrix );
+		std::vector< Vector4f > transformedVectors( numVectors );
+		fastMatrix.TransformVectors( vectors.data(), numVectors, transformedVectors.data() );
+		fastMatrix.TransformPoints( points.data(), numVectors, points.data() ); //In place, as promised.
+		fastMatrix.TransformDirections( directions.data(), numVectors, directions.data() );
+		for ( unsigned int vectorIndex = 0; vectorIndex < numVectors; vectorIndex++ )
+		{
+			const Vector4f& vector = vectors[ vectorIndex ];
+			Vector4f expectedVector = matrix.TransformVector( vector );
+			Vector3f expectedPoint = matrix.TransformVector( Vector4f( vector.xyz(), 1.f ) ).xyz();
+			Vector3f expectedDirection = matrix.TransformVector( Vector4f( vector.xyz(), 0.f ) ).xyz();
+			Vector4f singleVector = fastMatrix.TransformVector( vector );
+			Vector3f singlePoint = fastMatrix.TransformPoint( vector.xyz() );
+			Vector3f singleDirection = fastMatrix.TransformDirection( vector.xyz() );
+			if ( ( memcmp( &transformedVectors[ vectorIndex ], &expectedVector, sizeof( Vector4f ) ) != 0 ) || ( memcmp( &singleVector, &expectedVector, sizeof( Vector4f ) ) != 0 ) )
+				++numTransformMismatches;
+			if ( ( memcmp( &points[ vectorIndex ], &expectedPoint, sizeof( Vector3f ) ) != 0 ) || ( memcmp( &singlePoint, &expectedPoint, sizeof( Vector3f ) ) != 0 ) )
+				++numTransformMismatches;
+			if ( ( memcmp( &directions[ vectorIndex ], &expectedDirection, sizeof( Vector3f ) ) != 0 ) || ( memcmp( &singleDirection, &expectedDirection, sizeof( Vector3f ) ) != 0 ) )
+				++numTransformMismatches;
+		}
+		points.clear(); //Rebuild the in-place inputs for the next ordering.
+		directions.clear();
+		for ( unsigned int vectorIndex = 0; vectorIndex < numVectors; vectorIndex++ )
+		{
+			points.push_back( vectors[ vectorIndex ].xyz() );
+			directions.push_back( vectors[ vectorIndex ].xyz() );
+		}
+	}
+	didPass &= ReportMatrixTest( "vector, point and direction transforms", numTransformMismatches, numVectors * 3 * NUM_ORDERINGS );
+
+	//Inverses have no Matrix4x4f counterpart to match bitwise, so check M * M^-1 against identity, and affine against general.
+	float maxGeneralResidual = 0.f;
+	float maxAffineResidual = 0.f;
+	float maxAffineDifference = 0.f;
+	unsigned int numFailedInverses = 0;
+	for ( unsigned int caseIndex = 0; caseIndex < numCases; caseIndex++ )
+	{
+		Matrix44 matrix( MakeRandomMatrix4x4f( random, ROW_MAJOR ) );
+		for ( unsigned int diagonalIndex = 0; diagonalIndex < 16; diagonalIndex += 5 )
+			matrix.m_data[ diagonalIndex ] += 40.f; //Diagonally dominant, so well-conditioned enough for a float tolerance to mean something.
+		Matrix44 inverse;
+		if ( !matrix.GetInverse( inverse ) )
+			++numFailedInverses;
+		maxGeneralResidual = GetMax( maxGeneralResidual, CalcMaxDifference( ( matrix * inverse ).m_data, Matrix44::IDENTITY.m_data, 16 ) );
+
+		Matrix44 affineMatrix = MakeRandomAffineMatrix44( random );
+		Matrix44 affineInverse;
+		Matrix44 generalInverse;
+		if ( !affineMatrix.GetAffineInverse( affineInverse ) || !affineMatrix.GetInverse( generalInverse ) )
+			++numFailedInverses;
+		maxAffineResidual = GetMax( maxAffineResidual, CalcMaxDifference( ( affineMatrix * affineInverse ).m_data, Matrix44::IDENTITY.m_data, 16 ) );
+		maxAffineDifference = GetMax( maxAffineDifference, CalcMaxDifference( affineInverse.m_data, generalInverse.m_data, 16 ) );
+	}
+	Matrix44 singular( MakeRandomMatrix4x4f( random, ROW_MAJOR ) );
+	singular.SetRow( 2, Vec4( 0.f ) ); //A zero scale. Only exactly singular determinants are refused: rounding hides duplicate rows.
+	Matrix44 untouched;
+	if ( singular.GetInverse( untouched ) || singular.GetAffineInverse( untouched ) )
+		++numFailedInverses;
+
+	bool didInversesPass = ( numFailedInverses == 0 ) && ( maxGeneralResidual < MAX_INVERSE_TEST_RESIDUAL ) && ( maxAffineResidual < MAX_INVERSE_TEST_RESIDUAL ) && ( maxAffineDifference < MAX_INVERSE_TEST_RESIDUAL );
+	g_theConsole->Printf( "Matrix44Test: inverses, %u cases, max |M * M^-1 - I| general %g, affine %g, affine vs general %g, %u wrong singular calls: %s",
+						  numCases, maxGeneralResidual, maxAffineResidual, maxAffineDifference, numFailedInverses, didInversesPass ? "PASS" : "FAIL" );
+	didPass &= didInversesPass;
+
+	g_theConsole->Printf( "Matrix44Test: %s", didPass ? "PASS" : "FAIL" );
+	return didPass;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Matrix44Test( Command& )
+{
+	RunMatrix44Test();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Matrix44Benchmark( Command& args )
+{
+	int numIterations;
+	args.GetNextInt( &numIterations, DEFAULT_MATRIX_BENCHMARK_ITERATIONS );
+	if ( numIterations < 1 )
+	{
+		g_theConsole->Printf( "Usage: Matrix44Benchmark [numIterations = %d]", DEFAULT_MATRIX_BENCHMARK_ITERATIONS );
+		return;
+	}
+
+	//Chains each result into the next operation so nothing can be hoisted or skipped, and prints a checksum so nothing is dead.
+	RandomStream random( 44 );
+	Matrix4x4f slowMatrix( MakeRandomAffineMatrix44( random ).GetAsMatrix4x4f() );
+	Matrix4x4f slowStep( MakeRandomAffineMatrix44( random ).GetAsMatrix4x4f() );
+	Matrix44 fastMatrix( slowMatrix );
+	Matrix44 fastStep( slowStep );
+	float checksum = 0.f;
+
+	double startSeconds = GetCurrentTimeSeconds();
+	for ( int iteration = 0; iteration < numIterations; iteration++ )
+	{
+		Matrix4x4f product = slowMatrix * slowStep;
+		checksum += product.m_data[ iteration & 15 ];
+		slowStep.m_data[ 12 ] = product.m_data[ 0 ];
+	}
+	double slowMultiplySeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	startSeconds = GetCurrentTimeSeconds();
+	for ( int iteration = 0; iteration < numIterations; iteration++ )
+	{
+		Matrix44 product = fastMatrix * fastStep;
+		checksum += product.m_data[ iteration & 15 ];
+		fastStep.m_data[ 12 ] = product.m_data[ 0 ];
+	}
+	double fastMultiplySeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	startSeconds = GetCurrentTimeSeconds();
+	Matrix4x4f slowInverse;
+	for ( int iteration = 0; iteration < numIterations; iteration++ )
+	{
+		slowMatrix.GetInverseAssumingOrthonormality( slowInverse );
+		checksum += slowInverse.m_data[ iteration & 15 ];
+		slowMatrix.m_data[ 12 ] = slowInverse.m_data[ 0 ];
+	}
+	double slowInverseSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	startSeconds = GetCurrentTimeSeconds();
+	Matrix44 fastInverse;
+	for ( int iteration = 0; iteration < numIterations; iteration++ )
+	{
+		fastMatrix.GetAffineInverse( fastInverse );
+		checksum += fastInverse.m_data[ iteration & 15 ];
+		fastMatrix.m_data[ 12 ] = fastInverse.m_data[ 0 ];
+	}
+	double affineInverseSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	startSeconds = GetCurrentTimeSeconds();
+	for ( int iteration = 0; iteration < numIterations; iteration++ )
+	{
+		fastMatrix.GetInverse( fastInverse );
+		checksum += fastInverse.m_data[ iteration & 15 ];
+		fastMatrix.m_data[ 12 ] = fastInverse.m_data[ 0 ];
+	}
+	double generalInverseSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	const unsigned int numPoints = 4096;
+	const int numPointPasses = GetMax( 1, numIterations / static_cast<int>( numPoints ) );
+	std::vector< Vector3f > points( numPoints );
+	for ( unsigned int pointIndex = 0; pointIndex < numPoints; pointIndex++ )
+		points[ pointIndex ] = Vector3f( random.GetFloatInRange( -1.f, 1.f ), random.GetFloatInRange( -1.f, 1.f ), random.GetFloatInRange( -1.f, 1.f ) );
+	std::vector< Vector3f > transformedPoints( numPoints );
+
+	startSeconds = GetCurrentTimeSeconds();
+	for ( int pass = 0; pass < numPointPasses; pass++ )
+	{
+		for ( unsigned int pointIndex = 0; pointIndex < numPoints; pointIndex++ )
+			transformedPoints[ pointIndex ] = slowStep.TransformVector( Vector4f( points[ pointIndex ], 1.f ) ).xyz();
+		checksum += transformedPoints[ pass & ( numPoints - 1 ) ].x;
+	}
+	double slowPointsSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	startSeconds = GetCurrentTimeSeconds();
+	for ( int pass = 0; pass < numPointPasses; pass++ )
+	{
+		fastStep.TransformPoints( points.data(), numPoints, transformedPoints.data() );
+		checksum += transformedPoints[ pass & ( numPoints - 1 ) ].x;
+	}
+	double fastPointsSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	const double MEGA = 1000000.0;
+	const double numTransformedPoints = static_cast<double>( numPointPasses ) * numPoints;
+	g_theConsole->Printf( "Matrix44Benchmark: %d iterations (checksum %g):", numIterations, checksum );
+	g_theConsole->Printf( "  Multiply:  Matrix4x4f %.2f M/sec, Matrix44 %.2f M/sec (%.2fx)", numIterations / slowMultiplySeconds / MEGA, numIterations / fastMultiplySeconds / MEGA, slowMultiplySeconds / fastMultiplySeconds );
+	g_theConsole->Printf( "  Inverse:   Matrix4x4f orthonormal-only %.2f M/sec, Matrix44 affine %.2f M/sec (%.2fx), Matrix44 general %.2f M/sec",
+						  numIterations / slowInverseSeconds / MEGA, numIterations / affineInverseSeconds / MEGA, slowInverseSeconds / affineInverseSeconds, numIterations / generalInverseSeconds / MEGA );
+	g_theConsole->Printf( "  Points:    Matrix4x4f::TransformVector %.2f M/sec, Matrix44::TransformPoints %.2f M/sec (%.2fx)",
+						  numTransformedPoints / slowPointsSeconds / MEGA, numTransformedPoints / fastPointsSeconds / MEGA, slowPointsSeconds / fastPointsSeconds );
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+
+#include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Math/Vec4.hpp"
+
+
+//-----------------------------------------------------------------------------
+class Command;
+
+
+//-----------------------------------------------------------------------------
+//A float 4x4 with one fixed layout, for hot paths: Matrix4x4f's ROW_MAJOR (translation in m_data[ 12..14 ]), with row vectors, v' = v * M.
+//So A * B applies A first, as MatrixStack and Matrix4x4f's ROW_MAJOR multiplies expect. No ordering member or runtime ordering checks:
+//it's exactly 64 bytes, and arrays of it go straight to the card. Math runs through Vec4 and rounds identically to the Matrix4x4f code.
+//Not declared 16-byte aligned: the engine's operator new only promises 4, so Vec4 loads and stores don't assume alignment either.
+class Matrix44
+{
+public:
+	float m_data[ 16 ];
+
+	Matrix44(); //Identity.
+	explicit Matrix44( const float values[ 16 ] );
+	Matrix44( float in0, float in1, float in2, float in3, float in4, float in5, float in6, float in7,
+			  float in8, float in9, float in10, float in11, float in12, float in13, float in14, float in15 );
+	Matrix44( const Matrix4x4f& matrix ); //Transposes COLUMN_MAJOR ones, so either ordering converts to the same transform.
+	Matrix4x4f GetAsMatrix4x4f( Ordering ordering = ROW_MAJOR ) const;
+
+	static const Matrix44 IDENTITY;
+
+	Vec4 GetRow( unsigned int rowIndex ) const { return Vec4::Load( &m_data[ rowIndex * 4 ] ); }
+	void SetRow( unsigned int rowIndex, const Vec4& row ) { row.Store( &m_data[ rowIndex * 4 ] ); }
+	Vector3f GetTranslation() const { return Vector3f( m_data[ 12 ], m_data[ 13 ], m_data[ 14 ] ); }
+	void SetTranslation( const Vector3f& translation ) { m_data[ 12 ] = translation.x; m_data[ 13 ] = translation.y; m_data[ 14 ] = translation.z; }
+
+	Matrix44 operator*( const Matrix44& rhs ) const; //Bit-identical to mult() on ROW_MAJOR Matrix4x4fs. Safe to assign back into either operand.
+	Matrix44 GetTranspose() const;
+	void Transpose();
+	bool GetInverse( Matrix44& out_inverse ) const; //Any invertible matrix. False and out_inverse untouched if the determinant is 0.
+	bool GetAffineInverse( Matrix44& out_inverse ) const; //Cheaper, but assumes the last column is ( 0, 0, 0, 1 ). Same false case.
+
+	//Singles match Matrix4x4f::TransformVector on the equivalent ROW_MAJOR matrix, with w = 1 for points and 0 for directions.
+	Vec4 Transform( const Vec4& vector ) const;
+	Vector4f TransformVector( const Vector4f& vector ) const { return Transform( Vec4( vector ) ).GetAsVector4f(); }
+	Vector3f TransformPoint( const Vector3f& point ) const; //Drops the resulting w: no perspective divide.
+	Vector3f TransformDirection( const Vector3f& direction ) const;
+
+	//Batches keep the rows in registers across the whole array. out_ may be the input array itself.
+	void TransformVectors( const Vector4f* vectors, unsigned int numVectors, Vector4f* out_vectors ) const;
+	void TransformPoints( const Vector3f* points, unsigned int numPoints, Vector3f* out_points ) const;
+	void TransformDirections( const Vector3f* directions, unsigned int numDirections, Vector3f* out_directions ) const;
+};
+
+
+//-----------------------------------------------------------------------------
+bool RunMatrix44Test(); //Returns whether Matrix44Test passed. EngineTests calls it directly.
+void Matrix44Test( Command& args ); //Matrix44Test: multiplies, transforms and conversions bit-for-bit against Matrix4x4f, and inverse residuals.
+void Matrix44Benchmark( Command& args ); //Matrix44Benchmark [numIterations]: multiplies, inverses and point transforms per second, Matrix4x4f vs Matrix44.
+
+
+//-----------------------------------------------------------------------------
+inline Matrix44::Matrix44() //Spelled out rather than copying IDENTITY, which may not be constructed yet for other statics.
+{
+	for ( unsigned int index = 0; index < 16; index++ )
+		m_data[ index ] = ( ( index % 5 ) == 0 ) ? 1.f : 0.f;
+}
+
+
+//-----------------------------------------------------------------------------
+inline Vec4 Matrix44::Transform( const Vec4& vector ) const
+{
+	//Same terms in the same order as TransformVector's ROW_MAJOR case, so every lane rounds the same.
+	return ( ( ( GetRow( 0 ) * vector.SplatX() ) + ( GetRow( 1 ) * vector.SplatY() ) ) + ( GetRow( 2 ) * vector.SplatZ() ) ) + ( GetRow( 3 ) * vector.SplatW() );
+}
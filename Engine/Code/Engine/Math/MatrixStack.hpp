@@ -2,6 +2,7 @@
 
 
 #include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Math/Matrix44.hpp"
 #include <stack>
 
 
@@ -20,6 +21,7 @@ private:
 };
 
 typedef MatrixStack<Matrix4x4f> Matrix4x4Stack;
+typedef MatrixStack<Matrix44> Matrix44Stack; //Ordering is only read to convert the identity it starts with: Matrix44 is always ROW_MAJOR.
 
 
 //-----------------------------------------------------------------------------
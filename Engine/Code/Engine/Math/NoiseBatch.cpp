@@ -0,0 +1,699 @@
+#include "Engine/Math/NoiseBatch.hpp"
+
+
+#include "Engine/Math/Noise.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Concurrency/JobUtils.hpp"
+#include "Engine/Core/Command.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Time/Time.hpp"
+#include <emmintrin.h>
+#include <string.h>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Everything below reproduces Noise.cpp's fractal noise operation for operation, in the same order, so each lane rounds
+//exactly as the scalar code does. Reordering or fusing any of the float math (e.g. multiplying by a reciprocal) breaks that.
+static const float OCTAVE_OFFSET = 0.636764989593174f; //Noise.cpp's, see Compute1dFractalNoise.
+static const int NOISE_PRIME1 = 198491317; //Get2dNoiseUint's and Get3dNoiseUint's.
+static const int NOISE_PRIME2 = 6542989;
+static const unsigned int NUM_NOISE_LANES = 4;
+static const unsigned int MIN_SAMPLES_PER_NOISE_JOB = 16384;
+static const unsigned int MAX_NOISE_JOBS = 8;
+static const int DEFAULT_NOISE_TEST_OCTAVES = 4;
+static const int DEFAULT_NOISE_BENCHMARK_GRID_SIZE = 2048;
+static const int DEFAULT_NOISE_BENCHMARK_OCTAVES = 6;
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct FractalNoiseSettings
+{
+	float scale;
+	unsigned int numOctaves;
+	float octavePersistence;
+	float octaveScale;
+	bool renormalize;
+	unsigned int seed;
+	FractalNoiseSettings( float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed )
+		: scale( scale ), numOctaves( numOctaves ), octavePersistence( octavePersistence ), octaveScale( octaveScale ), renormalize( renormalize ), seed( seed ) {}
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct FractalNoiseGridRequest //What a grid fill's jobs share, so each job only carries its span.
+{
+	unsigned int numDimensions;
+	float mins[ 3 ];
+	float steps[ 3 ];
+	unsigned int counts[ 3 ]; //Unused axes are 1.
+	float* out_noise;
+	FractalNoiseSettings settings;
+	FractalNoiseGridRequest( unsigned int numDimensions, float* out_noise, const FractalNoiseSettings& settings )
+		: numDimensions( numDimensions ), out_noise( out_noise ), settings( settings )
+	{
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			mins[ axis ] = 0.f;
+			steps[ axis ] = 0.f;
+			counts[ axis ] = 1;
+		}
+	}
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline __m128i MultiplyLowInts( __m128i a, __m128i b ) //SSE2 lacks _mm_mullo_epi32: multiply even and odd lanes to 64 bits, keep the low halves.
+{
+	__m128i evenProducts = _mm_mul_epu32( a, b );
+	__m128i oddProducts = _mm_mul_epu32( _mm_srli_si128( a, 4 ), _mm_srli_si128( b, 4 ) );
+	return _mm_unpacklo_epi32( _mm_shuffle_epi32( evenProducts, _MM_SHUFFLE( 0, 0, 2, 0 ) ), _mm_shuffle_epi32( oddProducts, _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline __m128i Get1dNoiseUints( __m128i positions, unsigned int seed ) //Get1dNoiseUint per lane.
+{
+	__m128i mangledBits = MultiplyLowInts( positions, _mm_set1_epi32( (int) 0xB5297A4D ) );
+	mangledBits = _mm_add_epi32( mangledBits, _mm_set1_epi32( (int) seed ) );
+	mangledBits = _mm_xor_si128( mangledBits, _mm_srli_epi32( mangledBits, 8 ) );
+	mangledBits = _mm_add_epi32( mangledBits, _mm_set1_epi32( (int) 0x68E31DA4 ) );
+	mangledBits = _mm_xor_si128( mangledBits, _mm_slli_epi32( mangledBits, 8 ) );
+	mangledBits = MultiplyLowInts( mangledBits, _mm_set1_epi32( (int) 0x1B56C4E9 ) );
+	mangledBits = _mm_xor_si128( mangledBits, _mm_srli_epi32( mangledBits, 8 ) );
+	return mangledBits;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline __m128 Get1dNoiseZeroToOnes( __m128i positions, unsigned int seed ) //Get1dNoiseZeroToOne per lane, through doubles like it.
+{
+	const __m128d ONE_OVER_MAX_UINT = _mm_set1_pd( 1.0 / (double) 0xFFFFFFFF );
+	const __m128d TOP_BIT = _mm_set1_pd( 2147483648.0 );
+
+	//SSE2 only converts signed ints to doubles, so flip the top bit off and add it back as a double--exactly, like (double) of an unsigned.
+	__m128i flippedNoise = _mm_xor_si128( Get1dNoiseUints( positions, seed ), _mm_set1_epi32( (int) 0x80000000 ) );
+	__m128d lowNoise = _mm_add_pd( _mm_cvtepi32_pd( flippedNoise ), TOP_BIT );
+	__m128d highNoise = _mm_add_pd( _mm_cvtepi32_pd( _mm_shuffle_epi32( flippedNoise, _MM_SHUFFLE( 1, 0, 3, 2 ) ) ), TOP_BIT );
+	return _mm_movelh_ps( _mm_cvtpd_ps( _mm_mul_pd( ONE_OVER_MAX_UINT, lowNoise ) ), _mm_cvtpd_ps( _mm_mul_pd( ONE_OVER_MAX_UINT, highNoise ) ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline __m128 FastFloors( __m128 values, __m128i* out_floorsAsInts ) //FastFloor per lane: truncation only rounds negatives with a fraction the wrong way.
+{
+	__m128i truncatedInts = _mm_cvttps_epi32( values );
+	__m128 truncatedFloats = _mm_cvtepi32_ps( truncatedInts );
+	__m128 wasRoundedUp = _mm_cmpgt_ps( truncatedFloats, values );
+	*out_floorsAsInts = _mm_add_epi32( truncatedInts, _mm_castps_si128( wasRoundedUp ) ); //The mask is -1 where true.
+	return _mm_sub_ps( truncatedFloats, _mm_and_ps( wasRoundedUp, _mm_set1_ps( 1.f ) ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline __m128 SmoothSteps( __m128 inputsZeroToOne )
+{
+	__m128 squared = _mm_mul_ps( inputsZeroToOne, inputsZeroToOne );
+	return _mm_mul_ps( squared, _mm_sub_ps( _mm_set1_ps( 3.f ), _mm_mul_ps( _mm_set1_ps( 2.f ), inputsZeroToOne ) ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline __m128 Blend( const __m128& weightHigh, const __m128& valueHigh, const __m128& weightLow, const __m128& valueLow ) //By reference: Win32 only passes 3 __m128s by value.
+{
+	return _mm_add_ps( _mm_mul_ps( weightHigh, valueHigh ), _mm_mul_ps( weightLow, valueLow ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline __m128 AccumulateOctave( __m128 totalNoise, __m128 blendTotal, float currentAmplitude )
+{
+	__m128 noiseThisOctave = _mm_mul_ps( _mm_set1_ps( 2.f ), _mm_sub_ps( blendTotal, _mm_set1_ps( 0.5f ) ) ); //Map from [0,1] to [-1,1]
+	return _mm_add_ps( totalNoise, _mm_mul_ps( noiseThisOctave, _mm_set1_ps( currentAmplitude ) ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline __m128 AdvanceOctavePositions( __m128 positions, float octaveScale )
+{
+	return _mm_add_ps( _mm_mul_ps( positions, _mm_set1_ps( octaveScale ) ), _mm_set1_ps( OCTAVE_OFFSET ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline __m128 RenormalizeNoise( __m128 totalNoise, float totalAmplitude )
+{
+	totalNoise = _mm_div_ps( totalNoise, _mm_set1_ps( totalAmplitude ) );
+	totalNoise = _mm_add_ps( _mm_mul_ps( totalNoise, _mm_set1_ps( 0.5f ) ), _mm_set1_ps( 0.5f ) );
+	totalNoise = SmoothSteps( totalNoise );
+	return _mm_sub_ps( _mm_mul_ps( totalNoise, _mm_set1_ps( 2.f ) ), _mm_set1_ps( 1.f ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static __m128 Compute1dFractalNoises( __m128 positions, const FractalNoiseSettings& settings )
+{
+	const __m128 ONES = _mm_set1_ps( 1.f );
+	const __m128i INT_ONES = _mm_set1_epi32( 1 );
+
+	__m128 totalNoise = _mm_setzero_ps();
+	float totalAmplitude = 0.f;
+	float currentAmplitude = 1.f;
+	unsigned int seed = settings.seed;
+	__m128 currentPositions = _mm_mul_ps( positions, _mm_set1_ps( 1.f / settings.scale ) );
+
+	for ( unsigned int octaveNum = 0; octaveNum < settings.numOctaves; ++octaveNum )
+	{
+		__m128i indicesWest;
+		__m128 positionFloors = FastFloors( currentPositions, &indicesWest );
+		__m128 valuesWest = Get1dNoiseZeroToOnes( indicesWest, seed );
+		__m128 valuesEast = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesWest, INT_ONES ), seed );
+
+		__m128 weightsEast = SmoothSteps( _mm_sub_ps( currentPositions, positionFloors ) );
+		__m128 weightsWest = _mm_sub_ps( ONES, weightsEast );
+		totalNoise = AccumulateOctave( totalNoise, Blend( valuesWest, weightsWest, valuesEast, weightsEast ), currentAmplitude );
+
+		totalAmplitude += currentAmplitude;
+		currentAmplitude *= settings.octavePersistence;
+		currentPositions = AdvanceOctavePositions( currentPositions, settings.octaveScale );
+		++seed;
+	}
+
+	if ( settings.renormalize && totalAmplitude > 0.f )
+		totalNoise = RenormalizeNoise( totalNoise, totalAmplitude );
+
+	return totalNoise;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static __m128 Compute2dFractalNoises( __m128 positionsX, __m128 positionsY, const FractalNoiseSettings& settings )
+{
+	const __m128 ONES = _mm_set1_ps( 1.f );
+	const __m128i INT_ONES = _mm_set1_epi32( 1 );
+	const __m128i PRIME1 = _mm_set1_epi32( NOISE_PRIME1 );
+
+	__m128 totalNoise = _mm_setzero_ps();
+	float totalAmplitude = 0.f;
+	float currentAmplitude = 1.f;
+	unsigned int seed = settings.seed;
+	__m128 invScale = _mm_set1_ps( 1.f / settings.scale );
+	__m128 currentX = _mm_mul_ps( positionsX, invScale );
+	__m128 currentY = _mm_mul_ps( positionsY, invScale );
+
+	for ( unsigned int octaveNum = 0; octaveNum < settings.numOctaves; ++octaveNum )
+	{
+		__m128i indicesWestX;
+		__m128i indicesSouthY;
+		__m128 cellMinsX = FastFloors( currentX, &indicesWestX );
+		__m128 cellMinsY = FastFloors( currentY, &indicesSouthY );
+		__m128i indicesEastX = _mm_add_epi32( indicesWestX, INT_ONES );
+
+		//Get2dNoiseUint hashes ( x, y ) down to x + ( PRIME1 * y ).
+		__m128i rowsSouth = MultiplyLowInts( PRIME1, indicesSouthY );
+		__m128i rowsNorth = MultiplyLowInts( PRIME1, _mm_add_epi32( indicesSouthY, INT_ONES ) );
+		__m128 valuesSouthWest = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesWestX, rowsSouth ), seed );
+		__m128 valuesSouthEast = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesEastX, rowsSouth ), seed );
+		__m128 valuesNorthWest = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesWestX, rowsNorth ), seed );
+		__m128 valuesNorthEast = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesEastX, rowsNorth ), seed );
+
+		__m128 weightsEast = SmoothSteps( _mm_sub_ps( currentX, cellMinsX ) );
+		__m128 weightsNorth = SmoothSteps( _mm_sub_ps( currentY, cellMinsY ) );
+		__m128 weightsWest = _mm_sub_ps( ONES, weightsEast );
+		__m128 weightsSouth = _mm_sub_ps( ONES, weightsNorth );
+
+		__m128 blendSouth = Blend( weightsEast, valuesSouthEast, weightsWest, valuesSouthWest );
+		__m128 blendNorth = Blend( weightsEast, valuesNorthEast, weightsWest, valuesNorthWest );
+		totalNoise = AccumulateOctave( totalNoise, Blend( weightsSouth, blendSouth, weightsNorth, blendNorth ), currentAmplitude );
+
+		totalAmplitude += currentAmplitude;
+		currentAmplitude *= settings.octavePersistence;
+		currentX = AdvanceOctavePositions( currentX, settings.octaveScale );
+		currentY = AdvanceOctavePositions( currentY, settings.octaveScale );
+		++seed;
+	}
+
+	if ( settings.renormalize && totalAmplitude > 0.f )
+		totalNoise = RenormalizeNoise( totalNoise, totalAmplitude );
+
+	return totalNoise;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static __m128 Compute3dFractalNoises( __m128 positionsX, __m128 positionsY, __m128 positionsZ, const FractalNoiseSettings& settings )
+{
+	const __m128 ONES = _mm_set1_ps( 1.f );
+	const __m128i INT_ONES = _mm_set1_epi32( 1 );
+	const __m128i PRIME1 = _mm_set1_epi32( NOISE_PRIME1 );
+	const __m128i PRIME2 = _mm_set1_epi32( NOISE_PRIME2 );
+
+	__m128 totalNoise = _mm_setzero_ps();
+	float totalAmplitude = 0.f;
+	float currentAmplitude = 1.f;
+	unsigned int seed = settings.seed;
+	__m128 invScale = _mm_set1_ps( 1.f / settings.scale );
+	__m128 currentX = _mm_mul_ps( positionsX, invScale );
+	__m128 currentY = _mm_mul_ps( positionsY, invScale );
+	__m128 currentZ = _mm_mul_ps( positionsZ, invScale );
+
+	for ( unsigned int octaveNum = 0; octaveNum < settings.numOctaves; ++octaveNum )
+	{
+		__m128i indicesWestX;
+		__m128i indicesSouthY;
+		__m128i indicesBelowZ;
+		__m128 cellMinsX = FastFloors( currentX, &indicesWestX );
+		__m128 cellMinsY = FastFloors( currentY, &indicesSouthY );
+		__m128 cellMinsZ = FastFloors( currentZ, &indicesBelowZ );
+		__m128i indicesEastX = _mm_add_epi32( indicesWestX, INT_ONES );
+
+		//Get3dNoiseUint hashes ( x, y, z ) down to x + ( PRIME1 * y ) + ( PRIME2 * z ): wrapping int math, so any grouping gives the same bits.
+		__m128i rowsSouth = MultiplyLowInts( PRIME1, indicesSouthY );
+		__m128i rowsNorth = MultiplyLowInts( PRIME1, _mm_add_epi32( indicesSouthY, INT_ONES ) );
+		__m128i layersBelow = MultiplyLowInts( PRIME2, indicesBelowZ );
+		__m128i layersAbove = MultiplyLowInts( PRIME2, _mm_add_epi32( indicesBelowZ, INT_ONES ) );
+		__m128i belowSouth = _mm_add_epi32( rowsSouth, layersBelow );
+		__m128i belowNorth = _mm_add_epi32( rowsNorth, layersBelow );
+		__m128i aboveSouth = _mm_add_epi32( rowsSouth, layersAbove );
+		__m128i aboveNorth = _mm_add_epi32( rowsNorth, layersAbove );
+
+		__m128 aboveSouthWest = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesWestX, aboveSouth ), seed );
+		__m128 aboveSouthEast = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesEastX, aboveSouth ), seed );
+		__m128 aboveNorthWest = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesWestX, aboveNorth ), seed );
+		__m128 aboveNorthEast = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesEastX, aboveNorth ), seed );
+		__m128 belowSouthWest = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesWestX, belowSouth ), seed );
+		__m128 belowSouthEast = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesEastX, belowSouth ), seed );
+		__m128 belowNorthWest = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesWestX, belowNorth ), seed );
+		__m128 belowNorthEast = Get1dNoiseZeroToOnes( _mm_add_epi32( indicesEastX, belowNorth ), seed );
+
+		__m128 weightsEast = SmoothSteps( _mm_sub_ps( currentX, cellMinsX ) );
+		__m128 weightsNorth = SmoothSteps( _mm_sub_ps( currentY, cellMinsY ) );
+		__m128 weightsAbove = SmoothSteps( _mm_sub_ps( currentZ, cellMinsZ ) );
+		__m128 weightsWest = _mm_sub_ps( ONES, weightsEast );
+		__m128 weightsSouth = _mm_sub_ps( ONES, weightsNorth );
+		__m128 weightsBelow = _mm_sub_ps( ONES, weightsAbove );
+
+		//8-way blend (8 -> 4 -> 2 -> 1)
+		__m128 blendBelowSouth = Blend( weightsEast, belowSouthEast, weightsWest, belowSouthWest );
+		__m128 blendBelowNorth = Blend( weightsEast, belowNorthEast, weightsWest, belowNorthWest );
+		__m128 blendAboveSouth = Blend( weightsEast, aboveSouthEast, weightsWest, aboveSouthWest );
+		__m128 blendAboveNorth = Blend( weightsEast, aboveNorthEast, weightsWest, aboveNorthWest );
+		__m128 blendBelow = Blend( weightsSouth, blendBelowSouth, weightsNorth, blendBelowNorth );
+		__m128 blendAbove = Blend( weightsSouth, blendAboveSouth, weightsNorth, blendAboveNorth );
+		totalNoise = AccumulateOctave( totalNoise, Blend( weightsBelow, blendBelow, weightsAbove, blendAbove ), currentAmplitude );
+
+		totalAmplitude += currentAmplitude;
+		currentAmplitude *= settings.octavePersistence;
+		currentX = AdvanceOctavePositions( currentX, settings.octaveScale );
+		currentY = AdvanceOctavePositions( currentY, settings.octaveScale );
+		currentZ = AdvanceOctavePositions( currentZ, settings.octaveScale );
+		++seed;
+	}
+
+	if ( settings.renormalize && totalAmplitude > 0.f )
+		totalNoise = RenormalizeNoise( totalNoise, totalAmplitude );
+
+	return totalNoise;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Compute1dFractalNoiseBatch( const float* positions, unsigned int numPositions, float* out_noise,
+								 float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed )
+{
+	FractalNoiseSettings settings( scale, numOctaves, octavePersistence, octaveScale, renormalize, seed );
+	unsigned int positionIndex = 0;
+	for ( ; positionIndex + NUM_NOISE_LANES <= numPositions; positionIndex += NUM_NOISE_LANES )
+		_mm_storeu_ps( out_noise + positionIndex, Compute1dFractalNoises( _mm_loadu_ps( positions + positionIndex ), settings ) );
+	for ( ; positionIndex < numPositions; positionIndex++ )
+		out_noise[ positionIndex ] = Compute1dFractalNoise( positions[ positionIndex ], scale, numOctaves, octavePersistence, octaveScale, renormalize, seed );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Compute2dFractalNoiseBatch( const float* positionsX, const float* positionsY, unsigned int numPositions, float* out_noise,
+								 float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed )
+{
+	FractalNoiseSettings settings( scale, numOctaves, octavePersistence, octaveScale, renormalize, seed );
+	unsigned int positionIndex = 0;
+	for ( ; positionIndex + NUM_NOISE_LANES <= numPositions; positionIndex += NUM_NOISE_LANES )
+	{
+		__m128 noise = Compute2dFractalNoises( _mm_loadu_ps( positionsX + positionIndex ), _mm_loadu_ps( positionsY + positionIndex ), settings );
+		_mm_storeu_ps( out_noise + positionIndex, noise );
+	}
+	for ( ; positionIndex < numPositions; positionIndex++ )
+	{
+		out_noise[ positionIndex ] = Compute2dFractalNoise( positionsX[ positionIndex ], positionsY[ positionIndex ],
+															scale, numOctaves, octavePersistence, octaveScale, renormalize, seed );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Compute3dFractalNoiseBatch( const float* positionsX, const float* positionsY, const float* positionsZ, unsigned int numPositions, float* out_noise,
+								 float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed )
+{
+	FractalNoiseSettings settings( scale, numOctaves, octavePersistence, octaveScale, renormalize, seed );
+	unsigned int positionIndex = 0;
+	for ( ; positionIndex + NUM_NOISE_LANES <= numPositions; positionIndex += NUM_NOISE_LANES )
+	{
+		__m128 noise = Compute3dFractalNoises( _mm_loadu_ps( positionsX + positionIndex ), _mm_loadu_ps( positionsY + positionIndex ), _mm_loadu_ps( positionsZ + positionIndex ), settings );
+		_mm_storeu_ps( out_noise + positionIndex, noise );
+	}
+	for ( ; positionIndex < numPositions; positionIndex++ )
+	{
+		out_noise[ positionIndex ] = Compute3dFractalNoise( positionsX[ positionIndex ], positionsY[ positionIndex ], positionsZ[ positionIndex ],
+															scale, numOctaves, octavePersistence, octaveScale, renormalize, seed );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static float ComputeFractalNoiseAt( const FractalNoiseGridRequest& request, float posX, float posY, float posZ ) //The scalar function for the grid's dimension.
+{
+	const FractalNoiseSettings& settings = request.settings;
+	switch ( request.numDimensions )
+	{
+	case 1: return Compute1dFractalNoise( posX, settings.scale, settings.numOctaves, settings.octavePersistence, settings.octaveScale, settings.renormalize, settings.seed );
+	case 2: return Compute2dFractalNoise( posX, posY, settings.scale, settings.numOctaves, settings.octavePersistence, settings.octaveScale, settings.renormalize, settings.seed );
+	default: return Compute3dFractalNoise( posX, posY, posZ, settings.scale, settings.numOctaves, settings.octavePersistence, settings.octaveScale, settings.renormalize, settings.seed );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void FillFractalNoiseGrid( const FractalNoiseGridRequest& request, unsigned int firstRow, unsigned int numRows, unsigned int firstX, unsigned int numX )
+{
+	//A row runs along x, so it's rows numY * z + y. Positions are mins + ( index * step ), computed per lane the same way as per sample.
+	const __m128i LANE_OFFSETS = _mm_setr_epi32( 0, 1, 2, 3 );
+	const __m128 minsX = _mm_set1_ps( request.mins[ 0 ] );
+	const __m128 stepsX = _mm_set1_ps( request.steps[ 0 ] );
+	unsigned int endX = firstX + numX;
+
+	for ( unsigned int row = firstRow; row < firstRow + numRows; row++ )
+	{
+		unsigned int indexY = row % request.counts[ 1 ];
+		unsigned int indexZ = row / request.counts[ 1 ];
+		float posY = request.mins[ 1 ] + ( static_cast<float>( indexY ) * request.steps[ 1 ] );
+		float posZ = request.mins[ 2 ] + ( static_cast<float>( indexZ ) * request.steps[ 2 ] );
+		__m128 positionsY = _mm_set1_ps( posY );
+		__m128 positionsZ = _mm_set1_ps( posZ );
+		float* rowNoise = request.out_noise + ( row * request.counts[ 0 ] );
+
+		unsigned int indexX = firstX;
+		for ( ; indexX + NUM_NOISE_LANES <= endX; indexX += NUM_NOISE_LANES )
+		{
+			__m128 indicesX = _mm_cvtepi32_ps( _mm_add_epi32( _mm_set1_epi32( (int) indexX ), LANE_OFFSETS ) );
+			__m128 positionsX = _mm_add_ps( minsX, _mm_mul_ps( indicesX, stepsX ) );
+			__m128 noise;
+			switch ( request.numDimensions )
+			{
+			case 1: noise = Compute1dFractalNoises( positionsX, request.settings ); break;
+			case 2: noise = Compute2dFractalNoises( positionsX, positionsY, request.settings ); break;
+			default: noise = Compute3dFractalNoises( positionsX, positionsY, positionsZ, request.settings ); break;
+			}
+			_mm_storeu_ps( rowNoise + indexX, noise );
+		}
+		for ( ; indexX < endX; indexX++ )
+			rowNoise[ indexX ] = ComputeFractalNoiseAt( request, request.mins[ 0 ] + ( static_cast<float>( indexX ) * request.steps[ 0 ] ), posY, posZ );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void FillFractalNoiseGridJob( Job* job )
+{
+	const FractalNoiseGridRequest* request = job->Read<const FractalNoiseGridRequest*>();
+	unsigned int firstRow = job->Read<unsigned int>();
+	unsigned int numRows = job->Read<unsigned int>();
+	unsigned int firstX = job->Read<unsigned int>();
+	unsigned int numX = job->Read<unsigned int>();
+	FillFractalNoiseGrid( *request, firstRow, numRows, firstX, numX );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void DispatchFillFractalNoiseGridJob( const FractalNoiseGridRequest& request, unsigned int firstRow, unsigned int numRows, unsigned int firstX, unsigned int numX,
+											 std::vector< Job* >& jobs )
+{
+	JobSystem* jobSystem = JobSystem::Instance();
+	Job* job = jobSystem->CreateJob( JOB_CATEGORY_GENERIC, FillFractalNoiseGridJob );
+	job->Write<const FractalNoiseGridRequest*>( &request );
+	job->Write<unsigned int>( firstRow );
+	job->Write<unsigned int>( numRows );
+	job->Write<unsigned int>( firstX );
+	job->Write<unsigned int>( numX );
+	jobSystem->DispatchJob( job );
+	jobs.push_back( job );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void FillFractalNoiseGrid( const FractalNoiseGridRequest& request, bool useJobSystem )
+{
+	unsigned int numRows = request.counts[ 1 ] * request.counts[ 2 ];
+	unsigned int numX = request.counts[ 0 ];
+	unsigned int numSamples = numRows * numX;
+	JobSystem* jobSystem = JobSystem::Instance();
+	unsigned int numJobs = ( useJobSystem && jobSystem->IsRunning() ) ? GetMin( MAX_NOISE_JOBS, numSamples / MIN_SAMPLES_PER_NOISE_JOB ) : 0;
+	if ( numJobs < 2 )
+	{
+		FillFractalNoiseGrid( request, 0, numRows, 0, numX );
+		return;
+	}
+
+	//Every sample is independent, so jobs only need disjoint spans: whole rows, or for grids too short for that (like 1D), lane-sized pieces of rows.
+	std::vector< Job* > jobs;
+	if ( numRows >= numJobs )
+	{
+		unsigned int rowsPerJob = ( numRows + numJobs - 1 ) / numJobs;
+		for ( unsigned int firstRow = 0; firstRow < numRows; firstRow += rowsPerJob )
+			DispatchFillFractalNoiseGridJob( request, firstRow, GetMin( rowsPerJob, numRows - firstRow ), 0, numX, jobs );
+	}
+	else
+	{
+		unsigned int jobsPerRow = ( numJobs + numRows - 1 ) / numRows;
+		unsigned int xPerJob = ( numX + jobsPerRow - 1 ) / jobsPerRow;
+		xPerJob = ( ( xPerJob + NUM_NOISE_LANES - 1 ) / NUM_NOISE_LANES ) * NUM_NOISE_LANES;
+		for ( unsigned int row = 0; row < numRows; row++ )
+			for ( unsigned int firstX = 0; firstX < numX; firstX += xPerJob )
+				DispatchFillFractalNoiseGridJob( request, row, 1, firstX, GetMin( xPerJob, numX - firstX ), jobs );
+	}
+	jobSystem->WaitOnJobsForCompletion( jobs );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Compute1dFractalNoiseGrid( float minX, float stepX, unsigned int numX, float* out_noise,
+								float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed,
+								bool useJobSystem )
+{
+	FractalNoiseGridRequest request( 1, out_noise, FractalNoiseSettings( scale, numOctaves, octavePersistence, octaveScale, renormalize, seed ) );
+	request.mins[ 0 ] = minX;
+	request.steps[ 0 ] = stepX;
+	request.counts[ 0 ] = numX;
+	FillFractalNoiseGrid( request, useJobSystem );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Compute2dFractalNoiseGrid( const Vector2f& mins, const Vector2f& step, unsigned int numX, unsigned int numY, float* out_noise,
+								float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed,
+								bool useJobSystem )
+{
+	FractalNoiseGridRequest request( 2, out_noise, FractalNoiseSettings( scale, numOctaves, octavePersistence, octaveScale, renormalize, seed ) );
+	request.mins[ 0 ] = mins.x;
+	request.mins[ 1 ] = mins.y;
+	request.steps[ 0 ] = step.x;
+	request.steps[ 1 ] = step.y;
+	request.counts[ 0 ] = numX;
+	request.counts[ 1 ] = numY;
+	FillFractalNoiseGrid( request, useJobSystem );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Compute3dFractalNoiseGrid( const Vector3f& mins, const Vector3f& step, unsigned int numX, unsigned int numY, unsigned int numZ, float* out_noise,
+								float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed,
+								bool useJobSystem )
+{
+	FractalNoiseGridRequest request( 3, out_noise, FractalNoiseSettings( scale, numOctaves, octavePersistence, octaveScale, renormalize, seed ) );
+	request.mins[ 0 ] = mins.x;
+	request.mins[ 1 ] = mins.y;
+	request.mins[ 2 ] = mins.z;
+	request.steps[ 0 ] = step.x;
+	request.steps[ 1 ] = step.y;
+	request.steps[ 2 ] = step.z;
+	request.counts[ 0 ] = numX;
+	request.counts[ 1 ] = numY;
+	request.counts[ 2 ] = numZ;
+	FillFractalNoiseGrid( request, useJobSystem );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static unsigned int CountMismatches( const std::vector< float >& batchNoise, const std::vector< float >& scalarNoise ) //Bitwise, so -0 vs 0 counts.
+{
+	unsigned int numMismatches = 0;
+	for ( unsigned int sampleIndex = 0; sampleIndex < batchNoise.size(); sampleIndex++ )
+		if ( memcmp( &batchNoise[ sampleIndex ], &scalarNoise[ sampleIndex ], sizeof( float ) ) != 0 )
+			++numMismatches;
+	return numMismatches;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool ReportNoiseTest( const char* testName, unsigned int numMismatches, unsigned int numSamples )
+{
+	g_theConsole->Printf( "NoiseBatchTest: %s, %u samples, %u differ from scalar: %s", testName, numSamples, numMismatches, ( numMismatches == 0 ) ? "PASS" : "FAIL" );
+	return ( numMismatches == 0 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool RunNoiseBatchTest( int numOctaves )
+{
+	//Point lists: an odd count so the scalar tail runs too, spanning negatives so FastFloor's rounding runs too.
+	const unsigned int numPoints = 4099;
+	const float scale = 7.3f;
+	const float octavePersistence = 0.55f;
+	const float octaveScale = 2.1f;
+	const unsigned int seed = 1234;
+	std::vector< float > positionsX( numPoints );
+	std::vector< float > positionsY( numPoints );
+	std::vector< float > positionsZ( numPoints );
+	for ( unsigned int pointIndex = 0; pointIndex < numPoints; pointIndex++ )
+	{
+		positionsX[ pointIndex ] = GetRandomFloatInRange( -1000.f, 1000.f );
+		positionsY[ pointIndex ] = GetRandomFloatInRange( -1000.f, 1000.f );
+		positionsZ[ pointIndex ] = GetRandomFloatInRange( -1000.f, 1000.f );
+	}
+	positionsX[ 0 ] = -3.f; //Exact integers, where FastFloor's negative case takes its other branch.
+	positionsY[ 0 ] = -2.f * scale;
+
+	bool didPass = true;
+	std::vector< float > batchNoise( numPoints );
+	std::vector< float > scalarNoise( numPoints );
+	for ( int renormalize = 0; renormalize < 2; renormalize++ )
+	{
+		Compute1dFractalNoiseBatch( positionsX.data(), numPoints, batchNoise.data(), scale, numOctaves, octavePersistence, octaveScale, renormalize != 0, seed );
+		for ( unsigned int pointIndex = 0; pointIndex < numPoints; pointIndex++ )
+			scalarNoise[ pointIndex ] = Compute1dFractalNoise( positionsX[ pointIndex ], scale, numOctaves, octavePersistence, octaveScale, renormalize != 0, seed );
+		didPass &= ReportNoiseTest( renormalize ? "1D points" : "1D points, not renormalized", CountMismatches( batchNoise, scalarNoise ), numPoints );
+
+		Compute2dFractalNoiseBatch( positionsX.data(), positionsY.data(), numPoints, batchNoise.data(), scale, numOctaves, octavePersistence, octaveScale, renormalize != 0, seed );
+		for ( unsigned int pointIndex = 0; pointIndex < numPoints; pointIndex++ )
+			scalarNoise[ pointIndex ] = Compute2dFractalNoise( positionsX[ pointIndex ], positionsY[ pointIndex ], scale, numOctaves, octavePersistence, octaveScale, renormalize != 0, seed );
+		didPass &= ReportNoiseTest( renormalize ? "2D points" : "2D points, not renormalized", CountMismatches( batchNoise, scalarNoise ), numPoints );
+
+		Compute3dFractalNoiseBatch( positionsX.data(), positionsY.data(), positionsZ.data(), numPoints, batchNoise.data(), scale, numOctaves, octavePersistence, octaveScale, renormalize != 0, seed );
+		for ( unsigned int pointIndex = 0; pointIndex < numPoints; pointIndex++ )
+		{
+			scalarNoise[ pointIndex ] = Compute3dFractalNoise( positionsX[ pointIndex ], positionsY[ pointIndex ], positionsZ[ pointIndex ],
+															   scale, numOctaves, octavePersistence, octaveScale, renormalize != 0, seed );
+		}
+		didPass &= ReportNoiseTest( renormalize ? "3D points" : "3D points, not renormalized", CountMismatches( batchNoise, scalarNoise ), numPoints );
+	}
+
+	//Grids: sizes that aren't lane multiples, and big enough to split across jobs if the JobSystem's running.
+	const unsigned int numGridX = 70001;
+	batchNoise.resize( numGridX );
+	scalarNoise.resize( numGridX );
+	Compute1dFractalNoiseGrid( -50.f, .01f, numGridX, batchNoise.data(), scale, numOctaves, octavePersistence, octaveScale, true, seed );
+	for ( unsigned int x = 0; x < numGridX; x++ )
+		scalarNoise[ x ] = Compute1dFractalNoise( -50.f + ( static_cast<float>( x ) * .01f ), scale, numOctaves, octavePersistence, octaveScale, true, seed );
+	didPass &= ReportNoiseTest( "1D grid", CountMismatches( batchNoise, scalarNoise ), numGridX );
+
+	const Vector2f mins2D( -20.f, -35.5f );
+	const Vector2f step2D( .25f, .3f );
+	const unsigned int numGrid2DX = 259;
+	const unsigned int numGrid2DY = 131;
+	batchNoise.resize( numGrid2DX * numGrid2DY );
+	scalarNoise.resize( numGrid2DX * numGrid2DY );
+	Compute2dFractalNoiseGrid( mins2D, step2D, numGrid2DX, numGrid2DY, batchNoise.data(), scale, numOctaves, octavePersistence, octaveScale, true, seed );
+	for ( unsigned int y = 0; y < numGrid2DY; y++ )
+		for ( unsigned int x = 0; x < numGrid2DX; x++ )
+		{
+			scalarNoise[ ( y * numGrid2DX ) + x ] = Compute2dFractalNoise( mins2D.x + ( static_cast<float>( x ) * step2D.x ), mins2D.y + ( static_cast<float>( y ) * step2D.y ),
+																		   scale, numOctaves, octavePersistence, octaveScale, true, seed );
+		}
+	didPass &= ReportNoiseTest( "2D grid", CountMismatches( batchNoise, scalarNoise ), numGrid2DX * numGrid2DY );
+
+	const Vector3f mins3D( -4.f, 10.f, -7.25f );
+	const Vector3f step3D( .5f, .125f, .75f );
+	const unsigned int numGrid3DX = 43;
+	const unsigned int numGrid3DY = 37;
+	const unsigned int numGrid3DZ = 29;
+	batchNoise.resize( numGrid3DX * numGrid3DY * numGrid3DZ );
+	scalarNoise.resize( numGrid3DX * numGrid3DY * numGrid3DZ );
+	Compute3dFractalNoiseGrid( mins3D, step3D, numGrid3DX, numGrid3DY, numGrid3DZ, batchNoise.data(), scale, numOctaves, octavePersistence, octaveScale, true, seed );
+	for ( unsigned int z = 0; z < numGrid3DZ; z++ )
+		for ( unsigned int y = 0; y < numGrid3DY; y++ )
+			for ( unsigned int x = 0; x < numGrid3DX; x++ )
+			{
+				scalarNoise[ ( ( ( z * numGrid3DY ) + y ) * numGrid3DX ) + x ] =
+					Compute3dFractalNoise( mins3D.x + ( static_cast<float>( x ) * step3D.x ), mins3D.y + ( static_cast<float>( y ) * step3D.y ), mins3D.z + ( static_cast<float>( z ) * step3D.z ),
+										   scale, numOctaves, octavePersistence, octaveScale, true, seed );
+			}
+	didPass &= ReportNoiseTest( "3D grid", CountMismatches( batchNoise, scalarNoise ), numGrid3DX * numGrid3DY * numGrid3DZ );
+
+	g_theConsole->Printf( "NoiseBatchTest: %d octaves: %s", numOctaves, didPass ? "PASS" : "FAIL" );
+	return didPass;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void NoiseBatchTest( Command& args )
+{
+	int numOctaves;
+	args.GetNextInt( &numOctaves, DEFAULT_NOISE_TEST_OCTAVES );
+	if ( numOctaves < 1 )
+	{
+		g_theConsole->Printf( "Usage: NoiseBatchTest [numOctaves = %d]", DEFAULT_NOISE_TEST_OCTAVES );
+		return;
+	}
+
+	RunNoiseBatchTest( numOctaves );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void NoiseBatchBenchmark( Command& args )
+{
+	int gridSize;
+	args.GetNextInt( &gridSize, DEFAULT_NOISE_BENCHMARK_GRID_SIZE );
+	int numOctaves;
+	args.GetNextInt( &numOctaves, DEFAULT_NOISE_BENCHMARK_OCTAVES );
+	if ( ( gridSize < 1 ) || ( numOctaves < 1 ) )
+	{
+		g_theConsole->Printf( "Usage: NoiseBatchBenchmark [gridSize = %d] [numOctaves = %d]", DEFAULT_NOISE_BENCHMARK_GRID_SIZE, DEFAULT_NOISE_BENCHMARK_OCTAVES );
+		return;
+	}
+
+	const Vector2f mins( -512.f, -512.f );
+	const Vector2f step( .5f, .5f );
+	const float scale = 64.f;
+	unsigned int numSamples = gridSize * gridSize;
+	std::vector< float > noise( numSamples );
+
+	double startSeconds = GetCurrentTimeSeconds();
+	for ( int y = 0; y < gridSize; y++ )
+		for ( int x = 0; x < gridSize; x++ )
+			noise[ ( y * gridSize ) + x ] = Compute2dFractalNoise( mins.x + ( static_cast<float>( x ) * step.x ), mins.y + ( static_cast<float>( y ) * step.y ), scale, numOctaves );
+	double scalarSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	startSeconds = GetCurrentTimeSeconds();
+	Compute2dFractalNoiseGrid( mins, step, gridSize, gridSize, noise.data(), scale, numOctaves, 0.5f, 2.f, true, 0, false );
+	double batchSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	startSeconds = GetCurrentTimeSeconds();
+	Compute2dFractalNoiseGrid( mins, step, gridSize, gridSize, noise.data(), scale, numOctaves );
+	double jobSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	const double MEGA = 1000000.0;
+	g_theConsole->Printf( "NoiseBatchBenchmark: %dx%d 2D fractal field, %d octaves:", gridSize, gridSize, numOctaves );
+	g_theConsole->Printf( "  Scalar:  %.2f Msamples/sec", numSamples / scalarSeconds / MEGA );
+	g_theConsole->Printf( "  Batched: %.2f Msamples/sec (%.2fx)", numSamples / batchSeconds / MEGA, scalarSeconds / batchSeconds );
+	g_theConsole->Printf( "  Batched + jobs: %.2f Msamples/sec (%.2fx)%s", numSamples / jobSeconds / MEGA, scalarSeconds / jobSeconds,
+						  JobSystem::Instance()->IsRunning() ? "" : ", JobSystem isn't running" );
+}
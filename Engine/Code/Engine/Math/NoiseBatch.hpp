@@ -0,0 +1,45 @@
+#pragma once
+
+
+#include "Engine/Math/Vector2.hpp"
+#include "Engine/Math/Vector3.hpp"
+
+
+//-----------------------------------------------------------------------------
+class Command;
+
+
+//-----------------------------------------------------------------------------
+//Batch versions of Noise.hpp's fractal noise. SSE evaluates each octave for 4 samples at once, and every sample
+//comes out bit-identical to the scalar Compute*FractalNoise call for it, so batch and scalar results can mix freely.
+//Parameters after out_noise mean the same as for the scalar functions.
+
+
+//-----------------------------------------------------------------------------
+//Point lists: out_noise[ i ] is the noise at ( positionsX[ i ], positionsY[ i ], ... ). Any length; the last 0-3 run scalar.
+void Compute1dFractalNoiseBatch( const float* positions, unsigned int numPositions, float* out_noise,
+								 float scale = 1.f, unsigned int numOctaves = 1, float octavePersistence = 0.5f, float octaveScale = 2.f, bool renormalize = true, unsigned int seed = 0 );
+void Compute2dFractalNoiseBatch( const float* positionsX, const float* positionsY, unsigned int numPositions, float* out_noise,
+								 float scale = 1.f, unsigned int numOctaves = 1, float octavePersistence = 0.5f, float octaveScale = 2.f, bool renormalize = true, unsigned int seed = 0 );
+void Compute3dFractalNoiseBatch( const float* positionsX, const float* positionsY, const float* positionsZ, unsigned int numPositions, float* out_noise,
+								 float scale = 1.f, unsigned int numOctaves = 1, float octavePersistence = 0.5f, float octaveScale = 2.f, bool renormalize = true, unsigned int seed = 0 );
+
+
+//-----------------------------------------------------------------------------
+//Grids: sample ( x, y, z ) sits at mins + ( index * step ) per axis, stored row-major in out_noise[ ( ( ( z * numY ) + y ) * numX ) + x ].
+//Big grids split across JobSystem workers while it's running, unless useJobSystem is false. Returns when the grid is filled either way.
+void Compute1dFractalNoiseGrid( float minX, float stepX, unsigned int numX, float* out_noise,
+								float scale = 1.f, unsigned int numOctaves = 1, float octavePersistence = 0.5f, float octaveScale = 2.f, bool renormalize = true, unsigned int seed = 0,
+								bool useJobSystem = true );
+void Compute2dFractalNoiseGrid( const Vector2f& mins, const Vector2f& step, unsigned int numX, unsigned int numY, float* out_noise,
+								float scale = 1.f, unsigned int numOctaves = 1, float octavePersistence = 0.5f, float octaveScale = 2.f, bool renormalize = true, unsigned int seed = 0,
+								bool useJobSystem = true );
+void Compute3dFractalNoiseGrid( const Vector3f& mins, const Vector3f& step, unsigned int numX, unsigned int numY, unsigned int numZ, float* out_noise,
+								float scale = 1.f, unsigned int numOctaves = 1, float octavePersistence = 0.5f, float octaveScale = 2.f, bool renormalize = true, unsigned int seed = 0,
+								bool useJobSystem = true );
+
+
+//-----------------------------------------------------------------------------
+bool RunNoiseBatchTest( int numOctaves ); //NoiseBatchTest's checks, also run by EngineTests. True if all passed.
+void NoiseBatchTest( Command& args ); //NoiseBatchTest [numOctaves]: compares every batch and grid function bit-for-bit against the scalar ones.
+void NoiseBatchBenchmark( Command& args ); //NoiseBatchBenchmark [gridSize] [numOctaves]: samples/sec for a 2D fractal field, scalar vs batched vs jobs.
@@ -0,0 +1,159 @@
+#include "Engine/Math/RandomStream.hpp"
+
+
+#include "Engine/Math/Noise.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <atomic>
+
+
+//--------------------------------------------------------------------------------------------------------------
+static std::atomic< unsigned long long > s_threadLocalBaseSeed( RandomStream::DEFAULT_SEED );
+static std::atomic< unsigned int > s_numThreadLocalStreams( 0 );
+static std::atomic< unsigned int > s_numWorkItems( 0 );
+
+
+//--------------------------------------------------------------------------------------------------------------
+static unsigned long long MixSeedBits( unsigned long long seed ) //SplitMix64's finalizer: neighboring seeds (0, 1, 2...) give unrelated streams.
+{
+	seed += 0x9E3779B97F4A7C15ULL;
+	seed = ( seed ^ ( seed >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+	seed = ( seed ^ ( seed >> 27 ) ) * 0x94D049BB133111EBULL;
+	return seed ^ ( seed >> 31 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+RandomStream::RandomStream( unsigned long long seed, RandomGenerator generator )
+	: m_generator( generator )
+{
+	Seed( seed );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC RandomStream& RandomStream::GetThreadLocal()
+{
+	//Each thread's first call seeds its stream off the base seed and the order threads asked in, so no two threads share draws.
+	thread_local RandomStream s_threadLocalStream( MixSeedBits( s_threadLocalBaseSeed.load() + s_numThreadLocalStreams.fetch_add( 1 ) ) );
+	return s_threadLocalStream;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RandomStream::SetThreadLocalBaseSeed( unsigned long long baseSeed )
+{
+	s_threadLocalBaseSeed = baseSeed;
+	s_numThreadLocalStreams = 0;
+	s_numWorkItems = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int RandomStream::GetNextWorkItemIndex()
+{
+	return s_numWorkItems.fetch_add( 1 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned long long RandomStream::GetSeedForWorkItem( unsigned int workItemIndex )
+{
+	//Offset so work item 0 doesn't repeat the first thread-local stream's seed.
+	const unsigned long long WORK_ITEM_SEED_OFFSET = 0xA0761D6478BD642FULL;
+	return MixSeedBits( ( s_threadLocalBaseSeed.load() ^ WORK_ITEM_SEED_OFFSET ) + workItemIndex );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RandomStream::Seed( unsigned long long seed )
+{
+	m_seed = seed;
+	m_position = 0;
+
+	//PCG32's recommended seeding: the seed picks the stream, then sets the state one step in.
+	m_increment = ( MixSeedBits( seed ) << 1 ) | 1;
+	m_state = 0;
+	GetNextPcg32();
+	m_state += seed;
+	GetNextPcg32();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RandomStream::SetPosition( unsigned int position )
+{
+	GUARANTEE_OR_DIE( m_generator == RANDOM_GENERATOR_SQUIRREL_NOISE, "RandomStream::SetPosition only jumps counter-based streams!" );
+	m_position = position;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int RandomStream::GetNextUint()
+{
+	unsigned int position = m_position++;
+	if ( m_generator == RANDOM_GENERATOR_SQUIRREL_NOISE )
+		return Get1dNoiseUint( static_cast<int>( position ), static_cast<unsigned int>( m_seed ^ ( m_seed >> 32 ) ) );
+
+	return GetNextPcg32();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Vector2f RandomStream::GetUnitVector2D()
+{
+	float radians = GetFloatZeroTo( fTWO_PI );
+	return Vector2f( cos( radians ), sin( radians ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Vector3f RandomStream::GetUnitVector3D()
+{
+	//Archimedes: a uniform height on the unit sphere's axis, and a uniform angle around it, cover its area uniformly.
+	float z = GetFloatInRange( -1.f, 1.f );
+	float radians = GetFloatZeroTo( fTWO_PI );
+	float radiusAtZ = sqrt( GetMax( 0.f, 1.f - ( z * z ) ) );
+	return Vector3f( radiusAtZ * cos( radians ), radiusAtZ * sin( radians ), z );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Vector2f RandomStream::GetPointInDisc( const Vector2f& center, float radius )
+{
+	//Area grows with the radius squared, so the square root keeps points from crowding the center.
+	float distance = radius * sqrt( GetFloatZeroToOne() );
+	float radians = GetFloatZeroTo( fTWO_PI );
+	return center + Vector2f( distance * cos( radians ), distance * sin( radians ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RandomStream::FillFloatsInRange( float* out_floats, unsigned int numFloats, float minimumInclusive, float maximumInclusive )
+{
+	for ( unsigned int floatIndex = 0; floatIndex < numFloats; floatIndex++ )
+		out_floats[ floatIndex ] = GetFloatInRange( minimumInclusive, maximumInclusive );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RandomStream::FillUnitVectors2D( Vector2f* out_vectors, unsigned int numVectors )
+{
+	for ( unsigned int vectorIndex = 0; vectorIndex < numVectors; vectorIndex++ )
+		out_vectors[ vectorIndex ] = GetUnitVector2D();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RandomStream::FillUnitVectors3D( Vector3f* out_vectors, unsigned int numVectors )
+{
+	for ( unsigned int vectorIndex = 0; vectorIndex < numVectors; vectorIndex++ )
+		out_vectors[ vectorIndex ] = GetUnitVector3D();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RandomStream::FillPointsInDisc( Vector2f* out_points, unsigned int numPoints, const Vector2f& center, float radius )
+{
+	for ( unsigned int pointIndex = 0; pointIndex < numPoints; pointIndex++ )
+		out_points[ pointIndex ] = GetPointInDisc( center, radius );
+}
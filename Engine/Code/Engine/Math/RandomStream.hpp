@@ -0,0 +1,124 @@
+#pragma once
+
+
+#include "Engine/Math/Vector2.hpp"
+#include "Engine/Math/Vector3.hpp"
+
+
+//-----------------------------------------------------------------------------
+enum RandomGenerator
+{
+	RANDOM_GENERATOR_PCG32, //O'Neill's PCG-XSH-RR: 64 bits of state, a 2^64 period, and the seed also picks one of 2^63 distinct streams.
+	RANDOM_GENERATOR_SQUIRREL_NOISE, //Counter-based: value i is Get1dNoiseUint( i, seed ), so any position can be jumped to, e.g. to split draws across jobs.
+	NUM_RANDOM_GENERATORS
+};
+
+
+//-----------------------------------------------------------------------------
+//A seedable random number sequence: the same seed and generator always give the same draws, so replays can reproduce them.
+//Unlike rand(), each stream's state is its own. Share one between threads only with your own locking--instead, have each thread
+//use GetThreadLocal(), or hand each job a stream (or a SquirrelNoise position range) of its own.
+//The job system reseeds GetThreadLocal() from GetSeedForWorkItem() around every job, so a job's draws don't depend on which thread ran it.
+class RandomStream
+{
+public:
+	static const unsigned long long DEFAULT_SEED = 0x853C49E6748FEA9BULL;
+
+	explicit RandomStream( unsigned long long seed = DEFAULT_SEED, RandomGenerator generator = RANDOM_GENERATOR_PCG32 );
+
+	static RandomStream& GetThreadLocal(); //The calling thread's own PCG32 stream, seeded distinctly per thread until someone calls Seed on it.
+	static void SetThreadLocalBaseSeed( unsigned long long baseSeed ); //Streams threads make after this derive their seeds from it, as do work items. Restarts work item indices.
+	static unsigned int GetNextWorkItemIndex(); //Taken in creation order, so work items made by one thread get the same indices each run.
+	static unsigned long long GetSeedForWorkItem( unsigned int workItemIndex ); //Base seed plus the index, with its bits mixed.
+
+	void Seed( unsigned long long seed ); //Restarts the sequence, so the draws after it replay exactly.
+	unsigned long long GetSeed() const { return m_seed; }
+	RandomGenerator GetGenerator() const { return m_generator; }
+	unsigned int GetPosition() const { return m_position; } //Draws since Seed, mod 2^32.
+	void SetPosition( unsigned int position ); //SquirrelNoise only: jumps straight to a draw.
+
+	unsigned int GetNextUint();
+	float GetFloatZeroToOne(); //Inclusive of both ends, like GetRandomFloatZeroTo( 1.f ).
+	float GetFloatZeroTo( float maximumInclusive ) { return GetFloatZeroToOne() * maximumInclusive; }
+	float GetFloatInRange( float minimumInclusive, float maximumInclusive ) { return minimumInclusive + ( GetFloatZeroToOne() * ( maximumInclusive - minimumInclusive ) ); }
+	int GetIntLessThan( int maxExclusive ); //0 to maxExclusive - 1, using all 32 bits rather than a modulus of 15.
+	int GetIntInRange( int minInclusive, int maxInclusive ) { return minInclusive + GetIntLessThan( 1 + maxInclusive - minInclusive ); }
+	bool GetChance( float probabilityOfReturningTrue );
+	template < typename T > T GetElementInRange( T minInclusive, T maxInclusive );
+	Vector2f GetUnitVector2D();
+	Vector3f GetUnitVector3D(); //Uniform over the sphere.
+	Vector2f GetPointInDisc( const Vector2f& center, float radius ); //Uniform over the area, not bunched at the center.
+
+	//Bulk fills, same draws as calling the single versions in a loop.
+	void FillFloatsInRange( float* out_floats, unsigned int numFloats, float minimumInclusive, float maximumInclusive );
+	void FillUnitVectors2D( Vector2f* out_vectors, unsigned int numVectors );
+	void FillUnitVectors3D( Vector3f* out_vectors, unsigned int numVectors );
+	void FillPointsInDisc( Vector2f* out_points, unsigned int numPoints, const Vector2f& center, float radius );
+
+
+private:
+	unsigned int GetNextPcg32();
+
+	RandomGenerator m_generator;
+	unsigned long long m_seed;
+	unsigned long long m_state; //PCG32's.
+	unsigned long long m_increment; //PCG32's stream selector, always odd.
+	unsigned int m_position;
+};
+
+
+//-----------------------------------------------------------------------------
+inline unsigned int RandomStream::GetNextPcg32()
+{
+	const unsigned long long PCG32_MULTIPLIER = 6364136223846793005ULL;
+
+	unsigned long long oldState = m_state;
+	m_state = ( oldState * PCG32_MULTIPLIER ) + m_increment;
+	unsigned int xorShifted = static_cast<unsigned int>( ( ( oldState >> 18 ) ^ oldState ) >> 27 );
+	unsigned int rotation = static_cast<unsigned int>( oldState >> 59 );
+	return ( xorShifted >> rotation ) | ( xorShifted << ( ( 32 - rotation ) & 31 ) );
+}
+
+
+//-----------------------------------------------------------------------------
+inline float RandomStream::GetFloatZeroToOne()
+{
+	const float ONE_OVER_MAX_24_BITS = 1.f / 16777215.f; //24 bits fit a float's mantissa exactly, so every value is equally likely.
+	return static_cast<float>( GetNextUint() >> 8 ) * ONE_OVER_MAX_24_BITS;
+}
+
+
+//-----------------------------------------------------------------------------
+inline int RandomStream::GetIntLessThan( int maxExclusive )
+{
+	//Scales 32 random bits to the range instead of taking a modulus: no low-bit patterns, and bias under range / 2^32.
+	unsigned long long scaled = static_cast<unsigned long long>( GetNextUint() ) * static_cast<unsigned int>( maxExclusive );
+	return static_cast<int>( scaled >> 32 );
+}
+
+
+//-----------------------------------------------------------------------------
+inline bool RandomStream::GetChance( float probabilityOfReturningTrue )
+{
+	if ( probabilityOfReturningTrue >= 1.f )
+		return true;
+
+	return GetFloatZeroToOne() < probabilityOfReturningTrue;
+}
+
+
+//-----------------------------------------------------------------------------
+template < typename T > inline T RandomStream::GetElementInRange( T minInclusive, T maxInclusive )
+{
+	const float randomZeroToOne = GetFloatZeroToOne();
+	return minInclusive + static_cast<T>( ( maxInclusive - minInclusive ) * randomZeroToOne );
+}
+
+
+//-----------------------------------------------------------------------------
+template <> inline Vector2f RandomStream::GetElementInRange( Vector2f minInclusive, Vector2f maxInclusive )
+{
+	const float randomZeroToOneX = GetFloatZeroToOne();
+	const float randomZeroToOneY = GetFloatZeroToOne();
+	return minInclusive + Vector2f( ( maxInclusive.x - minInclusive.x ) * randomZeroToOneX, ( maxInclusive.y - minInclusive.y ) * randomZeroToOneY );
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+
+#include "Engine/BuildConfig.hpp"
+#include "Engine/Math/Vector3.hpp"
+#include "Engine/Math/Vector4.hpp"
+
+
+//-----------------------------------------------------------------------------
+//Every x86 and x64 target this builds for has SSE2 (MSVC's x86 default since /arch:SSE2 became it), but keep a plain float path
+//for anything else, and for BuildConfig's MATH_DISABLE_SIMD. Both paths round identically: no fused or reordered math in either.
+#if !defined( MATH_DISABLE_SIMD ) && ( defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) || defined( __SSE2__ ) )
+	#define MATH_USE_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+//-----------------------------------------------------------------------------
+//Four floats meant to live in a register, for Matrix44 and other batch math. Vector4f stays the storage and interface type;
+//convert at the edges of a loop, not per operation. Pass by const reference: x86 MSVC only passes three of these by value.
+class Vec4
+{
+public:
+	Vec4() {} //Uninitialized, like the register it stands for.
+	explicit Vec4( float xyzw );
+	Vec4( float x, float y, float z, float w );
+	explicit Vec4( const Vector4f& xyzw );
+	Vec4( const Vector3f& xyz, float w );
+
+	static Vec4 Load( const float* fourFloats ); //No alignment needed.
+	void Store( float* out_fourFloats ) const;
+	void StoreXYZ( float* out_threeFloats ) const; //Leaves out_threeFloats[ 3 ] alone, so it can write into packed Vector3f arrays.
+	Vector4f GetAsVector4f() const;
+	Vector3f GetAsVector3f() const;
+
+	float GetX() const;
+	Vec4 SplatX() const; //( x, x, x, x ).
+	Vec4 SplatY() const;
+	Vec4 SplatZ() const;
+	Vec4 SplatW() const;
+
+	Vec4 operator+( const Vec4& rhs ) const;
+	Vec4 operator-( const Vec4& rhs ) const;
+	Vec4 operator*( const Vec4& rhs ) const; //Componentwise.
+	Vec4 operator*( float scale ) const;
+	Vec4 operator-() const;
+
+	friend float DotProduct3( const Vec4& lhs, const Vec4& rhs ); //Ignores w.
+	friend Vec4 CrossProduct3( const Vec4& lhs, const Vec4& rhs ); //w comes out 0 for finite inputs.
+	friend void TransposeVec4s( Vec4& inout_row0, Vec4& inout_row1, Vec4& inout_row2, Vec4& inout_row3 ); //As the rows of a 4x4 matrix.
+
+
+private:
+#ifdef MATH_USE_SSE2
+	explicit Vec4( __m128 xyzw ) : m_xyzw( xyzw ) {}
+	__m128 m_xyzw;
+#else
+	float m_xyzw[ 4 ];
+#endif
+};
+
+
+#ifdef MATH_USE_SSE2
+//-----------------------------------------------------------------------------
+inline Vec4::Vec4( float xyzw ) : m_xyzw( _mm_set1_ps( xyzw ) ) {}
+inline Vec4::Vec4( float x, float y, float z, float w ) : m_xyzw( _mm_setr_ps( x, y, z, w ) ) {}
+inline Vec4::Vec4( const Vector4f& xyzw ) : m_xyzw( _mm_loadu_ps( &xyzw.x ) ) {}
+inline Vec4::Vec4( const Vector3f& xyz, float w ) : m_xyzw( _mm_setr_ps( xyz.x, xyz.y, xyz.z, w ) ) {}
+inline Vec4 Vec4::Load( const float* fourFloats ) { return Vec4( _mm_loadu_ps( fourFloats ) ); }
+inline void Vec4::Store( float* out_fourFloats ) const { _mm_storeu_ps( out_fourFloats, m_xyzw ); }
+inline float Vec4::GetX() const { return _mm_cvtss_f32( m_xyzw ); }
+inline Vec4 Vec4::SplatX() const { return Vec4( _mm_shuffle_ps( m_xyzw, m_xyzw, _MM_SHUFFLE( 0, 0, 0, 0 ) ) ); }
+inline Vec4 Vec4::SplatY() const { return Vec4( _mm_shuffle_ps( m_xyzw, m_xyzw, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ); }
+inline Vec4 Vec4::SplatZ() const { return Vec4( _mm_shuffle_ps( m_xyzw, m_xyzw, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ); }
+inline Vec4 Vec4::SplatW() const { return Vec4( _mm_shuffle_ps( m_xyzw, m_xyzw, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ); }
+inline Vec4 Vec4::operator+( const Vec4& rhs ) const { return Vec4( _mm_add_ps( m_xyzw, rhs.m_xyzw ) ); }
+inline Vec4 Vec4::operator-( const Vec4& rhs ) const { return Vec4( _mm_sub_ps( m_xyzw, rhs.m_xyzw ) ); }
+inline Vec4 Vec4::operator*( const Vec4& rhs ) const { return Vec4( _mm_mul_ps( m_xyzw, rhs.m_xyzw ) ); }
+inline Vec4 Vec4::operator*( float scale ) const { return Vec4( _mm_mul_ps( m_xyzw, _mm_set1_ps( scale ) ) ); }
+inline Vec4 Vec4::operator-() const { return Vec4( _mm_xor_ps( m_xyzw, _mm_set1_ps( -0.f ) ) ); }
+
+
+//-----------------------------------------------------------------------------
+inline void Vec4::StoreXYZ( float* out_threeFloats ) const
+{
+	_mm_storel_pi( reinterpret_cast<__m64*>( out_threeFloats ), m_xyzw );
+	_mm_store_ss( out_threeFloats + 2, _mm_movehl_ps( m_xyzw, m_xyzw ) );
+}
+
+
+//-----------------------------------------------------------------------------
+inline float DotProduct3( const Vec4& lhs, const Vec4& rhs )
+{
+	__m128 products = _mm_mul_ps( lhs.m_xyzw, rhs.m_xyzw );
+	__m128 sum = _mm_add_ss( products, _mm_shuffle_ps( products, products, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+	sum = _mm_add_ss( sum, _mm_movehl_ps( products, products ) );
+	return _mm_cvtss_f32( sum );
+}
+
+
+//-----------------------------------------------------------------------------
+inline Vec4 CrossProduct3( const Vec4& lhs, const Vec4& rhs )
+{
+	__m128 lhsYZX = _mm_shuffle_ps( lhs.m_xyzw, lhs.m_xyzw, _MM_SHUFFLE( 3, 0, 2, 1 ) );
+	__m128 rhsYZX = _mm_shuffle_ps( rhs.m_xyzw, rhs.m_xyzw, _MM_SHUFFLE( 3, 0, 2, 1 ) );
+	__m128 lhsZXY = _mm_shuffle_ps( lhs.m_xyzw, lhs.m_xyzw, _MM_SHUFFLE( 3, 1, 0, 2 ) );
+	__m128 rhsZXY = _mm_shuffle_ps( rhs.m_xyzw, rhs.m_xyzw, _MM_SHUFFLE( 3, 1, 0, 2 ) );
+	return Vec4( _mm_sub_ps( _mm_mul_ps( lhsYZX, rhsZXY ), _mm_mul_ps( lhsZXY, rhsYZX ) ) );
+}
+
+
+//-----------------------------------------------------------------------------
+inline void TransposeVec4s( Vec4& inout_row0, Vec4& inout_row1, Vec4& inout_row2, Vec4& inout_row3 )
+{
+	_MM_TRANSPOSE4_PS( inout_row0.m_xyzw, inout_row1.m_xyzw, inout_row2.m_xyzw, inout_row3.m_xyzw );
+}
+
+
+#else
+//-----------------------------------------------------------------------------
+inline Vec4::Vec4( float xyzw ) { m_xyzw[ 0 ] = m_xyzw[ 1 ] = m_xyzw[ 2 ] = m_xyzw[ 3 ] = xyzw; }
+inline Vec4::Vec4( float x, float y, float z, float w ) { m_xyzw[ 0 ] = x; m_xyzw[ 1 ] = y; m_xyzw[ 2 ] = z; m_xyzw[ 3 ] = w; }
+inline Vec4::Vec4( const Vector4f& xyzw ) { m_xyzw[ 0 ] = xyzw.x; m_xyzw[ 1 ] = xyzw.y; m_xyzw[ 2 ] = xyzw.z; m_xyzw[ 3 ] = xyzw.w; }
+inline Vec4::Vec4( const Vector3f& xyz, float w ) { m_xyzw[ 0 ] = xyz.x; m_xyzw[ 1 ] = xyz.y; m_xyzw[ 2 ] = xyz.z; m_xyzw[ 3 ] = w; }
+inline Vec4 Vec4::Load( const float* fourFloats ) { return Vec4( fourFloats[ 0 ], fourFloats[ 1 ], fourFloats[ 2 ], fourFloats[ 3 ] ); }
+inline void Vec4::Store( float* out_fourFloats ) const { for ( int i = 0; i < 4; i++ ) out_fourFloats[ i ] = m_xyzw[ i ]; }
+inline void Vec4::StoreXYZ( float* out_threeFloats ) const { for ( int i = 0; i < 3; i++ ) out_threeFloats[ i ] = m_xyzw[ i ]; }
+inline float Vec4::GetX() const { return m_xyzw[ 0 ]; }
+inline Vec4 Vec4::SplatX() const { return Vec4( m_xyzw[ 0 ] ); }
+inline Vec4 Vec4::SplatY() const { return Vec4( m_xyzw[ 1 ] ); }
+inline Vec4 Vec4::SplatZ() const { return Vec4( m_xyzw[ 2 ] ); }
+inline Vec4 Vec4::SplatW() const { return Vec4( m_xyzw[ 3 ] ); }
+
+
+//-----------------------------------------------------------------------------
+inline Vec4 Vec4::operator+( const Vec4& rhs ) const
+{
+	return Vec4( m_xyzw[ 0 ] + rhs.m_xyzw[ 0 ], m_xyzw[ 1 ] + rhs.m_xyzw[ 1 ], m_xyzw[ 2 ] + rhs.m_xyzw[ 2 ], m_xyzw[ 3 ] + rhs.m_xyzw[ 3 ] );
+}
+
+
+//-----------------------------------------------------------------------------
+inline Vec4 Vec4::operator-( const Vec4& rhs ) const
+{
+	return Vec4( m_xyzw[ 0 ] - rhs.m_xyzw[ 0 ], m_xyzw[ 1 ] - rhs.m_xyzw[ 1 ], m_xyzw[ 2 ] - rhs.m_xyzw[ 2 ], m_xyzw[ 3 ] - rhs.m_xyzw[ 3 ] );
+}
+
+
+//-----------------------------------------------------------------------------
+inline Vec4 Vec4::operator*( const Vec4& rhs ) const
+{
+	return Vec4( m_xyzw[ 0 ] * rhs.m_xyzw[ 0 ], m_xyzw[ 1 ] * rhs.m_xyzw[ 1 ], m_xyzw[ 2 ] * rhs.m_xyzw[ 2 ], m_xyzw[ 3 ] * rhs.m_xyzw[ 3 ] );
+}
+
+
+//-----------------------------------------------------------------------------
+inline Vec4 Vec4::operator*( float scale ) const
+{
+	return Vec4( m_xyzw[ 0 ] * scale, m_xyzw[ 1 ] * scale, m_xyzw[ 2 ] * scale, m_xyzw[ 3 ] * scale );
+}
+
+
+//-----------------------------------------------------------------------------
+inline Vec4 Vec4::operator-() const
+{
+	return Vec4( -m_xyzw[ 0 ], -m_xyzw[ 1 ], -m_xyzw[ 2 ], -m_xyzw[ 3 ] );
+}
+
+
+//-----------------------------------------------------------------------------
+inline float DotProduct3( const Vec4& lhs, const Vec4& rhs )
+{
+	return ( lhs.m_xyzw[ 0 ] * rhs.m_xyzw[ 0 ] + lhs.m_xyzw[ 1 ] * rhs.m_xyzw[ 1 ] ) + lhs.m_xyzw[ 2 ] * rhs.m_xyzw[ 2 ];
+}
+
+
+//-----------------------------------------------------------------------------
+inline Vec4 CrossProduct3( const Vec4& lhs, const Vec4& rhs )
+{
+	const float* l = lhs.m_xyzw;
+	const float* r = rhs.m_xyzw;
+	return Vec4( l[ 1 ] * r[ 2 ] - l[ 2 ] * r[ 1 ], l[ 2 ] * r[ 0 ] - l[ 0 ] * r[ 2 ], l[ 0 ] * r[ 1 ] - l[ 1 ] * r[ 0 ], l[ 3 ] * r[ 3 ] - l[ 3 ] * r[ 3 ] );
+}
+
+
+//-----------------------------------------------------------------------------
+inline void TransposeVec4s( Vec4& inout_row0, Vec4& inout_row1, Vec4& inout_row2, Vec4& inout_row3 )
+{
+	float* rows[ 4 ] = { inout_row0.m_xyzw, inout_row1.m_xyzw, inout_row2.m_xyzw, inout_row3.m_xyzw };
+	for ( int row = 0; row < 4; row++ )
+	{
+		for ( int column = row + 1; column < 4; column++ )
+		{
+			float swapped = rows[ row ][ column ];
+			rows[ row ][ column ] = rows[ column ][ row ];
+			rows[ column ][ row ] = swapped;
+		}
+	}
+}
+#endif
+
+
+//-----------------------------------------------------------------------------
+inline Vector4f Vec4::GetAsVector4f() const
+{
+	Vector4f result;
+	Store( &result.x );
+	return result;
+}
+
+
+//-----------------------------------------------------------------------------
+inline Vector3f Vec4::GetAsVector3f() const
+{
+	Vector3f result;
+	StoreXYZ( &result.x );
+	return result;
+}
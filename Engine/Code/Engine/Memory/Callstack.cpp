@@ -1,243 +1,392 @@
 #include "Engine/Memory/Callstack.hpp"
 
-#define WIN32_LEAN_AND_MEAN
-#define _WINSOCKAPI_
-#include <Windows.h>
-#include <DbgHelp.h>
 
-#include "Engine/Memory/CBuffer.hpp"
+#include "Engine/BuildConfig.hpp"
 #include "Engine/EngineCommon.hpp"
-#include "Engine/Memory/UntrackedAllocator.hpp"
+#include "Engine/Concurrency/CriticalSection.hpp"
+#include "Engine/Core/Command.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Time/Time.hpp"
+#include <atomic>
+#include <string.h>
+
+#if defined( PLATFORM_WINDOWS )
+	#pragma warning( disable : 4091 ) // Removing warning about typedef on an unnamed enum in DbgHelp.h
+	#define WIN32_LEAN_AND_MEAN
+	#define _WINSOCKAPI_
+	#include <Windows.h>
+	#include <DbgHelp.h>
+#endif
+
 
 //--------------------------------------------------------------------------------------------------------------
-#define MAX_CALLSTACK_DEPTH 128
+//The intern table: open addressing over atomic slots, never more than half full. Callstacks and their frames come out of
+//fixed arenas, since capturing runs inside operator new and can't allocate. A thread that loses a race to fill a slot
+//with the same frames wastes its copy, a few bytes of arena, and returns the winner's.
+static const unsigned int MAX_UNIQUE_CALLSTACKS = 16384;
+static const unsigned int CALLSTACK_TABLE_SIZE = MAX_UNIQUE_CALLSTACKS * 2; //Power of two, for masking.
+static const unsigned int MAX_INTERNED_STACK_FRAMES = MAX_UNIQUE_CALLSTACKS * 32;
+static const int DEFAULT_CALLSTACK_BENCHMARK_CAPTURES = 100000;
+
+static Callstack s_internedCallstacks[ MAX_UNIQUE_CALLSTACKS ];
+static void* s_internedStackFrames[ MAX_INTERNED_STACK_FRAMES ];
+static std::atomic< unsigned int > s_numInternedCallstacks( 0 );
+static std::atomic< unsigned int > s_numInternedStackFrames( 0 );
+static std::atomic< Callstack* > s_callstackTable[ CALLSTACK_TABLE_SIZE ];
+
+static CallstackLine g_callstackBuffer[ MAX_CALLSTACK_DEPTH ];
+static CriticalSection s_callstackBufferLock; //Guards g_callstackBuffer, and the platform's symbolizer, which needn't be thread-safe.
 
 
 //--------------------------------------------------------------------------------------------------------------
-typedef BOOL ( __stdcall* sym_initialize_t )( IN HANDLE hProcess, IN PSTR UserSearchPath, IN BOOL fInvadeProcess );
-typedef BOOL ( __stdcall* sym_cleanup_t )( IN HANDLE hPROCESS );
-typedef BOOL ( __stdcall* sym_from_addr_t )( IN HANDLE hProcess, IN DWORD64 Address, OUT PDWORD64 Displacement, OUT PSYMBOL_INFO Symbol );
+static uint32_t HashStackFrames( void* const* stackFrames, unsigned int stackFrameCount )
+{
+	//FNV-1a, a pointer at a time.
+	uint64_t hash = 14695981039346656037ULL;
+	for ( unsigned int frameIndex = 0; frameIndex < stackFrameCount; frameIndex++ )
+	{
+		hash ^= static_cast<uint64_t>( reinterpret_cast<uintptr_t>( stackFrames[ frameIndex ] ) );
+		hash *= 1099511628211ULL;
+	}
+	return static_cast<uint32_t>( hash ^ ( hash >> 32 ) );
+}
 
-typedef BOOL ( __stdcall* sym_get_line_t )( IN HANDLE hProcess, IN DWORD64 dwAddr, OUT PDWORD pdwDisplacement, OUT PIMAGEHLP_LINE64 Symbol );
+
+//--------------------------------------------------------------------------------------------------------------
+static Callstack* CreateInternedCallstack( void* const* stackFrames, unsigned int stackFrameCount, uint32_t hash )
+{
+	unsigned int callstackIndex = s_numInternedCallstacks.fetch_add( 1 );
+	unsigned int firstFrameIndex = s_numInternedStackFrames.fetch_add( stackFrameCount );
+	if ( ( callstackIndex >= MAX_UNIQUE_CALLSTACKS ) || ( firstFrameIndex + stackFrameCount > MAX_INTERNED_STACK_FRAMES ) )
+		return nullptr;
+
+	Callstack* cs = &s_internedCallstacks[ callstackIndex ];
+	cs->stackFrames = &s_internedStackFrames[ firstFrameIndex ];
+	cs->stackFrameCount = stackFrameCount;
+	cs->hash = hash;
+	memcpy( cs->stackFrames, stackFrames, sizeof( void* ) * stackFrameCount );
+	return cs;
+}
 
 
 //--------------------------------------------------------------------------------------------------------------
-static HMODULE g_debugHelp;
-static HANDLE g_process;
-static SYMBOL_INFO* g_symbol;
+static Callstack* InternCallstack( void* const* stackFrames, unsigned int stackFrameCount )
+{
+	const uint32_t hash = HashStackFrames( stackFrames, stackFrameCount );
+	Callstack* newCallstack = nullptr; //Made at most once, when the probe first reaches an empty slot.
 
-static CallstackLine g_callstackBuffer[ MAX_CALLSTACK_DEPTH ];
+	for ( unsigned int probe = 0; probe < CALLSTACK_TABLE_SIZE; probe++ )
+	{
+		std::atomic< Callstack* >& slot = s_callstackTable[ ( hash + probe ) & ( CALLSTACK_TABLE_SIZE - 1 ) ];
+		Callstack* existing = slot.load( std::memory_order_acquire );
+		if ( existing == nullptr )
+		{
+			if ( newCallstack == nullptr )
+			{
+				newCallstack = CreateInternedCallstack( stackFrames, stackFrameCount, hash );
+				if ( newCallstack == nullptr )
+					return nullptr;
+			}
+
+			if ( slot.compare_exchange_strong( existing, newCallstack, std::memory_order_acq_rel, std::memory_order_acquire ) )
+				return newCallstack;
+			//Lost the slot: existing is now whoever won it, checked below like any other occupant.
+		}
 
-static sym_initialize_t LSymInitialize;
-static sym_cleanup_t LSymCleanup;
-static sym_from_addr_t LSymFromAddr;
-static sym_get_line_t LSymGetLineFromAddr64;
+		if ( ( existing->hash == hash ) && ( existing->stackFrameCount == stackFrameCount ) &&
+			( memcmp( existing->stackFrames, stackFrames, sizeof( void* ) * stackFrameCount ) == 0 ) )
+			return existing;
+	}
+
+	return nullptr;
+}
 
 
 //--------------------------------------------------------------------------------------------------------------
-STATIC void Callstack::InitCallstackSystem()
+STATIC Callstack* Callstack::FetchAndAllocate( unsigned int stackFramesToSkip )
 {
-	g_debugHelp = LoadLibraryA( "dbghelp.dll" );
-	ASSERT_RETURN( g_debugHelp );
-	
-	LSymInitialize = (sym_initialize_t)GetProcAddress( g_debugHelp, "SymInitialize" );
-	LSymCleanup = (sym_cleanup_t)GetProcAddress( g_debugHelp, "SymCleanup" );
-	LSymFromAddr = (sym_from_addr_t)GetProcAddress( g_debugHelp, "SymFromAddr" );
-	LSymGetLineFromAddr64 = (sym_get_line_t)GetProcAddress( g_debugHelp, "SymGetLineFromAddr64" );
+	void* stackFrames[ MAX_CALLSTACK_DEPTH ]; //This thread's own buffer, on its stack, so capturing never touches the heap.
+	unsigned int stackFrameCount = CaptureStackFrames( stackFrames, MAX_CALLSTACK_DEPTH, stackFramesToSkip + 1 );
+	return InternCallstack( stackFrames, stackFrameCount );
+}
 
-	g_process = GetCurrentProcess();
-	LSymInitialize( g_process, NULL, TRUE );
 
-	g_symbol = (SYMBOL_INFO*)malloc( sizeof( SYMBOL_INFO ) + ( MAX_FILENAME_LENGTH * sizeof( char ) ) );
-	g_symbol->MaxNameLen = MAX_FILENAME_LENGTH;
-	g_symbol->SizeOfStruct = sizeof( SYMBOL_INFO );
+//--------------------------------------------------------------------------------------------------------------
+STATIC void Callstack::FreeCallstack( Callstack* )
+{
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-STATIC void Callstack::DeinitCallstackSystem()
+STATIC unsigned int Callstack::GetNumUniqueCallstacks()
 {
-	LSymCleanup( g_process );
+	unsigned int numInterned = s_numInternedCallstacks.load();
+	return ( numInterned < MAX_UNIQUE_CALLSTACKS ) ? numInterned : MAX_UNIQUE_CALLSTACKS;
+}
 
-	free( g_symbol );
 
-	FreeLibrary( g_debugHelp );
-	g_debugHelp = NULL;
+//--------------------------------------------------------------------------------------------------------------
+STATIC CallstackLine* Callstack::FetchHumanReadableLines( Callstack* cs )
+{
+	if ( cs == nullptr )
+		return nullptr;
+
+	s_callstackBufferLock.Lock();
+	for ( unsigned int i = 0; i < cs->stackFrameCount; ++i )
+		ResolveStackFrame( cs->stackFrames[ i ], g_callstackBuffer[ i ] );
+	s_callstackBufferLock.Unlock();
+
+	return g_callstackBuffer;
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-STATIC Callstack* Callstack::FetchAndAllocate( unsigned int stackFramesToSkip )
+STATIC void Callstack::PrintHumanReadableCallstackToDebugger( Callstack* cs )
 {
-	void* stack[ MAX_CALLSTACK_DEPTH ];
-	uint32_t framesTemp = CaptureStackBackTrace( stackFramesToSkip + 1, MAX_CALLSTACK_DEPTH, stack, NULL );
-
-	size_t allocSize = sizeof( Callstack ) + sizeof( void* ) * framesTemp; //Note from below that here framesTemp <=> # frames.
-	void* bufferData = malloc( allocSize );
+	if ( cs == nullptr )
+	{
+		DebuggerPrintf( "\t(Callstack not captured: the intern table is full.)\n\n" );
+		return;
+	}
 
-	CBuffer buffer;
-	buffer.Initialize( bufferData, allocSize );
+	DebuggerPrintf( "Top\n" );
 
-	Callstack* cs = buffer.WriteToBuffer<Callstack>();
-	buffer.readHeadOffsetFromStart = buffer.writeHeadOffsetFromStart; //We want below Read() to read from AFTER the above WriteTo.
-	cs->stackFrames = buffer.ReadFromBuffer<void*>();
-	cs->stackFrameCount = framesTemp; //Note pointer trick.
-	memcpy( cs->stackFrames, stack, sizeof( void* ) * cs->stackFrameCount );
+	s_callstackBufferLock.Lock();
+	for ( unsigned int i = 0; i < cs->stackFrameCount; ++i )
+	{
+		CallstackLine* line = &( g_callstackBuffer[ i ] );
+		ResolveStackFrame( cs->stackFrames[ i ], *line );
+		DebuggerPrintf( "\t%s(%d)\n", line->filename, line->line );
+	}
+	s_callstackBufferLock.Unlock();
 
-	return cs;
+	DebuggerPrintf( "Bottom\n\n\n" );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-STATIC CallstackLine* Callstack::FetchHumanReadableLines( Callstack* cs )
+void Callstack::PrintHumanReadableCallstackToFile( Callstack* cs, FILE* file )
 {
-	IMAGEHLP_LINE64 LineInfo;
-	DWORD LineDisplacement = 0; //Displacement from the beginning of the line.
-	LineInfo.SizeOfStruct = sizeof( IMAGEHLP_LINE64 );
+	if ( cs == nullptr )
+	{
+		const char* notCapturedStr = "\t(Callstack not captured: the intern table is full.)\n\n";
+		fwrite( notCapturedStr, sizeof( char ), strlen( notCapturedStr ), file );
+		return;
+	}
+
+	const char* topStr = "Top\n";
+	fwrite( topStr, sizeof( char ), strlen( topStr ), file );
 
-	unsigned int count = cs->stackFrameCount;
-	for ( unsigned int i = 0; i < count; ++i )
+	s_callstackBufferLock.Lock();
+	for ( unsigned int i = 0; i < cs->stackFrameCount; ++i )
 	{
 		CallstackLine* line = &( g_callstackBuffer[ i ] );
-		DWORD64 ptr = (DWORD64)( cs->stackFrames[ i ] );
-		LSymFromAddr( g_process, ptr, 0, g_symbol );
+		ResolveStackFrame( cs->stackFrames[ i ], *line );
 
-		strncpy_s( line->functionName, g_symbol->Name, MAX_SYMBOL_NAME_LENGTH );
+		char lineBuffer[ MAX_FILENAME_LENGTH + 16 + MAX_SYMBOL_NAME_LENGTH + 8 ]; //File + Line # + Function Name.
+		snprintf( lineBuffer, sizeof( lineBuffer ), "\t%s(%d) -- %s\n", line->filename, line->line, line->functionName );
+		fwrite( lineBuffer, sizeof( char ), strlen( lineBuffer ), file );
+	}
+	s_callstackBufferLock.Unlock();
 
-		BOOL bRet = LSymGetLineFromAddr64(
-			GetCurrentProcess(), //Process handle of the current process
-			ptr, //Address
-			&LineDisplacement, //Displacement stored here by the function
-			&LineInfo //File name/line info stored here
-		);
+	const char* bottomStr = "Bottom\n\n\n";
+	fwrite( bottomStr, sizeof( char ), strlen( bottomStr ), file );
+}
 
-		if ( bRet )
-		{
-			line->line = LineInfo.LineNumber;
 
-			const char* filename = LineInfo.FileName;
-			filename += 0; //"Skip to the important bit, so it can be double-clicked in Output."
-			strncpy_s( line->filename, filename, 128 );
+//--------------------------------------------------------------------------------------------------------------
+CALLSTACK_NOINLINE static void CaptureFromCallstackTestSite( Callstack*& out_callstack )
+{
+	out_callstack = Callstack::FetchAndAllocate( 0 ); //Stored after the call returns, so it can't become a tail call and lose this frame.
+}
 
-			line->offset = LineDisplacement;
-		}
-		else
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC bool Callstack::RunSelfTest()
+{
+	bool didPass = true;
+
+	//Captures through the same call site must intern to the same callstack, and through a different one, to another.
+	//The loop's bound is volatile so the compiler can't unroll it into two call sites.
+	Callstack* fromLoop[ 2 ] = { nullptr, nullptr };
+	volatile unsigned int numLoopCaptures = 2;
+	for ( unsigned int captureIndex = 0; captureIndex < numLoopCaptures; captureIndex++ )
+		CaptureFromCallstackTestSite( fromLoop[ captureIndex & 1 ] );
+	Callstack* fromElsewhere = nullptr;
+	CaptureFromCallstackTestSite( fromElsewhere );
+	bool didIntern = ( fromLoop[ 0 ] != nullptr ) && ( fromLoop[ 0 ] == fromLoop[ 1 ] ) && ( fromElsewhere != nullptr ) && ( fromElsewhere != fromLoop[ 0 ] );
+	g_theConsole->Printf( "CallstackTest: same site interned once, different sites apart: %s", didIntern ? "PASS" : "FAIL" );
+	didPass &= didIntern;
+
+	//Skipping 0 frames leaves the capturing function on top, so its name must come back.
+	bool didResolve = false;
+	if ( fromLoop[ 0 ] != nullptr )
+	{
+		CallstackLine* lines = FetchHumanReadableLines( fromLoop[ 0 ] );
+		for ( unsigned int frameIndex = 0; frameIndex < fromLoop[ 0 ]->stackFrameCount; frameIndex++ )
 		{
-			line->line = 0;
-			line->offset = 0;
-			strncpy_s( line->filename, "N/A", 128 );
+			if ( strstr( lines[ frameIndex ].functionName, "CaptureFromCallstackTestSite" ) != nullptr )
+			{
+				g_theConsole->Printf( "CallstackTest: frame %u of %u resolved to %s at %s(%u)", frameIndex, fromLoop[ 0 ]->stackFrameCount,
+									  lines[ frameIndex ].functionName, lines[ frameIndex ].filename, lines[ frameIndex ].line );
+				didResolve = true;
+				break;
+			}
 		}
 	}
+	g_theConsole->Printf( "CallstackTest: resolved CaptureFromCallstackTestSite by name: %s", didResolve ? "PASS" : "FAIL" );
+	didPass &= didResolve;
 
-	return g_callstackBuffer;
+	g_theConsole->Printf( "CallstackTest: %s (%u unique callstacks interned so far)", didPass ? "PASS" : "FAIL", GetNumUniqueCallstacks() );
+	return didPass;
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-STATIC void Callstack::FreeCallstack( Callstack* cs )
+STATIC void Callstack::RunTest( Command& )
 {
-	//Would free(cs->frames) separately, if you allocated it separately.
-	free( cs ); //Upside to doing the 1-allocation CBuffer approach, we only need this line.
+	RunSelfTest();
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-STATIC void Callstack::PrintHumanReadableCallstackToDebugger( Callstack* cs )
+STATIC void Callstack::RunBenchmark( Command& args )
 {
-	DebuggerPrintf( "Top\n" );
-
-	IMAGEHLP_LINE64 LineInfo;
-	DWORD LineDisplacement = 0; //Displacement from the beginning of the line.
-	LineInfo.SizeOfStruct = sizeof( IMAGEHLP_LINE64 );
+	int numCaptures;
+	args.GetNextInt( &numCaptures, DEFAULT_CALLSTACK_BENCHMARK_CAPTURES );
+	if ( numCaptures < 1 )
+	{
+		g_theConsole->Printf( "Usage: CallstackBenchmark [numCaptures = %d]", DEFAULT_CALLSTACK_BENCHMARK_CAPTURES );
+		return;
+	}
 
-	unsigned int count = cs->stackFrameCount;
-	for ( unsigned int i = 0; i < count; ++i )
+	void* stackFrames[ MAX_CALLSTACK_DEPTH ];
+	unsigned int totalFrames = 0;
+	double startSeconds = GetCurrentTimeSeconds();
+	for ( int captureIndex = 0; captureIndex < numCaptures; captureIndex++ )
+		totalFrames += CaptureStackFrames( stackFrames, MAX_CALLSTACK_DEPTH, 0 );
+	double captureSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	unsigned int numUniqueBefore = GetNumUniqueCallstacks();
+	unsigned int numFailed = 0;
+	startSeconds = GetCurrentTimeSeconds();
+	for ( int captureIndex = 0; captureIndex < numCaptures; captureIndex++ )
 	{
-		CallstackLine* line = &( g_callstackBuffer[ i ] );
-		DWORD64 ptr = (DWORD64)( cs->stackFrames[ i ] );
-		LSymFromAddr( g_process, ptr, 0, g_symbol );
-
-		strncpy_s( line->functionName, g_symbol->Name, MAX_SYMBOL_NAME_LENGTH );
-		
-		BOOL bRet = LSymGetLineFromAddr64(
-			GetCurrentProcess(), //Process handle of the current process
-			ptr, //Address
-			&LineDisplacement, //Displacement stored here by the function
-			&LineInfo //File name/line info stored here
-			);
-
-		if ( bRet )
-		{
-			line->line = LineInfo.LineNumber;
+		if ( FetchAndAllocate( 0 ) == nullptr )
+			++numFailed;
+	}
+	double internSeconds = GetCurrentTimeSeconds() - startSeconds;
 
-			const char* filename = LineInfo.FileName;
-			filename += 0; //"Skip to the important bit, so it can be double-clicked in Output."
-			strncpy_s( line->filename, filename, 128 );
+	const double NANO = 1000000000.0;
+	g_theConsole->Printf( "CallstackBenchmark: %d captures, %.1f frames deep:", numCaptures, static_cast<double>( totalFrames ) / numCaptures );
+	g_theConsole->Printf( "  Capture only: %.0f ns per call", captureSeconds * NANO / numCaptures );
+	g_theConsole->Printf( "  Capture and intern: %.0f ns per call, %u new unique callstacks, %u not captured",
+						  internSeconds * NANO / numCaptures, GetNumUniqueCallstacks() - numUniqueBefore, numFailed );
+}
 
-			line->offset = LineDisplacement;
-		}
-		else
-		{
-			line->line = 0;
-			line->offset = 0;
-			strncpy_s( line->filename, "N/A", 128 );
-		}
 
-		DebuggerPrintf( "\t%s(%d)\n", line->filename, line->line );
-	}
+#if defined( PLATFORM_WINDOWS )
+//--------------------------------------------------------------------------------------------------------------
+typedef BOOL ( __stdcall* sym_initialize_t )( IN HANDLE hProcess, IN PSTR UserSearchPath, IN BOOL fInvadeProcess );
+typedef BOOL ( __stdcall* sym_cleanup_t )( IN HANDLE hPROCESS );
+typedef BOOL ( __stdcall* sym_from_addr_t )( IN HANDLE hProcess, IN DWORD64 Address, OUT PDWORD64 Displacement, OUT PSYMBOL_INFO Symbol );
 
-	DebuggerPrintf( "Bottom\n\n\n" );
+typedef BOOL ( __stdcall* sym_get_line_t )( IN HANDLE hProcess, IN DWORD64 dwAddr, OUT PDWORD pdwDisplacement, OUT PIMAGEHLP_LINE64 Symbol );
+
+
+//--------------------------------------------------------------------------------------------------------------
+static HMODULE g_debugHelp;
+static HANDLE g_process;
+static SYMBOL_INFO* g_symbol;
+
+static sym_initialize_t LSymInitialize;
+static sym_cleanup_t LSymCleanup;
+static sym_from_addr_t LSymFromAddr;
+static sym_get_line_t LSymGetLineFromAddr64;
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void Callstack::InitCallstackSystem()
+{
+	if ( g_debugHelp != NULL )
+		return;
+
+	g_debugHelp = LoadLibraryA( "dbghelp.dll" );
+	ASSERT_RETURN( g_debugHelp );
+
+	LSymInitialize = (sym_initialize_t)GetProcAddress( g_debugHelp, "SymInitialize" );
+	LSymCleanup = (sym_cleanup_t)GetProcAddress( g_debugHelp, "SymCleanup" );
+	LSymFromAddr = (sym_from_addr_t)GetProcAddress( g_debugHelp, "SymFromAddr" );
+	LSymGetLineFromAddr64 = (sym_get_line_t)GetProcAddress( g_debugHelp, "SymGetLineFromAddr64" );
+
+	g_process = GetCurrentProcess();
+	LSymInitialize( g_process, NULL, TRUE );
+
+	g_symbol = (SYMBOL_INFO*)malloc( sizeof( SYMBOL_INFO ) + ( MAX_FILENAME_LENGTH * sizeof( char ) ) );
+	g_symbol->MaxNameLen = MAX_FILENAME_LENGTH;
+	g_symbol->SizeOfStruct = sizeof( SYMBOL_INFO );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-void Callstack::PrintHumanReadableCallstackToFile( Callstack* cs, FILE* file )
+STATIC void Callstack::DeinitCallstackSystem()
 {
-	const char* topStr = "Top\n";
-	fwrite( topStr, sizeof( char ), strlen( topStr ), file );
+	if ( g_debugHelp == NULL )
+		return;
+
+	LSymCleanup( g_process );
+
+	free( g_symbol );
+
+	FreeLibrary( g_debugHelp );
+	g_debugHelp = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int Callstack::CaptureStackFrames( void** out_stackFrames, unsigned int maxStackFrames, unsigned int stackFramesToSkip )
+{
+	return CaptureStackBackTrace( stackFramesToSkip + 1, maxStackFrames, out_stackFrames, NULL );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void Callstack::ResolveStackFrame( void* stackFrame, CallstackLine& out_line )
+{
+	InitCallstackSystem(); //Also lets ERROR_AND_DIE and the Logger print callstacks when memory tracking never started DbgHelp.
 
 	IMAGEHLP_LINE64 LineInfo;
 	DWORD LineDisplacement = 0; //Displacement from the beginning of the line.
 	LineInfo.SizeOfStruct = sizeof( IMAGEHLP_LINE64 );
 
-	unsigned int count = cs->stackFrameCount;
-	for ( unsigned int i = 0; i < count; ++i )
-	{
-		CallstackLine* line = &( g_callstackBuffer[ i ] );
-		DWORD64 ptr = (DWORD64)( cs->stackFrames[ i ] );
-		LSymFromAddr( g_process, ptr, 0, g_symbol );
-
-		strncpy_s( line->functionName, g_symbol->Name, MAX_SYMBOL_NAME_LENGTH );
+	DWORD64 ptr = (DWORD64)( stackFrame );
+	if ( LSymFromAddr( g_process, ptr, 0, g_symbol ) )
+		strncpy_s( out_line.functionName, g_symbol->Name, MAX_SYMBOL_NAME_LENGTH );
+	else
+		strncpy_s( out_line.functionName, "N/A", MAX_SYMBOL_NAME_LENGTH );
 
-		BOOL bRet = LSymGetLineFromAddr64(
-			GetCurrentProcess(), //Process handle of the current process
-			ptr, //Address
-			&LineDisplacement, //Displacement stored here by the function
-			&LineInfo //File name/line info stored here
-			);
+	BOOL bRet = LSymGetLineFromAddr64(
+		g_process, //Process handle of the current process
+		ptr, //Address
+		&LineDisplacement, //Displacement stored here by the function
+		&LineInfo //File name/line info stored here
+	);
 
-		if ( bRet )
-		{
-			line->line = LineInfo.LineNumber;
-
-			const char* filename = LineInfo.FileName;
-			filename += 0; //"Skip to the important bit, so it can be double-clicked in Output."
-			strncpy_s( line->filename, filename, 128 );
+	if ( bRet )
+	{
+		out_line.line = LineInfo.LineNumber;
 
-			line->offset = LineDisplacement;
-		}
-		else
-		{
-			line->line = 0;
-			line->offset = 0;
-			strncpy_s( line->filename, "N/A", 128 );
-		}
+		const char* filename = LineInfo.FileName;
+		filename += 0; //"Skip to the important bit, so it can be double-clicked in Output."
+		strncpy_s( out_line.filename, filename, 128 );
 
-		char lineBuffer[ 128 + 2 + MAX_SYMBOL_NAME_LENGTH + 128 + 2 ]; //File + Line # + Function Name.
-		sprintf_s( lineBuffer, MAX_SYMBOL_NAME_LENGTH + 128, "\t%s(%d) -- %s\n", line->filename, line->line, line->functionName );
-		fwrite( lineBuffer, sizeof( char ), strlen( lineBuffer ), file );
+		out_line.offset = LineDisplacement;
+	}
+	else
+	{
+		out_line.line = 0;
+		out_line.offset = 0;
+		strncpy_s( out_line.filename, "N/A", 128 );
 	}
-
-	const char* bottomStr = "Bottom\n\n\n";
-	fwrite( bottomStr, sizeof( char ), strlen( bottomStr ), file );
 }
+#endif
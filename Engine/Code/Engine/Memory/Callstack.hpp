@@ -1,13 +1,23 @@
 #pragma once
-#pragma warning( disable : 4091 ) // Removing warning about typedef on an unnamed enum in DbgHelp.h
 
-#include "Engine/Memory/ByteUtils.hpp"
+
+#include <stdint.h>
 #include <cstdio>
 
 
+//--------------------------------------------------------------------------------------------------------------
+class Command;
+
+
 //--------------------------------------------------------------------------------------------------------------
 #define MAX_FILENAME_LENGTH 1024
 #define MAX_SYMBOL_NAME_LENGTH 1024
+#define MAX_CALLSTACK_DEPTH 128
+#if defined( _MSC_VER )
+	#define CALLSTACK_NOINLINE __declspec( noinline ) //Frame skipping counts on these keeping a frame of their own.
+#else
+	#define CALLSTACK_NOINLINE __attribute__(( noinline ))
+#endif
 struct CallstackLine
 {
 	char filename[ MAX_FILENAME_LENGTH ];
@@ -18,19 +28,35 @@ struct CallstackLine
 
 
 //--------------------------------------------------------------------------------------------------------------
+//Captured callstacks are interned: the same frames always give back the same Callstack, so an allocation site or
+//log line that repeats costs a capture and one hash probe, never an allocation. They live until the program exits.
+//Capturing only records addresses. Turning them into names and lines waits until something prints them.
+//The platform halves live in Callstack.cpp (Windows, DbgHelp) and CallstackLinux.cpp (unwinder, ELF and DWARF tables).
 struct Callstack
 {
 	void** stackFrames;
 	unsigned int stackFrameCount;
+	uint32_t hash;
 
-	static void InitCallstackSystem();
+	static void InitCallstackSystem(); //Optional: symbolizing initializes on first use. Call to pay that cost up front.
 	static void DeinitCallstackSystem();
 
-	static Callstack* FetchAndAllocate( unsigned int stackFramesToSkip );
-	static CallstackLine* FetchHumanReadableLines( Callstack* cs );
-	static void FreeCallstack( Callstack* cs );
+	static Callstack* FetchAndAllocate( unsigned int stackFramesToSkip ); //Interned, see above. nullptr only once the table is full.
+	static CallstackLine* FetchHumanReadableLines( Callstack* cs ); //Into a shared buffer, overwritten by the next call.
+	static void FreeCallstack( Callstack* cs ); //Does nothing: interned callstacks are shared. Kept so callers needn't know.
+	static unsigned int GetNumUniqueCallstacks();
 
 	static void PrintCallstacks();
 	static void PrintHumanReadableCallstackToDebugger( Callstack* cs ); //Same as FetchLines but prints directly to Output.
 	static void PrintHumanReadableCallstackToFile( Callstack* cs, FILE* file );
+
+	static bool RunSelfTest(); //The checks behind CallstackTest, false if any failed. Also run by EngineTests.
+	static void RunTest( Command& args ); //CallstackTest: interning, and resolving a known function's name from a fresh capture.
+	static void RunBenchmark( Command& args ); //CallstackBenchmark [numCaptures]: cost per capture, raw and interned.
+
+
+private:
+	//Per-platform. Capture writes into the caller's buffer and must not allocate: it runs inside operator new.
+	CALLSTACK_NOINLINE static unsigned int CaptureStackFrames( void** out_stackFrames, unsigned int maxStackFrames, unsigned int stackFramesToSkip );
+	static void ResolveStackFrame( void* stackFrame, CallstackLine& out_line );
 };
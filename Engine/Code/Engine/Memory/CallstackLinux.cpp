@@ -0,0 +1,697 @@
+#include "Engine/Memory/Callstack.hpp"
+
+
+#include "Engine/BuildConfig.hpp"
+
+#if defined( PLATFORM_LINUX )
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unwind.h>
+
+
+//--------------------------------------------------------------------------------------------------------------
+#define STATIC //As in EngineCommon.hpp, which this can't include: it pulls in Windows-only headers.
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Capture is the unwinder walking .eh_frame, which every module has, debug info or not, and which touches no heap.
+//Symbolizing maps each module's file once, on first use, and reads names from .symtab (falling back to .dynsym, which
+//is all dladdr sees) and files and lines from .debug_line. Everything here runs under Callstack.cpp's symbolizer lock.
+//Debug info split out via .gnu_debuglink, and compressed sections, aren't followed: those frames get names but no lines.
+static const unsigned int MAX_CALLSTACK_MODULES = 64;
+static const char* const UNRESOLVED_STR = "N/A";
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct ElfSection
+{
+	const uint8_t* data;
+	size_t size;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct CallstackModule
+{
+	char path[ MAX_FILENAME_LENGTH ];
+	bool isLoaded; //False if the file couldn't be mapped or parsed. Remembered so it isn't retried every frame.
+	void* image;
+	size_t imageSize;
+	ElfSection symtab;
+	ElfSection symtabStrings;
+	ElfSection dynsym;
+	ElfSection dynsymStrings;
+	ElfSection debugLine;
+	ElfSection debugStr;
+	ElfSection debugLineStr;
+};
+static CallstackModule s_callstackModules[ MAX_CALLSTACK_MODULES ];
+static unsigned int s_numCallstackModules = 0;
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct UnwindState
+{
+	void** out_stackFrames;
+	unsigned int maxStackFrames;
+	unsigned int stackFramesToSkip;
+	unsigned int stackFrameCount;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+static _Unwind_Reason_Code UnwindCallback( _Unwind_Context* context, void* userData )
+{
+	UnwindState* state = static_cast<UnwindState*>( userData );
+
+	uintptr_t instructionPointer = _Unwind_GetIP( context );
+	if ( instructionPointer == 0 )
+		return _URC_END_OF_STACK;
+
+	if ( state->stackFramesToSkip > 0 )
+	{
+		--state->stackFramesToSkip;
+		return _URC_NO_REASON;
+	}
+
+	if ( state->stackFrameCount >= state->maxStackFrames )
+		return _URC_END_OF_STACK;
+
+	state->out_stackFrames[ state->stackFrameCount++ ] = reinterpret_cast<void*>( instructionPointer );
+	return _URC_NO_REASON;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void Callstack::InitCallstackSystem()
+{
+	//Nothing up front: modules are mapped as their frames are first resolved.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void Callstack::DeinitCallstackSystem()
+{
+	for ( unsigned int moduleIndex = 0; moduleIndex < s_numCallstackModules; moduleIndex++ )
+	{
+		CallstackModule& module = s_callstackModules[ moduleIndex ];
+		if ( module.image != nullptr )
+			munmap( module.image, module.imageSize );
+	}
+	memset( s_callstackModules, 0, sizeof( s_callstackModules ) );
+	s_numCallstackModules = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int Callstack::CaptureStackFrames( void** out_stackFrames, unsigned int maxStackFrames, unsigned int stackFramesToSkip )
+{
+	UnwindState state;
+	state.out_stackFrames = out_stackFrames;
+	state.maxStackFrames = maxStackFrames;
+	state.stackFramesToSkip = stackFramesToSkip + 1; //The unwinder starts with this function's own frame, like CaptureStackBackTrace.
+	state.stackFrameCount = 0;
+
+	_Unwind_Backtrace( UnwindCallback, &state );
+	return state.stackFrameCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static ElfSection GetElfSection( const CallstackModule& module, const ElfW( Shdr )& header )
+{
+	ElfSection section = { nullptr, 0 };
+	if ( ( header.sh_type == SHT_NOBITS ) || ( ( header.sh_flags & SHF_COMPRESSED ) != 0 ) )
+		return section;
+	if ( ( header.sh_offset > module.imageSize ) || ( header.sh_size > module.imageSize - header.sh_offset ) )
+		return section;
+
+	section.data = static_cast<const uint8_t*>( module.image ) + header.sh_offset;
+	section.size = header.sh_size;
+	return section;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool LoadCallstackModule( CallstackModule& module )
+{
+	int fileDescriptor = open( module.path, O_RDONLY );
+	if ( fileDescriptor < 0 )
+		return false;
+
+	struct stat fileStats;
+	if ( ( fstat( fileDescriptor, &fileStats ) != 0 ) || ( static_cast<size_t>( fileStats.st_size ) < sizeof( ElfW( Ehdr ) ) ) )
+	{
+		close( fileDescriptor );
+		return false;
+	}
+
+	void* image = mmap( nullptr, fileStats.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0 );
+	close( fileDescriptor );
+	if ( image == MAP_FAILED )
+		return false;
+	module.image = image;
+	module.imageSize = fileStats.st_size;
+
+	const ElfW( Ehdr )* elfHeader = static_cast<const ElfW( Ehdr )*>( image );
+	const unsigned char nativeClass = ( sizeof( void* ) == 8 ) ? ELFCLASS64 : ELFCLASS32;
+	if ( ( memcmp( elfHeader->e_ident, ELFMAG, SELFMAG ) != 0 ) || ( elfHeader->e_ident[ EI_CLASS ] != nativeClass ) ||
+		( elfHeader->e_shentsize != sizeof( ElfW( Shdr ) ) ) || ( elfHeader->e_shstrndx >= elfHeader->e_shnum ) ||
+		( elfHeader->e_shoff > module.imageSize ) || ( elfHeader->e_shnum * sizeof( ElfW( Shdr ) ) > module.imageSize - elfHeader->e_shoff ) )
+		return false;
+
+	const ElfW( Shdr )* sectionHeaders = reinterpret_cast<const ElfW( Shdr )*>( static_cast<const uint8_t*>( image ) + elfHeader->e_shoff );
+	ElfSection sectionNames = GetElfSection( module, sectionHeaders[ elfHeader->e_shstrndx ] );
+	if ( sectionNames.data == nullptr )
+		return false;
+
+	for ( unsigned int sectionIndex = 0; sectionIndex < elfHeader->e_shnum; sectionIndex++ )
+	{
+		const ElfW( Shdr )& header = sectionHeaders[ sectionIndex ];
+		if ( header.sh_name >= sectionNames.size )
+			continue;
+		const char* sectionName = reinterpret_cast<const char*>( sectionNames.data ) + header.sh_name;
+
+		if ( ( header.sh_type == SHT_SYMTAB || header.sh_type == SHT_DYNSYM ) && ( header.sh_link < elfHeader->e_shnum ) )
+		{
+			bool isSymtab = ( header.sh_type == SHT_SYMTAB );
+			( isSymtab ? module.symtab : module.dynsym ) = GetElfSection( module, header );
+			( isSymtab ? module.symtabStrings : module.dynsymStrings ) = GetElfSection( module, sectionHeaders[ header.sh_link ] );
+		}
+		else if ( strcmp( sectionName, ".debug_line" ) == 0 )
+			module.debugLine = GetElfSection( module, header );
+		else if ( strcmp( sectionName, ".debug_str" ) == 0 )
+			module.debugStr = GetElfSection( module, header );
+		else if ( strcmp( sectionName, ".debug_line_str" ) == 0 )
+			module.debugLineStr = GetElfSection( module, header );
+	}
+
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static CallstackModule* FindOrLoadCallstackModule( const char* path )
+{
+	for ( unsigned int moduleIndex = 0; moduleIndex < s_numCallstackModules; moduleIndex++ )
+	{
+		if ( strcmp( s_callstackModules[ moduleIndex ].path, path ) == 0 )
+			return s_callstackModules[ moduleIndex ].isLoaded ? &s_callstackModules[ moduleIndex ] : nullptr;
+	}
+
+	if ( s_numCallstackModules >= MAX_CALLSTACK_MODULES )
+		return nullptr;
+
+	CallstackModule& module = s_callstackModules[ s_numCallstackModules++ ];
+	strncpy( module.path, path, MAX_FILENAME_LENGTH - 1 );
+	module.isLoaded = LoadCallstackModule( module );
+	return module.isLoaded ? &module : nullptr;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const char* FindFunctionSymbol( const ElfSection& symbols, const ElfSection& strings, uintptr_t address, uintptr_t& out_symbolAddress )
+{
+	if ( ( symbols.data == nullptr ) || ( strings.data == nullptr ) )
+		return nullptr;
+
+	const ElfW( Sym )* symbolArray = reinterpret_cast<const ElfW( Sym )*>( symbols.data );
+	const size_t numSymbols = symbols.size / sizeof( ElfW( Sym ) );
+	for ( size_t symbolIndex = 0; symbolIndex < numSymbols; symbolIndex++ )
+	{
+		const ElfW( Sym )& symbol = symbolArray[ symbolIndex ];
+		const unsigned int symbolType = ELF32_ST_TYPE( symbol.st_info ); //Same bits in either class.
+		if ( ( symbolType != STT_FUNC && symbolType != STT_GNU_IFUNC ) || ( symbol.st_shndx == SHN_UNDEF ) || ( symbol.st_name >= strings.size ) )
+			continue;
+
+		const uintptr_t symbolSize = ( symbol.st_size > 0 ) ? symbol.st_size : 1;
+		if ( ( address >= symbol.st_value ) && ( address - symbol.st_value < symbolSize ) )
+		{
+			out_symbolAddress = symbol.st_value;
+			return reinterpret_cast<const char*>( strings.data ) + symbol.st_name;
+		}
+	}
+
+	return nullptr;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Bounds-checked little-endian reads over one section. Past the end, reads give 0 and isValid goes false for good.
+struct DwarfReader
+{
+	const uint8_t* current;
+	const uint8_t* end;
+	bool isValid;
+
+	DwarfReader( const uint8_t* start, const uint8_t* end ) : current( start ), end( end ), isValid( start <= end ) {}
+
+	bool Skip( uint64_t numBytes )
+	{
+		if ( !isValid || ( numBytes > static_cast<uint64_t>( end - current ) ) )
+		{
+			isValid = false;
+			return false;
+		}
+		current += numBytes;
+		return true;
+	}
+
+	uint64_t ReadUnsigned( unsigned int numBytes ) //Up to 8.
+	{
+		uint64_t value = 0;
+		const uint8_t* start = current;
+		if ( ( numBytes > 8 ) || !Skip( numBytes ) )
+			return 0;
+		for ( unsigned int byteIndex = 0; byteIndex < numBytes; byteIndex++ )
+			value |= static_cast<uint64_t>( start[ byteIndex ] ) << ( 8 * byteIndex );
+		return value;
+	}
+
+	uint8_t ReadU8() { return static_cast<uint8_t>( ReadUnsigned( 1 ) ); }
+	uint16_t ReadU16() { return static_cast<uint16_t>( ReadUnsigned( 2 ) ); }
+	uint64_t ReadOffset( bool is64Bit ) { return ReadUnsigned( is64Bit ? 8 : 4 ); }
+
+	uint64_t ReadULEB128()
+	{
+		uint64_t value = 0;
+		for ( unsigned int shift = 0; isValid; shift += 7 )
+		{
+			uint8_t byte = ReadU8();
+			if ( shift < 64 )
+				value |= static_cast<uint64_t>( byte & 0x7f ) << shift;
+			if ( ( byte & 0x80 ) == 0 )
+				break;
+		}
+		return value;
+	}
+
+	int64_t ReadSLEB128()
+	{
+		int64_t value = 0;
+		unsigned int shift = 0;
+		uint8_t byte = 0;
+		do
+		{
+			byte = ReadU8();
+			if ( shift < 64 )
+				value |= static_cast<int64_t>( byte & 0x7f ) << shift;
+			shift += 7;
+		} while ( isValid && ( ( byte & 0x80 ) != 0 ) );
+
+		if ( ( shift < 64 ) && ( ( byte & 0x40 ) != 0 ) )
+			value |= -( static_cast<int64_t>( 1 ) << shift );
+		return value;
+	}
+
+	const char* ReadString()
+	{
+		const uint8_t* terminator = isValid ? static_cast<const uint8_t*>( memchr( current, 0, end - current ) ) : nullptr;
+		if ( terminator == nullptr )
+		{
+			isValid = false;
+			return "";
+		}
+		const char* str = reinterpret_cast<const char*>( current );
+		current = terminator + 1;
+		return str;
+	}
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+//DWARF constants not every elf.h or dwarf.h carries.
+enum DwarfLineOpcode
+{
+	DW_LNS_COPY = 1, DW_LNS_ADVANCE_PC, DW_LNS_ADVANCE_LINE, DW_LNS_SET_FILE, DW_LNS_SET_COLUMN, DW_LNS_NEGATE_STMT,
+	DW_LNS_SET_BASIC_BLOCK, DW_LNS_CONST_ADD_PC, DW_LNS_FIXED_ADVANCE_PC, DW_LNS_SET_PROLOGUE_END, DW_LNS_SET_EPILOGUE_BEGIN, DW_LNS_SET_ISA,
+	DW_LNE_END_SEQUENCE = 1, DW_LNE_SET_ADDRESS = 2
+};
+enum DwarfLineContentType { DW_LNCT_PATH = 1, DW_LNCT_DIRECTORY_INDEX = 2 };
+enum DwarfForm
+{
+	DW_FORM_BLOCK2 = 0x03, DW_FORM_BLOCK4 = 0x04, DW_FORM_DATA2 = 0x05, DW_FORM_DATA4 = 0x06, DW_FORM_DATA8 = 0x07, DW_FORM_STRING = 0x08,
+	DW_FORM_BLOCK = 0x09, DW_FORM_BLOCK1 = 0x0a, DW_FORM_DATA1 = 0x0b, DW_FORM_STRP = 0x0e, DW_FORM_UDATA = 0x0f,
+	DW_FORM_DATA16 = 0x1e, DW_FORM_LINE_STRP = 0x1f
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct DwarfLineHeader
+{
+	unsigned int version;
+	bool is64Bit;
+	unsigned int addressSize;
+	uint8_t minInstructionLength;
+	bool defaultIsStmt;
+	int8_t lineBase;
+	uint8_t lineRange;
+	uint8_t opcodeBase;
+	const uint8_t* standardOpcodeLengths;
+	const uint8_t* directoryTable; //Raw tables, walked again only for the one file that matches.
+	const uint8_t* program;
+	const uint8_t* unitEnd;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Reads one DWARF 5 attribute. Strings come back through out_string, numbers through out_number. False on unknown forms.
+static bool ReadDwarfLineAttribute( DwarfReader& reader, uint64_t form, const CallstackModule& module, const DwarfLineHeader& header,
+									const char*& out_string, uint64_t& out_number )
+{
+	out_string = nullptr;
+	out_number = 0;
+	switch ( form )
+	{
+		case DW_FORM_STRING: out_string = reader.ReadString(); break;
+		case DW_FORM_STRP:
+		case DW_FORM_LINE_STRP:
+		{
+			const ElfSection& strings = ( form == DW_FORM_STRP ) ? module.debugStr : module.debugLineStr;
+			uint64_t stringOffset = reader.ReadOffset( header.is64Bit );
+			if ( ( strings.data != nullptr ) && ( stringOffset < strings.size ) && ( memchr( strings.data + stringOffset, 0, strings.size - stringOffset ) != nullptr ) )
+				out_string = reinterpret_cast<const char*>( strings.data ) + stringOffset;
+			break;
+		}
+		case DW_FORM_UDATA: out_number = reader.ReadULEB128(); break;
+		case DW_FORM_DATA1: out_number = reader.ReadU8(); break;
+		case DW_FORM_DATA2: out_number = reader.ReadU16(); break;
+		case DW_FORM_DATA4: out_number = reader.ReadUnsigned( 4 ); break;
+		case DW_FORM_DATA8: out_number = reader.ReadUnsigned( 8 ); break;
+		case DW_FORM_DATA16: reader.Skip( 16 ); break;
+		case DW_FORM_BLOCK: reader.Skip( reader.ReadULEB128() ); break;
+		case DW_FORM_BLOCK1: reader.Skip( reader.ReadU8() ); break;
+		case DW_FORM_BLOCK2: reader.Skip( reader.ReadU16() ); break;
+		case DW_FORM_BLOCK4: reader.Skip( reader.ReadUnsigned( 4 ) ); break;
+		default: return false; //e.g. DW_FORM_strx, which needs .debug_str_offsets and the unit's base: not worth it here.
+	}
+	return reader.isValid;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Walks one DWARF 5 entry table: a format list, then entries in that format. Hands back entry wantedIndex's path and
+//directory index, if asked for one, and leaves the reader after the table.
+static bool ReadDwarf5EntryTable( DwarfReader& reader, const CallstackModule& module, const DwarfLineHeader& header,
+								  uint64_t wantedIndex, const char*& out_path, uint64_t& out_directoryIndex )
+{
+	uint8_t numFormats = reader.ReadU8();
+	const uint8_t* formats = reader.current;
+	for ( unsigned int formatIndex = 0; formatIndex < numFormats; formatIndex++ )
+	{
+		reader.ReadULEB128();
+		reader.ReadULEB128();
+	}
+
+	uint64_t numEntries = reader.ReadULEB128();
+	for ( uint64_t entryIndex = 0; ( entryIndex < numEntries ) && reader.isValid; entryIndex++ )
+	{
+		DwarfReader formatReader( formats, reader.end );
+		for ( unsigned int formatIndex = 0; formatIndex < numFormats; formatIndex++ )
+		{
+			uint64_t contentType = formatReader.ReadULEB128();
+			uint64_t form = formatReader.ReadULEB128();
+
+			const char* str;
+			uint64_t number;
+			if ( !ReadDwarfLineAttribute( reader, form, module, header, str, number ) )
+				return false;
+
+			if ( entryIndex == wantedIndex )
+			{
+				if ( contentType == DW_LNCT_PATH )
+					out_path = str;
+				else if ( contentType == DW_LNCT_DIRECTORY_INDEX )
+					out_directoryIndex = number;
+			}
+		}
+	}
+
+	return reader.isValid;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//File numbers are 1-based before DWARF 5 and 0-based from it. So are directories, where 0 meant "the compile directory",
+//which .debug_line alone doesn't record before DWARF 5: those paths stay relative.
+static void GetDwarfLineFileName( const CallstackModule& module, const DwarfLineHeader& header, uint64_t fileIndex, char* out_filename, size_t maxLength )
+{
+	const char* fileName = nullptr;
+	const char* directoryName = nullptr;
+	const char* compileDirectoryName = nullptr; //DWARF 5 only: where directoryName is relative to, if it is.
+	uint64_t directoryIndex = 0;
+	DwarfReader reader( header.directoryTable, header.program );
+
+	if ( header.version >= 5 )
+	{
+		const char* unusedPath = nullptr;
+		uint64_t unusedIndex = 0;
+		const uint8_t* directoryTable = reader.current;
+		if ( !ReadDwarf5EntryTable( reader, module, header, UINT64_MAX, unusedPath, unusedIndex ) ||
+			 !ReadDwarf5EntryTable( reader, module, header, fileIndex, fileName, directoryIndex ) )
+			return;
+
+		DwarfReader directoryReader( directoryTable, header.program );
+		ReadDwarf5EntryTable( directoryReader, module, header, directoryIndex, directoryName, unusedIndex );
+		if ( ( directoryIndex != 0 ) && ( directoryName != nullptr ) && ( directoryName[ 0 ] != '/' ) )
+		{
+			DwarfReader compileDirectoryReader( directoryTable, header.program );
+			ReadDwarf5EntryTable( compileDirectoryReader, module, header, 0, compileDirectoryName, unusedIndex );
+		}
+	}
+	else
+	{
+		const uint8_t* directoryTable = reader.current;
+		while ( reader.isValid && ( *reader.ReadString() != '\0' ) ) {}
+
+		for ( uint64_t entryIndex = 1; reader.isValid; entryIndex++ )
+		{
+			const char* entryName = reader.ReadString();
+			if ( *entryName == '\0' )
+				break;
+			uint64_t entryDirectoryIndex = reader.ReadULEB128();
+			reader.ReadULEB128(); //Modification time.
+			reader.ReadULEB128(); //File length.
+			if ( entryIndex == fileIndex )
+			{
+				fileName = entryName;
+				directoryIndex = entryDirectoryIndex;
+				break;
+			}
+		}
+
+		DwarfReader directoryReader( directoryTable, header.program );
+		for ( uint64_t entryIndex = 1; ( directoryIndex > 0 ) && directoryReader.isValid; entryIndex++ )
+		{
+			const char* entryName = directoryReader.ReadString();
+			if ( *entryName == '\0' )
+				break;
+			if ( entryIndex == directoryIndex )
+				directoryName = entryName;
+		}
+	}
+
+	if ( ( fileName == nullptr ) || ( *fileName == '\0' ) )
+		return;
+
+	if ( ( fileName[ 0 ] == '/' ) || ( directoryName == nullptr ) || ( *directoryName == '\0' ) )
+		snprintf( out_filename, maxLength, "%s", fileName );
+	else if ( ( compileDirectoryName == nullptr ) || ( *compileDirectoryName == '\0' ) )
+		snprintf( out_filename, maxLength, "%s/%s", directoryName, fileName );
+	else
+		snprintf( out_filename, maxLength, "%s/%s/%s", compileDirectoryName, directoryName, fileName );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool ReadDwarfLineHeader( DwarfReader& reader, DwarfLineHeader& out_header )
+{
+	out_header.unitEnd = nullptr;
+	uint64_t unitLength = reader.ReadUnsigned( 4 );
+	out_header.is64Bit = ( unitLength == 0xffffffff );
+	if ( out_header.is64Bit )
+		unitLength = reader.ReadUnsigned( 8 );
+	if ( !reader.isValid || ( unitLength > static_cast<uint64_t>( reader.end - reader.current ) ) )
+		return false;
+	out_header.unitEnd = reader.current + unitLength;
+
+	out_header.version = reader.ReadU16();
+	out_header.addressSize = sizeof( void* );
+	if ( out_header.version >= 5 )
+	{
+		out_header.addressSize = reader.ReadU8();
+		reader.ReadU8(); //Segment selector size.
+	}
+
+	uint64_t headerLength = reader.ReadOffset( out_header.is64Bit );
+	if ( !reader.isValid || ( headerLength > static_cast<uint64_t>( out_header.unitEnd - reader.current ) ) )
+		return false;
+	out_header.program = reader.current + headerLength;
+
+	out_header.minInstructionLength = reader.ReadU8();
+	if ( out_header.version >= 4 )
+		reader.ReadU8(); //Maximum operations per instruction: only VLIW targets use more than 1.
+	out_header.defaultIsStmt = ( reader.ReadU8() != 0 );
+	out_header.lineBase = static_cast<int8_t>( reader.ReadU8() );
+	out_header.lineRange = reader.ReadU8();
+	out_header.opcodeBase = reader.ReadU8();
+	out_header.standardOpcodeLengths = reader.current;
+	reader.Skip( ( out_header.opcodeBase > 0 ) ? out_header.opcodeBase - 1 : 0 );
+	out_header.directoryTable = reader.current;
+
+	return reader.isValid && ( out_header.version >= 2 ) && ( out_header.version <= 5 ) && ( out_header.lineRange > 0 ) && ( out_header.opcodeBase > 0 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Runs each unit's line program until a row range covers address: the row before the first one past it, in the same sequence.
+static bool FindSourceLine( const CallstackModule& module, uintptr_t address, CallstackLine& out_line )
+{
+	if ( module.debugLine.data == nullptr )
+		return false;
+
+	DwarfReader unitReader( module.debugLine.data, module.debugLine.data + module.debugLine.size );
+	while ( unitReader.isValid && ( unitReader.current < unitReader.end ) )
+	{
+		DwarfLineHeader header;
+		if ( !ReadDwarfLineHeader( unitReader, header ) )
+		{
+			if ( !unitReader.isValid || ( header.unitEnd == nullptr ) )
+				return false;
+			unitReader.current = header.unitEnd; //Unsupported version: skip the unit.
+			continue;
+		}
+		unitReader.current = header.unitEnd;
+
+		DwarfReader reader( header.program, header.unitEnd );
+		uint64_t rowAddress = 0;
+		uint64_t fileIndex = 1;
+		int64_t line = 1;
+		bool hasPreviousRow = false;
+		uint64_t previousAddress = 0;
+		uint64_t previousFileIndex = 0;
+		int64_t previousLine = 0;
+
+		while ( reader.isValid && ( reader.current < reader.end ) )
+		{
+			bool isRow = false;
+			bool isEndOfSequence = false;
+
+			uint8_t opcode = reader.ReadU8();
+			if ( opcode >= header.opcodeBase )
+			{
+				uint8_t adjustedOpcode = opcode - header.opcodeBase;
+				rowAddress += header.minInstructionLength * ( adjustedOpcode / header.lineRange );
+				line += header.lineBase + ( adjustedOpcode % header.lineRange );
+				isRow = true;
+			}
+			else if ( opcode == 0 )
+			{
+				uint64_t length = reader.ReadULEB128();
+				const uint8_t* next = reader.current;
+				if ( ( length == 0 ) || !reader.Skip( length ) )
+					break;
+				reader.current = next;
+
+				uint8_t extendedOpcode = reader.ReadU8();
+				if ( extendedOpcode == DW_LNE_END_SEQUENCE )
+					isRow = isEndOfSequence = true;
+				else if ( extendedOpcode == DW_LNE_SET_ADDRESS )
+					rowAddress = reader.ReadUnsigned( static_cast<unsigned int>( length - 1 ) );
+				reader.current = next + length;
+			}
+			else
+			{
+				switch ( opcode )
+				{
+					case DW_LNS_COPY: isRow = true; break;
+					case DW_LNS_ADVANCE_PC: rowAddress += header.minInstructionLength * reader.ReadULEB128(); break;
+					case DW_LNS_ADVANCE_LINE: line += reader.ReadSLEB128(); break;
+					case DW_LNS_SET_FILE: fileIndex = reader.ReadULEB128(); break;
+					case DW_LNS_CONST_ADD_PC: rowAddress += header.minInstructionLength * ( ( 255 - header.opcodeBase ) / header.lineRange ); break;
+					case DW_LNS_FIXED_ADVANCE_PC: rowAddress += reader.ReadU16(); break;
+					default: //Everything else only sets registers lines don't need: skip its operands.
+						for ( uint8_t operandIndex = 0; operandIndex < header.standardOpcodeLengths[ opcode - 1 ]; operandIndex++ )
+							reader.ReadULEB128();
+						break;
+				}
+			}
+
+			if ( !isRow )
+				continue;
+
+			if ( hasPreviousRow && ( previousAddress <= address ) && ( address < rowAddress ) )
+			{
+				GetDwarfLineFileName( module, header, previousFileIndex, out_line.filename, MAX_FILENAME_LENGTH );
+				out_line.line = static_cast<uint32_t>( previousLine );
+				out_line.offset = static_cast<uint32_t>( address - previousAddress );
+				return true;
+			}
+
+			hasPreviousRow = !isEndOfSequence;
+			previousAddress = rowAddress;
+			previousFileIndex = fileIndex;
+			previousLine = line;
+			if ( isEndOfSequence )
+			{
+				rowAddress = 0;
+				fileIndex = 1;
+				line = 1;
+			}
+		}
+	}
+
+	return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void Callstack::ResolveStackFrame( void* stackFrame, CallstackLine& out_line )
+{
+	strncpy( out_line.functionName, UNRESOLVED_STR, MAX_SYMBOL_NAME_LENGTH );
+	strncpy( out_line.filename, UNRESOLVED_STR, MAX_FILENAME_LENGTH );
+	out_line.line = 0;
+	out_line.offset = 0;
+
+	Dl_info info;
+	link_map* moduleMap = nullptr;
+	if ( ( dladdr1( stackFrame, &info, reinterpret_cast<void**>( &moduleMap ), RTLD_DL_LINKMAP ) == 0 ) || ( moduleMap == nullptr ) )
+		return;
+
+	//Frames are return addresses, the instruction after the call: step back into the call itself. Symbols and line
+	//tables both use the module's link-time addresses, so take off where it was actually loaded, too.
+	const uintptr_t address = reinterpret_cast<uintptr_t>( stackFrame ) - 1 - moduleMap->l_addr;
+	const char* modulePath = ( moduleMap->l_name[ 0 ] != '\0' ) ? moduleMap->l_name : "/proc/self/exe"; //The main program has no name here.
+	const CallstackModule* module = FindOrLoadCallstackModule( modulePath );
+
+	const char* symbolName = nullptr;
+	uintptr_t symbolAddress = 0;
+	if ( module != nullptr )
+	{
+		symbolName = FindFunctionSymbol( module->symtab, module->symtabStrings, address, symbolAddress );
+		if ( symbolName == nullptr )
+			symbolName = FindFunctionSymbol( module->dynsym, module->dynsymStrings, address, symbolAddress );
+	}
+	if ( symbolName == nullptr )
+		symbolName = info.dli_sname;
+
+	if ( symbolName != nullptr )
+	{
+		int status = 0;
+		char* demangledName = abi::__cxa_demangle( symbolName, nullptr, nullptr, &status );
+		snprintf( out_line.functionName, MAX_SYMBOL_NAME_LENGTH, "%s", ( status == 0 ) ? demangledName : symbolName );
+		free( demangledName );
+	}
+
+	if ( ( module == nullptr ) || !FindSourceLine( *module, address, out_line ) )
+		snprintf( out_line.filename, MAX_FILENAME_LENGTH, "%s", ( info.dli_fname != nullptr ) ? info.dli_fname : modulePath ); //At least say which module.
+}
+#endif
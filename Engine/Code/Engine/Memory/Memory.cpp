@@ -1,6 +1,7 @@
 #include "Engine/Memory/Memory.hpp"
 
 #include <map>
+#include <atomic>
 #include "Engine/Memory/Callstack.hpp"
 #include "Engine/Memory/UntrackedAllocator.hpp"
 #include "Engine/Error/ErrorWarningAssert.hpp"
@@ -21,6 +22,8 @@ static AllocationToCallstackMap* g_callstackRegistry = nullptr;
 //--------------------------------------------------------------------------------------------------------------
 static bool s_hasTrackerStarted = false;
 static unsigned int s_numberOfAllocations = 0;
+static std::atomic< unsigned int > s_numberOfAllocationCallsEver( 0 ); //Never decremented, so deltas give allocation churn rather than net live count. Atomic as job threads allocate too.
+static thread_local unsigned int t_numberOfAllocationCallsOnThread = 0; //Same, but only this thread's, so a measurement isn't polluted by whatever the job threads are doing.
 static unsigned int s_totalAllocatedBytes = 0;
 static unsigned int s_maxTotalAllocatedBytes = 0;
 STATIC unsigned int MemoryAnalytics::m_numAllocationsAtStartup = 0;
@@ -42,6 +45,8 @@ void* operator new( size_t numBytes )
 	size_t* ptr = (size_t*)malloc( numBytes + sizeof( size_t ) );
 	//DebuggerPrintf( "Alloc %p of %u bytes.\n", ptr, numBytes );
 	++s_numberOfAllocations;
+	++s_numberOfAllocationCallsEver;
+	++t_numberOfAllocationCallsOnThread;
 	++s_numAllocationsSinceLastUpdate;
 	s_totalAllocatedBytes += numBytes;
 
@@ -83,6 +88,8 @@ void* operator new[] ( size_t numBytesEntireArray )
 	size_t* ptr = (size_t*)malloc( numBytesEntireArray + sizeof( size_t ) );
 	//DebuggerPrintf( "Alloc %p of %u bytes.\n", ptr, numBytes );
 	++s_numberOfAllocations;
+	++s_numberOfAllocationCallsEver;
+	++t_numberOfAllocationCallsOnThread;
 	++s_numAllocationsSinceLastUpdate;
 	s_totalAllocatedBytes += numBytesEntireArray;
 
@@ -309,6 +316,20 @@ STATIC unsigned int MemoryAnalytics::GetCurrentNumAllocations()
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int MemoryAnalytics::GetLifetimeNumAllocationCalls()
+{
+	return s_numberOfAllocationCallsEver;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int MemoryAnalytics::GetThreadLifetimeNumAllocationCalls()
+{
+	return t_numberOfAllocationCallsOnThread;
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 STATIC unsigned int MemoryAnalytics::GetAllocationsAtStartup()
 {
@@ -18,6 +18,8 @@ public:
 	static void Update( float deltaSeconds );
 
 	static unsigned int GetCurrentNumAllocations();
+	static unsigned int GetLifetimeNumAllocationCalls();
+	static unsigned int GetThreadLifetimeNumAllocationCalls(); //Only those made on the calling thread.
 	static unsigned int GetAllocationsAtStartup();
 	static unsigned int GetCurrentTotalAllocatedBytes();
 	static unsigned int GetCurrentHighwaterMark();
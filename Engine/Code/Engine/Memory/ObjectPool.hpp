@@ -18,6 +18,7 @@ class ObjectPool
 public:
 	void Init( const size_t numObjectsPerBlock ); //Note that init is called at start to kick off the ObjectPool, not what we alloc from per object--that's alloc().
 	TypeAllocated* Allocate();
+	TypeAllocated* TryAllocate(); //Returns nullptr when exhausted, for callers with a fallback.
 	void Delete( TypeAllocated* ptr );
 
 
@@ -38,6 +39,7 @@ template < typename TypeAllocated > void ObjectPool<TypeAllocated>::Init( const
 		//Can't do ++ with a PageNode since it's usually smaller than sizeof(T) since PageNode's just a single pointer in size, but can with a T++.
 	TypeAllocated* buffer = (TypeAllocated*)malloc( bufferSize );
 	m_memoryBuffer = (byte_t*)buffer;
+	m_freePagesStack = nullptr; //Terminates the list, so running dry is detectable in Allocate.
 
 	//Moving backwards through buffer so it's arranged how we want initially (will fragment with alloc/free's over time).
 	for ( size_t pageIndex = numObjectsPerBlock - 1; ; pageIndex-- )
@@ -57,9 +59,24 @@ template < typename TypeAllocated > void ObjectPool<TypeAllocated>::Init( const
 //--------------------------------------------------------------------------------------------------------------
 template < typename TypeAllocated > TypeAllocated* ObjectPool<TypeAllocated>::Allocate()
 {
+	TypeAllocated* newObj = TryAllocate();
+	ASSERT_OR_DIE( newObj != nullptr, "ObjectPool exhausted, raise the count passed to Init!" );
+
+	return newObj;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+template < typename TypeAllocated > TypeAllocated* ObjectPool<TypeAllocated>::TryAllocate()
+{
+	m_criticalSection.Lock(); //Jobs are created on one thread and released on another.
 	TypeAllocated* newObj = (TypeAllocated*)m_freePagesStack;
-	m_freePagesStack = m_freePagesStack->next;
-	new ( newObj ) TypeAllocated();
+	if ( newObj != nullptr )
+		m_freePagesStack = m_freePagesStack->next;
+	m_criticalSection.Unlock();
+
+	if ( newObj != nullptr )
+		new ( newObj ) TypeAllocated();
 
 	return newObj;
 }
@@ -73,6 +90,8 @@ template < typename TypeAllocated > void ObjectPool<TypeAllocated>::Delete( Type
 
 	ptr->~TypeAllocated();
 	PageNode* n = (PageNode*)ptr;
+	m_criticalSection.Lock();
 	n->next = m_freePagesStack;
 	m_freePagesStack = n; //This is why even if we alloc 3 things, and free the middle, things stay sane.
+	m_criticalSection.Unlock();
 }
\ No newline at end of file
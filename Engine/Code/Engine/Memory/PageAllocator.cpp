@@ -9,6 +9,8 @@ PageAllocator::PageAllocator( size_t pageSize, size_t initialNumPages )
 	size_t totalSize = pageSize * initialNumPages;
 	byte_t* memoryBlock = (byte_t*)malloc( totalSize );
 	m_freePagesStack = nullptr;
+	m_memoryBlock = memoryBlock;
+	m_blockSize = totalSize;
 	
 	//Moving backwards through buffer so it's arranged how we want initially (will fragment with alloc/free's over time).
 	for ( size_t pageIndex = initialNumPages - 1; ; pageIndex-- )
@@ -31,6 +33,9 @@ PageAllocator::PageAllocator( size_t pageSize, size_t initialNumPages )
 void* PageAllocator::Allocate()
 {
 	PageNode* page = m_freePagesStack;
+	if ( page == nullptr )
+		return nullptr;
+
 	m_freePagesStack = m_freePagesStack->next;
 	return page; //When it's used, this is no longer a "page", it's an allocation we're casting.
 }
@@ -43,3 +48,11 @@ void PageAllocator::Free( void* ptr )
 	m_freePagesStack = (PageNode*)ptr;
 	m_freePagesStack->next = temp; //This is why even if we alloc 3 things, and free the middle, things stay sane.
 }
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool PageAllocator::Owns( const void* ptr ) const
+{
+	const byte_t* bytePtr = (const byte_t*)ptr;
+	return ( bytePtr >= m_memoryBlock ) && ( bytePtr < m_memoryBlock + m_blockSize );
+}
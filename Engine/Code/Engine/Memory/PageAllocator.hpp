@@ -1,6 +1,10 @@
 #pragma once
 
 
+//--------------------------------------------------------------------------------------------------------------
+typedef unsigned char byte_t;
+
+
 //--------------------------------------------------------------------------------------------------------------
 struct PageNode
 {
@@ -14,9 +18,12 @@ class PageAllocator
 {
 public:
 	PageAllocator( size_t pageSize, size_t initialNumPages );
-	void* Allocate();
+	void* Allocate(); //Returns nullptr once every page is out, so callers can fall back to the heap.
 	void Free( void* ptr );
+	bool Owns( const void* ptr ) const;
 
 private:
 	PageNode* m_freePagesStack; //Since we "pop" them off on free(), and "push" them on in alloc().
+	byte_t* m_memoryBlock;
+	size_t m_blockSize;
 };
@@ -0,0 +1,645 @@
+#include "Engine/Physics/Cloth.hpp"
+
+
+#include "Engine/Physics/Forces.hpp"
+#include "Engine/Concurrency/JobUtils.hpp"
+#include "Engine/Core/Command.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Renderer/MeshRenderer.hpp"
+#include "Engine/Renderer/TheRenderer.hpp"
+#include "Engine/Time/Time.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const float CLOTH_GRAVITY = 9.81f;
+static const float MAX_SECONDS_PER_UPDATE = 1.f / 30.f; //Longer frames (hitches, breakpoints) slow the cloth down rather than blow it up.
+static const unsigned int DEFAULT_NUM_SUBSTEPS = 2;
+static const float DEFAULT_DAMPING_PER_SECOND = .1f;
+static const float DEFAULT_COMPLIANCES[ NUM_CONSTRAINT_TYPES ] = { 0.f, 1e-6f, 1e-4f }; //Stretch, shear, bend: stiff fabric that still folds.
+//At ~7ns a constraint, about 30us of work: several times a dispatch and wake-up, which are paid per color, per iteration, per substep.
+//So a 64x64 cloth's ~2000-constraint colors relax on the calling thread, and only far bigger cloths go wide.
+static const unsigned int MIN_CONSTRAINTS_PER_RELAX_JOB = 4096;
+static const unsigned int MAX_RELAX_JOBS = 8;
+
+static const float DEFAULT_CLOTH_TEST_BUDGET_MS = 4.f;
+static const int DEFAULT_CLOTH_TEST_SIZE = 64;
+static const unsigned int CLOTH_TEST_SOLVER_ITERATIONS = 4; //Per substep: XPBD spends its effort on substeps first.
+static const float CLOTH_TEST_SETTLED_KINETIC_ENERGY_RATIO = .001f; //Of the potential energy released by falling.
+
+
+//--------------------------------------------------------------------------------------------------------------
+Cloth::Cloth( const Vector3f& originTopLeftPosition,
+			  EphanovParticleType particleRenderType, float particleMass, float particleRadius,
+			  int numRows, int numCols,
+			  unsigned int numConstraintSolverIterations,
+			  double baseDistanceBetweenParticles /*= 1.f*/,
+			  double ratioDistanceStructuralToShear /*= sqrt( 2.f )*/,
+			  double ratioDistanceStructuralToBend /*= 2.f*/,
+			  const Vector3f& initialGlobalVelocity /*= Vector3f::ZERO*/ )
+	: m_originalTopLeftPosition( originTopLeftPosition )
+	, m_currentTopLeftPosition( originTopLeftPosition )
+	, m_numRows( numRows )
+	, m_numCols( numCols )
+	, m_numConstraintSolverIterations( numConstraintSolverIterations )
+	, m_originalNumConstraints( 0 )
+	, m_baseDistanceBetweenParticles( baseDistanceBetweenParticles )
+	, m_ratioDistanceStructuralToShear( ratioDistanceStructuralToShear )
+	, m_ratioDistanceStructuralToBend( ratioDistanceStructuralToBend )
+	, m_solverMode( CLOTH_SOLVER_XPBD )
+	, m_stiffness( 1.f )
+	, m_numSubsteps( DEFAULT_NUM_SUBSTEPS )
+	, m_dampingPerSecond( DEFAULT_DAMPING_PER_SECOND )
+	, m_useJobSystem( true )
+	, m_iterationStiffness( 1.f )
+	, m_particleRenderType( particleRenderType )
+	, m_particleRadius( particleRadius )
+	, m_meshRenderer( nullptr )
+	, m_isMeshStale( true )
+	, m_areMeshIndicesStale( true )
+{
+	ASSERT_OR_DIE( ( numRows > 1 ) && ( numCols > 1 ), "Cloth needs at least 2x2 particles!" );
+
+	for ( int constraintType = 0; constraintType < NUM_CONSTRAINT_TYPES; constraintType++ )
+	{
+		m_compliances[ constraintType ] = DEFAULT_COMPLIANCES[ constraintType ];
+		m_alphaTildes[ constraintType ] = 0.f;
+	}
+
+	unsigned int numParticles = numRows * numCols;
+	m_particles.Reserve( numParticles );
+	m_inverseMasses.resize( numParticles, 1.f / particleMass );
+	m_isExpired.resize( numParticles, false );
+
+	AssignParticleStates( static_cast<float>( baseDistanceBetweenParticles ), originTopLeftPosition.y, initialGlobalVelocity );
+
+	AddConstraints( static_cast<float>( baseDistanceBetweenParticles ), static_cast<float>( ratioDistanceStructuralToShear ), static_cast<float>( ratioDistanceStructuralToBend ) );
+
+	SetIsPinned( 0, 0, true );
+	SetIsPinned( 0, numCols - 1, true );
+
+	//Texture coordinates never change, so only positions get rewritten per frame.
+	m_meshVertices.reserve( numParticles );
+	for ( int r = 0; r < m_numRows; r++ )
+	{
+		for ( int c = 0; c < m_numCols; c++ )
+		{
+			Vector2f texCoords( 1.f - ( (float)c / (float)( m_numCols - 1 ) ), (float)r / (float)( m_numRows - 1 ) );
+			m_meshVertices.push_back( Vertex3D_PCT( GetParticlePosition( r, c ), Rgba::WHITE, texCoords ) );
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+Cloth::~Cloth()
+{
+	if ( m_meshRenderer != nullptr )
+		delete m_meshRenderer;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::SetIsPinned( int rowStartTop, int colStartLeft, bool newVal )
+{
+	unsigned int particleIndex = GetParticleIndex( rowStartTop, colStartLeft );
+	m_inverseMasses[ particleIndex ] = newVal ? 0.f : ( 1.f / m_particles.GetMass( particleIndex ) );
+	if ( newVal )
+		m_particles.SetVelocity( particleIndex, Vector3f::ZERO );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::ExpireParticle( int rowStartTop, int colStartLeft )
+{
+	unsigned int particleIndex = GetParticleIndex( rowStartTop, colStartLeft );
+	if ( m_isExpired[ particleIndex ] )
+		return;
+
+	m_isExpired[ particleIndex ] = true;
+	SetIsPinned( rowStartTop, colStartLeft, false ); //A shot corner falls.
+
+	//Dropped here, once, rather than checked for every frame inside the relaxation loop.
+	unsigned int numKept = 0;
+	for ( unsigned int constraintIndex = 0; constraintIndex < m_clothConstraints.size(); constraintIndex++ )
+	{
+		const ClothConstraint& cc = m_clothConstraints[ constraintIndex ];
+		if ( m_isExpired[ cc.particleIndex1 ] && m_isExpired[ cc.particleIndex2 ] ) // Tried to do || instead, creates awkward stretching...
+			continue;
+		m_clothConstraints[ numKept++ ] = cc;
+	}
+
+	if ( numKept < m_clothConstraints.size() )
+	{
+		m_clothConstraints.erase( m_clothConstraints.begin() + numKept, m_clothConstraints.end() );
+		ColorConstraints();
+	}
+	m_areMeshIndicesStale = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool Cloth::IsDead() const
+{
+	return IsExpired( 0, 0 ) && IsExpired( 0, m_numCols - 1 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+float Cloth::GetPercentageConstraintsLeft( ConstraintType constraintType /*= NUM_CONSTRAINT_TYPES*/ ) const
+{
+	return static_cast<float>( GetNumConstraints( constraintType ) ) / static_cast<float>( m_originalNumConstraints );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+int Cloth::GetNumConstraints( ConstraintType constraintType /*= NUM_CONSTRAINT_TYPES*/ ) const
+{
+	if ( constraintType == NUM_CONSTRAINT_TYPES )
+		return static_cast<int>( m_clothConstraints.size() );
+
+	int typeCount = 0;
+	for ( const ClothConstraint& cc : m_clothConstraints )
+	{
+		if ( constraintType == cc.type )
+			++typeCount;
+	}
+	return typeCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::Update( float deltaSeconds )
+{
+	deltaSeconds = GetMin( deltaSeconds, MAX_SECONDS_PER_UPDATE );
+	if ( deltaSeconds <= 0.f )
+		return;
+
+	float substepSeconds = deltaSeconds / m_numSubsteps;
+	for ( unsigned int substep = 0; substep < m_numSubsteps; substep++ )
+		StepSubstep( substepSeconds );
+
+	m_isMeshStale = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::StepSubstep( float deltaSeconds )
+{
+	unsigned int numParticles = GetNumParticles();
+	float* positions[ 3 ] = { m_particles.GetPositions( 0 ), m_particles.GetPositions( 1 ), m_particles.GetPositions( 2 ) };
+	float* velocities[ 3 ] = { m_particles.GetVelocities( 0 ), m_particles.GetVelocities( 1 ), m_particles.GetVelocities( 2 ) };
+
+	for ( unsigned int axis = 0; axis < 3; axis++ )
+		m_substepStartPositions[ axis ].assign( positions[ axis ], positions[ axis ] + numParticles );
+
+	//Predict: the forces' batch kernels move every particle as if unconstrained, then pinned ones go back.
+	m_particles.Step( deltaSeconds, DYNAMICS_INTEGRATOR_SEMI_IMPLICIT_EULER, m_useJobSystem );
+	for ( unsigned int particleIndex = 0; particleIndex < numParticles; particleIndex++ )
+	{
+		if ( m_inverseMasses[ particleIndex ] != 0.f )
+			continue;
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+			positions[ axis ][ particleIndex ] = m_substepStartPositions[ axis ][ particleIndex ];
+	}
+
+	SatisfyConstraints( deltaSeconds );
+
+	//Velocity is whatever moved the particles, constraints included, so the next prediction carries their corrections.
+	float velocityScale = GetMax( 1.f - ( m_dampingPerSecond * deltaSeconds ), 0.f ) / deltaSeconds;
+	for ( unsigned int axis = 0; axis < 3; axis++ )
+		for ( unsigned int particleIndex = 0; particleIndex < numParticles; particleIndex++ )
+			velocities[ axis ][ particleIndex ] = ( positions[ axis ][ particleIndex ] - m_substepStartPositions[ axis ][ particleIndex ] ) * velocityScale;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::SatisfyConstraints( float deltaSeconds )
+{
+	if ( m_solverMode == CLOTH_SOLVER_XPBD )
+	{
+		for ( int constraintType = 0; constraintType < NUM_CONSTRAINT_TYPES; constraintType++ )
+			m_alphaTildes[ constraintType ] = m_compliances[ constraintType ] / ( deltaSeconds * deltaSeconds );
+		for ( ClothConstraint& cc : m_clothConstraints )
+			cc.lambda = 0.f;
+	}
+	else //Spread the stiffness over the iterations, so the cloth doesn't stiffen as they go up.
+	{
+		float stiffness = GetMin( GetMax( m_stiffness, 0.f ), 1.f );
+		m_iterationStiffness = 1.f - powf( 1.f - stiffness, 1.f / static_cast<float>( m_numConstraintSolverIterations ) );
+	}
+
+	//No two constraints of a color share a particle, so a color splits across jobs however it likes. Colors still run in order.
+	JobSystem* jobSystem = JobSystem::Instance();
+	bool useJobSystem = m_useJobSystem && jobSystem->IsRunning();
+	for ( unsigned int numIteration = 0; numIteration < m_numConstraintSolverIterations; ++numIteration )
+	{
+		for ( unsigned int color = 0; color < GetNumConstraintColors(); color++ )
+		{
+			unsigned int firstConstraint = m_colorStartIndices[ color ];
+			unsigned int numConstraints = m_colorStartIndices[ color + 1 ] - firstConstraint;
+			unsigned int numJobs = useJobSystem ? GetMin( MAX_RELAX_JOBS, numConstraints / MIN_CONSTRAINTS_PER_RELAX_JOB ) : 0;
+			if ( numJobs < 2 )
+			{
+				RelaxConstraints( firstConstraint, numConstraints );
+				continue;
+			}
+
+			unsigned int constraintsPerJob = ( numConstraints + numJobs - 1 ) / numJobs;
+			for ( unsigned int jobStart = 0; jobStart < numConstraints; jobStart += constraintsPerJob )
+			{
+				Job* job = jobSystem->CreateJob( JOB_CATEGORY_GENERIC, RelaxConstraintsJob );
+				job->Write<Cloth*>( this );
+				job->Write<unsigned int>( firstConstraint + jobStart );
+				job->Write<unsigned int>( GetMin( constraintsPerJob, numConstraints - jobStart ) );
+				jobSystem->DispatchJob( job );
+				m_relaxJobs.push_back( job );
+			}
+			jobSystem->WaitOnJobsForCompletion( m_relaxJobs );
+			m_relaxJobs.clear();
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void Cloth::RelaxConstraintsJob( Job* job )
+{
+	Cloth* cloth = job->Read<Cloth*>();
+	unsigned int firstConstraint = job->Read<unsigned int>();
+	unsigned int numConstraints = job->Read<unsigned int>();
+
+	cloth->RelaxConstraints( firstConstraint, numConstraints );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::RelaxConstraints( unsigned int firstConstraint, unsigned int numConstraints )
+{
+	float* positionsX = m_particles.GetPositions( 0 );
+	float* positionsY = m_particles.GetPositions( 1 );
+	float* positionsZ = m_particles.GetPositions( 2 );
+	const float* inverseMasses = m_inverseMasses.data();
+	bool isXPBD = ( m_solverMode == CLOTH_SOLVER_XPBD );
+
+	unsigned int endConstraint = firstConstraint + numConstraints;
+	for ( unsigned int constraintIndex = firstConstraint; constraintIndex < endConstraint; constraintIndex++ )
+	{
+		ClothConstraint& cc = m_clothConstraints[ constraintIndex ];
+		unsigned int index1 = cc.particleIndex1;
+		unsigned int index2 = cc.particleIndex2;
+
+		float inverseMass1 = inverseMasses[ index1 ];
+		float inverseMass2 = inverseMasses[ index2 ];
+		float inverseMassSum = inverseMass1 + inverseMass2;
+		if ( inverseMassSum == 0.f )
+			continue; //Both pinned, neither need correction.
+
+		float displacementX = positionsX[ index1 ] - positionsX[ index2 ];
+		float displacementY = positionsY[ index1 ] - positionsY[ index2 ];
+		float displacementZ = positionsZ[ index1 ] - positionsZ[ index2 ];
+		float currentDistance = sqrtf( ( displacementX * displacementX ) + ( displacementY * displacementY ) + ( displacementZ * displacementZ ) );
+		if ( currentDistance == 0.f )
+			continue; //No direction to correct along, skip solving for a step.
+
+		//Gradient is the unit displacement for p1 and its negative for p2. Each moves in proportion to its inverse mass, so pinned ones don't.
+		float error = currentDistance - cc.restDistance;
+		float deltaLambda;
+		if ( isXPBD )
+		{
+			float alphaTilde = m_alphaTildes[ cc.type ];
+			deltaLambda = ( -error - ( alphaTilde * cc.lambda ) ) / ( inverseMassSum + alphaTilde );
+			cc.lambda += deltaLambda;
+		}
+		else deltaLambda = -error * m_iterationStiffness / inverseMassSum;
+
+		float correctionScale = deltaLambda / currentDistance;
+		positionsX[ index1 ] += inverseMass1 * correctionScale * displacementX;
+		positionsY[ index1 ] += inverseMass1 * correctionScale * displacementY;
+		positionsZ[ index1 ] += inverseMass1 * correctionScale * displacementZ;
+		positionsX[ index2 ] -= inverseMass2 * correctionScale * displacementX;
+		positionsY[ index2 ] -= inverseMass2 * correctionScale * displacementY;
+		positionsZ[ index2 ] -= inverseMass2 * correctionScale * displacementZ;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::Render( bool showCloth /*= true*/, bool showConstraints /*= false*/, bool showParticles /*= false*/ )
+{
+	if ( showCloth )
+	{
+		if ( m_isMeshStale || m_areMeshIndicesStale )
+			UpdateMesh();
+		m_meshRenderer->Render();
+		g_theRenderer->UnbindTexture();
+	}
+
+	if ( showConstraints )
+	{
+		for ( const ClothConstraint& cc : m_clothConstraints )
+		{
+			Vector3f particlePosition1 = m_particles.GetPosition( cc.particleIndex1 );
+			Vector3f particlePosition2 = m_particles.GetPosition( cc.particleIndex2 );
+
+			switch ( cc.type )
+			{
+			case STRETCH:	g_theRenderer->DrawLine( particlePosition1, particlePosition2, Rgba::RED, Rgba::RED ); break;
+			case SHEAR:		g_theRenderer->DrawLine( particlePosition1, particlePosition2, Rgba::GREEN, Rgba::GREEN ); break;
+			case BEND:		g_theRenderer->DrawLine( particlePosition1, particlePosition2, Rgba::BLUE, Rgba::BLUE ); break;
+			}
+		}
+	}
+
+	if ( !showParticles )
+		return;
+
+	for ( unsigned int particleIndex = 0; particleIndex < GetNumParticles(); particleIndex++ )
+	{
+		if ( m_isExpired[ particleIndex ] )
+			continue;
+
+		Vector3f particlePosition = m_particles.GetPosition( particleIndex );
+		switch ( m_particleRenderType )
+		{
+		case EphanovParticle_SPHERE:
+			g_theRenderer->DrawAnthonyCloudySphere( particlePosition, m_particleRadius, 20.f );
+			break;
+		case EphanovParticle_AABB3:
+			Vector3f offsetToCorners = Vector3f( m_particleRadius );
+			g_theRenderer->DrawShadedAABB( VertexGroupingRule::AS_TRIANGLES, AABB3f( particlePosition - offsetToCorners, particlePosition + offsetToCorners ), Rgba::GREEN, Rgba::WHITE, Rgba::BLACK, Rgba::RED );
+			break;
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::UpdateMesh()
+{
+	unsigned int numParticles = GetNumParticles();
+	for ( unsigned int particleIndex = 0; particleIndex < numParticles; particleIndex++ )
+		m_meshVertices[ particleIndex ].m_position = m_particles.GetPosition( particleIndex );
+	m_isMeshStale = false;
+
+	if ( ( m_mesh != nullptr ) && !m_areMeshIndicesStale )
+	{
+		m_mesh->SetThenUpdateMeshBuffers( numParticles, m_meshVertices.data() ); //Keeps the IBO.
+		return;
+	}
+
+	//Every 4 particle positions (r,c) to (r+1,c+1) make a quad, skipped once all four have been shot.
+	std::vector< unsigned int > indices;
+	indices.reserve( ( m_numRows - 1 ) * ( m_numCols - 1 ) * 6 );
+	for ( int r = 0; ( r + 1 ) < m_numRows; r++ )
+	{
+		for ( int c = 0; ( c + 1 ) < m_numCols; c++ )
+		{
+			unsigned int topLeft = GetParticleIndex( r, c ); //as 0,0 is top left.
+			unsigned int topRight = GetParticleIndex( r, c + 1 );
+			unsigned int bottomLeft = GetParticleIndex( r + 1, c );
+			unsigned int bottomRight = GetParticleIndex( r + 1, c + 1 );
+			if ( m_isExpired[ topLeft ] && m_isExpired[ topRight ] && m_isExpired[ bottomLeft ] && m_isExpired[ bottomRight ] )
+				continue;
+
+			indices.push_back( bottomLeft );
+			indices.push_back( bottomRight );
+			indices.push_back( topRight );
+			indices.push_back( bottomLeft );
+			indices.push_back( topRight );
+			indices.push_back( topLeft );
+		}
+	}
+	m_areMeshIndicesStale = false;
+
+	if ( m_mesh == nullptr )
+	{
+		DrawInstruction drawInstructions[] = { DrawInstruction( VertexGroupingRule::AS_TRIANGLES, 0, indices.size(), true ) };
+		m_mesh = std::shared_ptr<Mesh>( new Mesh( BufferUsage::STREAM_DRAW, Vertex3D_PCT::DEFINITION, numParticles, m_meshVertices.data(), indices.size(), indices.data(), 1, drawInstructions ) );
+		m_meshRenderer = new MeshRenderer( m_mesh, TheRenderer::s_defaultMaterial3D );
+		return;
+	}
+
+	m_mesh->ClearDrawInstructions();
+	m_mesh->AddDrawInstruction( VertexGroupingRule::AS_TRIANGLES, 0, indices.size(), true );
+	m_mesh->SetThenUpdateMeshBuffers( numParticles, m_meshVertices.data(), indices.size(), indices.data() );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+float Cloth::CalcKineticEnergy() const
+{
+	float kineticEnergy = 0.f;
+	for ( unsigned int particleIndex = 0; particleIndex < GetNumParticles(); particleIndex++ )
+	{
+		Vector3f velocity = m_particles.GetVelocity( particleIndex );
+		kineticEnergy += .5f * m_particles.GetMass( particleIndex ) * DotProduct( velocity, velocity );
+	}
+	return kineticEnergy;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+float Cloth::CalcMaxStretch() const
+{
+	float maxStretch = 0.f;
+	for ( const ClothConstraint& cc : m_clothConstraints )
+	{
+		if ( cc.type != STRETCH )
+			continue;
+		float currentDistance = ( m_particles.GetPosition( cc.particleIndex1 ) - m_particles.GetPosition( cc.particleIndex2 ) ).CalcFloatLength();
+		maxStretch = GetMax( maxStretch, ( currentDistance / cc.restDistance ) - 1.f );
+	}
+	return maxStretch;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::ResetForces( bool keepGravity /*= true*/ )
+{
+	m_particles.ClearForces( keepGravity );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::RemoveAllConstraints()
+{
+	m_clothConstraints.clear();
+	ColorConstraints();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::AssignParticleStates( float baseDistance, float nonPlanarDepth, const Vector3f& velocity /*= Vector3f::ZERO*/ )
+{
+	//FORCES ASSIGNED HERE RIGHT NOW:
+	m_particles.AddForce( new GravityForce( CLOTH_GRAVITY, WORLD3D_DOWN ) );
+	//m_particles.AddForce( new SpringForce( 0, Vector3f::ZERO, .72f, .72f ) );
+	//m_particles.AddForce( new ConstantWindForce( 30.f, Vector3f::UP ) );
+	//m_particles.AddForce( new WormholeForce( m_currentTopLeftPosition, 2.f, Vector3f::ONE ) );
+
+	float particleMass = 1.f / m_inverseMasses[ 0 ];
+	for ( int r = 0; r < m_numRows; r++ )
+	{
+		for ( int c = 0; c < m_numCols; c++ )
+		{
+			Vector3f startPosition( c * baseDistance, -r * baseDistance, nonPlanarDepth ); //BASIS CHANGE GOES HERE!
+			startPosition += m_currentTopLeftPosition;
+			m_particles.AddBody( startPosition, velocity, particleMass ); //Index matches GetParticleIndex( r, c ).
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::SetDistancesForConstraints( ConstraintType affectedType, float newRestDistance )
+{
+	for ( ClothConstraint& cc : m_clothConstraints )
+		if ( cc.type == affectedType )
+			cc.restDistance = newRestDistance;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::AddConstraints( float baseDistance, float ratioStructuralToShear, float ratioStructuralToBend )
+{
+	float shearDist = baseDistance * ratioStructuralToShear;
+	float bendDist = baseDistance * ratioStructuralToBend;
+
+	//Only toward later particles, so each pair gets one constraint instead of one from each end.
+	for ( int r = 0; r < m_numRows; r++ )
+	{
+		for ( int c = 0; c < m_numCols; c++ )
+		{
+			unsigned int particleIndex = GetParticleIndex( r, c );
+
+			if ( ( c + 1 ) < m_numCols )
+				m_clothConstraints.push_back( ClothConstraint( STRETCH, particleIndex, GetParticleIndex( r, c + 1 ), baseDistance ) );
+			if ( ( r + 1 ) < m_numRows )
+				m_clothConstraints.push_back( ClothConstraint( STRETCH, particleIndex, GetParticleIndex( r + 1, c ), baseDistance ) );
+
+			if ( ( r + 1 ) < m_numRows && ( c + 1 ) < m_numCols )
+				m_clothConstraints.push_back( ClothConstraint( SHEAR, particleIndex, GetParticleIndex( r + 1, c + 1 ), shearDist ) );
+			if ( ( r + 1 ) < m_numRows && ( c - 1 ) >= 0 )
+				m_clothConstraints.push_back( ClothConstraint( SHEAR, particleIndex, GetParticleIndex( r + 1, c - 1 ), shearDist ) );
+
+			if ( ( c + 2 ) < m_numCols )
+				m_clothConstraints.push_back( ClothConstraint( BEND, particleIndex, GetParticleIndex( r, c + 2 ), bendDist ) );
+			if ( ( r + 2 ) < m_numRows )
+				m_clothConstraints.push_back( ClothConstraint( BEND, particleIndex, GetParticleIndex( r + 2, c ), bendDist ) );
+		}
+	}
+
+	m_originalNumConstraints = m_clothConstraints.size();
+	ColorConstraints();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Cloth::ColorConstraints()
+{
+	//Greedy: each constraint takes the lowest color neither of its particles has yet.
+	unsigned int numConstraints = m_clothConstraints.size();
+	std::vector< unsigned long long > particleUsedColors( GetNumParticles(), 0 );
+	std::vector< unsigned char > constraintColors( numConstraints );
+	unsigned int numPerColor[ MAX_CONSTRAINT_COLORS ] = { 0 };
+	unsigned int numColors = 0;
+	for ( unsigned int constraintIndex = 0; constraintIndex < numConstraints; constraintIndex++ )
+	{
+		const ClothConstraint& cc = m_clothConstraints[ constraintIndex ];
+		unsigned long long usedColors = particleUsedColors[ cc.particleIndex1 ] | particleUsedColors[ cc.particleIndex2 ];
+		unsigned int color = 0;
+		while ( ( usedColors & ( 1ULL << color ) ) != 0 )
+			++color;
+		ASSERT_OR_DIE( color < MAX_CONSTRAINT_COLORS, "Cloth::ColorConstraints ran out of colors!" );
+
+		constraintColors[ constraintIndex ] = static_cast<unsigned char>( color );
+		particleUsedColors[ cc.particleIndex1 ] |= ( 1ULL << color );
+		particleUsedColors[ cc.particleIndex2 ] |= ( 1ULL << color );
+		++numPerColor[ color ];
+		numColors = GetMax( numColors, color + 1 );
+	}
+
+	//Counting sort by color, keeping creation order within one so neighboring constraints stay neighbors in memory.
+	m_colorStartIndices.assign( numColors + 1, 0 );
+	for ( unsigned int color = 0; color < numColors; color++ )
+		m_colorStartIndices[ color + 1 ] = m_colorStartIndices[ color ] + numPerColor[ color ];
+
+	std::vector< unsigned int > nextIndexPerColor( m_colorStartIndices.begin(), m_colorStartIndices.end() - 1 );
+	std::vector< ClothConstraint > sortedConstraints;
+	sortedConstraints.reserve( numConstraints );
+	sortedConstraints.insert( sortedConstraints.end(), m_clothConstraints.begin(), m_clothConstraints.end() );
+	for ( unsigned int constraintIndex = 0; constraintIndex < numConstraints; constraintIndex++ )
+		sortedConstraints[ nextIndexPerColor[ constraintColors[ constraintIndex ] ]++ ] = m_clothConstraints[ constraintIndex ];
+	m_clothConstraints.swap( sortedConstraints );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static float CalcHangingSheetEnergy( const Cloth& sheet, float particleMass )
+{
+	//Kinetic plus gravitational potential. Constraint potential is left out: stretch has no compliance, so it stores none.
+	float potentialEnergy = 0.f;
+	for ( int r = 0; r < sheet.GetNumRows(); r++ )
+		for ( int c = 0; c < sheet.GetNumCols(); c++ )
+			potentialEnergy += particleMass * CLOTH_GRAVITY * DotProduct( sheet.GetParticlePosition( r, c ), WORLD3D_UP );
+	return sheet.CalcKineticEnergy() + potentialEnergy;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC bool Cloth::RunSelfTest( float budgetMs, int numRowsAndCols )
+{
+	const float deltaSeconds = 1.f / 60.f;
+	const float particleMass = 1.f;
+
+	//A sheet pinned by its top corners, stepped at 60 Hz for 10 seconds: it should hang still, having lost energy, never gained it.
+	Cloth sheet( Vector3f::ZERO, EphanovParticle_AABB3, particleMass, .05f, 16, 16, CLOTH_TEST_SOLVER_ITERATIONS, .1 );
+	sheet.SetDampingPerSecond( 1.f );
+	float startEnergy = CalcHangingSheetEnergy( sheet, particleMass );
+	for ( int frame = 0; frame < 600; frame++ )
+		sheet.Update( deltaSeconds );
+	float finalEnergy = CalcHangingSheetEnergy( sheet, particleMass );
+	float finalKineticEnergy = sheet.CalcKineticEnergy();
+	float maxStretch = sheet.CalcMaxStretch();
+	bool didSettle = ( finalEnergy == finalEnergy ) && ( finalEnergy < startEnergy ) && ( finalKineticEnergy < ( CLOTH_TEST_SETTLED_KINETIC_ENERGY_RATIO * ( startEnergy - finalEnergy ) ) );
+	g_theConsole->Printf( "ClothTest: hanging 16x16 sheet, %u constraint colors, energy %g -> %g J, kinetic %g J, max stretch %.2f%%: %s",
+						  sheet.GetNumConstraintColors(), startEnergy, finalEnergy, finalKineticEnergy, maxStretch * 100.f, didSettle ? "PASS" : "FAIL" );
+
+	//Step time for a big cloth, with and without the JobSystem.
+	Cloth cloth( Vector3f::ZERO, EphanovParticle_AABB3, particleMass, .05f, numRowsAndCols, numRowsAndCols, CLOTH_TEST_SOLVER_ITERATIONS, .1 );
+	const int numTimedFrames = 60;
+	bool didPass = didSettle;
+	for ( int useJobSystem = 0; useJobSystem < 2; useJobSystem++ )
+	{
+		cloth.SetUseJobSystem( useJobSystem != 0 );
+		double startSeconds = GetCurrentTimeSeconds();
+		for ( int frame = 0; frame < numTimedFrames; frame++ )
+			cloth.Update( deltaSeconds );
+		float msPerStep = static_cast<float>( ( GetCurrentTimeSeconds() - startSeconds ) * 1000.0 / numTimedFrames );
+		g_theConsole->Printf( "ClothTest: %dx%d cloth, %d constraints%s: %.3f ms per 60 Hz step, budget %g ms: %s",
+							  numRowsAndCols, numRowsAndCols, cloth.GetNumConstraints(), useJobSystem ? " + jobs" : "", msPerStep, budgetMs, ( msPerStep <= budgetMs ) ? "PASS" : "FAIL" );
+		didPass &= ( msPerStep <= budgetMs );
+	}
+
+	g_theConsole->Printf( "ClothTest: %s", didPass ? "PASS" : "FAIL" );
+	return didPass;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void Cloth::RunTest( Command& args )
+{
+	float budgetMs;
+	args.GetNextFloat( &budgetMs, DEFAULT_CLOTH_TEST_BUDGET_MS );
+	int numRowsAndCols;
+	args.GetNextInt( &numRowsAndCols, DEFAULT_CLOTH_TEST_SIZE );
+	if ( ( budgetMs <= 0.f ) || ( numRowsAndCols < 2 ) )
+	{
+		g_theConsole->Printf( "Usage: ClothTest [budgetMs = %g] [numRowsAndCols = %d]", DEFAULT_CLOTH_TEST_BUDGET_MS, DEFAULT_CLOTH_TEST_SIZE );
+		return;
+	}
+
+	RunSelfTest( budgetMs, numRowsAndCols );
+}
@@ -0,0 +1,429 @@
+#include "Engine/Physics/DynamicsBatch.hpp"
+
+
+#include "Engine/Physics/Forces.hpp"
+#include "Engine/Physics/PhysicsUtils.hpp"
+#include "Engine/Concurrency/JobUtils.hpp"
+#include "Engine/Core/Command.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Time/Time.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const unsigned int MIN_BODIES_PER_STEP_JOB = 8192; //Fewer step faster than a job round trip.
+static const unsigned int MAX_STEP_JOBS = 16;
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline unsigned int RoundUpToSIMDWidth( unsigned int numBodies )
+{
+	return ( numBodies + DynamicsBatch::SIMD_WIDTH - 1 ) & ~( DynamicsBatch::SIMD_WIDTH - 1 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+DynamicsBatch::~DynamicsBatch()
+{
+	ClearForces();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicsBatch::ClearForces( bool keepGravity /*= false*/ )
+{
+	unsigned int numKept = 0;
+	for ( Force* force : m_forces )
+	{
+		if ( keepGravity && ( dynamic_cast<GravityForce*>( force ) != nullptr ) )
+			m_forces[ numKept++ ] = force;
+		else
+			delete force;
+	}
+	m_forces.resize( numKept );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicsBatch::Reserve( unsigned int numBodies )
+{
+	unsigned int numPaddedBodies = RoundUpToSIMDWidth( numBodies );
+	for ( unsigned int axis = 0; axis < 3; axis++ )
+	{
+		m_positions[ axis ].reserve( numPaddedBodies );
+		m_velocities[ axis ].reserve( numPaddedBodies );
+		m_previousAccelerations[ axis ].reserve( numPaddedBodies );
+	}
+	m_masses.reserve( numPaddedBodies );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicsBatch::ResizeArrays( unsigned int numPaddedBodies )
+{
+	//Only the state arrays: Step sizes the scratch ones, and only RK4 needs the stage ones.
+	for ( unsigned int axis = 0; axis < 3; axis++ )
+	{
+		m_positions[ axis ].resize( numPaddedBodies, 0.f );
+		m_velocities[ axis ].resize( numPaddedBodies, 0.f );
+		m_previousAccelerations[ axis ].resize( numPaddedBodies, 0.f );
+	}
+	m_masses.resize( numPaddedBodies, 1.f );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int DynamicsBatch::AddBody( const Vector3f& position, const Vector3f& velocity, float mass )
+{
+	ASSERT_OR_DIE( mass > 0.f, "DynamicsBatch::AddBody needs a positive mass!" );
+
+	unsigned int bodyIndex = m_numBodies++;
+	ResizeArrays( RoundUpToSIMDWidth( m_numBodies ) );
+	SetPosition( bodyIndex, position );
+	SetVelocity( bodyIndex, velocity );
+	m_masses[ bodyIndex ] = mass;
+	for ( unsigned int axis = 0; axis < 3; axis++ )
+		m_previousAccelerations[ axis ][ bodyIndex ] = 0.f;
+
+	return bodyIndex;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicsBatch::RemoveBody( unsigned int bodyIndex )
+{
+	ASSERT_OR_DIE( bodyIndex < m_numBodies, "DynamicsBatch::RemoveBody index out of range!" );
+
+	unsigned int lastBody = --m_numBodies;
+	for ( unsigned int axis = 0; axis < 3; axis++ )
+	{
+		m_positions[ axis ][ bodyIndex ] = m_positions[ axis ][ lastBody ];
+		m_velocities[ axis ][ bodyIndex ] = m_velocities[ axis ][ lastBody ];
+		m_previousAccelerations[ axis ][ bodyIndex ] = m_previousAccelerations[ axis ][ lastBody ];
+
+		//Back to a resting padding body, in case it's still inside the padded count.
+		m_positions[ axis ][ lastBody ] = 0.f;
+		m_velocities[ axis ][ lastBody ] = 0.f;
+		m_previousAccelerations[ axis ][ lastBody ] = 0.f;
+	}
+	m_masses[ bodyIndex ] = m_masses[ lastBody ];
+	m_masses[ lastBody ] = 1.f;
+
+	ResizeArrays( RoundUpToSIMDWidth( m_numBodies ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicsBatch::SetPosition( unsigned int bodyIndex, const Vector3f& newPos )
+{
+	m_positions[ 0 ][ bodyIndex ] = newPos.x;
+	m_positions[ 1 ][ bodyIndex ] = newPos.y;
+	m_positions[ 2 ][ bodyIndex ] = newPos.z;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicsBatch::SetVelocity( unsigned int bodyIndex, const Vector3f& newVel )
+{
+	m_velocities[ 0 ][ bodyIndex ] = newVel.x;
+	m_velocities[ 1 ][ bodyIndex ] = newVel.y;
+	m_velocities[ 2 ][ bodyIndex ] = newVel.z;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicsBatch::Step( float deltaSeconds, DynamicsIntegrator integrator, bool useJobSystem /*= true*/ )
+{
+	unsigned int numPaddedBodies = RoundUpToSIMDWidth( m_numBodies );
+	if ( numPaddedBodies == 0 )
+		return;
+
+	for ( unsigned int axis = 0; axis < 3; axis++ )
+	{
+		m_accelerations[ axis ].resize( numPaddedBodies );
+		if ( integrator == DYNAMICS_INTEGRATOR_RK4 )
+		{
+			m_stagePositions[ axis ].resize( numPaddedBodies );
+			m_stageVelocities[ axis ].resize( numPaddedBodies );
+			m_positionDerivativeSums[ axis ].resize( numPaddedBodies );
+			m_velocityDerivativeSums[ axis ].resize( numPaddedBodies );
+		}
+	}
+
+	//Forces here only read their own body, so any split of the bodies steps independently.
+	JobSystem* jobSystem = JobSystem::Instance();
+	unsigned int numJobs = GetMin( MAX_STEP_JOBS, numPaddedBodies / MIN_BODIES_PER_STEP_JOB );
+	if ( !useJobSystem || !jobSystem->IsRunning() || ( numJobs < 2 ) )
+	{
+		StepRange( 0, numPaddedBodies, deltaSeconds, integrator );
+		return;
+	}
+
+	m_stepJobs.clear(); //Keeps its capacity, so steady-state Steps don't allocate.
+	unsigned int bodiesPerJob = RoundUpToSIMDWidth( ( numPaddedBodies + numJobs - 1 ) / numJobs );
+	for ( unsigned int firstBody = 0; firstBody < numPaddedBodies; firstBody += bodiesPerJob )
+	{
+		Job* job = jobSystem->CreateJob( JOB_CATEGORY_GENERIC, StepRangeJob );
+		job->Write<DynamicsBatch*>( this );
+		job->Write<unsigned int>( firstBody );
+		job->Write<unsigned int>( GetMin( bodiesPerJob, numPaddedBodies - firstBody ) );
+		job->Write<float>( deltaSeconds );
+		job->Write<DynamicsIntegrator>( integrator );
+		jobSystem->DispatchJob( job );
+		m_stepJobs.push_back( job );
+	}
+	jobSystem->WaitOnJobsForCompletion( m_stepJobs );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void DynamicsBatch::StepRangeJob( Job* job )
+{
+	DynamicsBatch* batch = job->Read<DynamicsBatch*>();
+	unsigned int firstBody = job->Read<unsigned int>();
+	unsigned int numBodies = job->Read<unsigned int>();
+	float deltaSeconds = job->Read<float>();
+	DynamicsIntegrator integrator = job->Read<DynamicsIntegrator>();
+
+	batch->StepRange( firstBody, numBodies, deltaSeconds, integrator );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicsBatch::CalcAccelerations( unsigned int firstBody, unsigned int numBodies, float* const positions[ 3 ], float* const velocities[ 3 ], float* const out_accelerations[ 3 ] ) const
+{
+	//Forces accumulate into out_accelerations as net force, which Newton's 2nd law then turns into acceleration in place.
+	DynamicsBatchSpan span;
+	span.m_numBodies = numBodies;
+	span.m_masses = m_masses.data() + firstBody;
+	for ( unsigned int axis = 0; axis < 3; axis++ )
+	{
+		span.m_positions[ axis ] = positions[ axis ];
+		span.m_velocities[ axis ] = velocities[ axis ];
+		span.m_netForces[ axis ] = out_accelerations[ axis ];
+		memset( out_accelerations[ axis ], 0, numBodies * sizeof( float ) );
+	}
+
+	for ( const Force* force : m_forces )
+		force->AccumulateBatchForces( span );
+
+	for ( unsigned int axis = 0; axis < 3; axis++ )
+		for ( unsigned int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++ )
+			out_accelerations[ axis ][ bodyIndex ] /= span.m_masses[ bodyIndex ];
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicsBatch::StepRange( unsigned int firstBody, unsigned int numBodies, float deltaSeconds, DynamicsIntegrator integrator )
+{
+	//Plain loops over one axis' array at a time, which the compiler vectorizes as well as it would hand-written SSE.
+	float* positions[ 3 ];
+	float* velocities[ 3 ];
+	float* accelerations[ 3 ];
+	for ( unsigned int axis = 0; axis < 3; axis++ )
+	{
+		positions[ axis ] = m_positions[ axis ].data() + firstBody;
+		velocities[ axis ] = m_velocities[ axis ].data() + firstBody;
+		accelerations[ axis ] = m_accelerations[ axis ].data() + firstBody;
+	}
+
+	CalcAccelerations( firstBody, numBodies, positions, velocities, accelerations );
+
+	switch ( integrator )
+	{
+	case DYNAMICS_INTEGRATOR_EXPLICIT_EULER:
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			for ( unsigned int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++ )
+			{
+				positions[ axis ][ bodyIndex ] += velocities[ axis ][ bodyIndex ] * deltaSeconds; //x := x + (veloc * dt)
+				velocities[ axis ][ bodyIndex ] += accelerations[ axis ][ bodyIndex ] * deltaSeconds; //v := v + (accel * dt)
+			}
+		}
+		break;
+
+	case DYNAMICS_INTEGRATOR_SEMI_IMPLICIT_EULER:
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			for ( unsigned int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++ )
+			{
+				velocities[ axis ][ bodyIndex ] += accelerations[ axis ][ bodyIndex ] * deltaSeconds;
+				positions[ axis ][ bodyIndex ] += velocities[ axis ][ bodyIndex ] * deltaSeconds;
+			}
+		}
+		break;
+
+	case DYNAMICS_INTEGRATOR_VERLET:
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			float* previousAccelerations = m_previousAccelerations[ axis ].data() + firstBody;
+			for ( unsigned int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++ )
+			{
+				float acceleration = accelerations[ axis ][ bodyIndex ];
+				positions[ axis ][ bodyIndex ] += ( velocities[ axis ][ bodyIndex ] * deltaSeconds ) + ( acceleration * .5f * deltaSeconds * deltaSeconds ); //x := x + v*dt + .5*a*dt*dt.
+				velocities[ axis ][ bodyIndex ] += ( previousAccelerations[ bodyIndex ] + acceleration ) * .5f * deltaSeconds; //v := v + .5*(a + a_next)*dt.
+				previousAccelerations[ bodyIndex ] = acceleration;
+			}
+		}
+		break;
+
+	case DYNAMICS_INTEGRATOR_RK4:
+	{
+		//k1 is the start's derivative, k2 and k3 the midpoint's by the previous k, and k4 the endpoint's by k3.
+		float* stagePositions[ 3 ];
+		float* stageVelocities[ 3 ];
+		float* positionSums[ 3 ];
+		float* velocitySums[ 3 ];
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			stagePositions[ axis ] = m_stagePositions[ axis ].data() + firstBody;
+			stageVelocities[ axis ] = m_stageVelocities[ axis ].data() + firstBody;
+			positionSums[ axis ] = m_positionDerivativeSums[ axis ].data() + firstBody;
+			velocitySums[ axis ] = m_velocityDerivativeSums[ axis ].data() + firstBody;
+		}
+
+		const float halfDeltaSeconds = deltaSeconds * .5f;
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			for ( unsigned int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++ )
+			{
+				positionSums[ axis ][ bodyIndex ] = velocities[ axis ][ bodyIndex ];
+				velocitySums[ axis ][ bodyIndex ] = accelerations[ axis ][ bodyIndex ];
+				stagePositions[ axis ][ bodyIndex ] = positions[ axis ][ bodyIndex ] + ( velocities[ axis ][ bodyIndex ] * halfDeltaSeconds );
+				stageVelocities[ axis ][ bodyIndex ] = velocities[ axis ][ bodyIndex ] + ( accelerations[ axis ][ bodyIndex ] * halfDeltaSeconds );
+			}
+		}
+
+		const float stageSteps[ 2 ] = { halfDeltaSeconds, deltaSeconds }; //k2 leads to the midpoint again, k3 to the endpoint.
+		for ( unsigned int stage = 0; stage < 2; stage++ )
+		{
+			CalcAccelerations( firstBody, numBodies, stagePositions, stageVelocities, accelerations );
+			for ( unsigned int axis = 0; axis < 3; axis++ )
+			{
+				for ( unsigned int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++ )
+				{
+					float stageVelocity = stageVelocities[ axis ][ bodyIndex ];
+					positionSums[ axis ][ bodyIndex ] += 2.f * stageVelocity;
+					velocitySums[ axis ][ bodyIndex ] += 2.f * accelerations[ axis ][ bodyIndex ];
+					stagePositions[ axis ][ bodyIndex ] = positions[ axis ][ bodyIndex ] + ( stageVelocity * stageSteps[ stage ] );
+					stageVelocities[ axis ][ bodyIndex ] = velocities[ axis ][ bodyIndex ] + ( accelerations[ axis ][ bodyIndex ] * stageSteps[ stage ] );
+				}
+			}
+		}
+
+		CalcAccelerations( firstBody, numBodies, stagePositions, stageVelocities, accelerations );
+		const float sixthDeltaSeconds = deltaSeconds / 6.f;
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			for ( unsigned int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++ )
+			{
+				positions[ axis ][ bodyIndex ] += ( positionSums[ axis ][ bodyIndex ] + stageVelocities[ axis ][ bodyIndex ] ) * sixthDeltaSeconds;
+				velocities[ axis ][ bodyIndex ] += ( velocitySums[ axis ][ bodyIndex ] + accelerations[ axis ][ bodyIndex ] ) * sixthDeltaSeconds;
+			}
+		}
+		break;
+	}
+
+	default:
+		ERROR_RECOVERABLE( "DynamicsBatch::Step given an unknown integrator!" );
+		break;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void AddBenchmarkForces( DynamicsBatch* batch, LinearDynamicsState* state )
+{
+	//The four forces with batch kernels, as a particle effect might stack them.
+	Force* forces[] = {
+		new GravityForce(),
+		new DebrisForce( 9.81f, 0.f ),
+		new ConstantWindForce( 2.f, Vector3f( 1.f, 0.f, 0.f ), .1f ),
+		new WormholeForce( Vector3f::ZERO, .05f, Vector3f::ZERO, .1f )
+	};
+
+	for ( Force* force : forces )
+	{
+		if ( batch != nullptr )
+			batch->AddForce( force->GetCopy() );
+		if ( state != nullptr )
+			state->AddForce( force->GetCopy() );
+		delete force;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void DynamicsBatch::RunBenchmark( Command& args )
+{
+	int numBodies;
+	args.GetNextInt( &numBodies, 100000 );
+	int numSteps;
+	args.GetNextInt( &numSteps, 10 );
+	if ( ( numBodies <= 0 ) || ( numSteps <= 0 ) )
+	{
+		g_theConsole->Printf( "Usage: DynamicsBenchmark [numBodies = 100000] [numSteps = 10]" );
+		return;
+	}
+
+	const float deltaSeconds = 1.f / 60.f;
+	std::vector< LinearDynamicsState* > states;
+	states.reserve( numBodies );
+	DynamicsBatch batch;
+	batch.Reserve( numBodies );
+	AddBenchmarkForces( &batch, nullptr );
+	for ( int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++ )
+	{
+		Vector3f position( GetRandomFloatInRange( -50.f, 50.f ), GetRandomFloatInRange( -50.f, 50.f ), GetRandomFloatInRange( 0.f, 20.f ) );
+		Vector3f velocity( GetRandomFloatInRange( -5.f, 5.f ), GetRandomFloatInRange( -5.f, 5.f ), GetRandomFloatInRange( 0.f, 10.f ) );
+		float mass = GetRandomFloatInRange( .5f, 2.f );
+
+		states.push_back( new LinearDynamicsState( position, velocity ) );
+		AddBenchmarkForces( nullptr, states.back() );
+		batch.AddBody( position, velocity, mass );
+	}
+
+	//Same starting state and integrator on both paths, so their results should agree to float rounding.
+	double startSeconds = GetCurrentTimeSeconds();
+	for ( int step = 0; step < numSteps; step++ )
+		for ( int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++ )
+			states[ bodyIndex ]->StepWithForwardEuler( batch.GetMass( bodyIndex ), deltaSeconds );
+	double perObjectSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	startSeconds = GetCurrentTimeSeconds();
+	for ( int step = 0; step < numSteps; step++ )
+		batch.Step( deltaSeconds, DYNAMICS_INTEGRATOR_EXPLICIT_EULER, false );
+	double batchSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	float maxPositionError = 0.f;
+	for ( int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++ )
+		maxPositionError = GetMax( maxPositionError, ( states[ bodyIndex ]->GetPosition() - batch.GetPosition( bodyIndex ) ).CalcFloatLength() );
+
+	const double toMsPerStep = 1000.0 / numSteps;
+	g_theConsole->Printf( "DynamicsBenchmark: %d bodies, %d forces, %d steps (ms per step):", numBodies, (int)batch.GetNumForces(), numSteps );
+	g_theConsole->Printf( "  Explicit Euler, per object: %.3f", perObjectSeconds * toMsPerStep );
+	g_theConsole->Printf( "  Explicit Euler, batch: %.3f (%.1fx faster), max position difference %g", batchSeconds * toMsPerStep, perObjectSeconds / batchSeconds, maxPositionError );
+
+	startSeconds = GetCurrentTimeSeconds();
+	for ( int step = 0; step < numSteps; step++ )
+		for ( int bodyIndex = 0; bodyIndex < numBodies; bodyIndex++ )
+			states[ bodyIndex ]->StepWithVerlet( batch.GetMass( bodyIndex ), deltaSeconds );
+	perObjectSeconds = GetCurrentTimeSeconds() - startSeconds;
+	g_theConsole->Printf( "  Verlet, per object: %.3f", perObjectSeconds * toMsPerStep );
+
+	const char* integratorNames[ NUM_DYNAMICS_INTEGRATORS ] = { "Explicit Euler", "Semi-implicit Euler", "Verlet", "RK4" };
+	for ( int integrator = 0; integrator < NUM_DYNAMICS_INTEGRATORS; integrator++ )
+	{
+		for ( int useJobSystem = 0; useJobSystem < 2; useJobSystem++ )
+		{
+			startSeconds = GetCurrentTimeSeconds();
+			for ( int step = 0; step < numSteps; step++ )
+				batch.Step( deltaSeconds, (DynamicsIntegrator)integrator, useJobSystem != 0 );
+			batchSeconds = GetCurrentTimeSeconds() - startSeconds;
+			g_theConsole->Printf( "  %s, batch%s: %.3f", integratorNames[ integrator ], useJobSystem ? " + jobs" : "", batchSeconds * toMsPerStep );
+		}
+	}
+
+	for ( LinearDynamicsState* state : states )
+		delete state;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+
+#include <vector>
+#include "Engine/EngineCommon.hpp"
+
+
+//-----------------------------------------------------------------------------
+class Force;
+class Command;
+struct Job;
+
+
+//-----------------------------------------------------------------------------
+enum DynamicsIntegrator
+{
+	DYNAMICS_INTEGRATOR_EXPLICIT_EULER, //LinearDynamicsState::StepWithForwardEuler's.
+	DYNAMICS_INTEGRATOR_SEMI_IMPLICIT_EULER, //Velocity first, then position by the new velocity: as cheap, but doesn't gain energy on springs and orbits.
+	DYNAMICS_INTEGRATOR_VERLET, //LinearDynamicsState::StepWithVerlet's, each body with its own previous acceleration.
+	DYNAMICS_INTEGRATOR_RK4, //Four force evaluations per step, for when accuracy beats cost.
+	NUM_DYNAMICS_INTEGRATORS
+};
+
+
+//-----------------------------------------------------------------------------
+struct DynamicsBatchSpan //A run of a DynamicsBatch's bodies, as the arrays Force::AccumulateBatchForces reads and adds to. Index [ 0..2 ] is the axis.
+{
+	unsigned int m_numBodies; //Padded to a multiple of DynamicsBatch::SIMD_WIDTH, so kernels never need a scalar tail.
+	const float* m_positions[ 3 ];
+	const float* m_velocities[ 3 ];
+	const float* m_masses;
+	float* m_netForces[ 3 ];
+};
+
+
+//-----------------------------------------------------------------------------
+//Bodies sharing one set of forces, each state component in its own array (structure of arrays) instead of a LinearDynamicsState apiece.
+//Each force then makes one virtual call per step to run a SIMD kernel over every body, instead of one per body, and Step splits
+//the bodies across the JobSystem, which the per-object path's shared state never allowed.
+class DynamicsBatch
+{
+public:
+	static const unsigned int SIMD_WIDTH = 4; //Bodies per SSE register.
+
+	DynamicsBatch() : m_numBodies( 0 ) {}
+	~DynamicsBatch(); //Deletes its forces, like LinearDynamicsState.
+
+	unsigned int AddBody( const Vector3f& position, const Vector3f& velocity, float mass ); //Returns its index.
+	void RemoveBody( unsigned int bodyIndex ); //The last body moves into bodyIndex.
+	void ClearBodies() { m_numBodies = 0; ResizeArrays( 0 ); }
+	void Reserve( unsigned int numBodies );
+	unsigned int GetNumBodies() const { return m_numBodies; }
+
+	Vector3f GetPosition( unsigned int bodyIndex ) const { return Vector3f( m_positions[ 0 ][ bodyIndex ], m_positions[ 1 ][ bodyIndex ], m_positions[ 2 ][ bodyIndex ] ); }
+	Vector3f GetVelocity( unsigned int bodyIndex ) const { return Vector3f( m_velocities[ 0 ][ bodyIndex ], m_velocities[ 1 ][ bodyIndex ], m_velocities[ 2 ][ bodyIndex ] ); }
+	float GetMass( unsigned int bodyIndex ) const { return m_masses[ bodyIndex ]; }
+	void SetPosition( unsigned int bodyIndex, const Vector3f& newPos );
+	void SetVelocity( unsigned int bodyIndex, const Vector3f& newVel );
+	void SetMass( unsigned int bodyIndex, float newMass ) { m_masses[ bodyIndex ] = newMass; }
+	float* GetPositions( unsigned int axis ) { return m_positions[ axis ].data(); } //For solvers that move bodies directly between Steps, e.g. Cloth's constraints.
+	float* GetVelocities( unsigned int axis ) { return m_velocities[ axis ].data(); }
+
+	void AddForce( Force* newForce ) { m_forces.push_back( newForce ); } //Acts on every body. Takes ownership.
+	size_t GetNumForces() const { return m_forces.size(); }
+	void ClearForces( bool keepGravity = false );
+
+	void Step( float deltaSeconds, DynamicsIntegrator integrator, bool useJobSystem = true );
+
+	static void RunBenchmark( Command& args ); //DynamicsBenchmark [numBodies] [numSteps]: times this against a LinearDynamicsState per body.
+
+
+private:
+	static void StepRangeJob( Job* job );
+	void StepRange( unsigned int firstBody, unsigned int numBodies, float deltaSeconds, DynamicsIntegrator integrator );
+	void CalcAccelerations( unsigned int firstBody, unsigned int numBodies, float* const positions[ 3 ], float* const velocities[ 3 ], float* const out_accelerations[ 3 ] ) const;
+	void ResizeArrays( unsigned int numPaddedBodies );
+
+	unsigned int m_numBodies;
+	std::vector< float > m_positions[ 3 ]; //Every array is padded to a multiple of SIMD_WIDTH with resting bodies of mass 1.
+	std::vector< float > m_velocities[ 3 ];
+	std::vector< float > m_masses;
+	std::vector< float > m_previousAccelerations[ 3 ]; //Verlet's.
+	std::vector< float > m_accelerations[ 3 ]; //Scratch from here down, rewritten every Step.
+	std::vector< float > m_stagePositions[ 3 ]; //RK4's midpoint and endpoint states.
+	std::vector< float > m_stageVelocities[ 3 ];
+	std::vector< float > m_positionDerivativeSums[ 3 ]; //RK4's weighted k1 + 2k2 + 2k3 + k4.
+	std::vector< float > m_velocityDerivativeSums[ 3 ];
+	std::vector< Force* > m_forces;
+	std::vector< Job* > m_stepJobs; //Step's in-flight jobs, kept to reuse the storage.
+};
@@ -1,8 +1,16 @@
 #include "Engine/Physics/EphanovParticleSystem.hpp"
 #include "Engine/Audio/TheAudio.hpp"
 #include "Engine/Renderer/TheRenderer.hpp"
-#include "Engine/Physics/PhysicsUtils.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Renderer/MeshRenderer.hpp"
+#include "Engine/Physics/Forces.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include "Engine/Memory/Memory.hpp"
+#include "Engine/Core/Command.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Time/Time.hpp"
+#include <algorithm>
+#include <functional>
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -10,6 +18,42 @@ STATIC const Vector3f EphanovParticleSystem::MAX_EphanovParticle_OFFSET_FROM_EMI
 STATIC SoundID EphanovParticleSystem::s_emitSoundID = 0;
 
 
+//--------------------------------------------------------------------------------------------------------------
+//Corners 0-3 go counter-clockwise around the bottom from mins, 4-7 the same above them. Counter-clockwise from outside, for backface culling.
+static const unsigned int NUM_AABB3_VERTICES = 8;
+static const unsigned int AABB3_INDICES[] =
+{
+	0, 2, 1,	0, 3, 2, //Bottom.
+	4, 5, 6,	4, 6, 7, //Top.
+	0, 1, 5,	0, 5, 4, //Front.
+	2, 3, 7,	2, 7, 6, //Back.
+	3, 0, 4,	3, 4, 7, //Left.
+	1, 2, 6,	1, 6, 5  //Right.
+};
+
+//An octahedron: the cheapest closed shape that still reads as round at particle sizes. +x, -x, +y, -y, +z, -z.
+static const unsigned int NUM_SPHERE_VERTICES = 6;
+static const unsigned int SPHERE_INDICES[] =
+{
+	0, 2, 4,	2, 1, 4,	1, 3, 4,	3, 0, 4,
+	2, 0, 5,	1, 2, 5,	3, 1, 5,	0, 3, 5
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+static unsigned int GetNumVerticesPerEphanovParticle( EphanovParticleType particleType )
+{
+	return ( particleType == EphanovParticle_SPHERE ) ? NUM_SPHERE_VERTICES : NUM_AABB3_VERTICES;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static unsigned int GetNumIndicesPerEphanovParticle( EphanovParticleType particleType )
+{
+	return static_cast<unsigned int>( ( particleType == EphanovParticle_SPHERE ) ? _countof( SPHERE_INDICES ) : _countof( AABB3_INDICES ) );
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 EphanovParticleSystem::EphanovParticleSystem( const Vector3f& emitterPosition, EphanovParticleType EphanovParticleType, float EphanovParticleRadius, float EphanovParticleMass,
 				float muzzleSpeed, float maxDegreesDownFromWorldUp, float minDegreesDownFromWorldUp, float maxDegreesLeftFromWorldNorth, float minDegreesLeftFromWorldNorth,
@@ -20,15 +64,25 @@ EphanovParticleSystem::EphanovParticleSystem( const Vector3f& emitterPosition, E
 	, m_minDegreesDownFromWorldUp( minDegreesDownFromWorldUp )
 	, m_maxDegreesLeftFromWorldNorth( maxDegreesLeftFromWorldNorth )
 	, m_minDegreesLeftFromWorldNorth( minDegreesLeftFromWorldNorth )
-	, m_EphanovParticleToEmit( EphanovParticleType, EphanovParticleMass, secondsBeforeEphanovParticlesExpire, EphanovParticleRadius )
+	, m_EphanovParticleType( EphanovParticleType )
+	, m_EphanovParticleRadius( EphanovParticleRadius )
+	, m_EphanovParticleMass( EphanovParticleMass )
 	, m_secondsBetweenEmits( secondsBetweenEmits )
 	, m_secondsBeforeEphanovParticlesExpire( secondsBeforeEphanovParticlesExpire )
 	, m_maxEphanovParticlesEmitted( maxEphanovParticlesEmitted )
 	, m_EphanovParticlesEmittedAtOnce( EphanovParticlesEmittedAtOnce )
 	, m_secondsPassedSinceLastEmit( 0.f )
+	, m_playsEmitSound( true )
+	, m_meshRenderer( nullptr )
 {
 	GUARANTEE_OR_DIE( m_EphanovParticlesEmittedAtOnce <= m_maxEphanovParticlesEmitted, "Error in EphanovParticleSystem ctor, amount to emit at once exceeds max amount to emit." ); //Else infinite loop in EmitEphanovParticles().
-	m_EphanovParticleToEmit.SetEphanovParticleState( new LinearDynamicsState( emitterPosition, Vector3f::ZERO ) ); //So we can add forces to it prior to emission if requested.
+
+	//Everything a full pool needs, now, so emitting never has to grow anything.
+	m_liveEphanovParticles.Reserve( m_maxEphanovParticlesEmitted );
+	m_secondsAlive.resize( m_maxEphanovParticlesEmitted, 0.f );
+	m_scratchSecondsAlive.resize( m_maxEphanovParticlesEmitted );
+	m_meshVertices.resize( m_maxEphanovParticlesEmitted * GetNumVerticesPerEphanovParticle( m_EphanovParticleType ), Vertex3D_PCT( Vector3f::ZERO, Rgba::WHITE ) );
+
 	EphanovParticleSystem::s_emitSoundID = g_theAudio->CreateOrGetSound( "Data/Audio/Explo_EnergyFireball01.wav" );
 }
 
@@ -36,36 +90,88 @@ EphanovParticleSystem::EphanovParticleSystem( const Vector3f& emitterPosition, E
 //--------------------------------------------------------------------------------------------------------------
 EphanovParticleSystem::~EphanovParticleSystem()
 {
-	for ( unsigned int EphanovParticleIndex = 0; EphanovParticleIndex < m_unexpiredEphanovParticles.size(); EphanovParticleIndex++ )
-	{
-		EphanovParticle* currentEphanovParticle = m_unexpiredEphanovParticles[ EphanovParticleIndex ];
-		if ( currentEphanovParticle != nullptr )
-		{
-			delete currentEphanovParticle;
-			currentEphanovParticle = nullptr;
-		}
-	}
+	if ( m_meshRenderer != nullptr )
+		delete m_meshRenderer;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void EphanovParticleSystem::CreateMesh()
+{
+	//Live particles are always the pool's first n, so the first n particles' worth of this never changes.
+	const unsigned int* particleIndices = ( m_EphanovParticleType == EphanovParticle_SPHERE ) ? SPHERE_INDICES : AABB3_INDICES;
+	unsigned int numVerticesPerParticle = GetNumVerticesPerEphanovParticle( m_EphanovParticleType );
+	unsigned int numIndicesPerParticle = GetNumIndicesPerEphanovParticle( m_EphanovParticleType );
+
+	std::vector< unsigned int > indices;
+	indices.reserve( m_maxEphanovParticlesEmitted * numIndicesPerParticle );
+	for ( unsigned int particleIndex = 0; particleIndex < m_maxEphanovParticlesEmitted; particleIndex++ )
+		for ( unsigned int index = 0; index < numIndicesPerParticle; index++ )
+			indices.push_back( ( particleIndex * numVerticesPerParticle ) + particleIndices[ index ] );
+
+	DrawInstruction drawInstructions[] = { DrawInstruction( VertexGroupingRule::AS_TRIANGLES, 0, 0, true ) };
+	m_mesh = std::shared_ptr<Mesh>( new Mesh( BufferUsage::STREAM_DRAW, Vertex3D_PCT::DEFINITION, m_meshVertices.size(), m_meshVertices.data(), indices.size(), indices.data(), 1, drawInstructions ) );
+	m_meshRenderer = new MeshRenderer( m_mesh, TheRenderer::s_defaultMaterial3D );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-void EphanovParticleSystem::RenderThenExpireEphanovParticles()
+void EphanovParticleSystem::WriteEphanovParticleVertices( unsigned int particleIndex, Vertex3D_PCT* out_vertices ) const
 {
-	for ( auto EphanovParticleIter = m_unexpiredEphanovParticles.begin(); EphanovParticleIter != m_unexpiredEphanovParticles.end(); )
+	Vector3f particlePos = m_liveEphanovParticles.GetPosition( particleIndex );
+	float radius = m_EphanovParticleRadius;
+
+	switch ( m_EphanovParticleType )
 	{
-		EphanovParticle* currentEphanovParticle = *EphanovParticleIter;
-		currentEphanovParticle->Render();
-		if ( currentEphanovParticle->IsExpired() )
-		{
-			delete currentEphanovParticle;
-			currentEphanovParticle = nullptr;
-			EphanovParticleIter = m_unexpiredEphanovParticles.erase( EphanovParticleIter );
-		}
-		else ++EphanovParticleIter;
+	case EphanovParticle_SPHERE:
+		out_vertices[ 0 ] = Vertex3D_PCT( Vector3f( particlePos.x + radius, particlePos.y, particlePos.z ), Rgba::WHITE );
+		out_vertices[ 1 ] = Vertex3D_PCT( Vector3f( particlePos.x - radius, particlePos.y, particlePos.z ), Rgba::WHITE );
+		out_vertices[ 2 ] = Vertex3D_PCT( Vector3f( particlePos.x, particlePos.y + radius, particlePos.z ), Rgba::WHITE );
+		out_vertices[ 3 ] = Vertex3D_PCT( Vector3f( particlePos.x, particlePos.y - radius, particlePos.z ), Rgba::WHITE );
+		out_vertices[ 4 ] = Vertex3D_PCT( Vector3f( particlePos.x, particlePos.y, particlePos.z + radius ), Rgba::WHITE );
+		out_vertices[ 5 ] = Vertex3D_PCT( Vector3f( particlePos.x, particlePos.y, particlePos.z - radius ), Rgba::WHITE );
+		break;
+	case EphanovParticle_AABB3:
+		//Same corner colors DrawShadedAABB was called with per particle.
+		Vector3f mins = particlePos - Vector3f( radius );
+		Vector3f maxs = particlePos + Vector3f( radius );
+		out_vertices[ 0 ] = Vertex3D_PCT( Vector3f( mins.x, mins.y, mins.z ), Rgba::BLACK );
+		out_vertices[ 1 ] = Vertex3D_PCT( Vector3f( maxs.x, mins.y, mins.z ), Rgba::RED );
+		out_vertices[ 2 ] = Vertex3D_PCT( Vector3f( maxs.x, maxs.y, mins.z ), Rgba::WHITE );
+		out_vertices[ 3 ] = Vertex3D_PCT( Vector3f( mins.x, maxs.y, mins.z ), Rgba::GREEN );
+		out_vertices[ 4 ] = Vertex3D_PCT( Vector3f( mins.x, mins.y, maxs.z ), Rgba::BLACK );
+		out_vertices[ 5 ] = Vertex3D_PCT( Vector3f( maxs.x, mins.y, maxs.z ), Rgba::RED );
+		out_vertices[ 6 ] = Vertex3D_PCT( Vector3f( maxs.x, maxs.y, maxs.z ), Rgba::WHITE );
+		out_vertices[ 7 ] = Vertex3D_PCT( Vector3f( mins.x, maxs.y, maxs.z ), Rgba::GREEN );
+		break;
+		//FUTURE IDEAS TODO: add more render types!
 	}
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void EphanovParticleSystem::RenderEphanovParticles()
+{
+	unsigned int numLiveParticles = GetNumLiveEphanovParticles();
+	if ( numLiveParticles == 0 )
+		return;
+
+	if ( m_mesh == nullptr )
+		CreateMesh();
+
+	unsigned int numVerticesPerParticle = GetNumVerticesPerEphanovParticle( m_EphanovParticleType );
+	for ( unsigned int particleIndex = 0; particleIndex < numLiveParticles; particleIndex++ )
+		WriteEphanovParticleVertices( particleIndex, &m_meshVertices[ particleIndex * numVerticesPerParticle ] );
+
+	m_mesh->ClearDrawInstructions();
+	m_mesh->AddDrawInstruction( VertexGroupingRule::AS_TRIANGLES, 0, numLiveParticles * GetNumIndicesPerEphanovParticle( m_EphanovParticleType ), true );
+	m_mesh->SetThenUpdateMeshBuffers( numLiveParticles * numVerticesPerParticle, m_meshVertices.data() ); //Keeps the full pool's IBO.
+
+	g_theRenderer->UnbindTexture(); //Vertex colors only, as DrawShadedAABB did.
+	m_meshRenderer->Render();
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 void EphanovParticleSystem::UpdateEphanovParticles( float deltaSeconds )
 {
@@ -77,9 +183,62 @@ void EphanovParticleSystem::UpdateEphanovParticles( float deltaSeconds )
 //--------------------------------------------------------------------------------------------------------------
 void EphanovParticleSystem::StepAndAgeEphanovParticles( float deltaSeconds )
 {
-	for ( unsigned int EphanovParticleIndex = 0; EphanovParticleIndex < m_unexpiredEphanovParticles.size(); EphanovParticleIndex++ )
+	m_liveEphanovParticles.Step( deltaSeconds, DYNAMICS_INTEGRATOR_VERLET );
+
+	if ( m_secondsBeforeEphanovParticlesExpire <= 0.f )
+		return;
+
+	for ( unsigned int particleIndex = 0; particleIndex < GetNumLiveEphanovParticles(); )
+	{
+		m_secondsAlive[ particleIndex ] += deltaSeconds;
+		if ( m_secondsAlive[ particleIndex ] >= m_secondsBeforeEphanovParticlesExpire )
+			KillEphanovParticle( particleIndex ); //Don't advance: the last particle, not yet aged this step, now sits here.
+		else
+			++particleIndex;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void EphanovParticleSystem::KillEphanovParticle( unsigned int particleIndex )
+{
+	m_secondsAlive[ particleIndex ] = m_secondsAlive[ GetNumLiveEphanovParticles() - 1 ];
+	m_liveEphanovParticles.RemoveBody( particleIndex ); //Swaps the last body in the same way.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void EphanovParticleSystem::KillOldestEphanovParticles( unsigned int numToKill )
+{
+	//Swapping loses emission order, so finding the oldest takes passes over the pool--but once per emit into a full pool, not per particle.
+	unsigned int numLiveParticles = GetNumLiveEphanovParticles();
+	numToKill = GetMin( numToKill, numLiveParticles );
+	if ( numToKill == 0 )
+		return;
+
+	std::copy( m_secondsAlive.begin(), m_secondsAlive.begin() + numLiveParticles, m_scratchSecondsAlive.begin() );
+	std::nth_element( m_scratchSecondsAlive.begin(), m_scratchSecondsAlive.begin() + ( numToKill - 1 ), m_scratchSecondsAlive.begin() + numLiveParticles, std::greater<float>() );
+	float youngestAgeKilled = m_scratchSecondsAlive[ numToKill - 1 ];
+
+	//Everything older first, then ties with the youngest killed until there's room.
+	unsigned int numKilled = 0;
+	for ( unsigned int particleIndex = 0; particleIndex < GetNumLiveEphanovParticles(); )
+	{
+		if ( m_secondsAlive[ particleIndex ] > youngestAgeKilled )
+		{
+			KillEphanovParticle( particleIndex );
+			++numKilled;
+		}
+		else ++particleIndex;
+	}
+	for ( unsigned int particleIndex = 0; ( particleIndex < GetNumLiveEphanovParticles() ) && ( numKilled < numToKill ); )
 	{
-		m_unexpiredEphanovParticles[ EphanovParticleIndex ]->StepAndAge( deltaSeconds );
+		if ( m_secondsAlive[ particleIndex ] == youngestAgeKilled )
+		{
+			KillEphanovParticle( particleIndex );
+			++numKilled;
+		}
+		else ++particleIndex;
 	}
 }
 
@@ -91,20 +250,13 @@ void EphanovParticleSystem::EmitEphanovParticles( float deltaSeconds )
 	{
 		m_secondsPassedSinceLastEmit = 0.f;
 
-		//Prep for emit by erasing oldest EphanovParticles to make enough room.
-		unsigned int amountUnexpiredEphanovParticles = m_unexpiredEphanovParticles.size();
-
-		while ( amountUnexpiredEphanovParticles + m_EphanovParticlesEmittedAtOnce > m_maxEphanovParticlesEmitted )
-		{
-			//Remove earliest objects pushed--means removing from the front of a structure walked per-frame with items potentially being removed at its middle due their expiration. Any choice seems slow.
-			m_unexpiredEphanovParticles.erase( m_unexpiredEphanovParticles.begin() );
-			amountUnexpiredEphanovParticles = m_unexpiredEphanovParticles.size();
-		}
+		//Prep for emit by killing oldest EphanovParticles to make enough room.
+		if ( GetNumLiveEphanovParticles() + m_EphanovParticlesEmittedAtOnce > m_maxEphanovParticlesEmitted )
+			KillOldestEphanovParticles( GetNumLiveEphanovParticles() + m_EphanovParticlesEmittedAtOnce - m_maxEphanovParticlesEmitted );
 
 		//Actual emit.
 		for ( unsigned int iterationNum = 0; iterationNum < m_EphanovParticlesEmittedAtOnce; iterationNum++ )
 		{
-			EphanovParticle* newEphanovParticle = new EphanovParticle( m_EphanovParticleToEmit );
 			Vector3f newEphanovParticlePosition = m_emitterPosition; //Below offset to position allows us not to just have EphanovParticles emitting outward in "bands".
 			newEphanovParticlePosition.x += MAX_EphanovParticle_OFFSET_FROM_EMITTER.x * GetRandomFloatInRange( -1.f, 1.f );
 			newEphanovParticlePosition.y += MAX_EphanovParticle_OFFSET_FROM_EMITTER.y * GetRandomFloatInRange( -1.f, 1.f );
@@ -122,12 +274,72 @@ void EphanovParticleSystem::EmitEphanovParticles( float deltaSeconds )
 			muzzleVelocity.z = m_muzzleSpeed
 				* CosDegrees( ( spanDegreesDownFromWorldUp		* GetRandomFloatZeroTo( 1.0f ) ) + m_minDegreesDownFromWorldUp ); //Embeds assumption z is world-up? Would it work if using y-up, just rotated by 90deg?
 
-			newEphanovParticle->SetEphanovParticleState( new LinearDynamicsState( newEphanovParticlePosition, muzzleVelocity ) );
-			newEphanovParticle->CloneForcesFromEphanovParticle( &m_EphanovParticleToEmit );
-			m_unexpiredEphanovParticles.push_back( newEphanovParticle );
+			unsigned int particleIndex = m_liveEphanovParticles.AddBody( newEphanovParticlePosition, muzzleVelocity, m_EphanovParticleMass );
+			m_secondsAlive[ particleIndex ] = 0.f;
 		}
 
-		g_theAudio->PlaySound( s_emitSoundID );
+		if ( m_playsEmitSound )
+			g_theAudio->PlaySound( s_emitSoundID );
 	}
 	else m_secondsPassedSinceLastEmit += deltaSeconds;
 }
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void EphanovParticleSystem::RunBenchmark( Command& args )
+{
+	int maxParticles;
+	args.GetNextInt( &maxParticles, 10000 );
+	int numFrames;
+	args.GetNextInt( &numFrames, 300 );
+	if ( ( maxParticles < 100 ) || ( numFrames <= 0 ) )
+	{
+		g_theConsole->Printf( "Usage: EphanovParticleBenchmark [maxParticles = 10000, at least 100] [numFrames = 300]" );
+		return;
+	}
+
+	//A fountain emitting every frame, fast enough to fill the pool before its particles expire, so both ways of dying run.
+	const float deltaSeconds = 1.f / 60.f;
+	const float secondsToLive = 2.f;
+	EphanovParticleSystem fountain( Vector3f::ZERO, EphanovParticle_AABB3, .05f, 1.f, 10.f, 30.f, 0.f, 360.f, 0.f,
+									0.f, secondsToLive, maxParticles, maxParticles / 100 );
+	fountain.SetPlaysEmitSound( false ); //Audio's allocations aren't the pool's.
+	fountain.AddForce( new GravityForce() );
+
+	//Warm up past one lifetime: the pool fills, and the mesh and the batch's scratch reach full size.
+	for ( int frame = 0; frame < static_cast<int>( secondsToLive / deltaSeconds ) + 1; frame++ )
+	{
+		fountain.UpdateEphanovParticles( deltaSeconds );
+		fountain.RenderEphanovParticles();
+	}
+
+	//Counted on this thread only: other threads' allocations (audio, IO, other jobs) would otherwise land in our totals.
+	//Step's jobs only run StepRange's arithmetic, so everything the emitter could allocate happens here.
+	unsigned int updateAllocations = 0;
+	unsigned int renderAllocations = 0;
+	unsigned int processAllocations = 0;
+	double updateSeconds = 0.0;
+	double renderSeconds = 0.0;
+	for ( int frame = 0; frame < numFrames; frame++ )
+	{
+		unsigned int processAllocationsBefore = MemoryAnalytics::GetLifetimeNumAllocationCalls();
+		unsigned int allocationsBefore = MemoryAnalytics::GetThreadLifetimeNumAllocationCalls();
+		double startSeconds = GetCurrentTimeSeconds();
+		fountain.UpdateEphanovParticles( deltaSeconds );
+		double updatedSeconds = GetCurrentTimeSeconds();
+		unsigned int allocationsUpdated = MemoryAnalytics::GetThreadLifetimeNumAllocationCalls();
+		fountain.RenderEphanovParticles();
+		renderSeconds += GetCurrentTimeSeconds() - updatedSeconds;
+		updateSeconds += updatedSeconds - startSeconds;
+		renderAllocations += MemoryAnalytics::GetThreadLifetimeNumAllocationCalls() - allocationsUpdated;
+		updateAllocations += allocationsUpdated - allocationsBefore;
+		processAllocations += MemoryAnalytics::GetLifetimeNumAllocationCalls() - processAllocationsBefore;
+	}
+
+	const double toMsPerFrame = 1000.0 / numFrames;
+	g_theConsole->Printf( "EphanovParticleBenchmark: %u of %d particles live, %d steady-state frames:", fountain.GetNumLiveEphanovParticles(), maxParticles, numFrames );
+	g_theConsole->Printf( "  Update: %.3f ms per frame, %u allocations", updateSeconds * toMsPerFrame, updateAllocations );
+	g_theConsole->Printf( "  Render: %.3f ms per frame, %u allocations", renderSeconds * toMsPerFrame, renderAllocations );
+	g_theConsole->Printf( "  (%u allocations process-wide over the same frames, from any thread)", processAllocations );
+	g_theConsole->Printf( "  %s", ( ( updateAllocations + renderAllocations ) == 0 ) ? "PASS: allocation-free" : "FAIL: steady state still allocates" );
+}
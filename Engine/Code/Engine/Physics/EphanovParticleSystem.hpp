@@ -1,15 +1,24 @@
 #pragma once
 
 
+#include <memory>
 #include "Engine/EngineCommon.hpp"
 #include "Engine/Physics/EphanovParticle.hpp"
+#include "Engine/Physics/DynamicsBatch.hpp"
+#include "Engine/Renderer/Vertexes.hpp"
 
 
 //-----------------------------------------------------------------------------
+class Command;
 class Force;
+class Mesh;
+class MeshRenderer;
 
 
 //-----------------------------------------------------------------------------
+//Live particles are a fixed-capacity pool: the first GetNumLiveEphanovParticles() bodies of a DynamicsBatch, plus their ages alongside.
+//Dying swaps the last live particle into the dead one's slot, so neither emitting nor expiring moves the rest or touches the heap,
+//and one persistent mesh draws them all in a single call.
 class EphanovParticleSystem
 {
 public:
@@ -19,19 +28,25 @@ public:
 					float secondsBetweenEmits, float secondsBeforeEphanovParticlesExpire, unsigned int maxEphanovParticlesEmitted, unsigned int EphanovParticlesEmittedAtOnce );
 	~EphanovParticleSystem();
 
-	void RenderThenExpireEphanovParticles();
-	void UpdateEphanovParticles( float deltaSeconds );
-	void AddForce( Force* newForce ) {
-		m_EphanovParticleToEmit.AddForce( newForce );
-	}
+	void RenderEphanovParticles(); //One draw for the whole system.
+	void UpdateEphanovParticles( float deltaSeconds ); //Simulates, expires, then emits.
+	void AddForce( Force* newForce ) { m_liveEphanovParticles.AddForce( newForce ); } //Acts on every particle, emitted or not. Takes ownership.
 	float GetSecondsUntilNextEmit() const {
 		return m_secondsBetweenEmits - m_secondsPassedSinceLastEmit;
 	}
+	unsigned int GetNumLiveEphanovParticles() const { return m_liveEphanovParticles.GetNumBodies(); }
+	void SetPlaysEmitSound( bool newVal ) { m_playsEmitSound = newVal; }
+
+	static void RunBenchmark( Command& args ); //EphanovParticleBenchmark [maxParticles] [numFrames]: allocations and time per steady-state frame.
 
 private:
 
 	void StepAndAgeEphanovParticles( float deltaSeconds );
 	void EmitEphanovParticles( float deltaSeconds ); //silently emits nothing if not yet time to emit.
+	void KillEphanovParticle( unsigned int particleIndex );
+	void KillOldestEphanovParticles( unsigned int numToKill );
+	void WriteEphanovParticleVertices( unsigned int particleIndex, Vertex3D_PCT* out_vertices ) const;
+	void CreateMesh();
 
 	float m_maxDegreesDownFromWorldUp; //"theta" in most spherical-to-Cartesian conversions.
 	float m_minDegreesDownFromWorldUp;
@@ -41,16 +56,26 @@ private:
 	float m_muzzleSpeed; //How fast EphanovParticles shoot out.
 	float m_secondsPassedSinceLastEmit;
 	float m_secondsBetweenEmits;
-	float m_secondsBeforeEphanovParticlesExpire;
-	unsigned int m_maxEphanovParticlesEmitted;
-	unsigned int m_EphanovParticlesEmittedAtOnce; //Destroys oldest one(s) on next emit until emitter can emit this amount. 
+	float m_secondsBeforeEphanovParticlesExpire; //0 or less never expires them, only the pool running out does.
+	unsigned int m_maxEphanovParticlesEmitted; //The pool's capacity.
+	unsigned int m_EphanovParticlesEmittedAtOnce; //Destroys oldest one(s) on next emit until emitter can emit this amount.
 										   //No angular velocity right now.
 										   //No ability to ignore parent velocity right now.
+	bool m_playsEmitSound;
 
 	Vector3f m_emitterPosition;
 
-	EphanovParticle m_EphanovParticleToEmit;
-	std::vector< EphanovParticle* > m_unexpiredEphanovParticles;
+	EphanovParticleType m_EphanovParticleType;
+	float m_EphanovParticleRadius;
+	float m_EphanovParticleMass;
+
+	DynamicsBatch m_liveEphanovParticles;
+	std::vector< float > m_secondsAlive; //Parallel to m_liveEphanovParticles' bodies, swapped along with them.
+	std::vector< float > m_scratchSecondsAlive; //For KillOldestEphanovParticles to partially sort.
+
+	std::vector< Vertex3D_PCT > m_meshVertices; //Sized for a full pool up front.
+	std::shared_ptr< Mesh > m_mesh; //Its index buffer covers a full pool, so frames only upload vertices and shorten the draw.
+	MeshRenderer* m_meshRenderer;
 
 	static const Vector3f MAX_EphanovParticle_OFFSET_FROM_EMITTER;
 	static SoundID s_emitSoundID;
@@ -1,6 +1,36 @@
 #include "Engine/Physics/Forces.hpp"
 #include "Engine/Physics/PhysicsUtils.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include "Engine/Physics/DynamicsBatch.hpp"
+#include <xmmintrin.h>
+
+
+//--------------------------------------------------------------------------------------------------------------
+//The batch kernels below run SIMD_WIDTH bodies per iteration, relying on DynamicsBatchSpan's counts being padded to a multiple of it.
+static_assert( DynamicsBatch::SIMD_WIDTH == 4, "Force batch kernels are written for SSE's 4 floats per register!" );
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline __m128 SelectFloats( __m128 mask, __m128 ifTrue, __m128 ifFalse ) //Per lane, like mask ? ifTrue : ifFalse.
+{
+	return _mm_or_ps( _mm_and_ps( mask, ifTrue ), _mm_andnot_ps( mask, ifFalse ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Force::AccumulateBatchForces( const DynamicsBatchSpan& span ) const
+{
+	//For forces without a kernel of their own: no faster than the per-object path, but keeps any Force usable in a DynamicsBatch.
+	for ( unsigned int bodyIndex = 0; bodyIndex < span.m_numBodies; bodyIndex++ )
+	{
+		LinearDynamicsState state( Vector3f( span.m_positions[ 0 ][ bodyIndex ], span.m_positions[ 1 ][ bodyIndex ], span.m_positions[ 2 ][ bodyIndex ] ),
+								   Vector3f( span.m_velocities[ 0 ][ bodyIndex ], span.m_velocities[ 1 ][ bodyIndex ], span.m_velocities[ 2 ][ bodyIndex ] ) );
+		Vector3f force = CalcForceForStateAndMass( &state, span.m_masses[ bodyIndex ] );
+		span.m_netForces[ 0 ][ bodyIndex ] += force.x;
+		span.m_netForces[ 1 ][ bodyIndex ] += force.y;
+		span.m_netForces[ 2 ][ bodyIndex ] += force.z;
+	}
+}
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -10,6 +40,24 @@ Vector3f GravityForce::CalcForceForStateAndMass( const LinearDynamicsState * lds
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void GravityForce::AccumulateBatchForces( const DynamicsBatchSpan& span ) const
+{
+	Vector3f accel = m_direction * m_magnitude;
+	const __m128 accelByAxis[ 3 ] = { _mm_set1_ps( accel.x ), _mm_set1_ps( accel.y ), _mm_set1_ps( accel.z ) };
+
+	for ( unsigned int bodyIndex = 0; bodyIndex < span.m_numBodies; bodyIndex += DynamicsBatch::SIMD_WIDTH )
+	{
+		__m128 masses = _mm_loadu_ps( span.m_masses + bodyIndex );
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			__m128 netForces = _mm_loadu_ps( span.m_netForces[ axis ] + bodyIndex );
+			_mm_storeu_ps( span.m_netForces[ axis ] + bodyIndex, _mm_add_ps( netForces, _mm_mul_ps( masses, accelByAxis[ axis ] ) ) );
+		}
+	}
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 Vector3f ConstantWindForce::CalcForceForStateAndMass( const LinearDynamicsState * lds, float /*mass*/ ) const
 {
@@ -20,6 +68,26 @@ Vector3f ConstantWindForce::CalcForceForStateAndMass( const LinearDynamicsState
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void ConstantWindForce::AccumulateBatchForces( const DynamicsBatchSpan& span ) const
+{
+	//-c*(v - w) as c*w - c*v, with c*w the same for every body.
+	Vector3f dampedWind = m_direction * ( m_magnitude * m_dampedness );
+	const __m128 dampedWindByAxis[ 3 ] = { _mm_set1_ps( dampedWind.x ), _mm_set1_ps( dampedWind.y ), _mm_set1_ps( dampedWind.z ) };
+	const __m128 negativeDampedness = _mm_set1_ps( -m_dampedness );
+
+	for ( unsigned int bodyIndex = 0; bodyIndex < span.m_numBodies; bodyIndex += DynamicsBatch::SIMD_WIDTH )
+	{
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			__m128 velocities = _mm_loadu_ps( span.m_velocities[ axis ] + bodyIndex );
+			__m128 force = _mm_add_ps( dampedWindByAxis[ axis ], _mm_mul_ps( negativeDampedness, velocities ) );
+			_mm_storeu_ps( span.m_netForces[ axis ] + bodyIndex, _mm_add_ps( _mm_loadu_ps( span.m_netForces[ axis ] + bodyIndex ), force ) );
+		}
+	}
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 float WormholeForce::CalcMagnitudeForState( const LinearDynamicsState * lds ) const
 {
@@ -44,6 +112,36 @@ Vector3f WormholeForce::CalcForceForStateAndMass( const LinearDynamicsState* lds
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void WormholeForce::AccumulateBatchForces( const DynamicsBatchSpan& span ) const
+{
+	//-c*(v - w) with w = ( center - p ) * magnitude * |p|, the same math as the per-object path above.
+	const __m128 centerByAxis[ 3 ] = { _mm_set1_ps( m_center.x ), _mm_set1_ps( m_center.y ), _mm_set1_ps( m_center.z ) };
+	const __m128 dampedMagnitude = _mm_set1_ps( m_magnitude * m_dampedness );
+	const __m128 negativeDampedness = _mm_set1_ps( -m_dampedness );
+
+	for ( unsigned int bodyIndex = 0; bodyIndex < span.m_numBodies; bodyIndex += DynamicsBatch::SIMD_WIDTH )
+	{
+		__m128 positions[ 3 ];
+		__m128 squaredDistance = _mm_setzero_ps();
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			positions[ axis ] = _mm_loadu_ps( span.m_positions[ axis ] + bodyIndex );
+			squaredDistance = _mm_add_ps( squaredDistance, _mm_mul_ps( positions[ axis ], positions[ axis ] ) );
+		}
+		__m128 windScale = _mm_mul_ps( dampedMagnitude, _mm_sqrt_ps( squaredDistance ) );
+
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			__m128 velocities = _mm_loadu_ps( span.m_velocities[ axis ] + bodyIndex );
+			__m128 dampedWind = _mm_mul_ps( windScale, _mm_sub_ps( centerByAxis[ axis ], positions[ axis ] ) );
+			__m128 force = _mm_add_ps( dampedWind, _mm_mul_ps( negativeDampedness, velocities ) );
+			_mm_storeu_ps( span.m_netForces[ axis ] + bodyIndex, _mm_add_ps( _mm_loadu_ps( span.m_netForces[ axis ] + bodyIndex ), force ) );
+		}
+	}
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 Vector3f SpringForce::CalcForceForStateAndMass( const LinearDynamicsState * lds, float /*mass*/ ) const
 {
@@ -54,6 +152,25 @@ Vector3f SpringForce::CalcForceForStateAndMass( const LinearDynamicsState * lds,
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void SpringForce::AccumulateBatchForces( const DynamicsBatchSpan& span ) const
+{
+	const __m128 negativeDampedness = _mm_set1_ps( -m_dampedness );
+	const __m128 negativeStiffness = _mm_set1_ps( -m_stiffness );
+
+	for ( unsigned int bodyIndex = 0; bodyIndex < span.m_numBodies; bodyIndex += DynamicsBatch::SIMD_WIDTH )
+	{
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			__m128 dampedVelocities = _mm_mul_ps( negativeDampedness, _mm_loadu_ps( span.m_velocities[ axis ] + bodyIndex ) );
+			__m128 stiffenedPositions = _mm_mul_ps( negativeStiffness, _mm_loadu_ps( span.m_positions[ axis ] + bodyIndex ) );
+			__m128 force = _mm_add_ps( dampedVelocities, stiffenedPositions );
+			_mm_storeu_ps( span.m_netForces[ axis ] + bodyIndex, _mm_add_ps( _mm_loadu_ps( span.m_netForces[ axis ] + bodyIndex ), force ) );
+		}
+	}
+}
+
+
 
 
 
@@ -64,6 +181,43 @@ Vector3f DebrisForce::CalcForceForStateAndMass( const LinearDynamicsState * lds,
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void DebrisForce::AccumulateBatchForces( const DynamicsBatchSpan& span ) const
+{
+	//CalcMagnitudeForState and CalcDirectionForState's branches, taken per lane with masks. The direction is only ever up or down,
+	//so it folds into the magnitude's sign: F = up * ( ( below ? 1 : -1 ) * magnitude * mass ).
+	const __m128 upByAxis[ 3 ] = { _mm_set1_ps( WORLD3D_UP.x ), _mm_set1_ps( WORLD3D_UP.y ), _mm_set1_ps( WORLD3D_UP.z ) };
+	const __m128 groundHeight = _mm_set1_ps( m_groundHeight );
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.f );
+	const __m128 belowGroundScale = _mm_set1_ps( -10.f );
+	const __m128 fallingScale = _mm_set1_ps( .65f );
+
+	for ( unsigned int bodyIndex = 0; bodyIndex < span.m_numBodies; bodyIndex += DynamicsBatch::SIMD_WIDTH )
+	{
+		__m128 heights = zero;
+		__m128 upwardSpeeds = zero;
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			heights = _mm_add_ps( heights, _mm_mul_ps( upByAxis[ axis ], _mm_loadu_ps( span.m_positions[ axis ] + bodyIndex ) ) );
+			upwardSpeeds = _mm_add_ps( upwardSpeeds, _mm_mul_ps( upByAxis[ axis ], _mm_loadu_ps( span.m_velocities[ axis ] + bodyIndex ) ) );
+		}
+
+		__m128 isBelowGround = _mm_cmplt_ps( heights, groundHeight );
+		__m128 isFalling = _mm_and_ps( _mm_cmpgt_ps( heights, groundHeight ), _mm_cmplt_ps( upwardSpeeds, zero ) );
+		__m128 scale = SelectFloats( isBelowGround, belowGroundScale, SelectFloats( isFalling, fallingScale, one ) );
+		__m128 direction = SelectFloats( isBelowGround, one, _mm_sub_ps( zero, one ) );
+		__m128 upwardForces = _mm_mul_ps( _mm_mul_ps( heights, scale ), _mm_mul_ps( direction, _mm_loadu_ps( span.m_masses + bodyIndex ) ) );
+
+		for ( unsigned int axis = 0; axis < 3; axis++ )
+		{
+			__m128 force = _mm_mul_ps( upByAxis[ axis ], upwardForces );
+			_mm_storeu_ps( span.m_netForces[ axis ] + bodyIndex, _mm_add_ps( _mm_loadu_ps( span.m_netForces[ axis ] + bodyIndex ), force ) );
+		}
+	}
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 float DebrisForce::CalcMagnitudeForState( const LinearDynamicsState * lds ) const
 {
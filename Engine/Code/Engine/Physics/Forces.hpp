@@ -6,6 +6,7 @@
 
 //-----------------------------------------------------------------------------
 class LinearDynamicsState;
+struct DynamicsBatchSpan;
 
 
 //-----------------------------------------------------------------------------
@@ -14,11 +15,23 @@ class Force
 public:
 
 	virtual Vector3f CalcForceForStateAndMass( const LinearDynamicsState* lds, float mass ) const = 0;
+	virtual void AccumulateBatchForces( const DynamicsBatchSpan& span ) const; //Adds to span's net forces for every body in it. Defaults to CalcForceForStateAndMass per body.
 	virtual Force* GetCopy() const = 0;
+	virtual bool ResetFrom( const Force& source ) = 0; //Copies source's parameters over this one's, without reallocating. False if source is another type.
 
 
 protected:
 
+	template< typename ForceType > static bool ResetFromSameType( ForceType* force, const Force& source )
+	{
+		const ForceType* sourceOfSameType = dynamic_cast<const ForceType*>( &source );
+		if ( sourceOfSameType == nullptr )
+			return false;
+
+		*force = *sourceOfSameType;
+		return true;
+	}
+
 	Force( float magnitude, const Vector3f& direction = Vector3f::ZERO )
 		: m_magnitude( magnitude )
 		, m_direction( direction )
@@ -46,7 +59,9 @@ struct GravityForce : public Force // m*g
 	}
 
 	Vector3f CalcForceForStateAndMass( const LinearDynamicsState* lds, float mass ) const override;
+	void AccumulateBatchForces( const DynamicsBatchSpan& span ) const override;
 	Force* GetCopy() const { return new GravityForce( *this ); }
+	bool ResetFrom( const Force& source ) override { return ResetFromSameType( this, source ); }
 };
 
 
@@ -67,7 +82,9 @@ struct DebrisForce : public Force //The real problem: can't directly drag down v
 	Vector3f CalcForceForStateAndMass( const LinearDynamicsState* lds, float mass ) const override;
 	float CalcMagnitudeForState( const LinearDynamicsState* lds ) const override; //Magnitude shrinks if you hit/sink below ground.
 	virtual Vector3f CalcDirectionForState( const LinearDynamicsState* lds ) const override; //Direction inverts if you hit/sink below ground.
+	void AccumulateBatchForces( const DynamicsBatchSpan& span ) const override;
 	Force* GetCopy() const { return new DebrisForce( *this ); }
+	bool ResetFrom( const Force& source ) override { return ResetFromSameType( this, source ); }
 };
 
 
@@ -83,7 +100,9 @@ struct ConstantWindForce : public Force // -c*(v - w)
 	float m_dampedness; //"c".
 
 	Vector3f CalcForceForStateAndMass( const LinearDynamicsState* lds, float mass ) const override;
+	void AccumulateBatchForces( const DynamicsBatchSpan& span ) const override;
 	Force* GetCopy() const { return new ConstantWindForce( *this ); }
+	bool ResetFrom( const Force& source ) override { return ResetFromSameType( this, source ); }
 };
 
 
@@ -104,7 +123,9 @@ struct WormholeForce : public Force // -c*(v - w(pos))
 	float CalcMagnitudeForState( const LinearDynamicsState* lds ) const override; //Further from origin you move == stronger the wind.
 	virtual Vector3f CalcDirectionForState( const LinearDynamicsState* lds ) const override; //Direction sends you back toward origin.
 	Vector3f CalcForceForStateAndMass( const LinearDynamicsState* lds, float mass ) const override;
+	void AccumulateBatchForces( const DynamicsBatchSpan& span ) const override;
 	Force* GetCopy() const { return new WormholeForce( *this );	}
+	bool ResetFrom( const Force& source ) override { return ResetFromSameType( this, source ); }
 };
 
 
@@ -122,5 +143,7 @@ struct SpringForce : public Force // -cv + -kx
 	float m_stiffness; //"k".
 
 	Vector3f CalcForceForStateAndMass( const LinearDynamicsState* lds, float mass ) const override;
+	void AccumulateBatchForces( const DynamicsBatchSpan& span ) const override;
 	Force* GetCopy() const { return new SpringForce( *this ); }
+	bool ResetFrom( const Force& source ) override { return ResetFromSameType( this, source ); }
 };
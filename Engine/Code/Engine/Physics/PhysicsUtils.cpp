@@ -35,13 +35,11 @@ void LinearDynamicsState::StepWithForwardEuler( float mass, float deltaSeconds )
 void LinearDynamicsState::StepWithVerlet( float mass, float deltaSeconds )
 {
 	//https://en.wikipedia.org/wiki/Verlet_integration#Velocity_Verlet - to do away with the x_(t-1) at t=0 problem.
-	static Vector3f prevAccel = 0.f;
-
 	LinearDynamicsState dState = dStateForMass( mass );
 
 	m_position += ( m_velocity*deltaSeconds ) + ( dState.m_velocity*.5f*deltaSeconds*deltaSeconds ); //x := x + v*dt + .5*a*dt*dt.
-	m_velocity += ( prevAccel + dState.m_velocity )*.5f*deltaSeconds; //v := v + .5*(a + a_next)*dt.
-	prevAccel = dState.m_velocity;
+	m_velocity += ( m_previousAcceleration + dState.m_velocity )*.5f*deltaSeconds; //v := v + .5*(a + a_next)*dt.
+	m_previousAcceleration = dState.m_velocity;
 }
 
 
@@ -15,6 +15,7 @@ public:
 	LinearDynamicsState( const Vector3f& position = Vector3f::ZERO, const Vector3f& velocity = Vector3f::ZERO )
 		: m_position( position )
 		, m_velocity( velocity )
+		, m_previousAcceleration( Vector3f::ZERO )
 	{
 	}
 	~LinearDynamicsState();
@@ -25,14 +26,18 @@ public:
 	Vector3f GetVelocity() const { return m_velocity; }
 	void SetPosition( const Vector3f& newPos ) { m_position = newPos; }
 	void SetVelocity( const Vector3f& newVel ) { m_velocity = newVel; }
+	void ResetMotion( const Vector3f& position, const Vector3f& velocity = Vector3f::ZERO ) { m_position = position; m_velocity = velocity; m_previousAcceleration = Vector3f::ZERO; } //As freshly constructed, forces aside.
 	void AddForce( Force* newForce ) { m_forces.push_back( newForce ); }
-	void GetForces( std::vector< Force* >& out_forces ) { out_forces = m_forces; }
+	void GetForces( std::vector< Force* >& out_forces ) const { out_forces = m_forces; }
+	size_t GetNumForces() const { return m_forces.size(); }
+	Force* GetForce( size_t forceIndex ) const { return m_forces[ forceIndex ]; }
 	void ClearForces( bool keepGravity = true );
 
 private:
 
 	Vector3f m_position;
 	Vector3f m_velocity;
+	Vector3f m_previousAcceleration; //StepWithVerlet's a_prev. Was a function-local static, shared by every instance.
 	std::vector<Force*> m_forces; //i.e. All forces acting on whatever this LDS is attached to.
 
 	LinearDynamicsState dStateForMass( float mass ) const; //Solves accel, for use in Step() integrators.
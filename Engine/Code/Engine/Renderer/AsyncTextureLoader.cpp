@@ -0,0 +1,319 @@
+#include "Engine/Renderer/AsyncTextureLoader.hpp"
+
+#include "Engine/Renderer/Texture.hpp"
+#include "Engine/Concurrency/JobUtils.hpp"
+#include "Engine/Concurrency/Thread.hpp"
+#include "Engine/Concurrency/ThreadSafeQueue.hpp"
+#include "Engine/FileUtils/FileUtils.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Core/Logger.hpp"
+#include "Engine/Error/ErrorWarningAssert.hpp"
+#include "Engine/String/StringUtils.hpp"
+#include "Engine/Time/Time.hpp"
+#include "Engine/EngineCommon.hpp"
+#include <atomic>
+#include <map>
+
+#define STBI_HEADER_FILE_ONLY
+#include "ThirdParty/stb/stb_image.c"
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct TextureLoadWaiter
+{
+	TextureLoadedCallback* onLoaded;
+	void* userData;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct TextureLoadRequest
+{
+	std::string filePath;
+	size_t pathHash; //Same key as Texture's registry.
+	std::vector< TextureLoadWaiter > waiters; //Main thread only, so every request for one file shares a single decode.
+
+	//Written by whichever thread decodes it, only read back after it comes out of s_decodedRequests.
+	unsigned char* pixels;
+	Vector2i sizeInTexels;
+	int numComponents;
+	double decodeSeconds;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+typedef std::map< size_t, TextureLoadRequest* > TextureLoadRequestMap;
+
+static ThreadSafeQueue< TextureLoadRequest* > s_queuedRequests; //Waiting on a decode job.
+static ThreadSafeQueue< TextureLoadRequest* > s_decodedRequests; //Waiting on the main thread to upload.
+static std::atomic<int> s_numQueuedRequests( 0 );
+static std::atomic<int> s_numActiveDecodeJobs( 0 );
+
+//Main thread only.
+static TextureLoadRequestMap s_pendingRequests;
+static std::vector< unsigned char > s_mainThreadFileBytes; //For when FinishAllPending pitches in.
+static Texture* s_placeholderTexture = nullptr;
+static float s_uploadBudgetMilliseconds = 2.f;
+
+static unsigned int s_numTexturesLoaded = 0;
+static unsigned int s_numTexturesFailed = 0;
+static size_t s_numBytesUploaded = 0;
+static double s_totalDecodeSeconds = 0.0;
+static double s_totalUploadSeconds = 0.0;
+static double s_batchStartSeconds = 0.0; //Set when a request arrives with nothing pending.
+static double s_batchDecodeSeconds = 0.0;
+static double s_lastBatchWallSeconds = 0.0;
+static double s_lastBatchDecodeSeconds = 0.0; //Summed across threads, so vs. the wall time it shows how well decoding spread out.
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void DecodeRequest( TextureLoadRequest* request, std::vector< unsigned char >& fileBytes )
+{
+	double startSeconds = GetCurrentTimeSeconds();
+
+	request->pixels = nullptr;
+	if ( LoadBinaryFileIntoBuffer( request->filePath, fileBytes ) && !fileBytes.empty() )
+	{
+		request->pixels = stbi_load_from_memory( fileBytes.data(), (int)fileBytes.size(),
+												 &request->sizeInTexels.x, &request->sizeInTexels.y, &request->numComponents, 0 );
+			//0 requested components, as Texture's own ctor does: it handles 3 (RGB) or 4 (Rgba).
+	}
+
+	request->decodeSeconds = GetCurrentTimeSeconds() - startSeconds;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//One per IO thread at most, each draining the shared queue, so hundreds of textures don't need hundreds of pooled Jobs.
+static void DecodeQueuedTextures_Job( Job* )
+{
+	std::vector< unsigned char > fileBytes; //Reused across every file this job reads.
+
+	TextureLoadRequest* request;
+	while ( s_queuedRequests.Dequeue( &request ) )
+	{
+		--s_numQueuedRequests;
+		DecodeRequest( request, fileBytes );
+		s_decodedRequests.Enqueue( request );
+	}
+
+	--s_numActiveDecodeJobs;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Also re-run every Update, which picks up anything queued just as the last job was on its way out.
+static void DispatchDecodeJobs()
+{
+	JobSystem* jobSystem = JobSystem::Instance();
+	if ( !jobSystem->IsRunning() )
+		return; //FinishAllPending decodes on the main thread instead.
+
+	int maxNumDecodeJobs = jobSystem->GetNumIOWorkerThreads();
+	while ( s_numActiveDecodeJobs < maxNumDecodeJobs && s_numActiveDecodeJobs < s_numQueuedRequests )
+	{
+		++s_numActiveDecodeJobs;
+		Job* job = jobSystem->CreateJob( JOB_CATEGORY_IO, DecodeQueuedTextures_Job );
+		jobSystem->DispatchJob( job );
+		jobSystem->DetachJob( job );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void UploadAndNotify( TextureLoadRequest* request )
+{
+	double uploadStartSeconds = GetCurrentTimeSeconds();
+
+	Texture* loadedTexture = nullptr;
+	if ( request->pixels != nullptr )
+	{
+		loadedTexture = Texture::CreateTextureFromBytes( request->filePath, request->pixels, request->sizeInTexels, request->numComponents );
+		s_numBytesUploaded += request->sizeInTexels.x * request->sizeInTexels.y * request->numComponents;
+		++s_numTexturesLoaded;
+		stbi_image_free( request->pixels );
+	}
+	else
+	{
+		++s_numTexturesFailed;
+		ERROR_RECOVERABLE( Stringf( "AsyncTextureLoader failed to load %s, keeping placeholder!", request->filePath.c_str() ) );
+	}
+
+	double nowSeconds = GetCurrentTimeSeconds();
+	s_totalUploadSeconds += nowSeconds - uploadStartSeconds;
+	s_totalDecodeSeconds += request->decodeSeconds;
+	s_batchDecodeSeconds += request->decodeSeconds;
+
+	//Out of the pending map before any callback runs, in case one turns around and requests again.
+	s_pendingRequests.erase( request->pathHash );
+	if ( s_pendingRequests.empty() )
+	{
+		s_lastBatchWallSeconds = nowSeconds - s_batchStartSeconds;
+		s_lastBatchDecodeSeconds = s_batchDecodeSeconds;
+		Logger::PrintfWithTag( "AsyncTextureLoader", "Batch done: %u loaded, %u failed so far, %.3fs wall, %.3fs decode summed across %d IO threads.",
+							   s_numTexturesLoaded, s_numTexturesFailed, s_lastBatchWallSeconds, s_lastBatchDecodeSeconds, JobSystem::Instance()->GetNumIOWorkerThreads() );
+	}
+
+	for ( const TextureLoadWaiter& waiter : request->waiters )
+		waiter.onLoaded( loadedTexture, waiter.userData );
+
+	delete request;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void AsyncTextureLoader::RequestTexture( const std::string& imageFilePath, TextureLoadedCallback* onLoaded, void* userData )
+{
+	TextureLoadWaiter waiter = { onLoaded, userData };
+
+	Texture* residentTexture = Texture::GetTextureByPath( imageFilePath );
+	if ( residentTexture != nullptr )
+	{
+		onLoaded( residentTexture, userData );
+		return;
+	}
+
+	size_t pathHash = std::hash<std::string>{}( imageFilePath );
+	TextureLoadRequestMap::iterator found = s_pendingRequests.find( pathHash );
+	if ( found != s_pendingRequests.end() )
+	{
+		found->second->waiters.push_back( waiter );
+		return;
+	}
+
+	if ( s_pendingRequests.empty() )
+	{
+		s_batchStartSeconds = GetCurrentTimeSeconds();
+		s_batchDecodeSeconds = 0.0;
+	}
+
+	TextureLoadRequest* request = new TextureLoadRequest();
+	request->filePath = imageFilePath;
+	request->pathHash = pathHash;
+	request->waiters.push_back( waiter );
+	request->pixels = nullptr;
+	request->numComponents = 0;
+	request->decodeSeconds = 0.0;
+	s_pendingRequests[ pathHash ] = request;
+
+	++s_numQueuedRequests;
+	s_queuedRequests.Enqueue( request );
+	DispatchDecodeJobs();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void AsyncTextureLoader::Update()
+{
+	if ( s_pendingRequests.empty() )
+		return;
+
+	DispatchDecodeJobs();
+
+	//Always lets one through, so an upload bigger than the whole budget still lands eventually.
+	double stopAtSeconds = GetCurrentTimeSeconds() + ( s_uploadBudgetMilliseconds * 0.001 );
+	TextureLoadRequest* request;
+	while ( s_decodedRequests.Dequeue( &request ) )
+	{
+		UploadAndNotify( request );
+		if ( GetCurrentTimeSeconds() >= stopAtSeconds )
+			break;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void AsyncTextureLoader::FinishAllPending()
+{
+	while ( !s_pendingRequests.empty() )
+	{
+		DispatchDecodeJobs();
+
+		TextureLoadRequest* request;
+		if ( s_decodedRequests.Dequeue( &request ) )
+		{
+			UploadAndNotify( request );
+		}
+		else if ( s_queuedRequests.Dequeue( &request ) ) //Nothing to upload yet, so be one more decoder.
+		{
+			--s_numQueuedRequests;
+			DecodeRequest( request, s_mainThreadFileBytes );
+			UploadAndNotify( request );
+		}
+		else
+		{
+			Thread::ThreadYield(); //Last few are mid-decode on the IO threads.
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void AsyncTextureLoader::Shutdown()
+{
+	TextureLoadRequest* request;
+	while ( s_queuedRequests.Dequeue( &request ) ) //Pull these first so running jobs run dry sooner.
+	{
+		--s_numQueuedRequests;
+		delete request;
+	}
+
+	while ( s_numActiveDecodeJobs > 0 ) //None can still be writing into a request when we free it.
+		Thread::ThreadYield();
+
+	while ( s_decodedRequests.Dequeue( &request ) )
+	{
+		if ( request->pixels != nullptr )
+			stbi_image_free( request->pixels );
+		delete request;
+	}
+
+	s_pendingRequests.clear();
+	std::vector< unsigned char >().swap( s_mainThreadFileBytes );
+	s_placeholderTexture = nullptr; //Owned by Texture's registry.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC Texture* AsyncTextureLoader::GetPlaceholderTexture()
+{
+	if ( s_placeholderTexture == nullptr ) //Lazily, since it needs the GL context to exist.
+	{
+		const unsigned char magentaBlackChecker[ 2 * 2 * 3 ] =
+		{
+			255, 0, 255,	0, 0, 0,
+			0, 0, 0,		255, 0, 255
+		};
+		s_placeholderTexture = Texture::CreateTextureFromBytes( "AsyncTexturePlaceholder", magentaBlackChecker, Vector2i( 2, 2 ), 3 );
+	}
+
+	return s_placeholderTexture;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int AsyncTextureLoader::GetNumPendingRequests()
+{
+	return s_pendingRequests.size();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void AsyncTextureLoader::SetUploadBudgetMilliseconds( float newBudgetMilliseconds )
+{
+	s_uploadBudgetMilliseconds = newBudgetMilliseconds;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void AsyncTextureLoader::PrintStats( Command& )
+{
+	g_theConsole->Printf( "AsyncTextureLoader: %u loaded, %u failed, %u pending (%d queued for decode, %d decode jobs active).",
+						  s_numTexturesLoaded, s_numTexturesFailed, GetNumPendingRequests(), (int)s_numQueuedRequests, (int)s_numActiveDecodeJobs );
+	g_theConsole->Printf( "Uploaded %.2f MB in %.3fs, decoded in %.3fs summed across threads, budget %.2fms/frame.",
+						  (float)s_numBytesUploaded / ( 1024.f * 1024.f ), s_totalUploadSeconds, s_totalDecodeSeconds, s_uploadBudgetMilliseconds );
+
+	double parallelism = ( s_lastBatchWallSeconds > 0.0 ) ? ( s_lastBatchDecodeSeconds / s_lastBatchWallSeconds ) : 0.0;
+	g_theConsole->Printf( "Last batch: %.3fs decode on %d IO threads in %.3fs wall (~%.1fx).",
+						  s_lastBatchDecodeSeconds, JobSystem::Instance()->GetNumIOWorkerThreads(), s_lastBatchWallSeconds, parallelism );
+}
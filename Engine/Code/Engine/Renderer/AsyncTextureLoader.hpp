@@ -0,0 +1,29 @@
+#pragma once
+
+
+#include <string>
+class Texture;
+class Command;
+
+
+//-----------------------------------------------------------------------------
+typedef void ( TextureLoadedCallback )( Texture* loadedTexture, void* userData ); //loadedTexture is nullptr if the file couldn't be read or decoded.
+
+
+//-----------------------------------------------------------------------------
+//Moves the fopen + stbi_load half of Texture::CreateOrGetTexture onto the JobSystem's IO threads.
+//Decoded pixels queue up for Update() to upload on the main thread (the only one with a GL context), until that frame's budget runs out.
+//Until a request's callback fires, callers should draw with GetPlaceholderTexture(), then swap in the real one.
+class AsyncTextureLoader
+{
+public:
+	static void RequestTexture( const std::string& imageFilePath, TextureLoadedCallback* onLoaded, void* userData ); //Calls back immediately if already resident.
+	static void Update(); //Main thread, once a frame.
+	static void FinishAllPending(); //Main thread decodes alongside the IO threads and uploads everything, ignoring the budget.
+	static void Shutdown(); //Drops any callbacks still outstanding, so call before whatever they point at is destroyed.
+
+	static Texture* GetPlaceholderTexture();
+	static unsigned int GetNumPendingRequests();
+	static void SetUploadBudgetMilliseconds( float newBudgetMilliseconds );
+	static void PrintStats( Command& );
+};
@@ -5,6 +5,8 @@
 #include "Engine/Renderer/Texture.hpp"
 #include "Engine/Error/ErrorWarningAssert.hpp"
 #include "Engine/String/StringUtils.hpp"
+#include <algorithm>
+#include <climits>
 
 #define STBI_HEADER_FILE_ONLY
 #include "ThirdParty/stb/stb_image.c"
@@ -91,9 +93,10 @@ BitmapFont::BitmapFont( const std::string& fntFilePath )
 	);
 
 	m_tallestGlyphPx = 0.f;
+	m_glyphs.resize( numGlyphs );
 	for ( int glyphIndex = 0; glyphIndex < numGlyphs; glyphIndex++ )
 	{
-		Glyph* newGlyph = new Glyph;
+		Glyph* newGlyph = &m_glyphs[ glyphIndex ];
 		fscanf( file,
 			"char id=%d x=%d y=%d width=%d height=%d xoffset=%d yoffset=%d xadvance=%d page=%d chnl=%d ",
 			&newGlyph->m_id,
@@ -107,7 +110,8 @@ BitmapFont::BitmapFont( const std::string& fntFilePath )
 			&newGlyph->m_page,
 			&newGlyph->m_channel
 		);	
-		m_fontGlyphs[ newGlyph->m_id ] = newGlyph;
+		newGlyph->m_firstKerningIndex = 0;
+		newGlyph->m_numKernings = 0;
 
 		int glyphHeightWithOffset = newGlyph->m_height + newGlyph->m_yoffset;
 		if ( glyphHeightWithOffset > m_tallestGlyphPx )
@@ -119,6 +123,7 @@ BitmapFont::BitmapFont( const std::string& fntFilePath )
 		&numKernings
 	);
 
+	m_kerningPairs.reserve( numKernings );
 	for ( int kerningPairIndex = 0; kerningPairIndex < numKernings; kerningPairIndex++ )
 	{
 		fscanf( file,
@@ -127,11 +132,38 @@ BitmapFont::BitmapFont( const std::string& fntFilePath )
 			&secondKerningPairId,
 			&pixelsToMoveBack
 		);	
-		m_fontGlyphs[ firstKerningPairId ]->m_kernings[ secondKerningPairId ] = pixelsToMoveBack;
+		KerningPair newPair = { firstKerningPairId, secondKerningPairId, pixelsToMoveBack };
+		m_kerningPairs.push_back( newPair );
 	}
 
 	fclose( file );
 
+	//Build the flat lookup tables.
+	std::sort( m_glyphs.begin(), m_glyphs.end(), []( const Glyph& a, const Glyph& b ) { return a.m_id < b.m_id; } );
+	std::sort( m_kerningPairs.begin(), m_kerningPairs.end() );
+
+	for ( int charIndex = 0; charIndex < NUM_DIRECT_LOOKUP_GLYPHS; charIndex++ )
+		m_glyphIndicesByChar[ charIndex ] = -1;
+
+	m_glyphTexCoords.resize( m_glyphs.size() );
+	for ( unsigned int glyphIndex = 0; glyphIndex < m_glyphs.size(); glyphIndex++ )
+	{
+		Glyph& glyph = m_glyphs[ glyphIndex ];
+		if ( glyph.m_id >= 0 && glyph.m_id < NUM_DIRECT_LOOKUP_GLYPHS )
+			m_glyphIndicesByChar[ glyph.m_id ] = glyphIndex;
+
+		m_glyphTexCoords[ glyphIndex ] = CalcTexCoordsForGlyph( glyph );
+
+		KerningPair firstPossiblePair = { glyph.m_id, INT_MIN, 0 };
+		auto kerningsBegin = std::lower_bound( m_kerningPairs.begin(), m_kerningPairs.end(), firstPossiblePair );
+		auto kerningsEnd = kerningsBegin;
+		while ( kerningsEnd != m_kerningPairs.end() && kerningsEnd->m_firstID == glyph.m_id )
+			++kerningsEnd;
+
+		glyph.m_firstKerningIndex = kerningsBegin - m_kerningPairs.begin();
+		glyph.m_numKernings = kerningsEnd - kerningsBegin;
+	}
+
 	m_face = cstyleFace;
 	m_charset = cstyleCharset;
 }
@@ -154,17 +186,6 @@ BitmapFont::~BitmapFont()
 		delete m_fontAtlases;
 		m_fontAtlases = nullptr;
 	}
-
-	auto glyphIterEnd = m_fontGlyphs.end();
-	for ( auto glyphIter = m_fontGlyphs.begin(); glyphIter != glyphIterEnd; ++glyphIter )
-	{
-		std::pair< int, Glyph* > glyph = *glyphIter;
-		if ( glyph.second != nullptr )
-		{
-			delete glyph.second;
-			glyph.second = nullptr;
-		}
-	}
 }
 
 
@@ -201,10 +222,37 @@ void BitmapFont::LoadFontImage( const std::string& imageFilePath, unsigned int p
 //--------------------------------------------------------------------------------------------------------------
 const Glyph* BitmapFont::GetGlyphForChar( char c ) const
 {
-	if ( m_fontGlyphs.count( c ) > 0 )
-		return m_fontGlyphs.at( c );
-	else 
-		return nullptr;
+	int glyphIndex = m_glyphIndicesByChar[ static_cast<unsigned char>( c ) ];
+	return ( glyphIndex >= 0 ) ? &m_glyphs[ glyphIndex ] : nullptr;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+const Glyph* BitmapFont::GetGlyphForID( int glyphUnicode ) const
+{
+	if ( glyphUnicode >= 0 && glyphUnicode < NUM_DIRECT_LOOKUP_GLYPHS )
+	{
+		int glyphIndex = m_glyphIndicesByChar[ glyphUnicode ];
+		return ( glyphIndex >= 0 ) ? &m_glyphs[ glyphIndex ] : nullptr;
+	}
+
+	auto found = std::lower_bound( m_glyphs.begin(), m_glyphs.end(), glyphUnicode, []( const Glyph& glyph, int id ) { return glyph.m_id < id; } );
+	return ( found != m_glyphs.end() && found->m_id == glyphUnicode ) ? &*found : nullptr;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+float BitmapFont::GetKerning( const Glyph& first, const Glyph& second ) const
+{
+	//Most glyphs begin a handful of pairs at most, so a linear scan of the contiguous run beats anything fancier.
+	const KerningPair* pairsBegin = m_kerningPairs.data() + first.m_firstKerningIndex;
+	const KerningPair* pairsEnd = pairsBegin + first.m_numKernings;
+	for ( const KerningPair* pair = pairsBegin; pair != pairsEnd; ++pair )
+	{
+		if ( pair->m_secondID == second.m_id )
+			return static_cast<float>( pair->m_amount );
+	}
+	return 0.f;
 }
 
 
@@ -231,15 +279,22 @@ Texture* BitmapFont::GetFontTexture( int pageNum ) const
 TODO( "Switch / for * as in SpriteSheet's approach." );
 AABB2f BitmapFont::GetTexCoordsForGlyph( int glyphUnicode ) const
 {
-	//Trying to return a mins and a maxs relative to the texture itself.
-	ASSERT_OR_DIE( m_fontGlyphs.count( glyphUnicode ) > 0, Stringf("BitmapFont::GetTexCoordsForGlyph() failed to find %d in m_fontGlyphs!", glyphUnicode) );
-	Glyph* glyph = m_fontGlyphs.at( glyphUnicode );
+	const Glyph* glyph = GetGlyphForID( glyphUnicode );
+	ASSERT_OR_DIE( glyph != nullptr, Stringf("BitmapFont::GetTexCoordsForGlyph() failed to find %d in m_glyphs!", glyphUnicode) );
+
+	return GetTexCoordsForGlyph( *glyph );
+}
 
+
+//--------------------------------------------------------------------------------------------------------------
+AABB2f BitmapFont::CalcTexCoordsForGlyph( const Glyph& glyph ) const
+{
+	//Trying to return a mins and a maxs relative to the texture itself.
 	//Normalize via dividing full image width and height, because the full texCoords == [0,1]x[0,1].
-	float topLeftX = glyph->m_x / static_cast<float>( m_textureWidth );
-	float topLeftY = glyph->m_y / static_cast<float>( m_textureHeight );
-	float bottomRightX = ( glyph->m_x + glyph->m_width ) / static_cast<float>( m_textureWidth );
-	float bottomRightY = ( glyph->m_y + glyph->m_height ) / static_cast<float>( m_textureWidth );
+	float topLeftX = glyph.m_x / static_cast<float>( m_textureWidth );
+	float topLeftY = glyph.m_y / static_cast<float>( m_textureHeight );
+	float bottomRightX = ( glyph.m_x + glyph.m_width ) / static_cast<float>( m_textureWidth );
+	float bottomRightY = ( glyph.m_y + glyph.m_height ) / static_cast<float>( m_textureWidth );
 
 	return AABB2f( topLeftX, topLeftY, bottomRightX, bottomRightY );
 }
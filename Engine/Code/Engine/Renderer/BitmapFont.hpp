@@ -2,6 +2,7 @@
 
 
 #include <map>
+#include <vector>
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Memory/UntrackedAllocator.hpp"
 
@@ -23,8 +24,18 @@ struct Glyph
 	int m_xadvance; //"How much the current position should be advanced after drawing the character." (Prior to any kerning pair effects.)
 	int m_page; //"The texture page where the character image is found."
 	int m_channel; //"The texture channel where the character image is found (1 = blue, 2 = green, 4 = red, 8 = alpha, 15 = all channels)."
-	std::map< int, int > m_kernings; //If this glyph precedes one of these glyph IDs, offset backward by the associated amount, else return 0.
-	float GetKerning( int glyphID ) const { return ( m_kernings.count( glyphID ) > 0 ) ? static_cast<float>( m_kernings.at( glyphID ) ) : 0.f;  }
+	int m_firstKerningIndex; //Into BitmapFont::m_kerningPairs, which is sorted so all pairs this glyph begins are contiguous.
+	int m_numKernings;
+};
+
+
+//-----------------------------------------------------------------------------
+struct KerningPair //If glyph m_firstID precedes glyph m_secondID, offset backward by m_amount.
+{
+	int m_firstID;
+	int m_secondID;
+	int m_amount;
+	bool operator<( const KerningPair& other ) const { return ( m_firstID != other.m_firstID ) ? ( m_firstID < other.m_firstID ) : ( m_secondID < other.m_secondID ); }
 };
 
 
@@ -46,7 +57,10 @@ public:
 
 	float GetTallestGlyphHeightPx() const { return m_tallestGlyphPx; }
 	const Glyph* GetGlyphForChar( char c ) const;
+	const Glyph* GetGlyphForID( int glyphUnicode ) const;
+	float GetKerning( const Glyph& first, const Glyph& second ) const; //0 if the pair has none.
 	AABB2f GetTexCoordsForGlyph( int glyphUnicode ) const; //Can't rely on SpriteSheet now, need to call corresponding Glyph object.
+	const AABB2f& GetTexCoordsForGlyph( const Glyph& glyph ) const { return m_glyphTexCoords[ &glyph - m_glyphs.data() ]; }
 	Texture* GetFontTexture( int pageNum = 0 ) const;
 
 private:
@@ -88,7 +102,15 @@ private:
 	int numGlyphs; //"numChars" in .fnt.
 
 	static BitmapFontRegistryMap s_fontRegistry;	//Uses .fnt filepath as a key--only ever one .fnt file even for multi-page bitmap fonts.
-	std::map< int, Glyph* > m_fontGlyphs; //The .fnt char id is the key.
+
+	//Flat tables, since text layout looks up every glyph and kerning pair per character.
+	static const int NUM_DIRECT_LOOKUP_GLYPHS = 256; //Every char, so GetGlyphForChar never searches.
+	std::vector< Glyph > m_glyphs; //Sorted by the .fnt char id.
+	std::vector< AABB2f > m_glyphTexCoords; //Parallel to m_glyphs.
+	int m_glyphIndicesByChar[ NUM_DIRECT_LOOKUP_GLYPHS ]; //-1 if the font lacks it.
+	std::vector< KerningPair > m_kerningPairs; //Sorted, see Glyph::m_firstKerningIndex.
+
+	AABB2f CalcTexCoordsForGlyph( const Glyph& glyph ) const;
 
 	int m_numPages;
 	Texture** m_fontAtlases; //Array of Texture* for multi-page fonts.
@@ -1,157 +1,690 @@
 #include "Engine/Renderer/DebugRenderCommand.hpp"
 
 #include "Engine/Renderer/TheRenderer.hpp"
+#include "Engine/Renderer/Vertexes.hpp"
+#include "Engine/Concurrency/JobUtils.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Time/Time.hpp"
+#include <atomic>
+#include <string.h>
+#include <vector>
 
 
 //--------------------------------------------------------------------------------------------------------------
-std::list< DebugRenderCommand* >* g_theDebugRenderCommands = nullptr;
+static const unsigned int DEBUG_TEXT_MAX_LENGTH = 64; //Including the terminator.
+static const unsigned int RESERVED_COMMANDS_PER_TYPE = 1024;
+static const unsigned int SPHERE_GIMBAL_NUM_SIDES = 10;
+static const float DUAL_HIDDEN_THICKNESS_SCALAR = .3f;
+static const float AABB_EDGE_THICKNESS_SCALAR = 1.5f; //Ensure lines show over faces.
+static const unsigned int NUM_BENCHMARK_JOBS = 8;
 
 
 //--------------------------------------------------------------------------------------------------------------
-void DebugRenderCommandPoint::Render()
+struct DebugPoint { Vector3f position; float sizeScalar; };
+struct DebugLine { Vector3f startPos; Vector3f endPos; }; //Lines and arrows both.
+struct DebugAABB3 { AABB3f bounds; Rgba edgeColor; bool drawFilled; };
+struct DebugSphere { Vector3f centerPos; float radius; };
+struct DebugBasis { Vector3f originPos; float axisLength; bool showZ; };
+struct DebugText { Vector3f lowerLeftPos; Vector3f textPlaneUpDir; Vector3f textPlaneRightDir; float scale; char text[ DEBUG_TEXT_MAX_LENGTH ]; };
+
+
+//--------------------------------------------------------------------------------------------------------------
+//One array per field, all indexed alike. Expiring moves the last command into the hole, so order isn't kept.
+//Clearing keeps the capacity, which is how adds stop allocating once a pool has grown to a scene's usual load.
+template < typename ShapeType >
+struct DebugCommandPool
+{
+	std::vector< ShapeType > shapes;
+	std::vector< Rgba > colors;
+	std::vector< float > secondsToLive;
+	std::vector< float > lineThicknesses;
+	std::vector< unsigned char > depthModes;
+
+	unsigned int GetSize() const { return shapes.size(); }
+
+	void Reserve( unsigned int numCommands )
+	{
+		shapes.reserve( numCommands );
+		colors.reserve( numCommands );
+		secondsToLive.reserve( numCommands );
+		lineThicknesses.reserve( numCommands );
+		depthModes.reserve( numCommands );
+	}
+
+	void Add( const ShapeType& shape, float seconds, DepthMode depthMode, const Rgba& color, float lineThickness )
+	{
+		shapes.push_back( shape );
+		colors.push_back( color );
+		secondsToLive.push_back( seconds );
+		lineThicknesses.push_back( lineThickness );
+		depthModes.push_back( (unsigned char)depthMode );
+	}
+
+	void AddAll( const DebugCommandPool& other )
+	{
+		shapes.insert( shapes.end(), other.shapes.begin(), other.shapes.end() );
+		colors.insert( colors.end(), other.colors.begin(), other.colors.end() );
+		secondsToLive.insert( secondsToLive.end(), other.secondsToLive.begin(), other.secondsToLive.end() );
+		lineThicknesses.insert( lineThicknesses.end(), other.lineThicknesses.begin(), other.lineThicknesses.end() );
+		depthModes.insert( depthModes.end(), other.depthModes.begin(), other.depthModes.end() );
+	}
+
+	void Update( float deltaSeconds )
+	{
+		for ( float& seconds : secondsToLive )
+			seconds -= deltaSeconds;
+	}
+
+	void RemoveExpired()
+	{
+		unsigned int numLeft = GetSize();
+		for ( unsigned int commandIndex = 0; commandIndex < numLeft; )
+		{
+			if ( secondsToLive[ commandIndex ] > 0.f )
+			{
+				++commandIndex;
+				continue;
+			}
+
+			--numLeft;
+			shapes[ commandIndex ] = shapes[ numLeft ];
+			colors[ commandIndex ] = colors[ numLeft ];
+			secondsToLive[ commandIndex ] = secondsToLive[ numLeft ];
+			lineThicknesses[ commandIndex ] = lineThicknesses[ numLeft ];
+			depthModes[ commandIndex ] = depthModes[ numLeft ];
+		}
+
+		shapes.erase( shapes.begin() + numLeft, shapes.end() );
+		colors.erase( colors.begin() + numLeft, colors.end() );
+		secondsToLive.erase( secondsToLive.begin() + numLeft, secondsToLive.end() );
+		lineThicknesses.erase( lineThicknesses.begin() + numLeft, lineThicknesses.end() );
+		depthModes.erase( depthModes.begin() + numLeft, depthModes.end() );
+	}
+
+	void Clear()
+	{
+		shapes.clear();
+		colors.clear();
+		secondsToLive.clear();
+		lineThicknesses.clear();
+		depthModes.clear();
+	}
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct DebugCommandPools
+{
+	DebugCommandPool< DebugPoint > points;
+	DebugCommandPool< DebugLine > lines;
+	DebugCommandPool< DebugLine > arrows;
+	DebugCommandPool< DebugAABB3 > aabbs;
+	DebugCommandPool< DebugSphere > spheres;
+	DebugCommandPool< DebugBasis > bases;
+	DebugCommandPool< DebugText > texts;
+
+	unsigned int GetNumCommands() const
+	{
+		return points.GetSize() + lines.GetSize() + arrows.GetSize() + aabbs.GetSize() + spheres.GetSize() + bases.GetSize() + texts.GetSize();
+	}
+
+	void Reserve( unsigned int numCommandsPerType )
+	{
+		points.Reserve( numCommandsPerType );
+		lines.Reserve( numCommandsPerType );
+		arrows.Reserve( numCommandsPerType );
+		aabbs.Reserve( numCommandsPerType );
+		spheres.Reserve( numCommandsPerType );
+		bases.Reserve( numCommandsPerType );
+		texts.Reserve( numCommandsPerType );
+	}
+
+	void AddAll( const DebugCommandPools& other )
+	{
+		points.AddAll( other.points );
+		lines.AddAll( other.lines );
+		arrows.AddAll( other.arrows );
+		aabbs.AddAll( other.aabbs );
+		spheres.AddAll( other.spheres );
+		bases.AddAll( other.bases );
+		texts.AddAll( other.texts );
+	}
+
+	void Update( float deltaSeconds )
+	{
+		points.Update( deltaSeconds );
+		lines.Update( deltaSeconds );
+		arrows.Update( deltaSeconds );
+		aabbs.Update( deltaSeconds );
+		spheres.Update( deltaSeconds );
+		bases.Update( deltaSeconds );
+		texts.Update( deltaSeconds );
+	}
+
+	void RemoveExpired()
+	{
+		points.RemoveExpired();
+		lines.RemoveExpired();
+		arrows.RemoveExpired();
+		aabbs.RemoveExpired();
+		spheres.RemoveExpired();
+		bases.RemoveExpired();
+		texts.RemoveExpired();
+	}
+
+	void Clear()
+	{
+		points.Clear();
+		lines.Clear();
+		arrows.Clear();
+		aabbs.Clear();
+		spheres.Clear();
+		bases.Clear();
+		texts.Clear();
+	}
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Each adding thread's pair of pools. The thread adds into pools[ writeIndex ] while the main thread drains the other,
+//so neither side takes a lock (jobs mustn't). isWriting[ i ] is up while the owner is mid-add into pools[ i ]: after the
+//main thread flips writeIndex, it waits for the old pool's flag to drop, and an adder that sees writeIndex move under it
+//drops its flag and retries on the new pool.
+struct DebugCommandThreadQueue
+{
+	DebugCommandPools pools[ 2 ];
+	std::atomic< unsigned int > writeIndex;
+	std::atomic< bool > isWriting[ 2 ];
+	DebugCommandThreadQueue* next;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+enum DebugRenderPass //Draw order: the faint, depth-off half of DEPTH_TEST_DUAL goes first so the depth-on half draws over it where visible.
+{
+	DEBUG_RENDER_PASS_DUAL_HIDDEN,
+	DEBUG_RENDER_PASS_DEPTH_ON,
+	DEBUG_RENDER_PASS_DEPTH_OFF,
+	NUM_DEBUG_RENDER_PASSES
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct DebugLineStream
 {
+	float lineWidth;
+	std::vector< Vertex3D_PCT > vertices;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct DebugRenderPassStreams
+{
+	std::vector< Vertex3D_PCT > triangleVertices;
+	std::vector< DebugLineStream > lineStreams; //Only the first numLineWidths are in use: the rest keep their capacity for later frames.
+	unsigned int numLineWidths = 0;
+
+	std::vector< Vertex3D_PCT >& GetLineStream( float lineWidth ) //Line width is GL state, so each width needs its own draw.
+	{
+		for ( unsigned int widthIndex = 0; widthIndex < numLineWidths; widthIndex++ )
+			if ( lineStreams[ widthIndex ].lineWidth == lineWidth )
+				return lineStreams[ widthIndex ].vertices;
+
+		if ( numLineWidths == lineStreams.size() )
+			lineStreams.push_back( DebugLineStream() ); //Grows only when a frame sees more distinct widths than any before it.
+
+		DebugLineStream& newStream = lineStreams[ numLineWidths++ ];
+		newStream.lineWidth = lineWidth;
+		return newStream.vertices;
+	}
+
+	void Clear()
+	{
+		triangleVertices.clear();
+		for ( unsigned int widthIndex = 0; widthIndex < numLineWidths; widthIndex++ )
+			lineStreams[ widthIndex ].vertices.clear();
+		numLineWidths = 0;
+	}
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+static DebugCommandPools s_liveCommands; //Main thread only.
+static DebugRenderPassStreams s_passStreams[ NUM_DEBUG_RENDER_PASSES ]; //Main thread only, reused every frame.
+static std::atomic< DebugCommandThreadQueue* > s_threadQueues( nullptr ); //Pushed onto by each thread's first add, never popped until shutdown.
+static std::atomic< unsigned int > s_threadQueuesGeneration( 1 ); //Bumped on shutdown so a thread's cached queue reads as stale.
+static std::atomic< bool > s_haveDebugCommandsShutDown( false ); //Checked only when a thread's cached queue is stale, so adds stay lock- and check-free.
+static thread_local DebugCommandThreadQueue* t_threadQueue = nullptr;
+static thread_local unsigned int t_threadQueueGeneration = 0;
+static float s_sphereGimbalCosines[ SPHERE_GIMBAL_NUM_SIDES + 1 ];
+static float s_sphereGimbalSines[ SPHERE_GIMBAL_NUM_SIDES + 1 ];
+
+
+//--------------------------------------------------------------------------------------------------------------
+static DebugCommandThreadQueue* GetThreadQueue()
+{
+	unsigned int generation = s_threadQueuesGeneration.load();
+	if ( t_threadQueueGeneration == generation )
+		return t_threadQueue;
+
+	//Otherwise this would push a queue nobody drains or frees.
+	ASSERT_OR_DIE( !s_haveDebugCommandsShutDown.load(), "Debug render command added after ShutdownDebugCommands!" );
+
+	DebugCommandThreadQueue* queue = new DebugCommandThreadQueue();
+	queue->pools[ 0 ].Reserve( RESERVED_COMMANDS_PER_TYPE );
+	queue->pools[ 1 ].Reserve( RESERVED_COMMANDS_PER_TYPE );
+	queue->writeIndex = 0;
+	queue->isWriting[ 0 ] = false;
+	queue->isWriting[ 1 ] = false;
+	queue->next = s_threadQueues.load();
+	while ( !s_threadQueues.compare_exchange_weak( queue->next, queue ) )
+		;
+
+	t_threadQueue = queue;
+	t_threadQueueGeneration = generation;
+	return queue;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static DebugCommandPools& BeginQueueing( DebugCommandThreadQueue* queue, unsigned int& out_poolIndex )
+{
+	for ( ;; )
+	{
+		unsigned int poolIndex = queue->writeIndex.load();
+		queue->isWriting[ poolIndex ].store( true );
+		if ( queue->writeIndex.load() == poolIndex )
+		{
+			out_poolIndex = poolIndex;
+			return queue->pools[ poolIndex ];
+		}
+		queue->isWriting[ poolIndex ].store( false ); //Flipped in between, so the main thread may be draining it.
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void EndQueueing( DebugCommandThreadQueue* queue, unsigned int poolIndex )
+{
+	queue->isWriting[ poolIndex ].store( false );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void CollectThreadQueues()
+{
+	for ( DebugCommandThreadQueue* queue = s_threadQueues.load(); queue != nullptr; queue = queue->next )
+	{
+		unsigned int drainIndex = queue->writeIndex.load();
+		queue->writeIndex.store( drainIndex ^ 1 );
+		while ( queue->isWriting[ drainIndex ].load() )
+			; //At most one add's worth of pushes.
+
+		s_liveCommands.AddAll( queue->pools[ drainIndex ] );
+		queue->pools[ drainIndex ].Clear();
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline void AppendLine( std::vector< Vertex3D_PCT >& stream, const Vector3f& startPos, const Vector3f& endPos, const Rgba& color )
+{
+	stream.push_back( Vertex3D_PCT( startPos, color ) );
+	stream.push_back( Vertex3D_PCT( endPos, color ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void AppendPoint( DebugRenderPassStreams& streams, const DebugPoint& point, const Rgba& color, float lineThickness, bool /*isHiddenCopy*/ )
+{
+	std::vector< Vertex3D_PCT >& stream = streams.GetLineStream( lineThickness );
+	const Vector3f& pos = point.position;
+	float size = point.sizeScalar;
+
 	//x in XY.
-	g_theRenderer->DrawLine( m_position + ( Vector3f( -1.f, -1.f, 0.f ) * m_sizeScalar ), m_position + ( Vector3f( 1.f, 1.f, 0.f ) * m_sizeScalar ), m_color, m_color, m_lineThickness );
-	g_theRenderer->DrawLine( m_position + ( Vector3f( -1.f, 1.f, 0.f ) * m_sizeScalar ), m_position + ( Vector3f( 1.f, -1.f, 0.f ) * m_sizeScalar ), m_color, m_color, m_lineThickness );
+	AppendLine( stream, pos + Vector3f( -size, -size, 0.f ), pos + Vector3f( size, size, 0.f ), color );
+	AppendLine( stream, pos + Vector3f( -size, size, 0.f ), pos + Vector3f( size, -size, 0.f ), color );
 
 	//x in XZ.
-	g_theRenderer->DrawLine( m_position + ( Vector3f( -1.f, 0.f, -1.f ) * m_sizeScalar ), m_position + ( Vector3f( 1.f, 0.f, 1.f ) * m_sizeScalar ), m_color, m_color, m_lineThickness );
-	g_theRenderer->DrawLine( m_position + ( Vector3f( -1.f, 0.f, 1.f ) * m_sizeScalar ), m_position + ( Vector3f( 1.f, 0.f, -1.f ) * m_sizeScalar ), m_color, m_color, m_lineThickness );
+	AppendLine( stream, pos + Vector3f( -size, 0.f, -size ), pos + Vector3f( size, 0.f, size ), color );
+	AppendLine( stream, pos + Vector3f( -size, 0.f, size ), pos + Vector3f( size, 0.f, -size ), color );
 
 	//x in YZ.
-	g_theRenderer->DrawLine( m_position + ( Vector3f( 0.f, -1.f, -1.f ) * m_sizeScalar ), m_position + ( Vector3f( 0.f, 1.f, 1.f ) * m_sizeScalar ), m_color, m_color, m_lineThickness );
-	g_theRenderer->DrawLine( m_position + ( Vector3f( 0.f, -1.f, 1.f ) * m_sizeScalar ), m_position + ( Vector3f( 0.f, 1.f, -1.f ) * m_sizeScalar ), m_color, m_color, m_lineThickness );
+	AppendLine( stream, pos + Vector3f( 0.f, -size, -size ), pos + Vector3f( 0.f, size, size ), color );
+	AppendLine( stream, pos + Vector3f( 0.f, -size, size ), pos + Vector3f( 0.f, size, -size ), color );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-void DebugRenderCommandLine::Render()
+static void AppendLineCommand( DebugRenderPassStreams& streams, const DebugLine& line, const Rgba& color, float lineThickness, bool /*isHiddenCopy*/ )
 {
-	g_theRenderer->DrawLine( m_startPos, m_endPos, m_color, m_color, m_lineThickness );
+	AppendLine( streams.GetLineStream( lineThickness ), line.startPos, line.endPos, color );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-void DebugRenderCommandArrow::Render()
+static void AppendArrow( DebugRenderPassStreams& streams, const DebugLine& arrow, const Rgba& color, float lineThickness, bool /*isHiddenCopy*/ )
 {
-	g_theRenderer->DrawLine( m_startPos, m_endPos, m_color, m_color, m_lineThickness );
+	std::vector< Vertex3D_PCT >& stream = streams.GetLineStream( lineThickness );
+	const Vector3f& startPos = arrow.startPos;
+	const Vector3f& endPos = arrow.endPos;
 
 	float arrowScalar = .5f;
-	Vector3f arrowOffsets = ( m_endPos - m_startPos ) * arrowScalar;
-	Vector3f arrowX = Vector3f( m_startPos.x + arrowOffsets.x, m_endPos.y, m_endPos.z );
-	Vector3f arrowY = Vector3f( m_endPos.x, m_startPos.y + arrowOffsets.y, m_endPos.z );
-	Vector3f arrowZ = Vector3f( m_endPos.x, m_endPos.y, m_startPos.z + arrowOffsets.z );
-
-	g_theRenderer->DrawLine( m_endPos, arrowX, m_color, m_color, m_lineThickness );
-	g_theRenderer->DrawLine( m_endPos, arrowY, m_color, m_color, m_lineThickness );
-	g_theRenderer->DrawLine( m_endPos, arrowZ, m_color, m_color, m_lineThickness );
+	Vector3f arrowOffsets = ( endPos - startPos ) * arrowScalar;
+	Vector3f arrowX = Vector3f( startPos.x + arrowOffsets.x, endPos.y, endPos.z );
+	Vector3f arrowY = Vector3f( endPos.x, startPos.y + arrowOffsets.y, endPos.z );
+	Vector3f arrowZ = Vector3f( endPos.x, endPos.y, startPos.z + arrowOffsets.z );
+
+	AppendLine( stream, startPos, endPos, color );
+	AppendLine( stream, endPos, arrowX, color );
+	AppendLine( stream, endPos, arrowY, color );
+	AppendLine( stream, endPos, arrowZ, color );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-void DebugRenderCommandAABB3::Render()
+static void AppendAABB3( DebugRenderPassStreams& streams, const DebugAABB3& box, const Rgba& fillColor, float lineThickness, bool isHiddenCopy )
 {
-	
-	if ( m_drawFilled ) g_theRenderer->DrawAABB( VertexGroupingRule::AS_TRIANGLES, m_bounds, m_color, m_lineThickness );
-	g_theRenderer->DrawAABB( VertexGroupingRule::AS_LINE_STRIP, m_bounds, m_edgeColor, m_lineThickness * 1.5f ); //Ensure lines show over faces.
+	//Corner i takes maxs on an axis where its bit is set: x is bit 0, y bit 1, z bit 2.
+	const AABB3f& bounds = box.bounds;
+	Vector3f corners[ 8 ];
+	for ( unsigned int cornerIndex = 0; cornerIndex < 8; cornerIndex++ )
+	{
+		corners[ cornerIndex ] = Vector3f( ( cornerIndex & 1 ) ? bounds.maxs.x : bounds.mins.x,
+										   ( cornerIndex & 2 ) ? bounds.maxs.y : bounds.mins.y,
+										   ( cornerIndex & 4 ) ? bounds.maxs.z : bounds.mins.z );
+	}
+
+	if ( box.drawFilled ) //Same faces and winding as TheRenderer::DrawAABB: bottom, top, left, right, front, back.
+	{
+		static const unsigned char FACE_CORNERS[ 6 ][ 4 ] = { { 3, 1, 0, 2 }, { 6, 4, 5, 7 }, { 3, 2, 6, 7 }, { 5, 1, 0, 4 }, { 4, 6, 2, 0 }, { 1, 3, 7, 5 } };
+		for ( const unsigned char* face : FACE_CORNERS )
+		{
+			streams.triangleVertices.push_back( Vertex3D_PCT( corners[ face[ 0 ] ], fillColor ) );
+			streams.triangleVertices.push_back( Vertex3D_PCT( corners[ face[ 1 ] ], fillColor ) );
+			streams.triangleVertices.push_back( Vertex3D_PCT( corners[ face[ 2 ] ], fillColor ) );
+			streams.triangleVertices.push_back( Vertex3D_PCT( corners[ face[ 0 ] ], fillColor ) );
+			streams.triangleVertices.push_back( Vertex3D_PCT( corners[ face[ 2 ] ], fillColor ) );
+			streams.triangleVertices.push_back( Vertex3D_PCT( corners[ face[ 3 ] ], fillColor ) );
+		}
+	}
+
+	Rgba edgeColor = box.edgeColor;
+	if ( isHiddenCopy )
+		edgeColor.alphaOpacity >>= 2;
+
+	static const unsigned char EDGE_CORNERS[ 12 ][ 2 ] = { { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 }, { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } };
+	std::vector< Vertex3D_PCT >& stream = streams.GetLineStream( lineThickness * AABB_EDGE_THICKNESS_SCALAR );
+	for ( const unsigned char* edge : EDGE_CORNERS )
+		AppendLine( stream, corners[ edge[ 0 ] ], corners[ edge[ 1 ] ], edgeColor );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-void DebugRenderCommandSphere::Render()
+static void AppendSphere( DebugRenderPassStreams& streams, const DebugSphere& sphere, const Rgba& color, float lineThickness, bool /*isHiddenCopy*/ )
 {
-	g_theRenderer->DrawSphereGimbal( VertexGroupingRule::AS_LINES, m_centerPos, m_radius, 10.f, m_color, m_lineThickness );
+	std::vector< Vertex3D_PCT >& stream = streams.GetLineStream( lineThickness );
+	const Vector3f& center = sphere.centerPos;
+	float radius = sphere.radius;
+
+	for ( unsigned int sideIndex = 0; sideIndex < SPHERE_GIMBAL_NUM_SIDES; sideIndex++ )
+	{
+		float cosStart = radius * s_sphereGimbalCosines[ sideIndex ];
+		float sinStart = radius * s_sphereGimbalSines[ sideIndex ];
+		float cosEnd = radius * s_sphereGimbalCosines[ sideIndex + 1 ];
+		float sinEnd = radius * s_sphereGimbalSines[ sideIndex + 1 ];
+
+		AppendLine( stream, center + Vector3f( 0.f, cosStart, sinStart ), center + Vector3f( 0.f, cosEnd, sinEnd ), color ); //YZ.
+		AppendLine( stream, center + Vector3f( cosStart, 0.f, sinStart ), center + Vector3f( cosEnd, 0.f, sinEnd ), color ); //XZ.
+		AppendLine( stream, center + Vector3f( cosStart, sinStart, 0.f ), center + Vector3f( cosEnd, sinEnd, 0.f ), color ); //XY.
+	}
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-void DebugRenderCommandBasis::Render()
+static void AppendBasis( DebugRenderPassStreams& streams, const DebugBasis& basis, const Rgba& color, float lineThickness, bool /*isHiddenCopy*/ )
 {
-	g_theRenderer->DrawDebugAxes( m_axisLength, m_lineThickness, m_showZ );
+	std::vector< Vertex3D_PCT >& stream = streams.GetLineStream( lineThickness );
+	const Vector3f& origin = basis.originPos;
+	float length = basis.axisLength;
+	Rgba xColor = Rgba::RED;
+	Rgba yColor = Rgba::GREEN;
+	Rgba zColor = Rgba::BLUE;
+	xColor.alphaOpacity = yColor.alphaOpacity = zColor.alphaOpacity = color.alphaOpacity;
+
+	AppendLine( stream, origin, origin + Vector3f( length, 0.f, 0.f ), xColor );
+	AppendLine( stream, origin, origin + Vector3f( 0.f, length, 0.f ), yColor );
+	if ( basis.showZ )
+		AppendLine( stream, origin, origin + Vector3f( 0.f, 0.f, length ), zColor );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-void RenderThenExpireDebugCommands3D() //Handles the depth modes.
+//Appends each command to the passes its depth mode draws in: DUAL into both, faint and thin in the hidden pass.
+template < typename ShapeType, typename AppendShapeFunc >
+static void AppendPoolToPassStreams( const DebugCommandPool< ShapeType >& pool, AppendShapeFunc appendShape )
 {
-	auto commandIterEnd = g_theDebugRenderCommands->end();
-	for ( auto commandIter = g_theDebugRenderCommands->begin(); commandIter != commandIterEnd; )
+	unsigned int numCommands = pool.GetSize();
+	for ( unsigned int commandIndex = 0; commandIndex < numCommands; commandIndex++ )
 	{
-		DebugRenderCommand* currentCommand = *commandIter;
+		const ShapeType& shape = pool.shapes[ commandIndex ];
+		const Rgba& color = pool.colors[ commandIndex ];
+		float lineThickness = pool.lineThicknesses[ commandIndex ];
+		DepthMode depthMode = (DepthMode)pool.depthModes[ commandIndex ];
 
-		switch ( currentCommand->m_depthMode )
+		if ( depthMode == DEPTH_TEST_DUAL )
 		{
-		case DEPTH_TEST_ON: 
-			g_theRenderer->EnableDepthTesting( true );
-			currentCommand->Render();
-			break;
-		case DEPTH_TEST_OFF:
-			g_theRenderer->EnableDepthTesting( false );
-			currentCommand->Render();
-			break;
-		case DEPTH_TEST_DUAL:
-			unsigned char alphaBackup = currentCommand->m_color.alphaOpacity;
-			float sizeBackup = currentCommand->m_lineThickness;
-			g_theRenderer->EnableDepthTesting( false );
-			currentCommand->m_color.alphaOpacity >>= 2; //Halved.
-			currentCommand->m_lineThickness *= .3f;
-			currentCommand->Render();
-
-			g_theRenderer->EnableDepthTesting( true );
-			currentCommand->m_color.alphaOpacity = alphaBackup;
-			currentCommand->m_lineThickness = sizeBackup;
-			currentCommand->Render();
-			break;
+			Rgba hiddenColor = color;
+			hiddenColor.alphaOpacity >>= 2;
+			appendShape( s_passStreams[ DEBUG_RENDER_PASS_DUAL_HIDDEN ], shape, hiddenColor, lineThickness * DUAL_HIDDEN_THICKNESS_SCALAR, true );
 		}
 
-		if ( currentCommand->IsExpired() ) //Expire after draw or 1-frame commands wouldn't show.
-		{
-			commandIter = g_theDebugRenderCommands->erase( commandIter );
-
-			delete currentCommand;
-			currentCommand = nullptr;
-		}
-		else ++commandIter;
+		DebugRenderPass pass = ( depthMode == DEPTH_TEST_OFF ) ? DEBUG_RENDER_PASS_DEPTH_OFF : DEBUG_RENDER_PASS_DEPTH_ON;
+		appendShape( s_passStreams[ pass ], shape, color, lineThickness, false );
 	}
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-void UpdateDebugCommands( float deltaSeconds )
+static unsigned int BuildPassStreams() //Returns the number of draws the streams will take, not counting text.
 {
-	auto commandIterEnd = g_theDebugRenderCommands->end();
-	for ( auto commandIter = g_theDebugRenderCommands->begin(); commandIter != commandIterEnd; ++commandIter )
+	for ( DebugRenderPassStreams& streams : s_passStreams )
+		streams.Clear();
+
+	AppendPoolToPassStreams( s_liveCommands.points, AppendPoint );
+	AppendPoolToPassStreams( s_liveCommands.lines, AppendLineCommand );
+	AppendPoolToPassStreams( s_liveCommands.arrows, AppendArrow );
+	AppendPoolToPassStreams( s_liveCommands.aabbs, AppendAABB3 );
+	AppendPoolToPassStreams( s_liveCommands.spheres, AppendSphere );
+	AppendPoolToPassStreams( s_liveCommands.bases, AppendBasis );
+
+	unsigned int numDraws = 0;
+	for ( const DebugRenderPassStreams& streams : s_passStreams )
+		numDraws += streams.numLineWidths + ( streams.triangleVertices.empty() ? 0 : 1 );
+	return numDraws;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void DrawPass( DebugRenderPass pass )
+{
+	DebugRenderPassStreams& streams = s_passStreams[ pass ];
+	const DebugCommandPool< DebugText >& texts = s_liveCommands.texts;
+	if ( streams.triangleVertices.empty() && ( streams.numLineWidths == 0 ) && ( texts.GetSize() == 0 ) )
+		return;
+
+	g_theRenderer->EnableDepthTesting( pass == DEBUG_RENDER_PASS_DEPTH_ON );
+	g_theRenderer->UnbindTexture();
+
+	g_theRenderer->DrawVertexArray3D_PCT( AS_TRIANGLES, streams.triangleVertices.data(), streams.triangleVertices.size() );
+	for ( unsigned int widthIndex = 0; widthIndex < streams.numLineWidths; widthIndex++ )
+	{
+		const DebugLineStream& lineStream = streams.lineStreams[ widthIndex ];
+		g_theRenderer->SetLineWidth( lineStream.lineWidth );
+		g_theRenderer->DrawVertexArray3D_PCT( AS_LINES, lineStream.vertices.data(), lineStream.vertices.size() );
+	}
+
+	//Glyph quads share the font texture, so the renderer's immediate-draw batching merges a pass's text into one draw.
+	for ( unsigned int textIndex = 0; textIndex < texts.GetSize(); textIndex++ )
 	{
-		DebugRenderCommand* currentCommand = *commandIter;
-		currentCommand->Update( deltaSeconds );
+		DepthMode depthMode = (DepthMode)texts.depthModes[ textIndex ];
+		bool isHiddenCopy = ( pass == DEBUG_RENDER_PASS_DUAL_HIDDEN );
+		bool drawsInPass = isHiddenCopy ? ( depthMode == DEPTH_TEST_DUAL ) : ( ( depthMode == DEPTH_TEST_OFF ) == ( pass == DEBUG_RENDER_PASS_DEPTH_OFF ) );
+		if ( !drawsInPass )
+			continue;
+
+		const DebugText& text = texts.shapes[ textIndex ];
+		Rgba color = texts.colors[ textIndex ];
+		if ( isHiddenCopy )
+			color.alphaOpacity >>= 2;
+		g_theRenderer->DrawTextProportional3D( text.lowerLeftPos, text.text, text.textPlaneUpDir, text.textPlaneRightDir, text.scale, nullptr, color );
 	}
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-void ClearDebugCommands() //Else program could shutdown before all commands expire.
+void StartupDebugCommands()
 {
-	auto commandIterEnd = g_theDebugRenderCommands->end();
-	for ( auto commandIter = g_theDebugRenderCommands->begin(); commandIter != commandIterEnd; )
+	s_haveDebugCommandsShutDown = false;
+	s_liveCommands.Reserve( RESERVED_COMMANDS_PER_TYPE );
+
+	float degreesPerSide = 360.f / static_cast<float>( SPHERE_GIMBAL_NUM_SIDES );
+	for ( unsigned int sideIndex = 0; sideIndex <= SPHERE_GIMBAL_NUM_SIDES; sideIndex++ )
 	{
-		DebugRenderCommand* currentCommand = *commandIter;
+		s_sphereGimbalCosines[ sideIndex ] = CosDegrees( degreesPerSide * sideIndex );
+		s_sphereGimbalSines[ sideIndex ] = SinDegrees( degreesPerSide * sideIndex );
+	}
+}
 
-		if ( currentCommand != nullptr ) //Expire after draw or 1-frame commands wouldn't show.
-		{
-			commandIter = g_theDebugRenderCommands->erase( commandIter );
 
-			delete currentCommand;
-			currentCommand = nullptr;
-		}
-		else ++commandIter;
+//--------------------------------------------------------------------------------------------------------------
+void ShutdownDebugCommands()
+{
+	s_haveDebugCommandsShutDown = true;
+	s_threadQueuesGeneration++;
+	DebugCommandThreadQueue* queue = s_threadQueues.exchange( nullptr );
+	while ( queue != nullptr )
+	{
+		DebugCommandThreadQueue* next = queue->next;
+		delete queue;
+		queue = next;
 	}
+
+	s_liveCommands = DebugCommandPools();
+	for ( DebugRenderPassStreams& streams : s_passStreams )
+		streams = DebugRenderPassStreams();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderThenExpireDebugCommands3D() //Handles the depth modes.
+{
+	CollectThreadQueues();
+	BuildPassStreams();
+
+	DrawPass( DEBUG_RENDER_PASS_DUAL_HIDDEN );
+	DrawPass( DEBUG_RENDER_PASS_DEPTH_ON );
+	DrawPass( DEBUG_RENDER_PASS_DEPTH_OFF );
+
+	s_liveCommands.RemoveExpired(); //Expire after draw or 1-frame commands wouldn't show.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void UpdateDebugCommands( float deltaSeconds )
+{
+	CollectThreadQueues();
+	s_liveCommands.Update( deltaSeconds );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ClearDebugCommands() //Else program could shutdown before all commands expire.
+{
+	CollectThreadQueues(); //Drops whatever's queued, too.
+	s_liveCommands.Clear();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AddDebugRenderPoint( const Vector3f& position, float secondsToLive, DepthMode depthMode, const Rgba& color, float lineThickness, float sizeScalar /*= .1f*/ )
+{
+	DebugCommandThreadQueue* queue = GetThreadQueue();
+	unsigned int poolIndex;
+	BeginQueueing( queue, poolIndex ).points.Add( { position, sizeScalar }, secondsToLive, depthMode, color, lineThickness );
+	EndQueueing( queue, poolIndex );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AddDebugRenderLine( const Vector3f& startPos, const Vector3f& endPos, float secondsToLive, DepthMode depthMode, const Rgba& color, float lineThickness )
+{
+	DebugCommandThreadQueue* queue = GetThreadQueue();
+	unsigned int poolIndex;
+	BeginQueueing( queue, poolIndex ).lines.Add( { startPos, endPos }, secondsToLive, depthMode, color, lineThickness );
+	EndQueueing( queue, poolIndex );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-void AddDebugRenderCommand( DebugRenderCommand* newCommand )
+void AddDebugRenderArrow( const Vector3f& startPos, const Vector3f& endPos, float secondsToLive, DepthMode depthMode, const Rgba& color, float lineThickness )
 {
-	g_theDebugRenderCommands->push_back( newCommand );
+	DebugCommandThreadQueue* queue = GetThreadQueue();
+	unsigned int poolIndex;
+	BeginQueueing( queue, poolIndex ).arrows.Add( { startPos, endPos }, secondsToLive, depthMode, color, lineThickness );
+	EndQueueing( queue, poolIndex );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AddDebugRenderAABB3( const AABB3f& bounds, bool drawFilled, float secondsToLive, DepthMode depthMode, float lineThickness, const Rgba& edgeColor, const Rgba& fillColor )
+{
+	DebugCommandThreadQueue* queue = GetThreadQueue();
+	unsigned int poolIndex;
+	BeginQueueing( queue, poolIndex ).aabbs.Add( { bounds, edgeColor, drawFilled }, secondsToLive, depthMode, fillColor, lineThickness );
+	EndQueueing( queue, poolIndex );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AddDebugRenderSphere( const Vector3f& centerPos, float radius, float secondsToLive, DepthMode depthMode, const Rgba& color, float lineThickness )
+{
+	DebugCommandThreadQueue* queue = GetThreadQueue();
+	unsigned int poolIndex;
+	BeginQueueing( queue, poolIndex ).spheres.Add( { centerPos, radius }, secondsToLive, depthMode, color, lineThickness );
+	EndQueueing( queue, poolIndex );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AddDebugRenderBasis( const Vector3f& originPos, float axisLength, bool showZ, float secondsToLive, DepthMode depthMode, float lineThickness )
+{
+	DebugCommandThreadQueue* queue = GetThreadQueue();
+	unsigned int poolIndex;
+	BeginQueueing( queue, poolIndex ).bases.Add( { originPos, axisLength, showZ }, secondsToLive, depthMode, Rgba::WHITE, lineThickness );
+	EndQueueing( queue, poolIndex );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void AddDebugRenderText( const Vector3f& lowerLeftPos, const char* text, float secondsToLive, DepthMode depthMode, const Rgba& color, float scale /*= .25f*/,
+						 const Vector3f& textPlaneUpDir /*= Vector3f::UNIT_Z*/, const Vector3f& textPlaneRightDir /*= Vector3f( 0.f, -1.f, 0.f )*/ )
+{
+	DebugText debugText;
+	debugText.lowerLeftPos = lowerLeftPos;
+	debugText.textPlaneUpDir = textPlaneUpDir;
+	debugText.textPlaneRightDir = textPlaneRightDir;
+	debugText.scale = scale;
+
+	size_t textLength = GetMin( strlen( text ), (size_t)( DEBUG_TEXT_MAX_LENGTH - 1 ) );
+	memcpy( debugText.text, text, textLength );
+	debugText.text[ textLength ] = '\0';
+
+	DebugCommandThreadQueue* queue = GetThreadQueue();
+	unsigned int poolIndex;
+	BeginQueueing( queue, poolIndex ).texts.Add( debugText, secondsToLive, depthMode, color, 1.f );
+	EndQueueing( queue, poolIndex );
 }
 
 
@@ -160,3 +693,95 @@ void DebugRenderClearCommands( Command& /*args*/ )
 {
 	ClearDebugCommands();
 }
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void AddBenchmarkCommands( unsigned int firstCommand, unsigned int numCommands, float secondsToLive )
+{
+	//A 100-wide grid of unit cells, cycling through the command types, like a scene full of bullets and their hit boxes.
+	for ( unsigned int commandIndex = firstCommand; commandIndex < firstCommand + numCommands; commandIndex++ )
+	{
+		Vector3f cellPos = Vector3f( static_cast<float>( commandIndex % 100 ), static_cast<float>( ( commandIndex / 100 ) % 100 ), static_cast<float>( commandIndex / 10000 ) );
+		DepthMode depthMode = (DepthMode)( commandIndex % NUM_DEPTH_MODES );
+		switch ( commandIndex % 5 )
+		{
+		case 0: AddDebugRenderAABB3( AABB3f( cellPos, cellPos + Vector3f( .5f, .5f, .5f ) ), true, secondsToLive, depthMode, 1.f, Rgba::WHITE, Rgba::GRAY ); break;
+		case 1: AddDebugRenderLine( cellPos, cellPos + Vector3f( .5f, 0.f, .5f ), secondsToLive, depthMode, Rgba::GREEN, 1.f ); break;
+		case 2: AddDebugRenderPoint( cellPos, secondsToLive, depthMode, Rgba::RED, 1.f ); break;
+		case 3: AddDebugRenderSphere( cellPos, .25f, secondsToLive, depthMode, Rgba::BLUE, 1.f ); break;
+		case 4: AddDebugRenderArrow( cellPos, cellPos + Vector3f( 0.f, .5f, .5f ), secondsToLive, depthMode, Rgba::WHITE, 2.f ); break;
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void AddBenchmarkCommandsJob( Job* job )
+{
+	unsigned int firstCommand = job->Read<unsigned int>();
+	unsigned int numCommands = job->Read<unsigned int>();
+	float secondsToLive = job->Read<float>();
+
+	AddBenchmarkCommands( firstCommand, numCommands, secondsToLive );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DebugRenderBenchmark( Command& args )
+{
+	int numCommands;
+	float secondsToLive;
+	args.GetNextInt( &numCommands, 100000 );
+	args.GetNextFloat( &secondsToLive, 5.f );
+	if ( numCommands <= 0 )
+	{
+		g_theConsole->Printf( "DebugRenderBenchmark: numCommands must be positive." );
+		return;
+	}
+
+	//Adding from workers exercises the per-thread queues, and leaves the commands up to be looked at.
+	JobSystem* jobSystem = JobSystem::Instance();
+	unsigned int numJobs = jobSystem->IsRunning() ? NUM_BENCHMARK_JOBS : 1;
+	unsigned int commandsPerJob = ( numCommands + numJobs - 1 ) / numJobs;
+	double addStartSeconds = GetCurrentTimeSeconds();
+	if ( numJobs == 1 )
+	{
+		AddBenchmarkCommands( 0, numCommands, secondsToLive );
+	}
+	else
+	{
+		std::vector< Job* > jobs;
+		for ( unsigned int firstCommand = 0; firstCommand < (unsigned int)numCommands; firstCommand += commandsPerJob )
+		{
+			Job* job = jobSystem->CreateJob( JOB_CATEGORY_GENERIC, AddBenchmarkCommandsJob );
+			job->Write<unsigned int>( firstCommand );
+			job->Write<unsigned int>( GetMin( commandsPerJob, (unsigned int)numCommands - firstCommand ) );
+			job->Write<float>( secondsToLive );
+			jobSystem->DispatchJob( job );
+			jobs.push_back( job );
+		}
+		jobSystem->WaitOnJobsForCompletion( jobs );
+	}
+	double addSeconds = GetCurrentTimeSeconds() - addStartSeconds;
+
+	double collectStartSeconds = GetCurrentTimeSeconds();
+	CollectThreadQueues();
+	double buildStartSeconds = GetCurrentTimeSeconds();
+	unsigned int numDraws = BuildPassStreams();
+	double buildEndSeconds = GetCurrentTimeSeconds();
+
+	unsigned int numVertices = 0;
+	for ( const DebugRenderPassStreams& streams : s_passStreams )
+	{
+		numVertices += streams.triangleVertices.size();
+		for ( unsigned int widthIndex = 0; widthIndex < streams.numLineWidths; widthIndex++ )
+			numVertices += streams.lineStreams[ widthIndex ].vertices.size();
+	}
+
+	g_theConsole->Printf( "DebugRenderBenchmark: %d commands added from %u thread(s) in %.3f ms (%.1f ns per command).",
+						  numCommands, numJobs, addSeconds * 1000.0, ( addSeconds * 1000000000.0 ) / numCommands );
+	g_theConsole->Printf( "DebugRenderBenchmark: collected in %.3f ms, batched into %u vertices in %.3f ms.",
+						  ( buildStartSeconds - collectStartSeconds ) * 1000.0, numVertices, ( buildEndSeconds - buildStartSeconds ) * 1000.0 );
+	g_theConsole->Printf( "DebugRenderBenchmark: %u live commands draw in %u batched draws, where one draw per command would take %u or more.",
+						  s_liveCommands.GetNumCommands(), numDraws, s_liveCommands.GetNumCommands() );
+}
@@ -5,29 +5,20 @@
 #include "Engine/Math/AABB3.hpp"
 #include "Engine/Math/Vector3.hpp"
 #include "Engine/Core/Command.hpp"
-#include "Engine/Memory/UntrackedAllocator.hpp"
-#include <list>
 
 
 //-----------------------------------------------------------------------------
-struct DebugRenderCommand;
-//extern std::list< DebugRenderCommand*, UntrackedAllocator<DebugRenderCommand*> >* g_theDebugRenderCommands; //Because these are frequently deleted at random upon expiration.
-extern std::list< DebugRenderCommand* >* g_theDebugRenderCommands; //Because these are frequently deleted at random upon expiration.
+//Debug draws are stored by type in struct-of-arrays pools that keep their capacity, so adding and expiring commands
+//doesn't allocate once the pools have grown to a scene's usual load. At render, every line-like command (points, lines,
+//arrows, AABB edges, sphere gimbals, bases) is expanded into one line stream per depth pass and filled AABBs into one
+//triangle stream, so a frame of debug draws costs a handful of draw calls rather than one or more per command.
+//
+//The Add* functions may be called from any thread, JobSystem workers included: each thread queues into its own
+//buffers without locking, and the main thread collects them in UpdateDebugCommands and RenderThenExpireDebugCommands3D.
 
 
 //-----------------------------------------------------------------------------
-void RenderThenExpireDebugCommands3D();
-void UpdateDebugCommands( float deltaSeconds );
-void ClearDebugCommands();
-void AddDebugRenderCommand( DebugRenderCommand* newCommand );
-
-
-//-----------------------------------------------------------------------------
-void DebugRenderClearCommands( Command& /*args*/ );
-
-
-//-----------------------------------------------------------------------------
-enum DepthMode { 
+enum DepthMode {
 	DEPTH_TEST_ON,
 	DEPTH_TEST_OFF,
 	DEPTH_TEST_DUAL, //Drawn once on (brighter/bigger), once off (fainter/smaller).
@@ -36,142 +27,25 @@ enum DepthMode {
 
 
 //-----------------------------------------------------------------------------
-struct DebugRenderCommand
-{
-	Rgba m_color;
-	float m_secondsToLive;
-	DepthMode m_depthMode;
-	float m_lineThickness;
-
-	DebugRenderCommand( float secondsToLive = 0.f, 
-				   DepthMode depthMode = DEPTH_TEST_ON, 
-				   const Rgba& color = Rgba::WHITE,
-				   float lineThickness = 1.f )
-		: m_color( color )
-		, m_secondsToLive( secondsToLive )
-		, m_depthMode( depthMode ) 
-		, m_lineThickness( lineThickness )
-	{
-	}
-
-	bool IsExpired() { return m_secondsToLive <= 0.f; }
-	void Update( float deltaSeconds ) { m_secondsToLive -= deltaSeconds; }
-	void virtual Render() = 0;
-};
-
-//-----------------------------------------------------------------------------
-struct DebugRenderCommandPoint : public DebugRenderCommand
-{
-	Vector3f m_position;
-	float m_sizeScalar;
-
-	DebugRenderCommandPoint( const Vector3f& position, 
-						float secondsToLive, DepthMode depthMode, const Rgba& color, float lineThickness, float sizeScalar = .1f )
-		: DebugRenderCommand( secondsToLive, depthMode, color, lineThickness )
-		, m_position( position )
-		, m_sizeScalar( sizeScalar )
-	{
-	}
-
-	void Render() override;
-};
-
-
-//-----------------------------------------------------------------------------
-struct DebugRenderCommandLine : public DebugRenderCommand
-{
-	Vector3f m_startPos;
-	Vector3f m_endPos;
-
-	DebugRenderCommandLine( const Vector3f& startPos,
-					   const Vector3f& endPos,
-					   float secondsToLive, DepthMode depthMode, const Rgba& color, float lineThickness )
-		: DebugRenderCommand( secondsToLive, depthMode, color, lineThickness )
-		, m_startPos( startPos )
-		, m_endPos( endPos ) 
-	{
-	}
-
-	void Render() override;
-};
-
-
-//-----------------------------------------------------------------------------
-struct DebugRenderCommandArrow : public DebugRenderCommand
-{
-	Vector3f m_startPos;
-	Vector3f m_endPos;
-
-	DebugRenderCommandArrow( const Vector3f& startPos,
-						const Vector3f& endPos,
-						float secondsToLive, DepthMode depthMode, const Rgba& color, float lineThickness )
-		: DebugRenderCommand( secondsToLive, depthMode, color, lineThickness )
-		, m_startPos( startPos )
-		, m_endPos( endPos ) 
-	{
-	}
-
-	void Render() override;
-};
-
-
-//-----------------------------------------------------------------------------
-struct DebugRenderCommandAABB3 : public DebugRenderCommand
-{
-	AABB3f m_bounds;
-	Rgba m_edgeColor;
-	bool m_drawFilled;
-
-	DebugRenderCommandAABB3( const AABB3f& bounds,
-						bool drawFilled,
-						float secondsToLive, DepthMode depthMode, float lineThickness, const Rgba& edgeColor, const Rgba& fillColor )
-		: DebugRenderCommand( secondsToLive, depthMode, fillColor, lineThickness )
-		, m_bounds( bounds )
-		, m_edgeColor( edgeColor )
-		, m_drawFilled( drawFilled )
-	{
-	}
-
-	void Render() override;
-};
+void StartupDebugCommands();
+void ShutdownDebugCommands(); //No Add* calls from any thread after this.
+void RenderThenExpireDebugCommands3D();
+void UpdateDebugCommands( float deltaSeconds );
+void ClearDebugCommands();
 
 
 //-----------------------------------------------------------------------------
-struct DebugRenderCommandSphere : public DebugRenderCommand
-{
-	Vector3f m_centerPos;
-	float m_radius;
-
-	DebugRenderCommandSphere( const Vector3f& centerPos,
-						 float radius,
-						 float secondsToLive, DepthMode depthMode, const Rgba& color, float lineThickness )
-		: DebugRenderCommand( secondsToLive, depthMode, color, lineThickness )
-		, m_centerPos( centerPos )
-		, m_radius( radius )
-	{
-	}
-
-	void Render() override;
-};
+//A secondsToLive of 0 draws for one frame. Commands expire after their draw, so they always show at least once.
+void AddDebugRenderPoint( const Vector3f& position, float secondsToLive, DepthMode depthMode, const Rgba& color, float lineThickness, float sizeScalar = .1f );
+void AddDebugRenderLine( const Vector3f& startPos, const Vector3f& endPos, float secondsToLive, DepthMode depthMode, const Rgba& color, float lineThickness );
+void AddDebugRenderArrow( const Vector3f& startPos, const Vector3f& endPos, float secondsToLive, DepthMode depthMode, const Rgba& color, float lineThickness );
+void AddDebugRenderAABB3( const AABB3f& bounds, bool drawFilled, float secondsToLive, DepthMode depthMode, float lineThickness, const Rgba& edgeColor, const Rgba& fillColor );
+void AddDebugRenderSphere( const Vector3f& centerPos, float radius, float secondsToLive, DepthMode depthMode, const Rgba& color, float lineThickness );
+void AddDebugRenderBasis( const Vector3f& originPos, float axisLength, bool showZ, float secondsToLive, DepthMode depthMode, float lineThickness );
+void AddDebugRenderText( const Vector3f& lowerLeftPos, const char* text, float secondsToLive, DepthMode depthMode, const Rgba& color, float scale = .25f,
+						 const Vector3f& textPlaneUpDir = Vector3f::UNIT_Z, const Vector3f& textPlaneRightDir = Vector3f( 0.f, -1.f, 0.f ) ); //Defaults face a camera at zero yaw. Text past 63 chars is cut.
 
 
 //-----------------------------------------------------------------------------
-struct DebugRenderCommandBasis : public DebugRenderCommand
-{
-	Vector3f m_originPos;
-	float m_axisLength;
-	bool m_showZ;
-
-	DebugRenderCommandBasis( const Vector3f& originPos,
-						float axisLength,
-						bool showZ,
-						float secondsToLive, DepthMode depthMode, float lineThickness )
-		: DebugRenderCommand( secondsToLive, depthMode, Rgba::WHITE, lineThickness )
-		, m_originPos( originPos )
-		, m_axisLength( axisLength )
-		, m_showZ( showZ )
-	{
-	}
-
-	void Render() override;
-};
\ No newline at end of file
+void DebugRenderClearCommands( Command& /*args*/ );
+void DebugRenderBenchmark( Command& args ); //DebugRenderBenchmark [numCommands = 100000] [secondsToLive = 5]: adds from jobs, times the adds and the batching.
@@ -0,0 +1,292 @@
+#include "Engine/Renderer/DynamicResolution.hpp"
+
+
+#include "Engine/EngineCommon.hpp"
+#include "Engine/Renderer/OpenGLExtensions.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/Command.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include <math.h>
+#include <string.h>
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC const float DynamicResolutionController::SCALE_STEP = 1.f / 32.f;
+static const float FRAME_MS_SMOOTHING = .2f; //Weight of each new sample in the running average.
+static const unsigned int MIN_SAMPLES_BETWEEN_CHANGES = 8;
+static const float OVER_TARGET_TOLERANCE = .02f; //How far over the target still counts as noise, not a reason to scale down.
+static const float UNDER_TARGET_TOLERANCE = .1f; //How far under the target it must be before trying a step up.
+
+
+//--------------------------------------------------------------------------------------------------------------
+static float QuantizeScaleDown( float scale )
+{
+	return floorf( ( scale / DynamicResolutionController::SCALE_STEP ) + .001f ) * DynamicResolutionController::SCALE_STEP;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+DynamicResolutionController::DynamicResolutionController( float targetFrameMs, float minScale, float maxScale )
+	: m_targetFrameMs( targetFrameMs )
+	, m_minScale( minScale )
+	, m_maxScale( maxScale )
+	, m_scale( maxScale )
+	, m_isEnabled( false )
+	, m_smoothedFrameMs( 0.f )
+	, m_numSamplesSinceChange( 0 )
+	, m_numScaleChanges( 0 )
+	, m_numTimerFramesIssued( 0 )
+	, m_numTimerFramesRead( 0 )
+	, m_isTimingFrame( false )
+	, m_lastRenderedScale( 1.f )
+{
+	memset( m_timerQueryIDs, 0, sizeof( m_timerQueryIDs ) );
+	SetScaleLimits( minScale, maxScale );
+	ResetScale( maxScale );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+DynamicResolutionController::~DynamicResolutionController()
+{
+	if ( m_timerQueryIDs[ 0 ][ 0 ] != 0 )
+		glDeleteQueries( NUM_TIMER_QUERY_FRAMES * 2, &m_timerQueryIDs[ 0 ][ 0 ] );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicResolutionController::SetEnabled( bool isEnabled )
+{
+	if ( isEnabled == m_isEnabled )
+		return;
+
+	m_isEnabled = isEnabled;
+	ResetScale( m_maxScale ); //Start over from full detail, whichever way it switched.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicResolutionController::SetScaleLimits( float minScale, float maxScale )
+{
+	m_minScale = Clamp( QuantizeScaleDown( minScale ), SCALE_STEP, 1.f );
+	m_maxScale = Clamp( QuantizeScaleDown( maxScale ), m_minScale, 1.f );
+	m_scale = Clamp( m_scale, m_minScale, m_maxScale );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicResolutionController::ResetScale( float scale )
+{
+	m_scale = Clamp( QuantizeScaleDown( scale ), m_minScale, m_maxScale );
+	m_numSamplesSinceChange = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool DynamicResolutionController::IsUsingGpuTimer() const
+{
+	return ( glQueryCounter != nullptr ) && ( glGetQueryObjectui64v != nullptr );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicResolutionController::BeginGpuTiming( float renderedScale )
+{
+	m_lastRenderedScale = renderedScale;
+	if ( !IsUsingGpuTimer() )
+		return;
+
+	if ( m_timerQueryIDs[ 0 ][ 0 ] == 0 )
+		glGenQueries( NUM_TIMER_QUERY_FRAMES * 2, &m_timerQueryIDs[ 0 ][ 0 ] );
+
+	//All slots still waiting on the GPU: skip timing this frame rather than reuse a query in flight.
+	m_isTimingFrame = ( m_numTimerFramesIssued - m_numTimerFramesRead ) < NUM_TIMER_QUERY_FRAMES;
+	if ( !m_isTimingFrame )
+		return;
+
+	unsigned int slot = m_numTimerFramesIssued % NUM_TIMER_QUERY_FRAMES;
+	glQueryCounter( m_timerQueryIDs[ slot ][ 0 ], GL_TIMESTAMP );
+	m_timerQueryScales[ slot ] = renderedScale;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicResolutionController::EndGpuTiming()
+{
+	if ( !m_isTimingFrame )
+		return;
+
+	unsigned int slot = m_numTimerFramesIssued % NUM_TIMER_QUERY_FRAMES;
+	glQueryCounter( m_timerQueryIDs[ slot ][ 1 ], GL_TIMESTAMP );
+	++m_numTimerFramesIssued;
+	m_isTimingFrame = false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicResolutionController::Update( float deltaSeconds )
+{
+	if ( !IsUsingGpuTimer() )
+	{
+		AddFrameTimeSample( deltaSeconds * 1000.f, m_lastRenderedScale );
+		return;
+	}
+
+	//Oldest first. Results come back in order, so the first one not ready means none after it are either.
+	while ( m_numTimerFramesRead < m_numTimerFramesIssued )
+	{
+		unsigned int slot = m_numTimerFramesRead % NUM_TIMER_QUERY_FRAMES;
+
+		GLint isAvailable = GL_FALSE;
+		glGetQueryObjectiv( m_timerQueryIDs[ slot ][ 1 ], GL_QUERY_RESULT_AVAILABLE, &isAvailable );
+		if ( isAvailable == GL_FALSE )
+			break;
+
+		GLuint64 beginNanoseconds = 0;
+		GLuint64 endNanoseconds = 0;
+		glGetQueryObjectui64v( m_timerQueryIDs[ slot ][ 0 ], GL_QUERY_RESULT, &beginNanoseconds );
+		glGetQueryObjectui64v( m_timerQueryIDs[ slot ][ 1 ], GL_QUERY_RESULT, &endNanoseconds );
+		++m_numTimerFramesRead;
+
+		float frameMs = ( endNanoseconds > beginNanoseconds ) ? static_cast<float>( endNanoseconds - beginNanoseconds ) / 1000000.f : 0.f;
+		AddFrameTimeSample( frameMs, m_timerQueryScales[ slot ] );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicResolutionController::AddFrameTimeSample( float frameMs, float scaleWhenMeasured )
+{
+	if ( scaleWhenMeasured != GetScale() )
+		return; //Rendered before the last change, or at a scale the caller forced: says nothing about the current scale.
+
+	if ( m_numSamplesSinceChange == 0 )
+		m_smoothedFrameMs = frameMs;
+	else
+		m_smoothedFrameMs += FRAME_MS_SMOOTHING * ( frameMs - m_smoothedFrameMs );
+	++m_numSamplesSinceChange;
+
+	if ( !m_isEnabled || ( m_numSamplesSinceChange < MIN_SAMPLES_BETWEEN_CHANGES ) )
+		return;
+
+	//Pixels scale with the square of the scale, so this is where cost would meet the target if pixels were all of it.
+	float desiredScale = ( m_smoothedFrameMs > 0.f ) ? ( m_scale * sqrtf( m_targetFrameMs / m_smoothedFrameMs ) ) : m_maxScale;
+
+	float newScale = m_scale;
+	if ( m_smoothedFrameMs > ( m_targetFrameMs * ( 1.f + OVER_TARGET_TOLERANCE ) ) )
+		newScale = GetMin( QuantizeScaleDown( desiredScale ), m_scale - SCALE_STEP );
+	else if ( m_smoothedFrameMs < ( m_targetFrameMs * ( 1.f - UNDER_TARGET_TOLERANCE ) ) )
+		newScale = GetMax( QuantizeScaleDown( desiredScale ), m_scale );
+	newScale = Clamp( newScale, m_minScale, m_maxScale );
+
+	if ( newScale == m_scale )
+		return;
+
+	m_scale = newScale;
+	m_numSamplesSinceChange = 0;
+	++m_numScaleChanges;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct SimulatedGpuCost
+{
+	float CalcFrameMs( float scale ) const { return fixedMs + ( fullScalePixelMs * scale * scale ); }
+
+	float fixedMs;
+	float fullScalePixelMs;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool RunDynamicResolutionPhase( DynamicResolutionController& controller, const char* phaseName, const SimulatedGpuCost& cost, bool isForcedToFullScale, unsigned int& noiseState )
+{
+	const unsigned int NUM_FRAMES = 600;
+	const unsigned int LATENCY_FRAMES = 3; //Like timer queries read back a few frames late.
+	const float NOISE_FRACTION = .03f;
+
+	float pendingMs[ LATENCY_FRAMES ];
+	float pendingScales[ LATENCY_FRAMES ];
+	unsigned int numChangesAtStart = controller.GetNumScaleChanges();
+	unsigned int numChangesAtHalf = numChangesAtStart;
+	unsigned int lastChangeFrame = 0;
+	float scaleAtStart = controller.GetScale();
+
+	for ( unsigned int frameIndex = 0; frameIndex < NUM_FRAMES; frameIndex++ )
+	{
+		if ( frameIndex == NUM_FRAMES / 2 )
+			numChangesAtHalf = controller.GetNumScaleChanges();
+
+		unsigned int slot = frameIndex % LATENCY_FRAMES;
+		if ( frameIndex >= LATENCY_FRAMES )
+		{
+			unsigned int numChangesBefore = controller.GetNumScaleChanges();
+			controller.AddFrameTimeSample( pendingMs[ slot ], pendingScales[ slot ] );
+			if ( controller.GetNumScaleChanges() != numChangesBefore )
+				lastChangeFrame = frameIndex;
+		}
+
+		noiseState = ( noiseState * 1664525u ) + 1013904223u;
+		float noise = ( ( ( noiseState >> 8 ) & 0xFFFF ) / 32767.5f ) - 1.f;
+		pendingScales[ slot ] = isForcedToFullScale ? 1.f : controller.GetScale(); //As TheRenderer does while an effect reads depth.
+		pendingMs[ slot ] = cost.CalcFrameMs( pendingScales[ slot ] ) * ( 1.f + ( noise * NOISE_FRACTION ) );
+	}
+
+	//Settled means it stopped moving, and at a scale that's either within budget but not needlessly low, or pinned at a limit.
+	float targetMs = controller.GetTargetFrameMs();
+	float finalScale = controller.GetScale();
+	float settledMs = cost.CalcFrameMs( isForcedToFullScale ? 1.f : finalScale );
+	unsigned int numLateChanges = controller.GetNumScaleChanges() - numChangesAtHalf;
+	bool isWithinBudget = ( settledMs <= targetMs * 1.05f ) || ( finalScale == controller.GetMinScale() );
+	bool isNotWasteful = ( settledMs >= targetMs * .8f ) || ( finalScale == controller.GetMaxScale() );
+	bool didPass = ( numLateChanges == 0 ) && isWithinBudget && isNotWasteful;
+
+	//Forced scale samples say nothing about the controller's own scale, so it must hold it until they stop.
+	if ( isForcedToFullScale )
+		didPass = ( controller.GetNumScaleChanges() == numChangesAtStart ) && ( finalScale == scaleAtStart );
+
+	g_theConsole->Printf( "  %s: full scale %.2f ms -> scale %.3f, %.2f ms, %u changes, last at frame %u, %u in the last %u frames: %s",
+						  phaseName, cost.CalcFrameMs( 1.f ), finalScale, settledMs, controller.GetNumScaleChanges() - numChangesAtStart,
+						  lastChangeFrame, numLateChanges, NUM_FRAMES / 2, didPass ? "PASS" : "FAIL" );
+	return didPass;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool RunDynamicResolutionTest( float targetMs )
+{
+	//Scale limits of .5 to 1, so the heavy phase can't fit and must pin at .5.
+	DynamicResolutionController controller( targetMs, .5f, 1.f );
+	controller.SetEnabled( true );
+	unsigned int noiseState = 12345;
+
+	SimulatedGpuCost overBudget = { targetMs * .25f, targetMs * 1.2f };
+	SimulatedGpuCost lighter = { targetMs * .25f, targetMs * .6f };
+	SimulatedGpuCost underBudget = { targetMs * .25f, targetMs * .5f };
+	SimulatedGpuCost heavy = { targetMs * .25f, targetMs * 4.f };
+
+	g_theConsole->Printf( "DynamicResolutionTest: target %.2f ms, scale .5 to 1 in steps of %.4f, +-3%% noise, 3 frames latency", targetMs, DynamicResolutionController::SCALE_STEP );
+	bool didPass = RunDynamicResolutionPhase( controller, "Over budget", overBudget, false, noiseState );
+	didPass &= RunDynamicResolutionPhase( controller, "Depth effect holds full scale", overBudget, true, noiseState );
+	didPass &= RunDynamicResolutionPhase( controller, "Depth effect removed", overBudget, false, noiseState );
+	didPass &= RunDynamicResolutionPhase( controller, "Load drops", lighter, false, noiseState );
+	didPass &= RunDynamicResolutionPhase( controller, "Load spikes", heavy, false, noiseState );
+	didPass &= RunDynamicResolutionPhase( controller, "Under budget", underBudget, false, noiseState );
+	g_theConsole->Printf( "DynamicResolutionTest: %s", didPass ? "PASS" : "FAIL" );
+	return didPass;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void DynamicResolutionTest( Command& args )
+{
+	float targetMs;
+	args.GetNextFloat( &targetMs, 16.6f );
+	if ( targetMs <= 0.f )
+	{
+		g_theConsole->Printf( "Usage: DynamicResolutionTest [targetMs > 0, default 16.6]" );
+		return;
+	}
+
+	RunDynamicResolutionTest( targetMs );
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+
+//-----------------------------------------------------------------------------
+class Command;
+
+
+//-----------------------------------------------------------------------------
+//Picks the fraction of the screen's width and height the scene renders at, so the GPU time of the resolution-dependent
+//work (the scene and its post-process chain) settles at or just under a target. TheRenderer brackets that work with
+//BeginGpuTiming/EndGpuTiming, which read GPU timestamps a few frames late rather than stall. Without timer queries,
+//Update falls back to the whole CPU frame time, which under vsync never reads below the refresh interval.
+//
+//Cost is modeled as proportional to pixel count, i.e. scale squared: each change jumps straight to the largest step
+//predicted to fit the target. Scaling up never predicts past the target, and whatever cost doesn't scale with pixels
+//only makes a step up cheaper than predicted, so the scale doesn't hunt between two steps once it settles. Samples
+//measured before the last change are skipped, and the next change waits for a fresh average.
+class DynamicResolutionController
+{
+public:
+	DynamicResolutionController( float targetFrameMs, float minScale, float maxScale );
+	~DynamicResolutionController();
+	DynamicResolutionController( const DynamicResolutionController& copy ) = delete;
+
+	void SetEnabled( bool isEnabled );
+	bool IsEnabled() const { return m_isEnabled; }
+	void SetTargetFrameMs( float targetFrameMs ) { m_targetFrameMs = targetFrameMs; }
+	float GetTargetFrameMs() const { return m_targetFrameMs; }
+	void SetScaleLimits( float minScale, float maxScale ); //Rounded to SCALE_STEP.
+	float GetMinScale() const { return m_minScale; }
+	float GetMaxScale() const { return m_maxScale; }
+	float GetScale() const { return m_isEnabled ? m_scale : 1.f; }
+	float GetSmoothedFrameMs() const { return m_smoothedFrameMs; }
+	unsigned int GetNumScaleChanges() const { return m_numScaleChanges; }
+	bool IsUsingGpuTimer() const;
+
+	void BeginGpuTiming( float renderedScale ); //The scale the scene really renders at, which the caller may hold at 1 whatever GetScale says.
+	void EndGpuTiming();
+	void Update( float deltaSeconds ); //Once a frame, before the scene: feeds finished GPU timings, or deltaSeconds without them.
+
+	//The control step. Public so it can be driven by a simulated cost, see DynamicResolutionTest.
+	void AddFrameTimeSample( float frameMs, float scaleWhenMeasured );
+	void ResetScale( float scale );
+
+	static const float SCALE_STEP;
+
+
+private:
+	static const unsigned int NUM_TIMER_QUERY_FRAMES = 4; //In flight at once. The GPU rarely runs more than 2-3 frames behind.
+
+	float m_targetFrameMs;
+	float m_minScale;
+	float m_maxScale;
+	float m_scale;
+	bool m_isEnabled;
+
+	float m_smoothedFrameMs;
+	unsigned int m_numSamplesSinceChange; //0 means m_smoothedFrameMs starts over at the next sample.
+	unsigned int m_numScaleChanges;
+
+	unsigned int m_timerQueryIDs[ NUM_TIMER_QUERY_FRAMES ][ 2 ]; //Begin and end timestamps. 0 until the first BeginGpuTiming.
+	float m_timerQueryScales[ NUM_TIMER_QUERY_FRAMES ];
+	unsigned int m_numTimerFramesIssued;
+	unsigned int m_numTimerFramesRead;
+	bool m_isTimingFrame;
+	float m_lastRenderedScale; //For the CPU fallback, which times the whole frame BeginGpuTiming was last called in.
+};
+
+
+//-----------------------------------------------------------------------------
+bool RunDynamicResolutionTest( float targetMs ); //True if every phase settled. Needs no GL, so runs headless.
+void DynamicResolutionTest( Command& args ); //DynamicResolutionTest [targetMs = 16.6]: drives the controller with simulated GPU costs, checks it settles without hunting.
@@ -105,7 +105,7 @@ FrameBuffer::FrameBuffer( unsigned int width, unsigned int height, const std::ve
 	if ( depthStencilFormat != nullptr )
 	{
 		//Make that tex.
-		depthStencilTarget = Texture::CreateTextureFromNoData( "DepthStencilTarget_FBO" + m_fboID, width, height, *depthStencilFormat );
+		depthStencilTarget = Texture::CreateTextureFromNoData( Stringf( "DepthStencilTarget_FBO%d", m_fboID ), width, height, *depthStencilFormat );
 	}
 
 	//-----------------------------------------------------------------------------
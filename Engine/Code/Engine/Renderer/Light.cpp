@@ -285,5 +285,5 @@ void Light::Render() const
 	if ( lightColor == Rgba::BLACK )
 		return; //Not rendering "disabled" lights that aren't contributing to the scene!
 
-	g_theDebugRenderCommands->push_back( new DebugRenderCommandSphere( GetPosition(), s_renderRadius, 0.f, DEPTH_TEST_ON, lightColor, 1.f ) );
+	AddDebugRenderSphere( GetPosition(), s_renderRadius, 0.f, DEPTH_TEST_ON, lightColor, 1.f );
 }
@@ -22,9 +22,10 @@ STATIC MaterialRegistryMap		Material::s_materialRegistry;
 //--------------------------------------------------------------------------------------------------------------
 void Material::Bind()
 {
-	m_shaderProgram->UnbindAnyPrograms();
-	m_shaderProgram->BindTextures(); //MUST PRECEDE BIND PROGRAM.
-	m_shaderProgram->BindProgram(); //MUST NOT PRECEDE BIND TEXTURES.
+	//No unbinding first: RenderStateCache skips whatever the last material already left bound.
+	m_shaderProgram->BindTextures();
+	m_shaderProgram->BindProgram();
+	m_shaderProgram->UploadDirtyUniforms(); //Everything Set* since the last Bind, now that the program is current.
 	m_renderState.Bind();
 }
 
@@ -84,10 +85,10 @@ STATIC Material* Material::CreateOrGetMaterial( const std::string& materialName,
 
 
 //--------------------------------------------------------------------------------------------------------------
-bool Material::BindInputAttribute( const std::string& attributeNameVerbatim, unsigned int count, VertexFieldType engineFieldType, bool normalize, int strideInBytes, int offsetInBytes )
+bool Material::BindInputAttribute( const std::string& attributeNameVerbatim, unsigned int count, VertexFieldType engineFieldType, bool normalize, int strideInBytes, int offsetInBytes, unsigned int instanceDivisor /*= 0*/ )
 {
 //	if ( m_shaderProgram->FindAttribute( attributeNameVerbatim )  )
-	int bindPoint = m_shaderProgram->BindInputAttribute( attributeNameVerbatim, count, engineFieldType, normalize, strideInBytes, offsetInBytes );
+	int bindPoint = m_shaderProgram->BindInputAttribute( attributeNameVerbatim, count, engineFieldType, normalize, strideInBytes, offsetInBytes, instanceDivisor );
 
 	if ( bindPoint < 0 )
 		return false;
@@ -97,6 +98,7 @@ bool Material::BindInputAttribute( const std::string& attributeNameVerbatim, uns
 	switch ( engineFieldType )
 	{
 	case VERTEX_FIELD_TYPE_UNSIGNED_BYTE: //Because it seems it gets converted to a float by the time it reaches the GPU-side.
+	case VERTEX_FIELD_TYPE_UNSIGNED_SHORT:
 	case VERTEX_FIELD_TYPE_FLOAT:
 		switch ( count )
 		{
@@ -167,6 +169,13 @@ void Material::SetMatrix4x4( const std::string& uniformNameVerbatim, bool should
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void Material::SetMatrix4x4( const std::string& uniformNameVerbatim, bool shouldTranspose, const Matrix44* newValue, unsigned int arraySize /* = 1 */ )
+{
+	m_shaderProgram->SetMatrix4x4( uniformNameVerbatim, shouldTranspose, newValue, arraySize );
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 void Material::SetColor( const std::string& uniformNameVerbatim, const Rgba* newValue, unsigned int arraySize /* = 1 */ )
 {
@@ -188,6 +197,83 @@ void Material::SetTexture( const std::string& uniformNameVerbatim, unsigned int
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+unsigned int Material::GetTexture( const std::string& uniformNameVerbatim )
+{
+	return m_shaderProgram->GetTexture( uniformNameVerbatim );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+UniformHandle Material::GetUniformHandle( const std::string& uniformNameVerbatim ) const
+{
+	return m_shaderProgram->GetUniformHandle( uniformNameVerbatim );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Material::SetInt( UniformHandle handle, const int* newValue, unsigned int arraySize /* = 1 */ )
+{
+	m_shaderProgram->SetInt( handle, newValue, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Material::SetFloat( UniformHandle handle, const float* newValue, unsigned int arraySize /* = 1 */ )
+{
+	m_shaderProgram->SetFloat( handle, newValue, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Material::SetVector2( UniformHandle handle, const Vector2f* newValue, unsigned int arraySize /* = 1 */ )
+{
+	m_shaderProgram->SetVector2( handle, newValue, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Material::SetVector3( UniformHandle handle, const Vector3f* newValue, unsigned int arraySize /* = 1 */ )
+{
+	m_shaderProgram->SetVector3( handle, newValue, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Material::SetVector4( UniformHandle handle, const Vector4f* newValue, unsigned int arraySize /* = 1 */ )
+{
+	m_shaderProgram->SetVector4( handle, newValue, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Material::SetMatrix4x4( UniformHandle handle, bool shouldTranspose, const Matrix4x4f* newValue, unsigned int arraySize /* = 1 */ )
+{
+	m_shaderProgram->SetMatrix4x4( handle, shouldTranspose, newValue, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Material::SetMatrix4x4( UniformHandle handle, bool shouldTranspose, const Matrix44* newValue, unsigned int arraySize /* = 1 */ )
+{
+	m_shaderProgram->SetMatrix4x4( handle, shouldTranspose, newValue, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Material::SetColor( UniformHandle handle, const Rgba* newValue, unsigned int arraySize /* = 1 */ )
+{
+	m_shaderProgram->SetColor( handle, newValue, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Material::SetTexture( UniformHandle handle, unsigned int newTextureID )
+{
+	m_shaderProgram->SetTexture( handle, newTextureID );
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 bool Material::RemoveAndDeleteMaterial( const std::string& materialName )
 {
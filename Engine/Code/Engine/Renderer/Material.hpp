@@ -5,12 +5,14 @@
 #include "Engine/Memory/UntrackedAllocator.hpp"
 #include "Engine/Renderer/VertexDefinition.hpp"
 #include "Engine/Renderer/RenderState.hpp"
+#include "Engine/Renderer/ShaderProgram.hpp"
 #include "Engine/EngineCommon.hpp"
 
 
 //--------------------------------------------------------------------------------------------------------------
 class Shader;
 class ShaderProgram;
+class Matrix44;
 class Mesh;
 class Material;
 struct Rgba;
@@ -49,9 +51,10 @@ public:
 	static void DeleteMaterials();
 
 	const std::string& GetName() const { return m_materialName; }
+	ShaderProgram* GetShaderProgram() const { return m_shaderProgram; }
 	void Bind();
 	void Unbind();
-	bool BindInputAttribute( const std::string& attributeNameVerbatim, unsigned int count, VertexFieldType engineFieldType, bool normalize, int strideInBytes, int offsetInBytes );
+	bool BindInputAttribute( const std::string& attributeNameVerbatim, unsigned int count, VertexFieldType engineFieldType, bool normalize, int strideInBytes, int offsetInBytes, unsigned int instanceDivisor = 0 );
 	
 //	const VertexDefinition* GetVertexDefinition() const { return m_vertexDefinition; } //USE THE MESH TO GET THE CURRENT VDEFN INSTEAD.
 
@@ -62,9 +65,23 @@ public:
 	void SetVector3( const std::string& uniformNameVerbatim, const Vector3f* newValue, unsigned int arraySize = 1 );
 	void SetVector4( const std::string& uniformNameVerbatim, const Vector4f* newValue, unsigned int arraySize = 1 );
 	void SetMatrix4x4( const std::string& uniformNameVerbatim, bool shouldTranspose, const Matrix4x4f* newValue, unsigned int arraySize = 1 );
+	void SetMatrix4x4( const std::string& uniformNameVerbatim, bool shouldTranspose, const Matrix44* newValue, unsigned int arraySize = 1 );
 	void SetColor( const std::string& uniformNameVerbatim, const Rgba* newValue, unsigned int arraySize = 1 );
 	void SetSampler( const std::string& uniformNameVerbatim, unsigned int newSamplerID );
 	void SetTexture( const std::string& uniformNameVerbatim, unsigned int newTextureID );
+	unsigned int GetTexture( const std::string& uniformNameVerbatim );
+
+	//Handle versions skip the name lookup, for per-draw sets. Handles come from this material's ShaderProgram.
+	UniformHandle GetUniformHandle( const std::string& uniformNameVerbatim ) const;
+	void SetInt( UniformHandle handle, const int* newValue, unsigned int arraySize = 1 );
+	void SetFloat( UniformHandle handle, const float* newValue, unsigned int arraySize = 1 );
+	void SetVector2( UniformHandle handle, const Vector2f* newValue, unsigned int arraySize = 1 );
+	void SetVector3( UniformHandle handle, const Vector3f* newValue, unsigned int arraySize = 1 );
+	void SetVector4( UniformHandle handle, const Vector4f* newValue, unsigned int arraySize = 1 );
+	void SetMatrix4x4( UniformHandle handle, bool shouldTranspose, const Matrix4x4f* newValue, unsigned int arraySize = 1 );
+	void SetMatrix4x4( UniformHandle handle, bool shouldTranspose, const Matrix44* newValue, unsigned int arraySize = 1 );
+	void SetColor( UniformHandle handle, const Rgba* newValue, unsigned int arraySize = 1 );
+	void SetTexture( UniformHandle handle, unsigned int newTextureID );
 
 
 private:
@@ -34,6 +34,31 @@ struct DrawInstruction //Compare notes.
 };
 
 
+struct MeshLOD //A level of detail: a run of its Mesh's draw instructions, drawn instead of every instruction. See MeshBuilder::BuildLODChain.
+{
+	MeshLOD()
+		: m_firstInstruction( 0 )
+		, m_numInstructions( 0 )
+		, m_numTriangles( 0 )
+		, m_maxError( 0.f )
+	{
+	}
+
+	MeshLOD( unsigned int firstInstruction, unsigned int numInstructions, unsigned int numTriangles, float maxError )
+		: m_firstInstruction( firstInstruction )
+		, m_numInstructions( numInstructions )
+		, m_numTriangles( numTriangles )
+		, m_maxError( maxError )
+	{
+	}
+
+	unsigned int m_firstInstruction;
+	unsigned int m_numInstructions;
+	unsigned int m_numTriangles;
+	float m_maxError; //How far, in model units, the surface may stray from LOD 0's. MeshRenderer::SelectLOD projects it to pixels.
+};
+
+
 class Mesh //Has the VBO/IBOs, not uniforms. The "What" to render, but not the "How" (material) to render.
 {
 public:
@@ -63,11 +88,15 @@ public:
 	size_t GetIndexBufferSize() const { return ( m_indices == nullptr ) ? NULL : m_indices->GetBufferSize(); };
 
 	const std::vector<DrawInstruction>& GetDrawInstructions() const { return m_drawInstructions; }
-	void ClearDrawInstructions() { m_drawInstructions.clear(); }
+	void ClearDrawInstructions() { m_drawInstructions.clear(); m_lods.clear(); }
 	void AddDrawInstruction( const DrawInstruction& command ) { m_drawInstructions.push_back(command); }
 	void AddDrawInstruction( VertexGroupingRule prim, unsigned int startIndex, unsigned int count, bool useIndexBuffer );
 	void AddDrawInstructions( const std::vector< DrawInstruction >& instructions );
 
+	const std::vector<MeshLOD>& GetLODs() const { return m_lods; } //Empty if every instruction is one LOD.
+	unsigned int GetNumLODs() const { return m_lods.empty() ? 1 : m_lods.size(); }
+	void SetLODs( const std::vector<MeshLOD>& lods ) { m_lods = lods; }
+
 	bool UsesIndexBuffer() const { return m_usingIndexBuffer; }
 
 private:
@@ -81,4 +110,5 @@ private:
 	bool m_usingIndexBuffer; //Call glDrawElements instead of glDrawArrays in executing draw instructions.
 
 	std::vector<DrawInstruction> m_drawInstructions;
+	std::vector<MeshLOD> m_lods; //Finest first, ranges into m_drawInstructions.
 };
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "Engine/Renderer/MeshBuilder.hpp"
 #include "Engine/Renderer/Rgba.hpp"
 #include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Renderer/MeshOptimizer.hpp"
+#include "Engine/Renderer/VertexDefinition.hpp"
+#include "Engine/Concurrency/JobUtils.hpp"
+#include "Engine/Time/Time.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Math/Plane.hpp"
 #include "Engine/FileUtils/Writers/BinaryWriter.hpp"
@@ -12,6 +16,8 @@
 
 //--------------------------------------------------------------------------------------------------------------
 MeshBuilder* g_lastLoadedMeshBuilder = nullptr;
+static const unsigned int MIN_INDICES_PER_OPTIMIZATION_JOB = 3 * 4096; //Smaller draws reorder faster than a job round trip.
+static const float MAX_LOD_TRIANGLE_RATIO = .9f; //A LOD keeping more of the last's triangles than this isn't worth its indices.
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -106,6 +112,201 @@ void MeshBuilder::CopyToMesh( Mesh* mesh )
 
 	mesh->ClearDrawInstructions();
 	mesh->AddDrawInstructions( m_currentInstructions );
+	mesh->SetLODs( m_lods );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void OptimizeTriangleOrder( unsigned int* indices, unsigned int numIndices, const Vertex3D_Superset* vertices )
+{
+	MeshOptimizer::OptimizeVertexCache( indices, numIndices );
+	MeshOptimizer::OptimizeOverdraw( indices, numIndices, vertices ); //Only reorders whole cache-ordered clusters, so most of the above's locality survives.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void OptimizeTriangleOrderJob( Job* job )
+{
+	unsigned int* indices = job->Read<unsigned int*>();
+	unsigned int numIndices = job->Read<unsigned int>();
+	const Vertex3D_Superset* vertices = job->Read<const Vertex3D_Superset*>();
+
+	OptimizeTriangleOrder( indices, numIndices, vertices );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool MeshBuilder::Optimize( MeshOptimizationReport* out_report /*= nullptr*/ )
+{
+	for ( const DrawInstruction& instruction : m_currentInstructions )
+	{
+		if ( instruction.m_type != VertexGroupingRule::AS_TRIANGLES )
+		{
+			ERROR_RECOVERABLE( "MeshBuilder::Optimize only handles triangle lists!" );
+			return false;
+		}
+
+		unsigned int bufferSize = instruction.m_usingIndexBuffer ? m_currentIndices.size() : m_currentVertices.size();
+		if ( instruction.m_startIndex + instruction.m_count > bufferSize )
+		{
+			ERROR_RECOVERABLE( "MeshBuilder::Optimize found a draw instruction past the end of its buffer!" );
+			return false;
+		}
+	}
+
+	double startSeconds = GetCurrentTimeSeconds();
+	MeshOptimizationReport report;
+	report.m_before = CalcBufferStats();
+
+	//1. Every draw as an indexed triangle list, so welding can point duplicates' indices at the one vertex kept.
+	std::vector< unsigned int > indices;
+	std::vector< DrawInstruction > instructions;
+	AppendTriangleListIndices( indices, &instructions );
+
+	std::vector< unsigned int > remap( m_currentVertices.size() );
+	unsigned int numVerticesBeforeWelding = m_currentVertices.size();
+	report.m_numVerticesWelded = numVerticesBeforeWelding - MeshOptimizer::WeldVertices( m_currentVertices, remap.data() );
+	for ( unsigned int& index : indices )
+		index = remap[ index ];
+
+	//2, 3. Draws' index ranges don't overlap, so each reorders independently.
+	JobSystem* jobSystem = JobSystem::Instance();
+	std::vector< Job* > jobs;
+	for ( const DrawInstruction& instruction : instructions )
+	{
+		unsigned int* drawIndices = indices.data() + instruction.m_startIndex;
+		if ( !jobSystem->IsRunning() || ( instruction.m_count < MIN_INDICES_PER_OPTIMIZATION_JOB ) )
+		{
+			OptimizeTriangleOrder( drawIndices, instruction.m_count, m_currentVertices.data() );
+			continue;
+		}
+
+		Job* job = jobSystem->CreateJob( JOB_CATEGORY_GENERIC, OptimizeTriangleOrderJob );
+		job->Write<unsigned int*>( drawIndices );
+		job->Write<unsigned int>( instruction.m_count );
+		job->Write<const Vertex3D_Superset*>( m_currentVertices.data() );
+		jobSystem->DispatchJob( job );
+		jobs.push_back( job );
+	}
+	if ( !jobs.empty() )
+		jobSystem->WaitOnJobsForCompletion( jobs );
+
+	//4. Last, as it renumbers vertices in the order the final triangle order first uses them.
+	report.m_numVerticesUnused = MeshOptimizer::OptimizeVertexFetch( m_currentVertices, indices.data(), indices.size() );
+
+	m_currentIndices.swap( indices );
+	m_currentInstructions.swap( instructions );
+	m_usingIndexBuffer = 1;
+
+	report.m_after = CalcBufferStats();
+	report.m_seconds = GetCurrentTimeSeconds() - startSeconds;
+	if ( out_report != nullptr )
+		*out_report = report;
+
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+MeshBufferStats MeshBuilder::CalcBufferStats() const
+{
+	std::vector< unsigned int > drawnIndices;
+	AppendTriangleListIndices( drawnIndices );
+
+	MeshBufferStats stats;
+	stats.m_numVertices = m_currentVertices.size();
+	stats.m_numIndices = m_currentIndices.size();
+	stats.m_numTriangles = drawnIndices.size() / 3;
+	stats.m_numVertexBytes = stats.m_numVertices * Vertex3D_Superset::DEFINITION.GetVertexSize(); //What AddModel uploads, see GetVertexDefinitionFromVertexDataMask().
+	stats.m_numIndexBytes = stats.m_numIndices * sizeof( unsigned int );
+
+	unsigned int numCacheMisses = MeshOptimizer::CountCacheMisses( drawnIndices.data(), drawnIndices.size() );
+	if ( stats.m_numTriangles > 0 )
+		stats.m_acmr = (float)numCacheMisses / (float)stats.m_numTriangles;
+	if ( stats.m_numVertices > 0 )
+		stats.m_atvr = (float)numCacheMisses / (float)stats.m_numVertices;
+
+	return stats;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int MeshBuilder::BuildLODChain( unsigned int maxNumLODs, float triangleRatioPerLOD /*= .5f*/, float maxError /*= INFINITY*/ )
+{
+	if ( !m_lods.empty() )
+	{
+		ERROR_RECOVERABLE( "MeshBuilder::BuildLODChain called on a MeshBuilder that already has LODs!" );
+		return m_lods.size();
+	}
+
+	//Simplifying needs welded, indexed triangle lists, and every LOD reuses LOD 0's vertices, so their order should suit it.
+	if ( !Optimize() )
+		return 1;
+
+	unsigned int numBaseInstructions = m_currentInstructions.size();
+	unsigned int numBaseTriangles = 0;
+	for ( const DrawInstruction& instruction : m_currentInstructions )
+		numBaseTriangles += instruction.m_count / 3;
+	m_lods.push_back( MeshLOD( 0, numBaseInstructions, numBaseTriangles, 0.f ) );
+
+	//Each LOD simplifies LOD 0 rather than the last LOD, so its error is measured against the original surface and not compounded.
+	std::vector< unsigned int > lodIndices;
+	float triangleRatio = 1.f;
+	while ( m_lods.size() < maxNumLODs )
+	{
+		triangleRatio *= triangleRatioPerLOD;
+		MeshLOD lod( m_currentInstructions.size(), numBaseInstructions, 0, 0.f );
+		unsigned int firstLODIndex = m_currentIndices.size();
+		for ( unsigned int instructionIndex = 0; instructionIndex < numBaseInstructions; instructionIndex++ )
+		{
+			const DrawInstruction baseInstruction = m_currentInstructions[ instructionIndex ]; //By value, as the push_back below can reallocate.
+			unsigned int targetNumIndices = (unsigned int)( ( baseInstruction.m_count / 3 ) * triangleRatio ) * 3;
+			float error = MeshOptimizer::Simplify( m_currentIndices.data() + baseInstruction.m_startIndex, baseInstruction.m_count, m_currentVertices.data(), targetNumIndices, maxError, lodIndices );
+			MeshOptimizer::OptimizeVertexCache( lodIndices.data(), lodIndices.size() );
+
+			m_currentInstructions.push_back( DrawInstruction( VertexGroupingRule::AS_TRIANGLES, m_currentIndices.size(), lodIndices.size(), 1 ) );
+			m_currentIndices.insert( m_currentIndices.end(), lodIndices.begin(), lodIndices.end() );
+			lod.m_numTriangles += lodIndices.size() / 3;
+			lod.m_maxError = GetMax( lod.m_maxError, error );
+		}
+
+		//Also where maxError stops the simplifier short.
+		if ( (float)lod.m_numTriangles > (float)m_lods.back().m_numTriangles * MAX_LOD_TRIANGLE_RATIO )
+		{
+			m_currentInstructions.resize( lod.m_firstInstruction );
+			m_currentIndices.resize( firstLODIndex );
+			break;
+		}
+
+		m_lods.push_back( lod );
+	}
+
+	return m_lods.size();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void MeshBuilder::AppendTriangleListIndices( std::vector< unsigned int >& out_indices, std::vector< DrawInstruction >* out_indexedInstructions /*= nullptr*/ ) const
+{
+	for ( const DrawInstruction& instruction : m_currentInstructions )
+	{
+		if ( instruction.m_type != VertexGroupingRule::AS_TRIANGLES )
+			continue;
+
+		unsigned int firstIndex = out_indices.size();
+		if ( instruction.m_usingIndexBuffer )
+		{
+			out_indices.insert( out_indices.end(), m_currentIndices.begin() + instruction.m_startIndex, m_currentIndices.begin() + instruction.m_startIndex + instruction.m_count );
+		}
+		else
+		{
+			for ( unsigned int vertexIndex = instruction.m_startIndex; vertexIndex < instruction.m_startIndex + instruction.m_count; vertexIndex++ )
+				out_indices.push_back( vertexIndex );
+		}
+
+		if ( out_indexedInstructions != nullptr )
+			out_indexedInstructions->push_back( DrawInstruction( VertexGroupingRule::AS_TRIANGLES, firstIndex, instruction.m_count, 1 ) );
+	}
 }
 
 
@@ -374,6 +575,7 @@ bool MeshBuilder::WriteToStream( BinaryWriter& writer ) //Can have a bunch of me
 	didWrite = WriteVertices( writer );
 	didWrite = WriteIndices( writer );
 	didWrite = WriteDrawInstructions( writer );
+	didWrite = WriteLODs( writer );
 
 	return didWrite;
 }
@@ -559,6 +761,23 @@ bool MeshBuilder::WriteDrawInstructions( BinaryWriter& writer )
 	return didWrite;
 }
 
+
+//--------------------------------------------------------------------------------------------------------------
+bool MeshBuilder::WriteLODs( BinaryWriter& writer )
+{
+	bool didWrite = writer.Write<uint32_t>( m_lods.size() );
+
+	for ( const MeshLOD& lod : m_lods )
+	{
+		didWrite = writer.Write<uint32_t>( lod.m_firstInstruction );
+		didWrite = writer.Write<uint32_t>( lod.m_numInstructions );
+		didWrite = writer.Write<uint32_t>( lod.m_numTriangles );
+		didWrite = writer.Write<float>( lod.m_maxError );
+	}
+
+	return didWrite;
+}
+
 //--------------------------------------------------------------------------------------------------------------
 bool MeshBuilder::WriteVertexDataMask( BinaryWriter& writer, uint32_t vertexDataMask )
 {
@@ -730,6 +949,10 @@ bool MeshBuilder::ReadFromStream( BinaryReader& reader )
 	m_currentInstructions.resize( instructionsCount );
 	didRead = ReadDrawInstructions( reader );
 
+	m_lods.clear();
+	if ( fileVersion >= 2 )
+		didRead = ReadLODs( reader );
+
 	return didRead;
 }
 
@@ -919,6 +1142,25 @@ bool MeshBuilder::ReadDrawInstructions( BinaryReader& reader )
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+bool MeshBuilder::ReadLODs( BinaryReader& reader )
+{
+	uint32_t lodsCount = 0;
+	bool didRead = reader.Read<uint32_t>( &lodsCount );
+
+	m_lods.resize( lodsCount );
+	for ( MeshLOD& lod : m_lods )
+	{
+		didRead = reader.Read<uint32_t>( &lod.m_firstInstruction );
+		didRead = reader.Read<uint32_t>( &lod.m_numInstructions );
+		didRead = reader.Read<uint32_t>( &lod.m_numTriangles );
+		didRead = reader.Read<float>( &lod.m_maxError );
+	}
+
+	return didRead;
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 uint32_t MeshBuilder::ReadVertexDataMask( BinaryReader& reader )
 {
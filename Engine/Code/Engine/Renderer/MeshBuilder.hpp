@@ -12,11 +12,14 @@ extern MeshBuilder* g_lastLoadedMeshBuilder; //Used for saving out built meshes.
 //-----------------------------------------------------------------------------
 struct Rgba;
 struct DrawInstruction;
+struct MeshLOD;
 class Mesh;
 class BinaryWriter;
 class BinaryReader;
 class Command;
 class VertexDefinition;
+struct MeshBufferStats;
+struct MeshOptimizationReport;
 
 
 //-----------------------------------------------------------------------------
@@ -64,6 +67,14 @@ public:
 
 	//-----------------------------------------------------------------------------
 	void CopyToMesh( Mesh* mesh );
+	bool Optimize( MeshOptimizationReport* out_report = nullptr ); //Welds, indexes and reorders every draw for the vertex caches and overdraw, see MeshOptimizer. Triangle lists only.
+	MeshBufferStats CalcBufferStats() const; //Of the triangle list draws.
+
+	//Optimizes, then appends coarser copies of every draw made by MeshOptimizer::Simplify, each LOD keeping triangleRatioPerLOD of the last's triangles.
+	//Stops at maxNumLODs (counting the original as LOD 0), at maxError, or once a LOD would barely shrink. Returns the number of LODs made.
+	//Call it last: draws added after belong to no LOD, so a Mesh with LODs won't draw them.
+	unsigned int BuildLODChain( unsigned int maxNumLODs, float triangleRatioPerLOD = .5f, float maxError = INFINITY );
+	const std::vector< MeshLOD >& GetLODs() const { return m_lods; }
 
 	//-----------------------------------------------------------------------------
 	void BuildTriangle( const Vector3f& topLeft, const Vector3f& bottomLeft, const Vector3f& bottomRight ); //BL is (0,0), TR is (1,1).
@@ -101,14 +112,18 @@ private:
 	std::vector< Vertex3D_Superset > m_currentVertices;
 	std::vector< unsigned int > m_currentIndices;
 	std::vector< DrawInstruction > m_currentInstructions;
+	std::vector< MeshLOD > m_lods; //Empty until BuildLODChain.
 
-	static const uint32_t s_FILE_VERSION = 1;
+	static const uint32_t s_FILE_VERSION = 2;
 	bool WriteVertices( BinaryWriter& writer );
 	bool WriteIndices( BinaryWriter& writer );
 	bool WriteDrawInstructions( BinaryWriter& writer );
+	bool WriteLODs( BinaryWriter& writer );
 	bool ReadVertices( BinaryReader& reader );
 	bool ReadIndices( BinaryReader& reader );
 	bool ReadDrawInstructions( BinaryReader& reader );
+	bool ReadLODs( BinaryReader& reader );
+	void AppendTriangleListIndices( std::vector< unsigned int >& out_indices, std::vector< DrawInstruction >* out_indexedInstructions = nullptr ) const; //Non-indexed draws get sequential indices.
 };
 
 
@@ -127,4 +142,7 @@ private:
 		4. Vertices
 		5. Indices
 		6. Draw Instructions
+	v2 adds, after those:
+		7. LOD Count (0 without LODs), then per LOD its first instruction, instruction count, triangle count and max error.
+			v1 files still load, as meshes without LODs.
 */
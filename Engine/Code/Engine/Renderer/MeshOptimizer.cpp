@@ -0,0 +1,990 @@
+#include "Engine/Renderer/MeshOptimizer.hpp"
+
+
+#include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Concurrency/JobUtils.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Error/ErrorWarningAssert.hpp"
+#include <algorithm>
+#include <cmath>
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const unsigned int UNUSED_VERTEX = 0xFFFFFFFF;
+static const unsigned int MIN_VERTICES_PER_HASHING_JOB = 4096;
+static const unsigned int MAX_HASHING_JOBS = 16;
+static const unsigned int FORSYTH_CACHE_SIZE = 32; //Tuned for the scoring below, independent of what the GPU really has.
+static const unsigned int MAX_FORSYTH_VALENCE_SCORES = 64; //Triangles per vertex with a precomputed score, more take the powf.
+static const unsigned int MIN_TRIANGLES_PER_OVERDRAW_CLUSTER = 16;
+static const float OVERDRAW_CLUSTER_ACMR_THRESHOLD = 1.05f; //How much worse than its whole cluster's ACMR a split point can be.
+static const float MIN_COLLAPSE_NORMAL_COSINE = 0.25f; //Collapses turning a triangle past about 75 degrees are folds, rejected like outright flips.
+static const float BORDER_QUADRIC_WEIGHT = 10.f; //Per squared edge length: stiff enough that open edges erode last, as they're the most visible.
+static const unsigned int LOD_TEST_SPHERE_SLICES = 120;
+static const unsigned int LOD_TEST_SPHERE_STACKS = 81; //With the slices, 19200 triangles.
+static const unsigned int LOD_TEST_NUM_LODS = 4;
+static const float LOD_TEST_TRIANGLE_RATIO = .5f;
+static const float LOD_TEST_MAX_SINK_PER_ERROR = 2.f; //Error is an RMS over merged planes, so the worst point may sink a little further.
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Welding compares vertices bitwise, so Vertex3D_Superset can't have padding or the comparison would read garbage.
+static_assert( sizeof( Vertex3D_Superset ) % sizeof( unsigned int ) == 0, "Vertex3D_Superset must be a whole number of words to hash it as such!" );
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline unsigned int HashVertex( const Vertex3D_Superset& vertex )
+{
+	//FNV-1a by word, then a murmur finalizer: FNV alone leaves the low bits, which index the table, poorly mixed.
+	const unsigned int* words = reinterpret_cast<const unsigned int*>( &vertex );
+	unsigned int hash = 2166136261u;
+	for ( unsigned int wordIndex = 0; wordIndex < sizeof( Vertex3D_Superset ) / sizeof( unsigned int ); wordIndex++ )
+		hash = ( hash ^ words[ wordIndex ] ) * 16777619u;
+
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6b;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void HashVertices( const Vertex3D_Superset* vertices, unsigned int numVertices, unsigned int* out_hashes )
+{
+	for ( unsigned int vertexIndex = 0; vertexIndex < numVertices; vertexIndex++ )
+		out_hashes[ vertexIndex ] = HashVertex( vertices[ vertexIndex ] );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void HashVerticesJob( Job* job )
+{
+	const Vertex3D_Superset* vertices = job->Read<const Vertex3D_Superset*>();
+	unsigned int numVertices = job->Read<unsigned int>();
+	unsigned int* out_hashes = job->Read<unsigned int*>();
+
+	HashVertices( vertices, numVertices, out_hashes );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int MeshOptimizer::WeldVertices( std::vector< Vertex3D_Superset >& vertices, unsigned int* out_remap )
+{
+	unsigned int numVertices = vertices.size();
+	if ( numVertices == 0 )
+		return 0;
+
+	//Hashing is the part that reads every byte of every vertex, so it's what gets split across jobs.
+	std::vector< unsigned int > hashes( numVertices );
+	JobSystem* jobSystem = JobSystem::Instance();
+	unsigned int numJobs = GetMin( MAX_HASHING_JOBS, numVertices / MIN_VERTICES_PER_HASHING_JOB );
+	if ( !jobSystem->IsRunning() || ( numJobs < 2 ) )
+	{
+		HashVertices( vertices.data(), numVertices, hashes.data() );
+	}
+	else
+	{
+		std::vector< Job* > jobs;
+		unsigned int verticesPerJob = ( numVertices + numJobs - 1 ) / numJobs;
+		for ( unsigned int firstVertex = 0; firstVertex < numVertices; firstVertex += verticesPerJob )
+		{
+			Job* job = jobSystem->CreateJob( JOB_CATEGORY_GENERIC, HashVerticesJob );
+			job->Write<const Vertex3D_Superset*>( vertices.data() + firstVertex );
+			job->Write<unsigned int>( GetMin( verticesPerJob, numVertices - firstVertex ) );
+			job->Write<unsigned int*>( hashes.data() + firstVertex );
+			jobSystem->DispatchJob( job );
+			jobs.push_back( job );
+		}
+		jobSystem->WaitOnJobsForCompletion( jobs );
+	}
+
+	//Open addressing over the unique vertices so far, compacted into the front of vertices as they're found.
+	//Reading vertices[ vertexIndex ] before writing vertices[ numUniqueVertices ] is safe, as numUniqueVertices <= vertexIndex.
+	unsigned int tableSize = 1;
+	while ( tableSize < numVertices * 2 )
+		tableSize <<= 1;
+	unsigned int tableMask = tableSize - 1;
+	std::vector< unsigned int > table( tableSize, UNUSED_VERTEX );
+	std::vector< unsigned int > uniqueHashes;
+	uniqueHashes.reserve( numVertices );
+
+	unsigned int numUniqueVertices = 0;
+	for ( unsigned int vertexIndex = 0; vertexIndex < numVertices; vertexIndex++ )
+	{
+		unsigned int hash = hashes[ vertexIndex ];
+		unsigned int slot = hash & tableMask;
+		while ( table[ slot ] != UNUSED_VERTEX )
+		{
+			unsigned int candidate = table[ slot ];
+			if ( ( uniqueHashes[ candidate ] == hash ) && ( memcmp( &vertices[ candidate ], &vertices[ vertexIndex ], sizeof( Vertex3D_Superset ) ) == 0 ) )
+				break;
+
+			slot = ( slot + 1 ) & tableMask;
+		}
+
+		if ( table[ slot ] != UNUSED_VERTEX )
+		{
+			out_remap[ vertexIndex ] = table[ slot ];
+			continue;
+		}
+
+		table[ slot ] = numUniqueVertices;
+		uniqueHashes.push_back( hash );
+		vertices[ numUniqueVertices ] = vertices[ vertexIndex ];
+		out_remap[ vertexIndex ] = numUniqueVertices++;
+	}
+
+	vertices.resize( numUniqueVertices );
+	return numUniqueVertices;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline float CalcForsythVertexScore( int cachePosition, unsigned int numTrianglesLeft, const float* cachePositionScores, const float* valenceScores )
+{
+	if ( numTrianglesLeft == 0 )
+		return -1.f;
+
+	float score = ( cachePosition >= 0 ) ? cachePositionScores[ cachePosition ] : 0.f;
+	score += ( numTrianglesLeft < MAX_FORSYTH_VALENCE_SCORES ) ? valenceScores[ numTrianglesLeft ] : ( 2.f * powf( (float)numTrianglesLeft, -0.5f ) );
+	return score;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void MeshOptimizer::OptimizeVertexCache( unsigned int* indices, unsigned int numIndices )
+{
+	//Forsyth, "Linear-Speed Vertex Cache Optimisation": greedily emit the triangle whose vertices score highest,
+	//scoring vertices up by how recently they entered a simulated LRU cache and by how few triangles they have left.
+	unsigned int numTriangles = numIndices / 3;
+	if ( numTriangles < 2 )
+		return;
+
+	//Index relative to this draw's lowest vertex, so the per-vertex arrays are only as big as the range it uses.
+	unsigned int minIndex = *std::min_element( indices, indices + numIndices );
+	unsigned int maxIndex = *std::max_element( indices, indices + numIndices );
+	unsigned int numLocalVertices = maxIndex - minIndex + 1;
+
+	std::vector< unsigned int > localIndices( numIndices );
+	for ( unsigned int index = 0; index < numIndices; index++ )
+		localIndices[ index ] = indices[ index ] - minIndex;
+
+	float cachePositionScores[ FORSYTH_CACHE_SIZE ];
+	for ( unsigned int cachePosition = 0; cachePosition < FORSYTH_CACHE_SIZE; cachePosition++ ) //The last triangle's 3 score the same, so it isn't re-emitted strictly in order.
+		cachePositionScores[ cachePosition ] = ( cachePosition < 3 ) ? 0.75f : powf( 1.f - ( (float)( cachePosition - 3 ) / (float)( FORSYTH_CACHE_SIZE - 3 ) ), 1.5f );
+
+	float valenceScores[ MAX_FORSYTH_VALENCE_SCORES ];
+	for ( unsigned int valence = 1; valence < MAX_FORSYTH_VALENCE_SCORES; valence++ ) //Boosts vertices with few triangles left, to finish them off rather than strand them.
+		valenceScores[ valence ] = 2.f * powf( (float)valence, -0.5f );
+
+	std::vector< unsigned int > numTrianglesLeft( numLocalVertices, 0 );
+	std::vector< int > cachePositions( numLocalVertices, -1 );
+	std::vector< float > vertexScores( numLocalVertices, 0.f );
+	for ( unsigned int index = 0; index < numIndices; index++ )
+		++numTrianglesLeft[ localIndices[ index ] ];
+
+	//Each vertex's unemitted triangles, with the first numTrianglesLeft of its span live.
+	std::vector< unsigned int > firstAdjacentTriangle( numLocalVertices + 1, 0 );
+	for ( unsigned int vertex = 0; vertex < numLocalVertices; vertex++ )
+		firstAdjacentTriangle[ vertex + 1 ] = firstAdjacentTriangle[ vertex ] + numTrianglesLeft[ vertex ];
+	std::vector< unsigned int > adjacentTriangles( numIndices );
+	std::vector< unsigned int > numAdjacentWritten( numLocalVertices, 0 );
+	for ( unsigned int index = 0; index < numIndices; index++ )
+	{
+		unsigned int vertex = localIndices[ index ];
+		adjacentTriangles[ firstAdjacentTriangle[ vertex ] + numAdjacentWritten[ vertex ]++ ] = index / 3;
+	}
+
+	for ( unsigned int vertex = 0; vertex < numLocalVertices; vertex++ )
+		vertexScores[ vertex ] = CalcForsythVertexScore( cachePositions[ vertex ], numTrianglesLeft[ vertex ], cachePositionScores, valenceScores );
+
+	std::vector< unsigned char > isTriangleEmitted( numTriangles, 0 );
+	int bestTriangle = -1;
+	float bestScore = -1.f;
+	for ( unsigned int triangle = 0; triangle < numTriangles; triangle++ )
+	{
+		const unsigned int* corners = &localIndices[ triangle * 3 ];
+		float score = vertexScores[ corners[ 0 ] ] + vertexScores[ corners[ 1 ] ] + vertexScores[ corners[ 2 ] ];
+		if ( score > bestScore )
+		{
+			bestScore = score;
+			bestTriangle = triangle;
+		}
+	}
+
+	unsigned int cache[ FORSYTH_CACHE_SIZE + 3 ];
+	unsigned int cacheCount = 0;
+	unsigned int nextTriangleToScan = 0;
+	unsigned int numIndicesWritten = 0;
+	for ( unsigned int numEmitted = 0; numEmitted < numTriangles; numEmitted++ )
+	{
+		if ( bestTriangle < 0 ) //Nothing in the cache has triangles left, so restart from the first unemitted one.
+		{
+			while ( isTriangleEmitted[ nextTriangleToScan ] )
+				++nextTriangleToScan;
+			bestTriangle = nextTriangleToScan;
+		}
+
+		const unsigned int* corners = &localIndices[ bestTriangle * 3 ];
+		isTriangleEmitted[ bestTriangle ] = 1;
+		for ( unsigned int corner = 0; corner < 3; corner++ )
+		{
+			indices[ numIndicesWritten++ ] = corners[ corner ] + minIndex;
+
+			//Swap-remove it from the vertex's live triangles. Degenerate triangles list a vertex twice, and remove it twice.
+			unsigned int vertex = corners[ corner ];
+			unsigned int* adjacent = &adjacentTriangles[ firstAdjacentTriangle[ vertex ] ];
+			unsigned int numAdjacent = numTrianglesLeft[ vertex ];
+			for ( unsigned int adjacentIndex = 0; adjacentIndex < numAdjacent; adjacentIndex++ )
+			{
+				if ( adjacent[ adjacentIndex ] == (unsigned int)bestTriangle )
+				{
+					adjacent[ adjacentIndex ] = adjacent[ numAdjacent - 1 ];
+					--numTrianglesLeft[ vertex ];
+					break;
+				}
+			}
+		}
+
+		//The emitted triangle's vertices go to the front of the cache, the rest shift back and the overflow falls out.
+		unsigned int newCache[ FORSYTH_CACHE_SIZE + 3 ];
+		unsigned int newCacheCount = 0;
+		for ( unsigned int corner = 0; corner < 3; corner++ )
+			if ( std::find( newCache, newCache + newCacheCount, corners[ corner ] ) == newCache + newCacheCount )
+				newCache[ newCacheCount++ ] = corners[ corner ];
+		for ( unsigned int cacheIndex = 0; cacheIndex < cacheCount; cacheIndex++ )
+			if ( ( cache[ cacheIndex ] != corners[ 0 ] ) && ( cache[ cacheIndex ] != corners[ 1 ] ) && ( cache[ cacheIndex ] != corners[ 2 ] ) )
+				newCache[ newCacheCount++ ] = cache[ cacheIndex ];
+
+		for ( unsigned int cacheIndex = 0; cacheIndex < newCacheCount; cacheIndex++ )
+		{
+			unsigned int vertex = newCache[ cacheIndex ];
+			cachePositions[ vertex ] = ( cacheIndex < FORSYTH_CACHE_SIZE ) ? (int)cacheIndex : -1;
+			vertexScores[ vertex ] = CalcForsythVertexScore( cachePositions[ vertex ], numTrianglesLeft[ vertex ], cachePositionScores, valenceScores );
+		}
+
+		cacheCount = GetMin( newCacheCount, FORSYTH_CACHE_SIZE );
+		memcpy( cache, newCache, cacheCount * sizeof( unsigned int ) );
+
+		//Only triangles touching the cache changed score enough to matter.
+		bestTriangle = -1;
+		bestScore = -1.f;
+		for ( unsigned int cacheIndex = 0; cacheIndex < cacheCount; cacheIndex++ )
+		{
+			unsigned int vertex = cache[ cacheIndex ];
+			const unsigned int* adjacent = &adjacentTriangles[ firstAdjacentTriangle[ vertex ] ];
+			for ( unsigned int adjacentIndex = 0; adjacentIndex < numTrianglesLeft[ vertex ]; adjacentIndex++ )
+			{
+				const unsigned int* adjacentCorners = &localIndices[ adjacent[ adjacentIndex ] * 3 ];
+				float score = vertexScores[ adjacentCorners[ 0 ] ] + vertexScores[ adjacentCorners[ 1 ] ] + vertexScores[ adjacentCorners[ 2 ] ];
+				if ( score > bestScore )
+				{
+					bestScore = score;
+					bestTriangle = adjacent[ adjacentIndex ];
+				}
+			}
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void MeshOptimizer::OptimizeOverdraw( unsigned int* indices, unsigned int numIndices, const Vertex3D_Superset* vertices )
+{
+	//Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw": cut the cache-ordered triangles into clusters
+	//where the cache would be cold anyway, then draw the clusters facing most outward from the mesh's center first, as likely occluders.
+	unsigned int numTriangles = numIndices / 3;
+	if ( numTriangles < MIN_TRIANGLES_PER_OVERDRAW_CLUSTER * 2 )
+		return;
+
+	unsigned int minIndex = *std::min_element( indices, indices + numIndices );
+	unsigned int maxIndex = *std::max_element( indices, indices + numIndices );
+
+	//FIFO cache misses per triangle, timestamped so entering the cache is O(1).
+	std::vector< unsigned int > cacheTimestamps( maxIndex - minIndex + 1, 0 );
+	std::vector< unsigned char > missesPerTriangle( numTriangles );
+	unsigned int timestamp = SIMULATED_CACHE_SIZE + 1;
+	for ( unsigned int triangle = 0; triangle < numTriangles; triangle++ )
+	{
+		unsigned char numMisses = 0;
+		for ( unsigned int corner = 0; corner < 3; corner++ )
+		{
+			unsigned int& vertexTimestamp = cacheTimestamps[ indices[ triangle * 3 + corner ] - minIndex ];
+			if ( timestamp - vertexTimestamp > SIMULATED_CACHE_SIZE )
+			{
+				vertexTimestamp = timestamp++;
+				++numMisses;
+			}
+		}
+		missesPerTriangle[ triangle ] = numMisses;
+	}
+
+	//Hard boundaries miss on all three vertices. Within those, soft boundaries go wherever a cluster started cold is already near the whole
+	//hard cluster's ACMR, so splitting there costs little more than it already pays. Bumping the timestamp past the cache size empties it.
+	std::vector< unsigned int > clusterStarts;
+	unsigned int hardStart = 0;
+	while ( hardStart < numTriangles )
+	{
+		unsigned int hardEnd = hardStart + 1;
+		unsigned int numHardMisses = missesPerTriangle[ hardStart ];
+		while ( ( hardEnd < numTriangles ) && ( missesPerTriangle[ hardEnd ] < 3 ) )
+			numHardMisses += missesPerTriangle[ hardEnd++ ];
+
+		float acmrThreshold = OVERDRAW_CLUSTER_ACMR_THRESHOLD * (float)numHardMisses / (float)( hardEnd - hardStart );
+		unsigned int softStart = hardStart;
+		unsigned int numSoftMisses = 0;
+		timestamp += SIMULATED_CACHE_SIZE + 1;
+		clusterStarts.push_back( hardStart );
+		for ( unsigned int triangle = hardStart; triangle < hardEnd; triangle++ )
+		{
+			for ( unsigned int corner = 0; corner < 3; corner++ )
+			{
+				unsigned int& vertexTimestamp = cacheTimestamps[ indices[ triangle * 3 + corner ] - minIndex ];
+				if ( timestamp - vertexTimestamp > SIMULATED_CACHE_SIZE )
+				{
+					vertexTimestamp = timestamp++;
+					++numSoftMisses;
+				}
+			}
+
+			unsigned int numSoftTriangles = triangle - softStart + 1;
+			bool isLongEnough = ( numSoftTriangles >= MIN_TRIANGLES_PER_OVERDRAW_CLUSTER ) && ( hardEnd - triangle > MIN_TRIANGLES_PER_OVERDRAW_CLUSTER );
+			if ( isLongEnough && ( (float)numSoftMisses <= acmrThreshold * (float)numSoftTriangles ) )
+			{
+				softStart = triangle + 1;
+				numSoftMisses = 0;
+				timestamp += SIMULATED_CACHE_SIZE + 1;
+				clusterStarts.push_back( softStart );
+			}
+		}
+
+		hardStart = hardEnd;
+	}
+
+	unsigned int numClusters = clusterStarts.size();
+	if ( numClusters < 2 )
+		return;
+	clusterStarts.push_back( numTriangles );
+
+	//Area-weighted centroids and normals, per cluster and for the whole draw.
+	std::vector< Vector3f > clusterCentroids( numClusters, Vector3f::ZERO );
+	std::vector< Vector3f > clusterNormals( numClusters, Vector3f::ZERO );
+	std::vector< float > clusterAreas( numClusters, 0.f );
+	Vector3f meshCentroid = Vector3f::ZERO;
+	float meshArea = 0.f;
+	for ( unsigned int cluster = 0; cluster < numClusters; cluster++ )
+	{
+		for ( unsigned int triangle = clusterStarts[ cluster ]; triangle < clusterStarts[ cluster + 1 ]; triangle++ )
+		{
+			const Vector3f& p0 = vertices[ indices[ triangle * 3 + 0 ] ].m_position;
+			const Vector3f& p1 = vertices[ indices[ triangle * 3 + 1 ] ].m_position;
+			const Vector3f& p2 = vertices[ indices[ triangle * 3 + 2 ] ].m_position;
+
+			Vector3f doubleAreaNormal = CrossProduct( p1 - p0, p2 - p0 );
+			float area = doubleAreaNormal.CalcFloatLength() * 0.5f;
+			Vector3f triangleCentroid = ( p0 + p1 + p2 ) * ( 1.f / 3.f );
+
+			clusterNormals[ cluster ] += doubleAreaNormal;
+			clusterCentroids[ cluster ] += triangleCentroid * area;
+			clusterAreas[ cluster ] += area;
+		}
+
+		meshCentroid += clusterCentroids[ cluster ];
+		meshArea += clusterAreas[ cluster ];
+	}
+	if ( meshArea > 0.f )
+		meshCentroid = meshCentroid * ( 1.f / meshArea );
+
+	struct ClusterSortEntry
+	{
+		unsigned int m_clusterIndex;
+		float m_outwardness;
+	};
+	std::vector< ClusterSortEntry > sortEntries( numClusters );
+	for ( unsigned int cluster = 0; cluster < numClusters; cluster++ )
+	{
+		Vector3f centroid = ( clusterAreas[ cluster ] > 0.f ) ? ( clusterCentroids[ cluster ] * ( 1.f / clusterAreas[ cluster ] ) ) : meshCentroid;
+		float normalLength = clusterNormals[ cluster ].CalcFloatLength();
+		sortEntries[ cluster ].m_clusterIndex = cluster;
+		sortEntries[ cluster ].m_outwardness = ( normalLength > 0.f ) ? ( DotProduct( centroid - meshCentroid, clusterNormals[ cluster ] ) / normalLength ) : 0.f;
+	}
+	std::stable_sort( sortEntries.begin(), sortEntries.end(),
+					  []( const ClusterSortEntry& lhs, const ClusterSortEntry& rhs ) { return lhs.m_outwardness > rhs.m_outwardness; } );
+
+	std::vector< unsigned int > sourceIndices( indices, indices + numIndices );
+	unsigned int numIndicesWritten = 0;
+	for ( const ClusterSortEntry& entry : sortEntries )
+	{
+		unsigned int firstIndex = clusterStarts[ entry.m_clusterIndex ] * 3;
+		unsigned int endIndex = clusterStarts[ entry.m_clusterIndex + 1 ] * 3;
+		memcpy( indices + numIndicesWritten, sourceIndices.data() + firstIndex, ( endIndex - firstIndex ) * sizeof( unsigned int ) );
+		numIndicesWritten += endIndex - firstIndex;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int MeshOptimizer::OptimizeVertexFetch( std::vector< Vertex3D_Superset >& vertices, unsigned int* indices, unsigned int numIndices )
+{
+	std::vector< unsigned int > remap( vertices.size(), UNUSED_VERTEX );
+	std::vector< Vertex3D_Superset > reorderedVertices;
+	reorderedVertices.reserve( vertices.size() );
+
+	for ( unsigned int index = 0; index < numIndices; index++ )
+	{
+		unsigned int& newIndex = remap[ indices[ index ] ];
+		if ( newIndex == UNUSED_VERTEX )
+		{
+			newIndex = reorderedVertices.size();
+			reorderedVertices.push_back( vertices[ indices[ index ] ] );
+		}
+		indices[ index ] = newIndex;
+	}
+
+	unsigned int numUnusedVertices = vertices.size() - reorderedVertices.size();
+	vertices.swap( reorderedVertices );
+	return numUnusedVertices;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct ErrorQuadric //Garland and Heckbert's Q: the sum of squared distances to a set of planes, as the 10 unique terms of a symmetric 4x4.
+{
+	ErrorQuadric() : m_xx( 0.0 ), m_xy( 0.0 ), m_xz( 0.0 ), m_xw( 0.0 ), m_yy( 0.0 ), m_yz( 0.0 ), m_yw( 0.0 ), m_zz( 0.0 ), m_zw( 0.0 ), m_ww( 0.0 ), m_weight( 0.0 ) {}
+
+	void AddPlane( const Vector3f& unitNormal, float distance, float weight )
+	{
+		double a = unitNormal.x;
+		double b = unitNormal.y;
+		double c = unitNormal.z;
+		double d = distance;
+		m_xx += a * a * weight;	m_xy += a * b * weight;	m_xz += a * c * weight;	m_xw += a * d * weight;
+		m_yy += b * b * weight;	m_yz += b * c * weight;	m_yw += b * d * weight;
+		m_zz += c * c * weight;	m_zw += c * d * weight;
+		m_ww += d * d * weight;
+		m_weight += weight;
+	}
+
+	void Add( const ErrorQuadric& other )
+	{
+		m_xx += other.m_xx;	m_xy += other.m_xy;	m_xz += other.m_xz;	m_xw += other.m_xw;
+		m_yy += other.m_yy;	m_yz += other.m_yz;	m_yw += other.m_yw;
+		m_zz += other.m_zz;	m_zw += other.m_zw;
+		m_ww += other.m_ww;
+		m_weight += other.m_weight;
+	}
+
+	double CalcSquaredDistanceSum( const Vector3f& position ) const //v^T Q v for v = ( position, 1 ).
+	{
+		double x = position.x;
+		double y = position.y;
+		double z = position.z;
+		double sum = ( m_xx * x * x ) + ( m_yy * y * y ) + ( m_zz * z * z ) + m_ww
+				   + 2.0 * ( ( m_xy * x * y ) + ( m_xz * x * z ) + ( m_yz * y * z ) + ( m_xw * x ) + ( m_yw * y ) + ( m_zw * z ) );
+		return ( sum > 0.0 ) ? sum : 0.0; //Rounding can take a true 0 slightly negative.
+	}
+
+	double m_xx, m_xy, m_xz, m_xw, m_yy, m_yz, m_yw, m_zz, m_zw, m_ww;
+	double m_weight; //Area summed in, so dividing by it gives a mean squared distance instead of one that grows with triangle count.
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline unsigned long long MakeEdgeKey( unsigned int vertexA, unsigned int vertexB ) //Same key either direction.
+{
+	return ( vertexA < vertexB ) ? ( ( (unsigned long long)vertexA << 32 ) | vertexB ) : ( ( (unsigned long long)vertexB << 32 ) | vertexA );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool DoesCollapseFoldTriangles( unsigned int fromVertex, unsigned int toVertex, const Vector3f& toPosition, const unsigned int* localIndices,
+									   const unsigned int* canonicalVertices, const Vertex3D_Superset* localVertices, const unsigned int* adjacentTriangles, unsigned int numAdjacent )
+{
+	for ( unsigned int adjacentIndex = 0; adjacentIndex < numAdjacent; adjacentIndex++ )
+	{
+		const unsigned int* corners = &localIndices[ adjacentTriangles[ adjacentIndex ] * 3 ];
+		unsigned int canonical0 = canonicalVertices[ corners[ 0 ] ];
+		unsigned int canonical1 = canonicalVertices[ corners[ 1 ] ];
+		unsigned int canonical2 = canonicalVertices[ corners[ 2 ] ];
+		if ( ( canonical0 == toVertex ) || ( canonical1 == toVertex ) || ( canonical2 == toVertex ) ) //Collapses away with the edge.
+			continue;
+
+		const Vector3f& p0 = localVertices[ corners[ 0 ] ].m_position;
+		const Vector3f& p1 = localVertices[ corners[ 1 ] ].m_position;
+		const Vector3f& p2 = localVertices[ corners[ 2 ] ].m_position;
+		Vector3f normalBefore = CrossProduct( p1 - p0, p2 - p0 );
+		Vector3f normalAfter = CrossProduct( ( ( canonical1 == fromVertex ) ? toPosition : p1 ) - ( ( canonical0 == fromVertex ) ? toPosition : p0 ),
+											 ( ( canonical2 == fromVertex ) ? toPosition : p2 ) - ( ( canonical0 == fromVertex ) ? toPosition : p0 ) );
+		if ( DotProduct( normalBefore, normalAfter ) <= MIN_COLLAPSE_NORMAL_COSINE * normalBefore.CalcFloatLength() * normalAfter.CalcFloatLength() )
+			return true;
+	}
+
+	return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC float MeshOptimizer::Simplify( const unsigned int* indices, unsigned int numIndices, const Vertex3D_Superset* vertices, unsigned int targetNumIndices, float maxError, std::vector< unsigned int >& out_indices )
+{
+	out_indices.assign( indices, indices + numIndices );
+	if ( ( numIndices < 3 ) || ( targetNumIndices >= numIndices ) )
+		return 0.f;
+
+	unsigned int minIndex = *std::min_element( indices, indices + numIndices );
+	unsigned int maxIndex = *std::max_element( indices, indices + numIndices );
+	unsigned int numLocalVertices = maxIndex - minIndex + 1;
+	const Vertex3D_Superset* localVertices = vertices + minIndex;
+
+	std::vector< unsigned int > localIndices( numIndices );
+	for ( unsigned int index = 0; index < numIndices; index++ )
+		localIndices[ index ] = indices[ index ] - minIndex;
+
+	//Vertices sharing a position but not a normal, UV, etc. are wedges of one point. Each point's first wedge stands in for it as the
+	//canonical vertex, and points with more than one wedge lie on an attribute seam, so they stay put rather than tear it open.
+	std::vector< unsigned int > canonicalVertices( numLocalVertices, UNUSED_VERTEX );
+	std::vector< unsigned char > isLocked( numLocalVertices, 0 );
+	unsigned int tableSize = 1;
+	while ( tableSize < numLocalVertices * 2 )
+		tableSize <<= 1;
+	unsigned int tableMask = tableSize - 1;
+	std::vector< unsigned int > table( tableSize, UNUSED_VERTEX );
+	for ( unsigned int index = 0; index < numIndices; index++ )
+	{
+		unsigned int vertex = localIndices[ index ];
+		if ( canonicalVertices[ vertex ] != UNUSED_VERTEX )
+			continue;
+
+		const Vector3f& position = localVertices[ vertex ].m_position;
+		const unsigned int* words = reinterpret_cast<const unsigned int*>( &position );
+		unsigned int hash = ( words[ 0 ] * 73856093u ) ^ ( words[ 1 ] * 19349663u ) ^ ( words[ 2 ] * 83492791u );
+		hash ^= hash >> 16;
+		unsigned int slot = hash & tableMask;
+		while ( ( table[ slot ] != UNUSED_VERTEX ) && ( memcmp( &localVertices[ table[ slot ] ].m_position, &position, sizeof( Vector3f ) ) != 0 ) )
+			slot = ( slot + 1 ) & tableMask;
+
+		if ( table[ slot ] == UNUSED_VERTEX )
+		{
+			table[ slot ] = vertex;
+			canonicalVertices[ vertex ] = vertex;
+		}
+		else
+		{
+			canonicalVertices[ vertex ] = table[ slot ];
+			isLocked[ table[ slot ] ] = 1;
+		}
+	}
+
+	//Each point's quadric starts as the planes of the triangles around it, weighted by area.
+	std::vector< ErrorQuadric > quadrics( numLocalVertices );
+	for ( unsigned int firstCorner = 0; firstCorner < numIndices; firstCorner += 3 )
+	{
+		const Vector3f& p0 = localVertices[ localIndices[ firstCorner + 0 ] ].m_position;
+		const Vector3f& p1 = localVertices[ localIndices[ firstCorner + 1 ] ].m_position;
+		const Vector3f& p2 = localVertices[ localIndices[ firstCorner + 2 ] ].m_position;
+		Vector3f normal = CrossProduct( p1 - p0, p2 - p0 );
+		float doubleArea = normal.CalcFloatLength();
+		if ( doubleArea <= 0.f )
+			continue;
+
+		normal = normal * ( 1.f / doubleArea );
+		for ( unsigned int corner = 0; corner < 3; corner++ )
+			quadrics[ canonicalVertices[ localIndices[ firstCorner + corner ] ] ].AddPlane( normal, -DotProduct( normal, p0 ), doubleArea * 0.5f );
+	}
+
+	//Edges by canonical endpoints: one triangle makes a border, more than two a non-manifold edge, whose ends get locked.
+	//Border points are held to their border by planes through each border edge, perpendicular to its triangle.
+	std::vector< unsigned long long > edgeKeys;
+	edgeKeys.reserve( numIndices );
+	for ( unsigned int firstCorner = 0; firstCorner < numIndices; firstCorner += 3 )
+		for ( unsigned int corner = 0; corner < 3; corner++ )
+			edgeKeys.push_back( MakeEdgeKey( canonicalVertices[ localIndices[ firstCorner + corner ] ], canonicalVertices[ localIndices[ firstCorner + ( corner + 1 ) % 3 ] ] ) );
+	std::vector< unsigned long long > sortedEdgeKeys( edgeKeys );
+	std::sort( sortedEdgeKeys.begin(), sortedEdgeKeys.end() );
+
+	std::vector< unsigned char > isBorder( numLocalVertices, 0 );
+	for ( unsigned int edgeIndex = 0; edgeIndex < numIndices; edgeIndex++ )
+	{
+		unsigned long long key = edgeKeys[ edgeIndex ];
+		unsigned int vertexA = (unsigned int)( key >> 32 );
+		unsigned int vertexB = (unsigned int)( key & 0xFFFFFFFF );
+		if ( vertexA == vertexB )
+			continue;
+
+		unsigned int numTrianglesOnEdge = std::upper_bound( sortedEdgeKeys.begin(), sortedEdgeKeys.end(), key ) - std::lower_bound( sortedEdgeKeys.begin(), sortedEdgeKeys.end(), key );
+		if ( numTrianglesOnEdge > 2 )
+		{
+			isLocked[ vertexA ] = 1;
+			isLocked[ vertexB ] = 1;
+		}
+		else if ( numTrianglesOnEdge == 1 )
+		{
+			unsigned int firstCorner = edgeIndex - ( edgeIndex % 3 );
+			const Vector3f& p0 = localVertices[ localIndices[ firstCorner + 0 ] ].m_position;
+			const Vector3f& p1 = localVertices[ localIndices[ firstCorner + 1 ] ].m_position;
+			const Vector3f& p2 = localVertices[ localIndices[ firstCorner + 2 ] ].m_position;
+			const Vector3f& edgeStart = localVertices[ vertexA ].m_position;
+			Vector3f edge = localVertices[ vertexB ].m_position - edgeStart;
+			Vector3f borderNormal = CrossProduct( edge, CrossProduct( p1 - p0, p2 - p0 ) );
+			float borderNormalLength = borderNormal.CalcFloatLength();
+			if ( borderNormalLength > 0.f )
+			{
+				borderNormal = borderNormal * ( 1.f / borderNormalLength );
+				float weight = BORDER_QUADRIC_WEIGHT * DotProduct( edge, edge );
+				quadrics[ vertexA ].AddPlane( borderNormal, -DotProduct( borderNormal, edgeStart ), weight );
+				quadrics[ vertexB ].AddPlane( borderNormal, -DotProduct( borderNormal, edgeStart ), weight );
+			}
+			isBorder[ vertexA ] = 1;
+			isBorder[ vertexB ] = 1;
+		}
+	}
+
+	//Passes of the cheapest independent collapses: each locks the points around it until the next pass, so no two collapses in a pass
+	//see each other's half-done result and the costs computed at the pass's start stay exact.
+	struct CollapseCandidate
+	{
+		unsigned int m_fromVertex; //Canonical, and so the only wedge at its point.
+		unsigned int m_toVertex; //The wedge on the collapsing edge, whose attributes the moved corners take.
+		float m_cost;
+	};
+	double maxCost = (double)maxError * (double)maxError;
+	double reachedCost = 0.0;
+	std::vector< unsigned int > remap( numLocalVertices );
+	std::vector< unsigned char > isTouched( numLocalVertices );
+	std::vector< unsigned int > firstAdjacentTriangle( numLocalVertices + 1 );
+	std::vector< unsigned int > adjacentTriangles;
+	std::vector< CollapseCandidate > candidates;
+	while ( localIndices.size() > targetNumIndices )
+	{
+		unsigned int numCurrentIndices = localIndices.size();
+		unsigned int numCurrentTriangles = numCurrentIndices / 3;
+
+		//Each canonical vertex's triangles, for the fold test and for locking its neighborhood.
+		std::fill( firstAdjacentTriangle.begin(), firstAdjacentTriangle.end(), 0 );
+		for ( unsigned int index = 0; index < numCurrentIndices; index++ )
+			++firstAdjacentTriangle[ canonicalVertices[ localIndices[ index ] ] + 1 ];
+		for ( unsigned int vertex = 0; vertex < numLocalVertices; vertex++ )
+			firstAdjacentTriangle[ vertex + 1 ] += firstAdjacentTriangle[ vertex ];
+		adjacentTriangles.resize( numCurrentIndices );
+		std::vector< unsigned int > numAdjacentWritten( numLocalVertices, 0 );
+		for ( unsigned int index = 0; index < numCurrentIndices; index++ )
+		{
+			unsigned int vertex = canonicalVertices[ localIndices[ index ] ];
+			adjacentTriangles[ firstAdjacentTriangle[ vertex ] + numAdjacentWritten[ vertex ]++ ] = index / 3;
+		}
+
+		//Border edges now, since collapses along a border make new ones.
+		sortedEdgeKeys.clear();
+		for ( unsigned int firstCorner = 0; firstCorner < numCurrentIndices; firstCorner += 3 )
+			for ( unsigned int corner = 0; corner < 3; corner++ )
+				sortedEdgeKeys.push_back( MakeEdgeKey( canonicalVertices[ localIndices[ firstCorner + corner ] ], canonicalVertices[ localIndices[ firstCorner + ( corner + 1 ) % 3 ] ] ) );
+		std::sort( sortedEdgeKeys.begin(), sortedEdgeKeys.end() );
+
+		candidates.clear();
+		for ( unsigned int firstCorner = 0; firstCorner < numCurrentIndices; firstCorner += 3 )
+		{
+			for ( unsigned int corner = 0; corner < 3; corner++ )
+			{
+				unsigned int wedgeA = localIndices[ firstCorner + corner ];
+				unsigned int wedgeB = localIndices[ firstCorner + ( corner + 1 ) % 3 ];
+				unsigned int vertexA = canonicalVertices[ wedgeA ];
+				unsigned int vertexB = canonicalVertices[ wedgeB ];
+				if ( vertexA == vertexB )
+					continue;
+
+				unsigned long long key = MakeEdgeKey( vertexA, vertexB );
+				bool isBorderEdge = ( std::upper_bound( sortedEdgeKeys.begin(), sortedEdgeKeys.end(), key ) - std::lower_bound( sortedEdgeKeys.begin(), sortedEdgeKeys.end(), key ) ) == 1;
+				for ( unsigned int direction = 0; direction < 2; direction++ )
+				{
+					unsigned int fromVertex = ( direction == 0 ) ? vertexA : vertexB;
+					unsigned int toVertex = ( direction == 0 ) ? vertexB : vertexA;
+					unsigned int toWedge = ( direction == 0 ) ? wedgeB : wedgeA;
+					if ( isLocked[ fromVertex ] || ( isBorder[ fromVertex ] && !isBorderEdge ) ) //Border points only slide along their border.
+						continue;
+
+					ErrorQuadric merged = quadrics[ fromVertex ];
+					merged.Add( quadrics[ toVertex ] );
+					double cost = ( merged.m_weight > 0.0 ) ? ( merged.CalcSquaredDistanceSum( localVertices[ toVertex ].m_position ) / merged.m_weight ) : 0.0;
+					if ( cost > maxCost )
+						continue;
+
+					CollapseCandidate candidate;
+					candidate.m_fromVertex = fromVertex;
+					candidate.m_toVertex = toWedge;
+					candidate.m_cost = (float)cost;
+					candidates.push_back( candidate );
+				}
+			}
+		}
+		std::sort( candidates.begin(), candidates.end(),
+				   []( const CollapseCandidate& lhs, const CollapseCandidate& rhs ) { return lhs.m_cost < rhs.m_cost; } );
+
+		//An interior collapse removes two triangles, so aim for half the difference and let the next pass take what border collapses leave.
+		unsigned int numTrianglesToRemove = numCurrentTriangles - ( targetNumIndices / 3 );
+		unsigned int maxCollapses = GetMax( 1u, numTrianglesToRemove / 2 );
+		unsigned int numCollapses = 0;
+		for ( unsigned int vertex = 0; vertex < numLocalVertices; vertex++ )
+			remap[ vertex ] = vertex;
+		std::fill( isTouched.begin(), isTouched.end(), 0 );
+		for ( const CollapseCandidate& candidate : candidates )
+		{
+			if ( numCollapses >= maxCollapses )
+				break;
+
+			unsigned int fromVertex = candidate.m_fromVertex;
+			unsigned int toVertex = canonicalVertices[ candidate.m_toVertex ];
+			if ( isTouched[ fromVertex ] || isTouched[ toVertex ] )
+				continue;
+
+			const unsigned int* adjacent = &adjacentTriangles[ firstAdjacentTriangle[ fromVertex ] ];
+			unsigned int numAdjacent = firstAdjacentTriangle[ fromVertex + 1 ] - firstAdjacentTriangle[ fromVertex ];
+			if ( DoesCollapseFoldTriangles( fromVertex, toVertex, localVertices[ toVertex ].m_position, localIndices.data(), canonicalVertices.data(), localVertices, adjacent, numAdjacent ) )
+				continue;
+
+			remap[ fromVertex ] = candidate.m_toVertex;
+			quadrics[ toVertex ].Add( quadrics[ fromVertex ] );
+			reachedCost = GetMax( reachedCost, (double)candidate.m_cost );
+			++numCollapses;
+
+			for ( unsigned int adjacentIndex = 0; adjacentIndex < numAdjacent; adjacentIndex++ )
+				for ( unsigned int corner = 0; corner < 3; corner++ )
+					isTouched[ canonicalVertices[ localIndices[ adjacent[ adjacentIndex ] * 3 + corner ] ] ] = 1;
+		}
+
+		if ( numCollapses == 0 ) //Everything left is locked, would fold, or costs more than maxError.
+			break;
+
+		//Apply the pass, dropping triangles that collapsed to a line.
+		unsigned int numIndicesKept = 0;
+		for ( unsigned int firstCorner = 0; firstCorner < numCurrentIndices; firstCorner += 3 )
+		{
+			unsigned int corner0 = remap[ localIndices[ firstCorner + 0 ] ];
+			unsigned int corner1 = remap[ localIndices[ firstCorner + 1 ] ];
+			unsigned int corner2 = remap[ localIndices[ firstCorner + 2 ] ];
+			unsigned int canonical0 = canonicalVertices[ corner0 ];
+			unsigned int canonical1 = canonicalVertices[ corner1 ];
+			unsigned int canonical2 = canonicalVertices[ corner2 ];
+			if ( ( canonical0 == canonical1 ) || ( canonical1 == canonical2 ) || ( canonical2 == canonical0 ) )
+				continue;
+
+			localIndices[ numIndicesKept++ ] = corner0;
+			localIndices[ numIndicesKept++ ] = corner1;
+			localIndices[ numIndicesKept++ ] = corner2;
+		}
+		localIndices.resize( numIndicesKept );
+	}
+
+	out_indices.resize( localIndices.size() );
+	for ( unsigned int index = 0; index < localIndices.size(); index++ )
+		out_indices[ index ] = localIndices[ index ] + minIndex;
+
+	return (float)sqrt( reachedCost );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int MeshOptimizer::CountCacheMisses( const unsigned int* indices, unsigned int numIndices, unsigned int cacheSize )
+{
+	if ( numIndices == 0 )
+		return 0;
+
+	unsigned int maxIndex = *std::max_element( indices, indices + numIndices );
+	std::vector< unsigned int > cacheTimestamps( maxIndex + 1, 0 );
+	unsigned int timestamp = cacheSize + 1;
+	unsigned int numMisses = 0;
+	for ( unsigned int index = 0; index < numIndices; index++ )
+	{
+		unsigned int& vertexTimestamp = cacheTimestamps[ indices[ index ] ];
+		if ( timestamp - vertexTimestamp > cacheSize )
+		{
+			vertexTimestamp = timestamp++;
+			++numMisses;
+		}
+	}
+
+	return numMisses;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void MeshOptimizer::PrintReport( const MeshOptimizationReport& report )
+{
+	const MeshBufferStats& before = report.m_before;
+	const MeshBufferStats& after = report.m_after;
+	const float BYTES_TO_KB = 1.f / 1024.f;
+
+	g_theConsole->Printf( "Mesh optimized in %.2fms, %u triangles:", report.m_seconds * 1000.0, after.m_numTriangles );
+	g_theConsole->Printf( "  Vertices: %u -> %u (%u welded, %u unused)", before.m_numVertices, after.m_numVertices, report.m_numVerticesWelded, report.m_numVerticesUnused );
+	g_theConsole->Printf( "  Indices: %u -> %u", before.m_numIndices, after.m_numIndices );
+	g_theConsole->Printf( "  ACMR (%u-entry FIFO): %.3f -> %.3f    ATVR: %.3f -> %.3f", SIMULATED_CACHE_SIZE, before.m_acmr, after.m_acmr, before.m_atvr, after.m_atvr );
+	g_theConsole->Printf( "  Buffers: %.1fKB -> %.1fKB (vertices %.1fKB -> %.1fKB, indices %.1fKB -> %.1fKB)",
+						  ( before.m_numVertexBytes + before.m_numIndexBytes ) * BYTES_TO_KB, ( after.m_numVertexBytes + after.m_numIndexBytes ) * BYTES_TO_KB,
+						  before.m_numVertexBytes * BYTES_TO_KB, after.m_numVertexBytes * BYTES_TO_KB, before.m_numIndexBytes * BYTES_TO_KB, after.m_numIndexBytes * BYTES_TO_KB );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void BuildLODTestSphere( std::vector< Vertex3D_Superset >& out_vertices, std::vector< unsigned int >& out_indices )
+{
+	//A unit UV sphere, one vertex per pole. Each ring's last vertex copies its first's position bitwise with u = 1, so the simplifier sees a seam.
+	out_vertices.clear();
+	out_indices.clear();
+	Vertex3D_Superset vertex;
+	vertex.m_position = Vector3f( 0.f, 0.f, 1.f );
+	vertex.m_normal = vertex.m_position;
+	vertex.m_texCoords0 = Vector2f( .5f, 0.f );
+	out_vertices.push_back( vertex );
+	for ( unsigned int stack = 1; stack < LOD_TEST_SPHERE_STACKS; stack++ )
+	{
+		float polarRadians = ( fPI * stack ) / LOD_TEST_SPHERE_STACKS;
+		for ( unsigned int slice = 0; slice <= LOD_TEST_SPHERE_SLICES; slice++ )
+		{
+			if ( slice < LOD_TEST_SPHERE_SLICES )
+			{
+				float azimuthRadians = ( 2.f * fPI * slice ) / LOD_TEST_SPHERE_SLICES;
+				vertex.m_position = Vector3f( sinf( polarRadians ) * cosf( azimuthRadians ), sinf( polarRadians ) * sinf( azimuthRadians ), cosf( polarRadians ) );
+			}
+			else
+			{
+				vertex.m_position = out_vertices[ out_vertices.size() - LOD_TEST_SPHERE_SLICES ].m_position;
+			}
+			vertex.m_normal = vertex.m_position;
+			vertex.m_texCoords0 = Vector2f( (float)slice / LOD_TEST_SPHERE_SLICES, (float)stack / LOD_TEST_SPHERE_STACKS );
+			out_vertices.push_back( vertex );
+		}
+	}
+	vertex.m_position = Vector3f( 0.f, 0.f, -1.f );
+	vertex.m_normal = vertex.m_position;
+	vertex.m_texCoords0 = Vector2f( .5f, 1.f );
+	out_vertices.push_back( vertex );
+
+	//Wound to face out: a fan per pole, and two triangles per quad between rings.
+	const unsigned int verticesPerRing = LOD_TEST_SPHERE_SLICES + 1;
+	const unsigned int lastRingStart = 1 + ( ( LOD_TEST_SPHERE_STACKS - 2 ) * verticesPerRing );
+	const unsigned int southPole = out_vertices.size() - 1;
+	for ( unsigned int slice = 0; slice < LOD_TEST_SPHERE_SLICES; slice++ )
+	{
+		unsigned int topFan[ 3 ] = { 0, 1 + slice, 2 + slice };
+		out_indices.insert( out_indices.end(), topFan, topFan + 3 );
+
+		for ( unsigned int ring = 0; ring < LOD_TEST_SPHERE_STACKS - 2; ring++ )
+		{
+			unsigned int upper = 1 + ( ring * verticesPerRing ) + slice;
+			unsigned int lower = upper + verticesPerRing;
+			unsigned int quad[ 6 ] = { upper, lower, lower + 1, upper, lower + 1, upper + 1 };
+			out_indices.insert( out_indices.end(), quad, quad + 6 );
+		}
+
+		unsigned int bottomFan[ 3 ] = { southPole, lastRingStart + slice + 1, lastRingStart + slice };
+		out_indices.insert( out_indices.end(), bottomFan, bottomFan + 3 );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool CheckLODTestTriangles( const std::vector< Vertex3D_Superset >& vertices, const std::vector< unsigned int >& indices, float& out_maxSink )
+{
+	//False on any index out of range, triangle with two corners at one point, or triangle facing in, as a fold would.
+	//out_maxSink: how far below the unit sphere any triangle's centroid or edge midpoints lie.
+	out_maxSink = 0.f;
+	if ( indices.empty() || ( ( indices.size() % 3 ) != 0 ) )
+		return false;
+
+	for ( unsigned int index = 0; index < indices.size(); index += 3 )
+	{
+		if ( ( indices[ index ] >= vertices.size() ) || ( indices[ index + 1 ] >= vertices.size() ) || ( indices[ index + 2 ] >= vertices.size() ) )
+			return false;
+
+		const Vector3f& p0 = vertices[ indices[ index ] ].m_position;
+		const Vector3f& p1 = vertices[ indices[ index + 1 ] ].m_position;
+		const Vector3f& p2 = vertices[ indices[ index + 2 ] ].m_position;
+		if ( ( p0 == p1 ) || ( p1 == p2 ) || ( p2 == p0 ) )
+			return false;
+		if ( DotProduct( CrossProduct( p1 - p0, p2 - p0 ), p0 + p1 + p2 ) <= 0.f )
+			return false;
+
+		const Vector3f samples[ 4 ] = { ( p0 + p1 + p2 ) * ( 1.f / 3.f ), ( p0 + p1 ) * .5f, ( p1 + p2 ) * .5f, ( p2 + p0 ) * .5f };
+		for ( int sampleIndex = 0; sampleIndex < 4; sampleIndex++ )
+			out_maxSink = GetMax( out_maxSink, 1.f - samples[ sampleIndex ].CalcFloatLength() );
+	}
+
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool RunMeshLODTest()
+{
+	std::vector< Vertex3D_Superset > vertices;
+	std::vector< unsigned int > indices;
+	BuildLODTestSphere( vertices, indices );
+	unsigned int numBaseTriangles = indices.size() / 3;
+	float baseSink;
+	bool didPass = CheckLODTestTriangles( vertices, indices, baseSink );
+	g_theConsole->Printf( "MeshLODTest: %u-triangle UV sphere, %u vertices, sinking up to %.5f between them: %s", numBaseTriangles, vertices.size(), baseSink, didPass ? "PASS" : "FAIL" );
+
+	//Each LOD simplifies LOD 0, as BuildLODChain does. Tessellating already sinks the surface, so that's allowed on top of the error.
+	std::vector< unsigned int > lodIndices;
+	float triangleRatio = 1.f;
+	float lastError = 0.f;
+	float firstLODError = 0.f;
+	unsigned int lastNumIndices = indices.size();
+	for ( unsigned int lodIndex = 1; lodIndex < LOD_TEST_NUM_LODS; lodIndex++ )
+	{
+		triangleRatio *= LOD_TEST_TRIANGLE_RATIO;
+		unsigned int targetNumIndices = (unsigned int)( numBaseTriangles * triangleRatio ) * 3;
+		float error = MeshOptimizer::Simplify( indices.data(), indices.size(), vertices.data(), targetNumIndices, INFINITY, lodIndices );
+		float sink;
+		bool areTrianglesValid = CheckLODTestTriangles( vertices, lodIndices, sink );
+		bool didLODPass = areTrianglesValid && ( lodIndices.size() <= targetNumIndices ) && ( error > lastError ) && ( sink <= baseSink + ( error * LOD_TEST_MAX_SINK_PER_ERROR ) );
+		g_theConsole->Printf( "  LOD %u: %u triangles for a target of %u, error %.5f, sinking up to %.5f%s: %s", lodIndex, lodIndices.size() / 3, targetNumIndices / 3,
+							  error, sink, areTrianglesValid ? "" : ", bad triangles", didLODPass ? "PASS" : "FAIL" );
+		didPass &= didLODPass;
+		if ( lodIndex == 1 )
+			firstLODError = error;
+		lastError = error;
+		lastNumIndices = lodIndices.size();
+	}
+
+	//Capped at the first LOD's error, the coarsest target must stop short rather than exceed it.
+	unsigned int coarsestTargetNumIndices = (unsigned int)( numBaseTriangles * triangleRatio ) * 3;
+	float cappedError = MeshOptimizer::Simplify( indices.data(), indices.size(), vertices.data(), coarsestTargetNumIndices, firstLODError, lodIndices );
+	bool didCapHold = ( cappedError <= firstLODError ) && ( lodIndices.size() > lastNumIndices );
+	g_theConsole->Printf( "  Max error %.5f: stopped at %u triangles, error %.5f: %s", firstLODError, lodIndices.size() / 3, cappedError, didCapHold ? "PASS" : "FAIL" );
+	didPass &= didCapHold;
+
+	//Through MeshBuilder, from unindexed triangles: its LOD records must be contiguous runs, each coarser than the last.
+	MeshBuilder builder;
+	builder.Begin( VertexGroupingRule::AS_TRIANGLES, false );
+	for ( unsigned int index = 0; index < indices.size(); index++ )
+	{
+		const Vertex3D_Superset& corner = vertices[ indices[ index ] ];
+		builder.SetNormal( corner.m_normal );
+		builder.SetUV0( corner.m_texCoords0 );
+		builder.AddVertex( corner.m_position );
+	}
+	builder.End();
+	unsigned int numLODs = builder.BuildLODChain( LOD_TEST_NUM_LODS, LOD_TEST_TRIANGLE_RATIO );
+	const std::vector< MeshLOD >& lods = builder.GetLODs();
+	bool doLODsChain = ( numLODs == LOD_TEST_NUM_LODS ) && ( lods.size() == numLODs ) && ( lods[ 0 ].m_numTriangles == numBaseTriangles );
+	for ( unsigned int lodIndex = 1; doLODsChain && ( lodIndex < lods.size() ); lodIndex++ )
+	{
+		const MeshLOD& previous = lods[ lodIndex - 1 ];
+		const MeshLOD& lod = lods[ lodIndex ];
+		doLODsChain = ( lod.m_firstInstruction == previous.m_firstInstruction + previous.m_numInstructions ) && ( lod.m_numTriangles < previous.m_numTriangles ) && ( lod.m_maxError > previous.m_maxError );
+	}
+	g_theConsole->Printf( "  MeshBuilder::BuildLODChain: %u LODs, down to %u triangles: %s", numLODs, lods.empty() ? 0 : lods.back().m_numTriangles, doLODsChain ? "PASS" : "FAIL" );
+	didPass &= doLODsChain;
+
+	g_theConsole->Printf( "MeshLODTest: %s", didPass ? "PASS" : "FAIL" );
+	return didPass;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void MeshLODTest( Command& )
+{
+	RunMeshLODTest();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+
+#include <vector>
+#include "Engine/EngineCommon.hpp"
+#include "Engine/Renderer/Vertexes.hpp"
+
+
+//-----------------------------------------------------------------------------
+class Command;
+
+
+//-----------------------------------------------------------------------------
+struct MeshBufferStats
+{
+	MeshBufferStats() : m_numVertices( 0 ), m_numIndices( 0 ), m_numTriangles( 0 ), m_acmr( 0.f ), m_atvr( 0.f ), m_numVertexBytes( 0 ), m_numIndexBytes( 0 ) {}
+
+	unsigned int m_numVertices;
+	unsigned int m_numIndices; //0 when nothing's indexed.
+	unsigned int m_numTriangles;
+	float m_acmr; //Average cache miss ratio: post-transform cache misses per triangle, 0.5 at best on a regular grid and 3 with no reuse.
+	float m_atvr; //Average transform to vertex ratio: misses per unique vertex, 1 at best.
+	unsigned int m_numVertexBytes;
+	unsigned int m_numIndexBytes;
+};
+
+
+//-----------------------------------------------------------------------------
+struct MeshOptimizationReport
+{
+	MeshOptimizationReport() : m_numVerticesWelded( 0 ), m_numVerticesUnused( 0 ), m_seconds( 0.0 ) {}
+
+	MeshBufferStats m_before;
+	MeshBufferStats m_after;
+	unsigned int m_numVerticesWelded; //Duplicates merged into an identical vertex.
+	unsigned int m_numVerticesUnused; //Referenced by no index, dropped.
+	double m_seconds;
+};
+
+
+//-----------------------------------------------------------------------------
+//Triangle list optimizations, in the order MeshBuilder::Optimize() runs them:
+//	1. Weld bitwise-identical vertices and index the rest, hashing in parallel on the JobSystem.
+//	2. Reorder triangles for the post-transform vertex cache (Forsyth's linear-speed algorithm).
+//	3. Reorder the cache-coherent clusters that leaves so outward-facing ones draw first, for less overdraw (after Tipsify's second pass).
+//	4. Reorder vertices into first-use order, for the pre-transform vertex fetch.
+//Steps 2 and 3 only read and write one draw's indices, so separate draws can run them on separate threads.
+class MeshOptimizer
+{
+public:
+	static const unsigned int SIMULATED_CACHE_SIZE = 32; //FIFO entries for the ACMR measure: about what a GPU of this engine's era keeps.
+
+	static unsigned int WeldVertices( std::vector< Vertex3D_Superset >& vertices, unsigned int* out_remap ); //Compacts vertices and returns the new count. out_remap: old index -> new index.
+	static void OptimizeVertexCache( unsigned int* indices, unsigned int numIndices );
+	static void OptimizeOverdraw( unsigned int* indices, unsigned int numIndices, const Vertex3D_Superset* vertices );
+	static unsigned int OptimizeVertexFetch( std::vector< Vertex3D_Superset >& vertices, unsigned int* indices, unsigned int numIndices ); //Drops unused vertices, returns how many.
+
+	//Quadric error metric edge collapses (Garland and Heckbert), onto existing vertices so the result indexes the same vertex buffer.
+	//Stops at targetNumIndices, or early if every collapse left would exceed maxError. Attribute seams and non-manifold edges don't move.
+	//Returns the error reached: the worst collapsed point's RMS distance from the planes merged into it, in position units.
+	static float Simplify( const unsigned int* indices, unsigned int numIndices, const Vertex3D_Superset* vertices, unsigned int targetNumIndices, float maxError, std::vector< unsigned int >& out_indices );
+
+	static unsigned int CountCacheMisses( const unsigned int* indices, unsigned int numIndices, unsigned int cacheSize = SIMULATED_CACHE_SIZE );
+	static void PrintReport( const MeshOptimizationReport& report ); //To the console.
+};
+
+
+
+//-----------------------------------------------------------------------------
+bool RunMeshLODTest(); //What MeshLODTest runs, returning whether it passed. Needs no GL.
+void MeshLODTest( Command& args ); //MeshLODTest: simplifies a UV sphere to each LOD, checks triangle counts, error bounds, folds and the MeshBuilder LOD records.
@@ -12,12 +12,16 @@
 #include "Engine/Math/Vector3.hpp"
 #include "Engine/Math/Vector4.hpp"
 #include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Math/MathUtils.hpp"
 #include "Engine/Renderer/Rgba.hpp"
 #include "Engine/Renderer/Sampler.hpp"
 #include "Engine/Renderer/Texture.hpp"
+#include "Engine/Renderer/TheRenderer.hpp"
+#include "Engine/Renderer/RenderStateCache.hpp"
 
 //--------------------------------------------------------------------------------------------------------------
 STATIC MeshRendererRegistryMap		MeshRenderer::s_meshRendererRegistry;
+STATIC const float				MeshRenderer::DEFAULT_MAX_LOD_SCREEN_ERROR_PIXELS = 1.f; //Under a pixel of difference, no one can tell the LODs apart.
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -53,6 +57,9 @@ STATIC void MeshRenderer::ClearMeshRenderers()
 MeshRenderer::MeshRenderer( std::shared_ptr<Mesh> mesh, Material* material )
 	: m_material( nullptr )
 	, m_mesh( nullptr )
+	, m_vaoAttributesMaterial( nullptr )
+	, m_vaoAttributesVertexBufferID( 0 )
+	, m_currentLOD( 0 )
 {
 	glGenVertexArrays( 1, &m_vaoID );
 	ASSERT_OR_DIE( m_vaoID != NULL, "glGenVertexArrays failed in MeshRenderer()" );
@@ -69,6 +76,7 @@ MeshRenderer::MeshRenderer( std::shared_ptr<Mesh> mesh, Material* material )
 MeshRenderer::~MeshRenderer()
 {
 	glDeleteVertexArrays( 1, &m_vaoID );
+	RenderStateCache::OnVertexArrayDeleted( m_vaoID );
 }
 
 
@@ -89,16 +97,16 @@ const VertexDefinition* MeshRenderer::GetVertexDefinition() const
 //--------------------------------------------------------------------------------------------------------------
 void MeshRenderer::SetMesh( std::shared_ptr<Mesh> mesh )
 {
-	glBindVertexArray( m_vaoID );
-	glBindBuffer( GL_ARRAY_BUFFER, mesh->GetVertexBufferID() );
+	//No unbinding after: the VAO stays current until someone else's RenderStateCache::BindVertexArray.
+	//Unbinding the element buffer BEFORE the VAO would have detached it from this VAO, hence the old crash.
+	RenderStateCache::BindVertexArray( m_vaoID );
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, mesh->GetVertexBufferID() );
 
 	if ( mesh->GetIndexBufferID() != NULL )
-		glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, mesh->GetIndexBufferID() );
+		RenderStateCache::BindBuffer( GL_ELEMENT_ARRAY_BUFFER, mesh->GetIndexBufferID() );
 
-	glBindVertexArray( NULL ); //Must come first, but why?
-
-	glBindBuffer( GL_ARRAY_BUFFER, NULL );
-	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, NULL ); //Why does this cause a crash if before VAO unbind?
+	if ( mesh != m_mesh )
+		m_vaoAttributesMaterial = nullptr; //A new mesh can reuse a deleted VBO's name, so don't trust the ID alone.
 
 	m_mesh = mesh;
 }
@@ -109,13 +117,22 @@ void MeshRenderer::SetMaterial( Material* material, bool overwriteMemberMaterial
 {
 	if ( m_mesh == nullptr ) return;
 
-	glBindVertexArray( m_vaoID );
-	glBindBuffer( GL_ARRAY_BUFFER, m_mesh->GetVertexBufferID() );
+	//The VAO already points its attributes at this material's locations in this VBO, e.g. every sprite sharing the default material.
+	bool isVaoAlreadySetUp = ( material == m_vaoAttributesMaterial ) && ( m_mesh->GetVertexBufferID() == m_vaoAttributesVertexBufferID );
+	if ( isVaoAlreadySetUp )
+	{
+		if ( overwriteMemberMaterial )
+			m_material = material;
+		return;
+	}
+
+	RenderStateCache::BindVertexArray( m_vaoID );
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, m_mesh->GetVertexBufferID() );
 
 	if ( m_mesh->UsesIndexBuffer() )
-		glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_mesh->GetIndexBufferID() );
+		RenderStateCache::BindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_mesh->GetIndexBufferID() );
 	else
-		glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, NULL );
+		RenderStateCache::BindBuffer( GL_ELEMENT_ARRAY_BUFFER, NULL );
 
 	for ( int i = 0; i < 10; i++ ) //Being overly cautious, 10 is a random #, replace it with superset's #attribs.
 		glDisableVertexAttribArray( i );
@@ -134,10 +151,8 @@ void MeshRenderer::SetMaterial( Material* material, bool overwriteMemberMaterial
 		}
 	}
 
-	glBindVertexArray( NULL ); //Must come first, but why?
-
-	glBindBuffer( GL_ARRAY_BUFFER, NULL );
-	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, NULL ); //Why does this cause a crash if before VAO unbind?
+	m_vaoAttributesMaterial = material;
+	m_vaoAttributesVertexBufferID = m_mesh->GetVertexBufferID();
 
 	if ( overwriteMemberMaterial && ( m_material != material ) )
 	{
@@ -150,6 +165,33 @@ void MeshRenderer::SetMaterial( Material* material, bool overwriteMemberMaterial
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+unsigned int MeshRenderer::SelectLOD( float distanceToCamera, float viewportHeightPixels, float fovDegreesY /*= ENGINE_PERSPECTIVE_FOV_Y_DEGREES*/,
+									  float maxScreenErrorPixels /*= DEFAULT_MAX_LOD_SCREEN_ERROR_PIXELS*/ )
+{
+	m_currentLOD = 0;
+	if ( ( m_mesh == nullptr ) || ( distanceToCamera <= 0.f ) || ( viewportHeightPixels <= 0.f ) )
+		return m_currentLOD;
+
+	//How big a pixel is at that distance: the view's height there, over the viewport's in pixels. The farther or smaller on screen
+	//the mesh is, the more model units a pixel covers, and the more error a LOD can have before it shows.
+	float viewHeightAtDistance = 2.f * distanceToCamera * tanf( ConvertDegreesToRadians( fovDegreesY ) * .5f );
+	float maxError = maxScreenErrorPixels * viewHeightAtDistance / viewportHeightPixels;
+
+	const std::vector<MeshLOD>& lods = m_mesh->GetLODs();
+	for ( unsigned int lodIndex = (unsigned int)lods.size(); lodIndex-- > 1; ) //Errors only grow down the chain, so the first from the coarse end that fits is the coarsest.
+	{
+		if ( lods[ lodIndex ].m_maxError <= maxError )
+		{
+			m_currentLOD = lodIndex;
+			break;
+		}
+	}
+
+	return m_currentLOD;
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 void MeshRenderer::Render()
 {
@@ -164,6 +206,8 @@ void MeshRenderer::ResetVAO( Mesh* mesh, Material* material )
 	TODO( "Cleanup reset code upon FBXLoad in Tools/FBXUtils here!" );
 
 	glDeleteVertexArrays( 1, &m_vaoID );
+	RenderStateCache::OnVertexArrayDeleted( m_vaoID );
+	m_vaoAttributesMaterial = nullptr;
 
 	glGenVertexArrays( 1, &m_vaoID );
 	ASSERT_OR_DIE( m_vaoID != NULL, "glGenVertexArrays failed in MeshRenderer()" );
@@ -179,23 +223,36 @@ void MeshRenderer::Render( Mesh* mesh, Material* material )
 {
 	//Ideal: loop over all the instructions with the mesh, draw elements from startIndex to endIndex.
 
+	if ( g_theRenderer != nullptr )
+		g_theRenderer->FlushImmediateDraws(); //Else batched Draw* calls issued before this would land on top of it.
+
 	if ( mesh != m_mesh.get() )
 		SetMesh( std::shared_ptr<Mesh>(mesh) );
 		 
 	if ( material != m_material )
 		SetMaterial( material, true );
 
-	glBindVertexArray( m_vaoID );
+	RenderStateCache::BindVertexArray( m_vaoID );
 
 	if ( m_mesh->UsesIndexBuffer() )
-		glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_mesh->GetIndexBufferID() );
+		RenderStateCache::BindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_mesh->GetIndexBufferID() );
 	else
-		glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, NULL );
+		RenderStateCache::BindBuffer( GL_ELEMENT_ARRAY_BUFFER, NULL );
 
 	material->Bind();
 
 	const std::vector<DrawInstruction>& drawInstructions = m_mesh->GetDrawInstructions();
-	for ( unsigned int instructionIndex = 0; instructionIndex < drawInstructions.size(); instructionIndex++ )
+	unsigned int firstInstruction = 0;
+	unsigned int endInstruction = (unsigned int)drawInstructions.size();
+	const std::vector<MeshLOD>& lods = m_mesh->GetLODs();
+	if ( !lods.empty() )
+	{
+		const MeshLOD& lod = lods[ GetMin( m_currentLOD, (unsigned int)lods.size() - 1 ) ];
+		firstInstruction = lod.m_firstInstruction;
+		endInstruction = GetMin( lod.m_firstInstruction + lod.m_numInstructions, endInstruction );
+	}
+
+	for ( unsigned int instructionIndex = firstInstruction; instructionIndex < endInstruction; instructionIndex++ )
 	{
 		const DrawInstruction& currentInstruction = drawInstructions[ instructionIndex ];
 
@@ -203,16 +260,12 @@ void MeshRenderer::Render( Mesh* mesh, Material* material )
 		unsigned int vertexGroupingRule = GetOpenGLVertexGroupingRule( currentInstruction.m_type );
 
 		if ( m_mesh->UsesIndexBuffer() )
-			glDrawElements( vertexGroupingRule, currentInstruction.m_count, GL_UNSIGNED_INT, (GLvoid*)currentInstruction.m_startIndex ); //Vertex grouping rule, # indices, uint, &loc[0] or 0 for bound.
+			glDrawElements( vertexGroupingRule, currentInstruction.m_count, GL_UNSIGNED_INT, (GLvoid*)( currentInstruction.m_startIndex * sizeof( unsigned int ) ) ); //Vertex grouping rule, # indices, uint, byte offset into the bound IBO.
 		else
 			glDrawArrays( vertexGroupingRule, currentInstruction.m_startIndex, currentInstruction.m_count ); //Vertex grouping rule, start index into bound array, # vertexes to include.
 	}
 
-	material->Unbind();
-
-	glBindVertexArray( NULL );
-
-	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, NULL );
+	//Nothing unbound: the next draw sharing this VAO, program, textures or state gets them for free via RenderStateCache.
 }
 
 
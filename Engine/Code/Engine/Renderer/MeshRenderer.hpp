@@ -37,12 +37,21 @@ public:
 
 	const std::string& GetMaterialName() const;
 	std::shared_ptr<Mesh> GetMesh() const { return m_mesh; };
+	Material* GetMaterial() const { return m_material; }
 	const VertexDefinition* GetVertexDefinition() const;
 
 	void SetMesh( std::shared_ptr<Mesh> mesh );
 	void SetMaterial( Material* material, bool overwriteMemberMaterial );
 	void SetMeshAndMaterial( std::shared_ptr<Mesh> mesh, Material* material ) { SetMesh(mesh); SetMaterial(material, true); }
 
+	static const float DEFAULT_MAX_LOD_SCREEN_ERROR_PIXELS;
+
+	//LODs from MeshBuilder::BuildLODChain. Render() draws only the current one's instructions, or all of them if the mesh has no LODs.
+	unsigned int GetLOD() const { return m_currentLOD; }
+	void SetLOD( unsigned int lodIndex ) { m_currentLOD = lodIndex; } //Clamped to the mesh's coarsest when rendering.
+	unsigned int SelectLOD( float distanceToCamera, float viewportHeightPixels, float fovDegreesY = ENGINE_PERSPECTIVE_FOV_Y_DEGREES,
+							float maxScreenErrorPixels = DEFAULT_MAX_LOD_SCREEN_ERROR_PIXELS ); //Sets and returns the coarsest LOD whose error projects under maxScreenErrorPixels.
+
 	void Render();
 	void Render( Mesh* mesh, Material* material );
 
@@ -63,8 +72,11 @@ private:
 	static MeshRendererRegistryMap s_meshRendererRegistry;
 
 	unsigned int m_vaoID;
+	Material* m_vaoAttributesMaterial; //What SetMaterial last pointed the VAO's attributes at, to skip redoing it.
+	unsigned int m_vaoAttributesVertexBufferID;
 
 	//Using shared pointers because multiple MeshRenderers may otherwise delete meshes/materials still in use.
 	std::shared_ptr<Mesh> m_mesh;
 	Material* m_material;
+	unsigned int m_currentLOD;
 };
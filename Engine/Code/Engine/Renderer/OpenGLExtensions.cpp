@@ -8,6 +8,21 @@ PFNGLGENBUFFERSPROC			glGenBuffers		= nullptr;
 PFNGLBINDBUFFERPROC			glBindBuffer		= nullptr;
 PFNGLBUFFERDATAPROC			glBufferData		= nullptr;
 PFNGLDELETEBUFFERSPROC		glDeleteBuffers		= nullptr;
+PFNGLBUFFERSUBDATAPROC		glBufferSubData		= nullptr;
+PFNGLMAPBUFFERRANGEPROC		glMapBufferRange	= nullptr;
+PFNGLUNMAPBUFFERPROC		glUnmapBuffer		= nullptr;
+
+//Fences.
+PFNGLFENCESYNCPROC			glFenceSync			= nullptr;
+PFNGLCLIENTWAITSYNCPROC		glClientWaitSync	= nullptr;
+PFNGLDELETESYNCPROC			glDeleteSync		= nullptr;
+
+//Timer queries.
+PFNGLGENQUERIESPROC				glGenQueries			= nullptr;
+PFNGLDELETEQUERIESPROC			glDeleteQueries			= nullptr;
+PFNGLQUERYCOUNTERPROC			glQueryCounter			= nullptr;
+PFNGLGETQUERYOBJECTIVPROC		glGetQueryObjectiv		= nullptr;
+PFNGLGETQUERYOBJECTUI64VPROC	glGetQueryObjectui64v	= nullptr;
 
 
 //-----------------------------------------------------------------------------
@@ -56,6 +71,8 @@ PFNGLVERTEXATTRIBIPOINTERPROC		glVertexAttribIPointer		= nullptr;
 
 //Drawing. Already have glDrawArrays.
 PFNGLUSEPROGRAMPROC					glUseProgram				= nullptr;
+PFNGLDRAWELEMENTSINSTANCEDPROC		glDrawElementsInstanced		= nullptr;
+PFNGLVERTEXATTRIBDIVISORPROC		glVertexAttribDivisor		= nullptr;
 
 
 //-----------------------------------------------------------------------------
@@ -108,3 +125,138 @@ PFNWGLCREATECONTEXTATTRIBSARBPROC	wglCreateContextAttribsARB = nullptr;
 PFNGLGENERATEMIPMAPPROC				glGenerateMipmap = nullptr;
 PFNGLFRAMEBUFFERTEXTURE2DPROC		glFramebufferTexture2D = nullptr;
 PFNGLFRAMEBUFFERRENDERBUFFERPROC	glFramebufferRenderbuffer = nullptr;
+
+
+//--------------------------------------------------------------------------------------------------------------
+#ifdef ENGINE_HEADLESS
+#include <vector>
+
+//Null backend for the headless benchmark build. Signatures must match the PFN types exactly (stdcall: callee pops args).
+static GLuint s_nextNullObjectID = 1;
+
+static void APIENTRY NullGenObjects( GLsizei n, GLuint* ids ) { for ( GLsizei i = 0; i < n; i++ ) ids[ i ] = s_nextNullObjectID++; }
+static void APIENTRY NullDeleteObjects( GLsizei, const GLuint* ) {}
+static GLuint APIENTRY NullCreateObject() { return s_nextNullObjectID++; }
+static GLuint APIENTRY NullCreateObjectOfType( GLenum ) { return s_nextNullObjectID++; }
+static void APIENTRY NullEnum( GLenum ) {}
+static void APIENTRY NullUint( GLuint ) {}
+static void APIENTRY NullEnumUint( GLenum, GLuint ) {}
+static void APIENTRY NullUintUint( GLuint, GLuint ) {}
+static void APIENTRY NullUintEnum( GLuint, GLenum ) {}
+static void APIENTRY NullUintEnumInt( GLuint, GLenum, GLint ) {}
+static void APIENTRY NullBufferData( GLenum, GLsizeiptr, const void*, GLenum ) {}
+static void APIENTRY NullBufferSubData( GLenum, GLintptr, GLsizeiptr, const void* ) {}
+static void* APIENTRY NullMapBufferRange( GLenum, GLintptr, GLsizeiptr length, GLbitfield ) { static std::vector<unsigned char> s_scratch; if ( s_scratch.size() < (size_t)length ) s_scratch.resize( length ); return s_scratch.data(); }
+static GLboolean APIENTRY NullUnmapBuffer( GLenum ) { return GL_TRUE; }
+static GLsync APIENTRY NullFenceSync( GLenum, GLbitfield ) { return (GLsync)&s_nextNullObjectID; } //Any non-null handle, never dereferenced.
+static GLenum APIENTRY NullClientWaitSync( GLsync, GLbitfield, GLuint64 ) { return GL_ALREADY_SIGNALED; }
+static void APIENTRY NullDeleteSync( GLsync ) {}
+static void APIENTRY NullGetQueryObjectiv( GLuint, GLenum, GLint* params ) { *params = GL_TRUE; } //Only asked for GL_QUERY_RESULT_AVAILABLE.
+static void APIENTRY NullGetQueryObjectui64v( GLuint, GLenum, GLuint64* params ) { *params = 0; }
+static void APIENTRY NullShaderSource( GLuint, GLsizei, const GLchar* const*, const GLint* ) {}
+static void APIENTRY NullGetInfoLog( GLuint, GLsizei, GLsizei* length, GLchar* infoLog ) { if ( length != nullptr ) *length = 0; if ( infoLog != nullptr ) *infoLog = '\0'; }
+static void APIENTRY NullGetShaderiv( GLuint, GLenum pname, GLint* params ) { *params = ( pname == GL_COMPILE_STATUS ) ? GL_TRUE : 0; }
+static void APIENTRY NullGetProgramiv( GLuint, GLenum pname, GLint* params ) { *params = ( pname == GL_LINK_STATUS ) ? GL_TRUE : 0; } //0 active uniforms.
+static GLint APIENTRY NullGetLocation( GLuint, const GLchar* ) { return -1; } //Callers already skip -1.
+static void APIENTRY NullGetActiveUniform( GLuint, GLuint, GLsizei, GLsizei* length, GLint*, GLenum*, GLchar* ) { if ( length != nullptr ) *length = 0; }
+static void APIENTRY NullVertexAttribPointer( GLuint, GLint, GLenum, GLboolean, GLsizei, const void* ) {}
+static void APIENTRY NullVertexAttribIPointer( GLuint, GLint, GLenum, GLsizei, const void* ) {}
+static void APIENTRY NullDrawElementsInstanced( GLenum, GLsizei, GLenum, const void*, GLsizei ) {}
+static void APIENTRY NullUniformfv( GLint, GLsizei, const GLfloat* ) {}
+static void APIENTRY NullUniformiv( GLint, GLsizei, const GLint* ) {}
+static void APIENTRY NullUniformMatrix4fv( GLint, GLsizei, GLboolean, const GLfloat* ) {}
+static void APIENTRY NullFramebufferTexture( GLenum, GLenum, GLuint, GLint ) {}
+static GLenum APIENTRY NullCheckFramebufferStatus( GLenum ) { return GL_FRAMEBUFFER_COMPLETE; }
+static void APIENTRY NullDrawBuffers( GLsizei, const GLenum* ) {}
+static void APIENTRY NullBlitFramebuffer( GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum ) {}
+static void APIENTRY NullFramebufferTexture2D( GLenum, GLenum, GLenum, GLuint, GLint ) {}
+static void APIENTRY NullFramebufferRenderbuffer( GLenum, GLenum, GLenum, GLuint ) {}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void NullGLGenTextures( GLsizei n, GLuint* textures )
+{
+	NullGenObjects( n, textures );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void BindNullOpenGLExtensions()
+{
+	glGenBuffers = (PFNGLGENBUFFERSPROC)NullGenObjects;
+	glBindBuffer = (PFNGLBINDBUFFERPROC)NullEnumUint;
+	glBufferData = (PFNGLBUFFERDATAPROC)NullBufferData;
+	glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)NullDeleteObjects;
+	glBufferSubData = (PFNGLBUFFERSUBDATAPROC)NullBufferSubData;
+	glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC)NullMapBufferRange;
+	glUnmapBuffer = (PFNGLUNMAPBUFFERPROC)NullUnmapBuffer;
+	glFenceSync = (PFNGLFENCESYNCPROC)NullFenceSync;
+	glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)NullClientWaitSync;
+	glDeleteSync = (PFNGLDELETESYNCPROC)NullDeleteSync;
+	glGenQueries = (PFNGLGENQUERIESPROC)NullGenObjects;
+	glDeleteQueries = (PFNGLDELETEQUERIESPROC)NullDeleteObjects;
+	glQueryCounter = (PFNGLQUERYCOUNTERPROC)NullUintEnum;
+	glGetQueryObjectiv = (PFNGLGETQUERYOBJECTIVPROC)NullGetQueryObjectiv;
+	glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)NullGetQueryObjectui64v;
+
+	glCreateShader = (PFNGLCREATESHADERPROC)NullCreateObjectOfType;
+	glShaderSource = (PFNGLSHADERSOURCEPROC)NullShaderSource;
+	glCompileShader = (PFNGLCOMPILESHADERPROC)NullUint;
+	glGetShaderiv = (PFNGLGETSHADERIVPROC)NullGetShaderiv;
+	glDeleteShader = (PFNGLDELETESHADERPROC)NullUint;
+
+	glCreateProgram = (PFNGLCREATEPROGRAMPROC)NullCreateObject;
+	glAttachShader = (PFNGLATTACHSHADERPROC)NullUintUint;
+	glLinkProgram = (PFNGLLINKPROGRAMPROC)NullUint;
+	glGetProgramiv = (PFNGLGETPROGRAMIVPROC)NullGetProgramiv;
+	glDetachShader = (PFNGLDETACHSHADERPROC)NullUintUint;
+	glDeleteProgram = (PFNGLDELETEPROGRAMPROC)NullUint;
+
+	glGetShaderInfoLog = (PFNGLGETSHADERINFOLOGPROC)NullGetInfoLog;
+	glGetProgramInfoLog = (PFNGLGETPROGRAMINFOLOGPROC)NullGetInfoLog;
+
+	glGenVertexArrays = (PFNGLGENVERTEXARRAYSPROC)NullGenObjects;
+	glDeleteVertexArrays = (PFNGLDELETEVERTEXARRAYSPROC)NullDeleteObjects;
+	glBindVertexArray = (PFNGLBINDVERTEXARRAYPROC)NullUint;
+	glGetAttribLocation = (PFNGLGETATTRIBLOCATIONPROC)NullGetLocation;
+	glEnableVertexAttribArray = (PFNGLENABLEVERTEXATTRIBARRAYPROC)NullUint;
+	glDisableVertexAttribArray = (PFNGLDISABLEVERTEXATTRIBARRAYPROC)NullUint;
+	glVertexAttribPointer = (PFNGLVERTEXATTRIBPOINTERPROC)NullVertexAttribPointer;
+	glVertexAttribIPointer = (PFNGLVERTEXATTRIBIPOINTERPROC)NullVertexAttribIPointer;
+
+	glUseProgram = (PFNGLUSEPROGRAMPROC)NullUint;
+	glDrawElementsInstanced = (PFNGLDRAWELEMENTSINSTANCEDPROC)NullDrawElementsInstanced;
+	glVertexAttribDivisor = (PFNGLVERTEXATTRIBDIVISORPROC)NullUintUint;
+
+	glGetUniformLocation = (PFNGLGETUNIFORMLOCATIONPROC)NullGetLocation;
+	glGetActiveUniform = (PFNGLGETACTIVEUNIFORMPROC)NullGetActiveUniform;
+	glUniform1fv = (PFNGLUNIFORM1FVPROC)NullUniformfv;
+	glUniform2fv = (PFNGLUNIFORM2FVPROC)NullUniformfv;
+	glUniform3fv = (PFNGLUNIFORM3FVPROC)NullUniformfv;
+	glUniform4fv = (PFNGLUNIFORM4FVPROC)NullUniformfv;
+	glUniform1iv = (PFNGLUNIFORM1IVPROC)NullUniformiv;
+	glUniform2iv = (PFNGLUNIFORM2IVPROC)NullUniformiv;
+	glUniform3iv = (PFNGLUNIFORM3IVPROC)NullUniformiv;
+	glUniform4iv = (PFNGLUNIFORM4IVPROC)NullUniformiv;
+	glUniformMatrix4fv = (PFNGLUNIFORMMATRIX4FVPROC)NullUniformMatrix4fv;
+
+	glGenSamplers = (PFNGLGENSAMPLERSPROC)NullGenObjects;
+	glSamplerParameteri = (PFNGLSAMPLERPARAMETERIPROC)NullUintEnumInt;
+	glBindSampler = (PFNGLBINDSAMPLERPROC)NullUintUint;
+	glActiveTexture = (PFNGLACTIVETEXTUREPROC)NullEnum;
+	glDeleteSamplers = (PFNGLDELETESAMPLERSPROC)NullDeleteObjects;
+
+	glGenFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)NullGenObjects;
+	glBindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)NullEnumUint;
+	glFramebufferTexture = (PFNGLFRAMEBUFFERTEXTUREPROC)NullFramebufferTexture;
+	glCheckFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)NullCheckFramebufferStatus;
+	glDeleteFramebuffers = (PFNGLDELETEFRAMEBUFFERSPROC)NullDeleteObjects;
+	glDrawBuffers = (PFNGLDRAWBUFFERSPROC)NullDrawBuffers;
+	glBlitFramebuffer = (PFNGLBLITFRAMEBUFFERPROC)NullBlitFramebuffer;
+
+	glGenerateMipmap = (PFNGLGENERATEMIPMAPPROC)NullEnum;
+	glFramebufferTexture2D = (PFNGLFRAMEBUFFERTEXTURE2DPROC)NullFramebufferTexture2D;
+	glFramebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)NullFramebufferRenderbuffer;
+}
+
+#endif
@@ -17,6 +17,21 @@ extern PFNGLGENBUFFERSPROC				glGenBuffers;
 extern PFNGLBINDBUFFERPROC				glBindBuffer;
 extern PFNGLBUFFERDATAPROC				glBufferData;
 extern PFNGLDELETEBUFFERSPROC			glDeleteBuffers;
+extern PFNGLBUFFERSUBDATAPROC			glBufferSubData;
+extern PFNGLMAPBUFFERRANGEPROC			glMapBufferRange;
+extern PFNGLUNMAPBUFFERPROC				glUnmapBuffer;
+
+//Fences, for TransientGeometryBuffer to know when the GPU is done reading a ring segment.
+extern PFNGLFENCESYNCPROC				glFenceSync;
+extern PFNGLCLIENTWAITSYNCPROC			glClientWaitSync;
+extern PFNGLDELETESYNCPROC				glDeleteSync;
+
+//Timer queries, for DynamicResolutionController to read back GPU frame time without stalling.
+extern PFNGLGENQUERIESPROC				glGenQueries;
+extern PFNGLDELETEQUERIESPROC			glDeleteQueries;
+extern PFNGLQUERYCOUNTERPROC			glQueryCounter;
+extern PFNGLGETQUERYOBJECTIVPROC		glGetQueryObjectiv;
+extern PFNGLGETQUERYOBJECTUI64VPROC		glGetQueryObjectui64v;
 
 //--------------------------------------------------------------------------------------------------------------
 
@@ -63,6 +78,8 @@ extern PFNGLVERTEXATTRIBIPOINTERPROC	glVertexAttribIPointer;
 
 //Drawing. glDrawArrays we link in with the core.
 extern PFNGLUSEPROGRAMPROC				glUseProgram;
+extern PFNGLDRAWELEMENTSINSTANCEDPROC	glDrawElementsInstanced;
+extern PFNGLVERTEXATTRIBDIVISORPROC		glVertexAttribDivisor;
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -114,4 +131,53 @@ extern PFNWGLCREATECONTEXTATTRIBSARBPROC wglCreateContextAttribsARB;
 //Needed for RiftUtils.hpp.
 extern PFNGLGENERATEMIPMAPPROC			glGenerateMipmap;
 extern PFNGLFRAMEBUFFERTEXTURE2DPROC	glFramebufferTexture2D;
-extern PFNGLFRAMEBUFFERRENDERBUFFERPROC	glFramebufferRenderbuffer;
\ No newline at end of file
+extern PFNGLFRAMEBUFFERRENDERBUFFERPROC	glFramebufferRenderbuffer;
+
+//--------------------------------------------------------------------------------------------------------------
+
+//Headless configuration: no window or context exists, so TheRenderer() binds every pointer above to a no-op stub instead.
+//Stubs hand out unique nonzero IDs and report success on compile/link/FBO status checks so startup asserts still pass.
+#ifdef ENGINE_HEADLESS
+void BindNullOpenGLExtensions();
+
+//The GL 1.1 entry points are exported by opengl32.dll rather than fetched into pointers, so they're swapped out here instead.
+//Any file calling one must include this header after gl.h, which its include guard then keeps from being reparsed.
+template < typename... Args > inline void NullGLCall( const Args&... ) {}
+void NullGLGenTextures( GLsizei n, GLuint* textures ); //Same ID sequence as the extension stubs' glGen*.
+inline const GLubyte* NullGLGetString( GLenum ) { return (const GLubyte*)"Headless"; }
+inline GLenum NullGLGetError() { return GL_NO_ERROR; }
+
+#define glGenTextures( ... )			NullGLGenTextures( __VA_ARGS__ )
+#define glGetString( ... )				NullGLGetString( __VA_ARGS__ )
+#define glGetError()					NullGLGetError()
+#define glAlphaFunc( ... )				NullGLCall( __VA_ARGS__ )
+#define glBindTexture( ... )			NullGLCall( __VA_ARGS__ )
+#define glBlendFunc( ... )				NullGLCall( __VA_ARGS__ )
+#define glClear( ... )					NullGLCall( __VA_ARGS__ )
+#define glClearColor( ... )				NullGLCall( __VA_ARGS__ )
+#define glClearDepth( ... )				NullGLCall( __VA_ARGS__ )
+#define glColor4f( ... )				NullGLCall( __VA_ARGS__ )
+#define glColor4ub( ... )				NullGLCall( __VA_ARGS__ )
+#define glColorPointer( ... )			NullGLCall( __VA_ARGS__ )
+#define glCullFace( ... )				NullGLCall( __VA_ARGS__ )
+#define glDeleteTextures( ... )			NullGLCall( __VA_ARGS__ )
+#define glDepthFunc( ... )				NullGLCall( __VA_ARGS__ )
+#define glDepthMask( ... )				NullGLCall( __VA_ARGS__ )
+#define glDisable( ... )				NullGLCall( __VA_ARGS__ )
+#define glDisableClientState( ... )		NullGLCall( __VA_ARGS__ )
+#define glDrawArrays( ... )				NullGLCall( __VA_ARGS__ )
+#define glDrawElements( ... )			NullGLCall( __VA_ARGS__ )
+#define glEnable( ... )					NullGLCall( __VA_ARGS__ )
+#define glEnableClientState( ... )		NullGLCall( __VA_ARGS__ )
+#define glFinish()						NullGLCall()
+#define glLineWidth( ... )				NullGLCall( __VA_ARGS__ )
+#define glPixelStorei( ... )			NullGLCall( __VA_ARGS__ )
+#define glPointSize( ... )				NullGLCall( __VA_ARGS__ )
+#define glReadPixels( ... )				NullGLCall( __VA_ARGS__ ) //Leaves the caller's buffer as it was.
+#define glScissor( ... )				NullGLCall( __VA_ARGS__ )
+#define glTexCoordPointer( ... )		NullGLCall( __VA_ARGS__ )
+#define glTexImage2D( ... )				NullGLCall( __VA_ARGS__ )
+#define glTexParameteri( ... )			NullGLCall( __VA_ARGS__ )
+#define glVertexPointer( ... )			NullGLCall( __VA_ARGS__ )
+#define glViewport( ... )				NullGLCall( __VA_ARGS__ )
+#endif
@@ -6,6 +6,9 @@
 #include "Engine/Renderer/MeshRenderer.hpp"
 #include "Engine/Renderer/Vertexes.hpp"
 #include "Engine/Renderer/Sprite.hpp"
+#include "Engine/Renderer/SpriteResource.hpp"
+#include "Engine/Renderer/SpriteRenderer.hpp"
+#include "Engine/Renderer/RenderQueue.hpp"
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -23,6 +26,8 @@ STATIC ParticleEmitter* ParticleEmitter::Create( ParticleEmitterDefinition* emit
 	emitter->m_numInitialSpawnsLeft = emitterDefn->m_initialSpawnCount;
 	Material* emitterMaterial = Material::CreateOrGetMaterial( Stringf( "%s%d_Material", emitterDefn->GetName().c_str(), numInvocation ), emitterDefn->GetRenderState(), &Vertex2D_PCT::DEFINITION, "BasicSprite" );
 	emitter->m_emitterMeshRenderer->SetMaterial( emitterMaterial, true );
+	//Nothing binds to it per emitter, so one per definition (i.e. per render state) serves every emitter made from it.
+	emitter->m_instancedMaterial = Material::CreateOrGetMaterial( Stringf( "%s_InstancedMaterial", emitterDefn->GetName().c_str() ), emitterDefn->GetRenderState(), &SpriteInstance::DEFINITION, "InstancedSprite" );
 	return emitter;
 }
 
@@ -89,12 +94,67 @@ void ParticleEmitter::Render()
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void ParticleEmitter::RecordDraws( RenderCommandBuffer* commandBuffer, RenderLayerID layerID, unsigned int orderInLayer, bool isStateSorted, const RenderUniformBlock* uniforms )
+{
+	bool shouldInstance = SpriteRenderer::IsInstancingEnabled();
+	Material* material = shouldInstance ? m_instancedMaterial : m_emitterMeshRenderer->GetMaterial();
+
+	size_t runStart = 0;
+	while ( runStart < m_particles.size() )
+	{
+		//A packet per run of particles sharing a texture, capped like Render()'s batches so it always fits the transient ring.
+		unsigned int textureID = m_particles[ runStart ].m_sprite->GetDiffuseTextureID();
+		size_t runEnd = runStart + 1;
+		while ( ( runEnd < m_particles.size() ) && ( runEnd - runStart < MAX_BATCH_SIZE ) && ( m_particles[ runEnd ].m_sprite->GetDiffuseTextureID() == textureID ) )
+			++runEnd;
+		unsigned int numParticles = runEnd - runStart;
+
+		RenderSortKey sortKey = RenderQueue::MakeSortKey( layerID, orderInLayer, isStateSorted ? material : nullptr, isStateSorted ? textureID : 0 );
+		if ( shouldInstance )
+		{
+			SpriteInstance* instances = commandBuffer->AddInstancedDraw( sortKey, material, uniforms, textureID, numParticles );
+			for ( unsigned int particleIndex = 0; particleIndex < numParticles; particleIndex++ )
+			{
+				Particle& currentParticle = m_particles[ runStart + particleIndex ];
+
+				Sprite* sprite = currentParticle.m_sprite;
+				sprite->m_transform.m_position = currentParticle.m_physicsInfo->GetPosition().xy();
+				sprite->m_transform.m_scale = currentParticle.m_scale;
+
+				SpriteRenderer::WriteSpriteInstance( sprite, currentParticle.m_tint, instances + particleIndex );
+			}
+
+			runStart = runEnd;
+			continue;
+		}
+
+		unsigned int* indices;
+		Vertex2D_PCT* vertices = static_cast<Vertex2D_PCT*>( commandBuffer->AddTransientDraw( sortKey, material, uniforms, textureID, AS_TRIANGLES, Vertex2D_PCT::DEFINITION, numParticles * 4, numParticles * 6, &indices ) );
+
+		for ( unsigned int particleIndex = 0; particleIndex < numParticles; particleIndex++ )
+		{
+			Particle& currentParticle = m_particles[ runStart + particleIndex ];
+
+			Sprite* sprite = currentParticle.m_sprite;
+			sprite->m_transform.m_position = currentParticle.m_physicsInfo->GetPosition().xy();
+			sprite->m_transform.m_scale = currentParticle.m_scale;
+
+			SpriteRenderer::WriteSpriteQuad( sprite->GetVirtualBoundsInWorld(), currentParticle.m_tint, sprite->GetSpriteResource()->GetTexCoords(), particleIndex * 4, vertices + ( particleIndex * 4 ), indices + ( particleIndex * 6 ) );
+		}
+
+		runStart = runEnd;
+	}
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 ParticleEmitter::ParticleEmitter()
 	: m_isMarkedForDeletion( false )
 	, m_emitterDefinition( nullptr )
 	, m_numInitialSpawnsLeft( 0 )
 	, m_emitterMeshRenderer( new MeshRenderer( m_particleBatchMesh, nullptr ) )
+	, m_instancedMaterial( nullptr )
 	, m_particleBatchMesh( std::shared_ptr<Mesh>( new Mesh( BufferUsage::STATIC_DRAW, Vertex2D_PCT::DEFINITION, 0, nullptr, 0, nullptr, 0, nullptr ) ) )
 	, m_secondsSinceLastSpawn( 0.f )
 {
@@ -125,11 +185,12 @@ int ParticleEmitter::FillMesh( Particle* baseAddress, unsigned int numToAdd )
 
 
 		AABB2f worldBounds = sprite->GetVirtualBoundsInWorld();
+		const AABB2f& texCoords = sprite->GetSpriteResource()->GetTexCoords();
 
-		vertices.push_back( Vertex2D_PCT( Vector2f( worldBounds.mins.x, worldBounds.maxs.y ),	currentParticle->m_tint,	Vector2f( 0.f, 0.f ) ) ); //Top-left.		//0
-		vertices.push_back( Vertex2D_PCT( Vector2f( worldBounds.maxs.x, worldBounds.mins.y ),	currentParticle->m_tint,	Vector2f( 1.f, 1.f ) ) ); //Bottom-right.	//1
-		vertices.push_back( Vertex2D_PCT( worldBounds.mins,										currentParticle->m_tint,	Vector2f( 0.f, 1.f ) ) ); //Bottom-left.	//2
-		vertices.push_back( Vertex2D_PCT( worldBounds.maxs,										currentParticle->m_tint,	Vector2f( 1.f, 0.f ) ) ); //Top-right.	//3
+		vertices.push_back( Vertex2D_PCT( Vector2f( worldBounds.mins.x, worldBounds.maxs.y ),	currentParticle->m_tint,	texCoords.mins ) ); //Top-left.		//0
+		vertices.push_back( Vertex2D_PCT( Vector2f( worldBounds.maxs.x, worldBounds.mins.y ),	currentParticle->m_tint,	texCoords.maxs ) ); //Bottom-right.	//1
+		vertices.push_back( Vertex2D_PCT( worldBounds.mins,										currentParticle->m_tint,	Vector2f( texCoords.mins.x, texCoords.maxs.y ) ) ); //Bottom-left.	//2
+		vertices.push_back( Vertex2D_PCT( worldBounds.maxs,										currentParticle->m_tint,	Vector2f( texCoords.maxs.x, texCoords.mins.y ) ) ); //Top-right.	//3
 
 		indices.push_back( 2 );
 		indices.push_back( 1 );
@@ -11,6 +11,8 @@
 class ParticleEmitterDefinition;
 class Material;
 class MeshRenderer;
+class RenderCommandBuffer;
+struct RenderUniformBlock;
 
 
 
@@ -30,6 +32,7 @@ public:
 
 	void Update( float deltaSeconds );
 	void Render();
+	void RecordDraws( RenderCommandBuffer* commandBuffer, RenderLayerID layerID, unsigned int orderInLayer, bool isStateSorted, const RenderUniformBlock* uniforms ); //RenderQueue version of Render().
 	void MarkForDeletion();
 
 
@@ -47,4 +50,5 @@ private:
 
 	std::shared_ptr<Mesh> m_particleBatchMesh;
 	MeshRenderer* m_emitterMeshRenderer; //Material's kept on here until needs change.
+	Material* m_instancedMaterial; //Same render state, InstancedSprite shader, for RecordDraws. Shared by all emitters of a definition, not owned.
 };
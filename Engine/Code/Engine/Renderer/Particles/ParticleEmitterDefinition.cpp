@@ -3,6 +3,7 @@
 #include "Engine/Renderer/AnimatedSprite.hpp"
 #include "Engine/Physics/PhysicsUtils.hpp"
 #include "Engine/Renderer/ResourceDatabase.hpp"
+#include "Engine/Math/RandomStream.hpp"
 
 
 
@@ -86,10 +87,11 @@ void ParticleEmitterDefinition::Destroy( std::vector<Particle>& particles ) cons
 int ParticleEmitterDefinition::Spawn( std::vector<Particle>& particles, const WorldCoords2D& position, float& secondsSinceLastSpawn ) const
 {
 	int numSpawned = 0;
+	RandomStream& randomStream = RandomStream::GetThreadLocal(); //Looked up once, not per draw.
 
 	while ( ( secondsSinceLastSpawn >= m_secondsPerSpawn ) && ( numSpawned < m_initialSpawnCount ) )
 	{
-		particles.push_back( ParticleEmitterDefinition::SpawnParticle( position ) );
+		particles.push_back( ParticleEmitterDefinition::SpawnParticle( position, randomStream ) );
 
 		secondsSinceLastSpawn -= m_secondsPerSpawn;
 
@@ -101,18 +103,18 @@ int ParticleEmitterDefinition::Spawn( std::vector<Particle>& particles, const Wo
 
 
 //--------------------------------------------------------------------------------------------------------------
-Particle ParticleEmitterDefinition::SpawnParticle( const WorldCoords2D& position ) const
+Particle ParticleEmitterDefinition::SpawnParticle( const WorldCoords2D& position, RandomStream& randomStream ) const
 {
 	Particle p;
 	p.m_currentAgeSeconds = 0.f;
-	p.m_maxAgeSeconds = m_lifetimeSeconds.GetRandomElement();
-	p.m_scale = m_initialScale.GetRandomElement();
+	p.m_maxAgeSeconds = m_lifetimeSeconds.GetRandomElement( randomStream );
+	p.m_scale = m_initialScale.GetRandomElement( randomStream );
 
 	LinearDynamicsState* lds = new LinearDynamicsState();
 	lds->SetPosition( Vector3f( position.x, position.y, 0.f ) );
-	Vector2f vel = m_initialVelocity.GetRandomElement();
+	Vector2f vel = m_initialVelocity.GetRandomElement( randomStream );
 	lds->SetVelocity( Vector3f( vel.x, vel.y, 0.f ) );
-	p.m_mass = m_mass.GetRandomElement();
+	p.m_mass = m_mass.GetRandomElement( randomStream );
 	p.m_physicsInfo = lds;
 
 	p.m_tint = m_tint;
@@ -11,6 +11,7 @@
 class Sprite;
 class SpriteResource;
 class AnimatedSpriteSequence;
+class RandomStream;
 
 
 //-----------------------------------------------------------------------------
@@ -46,8 +47,8 @@ public:
 	void SetBlendState( ParticleBlendState );
 	void Update( std::vector<Particle>& particles, float deltaSeconds ) const;
 	void Destroy( std::vector<Particle>& particles ) const;
-	int Spawn( std::vector<Particle>& particles, const WorldCoords2D& position, float& secondsSinceLastSpawn ) const;
-	Particle SpawnParticle( const WorldCoords2D& position ) const;
+	int Spawn( std::vector<Particle>& particles, const WorldCoords2D& position, float& secondsSinceLastSpawn ) const; //Draws from the calling thread's RandomStream.
+	Particle SpawnParticle( const WorldCoords2D& position, RandomStream& randomStream ) const;
 
 
 private:
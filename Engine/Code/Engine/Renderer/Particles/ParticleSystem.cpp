@@ -116,3 +116,11 @@ void ParticleSystem::Render()
 	for ( ParticleEmitter* emitter : m_emitters )
 		emitter->Render();
 }
+
+
+//--------------------------------------------------------------------------------------------------------------
+void ParticleSystem::RecordDraws( RenderCommandBuffer* commandBuffer, RenderLayerID layerID, unsigned int orderInLayer, bool isStateSorted, const RenderUniformBlock* uniforms )
+{
+	for ( ParticleEmitter* emitter : m_emitters )
+		emitter->RecordDraws( commandBuffer, layerID, orderInLayer, isStateSorted, uniforms );
+}
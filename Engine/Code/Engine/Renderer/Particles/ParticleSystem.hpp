@@ -8,6 +8,8 @@
 //-----------------------------------------------------------------------------
 class ParticleSystemDefinition;
 class ParticleEmitter;
+class RenderCommandBuffer;
+struct RenderUniformBlock;
 
 
 
@@ -29,6 +31,7 @@ public:
 
 	void Update( float deltaSeconds );
 	void Render();
+	void RecordDraws( RenderCommandBuffer* commandBuffer, RenderLayerID layerID, unsigned int orderInLayer, bool isStateSorted, const RenderUniformBlock* uniforms ); //RenderQueue version of Render().
 
 
 private:
@@ -0,0 +1,526 @@
+#include "Engine/Renderer/PostProcessGraph.hpp"
+
+
+#include "Engine/EngineCommon.hpp"
+#include "Engine/Renderer/TheRenderer.hpp"
+#include "Engine/Renderer/OpenGLExtensions.hpp"
+#include "Engine/Renderer/FrameBuffer.hpp"
+#include "Engine/Renderer/FramebufferEffect.hpp"
+#include "Engine/Renderer/MeshRenderer.hpp"
+#include "Engine/Renderer/Material.hpp"
+#include "Engine/Renderer/Shader.hpp"
+#include "Engine/Renderer/Sampler.hpp"
+#include "Engine/Renderer/RenderState.hpp"
+#include "Engine/Renderer/Vertexes.hpp"
+#include "Engine/Renderer/Rgba.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/String/StringUtils.hpp"
+#include "Engine/Core/Command.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Time/Time.hpp"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC PerPixelEffectRegistryMap PostProcessGraph::s_perPixelEffectBodies;
+static const char* FBO_EFFECT_NAME_PREFIX = "FboEffect_"; //See TheRenderer::AddFullscreenFboEffect.
+static const RenderState POST_PROCESS_PASS_RENDER_STATE = RenderState( CULL_MODE_NONE, BLEND_MODE_ONE, BLEND_MODE_ZERO, DEPTH_COMPARE_MODE_ALWAYS, false ); //Overwrites, never blends.
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const char* BUILT_IN_PER_PIXEL_EFFECTS[][ 2 ] =
+{
+	{ "Grayscale", "return vec4( vec3( dot( color.rgb, vec3( .2126, .7152, .0722 ) ) ), color.a );" },
+	{ "Negative", "return vec4( vec3( 1.0 ) - color.rgb, color.a );" },
+	{ "Sepia", "return vec4( min( vec3( dot( color.rgb, vec3( .393, .769, .189 ) ), dot( color.rgb, vec3( .349, .686, .168 ) ), dot( color.rgb, vec3( .272, .534, .131 ) ) ), vec3( 1.0 ) ), color.a );" },
+	{ "Vignette", "float distanceFromCenter = length( uv - vec2( .5 ) ) * 1.41421356; return vec4( color.rgb * ( 1.0 - ( .6 * distanceFromCenter * distanceFromCenter ) ), color.a );" },
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+//The default FBO quad's UVs run opposite its positions (post.vert undoes that with -inUV0 and a repeating sampler), so
+//flipping them here gives 0 to 1 screen UVs that work under clamping too. No matrices: the quad is already in NDC.
+static const char* PASS_VERTEX_SHADER_SOURCE = "\
+#version 410 core\n\
+\n\
+in vec3 inPosition;\n\
+in vec2 inUV0;\n\
+\n\
+out vec2 passUV0;\n\
+\n\
+void main()\n\
+{\n\
+	passUV0 = vec2( 1.0 ) - inUV0;\n\
+	gl_Position = vec4( inPosition, 1.0 );\n\
+}";
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const char* PASS_FRAGMENT_SHADER_HEADER = "\
+#version 410 core\n\
+\n\
+uniform sampler2D uTexDiffuse;\n\
+uniform vec2 uSourceUVScale; //Sub-rect of uTexDiffuse to read, for dynamic resolution.\n\
+uniform float uUnwrappedTimer;\n\
+uniform float uWrappingTimer;\n\
+uniform float uWrappingTimerDuration;\n\
+\n\
+in vec2 passUV0;\n\
+\n\
+out vec4 outColor;\n\
+";
+
+
+//--------------------------------------------------------------------------------------------------------------
+PostProcessGraph::PostProcessGraph( std::shared_ptr<Mesh> fullscreenQuad )
+	: m_fullscreenQuad( fullscreenQuad )
+	, m_arePassesDirty( true )
+	, m_isFusionEnabled( true )
+{
+	//Clamped, so bilinear upscaling of a sub-rect doesn't pull in the opposite edge.
+	m_bilinearSampler = new Sampler( SamplerFilter::FILTER_LINEAR, SamplerFilter::FILTER_LINEAR, SamplerWrapMode::WRAP_CLAMP_TO_EDGE, SamplerWrapMode::WRAP_CLAMP_TO_EDGE );
+
+	const unsigned int NUM_BUILT_IN_EFFECTS = sizeof( BUILT_IN_PER_PIXEL_EFFECTS ) / sizeof( BUILT_IN_PER_PIXEL_EFFECTS[ 0 ] );
+	for ( unsigned int effectIndex = 0; effectIndex < NUM_BUILT_IN_EFFECTS; effectIndex++ )
+		s_perPixelEffectBodies.insert( PerPixelEffectRegistryPair( BUILT_IN_PER_PIXEL_EFFECTS[ effectIndex ][ 0 ], BUILT_IN_PER_PIXEL_EFFECTS[ effectIndex ][ 1 ] ) ); //Keeps any game override.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+PostProcessGraph::~PostProcessGraph()
+{
+	//Their Materials go with the rest in Material::DeleteMaterials.
+	for ( auto& fusedPass : m_fusedPassRenderers )
+		delete fusedPass.second;
+	m_fusedPassRenderers.clear();
+
+	delete m_bilinearSampler;
+	m_bilinearSampler = nullptr;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void PostProcessGraph::RegisterPerPixelEffect( const std::string& effectName, const char* glslBody )
+{
+	s_perPixelEffectBodies[ effectName ] = glslBody; //Passes compiled before keep the old body.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool PostProcessGraph::AddEffect( const std::string& effectName )
+{
+	Effect effect;
+	effect.name = effectName;
+	effect.fullscreenRenderer = nullptr;
+
+	if ( s_perPixelEffectBodies.find( effectName ) == s_perPixelEffectBodies.end() )
+	{
+		const FboEffectRegistryMap* fboEffects = FramebufferEffect::GetFboEffectRendererRegistry();
+		FboEffectRegistryMap::const_iterator found = fboEffects->find( effectName );
+		if ( found == fboEffects->end() )
+			found = fboEffects->find( FBO_EFFECT_NAME_PREFIX + effectName );
+		if ( found == fboEffects->end() )
+			return false;
+
+		effect.name = found->first;
+		effect.fullscreenRenderer = found->second->m_fboEffectRenderer;
+	}
+
+	m_effects.push_back( effect );
+	m_arePassesDirty = true;
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void PostProcessGraph::ClearEffects()
+{
+	m_effects.clear();
+	m_arePassesDirty = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool PostProcessGraph::DoesAnyEffectReadDepth() const
+{
+	for ( const Effect& effect : m_effects )
+	{
+		if ( ( effect.fullscreenRenderer != nullptr ) && ( effect.fullscreenRenderer->GetMaterial()->GetUniformHandle( "uTexDepth" ) != INVALID_UNIFORM_HANDLE ) )
+			return true;
+	}
+	return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void PostProcessGraph::SetFusionEnabled( bool isFusionEnabled )
+{
+	if ( isFusionEnabled == m_isFusionEnabled )
+		return;
+
+	m_isFusionEnabled = isFusionEnabled;
+	m_arePassesDirty = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int PostProcessGraph::GetNumPasses()
+{
+	if ( m_arePassesDirty )
+		CompilePasses();
+
+	return m_passes.size();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void PostProcessGraph::CompilePasses()
+{
+	m_passes.clear();
+
+	std::vector<std::string> perPixelRun;
+	for ( const Effect& effect : m_effects )
+	{
+		if ( effect.fullscreenRenderer == nullptr )
+		{
+			perPixelRun.push_back( effect.name );
+			if ( m_isFusionEnabled )
+				continue;
+		}
+
+		if ( !perPixelRun.empty() )
+		{
+			Pass fusedPass = { CreateOrGetFusedPass( perPixelRun ), true };
+			m_passes.push_back( fusedPass );
+			perPixelRun.clear();
+		}
+
+		if ( effect.fullscreenRenderer != nullptr )
+		{
+			Pass fullscreenPass = { effect.fullscreenRenderer, false };
+			m_passes.push_back( fullscreenPass );
+		}
+	}
+
+	if ( !perPixelRun.empty() || m_passes.empty() ) //An empty chain still needs a pass to resolve the scene.
+	{
+		Pass fusedPass = { CreateOrGetFusedPass( perPixelRun ), true };
+		m_passes.push_back( fusedPass );
+	}
+
+	m_arePassesDirty = false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+MeshRenderer* PostProcessGraph::CreateOrGetFusedPass( const std::vector<std::string>& perPixelEffectNames )
+{
+	std::string passName = "PostProcessPass";
+	for ( const std::string& effectName : perPixelEffectNames )
+		passName += "_" + effectName;
+
+	std::map< std::string, MeshRenderer* >::iterator found = m_fusedPassRenderers.find( passName );
+	if ( found != m_fusedPassRenderers.end() )
+		return found->second;
+
+	//Each effect becomes a function, called in chain order on a color that stays in registers between them.
+	std::string fragmentSource = PASS_FRAGMENT_SHADER_HEADER;
+	for ( const std::string& effectName : perPixelEffectNames )
+		fragmentSource += Stringf( "\nvec4 PostProcess_%s( vec4 color, vec2 uv )\n{\n\t%s\n}\n", effectName.c_str(), s_perPixelEffectBodies[ effectName ].c_str() );
+
+	fragmentSource += "\nvoid main()\n{\n";
+	fragmentSource += "\tvec2 halfTexel = vec2( .5 ) / vec2( textureSize( uTexDiffuse, 0 ) );\n"; //Keeps bilinear taps inside the sub-rect.
+	fragmentSource += "\tvec4 color = texture( uTexDiffuse, min( passUV0 * uSourceUVScale, uSourceUVScale - halfTexel ) );\n";
+	for ( const std::string& effectName : perPixelEffectNames )
+		fragmentSource += Stringf( "\tcolor = PostProcess_%s( color, passUV0 );\n", effectName.c_str() );
+	fragmentSource += "\toutColor = color;\n}\n";
+
+	//Raw-source shaders have no create-or-get, but each pass compiles only once, when first needed.
+	Shader* vertexShader = Shader::CreateShaderFromSource( PASS_VERTEX_SHADER_SOURCE, strlen( PASS_VERTEX_SHADER_SOURCE ), ShaderType::VERTEX_SHADER );
+	Shader* fragmentShader = Shader::CreateShaderFromSource( fragmentSource.c_str(), fragmentSource.size(), ShaderType::FRAGMENT_SHADER );
+	Material* passMaterial = Material::CreateOrGetMaterial( passName, &POST_PROCESS_PASS_RENDER_STATE, &Vertex3D_PCUTB::DEFINITION, passName.c_str(), vertexShader, fragmentShader );
+	passMaterial->SetSampler( "uTexDiffuse", m_bilinearSampler->GetSamplerID() );
+
+	MeshRenderer* passRenderer = new MeshRenderer( m_fullscreenQuad, passMaterial );
+	m_fusedPassRenderers[ passName ] = passRenderer;
+	return passRenderer;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void PostProcessGraph::Execute( FrameBuffer* source, unsigned int sourceWidth, unsigned int sourceHeight, FrameBuffer* destination )
+{
+	if ( m_arePassesDirty )
+		CompilePasses();
+
+	Vector2f sourceUVScale( static_cast<float>( sourceWidth ) / source->GetWidth(), static_cast<float>( sourceHeight ) / source->GetHeight() );
+	bool isSourceSubRect = ( sourceWidth != source->GetWidth() ) || ( sourceHeight != source->GetHeight() );
+	bool needsResolvePass = isSourceSubRect && !m_passes[ 0 ].canReadSubRect;
+	Pass resolvePass = { needsResolvePass ? CreateOrGetFusedPass( std::vector<std::string>() ) : nullptr, true };
+
+	unsigned int outputWidth = ( destination != nullptr ) ? destination->GetWidth() : static_cast<unsigned int>( g_theRenderer->GetScreenWidth() );
+	unsigned int outputHeight = ( destination != nullptr ) ? destination->GetHeight() : static_cast<unsigned int>( g_theRenderer->GetScreenHeight() );
+
+	unsigned int numPasses = m_passes.size() + ( needsResolvePass ? 1 : 0 );
+	FrameBuffer* input = source;
+	for ( unsigned int passIndex = 0; passIndex < numPasses; passIndex++ )
+	{
+		const Pass& pass = needsResolvePass ? ( ( passIndex == 0 ) ? resolvePass : m_passes[ passIndex - 1 ] ) : m_passes[ passIndex ];
+		bool isLastPass = ( passIndex == numPasses - 1 );
+
+		FrameBuffer* output = isLastPass ? destination : m_targetPool.Acquire( outputWidth, outputHeight, TextureFormat::TEXTURE_FORMAT_Rgba8, false );
+		RenderPass( pass, input, source, ( input == source ) ? sourceUVScale : Vector2f::ONE, output );
+
+		if ( input != source )
+			m_targetPool.Release( input ); //The source stays the caller's: later passes may still read its depth.
+		input = output;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void PostProcessGraph::RenderPass( const Pass& pass, FrameBuffer* input, FrameBuffer* source, const Vector2f& inputUVScale, FrameBuffer* output )
+{
+	g_theRenderer->BindFBO( output, false );
+
+	MeshRenderer* passRenderer = pass.renderer;
+	passRenderer->SetTexture( "uTexDiffuse", input->GetColorTextureID( 0 ) );
+	if ( source->HasDepthStencilRenderTarget() )
+		passRenderer->SetTexture( "uTexDepth", source->GetDepthStencilTextureID() );
+
+	if ( pass.canReadSubRect )
+	{
+		passRenderer->SetVector2( "uSourceUVScale", &inputUVScale );
+	}
+	else
+	{
+		//FramebufferEffect materials blend, so don't let them blend over whatever a reused target held last.
+		g_theRenderer->ClearScreenToColor( Rgba::BLACK );
+
+		//UpdateSceneMVP sets every program's uView and uProj to the camera's each frame.
+		passRenderer->SetMatrix4x4( "uModel", false, &Matrix4x4f::IDENTITY );
+		passRenderer->SetMatrix4x4( "uView", false, &Matrix4x4f::IDENTITY );
+		passRenderer->SetMatrix4x4( "uProj", false, &Matrix4x4f::IDENTITY );
+	}
+
+	passRenderer->Render();
+}
+
+
+#ifndef ENGINE_HEADLESS //The test and its helpers: it reads back pixels, which needs a real GL context.
+//--------------------------------------------------------------------------------------------------------------
+static const unsigned int TEST_PATTERN_CELLS_PER_SIDE = 8;
+
+
+//--------------------------------------------------------------------------------------------------------------
+static Rgba GetTestPatternColor( unsigned int cellX, unsigned int cellY )
+{
+	return Rgba( static_cast<byte_t>( 20 + ( cellX * 30 ) ), static_cast<byte_t>( 235 - ( cellY * 30 ) ), static_cast<byte_t>( ( ( cellX + cellY ) * 17 ) % 256 ), static_cast<byte_t>( 255 ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void DrawTestPattern( FrameBuffer* target, unsigned int patternSize )
+{
+	//Scissored clears, so the pattern's texels are exact without depending on any shader.
+	g_theRenderer->BindFBO( target, false );
+	g_theRenderer->ClearScreenToColor( Rgba::MAGENTA ); //Outside the pattern, a bad sub-rect read shows.
+
+	unsigned int cellSize = patternSize / TEST_PATTERN_CELLS_PER_SIDE;
+	glEnable( GL_SCISSOR_TEST );
+	for ( unsigned int cellY = 0; cellY < TEST_PATTERN_CELLS_PER_SIDE; cellY++ )
+	{
+		for ( unsigned int cellX = 0; cellX < TEST_PATTERN_CELLS_PER_SIDE; cellX++ )
+		{
+			glScissor( cellX * cellSize, cellY * cellSize, cellSize, cellSize );
+			g_theRenderer->ClearScreenToColor( GetTestPatternColor( cellX, cellY ) );
+		}
+	}
+	glDisable( GL_SCISSOR_TEST );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void ReadBackPixels( FrameBuffer* target, std::vector<byte_t>& out_rgbaPixels )
+{
+	g_theRenderer->BindFBO( target, false );
+	out_rgbaPixels.resize( target->GetWidth() * target->GetHeight() * 4 );
+	glReadPixels( 0, 0, target->GetWidth(), target->GetHeight(), GL_RGBA, GL_UNSIGNED_BYTE, out_rgbaPixels.data() );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void ApplyTestChainOnCpu( float* rgb, float u, float v ) //Mirrors the test's chain: Sepia, Vignette, Negative.
+{
+	float sepia[ 3 ] =
+	{
+		GetMin( ( rgb[ 0 ] * .393f ) + ( rgb[ 1 ] * .769f ) + ( rgb[ 2 ] * .189f ), 1.f ),
+		GetMin( ( rgb[ 0 ] * .349f ) + ( rgb[ 1 ] * .686f ) + ( rgb[ 2 ] * .168f ), 1.f ),
+		GetMin( ( rgb[ 0 ] * .272f ) + ( rgb[ 1 ] * .534f ) + ( rgb[ 2 ] * .131f ), 1.f )
+	};
+
+	float distanceFromCenter = sqrtf( ( ( u - .5f ) * ( u - .5f ) ) + ( ( v - .5f ) * ( v - .5f ) ) ) * 1.41421356f;
+	float vignette = 1.f - ( .6f * distanceFromCenter * distanceFromCenter );
+
+	for ( int channel = 0; channel < 3; channel++ )
+		rgb[ channel ] = 1.f - ( sepia[ channel ] * vignette );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static unsigned int CountTestChainMismatches( const std::vector<byte_t>& rgbaPixels, unsigned int size, int tolerance, int& out_maxError )
+{
+	unsigned int cellSize = size / TEST_PATTERN_CELLS_PER_SIDE;
+	unsigned int numMismatches = 0;
+	out_maxError = 0;
+	for ( unsigned int y = 0; y < size; y++ )
+	{
+		for ( unsigned int x = 0; x < size; x++ )
+		{
+			Rgba patternColor = GetTestPatternColor( x / cellSize, y / cellSize );
+			float rgb[ 3 ] = { patternColor.red / 255.f, patternColor.green / 255.f, patternColor.blue / 255.f };
+			ApplyTestChainOnCpu( rgb, ( x + .5f ) / size, ( y + .5f ) / size );
+
+			int worstChannelError = 0;
+			for ( int channel = 0; channel < 3; channel++ )
+			{
+				int expected = static_cast<int>( ( Clamp( rgb[ channel ], 0.f, 1.f ) * 255.f ) + .5f );
+				int error = abs( expected - static_cast<int>( rgbaPixels[ ( ( ( y * size ) + x ) * 4 ) + channel ] ) );
+				worstChannelError = GetMax( worstChannelError, error );
+			}
+			out_maxError = GetMax( out_maxError, worstChannelError );
+			if ( worstChannelError > tolerance )
+				++numMismatches;
+		}
+	}
+	return numMismatches;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool RunPostProcessTest( unsigned int size )
+{
+	//Borrow the renderer's graph, so this tests the instance frames use, then put its chain back.
+	PostProcessGraph* graph = g_theRenderer->GetPostProcessGraph();
+	RenderTargetPool* pool = graph->GetTargetPool();
+	std::vector<std::string> savedEffectNames;
+	for ( unsigned int effectIndex = 0; effectIndex < graph->GetNumEffects(); effectIndex++ )
+		savedEffectNames.push_back( graph->GetEffectName( effectIndex ) );
+	bool wasFusionEnabled = graph->IsFusionEnabled();
+	unsigned int numTargetsInUseBefore = pool->GetNumTargetsInUse();
+
+	FrameBuffer* source = pool->Acquire( size, size, TextureFormat::TEXTURE_FORMAT_Rgba8, false );
+	FrameBuffer* fusedResult = pool->Acquire( size, size, TextureFormat::TEXTURE_FORMAT_Rgba8, false );
+	FrameBuffer* unfusedResult = pool->Acquire( size, size, TextureFormat::TEXTURE_FORMAT_Rgba8, false );
+	DrawTestPattern( source, size );
+
+	graph->ClearEffects();
+	graph->AddEffect( "Sepia" );
+	graph->AddEffect( "Vignette" );
+	graph->AddEffect( "Negative" );
+
+	graph->SetFusionEnabled( true );
+	unsigned int numFusedPasses = graph->GetNumPasses();
+	graph->Execute( source, size, size, fusedResult );
+
+	graph->SetFusionEnabled( false );
+	unsigned int numUnfusedPasses = graph->GetNumPasses();
+	graph->Execute( source, size, size, unfusedResult );
+	unsigned int numTargetsAfterFirstRun = pool->GetNumTargets();
+
+	//Each result against the CPU, allowing a little for 8-bit rounding between unfused passes.
+	const int TOLERANCE = 3;
+	std::vector<byte_t> fusedPixels;
+	std::vector<byte_t> unfusedPixels;
+	ReadBackPixels( fusedResult, fusedPixels );
+	ReadBackPixels( unfusedResult, unfusedPixels );
+	int fusedMaxError;
+	int unfusedMaxError;
+	unsigned int numFusedMismatches = CountTestChainMismatches( fusedPixels, size, TOLERANCE, fusedMaxError );
+	unsigned int numUnfusedMismatches = CountTestChainMismatches( unfusedPixels, size, TOLERANCE, unfusedMaxError );
+
+	//Timing repeats double as the aliasing check: running the chains again may not add a single target.
+	const int NUM_TIMED_RUNS = 20;
+	double chainMs[ 2 ];
+	for ( int fusionIndex = 0; fusionIndex < 2; fusionIndex++ )
+	{
+		graph->SetFusionEnabled( fusionIndex == 0 );
+		glFinish();
+		double startSeconds = GetCurrentTimeSeconds();
+		for ( int runIndex = 0; runIndex < NUM_TIMED_RUNS; runIndex++ )
+			graph->Execute( source, size, size, ( fusionIndex == 0 ) ? fusedResult : unfusedResult );
+		glFinish();
+		chainMs[ fusionIndex ] = ( GetCurrentTimeSeconds() - startSeconds ) * 1000.0 / NUM_TIMED_RUNS;
+	}
+	unsigned int numTargetsAfterRepeats = pool->GetNumTargets();
+
+	//Dynamic resolution: the pattern drawn into a half-size sub-rect must come out whole. Checks only cell centers,
+	//where bilinear upscaling has nothing to blend with.
+	graph->ClearEffects();
+	DrawTestPattern( source, size / 2 );
+	graph->Execute( source, size / 2, size / 2, fusedResult );
+	std::vector<byte_t> upscaledPixels;
+	ReadBackPixels( fusedResult, upscaledPixels );
+	unsigned int cellSize = size / TEST_PATTERN_CELLS_PER_SIDE;
+	unsigned int numUpscaleMismatches = 0;
+	for ( unsigned int cellY = 0; cellY < TEST_PATTERN_CELLS_PER_SIDE; cellY++ )
+	{
+		for ( unsigned int cellX = 0; cellX < TEST_PATTERN_CELLS_PER_SIDE; cellX++ )
+		{
+			Rgba expected = GetTestPatternColor( cellX, cellY );
+			const byte_t* actual = &upscaledPixels[ ( ( ( ( cellY * cellSize ) + ( cellSize / 2 ) ) * size ) + ( cellX * cellSize ) + ( cellSize / 2 ) ) * 4 ];
+			if ( ( abs( actual[ 0 ] - expected.red ) > 1 ) || ( abs( actual[ 1 ] - expected.green ) > 1 ) || ( abs( actual[ 2 ] - expected.blue ) > 1 ) )
+				++numUpscaleMismatches;
+		}
+	}
+
+	pool->Release( source );
+	pool->Release( fusedResult );
+	pool->Release( unfusedResult );
+	g_theRenderer->BindFBO( nullptr );
+
+	graph->ClearEffects();
+	for ( const std::string& effectName : savedEffectNames )
+		graph->AddEffect( effectName );
+	graph->SetFusionEnabled( wasFusionEnabled );
+
+	bool didFusedPass = ( numFusedMismatches == 0 ) && ( numFusedPasses == 1 );
+	bool didUnfusedPass = ( numUnfusedMismatches == 0 ) && ( numUnfusedPasses == 3 );
+	bool didAliasingPass = ( numTargetsAfterRepeats == numTargetsAfterFirstRun ) && ( pool->GetNumTargetsInUse() == numTargetsInUseBefore );
+	bool didUpscalePass = ( numUpscaleMismatches == 0 );
+
+	g_theConsole->Printf( "PostProcessTest: Sepia > Vignette > Negative on a %ux%u pattern, checked against the CPU to within %d", size, size, TOLERANCE );
+	g_theConsole->Printf( "  Fused: %u pass, %.3f ms, %u pixels off, worst by %d: %s", numFusedPasses, chainMs[ 0 ], numFusedMismatches, fusedMaxError, didFusedPass ? "PASS" : "FAIL" );
+	g_theConsole->Printf( "  Unfused: %u passes, %.3f ms, %u pixels off, worst by %d: %s", numUnfusedPasses, chainMs[ 1 ], numUnfusedMismatches, unfusedMaxError, didUnfusedPass ? "PASS" : "FAIL" );
+	g_theConsole->Printf( "  Pool: %u targets after the first runs, %u after %d more of each, %u in use after: %s", numTargetsAfterFirstRun, numTargetsAfterRepeats,
+						  NUM_TIMED_RUNS, pool->GetNumTargetsInUse(), didAliasingPass ? "PASS" : "FAIL" );
+	g_theConsole->Printf( "  Half-size sub-rect upscaled: %u of %u cells off: %s", numUpscaleMismatches, TEST_PATTERN_CELLS_PER_SIDE * TEST_PATTERN_CELLS_PER_SIDE, didUpscalePass ? "PASS" : "FAIL" );
+	bool didPass = didFusedPass && didUnfusedPass && didAliasingPass && didUpscalePass;
+	g_theConsole->Printf( "PostProcessTest: %s", didPass ? "PASS" : "FAIL" );
+	return didPass;
+}
+
+#endif
+
+
+//--------------------------------------------------------------------------------------------------------------
+void PostProcessTest( Command& args )
+{
+#ifdef ENGINE_HEADLESS
+	UNREFERENCED( args );
+	g_theConsole->Printf( "PostProcessTest needs a real GL context, so is unavailable in the headless build." );
+#else
+	int requestedSize;
+	args.GetNextInt( &requestedSize, 64 );
+	if ( requestedSize < 32 || requestedSize > 1024 )
+	{
+		g_theConsole->Printf( "Usage: PostProcessTest [32 <= size <= 1024, default 64]" );
+		return;
+	}
+
+	RunPostProcessTest( static_cast<unsigned int>( requestedSize ) & ~15u ); //Whole pattern cells, at full and half size.
+#endif
+}
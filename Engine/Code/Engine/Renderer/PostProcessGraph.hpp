@@ -0,0 +1,98 @@
+#pragma once
+
+
+#include "Engine/Renderer/RenderTargetPool.hpp"
+#include "Engine/Memory/UntrackedAllocator.hpp"
+#include "Engine/Math/Vector2.hpp"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+//-----------------------------------------------------------------------------
+class Command;
+class FrameBuffer;
+class Material;
+class Mesh;
+class MeshRenderer;
+class Sampler;
+typedef std::pair< std::string, std::string > PerPixelEffectRegistryPair;
+typedef std::map< std::string, std::string, std::less<std::string>, UntrackedAllocator<PerPixelEffectRegistryPair> > PerPixelEffectRegistryMap;
+
+
+//-----------------------------------------------------------------------------
+//A chain of fullscreen effects run on the scene before 2D draws over it. Effects are of two kinds:
+//
+//	- Per-pixel effects are GLSL bodies of "vec4 <name>( vec4 color, vec2 uv )": they see only their own pixel's color
+//	  and screen position, plus the uUnwrappedTimer/uWrappingTimer/uWrappingTimerDuration uniforms every program gets.
+//	  Consecutive ones fuse into one generated shader, so a run of them costs one pass instead of one each.
+//	- Fullscreen effects are the FramebufferEffects TheRenderer::AddFullscreenFboEffect registered, which may sample
+//	  neighbors or uTexDepth, so each is its own pass.
+//
+//Passes in between read and write targets from a RenderTargetPool, each released once the next pass has read it, so
+//any chain alternates between two. The last pass writes straight to the destination.
+//
+//For dynamic resolution, the scene may cover only the lower-left sub-rect of its target, so resizing never allocates.
+//The first pass reads just that sub-rect, upscaling with bilinear filtering, and every pass after runs at the
+//destination's size. A chain starting with a fullscreen effect gets a plain per-pixel pass ahead of it to do that, as
+//FramebufferEffect shaders expect a whole target.
+class PostProcessGraph
+{
+public:
+	PostProcessGraph( std::shared_ptr<Mesh> fullscreenQuad );
+	~PostProcessGraph();
+	PostProcessGraph( const PostProcessGraph& copy ) = delete;
+
+	static void RegisterPerPixelEffect( const std::string& effectName, const char* glslBody ); //Name must be a valid GLSL identifier.
+
+	bool AddEffect( const std::string& effectName ); //A per-pixel effect's name, or a FramebufferEffect's with or without its "FboEffect_" prefix.
+	void ClearEffects();
+	unsigned int GetNumEffects() const { return m_effects.size(); }
+	const std::string& GetEffectName( unsigned int effectIndex ) const { return m_effects[ effectIndex ].name; }
+	bool DoesAnyEffectReadDepth() const;
+
+	void SetFusionEnabled( bool isFusionEnabled );
+	bool IsFusionEnabled() const { return m_isFusionEnabled; }
+
+	//sourceWidth and sourceHeight are the sub-rect the scene covers. Destination nullptr is the default framebuffer.
+	void Execute( FrameBuffer* source, unsigned int sourceWidth, unsigned int sourceHeight, FrameBuffer* destination );
+	unsigned int GetNumPasses(); //For a source covering its whole target, otherwise maybe one more.
+	RenderTargetPool* GetTargetPool() { return &m_targetPool; }
+
+
+private:
+	struct Effect
+	{
+		std::string name;
+		MeshRenderer* fullscreenRenderer; //nullptr for a per-pixel effect.
+	};
+
+	struct Pass
+	{
+		MeshRenderer* renderer;
+		bool canReadSubRect; //Only generated passes have uSourceUVScale.
+	};
+
+	void CompilePasses();
+	MeshRenderer* CreateOrGetFusedPass( const std::vector<std::string>& perPixelEffectNames );
+	void RenderPass( const Pass& pass, FrameBuffer* input, FrameBuffer* source, const Vector2f& inputUVScale, FrameBuffer* output );
+
+	static PerPixelEffectRegistryMap s_perPixelEffectBodies;
+
+	std::shared_ptr<Mesh> m_fullscreenQuad;
+	Sampler* m_bilinearSampler;
+	RenderTargetPool m_targetPool;
+	std::vector<Effect> m_effects;
+	std::vector<Pass> m_passes;
+	bool m_arePassesDirty;
+	bool m_isFusionEnabled;
+	std::map< std::string, MeshRenderer* > m_fusedPassRenderers; //By the names they fuse, each kept once compiled.
+};
+
+
+//-----------------------------------------------------------------------------
+#ifndef ENGINE_HEADLESS
+bool RunPostProcessTest( unsigned int size ); //size: a multiple of 16. Reads back pixels, so only exists with a real GL context.
+#endif
+void PostProcessTest( Command& args ); //PostProcessTest [size = 64]: renders a known pattern through fused and unfused chains, checks them against the CPU.
@@ -1,9 +1,13 @@
 #include "Engine/Renderer/RenderLayer.hpp"
 #include "Engine/Renderer/FramebufferEffect.hpp"
+#include "Engine/Renderer/SpriteRenderer.hpp"
+#include "Engine/Error/ErrorWarningAssert.hpp"
+#include <algorithm>
 
 
 //--------------------------------------------------------------------------------------------------------------
 STATIC const Vector2f RenderLayer::NO_CUSTOM_VIRTUAL_SIZE = Vector2f::ZERO;
+STATIC const float RenderLayer::SPRITE_TREE_FAT_MARGIN = .25f; //Virtual units, of the default 15 across. Sprites drifting less stay in their leaf.
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -25,3 +29,120 @@ void RenderLayer::AddFboEffect( FramebufferEffect* fboEffect )
 {
 	m_effects.push_back( fboEffect );
 }
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderLayer::AddSprite( Sprite* sprite )
+{
+	sprite->m_indexInLayer = m_sprites.size();
+	sprite->m_drawOrderInLayer = m_nextDrawOrder++;
+	m_sprites.push_back( sprite );
+
+	SpriteCullingState cullingState;
+	cullingState.m_proxyID = m_spriteTree.CreateProxy( CalcCullingBounds( sprite ), sprite );
+	cullingState.m_lastTransform = sprite->m_transform;
+	cullingState.m_lastVirtualSize = Vector2f( sprite->GetVirtualWidth(), sprite->GetVirtualHeight() );
+	m_cullingStates.push_back( cullingState );
+
+	m_isVisibleListStale = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderLayer::RemoveSprite( Sprite* sprite )
+{
+	//Sprites are unregistered on destruction whether or not they were enabled, so it may not be here.
+	unsigned int spriteIndex = sprite->m_indexInLayer;
+	if ( ( spriteIndex >= m_sprites.size() ) || ( m_sprites[ spriteIndex ] != sprite ) )
+		return;
+
+	m_spriteTree.DestroyProxy( m_cullingStates[ spriteIndex ].m_proxyID );
+
+	unsigned int lastIndex = m_sprites.size() - 1;
+	m_sprites[ spriteIndex ] = m_sprites[ lastIndex ];
+	m_cullingStates[ spriteIndex ] = m_cullingStates[ lastIndex ];
+	m_sprites[ spriteIndex ]->m_indexInLayer = spriteIndex;
+	m_sprites.pop_back();
+	m_cullingStates.pop_back();
+
+	sprite->m_indexInLayer = Sprite::NOT_IN_LAYER;
+	m_isVisibleListStale = true; //Else the visible list could still hold it, if it's removed between culling and drawing.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderLayer::RefitSprite( unsigned int spriteIndex )
+{
+	const Sprite* sprite = m_sprites[ spriteIndex ];
+	SpriteCullingState& cullingState = m_cullingStates[ spriteIndex ];
+
+	//Its parents' transforms aren't tracked, so a parented sprite always refits.
+	const Transform2D& transform = sprite->m_transform;
+	const Transform2D& lastTransform = cullingState.m_lastTransform;
+	bool isUnchanged = ( transform.m_position == lastTransform.m_position ) && ( transform.m_scale == lastTransform.m_scale )
+		&& ( transform.m_rotationAngleDegrees == lastTransform.m_rotationAngleDegrees )
+		&& ( sprite->GetVirtualWidth() == cullingState.m_lastVirtualSize.x ) && ( sprite->GetVirtualHeight() == cullingState.m_lastVirtualSize.y )
+		&& ( ( sprite->GetParent() == nullptr ) || !SpriteRenderer::IsParentingEnabled() );
+	if ( isUnchanged )
+		return;
+
+	cullingState.m_lastTransform = transform;
+	cullingState.m_lastVirtualSize = Vector2f( sprite->GetVirtualWidth(), sprite->GetVirtualHeight() );
+	m_spriteTree.MoveProxy( cullingState.m_proxyID, CalcCullingBounds( sprite ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderLayer::CullSprites( const AABB2f& viewBounds, bool shouldCull )
+{
+	//Unculled, the list only changes with membership, so it's kept until a sprite's added or removed.
+	bool canKeepList = !shouldCull && !m_isCulling && !m_isVisibleListStale;
+
+	m_cullBounds = viewBounds;
+	m_isCulling = shouldCull;
+	if ( !canKeepList )
+		RebuildVisibleSprites();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+const std::vector<Sprite*>& RenderLayer::GetVisibleSprites()
+{
+	if ( m_isVisibleListStale )
+		RebuildVisibleSprites();
+
+	return m_visibleSprites;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderLayer::RebuildVisibleSprites()
+{
+	m_visibleSprites.clear();
+	if ( m_isCulling )
+		m_spriteTree.Query( m_cullBounds, AddVisibleSprite, this );
+	else
+		m_visibleSprites.assign( m_sprites.begin(), m_sprites.end() );
+
+	std::sort( m_visibleSprites.begin(), m_visibleSprites.end(), IsDrawnBefore );
+	m_isVisibleListStale = false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderLayer::AddVisibleSprite( void* sprite, void* layer )
+{
+	static_cast<RenderLayer*>( layer )->m_visibleSprites.push_back( static_cast<Sprite*>( sprite ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC AABB2f RenderLayer::CalcCullingBounds( const Sprite* sprite )
+{
+	//GetVirtualBoundsInWorld() only transforms two corners, which stop bounding the quad once it's rotated.
+	//The circle through all four corners does bound it at any rotation, so box that instead.
+	AABB2f cornerBounds = sprite->GetVirtualBoundsInWorld();
+	Vector2f center = ( cornerBounds.mins + cornerBounds.maxs ) * 0.5f;
+	float radius = ( cornerBounds.maxs - cornerBounds.mins ).CalcFloatLength() * 0.5f;
+	return AABB2f( center.x - radius, center.y - radius, center.x + radius, center.y + radius );
+}
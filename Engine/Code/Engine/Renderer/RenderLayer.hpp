@@ -1,10 +1,11 @@
 #pragma once
 #include <vector>
 #include "Engine/EngineCommon.hpp"
+#include "Engine/Math/AABB2Tree.hpp"
+#include "Engine/Renderer/Sprite.hpp"
 
 
 //-----------------------------------------------------------------------------
-class Sprite;
 class ParticleSystem;
 class FramebufferEffect;
 
@@ -18,28 +19,30 @@ public:
 		, m_name( name )
 		, m_enabled( enabled )
 		, m_virtualSize( NO_CUSTOM_VIRTUAL_SIZE )
+		, m_isStateSorted( false )
+		, m_spriteTree( SPRITE_TREE_FAT_MARGIN )
+		, m_nextDrawOrder( 0 )
+		, m_isCulling( false )
+		, m_isVisibleListStale( false )
 	{
 	}
 
 	void AddParticleSystem( ParticleSystem* ps ) { m_particleSystems.push_back( ps ); }
-	void AddSprite( Sprite* sprite ) { m_sprites.push_back( sprite ); }
-	void RemoveSprite( Sprite* sprite ) 
-	{ 
-		for ( unsigned int index = 0; index < m_sprites.size(); index++ )
-		{
-			if ( m_sprites[ index ] == sprite )
-			{
-				m_sprites.erase( m_sprites.begin() + index );
-				return;
-			}
-		}
-	}
+	void AddSprite( Sprite* sprite );
+	void RemoveSprite( Sprite* sprite ); //O(1), swapping the last sprite into its slot: m_sprites isn't in draw order, the visible list is.
+	void RefitSprite( unsigned int spriteIndex ); //Moves its culling bounds if its transform or size changed, call per frame before culling.
+	void CullSprites( const AABB2f& viewBounds, bool shouldCull ); //When not culling, every sprite is visible.
+	const std::vector<Sprite*>& GetVisibleSprites(); //In draw order. Re-culls against the last view bounds if sprites were added or removed since.
+	unsigned int GetNumVisibleSprites() const { return m_visibleSprites.size(); }
+	const AABB2Tree& GetSpriteTree() const { return m_spriteTree; }
 	Vector2f GetLayerVirtualSize() const { return m_virtualSize; }
 	void UpdateVirtualSize( float unitXY );
 	void UpdateVirtualSize( float unitX, float unitY );
 	bool IsScrolling() const { return m_isScrolling; }
 	void SetIsScrolling( bool newVal ) { m_isScrolling = newVal; }
 	void IgnoreScrolling() { m_isScrolling = false; }
+	bool IsStateSorted() const { return m_isStateSorted; }
+	void SetIsStateSorted( bool newVal ) { m_isStateSorted = newVal; }
 	void AllowScrolling() { m_isScrolling = true; }
 	void AddFboEffect( FramebufferEffect* fboEffect );
 
@@ -47,7 +50,7 @@ public:
 public:
 	std::vector<ParticleSystem*> m_particleSystems; //Note that particle systems render last in layer over everything.
 	std::vector<FramebufferEffect*> m_effects;
-	std::vector<Sprite*> m_sprites;
+	std::vector<Sprite*> m_sprites; //Unordered, see RemoveSprite(). Draw from GetVisibleSprites().
 	std::string m_name;
 	RenderLayerID m_layerID;
 	bool m_enabled;
@@ -58,6 +61,28 @@ private:
 	//Each layer can have its own virtual size, but not bounding volume (since I want scrolling limits on Camera2D), only whether or not to ignore scrolling altogether.
 	Vector2f m_virtualSize; //NOT a unit length as I had before, but the total size of the layer in virtual units (used to scale sprite size).
 	bool m_isScrolling; //When true, all sprites inside this receive uView matrix := identity.
+	bool m_isStateSorted; //When true, the RenderQueue may reorder this layer's sprites by material and texture, so only for layers whose sprites don't overlap.
+
+	struct SpriteCullingState //Parallel to m_sprites.
+	{
+		int m_proxyID;
+		Transform2D m_lastTransform; //As of the last refit, so sprites that haven't moved skip recomputing their bounds.
+		Vector2f m_lastVirtualSize;
+	};
+
+	static const float SPRITE_TREE_FAT_MARGIN;
+	static AABB2f CalcCullingBounds( const Sprite* sprite );
+	static bool IsDrawnBefore( const Sprite* lhs, const Sprite* rhs ) { return lhs->m_drawOrderInLayer < rhs->m_drawOrderInLayer; }
+	static void AddVisibleSprite( void* sprite, void* layer );
+	void RebuildVisibleSprites();
+
+	std::vector<SpriteCullingState> m_cullingStates;
+	AABB2Tree m_spriteTree; //Over every sprite's culling bounds, so culling only visits the visible ones and the branches holding them.
+	std::vector<Sprite*> m_visibleSprites;
+	unsigned int m_nextDrawOrder; //Registration order, which sprites draw in: later ones over earlier ones, as when m_sprites was kept in order.
+	AABB2f m_cullBounds;
+	bool m_isCulling;
+	bool m_isVisibleListStale;
 };
 
 //Background layers could go negative from a default of 0.
@@ -0,0 +1,387 @@
+#include "Engine/Renderer/RenderQueue.hpp"
+
+
+#include "Engine/Renderer/TransientGeometryBuffer.hpp"
+#include "Engine/Renderer/SpriteInstanceBuffer.hpp"
+#include "Engine/Renderer/VertexDefinition.hpp"
+#include "Engine/Renderer/MeshRenderer.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+#include "Engine/Renderer/Material.hpp"
+#include "Engine/Renderer/TheRenderer.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Time/Time.hpp"
+#include "Engine/Error/ErrorWarningAssert.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const unsigned int SORT_KEY_FIELD_MASK = 0xFFFF;
+static const unsigned int RADIX_BITS = 8;
+static const unsigned int RADIX_NUM_BUCKETS = 1 << RADIX_BITS;
+static const unsigned int NO_TEXTURE_BOUND = 0xFFFFFFFF;
+
+
+//--------------------------------------------------------------------------------------------------------------
+void* RenderCommandBuffer::AddTransientDraw( RenderSortKey sortKey, Material* material, const RenderUniformBlock* uniforms, unsigned int diffuseTextureID, VertexGroupingRule vertexGroupingRule,
+											 const VertexDefinition& vertexDefinition, unsigned int numVertices, unsigned int numIndices, unsigned int** out_indices )
+{
+	RenderPacket packet;
+	packet.m_sortKey = sortKey;
+	packet.m_material = material;
+	packet.m_uniforms = uniforms;
+	packet.m_meshRenderer = nullptr;
+	packet.m_vertexDefinition = &vertexDefinition;
+	packet.m_diffuseTextureID = diffuseTextureID;
+	packet.m_vertexGroupingRule = vertexGroupingRule;
+	packet.m_firstVertexByte = m_vertexBytes.size();
+	packet.m_numVertices = numVertices;
+	packet.m_firstIndex = m_indices.size();
+	packet.m_numIndices = numIndices;
+	packet.m_firstInstance = packet.m_numInstances = 0;
+	m_packets.push_back( packet );
+
+	m_vertexBytes.resize( m_vertexBytes.size() + ( numVertices * vertexDefinition.GetVertexSize() ) );
+	m_indices.resize( m_indices.size() + numIndices );
+
+	if ( out_indices != nullptr )
+		*out_indices = m_indices.data() + packet.m_firstIndex;
+	return m_vertexBytes.data() + packet.m_firstVertexByte;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderCommandBuffer::AddMeshDraw( RenderSortKey sortKey, MeshRenderer* meshRenderer, const RenderUniformBlock* uniforms )
+{
+	RenderPacket packet;
+	packet.m_sortKey = sortKey;
+	packet.m_material = meshRenderer->GetMaterial();
+	packet.m_uniforms = uniforms;
+	packet.m_meshRenderer = meshRenderer;
+	packet.m_vertexDefinition = nullptr;
+	packet.m_diffuseTextureID = 0;
+	packet.m_vertexGroupingRule = AS_TRIANGLES;
+	packet.m_firstVertexByte = packet.m_numVertices = packet.m_firstIndex = packet.m_numIndices = 0;
+	packet.m_firstInstance = packet.m_numInstances = 0;
+	m_packets.push_back( packet );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+SpriteInstance* RenderCommandBuffer::AddInstancedDraw( RenderSortKey sortKey, Material* instancingMaterial, const RenderUniformBlock* uniforms, unsigned int diffuseTextureID, unsigned int numInstances )
+{
+	RenderPacket packet;
+	packet.m_sortKey = sortKey;
+	packet.m_material = instancingMaterial;
+	packet.m_uniforms = uniforms;
+	packet.m_meshRenderer = nullptr;
+	packet.m_vertexDefinition = nullptr;
+	packet.m_diffuseTextureID = diffuseTextureID;
+	packet.m_vertexGroupingRule = AS_TRIANGLES;
+	packet.m_firstVertexByte = packet.m_numVertices = packet.m_firstIndex = packet.m_numIndices = 0;
+	packet.m_firstInstance = m_instances.size();
+	packet.m_numInstances = numInstances;
+	m_packets.push_back( packet );
+
+	m_instances.resize( m_instances.size() + numInstances );
+	return m_instances.data() + packet.m_firstInstance;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderCommandBuffer::Clear()
+{
+	m_packets.clear();
+	m_vertexBytes.clear();
+	m_indices.clear();
+	m_instances.clear();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+RenderQueue::RenderQueue( unsigned int transientVertexBytesPerFrame, unsigned int transientIndexBytesPerFrame, unsigned int instanceBytesPerFrame )
+	: m_transientVertexBytesPerFrame( transientVertexBytesPerFrame )
+	, m_transientIndexBytesPerFrame( transientIndexBytesPerFrame )
+	, m_spriteInstances( new SpriteInstanceBuffer( instanceBytesPerFrame ) )
+	, m_oversizedPacketRenderer( new MeshRenderer( nullptr, nullptr ) )
+	, m_lastTransientGeometry( nullptr )
+	, m_boundMaterial( nullptr )
+	, m_boundUniforms( nullptr )
+	, m_boundTextureID( NO_TEXTURE_BOUND )
+	, m_viewHandle( INVALID_UNIFORM_HANDLE )
+	, m_projectionHandle( INVALID_UNIFORM_HANDLE )
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+RenderQueue::~RenderQueue()
+{
+	for ( RenderCommandBuffer* commandBuffer : m_commandBuffers )
+		delete commandBuffer;
+
+	for ( auto& transientPair : m_transientGeometryPerDefinition )
+		delete transientPair.second;
+
+	delete m_spriteInstances;
+	delete m_oversizedPacketRenderer;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC RenderSortKey RenderQueue::MakeSortKey( RenderLayerID layerID, unsigned int orderInLayer, const Material* material /*= nullptr*/, unsigned int textureID /*= 0*/ )
+{
+	//Biased so negative (background) layers sort first, as they do in SpriteRenderer's layer map.
+	int biasedLayer = GetMax( 0, GetMin( layerID + 0x8000, (int)SORT_KEY_FIELD_MASK ) );
+	unsigned int clampedOrder = GetMin( orderInLayer, SORT_KEY_FIELD_MASK );
+
+	//Only grouping equal materials matters, not their order, so low pointer bits do. A collision only costs some merging.
+	unsigned int materialBits = (unsigned int)( reinterpret_cast<size_t>( material ) >> 4 ) & SORT_KEY_FIELD_MASK;
+	unsigned int textureBits = textureID & SORT_KEY_FIELD_MASK;
+
+	return ( (RenderSortKey)biasedLayer << 48 ) | ( (RenderSortKey)clampedOrder << 32 ) | ( (RenderSortKey)materialBits << 16 ) | (RenderSortKey)textureBits;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+RenderCommandBuffer* RenderQueue::GetCommandBuffer( unsigned int recorderIndex )
+{
+	while ( m_commandBuffers.size() <= recorderIndex )
+		m_commandBuffers.push_back( new RenderCommandBuffer() );
+
+	return m_commandBuffers[ recorderIndex ];
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderQueue::Submit()
+{
+	double submitStartSeconds = GetCurrentTimeSeconds();
+	m_lastSubmitStats.Clear();
+
+	m_sortEntries.clear();
+	for ( unsigned int commandBufferIndex = 0; commandBufferIndex < m_commandBuffers.size(); commandBufferIndex++ )
+	{
+		const RenderCommandBuffer* commandBuffer = m_commandBuffers[ commandBufferIndex ];
+		if ( commandBuffer->GetNumPackets() == 0 )
+			continue;
+
+		++m_lastSubmitStats.m_numCommandBuffers;
+		for ( unsigned int packetIndex = 0; packetIndex < commandBuffer->GetNumPackets(); packetIndex++ )
+		{
+			const RenderPacket& packet = commandBuffer->GetPacket( packetIndex );
+			if ( packet.m_numInstances > 0 )
+			{
+				++m_lastSubmitStats.m_numInstancedPackets;
+				m_lastSubmitStats.m_numInstances += packet.m_numInstances;
+			}
+
+			SortEntry entry;
+			entry.m_sortKey = packet.m_sortKey;
+			entry.m_commandBufferIndex = commandBufferIndex;
+			entry.m_packetIndex = packetIndex;
+			m_sortEntries.push_back( entry );
+		}
+	}
+	m_lastSubmitStats.m_numPackets = m_sortEntries.size();
+
+	double sortStartSeconds = GetCurrentTimeSeconds();
+	RadixSortEntries();
+	m_lastSubmitStats.m_sortSeconds = GetCurrentTimeSeconds() - sortStartSeconds;
+
+	//Immediate-mode draws made before this Submit still sit staged in TheRenderer's batch, and must land underneath.
+	g_theRenderer->FlushImmediateDraws();
+
+	m_boundMaterial = nullptr;
+	m_boundUniforms = nullptr;
+	m_boundTextureID = NO_TEXTURE_BOUND;
+	for ( const SortEntry& entry : m_sortEntries )
+	{
+		const RenderCommandBuffer& commandBuffer = *m_commandBuffers[ entry.m_commandBufferIndex ];
+		IssuePacket( commandBuffer, commandBuffer.GetPacket( entry.m_packetIndex ) );
+	}
+	FlushStagedDraws();
+
+	for ( RenderCommandBuffer* commandBuffer : m_commandBuffers )
+		commandBuffer->Clear();
+
+	m_lastSubmitStats.m_submitSeconds = GetCurrentTimeSeconds() - submitStartSeconds;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderQueue::RadixSortEntries()
+{
+	//LSD radix sort, a byte per pass: linear in packets, and stable, which the recording-order guarantee relies on.
+	unsigned int numEntries = m_sortEntries.size();
+	if ( numEntries < 2 )
+		return;
+
+	m_sortScratch.resize( numEntries );
+	for ( unsigned int shift = 0; shift < 64; shift += RADIX_BITS )
+	{
+		unsigned int bucketCounts[ RADIX_NUM_BUCKETS ] = { 0 };
+		for ( const SortEntry& entry : m_sortEntries )
+			++bucketCounts[ ( entry.m_sortKey >> shift ) & ( RADIX_NUM_BUCKETS - 1 ) ];
+
+		//Most passes are no-ops: layers and orders are few, and painter-ordered content zeroes the bottom 32 bits.
+		if ( bucketCounts[ ( m_sortEntries[ 0 ].m_sortKey >> shift ) & ( RADIX_NUM_BUCKETS - 1 ) ] == numEntries )
+			continue;
+
+		unsigned int bucketStarts[ RADIX_NUM_BUCKETS ];
+		unsigned int runningTotal = 0;
+		for ( unsigned int bucketIndex = 0; bucketIndex < RADIX_NUM_BUCKETS; bucketIndex++ )
+		{
+			bucketStarts[ bucketIndex ] = runningTotal;
+			runningTotal += bucketCounts[ bucketIndex ];
+		}
+
+		for ( const SortEntry& entry : m_sortEntries )
+			m_sortScratch[ bucketStarts[ ( entry.m_sortKey >> shift ) & ( RADIX_NUM_BUCKETS - 1 ) ]++ ] = entry;
+
+		m_sortEntries.swap( m_sortScratch );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderQueue::IssuePacket( const RenderCommandBuffer& commandBuffer, const RenderPacket& packet )
+{
+	bool isNewMaterial = ( packet.m_material != m_boundMaterial );
+	bool isNewUniforms = ( packet.m_uniforms != m_boundUniforms );
+	if ( isNewMaterial || isNewUniforms )
+	{
+		FlushStagedDraws(); //A staged batch reads its material's uniforms when it flushes, so it has to go before they change.
+
+		if ( isNewMaterial )
+		{
+			m_boundMaterial = packet.m_material;
+			m_viewHandle = m_boundMaterial->GetUniformHandle( "uView" );
+			m_projectionHandle = m_boundMaterial->GetUniformHandle( "uProj" );
+			++m_lastSubmitStats.m_numMaterialChanges;
+		}
+
+		if ( isNewUniforms )
+		{
+			m_boundUniforms = packet.m_uniforms;
+			++m_lastSubmitStats.m_numUniformBlockChanges;
+		}
+
+		if ( m_boundUniforms != nullptr )
+		{
+			m_boundMaterial->SetMatrix4x4( m_viewHandle, false, &m_boundUniforms->m_view );
+			m_boundMaterial->SetMatrix4x4( m_projectionHandle, false, &m_boundUniforms->m_projection );
+		}
+	}
+
+	if ( packet.m_meshRenderer != nullptr )
+	{
+		FlushStagedDraws();
+		packet.m_meshRenderer->Render();
+		return;
+	}
+
+	if ( packet.m_diffuseTextureID != m_boundTextureID )
+	{
+		m_boundTextureID = packet.m_diffuseTextureID;
+		++m_lastSubmitStats.m_numTextureChanges;
+	}
+
+	if ( packet.m_numInstances > 0 )
+	{
+		if ( m_lastTransientGeometry != nullptr ) //Else its staged batch would land on top of these instances.
+		{
+			m_lastTransientGeometry->Flush();
+			m_lastTransientGeometry = nullptr;
+		}
+
+		SpriteInstanceDrawKey instanceKey;
+		instanceKey.m_material = packet.m_material;
+		instanceKey.m_diffuseTextureID = packet.m_diffuseTextureID;
+		m_spriteInstances->Draw( instanceKey, commandBuffer.GetInstances( packet ), packet.m_numInstances );
+		return;
+	}
+
+	m_spriteInstances->Flush(); //No-op unless the last packet was instanced.
+
+	TransientGeometryBuffer* transientGeometry = CreateOrGetTransientGeometry( packet.m_vertexDefinition );
+	if ( transientGeometry != m_lastTransientGeometry )
+	{
+		FlushStagedDraws();
+		m_lastTransientGeometry = transientGeometry;
+	}
+
+	TransientDrawKey key;
+	key.m_material = packet.m_material;
+	key.m_vertexGroupingRule = packet.m_vertexGroupingRule;
+	key.m_diffuseTextureID = packet.m_diffuseTextureID;
+	key.m_usesIndices = ( packet.m_numIndices > 0 );
+
+	const unsigned int* indices = key.m_usesIndices ? commandBuffer.GetIndices( packet ) : nullptr;
+	if ( !transientGeometry->Draw( key, commandBuffer.GetVertexBytes( packet ), packet.m_numVertices, indices, packet.m_numIndices ) )
+		DrawOversizedPacket( commandBuffer, packet );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderQueue::DrawOversizedPacket( const RenderCommandBuffer& commandBuffer, const RenderPacket& packet )
+{
+	++m_lastSubmitStats.m_numOversizedPackets;
+
+	FlushStagedDraws(); //Else the staged batch would land on top of this.
+
+	bool usesIndices = ( packet.m_numIndices > 0 );
+	unsigned int numElements = usesIndices ? packet.m_numIndices : packet.m_numVertices;
+	DrawInstruction drawInstructions[] = { DrawInstruction( packet.m_vertexGroupingRule, 0, numElements, usesIndices ) };
+
+	Mesh* mesh;
+	if ( usesIndices )
+	{
+		mesh = new Mesh( BufferUsage::STATIC_DRAW, *packet.m_vertexDefinition, packet.m_numVertices, commandBuffer.GetVertexBytes( packet ),
+						 packet.m_numIndices, const_cast<unsigned int*>( commandBuffer.GetIndices( packet ) ), 1, drawInstructions );
+	}
+	else mesh = new Mesh( BufferUsage::STATIC_DRAW, *packet.m_vertexDefinition, packet.m_numVertices, commandBuffer.GetVertexBytes( packet ), 1, drawInstructions );
+
+	//As the transient buffers do at Flush, leave the material's texture as the recorder found it.
+	Material* material = packet.m_material;
+	unsigned int liveTextureID = material->GetTexture( "uTexDiffuse" );
+	material->SetTexture( "uTexDiffuse", packet.m_diffuseTextureID );
+
+	m_oversizedPacketRenderer->SetMeshAndMaterial( std::shared_ptr<Mesh>( mesh ), material );
+	m_oversizedPacketRenderer->Render();
+
+	material->SetTexture( "uTexDiffuse", liveTextureID );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+TransientGeometryBuffer* RenderQueue::CreateOrGetTransientGeometry( const VertexDefinition* vertexDefinition )
+{
+	auto found = m_transientGeometryPerDefinition.find( vertexDefinition );
+	if ( found != m_transientGeometryPerDefinition.end() )
+		return found->second;
+
+	TransientGeometryBuffer* transientGeometry = new TransientGeometryBuffer( *vertexDefinition, m_transientVertexBytesPerFrame, m_transientIndexBytesPerFrame );
+	m_transientGeometryPerDefinition[ vertexDefinition ] = transientGeometry;
+	return transientGeometry;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderQueue::FlushStagedDraws()
+{
+	if ( m_lastTransientGeometry != nullptr )
+		m_lastTransientGeometry->Flush();
+
+	m_spriteInstances->Flush();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderQueue::EndFrame()
+{
+	for ( auto& transientPair : m_transientGeometryPerDefinition )
+		transientPair.second->EndFrame();
+
+	m_spriteInstances->EndFrame();
+
+	m_lastTransientGeometry = nullptr;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+
+#include <map>
+#include <vector>
+#include "Engine/EngineCommon.hpp"
+#include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Renderer/ShaderProgram.hpp"
+#include "Engine/Renderer/Vertexes.hpp"
+
+
+//-----------------------------------------------------------------------------
+class Material;
+class MeshRenderer;
+class VertexDefinition;
+class TransientGeometryBuffer;
+class SpriteInstanceBuffer;
+typedef unsigned long long RenderSortKey;
+
+
+//-----------------------------------------------------------------------------
+struct RenderUniformBlock //Shared by many packets, e.g. one per sprite layer. Must outlive the Submit() of packets pointing at it.
+{
+	Matrix4x4f m_view;
+	Matrix4x4f m_projection;
+};
+
+
+//-----------------------------------------------------------------------------
+struct RenderPacket
+{
+	RenderSortKey m_sortKey;
+	Material* m_material;
+	const RenderUniformBlock* m_uniforms; //Null leaves the material's uView and uProj as they are.
+	MeshRenderer* m_meshRenderer; //Persistent geometry. Null for transient vertices or instances, held by the packet's RenderCommandBuffer.
+	const VertexDefinition* m_vertexDefinition; //Null for mesh and instanced packets.
+	unsigned int m_diffuseTextureID;
+	VertexGroupingRule m_vertexGroupingRule;
+	unsigned int m_firstVertexByte;
+	unsigned int m_numVertices;
+	unsigned int m_firstIndex;
+	unsigned int m_numIndices;
+	unsigned int m_firstInstance;
+	unsigned int m_numInstances; //Nonzero for instanced packets, which have no vertices or indices.
+};
+
+
+//-----------------------------------------------------------------------------
+//Where one recorder (usually one job) writes its packets. Nothing here is locked: a buffer has exactly one writer at a time,
+//and only RenderQueue::Submit() on the main thread reads it, after every recording job's been waited on.
+class RenderCommandBuffer
+{
+public:
+	//Returns where to write numVertices of vertexDefinition's size, and out_indices where to write numIndices, relative to this draw's first vertex.
+	//Both pointers are only good until this buffer's next Add.
+	void* AddTransientDraw( RenderSortKey sortKey, Material* material, const RenderUniformBlock* uniforms, unsigned int diffuseTextureID, VertexGroupingRule vertexGroupingRule,
+							const VertexDefinition& vertexDefinition, unsigned int numVertices, unsigned int numIndices, unsigned int** out_indices );
+	void AddMeshDraw( RenderSortKey sortKey, MeshRenderer* meshRenderer, const RenderUniformBlock* uniforms ); //Draws with the MeshRenderer's own material.
+	SpriteInstance* AddInstancedDraw( RenderSortKey sortKey, Material* instancingMaterial, const RenderUniformBlock* uniforms, unsigned int diffuseTextureID, unsigned int numInstances ); //Good until the next Add.
+
+	void Clear(); //Keeps capacity, so steady-state recording doesn't allocate.
+	unsigned int GetNumPackets() const { return m_packets.size(); }
+	const RenderPacket& GetPacket( unsigned int packetIndex ) const { return m_packets[ packetIndex ]; }
+	const unsigned char* GetVertexBytes( const RenderPacket& packet ) const { return m_vertexBytes.data() + packet.m_firstVertexByte; }
+	const unsigned int* GetIndices( const RenderPacket& packet ) const { return m_indices.data() + packet.m_firstIndex; }
+	const SpriteInstance* GetInstances( const RenderPacket& packet ) const { return m_instances.data() + packet.m_firstInstance; }
+
+
+private:
+	std::vector< RenderPacket > m_packets;
+	std::vector< unsigned char > m_vertexBytes;
+	std::vector< unsigned int > m_indices;
+	std::vector< SpriteInstance > m_instances;
+};
+
+
+//-----------------------------------------------------------------------------
+struct RenderQueueStats
+{
+	RenderQueueStats() { Clear(); }
+	void Clear() { m_numPackets = m_numInstancedPackets = m_numInstances = m_numCommandBuffers = m_numMaterialChanges = m_numTextureChanges = m_numUniformBlockChanges = m_numOversizedPackets = 0; m_sortSeconds = m_submitSeconds = 0.0; }
+
+	unsigned int m_numPackets;
+	unsigned int m_numInstancedPackets; //Of m_numPackets.
+	unsigned int m_numInstances;
+	unsigned int m_numCommandBuffers; //Ones with packets in them.
+	unsigned int m_numMaterialChanges; //Versus m_numPackets, what the sort bought.
+	unsigned int m_numTextureChanges;
+	unsigned int m_numUniformBlockChanges;
+	unsigned int m_numOversizedPackets; //Too big for a frame's transient segment and not splittable, so drawn through their own Mesh.
+	double m_sortSeconds;
+	double m_submitSeconds; //Includes the sort.
+};
+
+
+//-----------------------------------------------------------------------------
+//Draws are recorded as RenderPackets into RenderCommandBuffers, possibly from job threads, then merged, radix sorted by key and issued by Submit().
+//The sort is stable, so packets with equal keys draw in recording order: give painter-ordered content equal keys, and record in the order to draw.
+//Transient packets go through one TransientGeometryBuffer per vertex format, and instanced packets through one SpriteInstanceBuffer,
+//so consecutive equal-state packets merge into one draw call.
+class RenderQueue
+{
+public:
+	RenderQueue( unsigned int transientVertexBytesPerFrame, unsigned int transientIndexBytesPerFrame, unsigned int instanceBytesPerFrame );
+	~RenderQueue();
+
+	//Key layout, most significant first: 16 bits layer, 16 bits order within it, 16 bits material, 16 bits texture.
+	//Pass a null material and 0 texture to keep equal-order packets in recording order rather than grouped by state.
+	static RenderSortKey MakeSortKey( RenderLayerID layerID, unsigned int orderInLayer, const Material* material = nullptr, unsigned int textureID = 0 );
+
+	RenderCommandBuffer* GetCommandBuffer( unsigned int recorderIndex ); //Main thread only, before dispatching the recorders. Grows as needed.
+	void Submit(); //Main thread: merges, sorts and issues every buffer's packets in recorderIndex order, then clears them.
+	void EndFrame();
+
+	const RenderQueueStats& GetLastSubmitStats() const { return m_lastSubmitStats; }
+	const SpriteInstanceBuffer* GetSpriteInstances() const { return m_spriteInstances; }
+
+
+private:
+	struct SortEntry
+	{
+		RenderSortKey m_sortKey;
+		unsigned int m_commandBufferIndex;
+		unsigned int m_packetIndex;
+	};
+
+	void RadixSortEntries();
+	void IssuePacket( const RenderCommandBuffer& commandBuffer, const RenderPacket& packet );
+	TransientGeometryBuffer* CreateOrGetTransientGeometry( const VertexDefinition* vertexDefinition );
+	void FlushStagedDraws(); //Only the last TransientGeometryBuffer drawn into, and the SpriteInstanceBuffer, can have a batch staged.
+	void DrawOversizedPacket( const RenderCommandBuffer& commandBuffer, const RenderPacket& packet ); //As TheRenderer's DrawVertexArray*_PCT do when the transient path refuses.
+
+	std::vector< RenderCommandBuffer* > m_commandBuffers;
+	std::vector< SortEntry > m_sortEntries;
+	std::vector< SortEntry > m_sortScratch;
+	std::map< const VertexDefinition*, TransientGeometryBuffer* > m_transientGeometryPerDefinition;
+	unsigned int m_transientVertexBytesPerFrame;
+	unsigned int m_transientIndexBytesPerFrame;
+	SpriteInstanceBuffer* m_spriteInstances;
+	MeshRenderer* m_oversizedPacketRenderer;
+
+	//What the last issued packet left bound, reset every Submit.
+	TransientGeometryBuffer* m_lastTransientGeometry;
+	Material* m_boundMaterial;
+	const RenderUniformBlock* m_boundUniforms;
+	unsigned int m_boundTextureID;
+	UniformHandle m_viewHandle;
+	UniformHandle m_projectionHandle;
+
+	RenderQueueStats m_lastSubmitStats;
+};
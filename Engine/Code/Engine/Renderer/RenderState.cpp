@@ -1,10 +1,12 @@
 #include "Engine/Renderer/RenderState.hpp"
 #include "Engine/Error/ErrorWarningAssert.hpp"
+#include "Engine/Renderer/RenderStateCache.hpp"
 
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #include <gl/gl.h>
+#include "Engine/Renderer/OpenGLExtensions.hpp"
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -75,63 +77,63 @@ unsigned int GetOpenGLFillMode( FillMode engineFillMode )
 //--------------------------------------------------------------------------------------------------------------
 void RenderStateOptions::DisableAll() const
 {
-	glDisable( GL_BLEND );
-	glDisable( GL_CULL_FACE );
+	RenderStateCache::SetCapability( GL_BLEND, false );
+	RenderStateCache::SetCapability( GL_CULL_FACE, false );
 	glDisable( GL_FILL );
-	glDisable( GL_DEPTH_TEST );
+	RenderStateCache::SetCapability( GL_DEPTH_TEST, false );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void RenderStateOptions::DisableBlending() const
 {
-	glDisable( GL_BLEND );
+	RenderStateCache::SetCapability( GL_BLEND, false );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void RenderStateOptions::DisableCulling() const
 {
-	glDisable( GL_CULL_FACE );
+	RenderStateCache::SetCapability( GL_CULL_FACE, false );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void RenderStateOptions::DisableDepthTesting() const
 {
-	glDisable( GL_DEPTH_TEST );
+	RenderStateCache::SetCapability( GL_DEPTH_TEST, false );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void RenderStateOptions::EnableDepthTesting() const
 {
-	glEnable( GL_DEPTH_TEST );
+	RenderStateCache::SetCapability( GL_DEPTH_TEST, true );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void RenderStateOptions::EnableCulling() const
 {
-	glEnable( GL_CULL_FACE );
+	RenderStateCache::SetCapability( GL_CULL_FACE, true );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void RenderStateOptions::SetBlendMode( BlendMode src, BlendMode dest ) const
 {
-	glEnable( GL_BLEND );
+	RenderStateCache::SetCapability( GL_BLEND, true );
 
-	glBlendFunc( GetOpenGLBlendMode( src ), GetOpenGLBlendMode( dest ) );
+	RenderStateCache::BlendFunc( GetOpenGLBlendMode( src ), GetOpenGLBlendMode( dest ) );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void RenderState::SetBlendModeAndSave( BlendMode src, BlendMode dest )
 {
-	glEnable( GL_BLEND );
+	RenderStateCache::SetCapability( GL_BLEND, true );
 
-	glBlendFunc( GetOpenGLBlendMode( src ), GetOpenGLBlendMode( dest ) );
+	RenderStateCache::BlendFunc( GetOpenGLBlendMode( src ), GetOpenGLBlendMode( dest ) );
 
 	m_options.m_sourceBlendMode = src;
 	m_options.m_destinationBlendMode = dest;
@@ -147,26 +149,27 @@ void RenderStateOptions::SetCullMode( CullMode mode ) const
 		return;
 	}
 
-	glEnable( GL_CULL_FACE );
+	RenderStateCache::SetCapability( GL_CULL_FACE, true );
 
-	glCullFace( GetOpenGLCullMode( mode ) );
+	RenderStateCache::CullFace( GetOpenGLCullMode( mode ) );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void RenderStateOptions::SetDepthTest( DepthTestCompareMode zTest, bool writeDepths ) const
 {
-	glEnable( GL_DEPTH_TEST );
+	RenderStateCache::SetCapability( GL_DEPTH_TEST, true );
 
-	glDepthFunc( GetOpenGLDepthTestCompareMode( zTest ) );
+	RenderStateCache::DepthFunc( GetOpenGLDepthTestCompareMode( zTest ) );
 
-	glDepthMask( writeDepths );
+	RenderStateCache::DepthMask( writeDepths );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void RenderState::Bind() const
 {
+	//Every set below goes through RenderStateCache, so binding the same state twice in a row costs no GL calls.
 // 	if ( m_isDirty )
 // 	{
 		if ( m_isBlendEnabled )
@@ -0,0 +1,258 @@
+#include "Engine/Renderer/RenderStateCache.hpp"
+
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <gl/gl.h>
+#include "Engine/Renderer/OpenGLExtensions.hpp"
+#include "Engine/EngineCommon.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int RenderStateCache::s_programID = RenderStateCache::UNKNOWN;
+STATIC unsigned int RenderStateCache::s_vaoID = RenderStateCache::UNKNOWN;
+STATIC unsigned int RenderStateCache::s_arrayBufferID = RenderStateCache::UNKNOWN;
+STATIC unsigned int RenderStateCache::s_elementBufferID = RenderStateCache::UNKNOWN;
+STATIC unsigned int RenderStateCache::s_activeTextureUnit = RenderStateCache::UNKNOWN;
+STATIC unsigned int RenderStateCache::s_textureIDs[ MAX_TRACKED_TEXTURE_UNITS ];
+STATIC unsigned int RenderStateCache::s_samplerIDs[ MAX_TRACKED_TEXTURE_UNITS ];
+STATIC unsigned int RenderStateCache::s_capabilities[ NUM_TRACKED_CAPABILITIES ];
+STATIC unsigned int RenderStateCache::s_blendSourceFactor = RenderStateCache::UNKNOWN;
+STATIC unsigned int RenderStateCache::s_blendDestinationFactor = RenderStateCache::UNKNOWN;
+STATIC unsigned int RenderStateCache::s_depthFunc = RenderStateCache::UNKNOWN;
+STATIC unsigned int RenderStateCache::s_depthMask = RenderStateCache::UNKNOWN;
+STATIC unsigned int RenderStateCache::s_cullFace = RenderStateCache::UNKNOWN;
+STATIC RenderStateCacheStats RenderStateCache::s_currentFrameStats;
+STATIC RenderStateCacheStats RenderStateCache::s_lastFrameStats;
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::Invalidate()
+{
+	s_programID = UNKNOWN;
+	s_vaoID = UNKNOWN;
+	s_arrayBufferID = UNKNOWN;
+	s_elementBufferID = UNKNOWN;
+	s_activeTextureUnit = UNKNOWN;
+	for ( unsigned int unit = 0; unit < MAX_TRACKED_TEXTURE_UNITS; unit++ )
+		s_textureIDs[ unit ] = s_samplerIDs[ unit ] = UNKNOWN;
+	for ( unsigned int capability = 0; capability < NUM_TRACKED_CAPABILITIES; capability++ )
+		s_capabilities[ capability ] = UNKNOWN;
+	s_blendSourceFactor = s_blendDestinationFactor = UNKNOWN;
+	s_depthFunc = UNKNOWN;
+	s_depthMask = UNKNOWN;
+	s_cullFace = UNKNOWN;
+
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::EndFrame()
+{
+	s_lastFrameStats = s_currentFrameStats;
+	s_currentFrameStats.Clear();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC const char* RenderStateCache::GetStateChangeTypeName( RenderStateChangeType type )
+{
+	switch ( type )
+	{
+	case STATE_CHANGE_PROGRAM: return "Program";
+	case STATE_CHANGE_VERTEX_ARRAY: return "VertexArray";
+	case STATE_CHANGE_BUFFER: return "Buffer";
+	case STATE_CHANGE_ACTIVE_TEXTURE: return "ActiveTexture";
+	case STATE_CHANGE_TEXTURE: return "Texture";
+	case STATE_CHANGE_SAMPLER: return "Sampler";
+	case STATE_CHANGE_CAPABILITY: return "Enable/Disable";
+	case STATE_CHANGE_BLEND_FUNC: return "BlendFunc";
+	case STATE_CHANGE_DEPTH_FUNC: return "DepthFunc";
+	case STATE_CHANGE_DEPTH_MASK: return "DepthMask";
+	case STATE_CHANGE_CULL_FACE: return "CullFace";
+	default: return "Unknown";
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC bool RenderStateCache::ShouldIssue( unsigned int& inout_cachedValue, unsigned int newValue, RenderStateChangeType type )
+{
+	if ( inout_cachedValue == newValue )
+	{
+		++s_currentFrameStats.m_numSkipped[ type ];
+		return false;
+	}
+
+	inout_cachedValue = newValue;
+	++s_currentFrameStats.m_numIssued[ type ];
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::UseProgram( unsigned int programID )
+{
+	if ( ShouldIssue( s_programID, programID, STATE_CHANGE_PROGRAM ) )
+		glUseProgram( programID );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::BindVertexArray( unsigned int vaoID )
+{
+	if ( !ShouldIssue( s_vaoID, vaoID, STATE_CHANGE_VERTEX_ARRAY ) )
+		return;
+
+	glBindVertexArray( vaoID );
+	s_elementBufferID = UNKNOWN; //Whatever the new VAO last recorded.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::BindBuffer( unsigned int glTarget, unsigned int bufferID )
+{
+	unsigned int* cachedBufferID = nullptr;
+	if ( glTarget == GL_ARRAY_BUFFER )
+		cachedBufferID = &s_arrayBufferID;
+	else if ( glTarget == GL_ELEMENT_ARRAY_BUFFER )
+		cachedBufferID = &s_elementBufferID;
+
+	if ( cachedBufferID == nullptr )
+	{
+		++s_currentFrameStats.m_numIssued[ STATE_CHANGE_BUFFER ];
+		glBindBuffer( glTarget, bufferID );
+		return;
+	}
+
+	if ( ShouldIssue( *cachedBufferID, bufferID, STATE_CHANGE_BUFFER ) )
+		glBindBuffer( glTarget, bufferID );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::ActiveTexture( unsigned int textureUnit )
+{
+	if ( ShouldIssue( s_activeTextureUnit, textureUnit, STATE_CHANGE_ACTIVE_TEXTURE ) )
+		glActiveTexture( GL_TEXTURE0 + textureUnit );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::BindTexture2D( unsigned int textureUnit, unsigned int textureID )
+{
+	if ( textureUnit < MAX_TRACKED_TEXTURE_UNITS && !ShouldIssue( s_textureIDs[ textureUnit ], textureID, STATE_CHANGE_TEXTURE ) )
+		return;
+
+	if ( textureUnit >= MAX_TRACKED_TEXTURE_UNITS )
+		++s_currentFrameStats.m_numIssued[ STATE_CHANGE_TEXTURE ];
+
+	ActiveTexture( textureUnit );
+	glBindTexture( GL_TEXTURE_2D, textureID );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::BindSampler( unsigned int textureUnit, unsigned int samplerID )
+{
+	if ( textureUnit < MAX_TRACKED_TEXTURE_UNITS && !ShouldIssue( s_samplerIDs[ textureUnit ], samplerID, STATE_CHANGE_SAMPLER ) )
+		return;
+
+	if ( textureUnit >= MAX_TRACKED_TEXTURE_UNITS )
+		++s_currentFrameStats.m_numIssued[ STATE_CHANGE_SAMPLER ];
+
+	glBindSampler( textureUnit, samplerID ); //Takes the unit directly, no glActiveTexture needed.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::SetCapability( unsigned int glCapability, bool isEnabled )
+{
+	int trackedIndex = -1;
+	switch ( glCapability )
+	{
+	case GL_BLEND: trackedIndex = TRACKED_BLEND; break;
+	case GL_CULL_FACE: trackedIndex = TRACKED_CULL_FACE; break;
+	case GL_DEPTH_TEST: trackedIndex = TRACKED_DEPTH_TEST; break;
+	}
+
+	if ( trackedIndex >= 0 && !ShouldIssue( s_capabilities[ trackedIndex ], isEnabled ? 1 : 0, STATE_CHANGE_CAPABILITY ) )
+		return;
+
+	if ( trackedIndex < 0 )
+		++s_currentFrameStats.m_numIssued[ STATE_CHANGE_CAPABILITY ];
+
+	if ( isEnabled )
+		glEnable( glCapability );
+	else
+		glDisable( glCapability );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::BlendFunc( unsigned int glSourceFactor, unsigned int glDestinationFactor )
+{
+	if ( s_blendSourceFactor == glSourceFactor && s_blendDestinationFactor == glDestinationFactor )
+	{
+		++s_currentFrameStats.m_numSkipped[ STATE_CHANGE_BLEND_FUNC ];
+		return;
+	}
+
+	s_blendSourceFactor = glSourceFactor;
+	s_blendDestinationFactor = glDestinationFactor;
+	++s_currentFrameStats.m_numIssued[ STATE_CHANGE_BLEND_FUNC ];
+	glBlendFunc( glSourceFactor, glDestinationFactor );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::DepthFunc( unsigned int glCompareFunc )
+{
+	if ( ShouldIssue( s_depthFunc, glCompareFunc, STATE_CHANGE_DEPTH_FUNC ) )
+		glDepthFunc( glCompareFunc );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::DepthMask( bool shouldWriteDepths )
+{
+	if ( ShouldIssue( s_depthMask, shouldWriteDepths ? 1 : 0, STATE_CHANGE_DEPTH_MASK ) )
+		glDepthMask( shouldWriteDepths ? GL_TRUE : GL_FALSE );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::CullFace( unsigned int glFace )
+{
+	if ( ShouldIssue( s_cullFace, glFace, STATE_CHANGE_CULL_FACE ) )
+		glCullFace( glFace );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::OnProgramDeleted( unsigned int programID )
+{
+	if ( s_programID == programID )
+		s_programID = UNKNOWN;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::OnVertexArrayDeleted( unsigned int vaoID )
+{
+	if ( s_vaoID != vaoID )
+		return;
+
+	s_vaoID = 0;
+	s_elementBufferID = UNKNOWN;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void RenderStateCache::OnBufferDeleted( unsigned int bufferID )
+{
+	if ( s_arrayBufferID == bufferID )
+		s_arrayBufferID = 0;
+	if ( s_elementBufferID == bufferID )
+		s_elementBufferID = UNKNOWN;
+}
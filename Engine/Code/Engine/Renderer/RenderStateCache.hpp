@@ -0,0 +1,88 @@
+#pragma once
+
+
+//-----------------------------------------------------------------------------
+enum RenderStateChangeType
+{
+	STATE_CHANGE_PROGRAM,
+	STATE_CHANGE_VERTEX_ARRAY,
+	STATE_CHANGE_BUFFER,
+	STATE_CHANGE_ACTIVE_TEXTURE,
+	STATE_CHANGE_TEXTURE,
+	STATE_CHANGE_SAMPLER,
+	STATE_CHANGE_CAPABILITY, //glEnable/glDisable.
+	STATE_CHANGE_BLEND_FUNC,
+	STATE_CHANGE_DEPTH_FUNC,
+	STATE_CHANGE_DEPTH_MASK,
+	STATE_CHANGE_CULL_FACE,
+	NUM_STATE_CHANGE_TYPES
+};
+
+
+//-----------------------------------------------------------------------------
+struct RenderStateCacheStats
+{
+	RenderStateCacheStats() { Clear(); }
+	void Clear() { for ( int i = 0; i < NUM_STATE_CHANGE_TYPES; i++ ) m_numIssued[ i ] = m_numSkipped[ i ] = 0; }
+
+	unsigned int m_numIssued[ NUM_STATE_CHANGE_TYPES ]; //Reached GL.
+	unsigned int m_numSkipped[ NUM_STATE_CHANGE_TYPES ]; //Already the current state, so never sent.
+};
+
+
+//-----------------------------------------------------------------------------
+//Shadows the GL binding and fixed-function state the engine touches, so a bind that wouldn't change anything never reaches the driver.
+//Everything engine-side that changes this state must come through here, else the shadow goes stale and a needed bind gets skipped.
+//Code outside the engine's control that touches GL (e.g. a VR compositor) should be followed by Invalidate().
+class RenderStateCache
+{
+public:
+	static void Invalidate(); //Forget everything, the next set of each state always goes through. TheRenderer calls it once the context is up.
+	static void EndFrame(); //Rolls over the stats.
+	static const RenderStateCacheStats& GetLastFrameStats() { return s_lastFrameStats; }
+	static const char* GetStateChangeTypeName( RenderStateChangeType type );
+
+	static void UseProgram( unsigned int programID );
+	static void BindVertexArray( unsigned int vaoID );
+	static void BindBuffer( unsigned int glTarget, unsigned int bufferID ); //Only GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are tracked.
+	static void ActiveTexture( unsigned int textureUnit ); //0-based unit, NOT GL_TEXTURE0 + unit.
+	static void BindTexture2D( unsigned int textureUnit, unsigned int textureID );
+	static void BindSampler( unsigned int textureUnit, unsigned int samplerID );
+	static void SetCapability( unsigned int glCapability, bool isEnabled ); //Only GL_BLEND, GL_CULL_FACE and GL_DEPTH_TEST are tracked.
+	static void BlendFunc( unsigned int glSourceFactor, unsigned int glDestinationFactor );
+	static void DepthFunc( unsigned int glCompareFunc );
+	static void DepthMask( bool shouldWriteDepths );
+	static void CullFace( unsigned int glFace );
+
+	//GL unbinds deleted names itself, and may hand the same name back out later.
+	static void OnProgramDeleted( unsigned int programID );
+	static void OnVertexArrayDeleted( unsigned int vaoID );
+	static void OnBufferDeleted( unsigned int bufferID );
+
+	static unsigned int GetBoundProgram() { return s_programID; }
+
+
+private:
+	static const unsigned int UNKNOWN = 0xFFFFFFFF;
+	static const unsigned int MAX_TRACKED_TEXTURE_UNITS = 16;
+	enum TrackedCapability { TRACKED_BLEND, TRACKED_CULL_FACE, TRACKED_DEPTH_TEST, NUM_TRACKED_CAPABILITIES };
+
+	static bool ShouldIssue( unsigned int& inout_cachedValue, unsigned int newValue, RenderStateChangeType type );
+
+	static unsigned int s_programID;
+	static unsigned int s_vaoID;
+	static unsigned int s_arrayBufferID;
+	static unsigned int s_elementBufferID; //Belongs to the bound VAO, so forgotten whenever that changes.
+	static unsigned int s_activeTextureUnit;
+	static unsigned int s_textureIDs[ MAX_TRACKED_TEXTURE_UNITS ];
+	static unsigned int s_samplerIDs[ MAX_TRACKED_TEXTURE_UNITS ];
+	static unsigned int s_capabilities[ NUM_TRACKED_CAPABILITIES ]; //0, 1 or UNKNOWN.
+	static unsigned int s_blendSourceFactor;
+	static unsigned int s_blendDestinationFactor;
+	static unsigned int s_depthFunc;
+	static unsigned int s_depthMask;
+	static unsigned int s_cullFace;
+
+	static RenderStateCacheStats s_currentFrameStats;
+	static RenderStateCacheStats s_lastFrameStats;
+};
@@ -0,0 +1,89 @@
+#include "Engine/Renderer/RenderTargetPool.hpp"
+
+
+#include "Engine/Renderer/FrameBuffer.hpp"
+#include "Engine/Error/ErrorWarningAssert.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+RenderTargetPool::~RenderTargetPool()
+{
+	//Their textures go with the rest in TheRenderer::DeleteTextures.
+	for ( PooledTarget& pooled : m_targets )
+		delete pooled.target;
+	m_targets.clear();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+FrameBuffer* RenderTargetPool::Acquire( unsigned int width, unsigned int height, TextureFormat colorFormat, bool hasDepthStencil )
+{
+	for ( PooledTarget& pooled : m_targets )
+	{
+		if ( pooled.isInUse || ( pooled.width != width ) || ( pooled.height != height ) || ( pooled.colorFormat != colorFormat ) || ( pooled.hasDepthStencil != hasDepthStencil ) )
+			continue;
+
+		pooled.isInUse = true;
+		++m_numAcquiresReused;
+		return pooled.target;
+	}
+
+	std::vector<TextureFormat> colorFormats;
+	colorFormats.push_back( colorFormat );
+	const TextureFormat depthStencilFormat = TextureFormat::TEXTURE_FORMAT_Depth24_Stencil8;
+
+	PooledTarget pooled;
+	pooled.target = new FrameBuffer( width, height, colorFormats, hasDepthStencil ? &depthStencilFormat : nullptr );
+	pooled.width = width;
+	pooled.height = height;
+	pooled.colorFormat = colorFormat;
+	pooled.hasDepthStencil = hasDepthStencil;
+	pooled.isInUse = true;
+	m_targets.push_back( pooled );
+
+	return pooled.target;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void RenderTargetPool::Release( FrameBuffer* target )
+{
+	for ( PooledTarget& pooled : m_targets )
+	{
+		if ( pooled.target != target )
+			continue;
+
+		ASSERT_OR_DIE( pooled.isInUse, "RenderTargetPool::Release found a target released twice!" );
+		pooled.isInUse = false;
+		return;
+	}
+
+	ERROR_RECOVERABLE( "RenderTargetPool::Release given a target it doesn't own!" );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int RenderTargetPool::GetNumTargetsInUse() const
+{
+	unsigned int numInUse = 0;
+	for ( const PooledTarget& pooled : m_targets )
+	{
+		if ( pooled.isInUse )
+			++numInUse;
+	}
+	return numInUse;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+size_t RenderTargetPool::GetTargetBytes() const
+{
+	size_t numBytes = 0;
+	for ( const PooledTarget& pooled : m_targets )
+	{
+		const size_t BYTES_PER_TEXEL = 4; //Rgba8 and Depth24_Stencil8 alike.
+		size_t numTexels = static_cast<size_t>( pooled.width ) * pooled.height;
+		numBytes += numTexels * BYTES_PER_TEXEL * ( pooled.hasDepthStencil ? 2 : 1 );
+	}
+	return numBytes;
+}
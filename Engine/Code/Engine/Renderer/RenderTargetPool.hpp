@@ -0,0 +1,49 @@
+#pragma once
+
+
+#include "Engine/Renderer/Texture.hpp"
+#include <vector>
+
+
+//-----------------------------------------------------------------------------
+class FrameBuffer;
+
+
+//-----------------------------------------------------------------------------
+//Hands out FrameBuffers by size and format, so passes that don't overlap in time share one target instead of each
+//owning its own. A released target goes straight back to the pool and the next matching Acquire gets it, which is what
+//makes a chain of passes ping-pong between two targets however long it is.
+//
+//Targets are never freed before the pool is deleted: FrameBuffer doesn't give its GL objects back (see its destructor),
+//so the pool is only as big as the largest set of sizes ever live at once. Callers asking for many sizes should keep
+//them few, e.g. PostProcessGraph renders scaled scenes into a sub-rect of one full-size target.
+class RenderTargetPool
+{
+public:
+	RenderTargetPool() : m_numAcquiresReused( 0 ) {}
+	~RenderTargetPool();
+	RenderTargetPool( const RenderTargetPool& copy ) = delete;
+
+	FrameBuffer* Acquire( unsigned int width, unsigned int height, TextureFormat colorFormat, bool hasDepthStencil );
+	void Release( FrameBuffer* target ); //Its contents are undefined once released, as the next Acquire may draw over them.
+
+	unsigned int GetNumTargets() const { return m_targets.size(); }
+	unsigned int GetNumTargetsInUse() const;
+	unsigned int GetNumAcquiresReused() const { return m_numAcquiresReused; }
+	size_t GetTargetBytes() const;
+
+
+private:
+	struct PooledTarget
+	{
+		FrameBuffer* target;
+		unsigned int width;
+		unsigned int height;
+		TextureFormat colorFormat;
+		bool hasDepthStencil;
+		bool isInUse;
+	};
+
+	std::vector<PooledTarget> m_targets;
+	unsigned int m_numAcquiresReused;
+};
@@ -5,6 +5,7 @@
 #include "Engine/Core/TheConsole.hpp"
 #include "Engine/FileUtils/FileUtils.hpp"
 #include "Engine/FileUtils/XMLUtils.hpp"
+#include "Engine/FileUtils/XMLStreamReader.hpp"
 #include "Engine/Renderer/Material.hpp"
 #include "Engine/Renderer/ShaderProgram.hpp"
 
@@ -30,22 +31,15 @@ STATIC ResourceDatabase* /*CreateOrGet*/ ResourceDatabase::Instance()
 
 
 //--------------------------------------------------------------------------------------------------------------
-static SpriteResource* CreateSpriteResourceFromXML( const XMLNode& resourceNode )
+static SpriteResource* CreateSpriteResourceFromXML( const XMLStreamReader& resourceReader )
 {
-	std::string name, imageFilePath, materialName, uvTopLeftStr, uvBottomRightStr;
-	Vector2f uv_tl = Vector2f::ZERO;
-	Vector2f uv_br = Vector2f::ONE;
+	std::string name = resourceReader.ReadAttribute( "name", std::string() );
+	std::string imageFilePath = resourceReader.ReadAttribute( "image", std::string() );
+	std::string materialName = resourceReader.ReadAttribute( "material", std::string() );
+	Vector2f uv_tl = resourceReader.ReadAttribute( "uvTopLeft", Vector2f::ZERO );
+	Vector2f uv_br = resourceReader.ReadAttribute( "uvBottomRight", Vector2f::ONE );
 
-	name = ReadXMLAttribute( resourceNode, "name", name );
-	imageFilePath = ReadXMLAttribute( resourceNode, "image", imageFilePath );
-	materialName = ReadXMLAttribute( resourceNode, "material", materialName );
-	uvTopLeftStr = ReadXMLAttribute( resourceNode, "uvTopLeft", uvTopLeftStr );
-	uvBottomRightStr = ReadXMLAttribute( resourceNode, "uvBottomRight", uvBottomRightStr );
-
-	sscanf_s( uvTopLeftStr.c_str(), "%f,%f", &uv_tl.x, &uv_tl.y );
-	sscanf_s( uvBottomRightStr.c_str(), "%f,%f", &uv_br.x, &uv_br.y );
-
-	SpriteResource* sr = SpriteResource::Create( name, imageFilePath.c_str() ); //Will add to DB in here.
+	SpriteResource* sr = SpriteResource::CreateAsync( name, imageFilePath.c_str() ); //Will add to DB in here.
 
 	if ( materialName != "" )
 	{
@@ -61,25 +55,20 @@ static SpriteResource* CreateSpriteResourceFromXML( const XMLNode& resourceNode
 
 
 //--------------------------------------------------------------------------------------------------------------
-static void CreateSpriteSequenceFromXML( const XMLNode& animNode )
+static void CreateSpriteSequenceFromXML( XMLStreamReader& animReader ) //Consumes the SpriteAnimation element's keyframe children.
 {
-	std::string name = "Unnamed Animation";
-	std::string loopModeStr;
-	float durationSeconds = -1.f;
-
-	name = ReadXMLAttribute( animNode, "name", name );
-	loopModeStr = ReadXMLAttribute( animNode, "loopMode", loopModeStr );
-	durationSeconds = ReadXMLAttribute( animNode, "durationSeconds", durationSeconds );
+	std::string name = animReader.ReadAttribute( "name", std::string( "Unnamed Animation" ) );
+	std::string loopModeStr = animReader.ReadAttribute( "loopMode", std::string() );
+	float durationSeconds = animReader.ReadAttribute( "durationSeconds", -1.f );
 
 	AnimatedSpriteSequence* anim = new AnimatedSpriteSequence( name, GetLoopModeForString( loopModeStr ), durationSeconds );
 
 	//Note keyframes will have their own SpriteResources registered to the database.
-	for ( int keyframeIndex = 0; keyframeIndex < animNode.nChildNode(); keyframeIndex++ )
+	int animDepth = animReader.GetDepth();
+	while ( animReader.ReadToNextChildElement( animDepth ) )
 	{
-		XMLNode keyframeNode = animNode.getChildNode( keyframeIndex );
-		SpriteResource* sr = CreateSpriteResourceFromXML( keyframeNode );
-		float keyframeStartSeconds = -1.f;
-		keyframeStartSeconds = ReadXMLAttribute( keyframeNode, "keyframeStart", keyframeStartSeconds );
+		float keyframeStartSeconds = animReader.ReadAttribute( "keyframeStart", -1.f );
+		SpriteResource* sr = CreateSpriteResourceFromXML( animReader );
 		anim->AddKeyframe( keyframeStartSeconds, sr );
 	}
 
@@ -135,21 +124,24 @@ STATIC void ResourceDatabase::LoadAllSpriteResources()
 {
 	//Note we may have more than one SpriteResource in a file.
 	std::vector< std::string > m_spriteFiles = EnumerateFilesInDirectory( "Data/XML/SpriteResources", "*.Sprites.xml" );
+	XMLStreamReader reader; //Reused across files so its buffer only grows.
 	
 	for ( unsigned int spriteFileIndex = 0; spriteFileIndex < m_spriteFiles.size(); spriteFileIndex++ )
 	{
 		const char* xmlFilename = m_spriteFiles[ spriteFileIndex ].c_str();
-		XMLNode resourcesRoot = XMLNode::openFileHelper( xmlFilename, "SpriteResources" );
-
-		for ( int resourceIndex = 0; resourceIndex < resourcesRoot.nChildNode(); resourceIndex++ )
+		if ( !reader.OpenFileCooked( xmlFilename ) || !reader.ReadToNextStartElement( "SpriteResources" ) )
 		{
-			XMLNode resourceNode = resourcesRoot.getChildNode( resourceIndex );
+			ERROR_RECOVERABLE( Stringf( "Failed to find SpriteResources in %s!", xmlFilename ) );
+			continue;
+		}
 
-			if ( strcmp( resourceNode.getName(), "SpriteAnimation" ) == 0 )
-				CreateSpriteSequenceFromXML( resourceNode );
+		int rootDepth = reader.GetDepth();
+		while ( reader.ReadToNextChildElement( rootDepth ) )
+		{
+			if ( reader.GetName() == "SpriteAnimation" )
+				CreateSpriteSequenceFromXML( reader );
 			else //Normal 1-sprite SpriteResource
-				CreateSpriteResourceFromXML( resourceNode );
-				
+				CreateSpriteResourceFromXML( reader );
 		}
 	}
 }
@@ -160,28 +152,25 @@ STATIC void ResourceDatabase::ReloadAllSpriteResources()
 {	
 	//Note we may have more than one SpriteResource in a file.
 	std::vector< std::string > m_spriteFiles = EnumerateFilesInDirectory( "Data/XML/SpriteResources", "*.Sprites.xml" );
+	XMLStreamReader reader;
 
 	for ( unsigned int spriteFileIndex = 0; spriteFileIndex < m_spriteFiles.size(); spriteFileIndex++ )
 	{
 		const char* xmlFilename = m_spriteFiles[ spriteFileIndex ].c_str();
-		XMLNode resourcesRoot = XMLNode::openFileHelper( xmlFilename, "SpriteResources" );
-
-		for ( int resourceIndex = 0; resourceIndex < resourcesRoot.nChildNode(); resourceIndex++ )
+		if ( !reader.OpenFileCooked( xmlFilename ) || !reader.ReadToNextStartElement( "SpriteResources" ) )
 		{
-			XMLNode resourceNode = resourcesRoot.getChildNode( resourceIndex );
-
-			std::string name, imageFilePath, materialName, uvTopLeftStr, uvBottomRightStr;
-			Vector2f uv_tl = Vector2f::ZERO;
-			Vector2f uv_br = Vector2f::ONE;
-
-			name = ReadXMLAttribute( resourceNode, "name", name );
-			imageFilePath = ReadXMLAttribute( resourceNode, "image", imageFilePath );
-			materialName = ReadXMLAttribute( resourceNode, "material", materialName );
-			uvTopLeftStr = ReadXMLAttribute( resourceNode, "uvTopLeft", uvTopLeftStr );
-			uvBottomRightStr = ReadXMLAttribute( resourceNode, "uvBottomRight", uvBottomRightStr );
+			ERROR_RECOVERABLE( Stringf( "Failed to find SpriteResources in %s!", xmlFilename ) );
+			continue;
+		}
 
-			sscanf_s( uvTopLeftStr.c_str(), "%f,%f", &uv_tl.x, &uv_tl.y );
-			sscanf_s( uvBottomRightStr.c_str(), "%f,%f", &uv_br.x, &uv_br.y );
+		int rootDepth = reader.GetDepth();
+		while ( reader.ReadToNextChildElement( rootDepth ) )
+		{
+			std::string name = reader.ReadAttribute( "name", std::string() );
+			std::string imageFilePath = reader.ReadAttribute( "image", std::string() );
+			std::string materialName = reader.ReadAttribute( "material", std::string() );
+			Vector2f uv_tl = reader.ReadAttribute( "uvTopLeft", Vector2f::ZERO );
+			Vector2f uv_br = reader.ReadAttribute( "uvBottomRight", Vector2f::ONE );
 
 			SpriteResource* sr;
 			if ( s_spriteResourceRegistry.count( name ) > 0 )
@@ -9,12 +9,28 @@
 #include "Engine/Error/ErrorWarningAssert.hpp"
 #include "Engine/EngineCommon.hpp"
 #include "Engine/Math/Vector4.hpp"
+#include "Engine/Math/Matrix44.hpp"
 #include "Engine/Renderer/Rgba.hpp"
 #include "Engine/Renderer/Vertexes.hpp"
+#include "Engine/Renderer/TransientGeometryBuffer.hpp"
+#include "Engine/Core/Logger.hpp"
+#include "Engine/Renderer/RenderStateCache.hpp"
+#include <cstring>
 
 
 //--------------------------------------------------------------------------------------------------------------
 STATIC ShaderProgramRegistryMap	ShaderProgram::s_shaderProgramRegistry;
+STATIC UniformCacheStats ShaderProgram::s_currentFrameUniformStats;
+STATIC UniformCacheStats ShaderProgram::s_lastFrameUniformStats;
+static const unsigned int GL_CALLS_PER_UNCACHED_SET = 5; //What each Set* used to cost: glUseProgram, glGetUniformLocation, glUniform*, then glUseProgram( 0 ) and glActiveTexture.
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int UniformCacheStats::GetNumGLCallsAvoided() const
+{
+	unsigned int numCallsBefore = m_numSetCalls * GL_CALLS_PER_UNCACHED_SET;
+	return ( numCallsBefore > m_numUploads ) ? ( numCallsBefore - m_numUploads ) : 0;
+}
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -33,7 +49,7 @@ ShaderVariableType GetEngineShaderVariableType( GLenum glShaderVariableType )
 	case GL_FLOAT_VEC4: return GLSL_VEC4;
 	case GL_FLOAT_MAT4: return GLSL_MAT4;
 	case GL_SAMPLER_2D: return GLSL_SAMPLER2D;
-	default: ERROR_AND_DIE( "Unsupported glShaderVariableType in GetEngineShaderVariableType!" );
+	default: return INVALID_TYPE; //RecordUniforms skips these rather than dying on e.g. a sampler type we don't wrap yet.
 	}
 }
 
@@ -139,6 +155,7 @@ GLuint CreateAndLinkProgram( GLuint vertexShader, GLuint fragmentShader, const s
 ShaderProgram::ShaderProgram( const std::string& shaderProgramName, const char* vertexShaderFilePath, const char* fragmentShaderFilePath, const VertexDefinition& vertexDefinition )
 	: m_vertexDefinition( &vertexDefinition )
 	, m_shaderProgramName( shaderProgramName )
+	, m_pendingTransientBatch( nullptr )
 {
 	Shader* vertexShader = Shader::CreateOrGetShader( vertexShaderFilePath, ShaderType::VERTEX_SHADER );
 	Shader* fragmentShader = Shader::CreateOrGetShader( fragmentShaderFilePath, ShaderType::FRAGMENT_SHADER );
@@ -169,6 +186,7 @@ ShaderProgram::ShaderProgram( const std::string& shaderProgramName, const char*
 ShaderProgram::ShaderProgram( const std::string& shaderProgramName, Shader* vertexShader, Shader* fragmentShader, const VertexDefinition& vertexDefinition )
 	: m_vertexDefinition( &vertexDefinition )
 	, m_shaderProgramName( shaderProgramName )
+	, m_pendingTransientBatch( nullptr )
 {
 	ASSERT_OR_DIE( vertexShader != NULL && fragmentShader != NULL, "Found Null Shaders in CreateLoadAndLinkShaderProgram()" );
 
@@ -228,6 +246,29 @@ void ShaderProgram::DeleteShaderPrograms()
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+STATIC void ShaderProgram::EndFrame()
+{
+	s_lastFrameUniformStats = s_currentFrameUniformStats;
+	s_currentFrameUniformStats.Clear();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int ShaderProgram::GetUniformElementSize( ShaderVariableType glslType )
+{
+	switch ( glslType )
+	{
+	case GLSL_INT: case GLSL_UINT: case GLSL_FLOAT: case GLSL_SAMPLER2D: return 4;
+	case GLSL_UVEC2: case GLSL_VEC2: return 8;
+	case GLSL_UVEC3: case GLSL_VEC3: return 12;
+	case GLSL_UVEC4: case GLSL_VEC4: return 16;
+	case GLSL_MAT4: return 64;
+	default: return 0; //Unsupported, callers treat as "no shadow storage".
+	}
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 void ShaderProgram::RecordUniforms()
 {
@@ -245,14 +286,30 @@ void ShaderProgram::RecordUniforms()
 		char* uniformNameBuffer = new char[ bufferSize ];
 		glGetActiveUniform( m_shaderProgramID, uniformIndex, bufferSize, &lengthWritten, &uniformSize, &uniformType, uniformNameBuffer );
 
+		ShaderVariableType glslType = GetEngineShaderVariableType( uniformType );
+		unsigned int elementSize = GetUniformElementSize( glslType );
+		if ( elementSize == 0 )
+		{
+			Logger::PrintfWithTag( "ShaderProgram", "Skipping uniform %s of unsupported GL type 0x%x in %s, sets on it will fail to find a handle.", uniformNameBuffer, uniformType, m_shaderProgramName.c_str() );
+			delete[] uniformNameBuffer;
+			continue;
+		}
+
 		ShaderProgramUniform spu;
-		spu.m_glslType = GetEngineShaderVariableType( uniformType );
+		spu.m_glslType = glslType;
 		spu.m_count = uniformSize;
-		spu.m_uniformLocation = uniformIndex;
+		spu.m_uniformLocation = glGetUniformLocation( m_shaderProgramID, uniformNameBuffer );
 		spu.m_uniformNameVerbatim = uniformNameBuffer;
+		spu.m_uniformNameHash = std::hash< std::string >()( uniformNameBuffer );
 		spu.m_samplerID = ShaderProgramUniform::UNSET;
 		spu.m_textureID = ShaderProgramUniform::UNSET;
+		spu.m_valueOffset = m_uniformValues.size();
+		spu.m_valueSize = elementSize * spu.m_count;
+		spu.m_shouldTranspose = false;
+		spu.m_isDirty = false; //GL zero-initializes uniforms at link, same as the shadow copy below.
 		m_programUniforms.push_back( spu );
+
+		m_uniformValues.resize( m_uniformValues.size() + spu.m_valueSize, 0 );
 	}
 }
 
@@ -265,6 +322,7 @@ ShaderProgram::~ShaderProgram()
 	glDeleteShader( m_vertexShaderID );
 	glDeleteShader( m_fragmentShaderID );
 	glDeleteProgram( m_shaderProgramID );
+	RenderStateCache::OnProgramDeleted( m_shaderProgramID );
 
 	for ( ShaderProgramUniform& programUniform : m_programUniforms )
 	{
@@ -280,7 +338,7 @@ ShaderProgram::~ShaderProgram()
 //--------------------------------------------------------------------------------------------------------------
 TODO( "Revise attribute and uniform caching to Forseth's comments." );
 //Called by Material::BindInputAttribute which is called by MeshRenderer::SetMaterial.
-unsigned int ShaderProgram::BindInputAttribute( const std::string& attributeName, unsigned int count, VertexFieldType fieldType, bool normalize, int strideInBytes, int offsetInBytes )
+unsigned int ShaderProgram::BindInputAttribute( const std::string& attributeName, unsigned int count, VertexFieldType fieldType, bool normalize, int strideInBytes, int offsetInBytes, unsigned int instanceDivisor /*= 0*/ )
 {
 	int bindPoint = glGetAttribLocation( m_shaderProgramID, attributeName.c_str() );
 	unsigned int glFieldType = GetOpenGLVertexFieldType( fieldType );
@@ -306,6 +364,8 @@ unsigned int ShaderProgram::BindInputAttribute( const std::string& attributeName
 				(GLsizei)strideInBytes, // Stride: how far between each the beginning of each element
 				(GLvoid*)offsetInBytes // Where we can find the first such attribute in the buffer. Returns # bytes from beginning of type.
 			);
+
+		glVertexAttribDivisor( bindPoint, instanceDivisor ); //Always set, since VAOs reused across materials could otherwise keep a stale one.
 	}
 
 	return bindPoint;
@@ -329,7 +389,7 @@ void ShaderProgram::AddInputAttribute( const std::string& attributeNameVerbatim,
 //--------------------------------------------------------------------------------------------------------------
 void ShaderProgram::BindProgram()
 {
-	glUseProgram( m_shaderProgramID );
+	RenderStateCache::UseProgram( m_shaderProgramID );
 }
 
 
@@ -338,8 +398,9 @@ void ShaderProgram::BindTextures()
 {
 	//Bind textures to slots, looping over all uniforms to see which ones are textures.
 	unsigned int texIndex = 0;
-	for ( ShaderProgramUniform currentUniform : m_programUniforms )
+	for ( unsigned int uniformIndex = 0; uniformIndex < m_programUniforms.size(); uniformIndex++ )
 	{
+		const ShaderProgramUniform& currentUniform = m_programUniforms[ uniformIndex ];
 		if ( currentUniform.m_glslType != GLSL_SAMPLER2D )
 			continue;
 
@@ -347,10 +408,9 @@ void ShaderProgram::BindTextures()
 			 || currentUniform.m_textureID == ShaderProgramUniform::UNSET )
 			continue;
 
-		glActiveTexture( GL_TEXTURE0 + texIndex );
-		glBindTexture( GL_TEXTURE_2D, currentUniform.m_textureID );
-		glBindSampler( texIndex, currentUniform.m_samplerID );
-		SetInt( currentUniform.m_uniformNameVerbatim, (int*)&texIndex ); //The active tex bind port from glActiveTexture, not the tex ID.
+		RenderStateCache::BindTexture2D( texIndex, currentUniform.m_textureID );
+		RenderStateCache::BindSampler( texIndex, currentUniform.m_samplerID );
+		SetInt( (UniformHandle)uniformIndex, (int*)&texIndex ); //The active tex bind port from glActiveTexture, not the tex ID.
 																  //NOT passing the samplerID, passing where to bind the sampler to, since OpenGL has a limited # sampler ports to bind at.
 
 		++texIndex;
@@ -361,184 +421,246 @@ void ShaderProgram::BindTextures()
 //--------------------------------------------------------------------------------------------------------------
 STATIC void ShaderProgram::UnbindAnyPrograms()
 {
-	glUseProgram( NULL );
-	glActiveTexture( GL_TEXTURE0 ); //Else font will mess up and all objects will texture oddly (since it doesn't reset to default plain white texture).
+	RenderStateCache::UseProgram( NULL );
+	RenderStateCache::ActiveTexture( 0 ); //Else font will mess up and all objects will texture oddly (since it doesn't reset to default plain white texture).
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-ShaderProgramUniform* ShaderProgram::FindUniform( const std::string& uniformNameVerbatim )
+void ShaderProgram::UploadDirtyUniforms()
 {
 	for ( ShaderProgramUniform& currentUniform : m_programUniforms )
 	{
-		if ( currentUniform.m_uniformNameVerbatim != uniformNameVerbatim )
+		if ( !currentUniform.m_isDirty )
 			continue;
 
-		return &currentUniform;
+		currentUniform.m_isDirty = false;
+		if ( currentUniform.m_uniformLocation < 0 )
+			continue;
+
+		const void* value = &m_uniformValues[ currentUniform.m_valueOffset ];
+		GLint loc = currentUniform.m_uniformLocation;
+		GLsizei count = currentUniform.m_count;
+		switch ( currentUniform.m_glslType )
+		{
+		case GLSL_INT:
+		case GLSL_SAMPLER2D: glUniform1iv( loc, count, (const GLint*)value ); break;
+		case GLSL_FLOAT: glUniform1fv( loc, count, (const GLfloat*)value ); break;
+		case GLSL_VEC2: glUniform2fv( loc, count, (const GLfloat*)value ); break;
+		case GLSL_VEC3: glUniform3fv( loc, count, (const GLfloat*)value ); break;
+		case GLSL_VEC4: glUniform4fv( loc, count, (const GLfloat*)value ); break;
+		case GLSL_MAT4: glUniformMatrix4fv( loc, count, (GLboolean)currentUniform.m_shouldTranspose, (const GLfloat*)value ); break;
+			//shouldTranspose: must be true if using row-major MVP && left-multiplying vert*MVP in shader!.
+			//NOTE: OpenGL ES and WebGL seem to potentially not allow true here, in which case just invert any val param with val->m_ordering == ROW_MAJOR.
+		default: continue; //No setter writes unsigned types.
+		}
+		++s_currentFrameUniformStats.m_numUploads;
 	}
-	return nullptr;
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-bool ShaderProgram::SetMatrix4x4( const std::string& uniformNameVerbatim, bool shouldTranspose, const Matrix4x4f* val, unsigned int arraySize /*= 1*/ )
+ShaderProgramUniform* ShaderProgram::FindUniform( const std::string& uniformNameVerbatim )
 {
-	if ( FindUniform( uniformNameVerbatim ) == nullptr )
-		return false;
+	UniformHandle handle = GetUniformHandle( uniformNameVerbatim );
+	return ( handle != INVALID_UNIFORM_HANDLE ) ? &m_programUniforms[ handle ] : nullptr;
+}
 
-	FIXME( "Remove m_ordering => GetMatrixOrdering { return ROW_MAJOR } depending on GL ES. This slows down things by remaking vectors repeatedly." );
-	//Convert Matrix4x4 class which has extra members to an array of only matrix data to send to card:
-	std::vector< float > matrixValues;
-	for ( unsigned int matrixIndex = 0; matrixIndex < arraySize; matrixIndex++ )
-	{
-		const float* inMatrixData = val[ matrixIndex ].m_data;
-		for ( int i = 0; i < 16; i++ )
-			matrixValues.push_back( inMatrixData[ i ] );
-	}
 
-	BindProgram();
-	GLint loc = glGetUniformLocation( m_shaderProgramID, uniformNameVerbatim.c_str() );
-	if ( loc >= 0 )
+//--------------------------------------------------------------------------------------------------------------
+UniformHandle ShaderProgram::GetUniformHandle( const std::string& uniformNameVerbatim ) const
+{
+	size_t nameHash = std::hash< std::string >()( uniformNameVerbatim );
+	for ( unsigned int uniformIndex = 0; uniformIndex < m_programUniforms.size(); uniformIndex++ )
 	{
-		TODO( "Replace &val by _offsetof(Matrix4x4, m_data) to foolproof against shifting bug." );
-		//BE VERY CAREFUL THAT THE DATA IS THE FIRST ELEMENT OF THE CLASS, ELSE BELOW CODE IS SHIFTED BY OTHER MEMBERS OF MATRIX CLASS.
-		glUniformMatrix4fv( loc, arraySize, (GLboolean)shouldTranspose, (GLfloat*)matrixValues.data() ); //shouldTranspose: must be true if using row-major MVP && left-multiplying vert*MVP in shader!.
-		//NOTE: OpenGL ES and WebGL seem to potentially not allow true here, in which case just invert any val param with val->m_ordering == ROW_MAJOR.
-		UnbindAnyPrograms();
-		return true;
+		const ShaderProgramUniform& currentUniform = m_programUniforms[ uniformIndex ];
+		if ( currentUniform.m_uniformNameHash != nameHash || currentUniform.m_uniformNameVerbatim != uniformNameVerbatim )
+			continue;
+
+		return (UniformHandle)uniformIndex;
 	}
-	UnbindAnyPrograms();
-	return false;
+	return INVALID_UNIFORM_HANDLE;
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-bool ShaderProgram::SetColor( const std::string& uniformNameVerbatim, const Rgba* val, unsigned int arraySize /*= 1*/ )
+bool ShaderProgram::SetUniformValue( UniformHandle handle, ShaderVariableType expectedType, const void* newValue, unsigned int arraySize, bool shouldTranspose /*= false*/ )
 {
-	if ( FindUniform( uniformNameVerbatim ) == nullptr )
+	if ( handle < 0 || handle >= (int)m_programUniforms.size() )
 		return false;
 
-	BindProgram();
-	GLint loc = glGetUniformLocation( m_shaderProgramID, uniformNameVerbatim.c_str() );
-	if ( loc >= 0 )
-	{
-		Vector4f* colorAsFloats = new Vector4f[ arraySize ];
-		for ( unsigned int colorArrayIndex = 0; colorArrayIndex < arraySize; colorArrayIndex++ )
-			colorAsFloats[ colorArrayIndex ] = val[ colorArrayIndex ].GetAsFloats();
+	ShaderProgramUniform& uniform = m_programUniforms[ handle ];
+	bool isIntSetOnSampler = ( expectedType == GLSL_INT && uniform.m_glslType == GLSL_SAMPLER2D );
+	if ( uniform.m_glslType != expectedType && !isIntSetOnSampler )
+		return false; //glUniform* would have raised GL_INVALID_OPERATION and ignored it too.
+
+	unsigned int numBytes = GetUniformElementSize( uniform.m_glslType ) * arraySize;
+	if ( numBytes > uniform.m_valueSize )
+		numBytes = uniform.m_valueSize; //Clamp writes past the end of the array, as GL does.
 
-		//Need to loop and do this cast based on the arraySize per array element!!
+	++s_currentFrameUniformStats.m_numSetCalls;
 
-		glUniform4fv( loc, arraySize, (GLfloat*)&colorAsFloats[0] );
-		UnbindAnyPrograms();
-		delete colorAsFloats;
+	unsigned char* shadowValue = &m_uniformValues[ uniform.m_valueOffset ];
+	if ( uniform.m_shouldTranspose == shouldTranspose && memcmp( shadowValue, newValue, numBytes ) == 0 )
+	{
+		++s_currentFrameUniformStats.m_numRedundantSets;
 		return true;
 	}
-	UnbindAnyPrograms();
-	return false;
+
+	OnUniformChanging( handle );
+	memcpy( shadowValue, newValue, numBytes );
+	uniform.m_shouldTranspose = shouldTranspose;
+	uniform.m_isDirty = true;
+	return true;
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-bool ShaderProgram::SetVector2( const std::string& uniformNameVerbatim, const Vector2f* val, unsigned int arraySize /*= 1*/ )
+void ShaderProgram::OnUniformChanging( UniformHandle handle )
 {
-	if ( FindUniform( uniformNameVerbatim ) == nullptr )
-		return false;
+	if ( m_pendingTransientBatch != nullptr )
+		m_pendingTransientBatch->OnStagedUniformChanging( handle ); //May flush, drawing with the values it was staged against.
+}
 
-	BindProgram();
-	GLint loc = glGetUniformLocation( m_shaderProgramID, uniformNameVerbatim.c_str() );
-	if ( loc >= 0 )
-	{
-		glUniform2fv( loc, arraySize, (GLfloat*)val );
-		UnbindAnyPrograms();
-		return true;
-	}
-	UnbindAnyPrograms();
-	return false;
+
+//--------------------------------------------------------------------------------------------------------------
+void ShaderProgram::SetPendingTransientBatch( TransientGeometryBuffer* batchOwner )
+{
+	if ( ( m_pendingTransientBatch != nullptr ) && ( m_pendingTransientBatch != batchOwner ) )
+		m_pendingTransientBatch->Flush(); //Staged first, so it draws first. Flushing unregisters it.
+
+	m_pendingTransientBatch = batchOwner;
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-bool ShaderProgram::SetVector3( const std::string& uniformNameVerbatim, const Vector3f* val, unsigned int arraySize /*= 1*/ )
+bool ShaderProgram::SetMatrix4x4( UniformHandle handle, bool shouldTranspose, const Matrix4x4f* val, unsigned int arraySize /*= 1*/ )
 {
-	if ( FindUniform( uniformNameVerbatim ) == nullptr )
-		return false;
+	if ( arraySize == 1 ) //Common case, m_data is already the 16 contiguous floats to send.
+		return SetUniformValue( handle, GLSL_MAT4, val->m_data, 1, shouldTranspose );
 
-	BindProgram();
-	GLint loc = glGetUniformLocation( m_shaderProgramID, uniformNameVerbatim.c_str() );
-	if ( loc >= 0 )
-	{
-		glUniform3fv( loc, arraySize, (GLfloat*)val );
-		UnbindAnyPrograms();
-		return true;
-	}
-	UnbindAnyPrograms();
-	return false;
+	//Convert Matrix4x4 class which has extra members to an array of only matrix data to send to card:
+	m_matrixScratch.resize( arraySize * 16 );
+	for ( unsigned int matrixIndex = 0; matrixIndex < arraySize; matrixIndex++ )
+		memcpy( &m_matrixScratch[ matrixIndex * 16 ], val[ matrixIndex ].m_data, sizeof( float ) * 16 );
+
+	return SetUniformValue( handle, GLSL_MAT4, m_matrixScratch.data(), arraySize, shouldTranspose );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-bool ShaderProgram::SetVector4( const std::string& uniformNameVerbatim, const Vector4f* val, unsigned int arraySize /*= 1*/ )
+bool ShaderProgram::SetMatrix4x4( UniformHandle handle, bool shouldTranspose, const Matrix44* val, unsigned int arraySize /*= 1*/ )
 {
-	if ( FindUniform( uniformNameVerbatim ) == nullptr )
-		return false;
+	//Matrix44 is only its 16 floats, so any array of them is already what the card expects.
+	return SetUniformValue( handle, GLSL_MAT4, val->m_data, arraySize, shouldTranspose );
+}
 
-	BindProgram();
-	GLint loc = glGetUniformLocation( m_shaderProgramID, uniformNameVerbatim.c_str() );
-	if ( loc >= 0 )
-	{
-		glUniform4fv( loc, arraySize, (GLfloat*)val );
-		UnbindAnyPrograms();
-		return true;
-	}
-	UnbindAnyPrograms();
-	return false;
+
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetColor( UniformHandle handle, const Rgba* val, unsigned int arraySize /*= 1*/ )
+{
+	m_colorScratch.resize( arraySize );
+	for ( unsigned int colorArrayIndex = 0; colorArrayIndex < arraySize; colorArrayIndex++ )
+		m_colorScratch[ colorArrayIndex ] = val[ colorArrayIndex ].GetAsFloats();
+
+	return SetUniformValue( handle, GLSL_VEC4, m_colorScratch.data(), arraySize );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-bool ShaderProgram::SetFloat( const std::string& uniformNameVerbatim, const float* val, unsigned int arraySize /*= 1*/ )
+bool ShaderProgram::SetVector2( UniformHandle handle, const Vector2f* val, unsigned int arraySize /*= 1*/ )
 {
-	if ( FindUniform( uniformNameVerbatim ) == nullptr )
-		return false;
+	return SetUniformValue( handle, GLSL_VEC2, val, arraySize );
+}
 
-	BindProgram();
-	GLint loc = glGetUniformLocation( m_shaderProgramID, uniformNameVerbatim.c_str() );
-	if ( loc >= 0 )
-	{
-		glUniform1fv( loc, arraySize, (GLfloat*)val );
-		UnbindAnyPrograms();
-		return true;
-	}
-	UnbindAnyPrograms();
-	return false;
+
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetVector3( UniformHandle handle, const Vector3f* val, unsigned int arraySize /*= 1*/ )
+{
+	return SetUniformValue( handle, GLSL_VEC3, val, arraySize );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-bool ShaderProgram::SetInt( const std::string& uniformNameVerbatim, const int* val, unsigned int arraySize /*= 1*/ ) //Also used for setting a sampler value.
+bool ShaderProgram::SetVector4( UniformHandle handle, const Vector4f* val, unsigned int arraySize /*= 1*/ )
 {
-	if ( FindUniform( uniformNameVerbatim ) == nullptr )
-		return false;
+	return SetUniformValue( handle, GLSL_VEC4, val, arraySize );
+}
 
-	BindProgram();
-	GLint loc = glGetUniformLocation( m_shaderProgramID, uniformNameVerbatim.c_str() );
-	if ( loc >= 0 )
-	{
-		glUniform1iv( loc, arraySize, (GLint*)val );
-		UnbindAnyPrograms();
-		return true;
-	}
-	UnbindAnyPrograms();
-	return false;
+
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetFloat( UniformHandle handle, const float* val, unsigned int arraySize /*= 1*/ )
+{
+	return SetUniformValue( handle, GLSL_FLOAT, val, arraySize );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-bool ShaderProgram::SetSampler( const std::string& uniformNameVerbatim, unsigned int newSamplerID ) //Also used for setting a sampler value.
+bool ShaderProgram::SetInt( UniformHandle handle, const int* val, unsigned int arraySize /*= 1*/ ) //Also used for setting a sampler value.
 {
-	if ( FindUniform( uniformNameVerbatim ) == nullptr )
-		return false;
+	return SetUniformValue( handle, GLSL_INT, val, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetMatrix4x4( const std::string& uniformNameVerbatim, bool shouldTranspose, const Matrix4x4f* val, unsigned int arraySize /*= 1*/ )
+{
+	return SetMatrix4x4( GetUniformHandle( uniformNameVerbatim ), shouldTranspose, val, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetMatrix4x4( const std::string& uniformNameVerbatim, bool shouldTranspose, const Matrix44* val, unsigned int arraySize /*= 1*/ )
+{
+	return SetMatrix4x4( GetUniformHandle( uniformNameVerbatim ), shouldTranspose, val, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetColor( const std::string& uniformNameVerbatim, const Rgba* val, unsigned int arraySize /*= 1*/ )
+{
+	return SetColor( GetUniformHandle( uniformNameVerbatim ), val, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetVector2( const std::string& uniformNameVerbatim, const Vector2f* val, unsigned int arraySize /*= 1*/ )
+{
+	return SetVector2( GetUniformHandle( uniformNameVerbatim ), val, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetVector3( const std::string& uniformNameVerbatim, const Vector3f* val, unsigned int arraySize /*= 1*/ )
+{
+	return SetVector3( GetUniformHandle( uniformNameVerbatim ), val, arraySize );
+}
+
 
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetVector4( const std::string& uniformNameVerbatim, const Vector4f* val, unsigned int arraySize /*= 1*/ )
+{
+	return SetVector4( GetUniformHandle( uniformNameVerbatim ), val, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetFloat( const std::string& uniformNameVerbatim, const float* val, unsigned int arraySize /*= 1*/ )
+{
+	return SetFloat( GetUniformHandle( uniformNameVerbatim ), val, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetInt( const std::string& uniformNameVerbatim, const int* val, unsigned int arraySize /*= 1*/ ) //Also used for setting a sampler value.
+{
+	return SetInt( GetUniformHandle( uniformNameVerbatim ), val, arraySize );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetSampler( const std::string& uniformNameVerbatim, unsigned int newSamplerID ) //Also used for setting a sampler value.
+{
 	//Edit m_programUniforms, let Material::Render() call BindProgram() which can then loop and handle textures.
 	ShaderProgramUniform* requestedUniform = FindUniform( uniformNameVerbatim );
 	if ( requestedUniform == nullptr )
@@ -547,6 +669,8 @@ bool ShaderProgram::SetSampler( const std::string& uniformNameVerbatim, unsigned
 	if ( requestedUniform->m_glslType != GLSL_SAMPLER2D )
 		return false;
 
+	if ( requestedUniform->m_samplerID != newSamplerID )
+		OnUniformChanging( static_cast<UniformHandle>( requestedUniform - m_programUniforms.data() ) );
 	requestedUniform->m_samplerID = newSamplerID;
 
 	return true;
@@ -554,20 +678,37 @@ bool ShaderProgram::SetSampler( const std::string& uniformNameVerbatim, unsigned
 
 
 //--------------------------------------------------------------------------------------------------------------
-bool ShaderProgram::SetTexture( const std::string& uniformNameVerbatim, unsigned int newTextureID ) //Also used for setting a sampler value.
+bool ShaderProgram::SetTexture( UniformHandle handle, unsigned int newTextureID )
 {
-	if ( FindUniform( uniformNameVerbatim ) == nullptr )
-		return false;
-
 	//Edit m_programUniforms, let Material::Render() call BindProgram() which can then loop all uniforms, use .m_texIndex > 0 to see which are textures.
-	ShaderProgramUniform* requestedUniform = FindUniform( uniformNameVerbatim );
-	if ( requestedUniform == nullptr )
+	if ( handle < 0 || handle >= (int)m_programUniforms.size() )
 		return false;
 
-	if ( requestedUniform->m_glslType != GLSL_SAMPLER2D )
+	ShaderProgramUniform& requestedUniform = m_programUniforms[ handle ];
+	if ( requestedUniform.m_glslType != GLSL_SAMPLER2D )
 		return false;
 
-	requestedUniform->m_textureID = newTextureID;
+	if ( requestedUniform.m_textureID != newTextureID )
+		OnUniformChanging( handle );
+	requestedUniform.m_textureID = newTextureID;
 
 	return true;
 }
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::SetTexture( const std::string& uniformNameVerbatim, unsigned int newTextureID ) //Also used for setting a sampler value.
+{
+	return SetTexture( GetUniformHandle( uniformNameVerbatim ), newTextureID );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int ShaderProgram::GetTexture( const std::string& uniformNameVerbatim )
+{
+	const ShaderProgramUniform* requestedUniform = FindUniform( uniformNameVerbatim );
+	if ( requestedUniform == nullptr || requestedUniform->m_glslType != GLSL_SAMPLER2D )
+		return ShaderProgramUniform::UNSET;
+
+	return requestedUniform->m_textureID;
+}
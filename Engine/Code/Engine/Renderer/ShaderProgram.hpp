@@ -11,8 +11,10 @@
 
 //--------------------------------------------------------------------------------------------------------------
 class VertexDefinition;
+class Matrix44;
 struct Rgba;
 class Sampler;
+class TransientGeometryBuffer;
 class Texture;
 
 
@@ -48,15 +50,38 @@ struct ShaderProgramInputAttribute
 struct ShaderProgramUniform
 {
 	const char* m_uniformNameVerbatim;
-	unsigned int m_uniformLocation;
+	size_t m_uniformNameHash; //Hashed once in RecordUniforms, so lookups compare names only on a hash match.
+	int m_uniformLocation; //From glGetUniformLocation, NOT the active uniform index.
 	ShaderVariableType m_glslType; //e.g. to tell to use glUniformf, 1f, fv, iv, etc. esp. if it's a sampler2D or not.
 	unsigned int m_textureID; //Zero == not a sampler2D variable. Lowest texture ID == 1 == TheRenderer::m_defaultTexture.
 	unsigned int m_samplerID; //Zero == not a sampler2D variable. Lowest sampler ID == 1 == TheRenderer::m_defaultSampler.
 	unsigned int m_count; // "For arrays, this is the length of the array. For non-arrays, this is 1." NOT e.g. 4 for vec4.
+	unsigned int m_valueOffset; //Into ShaderProgram::m_uniformValues, the CPU-side copy of what the program holds.
+	unsigned int m_valueSize; //In bytes, for all m_count elements.
+	bool m_shouldTranspose; //Only for GLSL_MAT4.
+	bool m_isDirty; //Shadow copy changed since the last upload, which waits for the next Material::Bind.
 	static const unsigned int UNSET = 0;
 };
 
 
+//--------------------------------------------------------------------------------------------------------------
+typedef int UniformHandle; //Index into a ShaderProgram's uniforms, only valid for the program that returned it.
+static const UniformHandle INVALID_UNIFORM_HANDLE = -1;
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct UniformCacheStats
+{
+	UniformCacheStats() { Clear(); }
+	void Clear() { m_numSetCalls = m_numRedundantSets = m_numUploads = 0; }
+	unsigned int GetNumGLCallsAvoided() const;
+
+	unsigned int m_numSetCalls; //Set* calls that found their uniform.
+	unsigned int m_numRedundantSets; //Of those, ones matching the shadow copy, so nothing was marked dirty.
+	unsigned int m_numUploads; //glUniform* calls made by UploadDirtyUniforms.
+};
+
+
 //--------------------------------------------------------------------------------------------------------------
 class ShaderProgram;
 typedef std::pair< std::string, ShaderProgram* > ShaderProgramRegistryPair;
@@ -73,13 +98,15 @@ public:
 	static const ShaderProgramRegistryMap* GetRegistry() { return &s_shaderProgramRegistry; }
 	static const char* GetDefaultShaderNameForVertexDefinition( const VertexDefinition* vdefn );
 	static void DeleteShaderPrograms();
+	static void EndFrame(); //Rolls over the uniform cache stats.
+	static const UniformCacheStats& GetLastFrameUniformStats() { return s_lastFrameUniformStats; }
 
 //	void RecordInputAttributes(); //Handled by Material::BindInputAttribute() as called by MeshRenderer::SetMaterial() as it needs the MR's VAO ID.
 	void RecordUniforms();
 
 	~ShaderProgram();
 
-	unsigned int BindInputAttribute( const std::string& attributeNameVerbatim, unsigned int count, VertexFieldType fieldType, bool normalize, int strideInBytes, int offsetInBytes );
+	unsigned int BindInputAttribute( const std::string& attributeNameVerbatim, unsigned int count, VertexFieldType fieldType, bool normalize, int strideInBytes, int offsetInBytes, unsigned int instanceDivisor = 0 ); //Divisor 0 is per-vertex, 1 per-instance.
 	void AddInputAttribute( const std::string& attributeNameVerbatim, unsigned int attributeLocation, ShaderVariableType glslType );
 
 	unsigned int GetShaderProgramID() const { return m_shaderProgramID; }
@@ -87,17 +114,37 @@ public:
 
 	void BindProgram();
 	void BindTextures();
+	void UploadDirtyUniforms(); //Program must be bound, see Material::Bind.
 	static void UnbindAnyPrograms();
 	ShaderProgramUniform* FindUniform( const std::string& uniformNameVerbatim );
+	UniformHandle GetUniformHandle( const std::string& uniformNameVerbatim ) const; //INVALID_UNIFORM_HANDLE if absent or optimized out.
+
+	//Setters only write the CPU-side copy, the GL upload is deferred to the next Material::Bind and skipped if nothing changed.
+	bool SetInt( UniformHandle handle, const int* newValue, unsigned int arraySize = 1 );
+	bool SetFloat( UniformHandle handle, const float* newValue, unsigned int arraySize = 1 );
+	bool SetVector2( UniformHandle handle, const Vector2f* newValue, unsigned int arraySize = 1 );
+	bool SetVector3( UniformHandle handle, const Vector3f* newValue, unsigned int arraySize = 1 );
+	bool SetVector4( UniformHandle handle, const Vector4f* newValue, unsigned int arraySize = 1 );
+	bool SetMatrix4x4( UniformHandle handle, bool shouldTranspose, const Matrix4x4f* newValue, unsigned int arraySize = 1 );
+	bool SetMatrix4x4( UniformHandle handle, bool shouldTranspose, const Matrix44* newValue, unsigned int arraySize = 1 ); //Arrays upload as-is, no repacking.
+	bool SetColor( UniformHandle handle, const Rgba* newValue, unsigned int arraySize = 1 );
+	bool SetTexture( UniformHandle handle, unsigned int newTextureID );
 	bool SetInt( const std::string& uniformNameVerbatim, const int* newValue, unsigned int arraySize = 1 );
 	bool SetFloat( const std::string& uniformNameVerbatim, const float* newValue, unsigned int arraySize = 1 );
 	bool SetVector2( const std::string& uniformNameVerbatim, const Vector2f* newValue, unsigned int arraySize = 1 );
 	bool SetVector3( const std::string& uniformNameVerbatim, const Vector3f* newValue, unsigned int arraySize = 1 );
 	bool SetVector4( const std::string& uniformNameVerbatim, const Vector4f* newValue, unsigned int arraySize = 1 );
 	bool SetMatrix4x4( const std::string& uniformNameVerbatim, bool shouldTranspose, const Matrix4x4f* newValue, unsigned int arraySize = 1 );
+	bool SetMatrix4x4( const std::string& uniformNameVerbatim, bool shouldTranspose, const Matrix44* newValue, unsigned int arraySize = 1 );
 	bool SetColor( const std::string& uniformNameVerbatim, const Rgba* newValue, unsigned int arraySize = 1 );
 	bool SetSampler( const std::string& uniformNameVerbatim, unsigned int newSamplerID );
 	bool SetTexture( const std::string& uniformNameVerbatim, unsigned int newTextureID );
+	unsigned int GetTexture( const std::string& uniformNameVerbatim ); //ShaderProgramUniform::UNSET if not a sampler2D uniform.
+
+	//A TransientGeometryBuffer's staged batch only reads this program's uniforms when it flushes, so it registers here to be told before
+	//any of them actually changes. One at a time: registering flushes whoever was registered before.
+	void SetPendingTransientBatch( TransientGeometryBuffer* batchOwner );
+	void ClearPendingTransientBatch( TransientGeometryBuffer* batchOwner ) { if ( m_pendingTransientBatch == batchOwner ) m_pendingTransientBatch = nullptr; }
 
 
 private:
@@ -111,12 +158,22 @@ private:
 				   Shader* fragmentShader, 
 				   const VertexDefinition& vertexDefinition );
 	static ShaderProgramRegistryMap s_shaderProgramRegistry;
+	static UniformCacheStats s_currentFrameUniformStats;
+	static UniformCacheStats s_lastFrameUniformStats;
+
+	static unsigned int GetUniformElementSize( ShaderVariableType glslType );
+	bool SetUniformValue( UniformHandle handle, ShaderVariableType expectedType, const void* newValue, unsigned int arraySize, bool shouldTranspose = false );
+	void OnUniformChanging( UniformHandle handle );
 
 	const std::string m_shaderProgramName;
 	unsigned int m_shaderProgramID;
 	const VertexDefinition* m_vertexDefinition; //For use in accessing attribute data in the shader program.
 	std::set<ShaderProgramInputAttribute> m_programInputAttributes;
 	std::vector<ShaderProgramUniform> m_programUniforms;
+	std::vector<unsigned char> m_uniformValues; //Shadow copy of every uniform's value, see ShaderProgramUniform::m_valueOffset.
+	std::vector<float> m_matrixScratch; //SetMatrix4x4( Matrix4x4f* ) repacking, kept per program so it only grows once.
+	std::vector<Vector4f> m_colorScratch; //SetColor's Rgba -> float conversion, likewise.
+	TransientGeometryBuffer* m_pendingTransientBatch;
 	
 	unsigned int m_vertexShaderID;
 	unsigned int m_fragmentShaderID;
@@ -1,4 +1,5 @@
 #include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Math/Matrix44.hpp"
 #include "Engine/FileUtils/Writers/FileBinaryWriter.hpp"
 #include "Engine/FileUtils/Readers/FileBinaryReader.hpp"
 #include "Game/GameCommon.hpp"
@@ -32,6 +33,26 @@ void Skeleton::GetBoneMatrices( Matrix4x4f* out_matrices, unsigned int numMatric
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void Skeleton::GetBoneMatrices( Matrix44* out_matrices, unsigned int numMatrices )
+{
+	const unsigned int jointCount = GetNumJoints();
+	ASSERT_OR_DIE( numMatrices >= jointCount, "Skeleton::GetBoneMatrices() - Not enough room in out_matrices!" );
+
+	for ( unsigned int jointIndex = 0; jointIndex < jointCount; jointIndex++ )
+	{
+		const Matrix4x4f& modelToInitialBoneMatrix = m_unchangingGlobalJointModelToBoneSpaceTransforms[ jointIndex ];
+		const Matrix4x4f& currentModelMatrix = m_globalJointBoneToModelSpaceTransforms[ jointIndex ];
+
+		//Matrix4x4f's operator* composes COLUMN_MAJOR operands in the reverse order, so match whichever it did.
+		if ( modelToInitialBoneMatrix.GetOrdering() == ROW_MAJOR )
+			out_matrices[ jointIndex ] = Matrix44( modelToInitialBoneMatrix ) * Matrix44( currentModelMatrix );
+		else
+			out_matrices[ jointIndex ] = Matrix44( currentModelMatrix ) * Matrix44( modelToInitialBoneMatrix );
+	}
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 int Skeleton::GetLastAddedJointIndex() const
 {
@@ -341,7 +362,7 @@ void Skeleton::RecursivelyDrawBones( SkeletonJoint* currentJoint, const Rgba& bo
 		Vector3f childPosition;
 		m_globalJointBoneToModelSpaceTransforms[ childJoint->m_parallelArraysIndex ].GetTranslation( childPosition );
 
-		AddDebugRenderCommand( new DebugRenderCommandLine( parentPosition, childPosition, 0.f, DEPTH_TEST_DUAL, boneColor, boneThickness ) );
+		AddDebugRenderLine( parentPosition, childPosition, 0.f, DEPTH_TEST_DUAL, boneColor, boneThickness );
 
 		RecursivelyDrawBones( childJoint, boneColor, boneThickness * .1f ); //Down a tenth in width each time.
 	}
@@ -357,12 +378,12 @@ void Skeleton::VisualizeSkeleton( const Rgba& boneColor /*= Rgba::CYAN*/, float
 	AABB3f rootBounds;
 	rootBounds.mins = position + Vector3f::ONE * .01f;
 	rootBounds.maxs = position - Vector3f::ONE * .01f;
-	AddDebugRenderCommand( new DebugRenderCommandAABB3( rootBounds, true, 0.f, DEPTH_TEST_DUAL, 1.f, jointColor, jointColor *  Rgba::GRAY ) );
+	AddDebugRenderAABB3( rootBounds, true, 0.f, DEPTH_TEST_DUAL, 1.f, jointColor, jointColor *  Rgba::GRAY );
 
 	for ( std::vector<SkeletonJoint*>::iterator it = m_joints.begin() + 1; it != m_joints.end(); ++it )
 	{
 		m_globalJointBoneToModelSpaceTransforms[ ( *it )->m_parallelArraysIndex ].GetTranslation( position );
-		AddDebugRenderCommand( new DebugRenderCommandPoint( position, 0.f, DEPTH_TEST_DUAL, jointColor, 1.f, jointSizeScalar ) );
+		AddDebugRenderPoint( position, 0.f, DEPTH_TEST_DUAL, jointColor, 1.f, jointSizeScalar );
 	}
 	RecursivelyDrawBones( m_hierarchyRoot, boneColor, boneThickness );
 }
\ No newline at end of file
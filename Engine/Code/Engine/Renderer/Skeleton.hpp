@@ -18,6 +18,7 @@ extern Skeleton* g_lastLoadedSkeleton; //Used for saving out skeletons.
 
 //-----------------------------------------------------------------------------
 class BinaryWriter;
+class Matrix44;
 class BinaryReader;
 
 
@@ -46,6 +47,7 @@ public:
 	//Therefore, whatever index you use to access these arrays == the index identifying the current joint.
 
 	void GetBoneMatrices( Matrix4x4f* out_matrices, unsigned int numMatrices );
+	void GetBoneMatrices( Matrix44* out_matrices, unsigned int numMatrices ); //Same transforms, as one tightly packed array for ShaderProgram::SetMatrix4x4.
 	int GetNumJoints() const { return m_joints.size(); }
 	int GetLastAddedJointIndex() const;
 	int GetJointIndexForName( const std::string& name ) const;
@@ -2,10 +2,56 @@
 #include "Engine/Renderer/ResourceDatabase.hpp"
 #include "Engine/Renderer/SpriteRenderer.hpp"
 #include "Engine/Math/MatrixStack.hpp"
+#include "Engine/Memory/PageAllocator.hpp"
+#include "Engine/Concurrency/CriticalSection.hpp"
 
 
 //--------------------------------------------------------------------------------------------------------------
 STATIC int Sprite::s_BASE_SPRITE_ID = 1;
+static const size_t SPRITE_INSTANCE_POOL_SIZE = 4096; //Covers a heavy bullet wave plus UI/backgrounds.
+static CriticalSection s_spriteInstancePoolLock; //Enemy::Update fires patterns from job threads.
+
+
+//--------------------------------------------------------------------------------------------------------------
+static PageAllocator& GetSpriteInstancePool()
+{
+	static PageAllocator s_spriteInstancePool( sizeof( Sprite ), SPRITE_INSTANCE_POOL_SIZE ); //Function-local so it exists before any static Sprite.
+	return s_spriteInstancePool;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void* Sprite::operator new( size_t numBytes )
+{
+	if ( numBytes == sizeof( Sprite ) )
+	{
+		s_spriteInstancePoolLock.Lock();
+		void* page = GetSpriteInstancePool().Allocate();
+		s_spriteInstancePoolLock.Unlock();
+
+		if ( page != nullptr )
+			return page;
+	}
+
+	return ::operator new( numBytes );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void Sprite::operator delete( void* ptr )
+{
+	if ( ptr == nullptr )
+		return;
+
+	PageAllocator& pool = GetSpriteInstancePool();
+	if ( pool.Owns( ptr ) )
+	{
+		s_spriteInstancePoolLock.Lock();
+		pool.Free( ptr );
+		s_spriteInstancePoolLock.Unlock();
+	}
+	else ::operator delete( ptr );
+}
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -62,6 +108,27 @@ STATIC Sprite* Sprite::Create( Sprite* other )
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void Sprite::ResetFrom( const Sprite* other )
+{
+	ASSERT_OR_DIE( !m_enabled, "Resetting a sprite that's still registered with SpriteRenderer!" );
+	ASSERT_RETURN( other );
+
+	//Mirrors Create( resourceID, worldPos, tint ), so a recycled sprite is indistinguishable from a fresh clone.
+	m_spriteResource = other->m_spriteResource;
+	m_spriteID = s_BASE_SPRITE_ID++;
+	m_layerID = 0;
+	m_overrideMaterial = nullptr;
+	m_parent = nullptr;
+	m_shown = true;
+
+	m_transform.m_position = other->m_transform.m_position;
+	m_transform.m_scale = 1.f;
+	m_transform.m_rotationAngleDegrees = 0.f;
+	m_tint = other->m_tint;
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 ResourceID Sprite::GetResourceID() const
 {
@@ -29,10 +29,15 @@ public:
 	static Sprite* Create( ResourceID resourceID, const Vector2f& worldPos );
 	static Sprite* Create( ResourceID resourceID, const Vector2f& worldPos, const Rgba& tint );
 	static Sprite* Create( Sprite* other );
+	void ResetFrom( const Sprite* other ); //Re-stamps a disabled, recycled sprite the way Create( other ) would, minus the allocation.
+
+	static void* operator new( size_t numBytes ); //Sprite-sized requests come out of a fixed instance pool, subclasses and overflow go to the heap.
+	static void operator delete( void* ptr );
 
 	virtual void Update( float deltaSeconds ) { UNREFERENCED( deltaSeconds ); } //Overridden to update animations w/o requiring a separate container for them.
 
 	ResourceID GetResourceID() const;
+	const SpriteResource* GetSpriteResource() const { return m_spriteResource; }
 	Vector2f GetPivotSpriteRelative() const;
 	float GetVirtualWidth() const { return m_virtualDimensions.x; }
 	float GetVirtualHeight() const { return m_virtualDimensions.y; }
@@ -52,6 +57,7 @@ public:
 	void SetVirtualSize( const Vector2f& newSize ) { SetVirtualSize( newSize.x, newSize.y ); }
 	void SetVirtualSize( float unitX, float unitY );
 	void SetLayerID( RenderLayerID newLayerID, const char* newName = nullptr );
+	Sprite* GetParent() const { return m_parent; }
 	void SetParent( Sprite* newParent ) { m_parent = newParent; }
 	void SetMaterial( Material* newMat ) { m_overrideMaterial = newMat; }
 
@@ -65,9 +71,9 @@ public:
 
 
 protected:
-	Sprite() : m_parent( nullptr ), m_spriteResource( nullptr ), m_overrideMaterial( nullptr ), m_enabled( false ) {}
+	Sprite() : m_parent( nullptr ), m_spriteResource( nullptr ), m_overrideMaterial( nullptr ), m_enabled( false ), m_shown( true ), m_indexInLayer( NOT_IN_LAYER ), m_drawOrderInLayer( 0 ) {}
 	bool m_enabled; //.active in Unity, doesn't render when false.
-	bool m_shown; //for visibility culling, even when enabled.
+	bool m_shown; //Hides it while enabled. Culling no longer toggles this, it only keeps culled sprites off their layer's visible list.
 	Sprite* m_parent;
 	RenderLayerID m_layerID;
 	int m_spriteID; //Copy SD4 style.
@@ -78,4 +84,11 @@ protected:
 	Material* m_overrideMaterial;
 
 	static int s_BASE_SPRITE_ID;
+
+
+private:
+	friend struct RenderLayer; //Only the layer holding the sprite sets these.
+	static const unsigned int NOT_IN_LAYER = 0xFFFFFFFF;
+	unsigned int m_indexInLayer; //Into its RenderLayer's m_sprites, for O(1) removal.
+	unsigned int m_drawOrderInLayer;
 };
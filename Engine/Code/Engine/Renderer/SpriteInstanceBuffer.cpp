@@ -0,0 +1,247 @@
+#include "Engine/Renderer/SpriteInstanceBuffer.hpp"
+
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <gl/gl.h>
+#include "Engine/Renderer/OpenGLExtensions.hpp"
+#include "Engine/Renderer/RenderStateCache.hpp"
+#include "Engine/Renderer/Material.hpp"
+#include "Engine/Renderer/VertexDefinition.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Error/ErrorWarningAssert.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const char* DIFFUSE_TEXTURE_UNIFORM_NAME = "uTexDiffuse";
+static const char* UNIT_QUAD_CORNER_ATTRIBUTE_NAME = "inCorner";
+static const unsigned int NUM_UNIT_QUAD_INDICES = 6;
+
+
+//--------------------------------------------------------------------------------------------------------------
+SpriteInstanceBuffer::SpriteInstanceBuffer( unsigned int instanceBytesPerFrame )
+	: m_quadVboID( NULL )
+	, m_quadIboID( NULL )
+	, m_instanceVboID( NULL )
+	, m_currentSegment( 0 )
+	, m_instanceHead( 0 )
+{
+	//Segment starts must land on whole instances, else the attribute offsets in BindInstanceAttributes straddle two.
+	m_maxInstancesPerSegment = instanceBytesPerFrame / sizeof( SpriteInstance );
+	m_instanceSegmentSize = m_maxInstancesPerSegment * sizeof( SpriteInstance );
+	ASSERT_OR_DIE( m_maxInstancesPerSegment > 0, "SpriteInstanceBuffer needs room for at least one instance a frame!" );
+
+	for ( unsigned int segmentIndex = 0; segmentIndex < NUM_FRAMES_IN_FLIGHT; segmentIndex++ )
+		m_segmentFences[ segmentIndex ] = nullptr;
+
+	m_stagedKey.m_material = nullptr;
+	m_stagedKey.m_diffuseTextureID = 0;
+
+	//Same winding and corner order as SpriteRenderer::WriteSpriteQuad, in [0,1] so the shader can scale it by each instance's size.
+	const Vector2f quadCorners[] =
+	{
+		Vector2f( 0.f, 1.f ), //Top-left.		//0
+		Vector2f( 1.f, 0.f ), //Bottom-right.	//1
+		Vector2f( 0.f, 0.f ), //Bottom-left.	//2
+		Vector2f( 1.f, 1.f )  //Top-right.		//3
+	};
+	const unsigned int quadIndices[ NUM_UNIT_QUAD_INDICES ] = { 2, 1, 0, 0, 1, 3 };
+
+	glGenBuffers( 1, &m_quadVboID );
+	glGenBuffers( 1, &m_quadIboID );
+	glGenBuffers( 1, &m_instanceVboID );
+	ASSERT_OR_DIE( m_quadVboID != NULL && m_quadIboID != NULL && m_instanceVboID != NULL, "glGenBuffers failed in SpriteInstanceBuffer()" );
+
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, m_quadVboID );
+	glBufferData( GL_ARRAY_BUFFER, sizeof( quadCorners ), quadCorners, GL_STATIC_DRAW );
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, m_quadIboID ); //Not GL_ELEMENT_ARRAY_BUFFER, that would rebind whatever VAO is current.
+	glBufferData( GL_ARRAY_BUFFER, sizeof( quadIndices ), quadIndices, GL_STATIC_DRAW );
+
+	Orphan(); //Allocates the instance storage, nothing to orphan yet.
+	m_currentFrameStats.m_numOrphans = 0;
+
+	m_stagedInstances.reserve( m_maxInstancesPerSegment );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+SpriteInstanceBuffer::~SpriteInstanceBuffer()
+{
+	for ( unsigned int segmentIndex = 0; segmentIndex < NUM_FRAMES_IN_FLIGHT; segmentIndex++ )
+		if ( m_segmentFences[ segmentIndex ] != nullptr )
+			glDeleteSync( (GLsync)m_segmentFences[ segmentIndex ] );
+
+	for ( auto& vaoPair : m_vaoIDsPerMaterial )
+	{
+		glDeleteVertexArrays( 1, &vaoPair.second );
+		RenderStateCache::OnVertexArrayDeleted( vaoPair.second );
+	}
+
+	glDeleteBuffers( 1, &m_quadVboID );
+	glDeleteBuffers( 1, &m_quadIboID );
+	glDeleteBuffers( 1, &m_instanceVboID );
+	RenderStateCache::OnBufferDeleted( m_quadVboID );
+	RenderStateCache::OnBufferDeleted( m_quadIboID );
+	RenderStateCache::OnBufferDeleted( m_instanceVboID );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteInstanceBuffer::Draw( const SpriteInstanceDrawKey& key, const SpriteInstance* instances, unsigned int numInstances )
+{
+	++m_currentFrameStats.m_numDrawsSubmitted;
+
+	if ( numInstances > m_maxInstancesPerSegment )
+		++m_currentFrameStats.m_numSplitDraws;
+
+	//Instances are independent of one another, so an oversized draw just goes out a segment's worth at a time.
+	while ( numInstances > 0 )
+	{
+		bool fitsInBatch = ( m_stagedInstances.size() + numInstances <= m_maxInstancesPerSegment );
+		if ( !fitsInBatch || ( key != m_stagedKey ) )
+			Flush();
+
+		m_stagedKey = key;
+
+		unsigned int numInstancesStaged = GetMin( numInstances, m_maxInstancesPerSegment - (unsigned int)m_stagedInstances.size() );
+		m_stagedInstances.insert( m_stagedInstances.end(), instances, instances + numInstancesStaged );
+
+		instances += numInstancesStaged;
+		numInstances -= numInstancesStaged;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteInstanceBuffer::Flush()
+{
+	if ( m_stagedInstances.empty() )
+		return;
+
+	unsigned int numInstances = m_stagedInstances.size();
+	unsigned int numInstanceBytes = numInstances * sizeof( SpriteInstance );
+	if ( m_instanceHead + numInstanceBytes > m_instanceSegmentSize )
+	{
+		Orphan(); //This frame outgrew its segment, so start over in fresh storage rather than overwrite one still in flight.
+		m_instanceHead = 0;
+	}
+
+	unsigned int instanceOffset = ( m_currentSegment * m_instanceSegmentSize ) + m_instanceHead;
+
+	//Unsynchronized is safe: the segment's fence passed, or the storage was just orphaned.
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, m_instanceVboID );
+	void* mappedInstances = glMapBufferRange( GL_ARRAY_BUFFER, instanceOffset, numInstanceBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT );
+	if ( mappedInstances != nullptr )
+	{
+		memcpy( mappedInstances, m_stagedInstances.data(), numInstanceBytes );
+		glUnmapBuffer( GL_ARRAY_BUFFER );
+	}
+	else glBufferSubData( GL_ARRAY_BUFFER, instanceOffset, numInstanceBytes, m_stagedInstances.data() );
+
+	//As in TransientGeometryBuffer::Flush, leave the material's texture as the caller last set it.
+	Material* material = m_stagedKey.m_material;
+	unsigned int liveTextureID = material->GetTexture( DIFFUSE_TEXTURE_UNIFORM_NAME );
+	material->SetTexture( DIFFUSE_TEXTURE_UNIFORM_NAME, m_stagedKey.m_diffuseTextureID );
+
+	RenderStateCache::BindVertexArray( CreateOrGetVertexArrayForMaterial( material ) );
+	BindInstanceAttributes( material, instanceOffset );
+	material->Bind();
+
+	glDrawElementsInstanced( GL_TRIANGLES, NUM_UNIT_QUAD_INDICES, GL_UNSIGNED_INT, (GLvoid*)0, numInstances );
+
+	material->SetTexture( DIFFUSE_TEXTURE_UNIFORM_NAME, liveTextureID );
+
+	m_instanceHead += numInstanceBytes;
+
+	++m_currentFrameStats.m_numDrawCallsIssued;
+	m_currentFrameStats.m_numInstancesDrawn += numInstances;
+	m_currentFrameStats.m_numBytesUploaded += numInstanceBytes;
+
+	m_stagedInstances.clear();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteInstanceBuffer::EndFrame()
+{
+	Flush();
+
+	m_segmentFences[ m_currentSegment ] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+
+	m_currentSegment = ( m_currentSegment + 1 ) % NUM_FRAMES_IN_FLIGHT;
+	m_instanceHead = 0;
+
+	m_lastFrameStats = m_currentFrameStats;
+	m_currentFrameStats.Clear();
+
+	GLsync nextSegmentFence = (GLsync)m_segmentFences[ m_currentSegment ];
+	if ( nextSegmentFence == nullptr )
+		return;
+
+	GLenum fenceStatus = glClientWaitSync( nextSegmentFence, 0, 0 ); //Zero timeout: only polling, never stalling.
+	if ( ( fenceStatus == GL_ALREADY_SIGNALED ) || ( fenceStatus == GL_CONDITION_SATISFIED ) )
+	{
+		glDeleteSync( nextSegmentFence );
+		m_segmentFences[ m_currentSegment ] = nullptr;
+		return;
+	}
+
+	++m_currentFrameStats.m_numFenceMisses;
+	Orphan();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteInstanceBuffer::Orphan()
+{
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, m_instanceVboID );
+	glBufferData( GL_ARRAY_BUFFER, m_instanceSegmentSize * NUM_FRAMES_IN_FLIGHT, nullptr, GL_STREAM_DRAW );
+
+	for ( unsigned int segmentIndex = 0; segmentIndex < NUM_FRAMES_IN_FLIGHT; segmentIndex++ )
+	{
+		if ( m_segmentFences[ segmentIndex ] == nullptr )
+			continue;
+
+		glDeleteSync( (GLsync)m_segmentFences[ segmentIndex ] );
+		m_segmentFences[ segmentIndex ] = nullptr;
+	}
+
+	++m_currentFrameStats.m_numOrphans;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int SpriteInstanceBuffer::CreateOrGetVertexArrayForMaterial( Material* material )
+{
+	auto found = m_vaoIDsPerMaterial.find( material );
+	if ( found != m_vaoIDsPerMaterial.end() )
+		return found->second;
+
+	unsigned int vaoID;
+	glGenVertexArrays( 1, &vaoID );
+	ASSERT_OR_DIE( vaoID != NULL, "glGenVertexArrays failed in SpriteInstanceBuffer::CreateOrGetVertexArrayForMaterial()" );
+
+	//Only the unit quad's attribute is set up once here, the instance ones move every Flush().
+	RenderStateCache::BindVertexArray( vaoID );
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, m_quadVboID );
+	RenderStateCache::BindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_quadIboID );
+	material->BindInputAttribute( UNIT_QUAD_CORNER_ATTRIBUTE_NAME, 2, VERTEX_FIELD_TYPE_FLOAT, false, sizeof( Vector2f ), 0 );
+
+	m_vaoIDsPerMaterial[ material ] = vaoID;
+	return vaoID;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteInstanceBuffer::BindInstanceAttributes( Material* material, unsigned int firstInstanceByte )
+{
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, m_instanceVboID );
+
+	const VertexDefinition& instanceDefinition = SpriteInstance::DEFINITION;
+	for ( unsigned int attributeIndex = 0; attributeIndex < instanceDefinition.GetNumAttributes(); attributeIndex++ )
+	{
+		const VertexAttribute* attr = instanceDefinition.GetAttributeAtIndex( attributeIndex );
+		material->BindInputAttribute( attr->m_attributeName, attr->m_count, attr->m_fieldType, attr->m_normalized,
+									  instanceDefinition.GetVertexSize(), firstInstanceByte + attr->m_offset, 1 );
+	}
+}
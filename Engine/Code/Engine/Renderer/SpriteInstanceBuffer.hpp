@@ -0,0 +1,83 @@
+#pragma once
+
+
+#include <map>
+#include <vector>
+#include "Engine/EngineCommon.hpp"
+#include "Engine/Renderer/Vertexes.hpp"
+
+
+//-----------------------------------------------------------------------------
+class Material;
+
+
+//-----------------------------------------------------------------------------
+struct SpriteInstanceDrawKey //Everything that has to match for two instanced draws to share one glDrawElementsInstanced call.
+{
+	Material* m_material;
+	unsigned int m_diffuseTextureID;
+
+	bool operator==( const SpriteInstanceDrawKey& other ) const { return ( m_material == other.m_material ) && ( m_diffuseTextureID == other.m_diffuseTextureID ); }
+	bool operator!=( const SpriteInstanceDrawKey& other ) const { return !( *this == other ); }
+};
+
+
+//-----------------------------------------------------------------------------
+struct SpriteInstanceStats
+{
+	SpriteInstanceStats() { Clear(); }
+	void Clear() { m_numDrawsSubmitted = m_numDrawCallsIssued = m_numInstancesDrawn = m_numSplitDraws = m_numOrphans = m_numFenceMisses = m_numBytesUploaded = 0; }
+
+	unsigned int m_numDrawsSubmitted; //Calls into Draw().
+	unsigned int m_numDrawCallsIssued; //glDrawElementsInstanced calls after merging.
+	unsigned int m_numInstancesDrawn;
+	unsigned int m_numSplitDraws; //Too big for a frame's segment, so split into several.
+	unsigned int m_numOrphans;
+	unsigned int m_numFenceMisses;
+	unsigned int m_numBytesUploaded; //sizeof( SpriteInstance ) a sprite, versus 4 Vertex2D_PCTs and 6 indices on the transient path.
+};
+
+
+//-----------------------------------------------------------------------------
+//Draws quads as one static unit quad plus a SpriteInstance each, expanded by the vertex shader, so the CPU writes and uploads
+//one small struct a sprite instead of a quad's vertices and indices. Materials drawn through here need an instancing shader, e.g. SpriteRenderer's InstancedSprite.
+//The instance stream is ringed and fenced a segment per frame in flight, orphaning rather than stalling, as in TransientGeometryBuffer,
+//and consecutive draws with equal SpriteInstanceDrawKeys are likewise staged and merged into one draw call.
+class SpriteInstanceBuffer
+{
+public:
+	SpriteInstanceBuffer( unsigned int instanceBytesPerFrame );
+	~SpriteInstanceBuffer();
+
+	void Draw( const SpriteInstanceDrawKey& key, const SpriteInstance* instances, unsigned int numInstances ); //Split into segment-sized draws if need be.
+	void Flush(); //Issues the staged batch. Call before any state the batch's draw depends on changes.
+	void EndFrame(); //Flushes, fences this frame's segment, and moves on to the next.
+
+	const SpriteInstanceStats& GetLastFrameStats() const { return m_lastFrameStats; }
+	unsigned int GetMaxInstancesPerDraw() const { return m_maxInstancesPerSegment; }
+
+
+private:
+	static const unsigned int NUM_FRAMES_IN_FLIGHT = 3;
+
+	unsigned int CreateOrGetVertexArrayForMaterial( Material* material );
+	void BindInstanceAttributes( Material* material, unsigned int firstInstanceByte ); //No base instance in GL 4.1, so the pointers move instead.
+	void Orphan();
+
+	unsigned int m_quadVboID; //Static, never rewritten.
+	unsigned int m_quadIboID;
+	unsigned int m_instanceVboID;
+	unsigned int m_instanceSegmentSize;
+	unsigned int m_maxInstancesPerSegment;
+	std::map< Material*, unsigned int > m_vaoIDsPerMaterial;
+
+	unsigned int m_currentSegment;
+	unsigned int m_instanceHead; //Byte offset within the current segment.
+	void* m_segmentFences[ NUM_FRAMES_IN_FLIGHT ]; //GLsync.
+
+	SpriteInstanceDrawKey m_stagedKey;
+	std::vector< SpriteInstance > m_stagedInstances;
+
+	SpriteInstanceStats m_currentFrameStats;
+	SpriteInstanceStats m_lastFrameStats;
+};
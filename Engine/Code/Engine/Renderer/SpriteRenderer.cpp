@@ -9,6 +9,8 @@
 #include "Engine/Renderer/Sprite.hpp"
 #include "Engine/Renderer/Mesh.hpp"
 #include "Engine/Renderer/Texture.hpp"
+#include "Engine/Renderer/AsyncTextureLoader.hpp"
+#include "Engine/Renderer/TextureAtlas.hpp"
 #include "Engine/EngineCommon.hpp"
 #include "Engine/Math/Matrix4x4.hpp"
 #include "Engine/Math/MathUtils.hpp"
@@ -17,11 +19,15 @@
 #include "Engine/Renderer/FrameBufferEffect.hpp"
 #include "Engine/Renderer/RiftUtils.hpp"
 #include "Engine/Renderer/Particles/ParticleSystem.hpp"
+#include "Engine/Renderer/RenderQueue.hpp"
+#include "Engine/Concurrency/JobUtils.hpp"
+#include "Engine/Tools/Profiling/Profiler.hpp"
 
 
 //--------------------------------------------------------------------------------------------------------------
 STATIC SpriteLayerRegistryMap SpriteRenderer::s_spriteLayers = SpriteLayerRegistryMap();
 STATIC Material* SpriteRenderer::s_defaultSpriteMaterial = nullptr;
+STATIC Material* SpriteRenderer::s_instancedSpriteMaterial = nullptr;
 STATIC std::shared_ptr<Mesh> SpriteRenderer::s_spriteMesh = nullptr;
 STATIC MeshRenderer* SpriteRenderer::s_spriteMeshRenderer = nullptr;
 STATIC const RenderState SpriteRenderer::s_defaultSpriteRenderState = RenderState( CULL_MODE_NONE/*FOR_VR*/, BLEND_MODE_SOURCE_ALPHA, BLEND_MODE_ONE_MINUS_SOURCE_ALPHA, DEPTH_COMPARE_MODE_LESS, false );
@@ -33,6 +39,9 @@ STATIC bool SpriteRenderer::s_isParentingEnabled = false;
 STATIC unsigned int SpriteRenderer::s_numSpritesCulled = 0;
 STATIC FrameBuffer* SpriteRenderer::s_currentRenderTarget = nullptr;
 STATIC FrameBuffer* SpriteRenderer::s_effectRenderTarget = nullptr;
+STATIC std::vector<RenderUniformBlock> SpriteRenderer::s_layerUniformBlocks;
+STATIC bool SpriteRenderer::s_isRenderQueueEnabled = true;
+STATIC bool SpriteRenderer::s_isInstancingEnabled = true;
 
 STATIC float SpriteRenderer::s_aspectRatio;
 STATIC float SpriteRenderer::s_defaultImportSize;
@@ -41,6 +50,18 @@ STATIC Vector2f SpriteRenderer::s_defaultVirtualSize;
 STATIC const Camera2D* SpriteRenderer::s_activeCamera;
 
 
+//--------------------------------------------------------------------------------------------------------------
+static const unsigned int SPRITE_ORDER_IN_LAYER = 0;
+static const unsigned int PARTICLE_ORDER_IN_LAYER = 1; //Particle systems render last in layer, over its sprites.
+static const unsigned int MIN_SPRITES_PER_RECORDING_JOB = 256; //Below this a job costs more than it saves.
+static const unsigned int MAX_SPRITE_RECORDING_JOBS = 16; //JobSystem's pool is small and shared.
+static const unsigned int MAX_INSTANCES_PER_SPRITE_PACKET = 4096; //Well under a frame's SpriteInstanceBuffer segment.
+static const float MAX_INSTANCE_TEX_COORD = 65535.f; //SpriteInstance::m_uvRect is normalized unsigned shorts.
+static const char* SPRITE_ATLAS_IMAGE_DIRECTORIES[] = { "Data/Images/Sprites", "Data/Images/Particles" };
+static const char* INSTANCED_SPRITE_VERTEX_SHADER_PATH = "Data/Shaders/Sprites/instancedSprite.vert";
+static const char* INSTANCED_SPRITE_FRAGMENT_SHADER_PATH = "Data/Shaders/Sprites/instancedSprite.frag";
+
+
 //--------------------------------------------------------------------------------------------------------------
 static const char* defaultVertexShaderSource = "\
 #version 410 core\n\
@@ -153,7 +174,8 @@ void SpriteRenderer::PrintLayers( Command& )
 	{
 		const RenderLayer* layer = layerIter->second;
 		const char* enabledStr = ( layer->m_enabled ? "True" : "False" );
-		g_theConsole->Printf( "ID: %d  Enabled: %s    Name: %s", layer->m_layerID, enabledStr, layer->m_name.c_str() );
+		g_theConsole->Printf( "ID: %d  Enabled: %s    Name: %s    Sprites: %u (%u visible)    Culling tree height: %d", layer->m_layerID, enabledStr, layer->m_name.c_str(),
+							  layer->m_sprites.size(), layer->GetNumVisibleSprites(), layer->GetSpriteTree().GetHeight() );
 	}
 }
 
@@ -205,6 +227,9 @@ static void RegisterConsoleCommands()
 	g_theConsole->RegisterCommand( "ToggleShowing3D", SpriteRenderer::ToggleShowing3D );
 	g_theConsole->RegisterCommand( "ToggleShowing2D", SpriteRenderer::ToggleShowing2D );
 	g_theConsole->RegisterCommand( "SpriteRendererToggleCulling", SpriteRenderer::ToggleCulling );
+	g_theConsole->RegisterCommand( "SpriteRendererToggleRenderQueue", SpriteRenderer::ToggleRenderQueue );
+	g_theConsole->RegisterCommand( "SpriteRendererToggleInstancing", SpriteRenderer::ToggleInstancing );
+	g_theConsole->RegisterCommand( "SpriteRendererAtlasStats", TextureAtlas::PrintStats );
 }
 
 
@@ -253,6 +278,11 @@ void SpriteRenderer::Startup( const Camera2D* activeCamera, const Rgba& clearCol
 	s_defaultSpriteMaterial->SetMatrix4x4( "uView", false, &Matrix4x4f::IDENTITY );
 	s_spriteMeshRenderer = new MeshRenderer( s_spriteMesh, s_defaultSpriteMaterial );
 
+	s_instancedSpriteMaterial = Material::CreateOrGetMaterial( "InstancedSprite", &s_defaultSpriteRenderState, &SpriteInstance::DEFINITION, "InstancedSprite",
+															   INSTANCED_SPRITE_VERTEX_SHADER_PATH, INSTANCED_SPRITE_FRAGMENT_SHADER_PATH );
+	s_instancedSpriteMaterial->SetSampler( "uTexDiffuse", TheRenderer::DEFAULT_SAMPLER_ID );
+	s_instancedSpriteMaterial->SetMatrix4x4( "uView", false, &Matrix4x4f::IDENTITY );
+
 	SpriteResource::Create( "Default", g_theRenderer->GetDefaultTexture()->GetFilePath().c_str() );
 }
 
@@ -260,6 +290,10 @@ void SpriteRenderer::Startup( const Camera2D* activeCamera, const Rgba& clearCol
 //--------------------------------------------------------------------------------------------------------------
 void SpriteRenderer::LoadAllSpriteResources()
 {
+	//First, so the SpriteResources made below find their images' atlas cells.
+	std::vector< std::string > atlasImageDirectories( SPRITE_ATLAS_IMAGE_DIRECTORIES, SPRITE_ATLAS_IMAGE_DIRECTORIES + _countof( SPRITE_ATLAS_IMAGE_DIRECTORIES ) );
+	TextureAtlas::LoadOrBuild( atlasImageDirectories );
+
 	ResourceDatabase::LoadAllSpriteResources();
 }
 
@@ -304,6 +338,7 @@ void SpriteRenderer::SaveAllSprites( Command& arg )
 //--------------------------------------------------------------------------------------------------------------
 void SpriteRenderer::Shutdown()
 {
+	AsyncTextureLoader::Shutdown(); //Its callbacks point into the database.
 	ResourceDatabase::Shutdown();
 
 	//Material cleaned up by its registry.
@@ -370,6 +405,12 @@ STATIC void SpriteRenderer::RenderFrame()
 
 //	g_theRenderer->BindFBO( s_currentRenderTarget );
 
+	if ( s_isRenderQueueEnabled )
+	{
+		RecordFrame();
+		return;
+	}
+
 	for ( const SpriteLayerRegistryPair& layerPair : s_spriteLayers )
 	{
 		RenderLayer* layer = layerPair.second;
@@ -384,12 +425,212 @@ void SpriteRenderer::DrawLayer( RenderLayer* layer )
 	if ( !layer->m_enabled )
 		return;
 
-	for ( Sprite* sprite : layer->m_sprites )
+	for ( Sprite* sprite : layer->GetVisibleSprites() )
 		SpriteRenderer::RenderSprite( sprite, layer->IsScrolling() );
 
 	for ( ParticleSystem* particleSystem : layer->m_particleSystems )
 		particleSystem->Render();
 
+	ApplyLayerEffects( layer );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteRenderer::RecordFrame()
+{
+	RenderQueue* renderQueue = g_theRenderer->GetRenderQueue();
+	JobSystem* jobSystem = JobSystem::Instance();
+	bool shouldUseJobs = jobSystem->IsRunning();
+
+	unsigned int numEnabledLayers = 0;
+	unsigned int numSprites = 0;
+	for ( const SpriteLayerRegistryPair& layerPair : s_spriteLayers )
+	{
+		if ( !layerPair.second->m_enabled )
+			continue;
+
+		++numEnabledLayers;
+		numSprites += layerPair.second->GetVisibleSprites().size();
+	}
+	unsigned int spritesPerJob = GetMax( MIN_SPRITES_PER_RECORDING_JOB, ( numSprites + MAX_SPRITE_RECORDING_JOBS - 1 ) / MAX_SPRITE_RECORDING_JOBS );
+
+	s_layerUniformBlocks.resize( numEnabledLayers ); //Sized before recording so packets' pointers into it hold.
+
+	//Command buffers are handed out in draw order, which keeps equal-keyed packets (i.e. painter-ordered sprites) in that order through the sort.
+	static std::vector<Job*> s_recordingJobs;
+	s_recordingJobs.clear();
+	unsigned int recorderIndex = 0;
+	unsigned int layerIndex = 0;
+	for ( const SpriteLayerRegistryPair& layerPair : s_spriteLayers )
+	{
+		RenderLayer* layer = layerPair.second;
+		if ( !layer->m_enabled )
+			continue;
+
+		RenderUniformBlock* uniforms = &s_layerUniformBlocks[ layerIndex++ ];
+		CalcLayerMatrices( layer->IsScrolling(), uniforms->m_view, uniforms->m_projection );
+
+		const std::vector<Sprite*>& visibleSprites = layer->GetVisibleSprites(); //Not rebuilt again until next Update, so jobs can read it.
+		for ( unsigned int firstSprite = 0; firstSprite < visibleSprites.size(); firstSprite += spritesPerJob )
+		{
+			unsigned int numSpritesForJob = GetMin( spritesPerJob, (unsigned int)visibleSprites.size() - firstSprite );
+			RenderCommandBuffer* commandBuffer = renderQueue->GetCommandBuffer( recorderIndex++ );
+			if ( !shouldUseJobs || ( numSprites <= MIN_SPRITES_PER_RECORDING_JOB ) )
+			{
+				RecordSprites( visibleSprites.data() + firstSprite, numSpritesForJob, layer, uniforms, commandBuffer );
+				continue;
+			}
+
+			Job* job = jobSystem->CreateJob( JOB_CATEGORY_GENERIC, RecordSpritesJob );
+			job->Write<Sprite* const*>( visibleSprites.data() + firstSprite );
+			job->Write<unsigned int>( numSpritesForJob );
+			job->Write<const RenderLayer*>( layer );
+			job->Write<const RenderUniformBlock*>( uniforms );
+			job->Write<RenderCommandBuffer*>( commandBuffer );
+			jobSystem->DispatchJob( job );
+			s_recordingJobs.push_back( job );
+		}
+
+		if ( layer->m_particleSystems.empty() )
+			continue;
+
+		RenderCommandBuffer* commandBuffer = renderQueue->GetCommandBuffer( recorderIndex++ );
+		if ( !shouldUseJobs )
+		{
+			RecordParticles( layer, uniforms, commandBuffer );
+			continue;
+		}
+
+		Job* job = jobSystem->CreateJob( JOB_CATEGORY_GENERIC, RecordParticlesJob );
+		job->Write<const RenderLayer*>( layer );
+		job->Write<const RenderUniformBlock*>( uniforms );
+		job->Write<RenderCommandBuffer*>( commandBuffer );
+		jobSystem->DispatchJob( job );
+		s_recordingJobs.push_back( job );
+	}
+
+	if ( !s_recordingJobs.empty() ) //Runs queued recorders itself, and is woken as each finishes, so costs about the slowest one.
+		jobSystem->WaitOnJobsForCompletion( s_recordingJobs );
+
+	renderQueue->Submit();
+
+	for ( const SpriteLayerRegistryPair& layerPair : s_spriteLayers )
+		if ( layerPair.second->m_enabled )
+			ApplyLayerEffects( layerPair.second );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteRenderer::RecordSprites( Sprite* const* sprites, unsigned int numSprites, const RenderLayer* layer, const RenderUniformBlock* uniforms, RenderCommandBuffer* commandBuffer )
+{
+	unsigned int spriteIndex = 0;
+	while ( spriteIndex < numSprites )
+	{
+		const Sprite* sprite = sprites[ spriteIndex ];
+		if ( !sprite->IsEnabled() || !sprite->IsVisible() )
+		{
+			++spriteIndex;
+			continue;
+		}
+
+		if ( CanDrawInstanced( sprite ) )
+		{
+			//One packet for the run of instanceable sprites sharing this texture, which stays in painter order within it.
+			unsigned int textureID = sprite->GetDiffuseTextureID();
+			unsigned int runEnd = spriteIndex + 1;
+			unsigned int numInRun = 1;
+			while ( ( runEnd < numSprites ) && ( numInRun < MAX_INSTANCES_PER_SPRITE_PACKET ) )
+			{
+				const Sprite* nextSprite = sprites[ runEnd ];
+				if ( nextSprite->IsEnabled() && nextSprite->IsVisible() )
+				{
+					if ( !CanDrawInstanced( nextSprite ) || ( nextSprite->GetDiffuseTextureID() != textureID ) )
+						break;
+					++numInRun;
+				}
+				++runEnd;
+			}
+
+			RenderSortKey sortKey = layer->IsStateSorted()
+				? RenderQueue::MakeSortKey( layer->m_layerID, SPRITE_ORDER_IN_LAYER, s_instancedSpriteMaterial, textureID )
+				: RenderQueue::MakeSortKey( layer->m_layerID, SPRITE_ORDER_IN_LAYER );
+
+			SpriteInstance* instances = commandBuffer->AddInstancedDraw( sortKey, s_instancedSpriteMaterial, uniforms, textureID, numInRun );
+			for ( ; spriteIndex < runEnd; spriteIndex++ )
+			{
+				const Sprite* runSprite = sprites[ spriteIndex ];
+				if ( runSprite->IsEnabled() && runSprite->IsVisible() )
+					WriteSpriteInstance( runSprite, runSprite->GetTint(), instances++ );
+			}
+			continue;
+		}
+		++spriteIndex;
+
+		Material* spriteMat = sprite->GetMaterial();
+		if ( spriteMat == nullptr )
+			spriteMat = s_defaultSpriteMaterial;
+		unsigned int textureID = sprite->GetDiffuseTextureID();
+
+		RenderSortKey sortKey = layer->IsStateSorted()
+			? RenderQueue::MakeSortKey( layer->m_layerID, SPRITE_ORDER_IN_LAYER, spriteMat, textureID )
+			: RenderQueue::MakeSortKey( layer->m_layerID, SPRITE_ORDER_IN_LAYER );
+
+		unsigned int* indices;
+		Vertex2D_PCT* vertices = static_cast<Vertex2D_PCT*>( commandBuffer->AddTransientDraw( sortKey, spriteMat, uniforms, textureID, AS_TRIANGLES, Vertex2D_PCT::DEFINITION, 4, 6, &indices ) );
+		WriteSpriteQuad( sprite->GetVirtualBoundsInWorld(), sprite->GetTint(), sprite->GetSpriteResource()->GetTexCoords(), 0, vertices, indices );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC bool SpriteRenderer::CanDrawInstanced( const Sprite* sprite )
+{
+	if ( !s_isInstancingEnabled )
+		return false;
+
+	//Custom materials' shaders expect per-vertex input, and parented sprites need their ancestors' matrices.
+	Material* spriteMat = sprite->GetMaterial();
+	bool usesDefaultMaterial = ( spriteMat == nullptr ) || ( spriteMat == s_defaultSpriteMaterial );
+	bool isParented = s_isParentingEnabled && ( sprite->GetParent() != nullptr );
+	return usesDefaultMaterial && !isParented;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteRenderer::RecordParticles( const RenderLayer* layer, const RenderUniformBlock* uniforms, RenderCommandBuffer* commandBuffer )
+{
+	for ( ParticleSystem* particleSystem : layer->m_particleSystems )
+		particleSystem->RecordDraws( commandBuffer, layer->m_layerID, PARTICLE_ORDER_IN_LAYER, layer->IsStateSorted(), uniforms );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void SpriteRenderer::RecordSpritesJob( Job* job )
+{
+	Sprite* const* sprites = job->Read<Sprite* const*>();
+	unsigned int numSprites = job->Read<unsigned int>();
+	const RenderLayer* layer = job->Read<const RenderLayer*>();
+	const RenderUniformBlock* uniforms = job->Read<const RenderUniformBlock*>();
+	RenderCommandBuffer* commandBuffer = job->Read<RenderCommandBuffer*>();
+
+	RecordSprites( sprites, numSprites, layer, uniforms, commandBuffer );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void SpriteRenderer::RecordParticlesJob( Job* job )
+{
+	const RenderLayer* layer = job->Read<const RenderLayer*>();
+	const RenderUniformBlock* uniforms = job->Read<const RenderUniformBlock*>();
+	RenderCommandBuffer* commandBuffer = job->Read<RenderCommandBuffer*>();
+
+	RecordParticles( layer, uniforms, commandBuffer );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteRenderer::ApplyLayerEffects( RenderLayer* layer )
+{
 	for ( FramebufferEffect* fboEffect : layer->m_effects )
 	{
 //		g_theRenderer->BindFBO( s_effectRenderTarget ); //Render current render target to effect render target.
@@ -412,8 +653,8 @@ void SpriteRenderer::Register( Sprite* newSprite, const char* newLayerName /*= n
 		//Background layers could go negative from a default of 0.
 		//Going by intervals: 100 as enemy layer, 200 as player layer, 300 as bullet layer, 400 as foreground, -100 as background, -200 as secondary background, and +1000 as UI layer. Lets you add layers in between without shifting all else.
 		//Recommends named constants over an enum to not lock it down on the engine side.
+	SpriteRenderer::ResizeSprite( newSprite ); //First, so the layer's culling bounds for it start out the right size.
 	layer->AddSprite( newSprite );
-	SpriteRenderer::ResizeSprite( newSprite );
 }
 
 
@@ -449,20 +690,59 @@ void SpriteRenderer::CopySpriteIntoMesh( Sprite* sprite )
 {
 	//The IBO and draw instructions will stay the same, but the VBO needs to be overwritten in-place and sent to the GPU again.
 	AABB2f worldBounds = sprite->GetVirtualBoundsInWorld();
+	const AABB2f& texCoords = sprite->GetSpriteResource()->GetTexCoords(); //Mins are the top-left.
 
 	//Order taken from CreateQuadMesh used in SpriteRenderer::Startup, to let us keep the same IBO.
 	const Vertex2D_PCT vertices[] =
 	{
-		Vertex2D_PCT( Vector2f( worldBounds.mins.x, worldBounds.maxs.y ),	sprite->GetTint(),	Vector2f( 0.f, 0.f ) ), //Top-left.		//0
-		Vertex2D_PCT( Vector2f( worldBounds.maxs.x, worldBounds.mins.y ),	sprite->GetTint(),	Vector2f( 1.f, 1.f ) ), //Bottom-right.	//1
-		Vertex2D_PCT( worldBounds.mins,										sprite->GetTint(),	Vector2f( 0.f, 1.f ) ), //Bottom-left.	//2
-		Vertex2D_PCT( worldBounds.maxs,										sprite->GetTint(),	Vector2f( 1.f, 0.f ) ) //Top-right.	//3
+		Vertex2D_PCT( Vector2f( worldBounds.mins.x, worldBounds.maxs.y ),	sprite->GetTint(),	texCoords.mins ), //Top-left.		//0
+		Vertex2D_PCT( Vector2f( worldBounds.maxs.x, worldBounds.mins.y ),	sprite->GetTint(),	texCoords.maxs ), //Bottom-right.	//1
+		Vertex2D_PCT( worldBounds.mins,										sprite->GetTint(),	Vector2f( texCoords.mins.x, texCoords.maxs.y ) ), //Bottom-left.	//2
+		Vertex2D_PCT( worldBounds.maxs,										sprite->GetTint(),	Vector2f( texCoords.maxs.x, texCoords.mins.y ) ) //Top-right.	//3
 	}; //Original BL is mins, original TR is maxs. Recall that a UV flip is required to compensate for OGL/stbi importing upside-down on y.
 
 	s_spriteMesh->SetThenUpdateMeshBuffers( 4, (void*)vertices );
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void SpriteRenderer::WriteSpriteQuad( const AABB2f& worldBounds, const Rgba& tint, const AABB2f& texCoords, unsigned int firstVertex, Vertex2D_PCT* out_vertices, unsigned int* out_indices )
+{
+	//As CopySpriteIntoMesh's vertices and Startup's quadIndices, but indices offset for quads packed into one draw.
+	out_vertices[ 0 ] = Vertex2D_PCT( Vector2f( worldBounds.mins.x, worldBounds.maxs.y ),	tint,	texCoords.mins ); //Top-left.		//0
+	out_vertices[ 1 ] = Vertex2D_PCT( Vector2f( worldBounds.maxs.x, worldBounds.mins.y ),	tint,	texCoords.maxs ); //Bottom-right.	//1
+	out_vertices[ 2 ] = Vertex2D_PCT( worldBounds.mins,										tint,	Vector2f( texCoords.mins.x, texCoords.maxs.y ) ); //Bottom-left.	//2
+	out_vertices[ 3 ] = Vertex2D_PCT( worldBounds.maxs,										tint,	Vector2f( texCoords.maxs.x, texCoords.mins.y ) ); //Top-right.	//3
+
+	out_indices[ 0 ] = firstVertex + 2;
+	out_indices[ 1 ] = firstVertex + 1;
+	out_indices[ 2 ] = firstVertex + 0;
+	out_indices[ 3 ] = firstVertex + 0;
+	out_indices[ 4 ] = firstVertex + 1;
+	out_indices[ 5 ] = firstVertex + 3; //Counter-Clockwise, else renders to the back and the quad won't show with backface culling.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteRenderer::WriteSpriteInstance( const Sprite* sprite, const Rgba& tint, SpriteInstance* out_instance )
+{
+	//What GetVirtualBoundsInWorld does to the corners, left for the vertex shader: the unit quad's scaled by m_size from m_minsFromPivot.
+	Vector2f scale = sprite->GetScale();
+	Vector2f pivot = sprite->GetPivotSpriteRelative();
+
+	out_instance->m_position = sprite->m_transform.m_position;
+	out_instance->m_minsFromPivot = Vector2f( -pivot.x * scale.x, -pivot.y * scale.y );
+	out_instance->m_size = Vector2f( sprite->GetVirtualWidth() * scale.x, sprite->GetVirtualHeight() * scale.y );
+	out_instance->m_rotationDegrees = sprite->GetRotationDegrees() + SPRITE_ANGLE_CORRECTION;
+	out_instance->m_tint = tint;
+
+	const AABB2f& texCoords = sprite->GetSpriteResource()->GetTexCoords();
+	const float uvRect[ 4 ] = { texCoords.mins.x, texCoords.mins.y, texCoords.maxs.x, texCoords.maxs.y };
+	for ( unsigned int uvIndex = 0; uvIndex < 4; uvIndex++ )
+		out_instance->m_uvRect[ uvIndex ] = (unsigned short)( ( ClampZeroToOne( uvRect[ uvIndex ] ) * MAX_INSTANCE_TEX_COORD ) + 0.5f );
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 void SpriteRenderer::AddLayerEffect( RenderLayerID layerID, FramebufferEffect* fboEffect )
 {
@@ -486,31 +766,53 @@ void SpriteRenderer::RenderSprite( Sprite* sprite, bool isLayerScrolling )
 	if ( spriteMat == nullptr )
 		spriteMat = s_defaultSpriteMaterial;
 	
-	TODO( "Move the ortho uniform update to not happen per-frame, only as virt size is updated." );
+	Matrix4x4f view( COLUMN_MAJOR );
 	Matrix4x4f ortho( COLUMN_MAJOR );
-	ortho.ClearToOrthogonalProjection( s_virtualScreenSize.x, s_virtualScreenSize.y, -1.f, 1.f, ortho.GetOrdering() );
+	CalcLayerMatrices( isLayerScrolling, view, ortho );
+
+	//Handles are per ShaderProgram, so only look them up again when the material changes, which is rare.
+	static const Material* s_lastSpriteMat = nullptr;
+	static UniformHandle s_viewHandle = INVALID_UNIFORM_HANDLE;
+	static UniformHandle s_projHandle = INVALID_UNIFORM_HANDLE;
+	static UniformHandle s_texDiffuseHandle = INVALID_UNIFORM_HANDLE;
+	if ( spriteMat != s_lastSpriteMat )
+	{
+		s_lastSpriteMat = spriteMat;
+		s_viewHandle = spriteMat->GetUniformHandle( "uView" );
+		s_projHandle = spriteMat->GetUniformHandle( "uProj" );
+		s_texDiffuseHandle = spriteMat->GetUniformHandle( "uTexDiffuse" );
+	}
+
+	spriteMat->SetMatrix4x4( s_viewHandle, false, &view );
+	spriteMat->SetMatrix4x4( s_projHandle, false, &ortho ); //Same every sprite in a layer, the shadow copy skips it after the first.
+
+	spriteMat->SetTexture( s_texDiffuseHandle, sprite->GetDiffuseTextureID() );
+	SpriteRenderer::s_spriteMeshRenderer->SetMaterial( spriteMat, true );
+	
+	SpriteRenderer::s_spriteMeshRenderer->Render();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteRenderer::CalcLayerMatrices( bool isLayerScrolling, Matrix4x4f& out_view, Matrix4x4f& out_projection )
+{
+	TODO( "Move the ortho uniform update to not happen per-frame, only as virt size is updated." );
+	out_projection = Matrix4x4f( COLUMN_MAJOR );
+	out_projection.ClearToOrthogonalProjection( s_virtualScreenSize.x, s_virtualScreenSize.y, -1.f, 1.f, out_projection.GetOrdering() );
 		// The values of zNear and zFar don't matter as long as former/latter are -/+, using 0 would cause division by 0.
 		// Could set the virtual size per layer, to support zooming in and out per layer( i.e.changing - 1 and +1 / zNear and zFar above ).
 		// Can set this as a member on TheGame or per layer depending on whether you do per - layer features.
 
-	Matrix4x4f view( COLUMN_MAJOR );
+	out_view = Matrix4x4f( COLUMN_MAJOR );
 	if ( isLayerScrolling ) //Else it defaults to default ctor's identity matrix, so no scroll.
-		view = s_activeCamera->GetViewTransform();
+		out_view = s_activeCamera->GetViewTransform();
 
 #ifdef PLATFORM_RIFT_CV1
 	//Overwrite by adding in offsets based on VR HMD.
 	int eye = g_theRenderer->GetRiftContext()->currentEye;
-	view = g_theRenderer->CalcRiftViewMatrixMyBasis( eye, s_activeCamera );
-	ortho = g_theRenderer->CalcRiftOrthoProjMatrixMyBasis( eye );
+	out_view = g_theRenderer->CalcRiftViewMatrixMyBasis( eye, s_activeCamera );
+	out_projection = g_theRenderer->CalcRiftOrthoProjMatrixMyBasis( eye );
 #endif
-
-	spriteMat->SetMatrix4x4( "uView", false, &view );
-	spriteMat->SetMatrix4x4( "uProj", false, &ortho );
-
-	spriteMat->SetTexture( "uTexDiffuse", sprite->GetDiffuseTextureID() );
-	SpriteRenderer::s_spriteMeshRenderer->SetMaterial( spriteMat, true );
-	
-	SpriteRenderer::s_spriteMeshRenderer->Render();
 }
 
 
@@ -535,10 +837,8 @@ void SpriteRenderer::SetLayerVirtualSize( RenderLayerID layerID, float lengthX,
 //--------------------------------------------------------------------------------------------------------------
 void SpriteRenderer::ResizeSprite( Sprite* sprite )
 {
-	//Virtual conversion setup.
-	Vector2f dimensionsInPixelsAsFloats;
-	dimensionsInPixelsAsFloats.x = static_cast<float>( sprite->GetDiffuseTexture()->GetTextureDimensions().x );
-	dimensionsInPixelsAsFloats.y = static_cast<float>( sprite->GetDiffuseTexture()->GetTextureDimensions().y );
+	//Virtual conversion setup. The resource's region rather than its texture's, which may be a whole atlas page.
+	Vector2f dimensionsInPixelsAsFloats = sprite->GetSpriteResource()->GetSizeInTexels();
 //	ASSERT_OR_DIE( dimensionsInPixelsAsFloats.x <= importSize && dimensionsInPixelsAsFloats.y <= importSize, "Sprites should not exceed import size!" );
 	Vector2f dimsWithCancelledPx = dimensionsInPixelsAsFloats / SpriteRenderer::GetImportSize(); //Because of above assert, should always be 0-1.
 
@@ -551,6 +851,17 @@ void SpriteRenderer::ResizeSprite( Sprite* sprite )
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void SpriteRenderer::ResizeSpritesUsingResource( const SpriteResource* resource )
+{
+	//If it's disabled, it's not in a layer, and Register() will size it when it's next enabled.
+	for ( const SpriteLayerRegistryPair& layerPair : s_spriteLayers )
+		for ( Sprite* sprite : layerPair.second->m_sprites )
+			if ( sprite->GetSpriteResource() == resource )
+				SpriteRenderer::ResizeSprite( sprite );
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 void SpriteRenderer::Update( float deltaSeconds )
 {	
@@ -559,9 +870,14 @@ void SpriteRenderer::Update( float deltaSeconds )
 
 	for ( const SpriteLayerRegistryPair& layerPair : s_spriteLayers )
 	{
-		for ( Sprite* sprite : layerPair.second->m_sprites )
-			sprite->Update( deltaSeconds ); //Primarily for animations.
+		RenderLayer* layer = layerPair.second;
+		for ( unsigned int spriteIndex = 0; spriteIndex < layer->m_sprites.size(); spriteIndex++ )
+		{
+			layer->m_sprites[ spriteIndex ]->Update( deltaSeconds ); //Primarily for animations.
+			layer->RefitSprite( spriteIndex );
+		}
 
+		ProfilerSample* particlesSample = Profiler::Instance()->StartSample( "SpriteRenderer::UpdateParticles" );
 		std::vector<ParticleSystem*>& particleSystems = layerPair.second->m_particleSystems;
 		for ( size_t index = 0; index < particleSystems.size(); index++ )
 		{
@@ -578,40 +894,28 @@ void SpriteRenderer::Update( float deltaSeconds )
 
 			system->Update( deltaSeconds ); //We don't want it to be expired last, or it could update and immediately die without getting rendered.
 		}
+		Profiler::Instance()->EndSample( particlesSample );
 	}
 
 
 	TODO( "Move below into TheRenderer instead of SpriteRenderer--see code review, doesn't belong here." );
-	//The camera is GetVirtualScreenBounds() centered on activeCam.m_worldPosition:
+	//The camera is GetVirtualScreenBounds() centered on activeCam.m_worldPosition, or on the origin for layers that ignore scrolling.
+	//Culling messes up when the view is rotated, because the camera's bounds here aren't.
 	Vector2f halfVirtualScreenSize = GetVirtualScreenDimensions() * 0.5f;
 	AABB2f cameraBoundsInWorld;
 	cameraBoundsInWorld.mins = s_activeCamera->m_worldPosition - halfVirtualScreenSize;
 	cameraBoundsInWorld.maxs = s_activeCamera->m_worldPosition + halfVirtualScreenSize;
+	AABB2f screenBounds = AABB2f( -halfVirtualScreenSize, halfVirtualScreenSize );
 
 	s_numSpritesCulled = 0;
 	for ( const SpriteLayerRegistryPair& layerPair : s_spriteLayers )
 	{
-		if ( !layerPair.second->m_enabled )
+		RenderLayer* layer = layerPair.second;
+		if ( !layer->m_enabled )
 			continue;
 
 		//If it's disabled, it's not in a layer, so we don't have to worry about Sprite::IsEnabled().
-		for ( Sprite* sprite : layerPair.second->m_sprites )
-		{
-			//Culling messes up when the view is rotated, because then the post-rotation corners aren't maxs and mins as expected.
-			bool visible = DoAABBsOverlap( cameraBoundsInWorld, sprite->GetVirtualBoundsInWorld() );
-			if ( !s_shouldCull )
-				visible = true;
-
-			if ( visible && !sprite->IsVisible() )
-				sprite->Show();
-			else if ( !visible && sprite->IsVisible() )
-				sprite->Hide();
-
-			if ( !visible )
-			{
-				++s_numSpritesCulled;
-				continue;
-			}
-		}
+		layer->CullSprites( layer->IsScrolling() ? cameraBoundsInWorld : screenBounds, s_shouldCull );
+		s_numSpritesCulled += layer->m_sprites.size() - layer->GetNumVisibleSprites();
 	}
 }
@@ -36,9 +36,15 @@ class FrameBuffer;
 class Material;
 class Mesh;
 class MeshRenderer;
+class SpriteResource;
 class Command;
 class Camera2D;
+class RenderCommandBuffer;
+struct RenderUniformBlock;
 struct Rgba;
+struct Vertex2D_PCT;
+struct SpriteInstance;
+struct Job;
 typedef std::pair<RenderLayerID, RenderLayer*> SpriteLayerRegistryPair;
 typedef std::map<RenderLayerID, RenderLayer*, std::less<RenderLayerID>, UntrackedAllocator<SpriteLayerRegistryPair> > SpriteLayerRegistryMap;
 
@@ -73,6 +79,9 @@ public:
 	static void ToggleShowing3D( Command& ) { s_shouldHide3D = !s_shouldHide3D; }
 	static void ToggleShowing2D( Command& ) { s_shouldHide2D = !s_shouldHide2D; }
 	static void ToggleCulling( Command& ) { s_shouldCull = !s_shouldCull; }
+	static void ToggleRenderQueue( Command& ) { s_isRenderQueueEnabled = !s_isRenderQueueEnabled; }
+	static void ToggleInstancing( Command& ) { s_isInstancingEnabled = !s_isInstancingEnabled; }
+	static bool IsInstancingEnabled() { return s_isInstancingEnabled; }
 
 	static void PrintLayers( Command& );
 	static void CreateOrRenameLayer( Command& args );
@@ -85,8 +94,10 @@ public:
 	static void SetLayerVirtualSize( RenderLayerID layerID, float lengthXY ) { SetLayerVirtualSize( layerID, lengthXY, lengthXY ); }
 	static void SetLayerVirtualSize( RenderLayerID layerID, float lengthX, float lengthY );
 	static void SetLayerIsScrolling( RenderLayerID layerID, bool newVal ) { s_spriteLayers.at( layerID )->SetIsScrolling( newVal ); }
+	static void SetLayerIsStateSorted( RenderLayerID layerID, bool newVal ) { s_spriteLayers.at( layerID )->SetIsStateSorted( newVal ); }
 
 	static void ResizeSprite( Sprite* sprite );
+	static void ResizeSpritesUsingResource( const SpriteResource* resource ); //After its texture changes size, e.g. an async load replacing the placeholder.
 
 	static void Update( float deltaSeconds );
 	static void RenderFrame();
@@ -98,17 +109,34 @@ public:
 	static RenderLayer* CreateOrGetLayer( RenderLayerID layerID, const char* newLayerName = nullptr );
 
 	static void CopySpriteIntoMesh( Sprite* sprite );
+	static void WriteSpriteQuad( const AABB2f& worldBounds, const Rgba& tint, const AABB2f& texCoords, unsigned int firstVertex, Vertex2D_PCT* out_vertices, unsigned int* out_indices ); //4 vertices, 6 indices, same corners and winding as s_spriteMesh.
+	static void WriteSpriteInstance( const Sprite* sprite, const Rgba& tint, SpriteInstance* out_instance ); //The same quad for s_instancedSpriteMaterial to expand, minus parenting.
 
 	static void AddLayerEffect( RenderLayerID layerID, FramebufferEffect* fboMaterial );
 
 	static const RenderState s_defaultSpriteRenderState;
 	static Material* s_defaultSpriteMaterial;
+	static Material* s_instancedSpriteMaterial; //Draws SpriteInstances, for sprites that'd otherwise use s_defaultSpriteMaterial.
 	static std::shared_ptr<Mesh> s_spriteMesh; //Recopied onto per registered sprite quad.
 	static MeshRenderer* s_spriteMeshRenderer;
 
 
 private:
 	static void RenderSprite( Sprite* sprite, bool isLayerScrolling );
+	static void CalcLayerMatrices( bool isLayerScrolling, Matrix4x4f& out_view, Matrix4x4f& out_projection );
+	static void ApplyLayerEffects( RenderLayer* layer );
+
+	//RenderQueue path: layers are recorded by jobs, then sorted and drawn together.
+	static void RecordFrame();
+	static void RecordSprites( Sprite* const* sprites, unsigned int numSprites, const RenderLayer* layer, const RenderUniformBlock* uniforms, RenderCommandBuffer* commandBuffer );
+	static void RecordParticles( const RenderLayer* layer, const RenderUniformBlock* uniforms, RenderCommandBuffer* commandBuffer );
+	static void RecordSpritesJob( Job* job );
+	static void RecordParticlesJob( Job* job );
+	static bool CanDrawInstanced( const Sprite* sprite );
+	static std::vector<RenderUniformBlock> s_layerUniformBlocks; //Per enabled layer, read by packets until the frame's Submit.
+	static bool s_isRenderQueueEnabled;
+	static bool s_isInstancingEnabled; //Only takes effect on the RenderQueue path.
+
 	static SpriteLayerRegistryMap s_spriteLayers; //Small enough to have by value.
 	static FrameBuffer* s_currentRenderTarget; //What we're currently rendering to. The composite of all of them.
 	static FrameBuffer* s_effectRenderTarget; //Secondary, for the effect.
@@ -6,19 +6,63 @@
 #include "Engine/Error/ErrorWarningAssert.hpp"
 #include "Engine/FileUtils/XMLUtils.hpp"
 #include "Engine/Renderer/Material.hpp"
+#include "Engine/Renderer/AsyncTextureLoader.hpp"
+#include "Engine/Renderer/TextureAtlas.hpp"
 
 
 //--------------------------------------------------------------------------------------------------------------
 SpriteResource* SpriteResource::Create( ResourceID id, const char* textureFilename )
 {
+	const TextureAtlasCell* atlasCell = TextureAtlas::FindCell( textureFilename );
+	if ( atlasCell != nullptr )
+		return CreateWithTexture( id, textureFilename, atlasCell->m_page, atlasCell );
+
 	Texture* diffuseTex = Texture::CreateOrGetTexture( textureFilename );
 	ASSERT_RETURN( diffuseTex );
 
+	return CreateWithTexture( id, textureFilename, diffuseTex );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+SpriteResource* SpriteResource::CreateAsync( ResourceID id, const char* textureFilename )
+{
+	const TextureAtlasCell* atlasCell = TextureAtlas::FindCell( textureFilename );
+	if ( atlasCell != nullptr ) //Its page is already resident, nothing to wait on.
+		return CreateWithTexture( id, textureFilename, atlasCell->m_page, atlasCell );
+
+	SpriteResource* sr = CreateWithTexture( id, textureFilename, AsyncTextureLoader::GetPlaceholderTexture() );
+	AsyncTextureLoader::RequestTexture( textureFilename, OnDiffuseTextureLoaded, sr ); //May swap immediately if already resident.
+
+	return sr;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteResource::OnDiffuseTextureLoaded( Texture* loadedTexture, void* spriteResource )
+{
+	if ( loadedTexture == nullptr ) //Loader already complained, keep drawing the placeholder.
+		return;
+
+	SpriteResource* sr = static_cast<SpriteResource*>( spriteResource );
+	if ( loadedTexture->GetFilePath() != sr->m_diffuseTexturePath ) //Re-pointed by SetDiffuseTexture while this was in flight.
+		return;
+
+	sr->m_diffuseTexture = loadedTexture;
+	SpriteRenderer::ResizeSpritesUsingResource( sr ); //Sprite sizes come from texel dimensions, which the placeholder didn't have.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+SpriteResource* SpriteResource::CreateWithTexture( ResourceID id, const char* textureFilename, Texture* diffuseTex, const TextureAtlasCell* atlasCell )
+{
 	ASSERT_OR_DIE( ResourceDatabase::Count( id ) == 0, "Non-unique SpriteResource!" );
 
 	SpriteResource* sr = new SpriteResource();
 	sr->m_id = id;
 	sr->m_diffuseTexture = diffuseTex;
+	sr->m_diffuseTexturePath = textureFilename;
+	sr->m_atlasCell = atlasCell;
 	sr->m_defaultMaterial = SpriteRenderer::s_defaultSpriteMaterial;
 		//Recommends typing this up in a .vert like SD3, but then just pasting that and hard-loading it 
 		//with no dependencies using the CompileShader( const char* sourceCodeBuffer ).
@@ -26,6 +70,7 @@ SpriteResource* SpriteResource::Create( ResourceID id, const char* textureFilena
 	
 	//For now, just show entire sprite:
 	sr->m_texCoords = AABB2f( 0.f, 0.f, 1.f, 1.f );
+	sr->UpdateDrawTexCoords();
 
 	ResourceDatabase::Instance()->AddSpriteResource( id, sr );
 
@@ -37,7 +82,7 @@ SpriteResource* SpriteResource::Create( ResourceID id, const char* textureFilena
 void SpriteResource::WriteToXMLNode( XMLNode& resourceNode )
 {
 	WriteXMLAttribute( resourceNode, "name",			m_id, std::string() );
-	WriteXMLAttribute( resourceNode, "image",			m_diffuseTexture->GetFilePath(), std::string() );
+	WriteXMLAttribute( resourceNode, "image",			m_diffuseTexturePath, std::string() );
 
 	std::string materialName;
 	if ( m_defaultMaterial != nullptr )
@@ -64,13 +109,27 @@ Texture* SpriteResource::GetDiffuseTexture() const
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+Vector2f SpriteResource::GetSizeInTexels() const
+{
+	Vector2i imageSize = ( m_atlasCell != nullptr ) ? m_atlasCell->m_sizeInTexels : m_diffuseTexture->GetTextureDimensions();
+	Vector2f texCoordsExtent = m_texCoords.maxs - m_texCoords.mins;
+
+	return Vector2f( imageSize.x * texCoordsExtent.x, imageSize.y * texCoordsExtent.y );
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 void SpriteResource::SetDiffuseTexture( const std::string& newTexFilePath )
 {
-	Texture* diffuseTex = Texture::CreateOrGetTexture( newTexFilePath );
+	const TextureAtlasCell* atlasCell = TextureAtlas::FindCell( newTexFilePath );
+	Texture* diffuseTex = ( atlasCell != nullptr ) ? atlasCell->m_page : Texture::CreateOrGetTexture( newTexFilePath );
 	ASSERT_RETURN( diffuseTex );
 
 	m_diffuseTexture = diffuseTex;
+	m_diffuseTexturePath = newTexFilePath;
+	m_atlasCell = atlasCell;
+	UpdateDrawTexCoords();
 }
 
 
@@ -78,4 +137,21 @@ void SpriteResource::SetDiffuseTexture( const std::string& newTexFilePath )
 void SpriteResource::SetUV( const Vector2f& mins, const Vector2f& maxs )
 {
 	m_texCoords = AABB2f( mins, maxs );
+	UpdateDrawTexCoords();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void SpriteResource::UpdateDrawTexCoords()
+{
+	if ( m_atlasCell == nullptr )
+	{
+		m_drawTexCoords = m_texCoords;
+		return;
+	}
+
+	//The source-relative UVs, scaled and offset into the cell's.
+	const AABB2f& cellTexCoords = m_atlasCell->m_texCoords;
+	Vector2f cellExtent = cellTexCoords.maxs - cellTexCoords.mins;
+	m_drawTexCoords = AABB2f( cellTexCoords.mins + ( m_texCoords.mins * cellExtent ), cellTexCoords.mins + ( m_texCoords.maxs * cellExtent ) );
 }
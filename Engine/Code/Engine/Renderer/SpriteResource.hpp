@@ -6,6 +6,7 @@
 class Texture;
 class Material;
 struct XMLNode;
+struct TextureAtlasCell;
 
 
 //-----------------------------------------------------------------------------
@@ -17,7 +18,8 @@ typedef std::vector< SpriteResource*, UntrackedAllocator<SpriteResource*> > Spri
 class SpriteResource
 {
 public:
-	static SpriteResource* Create( ResourceID id, const char* textureFilename );
+	static SpriteResource* Create( ResourceID id, const char* textureFilename ); //Both draw from TextureAtlas's page instead if the image was atlased.
+	static SpriteResource* CreateAsync( ResourceID id, const char* textureFilename ); //Usable right away, drawn with AsyncTextureLoader's placeholder until the real texture lands.
 	void WriteToXMLNode( XMLNode& resourceNode );
 
 	ResourceID GetID() const { return m_id; }
@@ -25,20 +27,28 @@ public:
 	Material* GetMaterial() const { return m_defaultMaterial; }
 	unsigned int GetDiffuseTextureID() const;
 	Texture* GetDiffuseTexture() const;
+	const AABB2f& GetTexCoords() const { return m_drawTexCoords; } //Within GetDiffuseTexture(), so already inside the atlas cell if there is one.
+	Vector2f GetSizeInTexels() const; //Of the region drawn, not the whole texture or atlas page.
 
 	void SetDiffuseTexture( const std::string& newTexFilePath );
 	void SetMaterial( Material* newMat ) { m_defaultMaterial = newMat; }
 	void SetUV( const Vector2f& mins, const Vector2f& maxs );
 
 private:
-	SpriteResource() { m_diffuseTexture = nullptr; m_defaultMaterial = nullptr; }
+	SpriteResource() { m_diffuseTexture = nullptr; m_atlasCell = nullptr; m_defaultMaterial = nullptr; }
+	static SpriteResource* CreateWithTexture( ResourceID id, const char* textureFilename, Texture* diffuseTex, const TextureAtlasCell* atlasCell = nullptr );
+	static void OnDiffuseTextureLoaded( Texture* loadedTexture, void* spriteResource );
+	void UpdateDrawTexCoords();
 	SpriteResource( const SpriteResource& ) {} //Disallow copying.
 	void operator=( const SpriteResource& ) {} //Disallow assignment/pass by value.
 	ResourceID m_id;
 
 	//Change below two members to be a list if looking to extend sprites to have normal maps, etc.
 	Texture* m_diffuseTexture;
-	AABB2f m_texCoords;
+	std::string m_diffuseTexturePath; //Kept apart from m_diffuseTexture, which may still be the async placeholder.
+	const TextureAtlasCell* m_atlasCell; //Null when drawing from the image's own texture.
+	AABB2f m_texCoords; //Relative to the source image, as read from and written to XML.
+	AABB2f m_drawTexCoords; //m_texCoords moved into m_atlasCell's.
 
 	Material* m_defaultMaterial; //i.e. can be overridden by Sprite's member.
 };
@@ -0,0 +1,178 @@
+#include "Engine/Renderer/TextLayoutCache.hpp"
+
+
+#include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/EngineCommon.hpp"
+#include <cstring>
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline void HashCombine( size_t& inout_hash, size_t value )
+{
+	inout_hash ^= value + 0x9e3779b9 + ( inout_hash << 6 ) + ( inout_hash >> 2 );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline size_t PackRgba( const Rgba& color )
+{
+	return ( color.red << 24 ) | ( color.green << 16 ) | ( color.blue << 8 ) | color.alphaOpacity;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC size_t TextLayoutCache::CalcKeyHash( const BitmapFont* font, const std::string& text, float scale, const Rgba& tint, bool drawDropShadow, const Rgba& shadowColor )
+{
+	unsigned int scaleBits;
+	memcpy( &scaleBits, &scale, sizeof( scaleBits ) );
+
+	size_t hash = std::hash< std::string >()( text );
+	HashCombine( hash, std::hash< const BitmapFont* >()( font ) );
+	HashCombine( hash, scaleBits );
+	HashCombine( hash, PackRgba( tint ) );
+	if ( drawDropShadow )
+		HashCombine( hash, PackRgba( shadowColor ) ^ 0x5bd1e995 );
+	return hash;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC bool TextLayoutCache::DoesEntryMatch( const CacheEntry& entry, const BitmapFont* font, const std::string& text, float scale, const Rgba& tint, bool drawDropShadow, const Rgba& shadowColor )
+{
+	if ( entry.m_font != font || entry.m_scale != scale || entry.m_drawDropShadow != drawDropShadow )
+		return false;
+	if ( PackRgba( entry.m_tint ) != PackRgba( tint ) )
+		return false;
+	if ( drawDropShadow && PackRgba( entry.m_shadowColor ) != PackRgba( shadowColor ) )
+		return false;
+	return entry.m_text == text;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+const TextLayout& TextLayoutCache::CreateOrGetLayout( const BitmapFont* font, const std::string& text, float scale, const Rgba& tint, bool drawDropShadow, const Rgba& shadowColor )
+{
+	size_t hash = CalcKeyHash( font, text, scale, tint, drawDropShadow, shadowColor );
+
+	auto found = m_entries.find( hash );
+	if ( found != m_entries.end() && DoesEntryMatch( found->second, font, text, scale, tint, drawDropShadow, shadowColor ) )
+	{
+		++m_currentFrameStats.m_numHits;
+		found->second.m_lastUsedFrame = m_currentFrame;
+		return found->second.m_layout;
+	}
+
+	++m_currentFrameStats.m_numMisses;
+
+	CacheEntry& entry = m_entries[ hash ]; //On a collision, the older string just loses its slot.
+	entry.m_font = font;
+	entry.m_text = text;
+	entry.m_scale = scale;
+	entry.m_tint = tint;
+	entry.m_shadowColor = shadowColor;
+	entry.m_drawDropShadow = drawDropShadow;
+	entry.m_lastUsedFrame = m_currentFrame;
+	BuildLayout( entry.m_layout, font, text, scale, tint, drawDropShadow, shadowColor );
+
+	return entry.m_layout;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void TextLayoutCache::EndFrame()
+{
+	++m_currentFrame;
+
+	m_lastFrameStats = m_currentFrameStats;
+	m_currentFrameStats.Clear();
+
+	if ( m_currentFrame % EVICTION_INTERVAL_FRAMES != 0 )
+		return;
+
+	unsigned int maxIdleFrames = ( m_entries.size() > MAX_CACHED_LAYOUTS ) ? 1 : MAX_IDLE_FRAMES;
+	for ( auto entryIter = m_entries.begin(); entryIter != m_entries.end(); )
+	{
+		if ( m_currentFrame - entryIter->second.m_lastUsedFrame > maxIdleFrames )
+		{
+			entryIter = m_entries.erase( entryIter );
+			++m_lastFrameStats.m_numEvictions;
+		}
+		else ++entryIter;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void TextLayoutCache::AppendQuad( TextLayoutRun& run, const Vector2f& mins, const Vector2f& maxs, const AABB2f& texCoords, const Rgba& color )
+{
+	//Same corners and winding as TheRenderer::DrawAABB's textured 2D quad.
+	unsigned int firstIndex = run.m_vertices.size();
+	run.m_vertices.push_back( Vertex3D_PCT( Vector3f( maxs.x, maxs.y, 0.f ), Vector2f( texCoords.maxs.x, texCoords.mins.y ), color ) );
+	run.m_vertices.push_back( Vertex3D_PCT( Vector3f( mins.x, mins.y, 0.f ), Vector2f( texCoords.mins.x, texCoords.maxs.y ), color ) );
+	run.m_vertices.push_back( Vertex3D_PCT( Vector3f( maxs.x, mins.y, 0.f ), Vector2f( texCoords.maxs.x, texCoords.maxs.y ), color ) );
+	run.m_vertices.push_back( Vertex3D_PCT( Vector3f( mins.x, maxs.y, 0.f ), Vector2f( texCoords.mins.x, texCoords.mins.y ), color ) );
+
+	const unsigned int quadIndicesCounterClockwise[] = { 0, 1, 2, 3, 1, 0 };
+	for ( unsigned int index : quadIndicesCounterClockwise )
+		run.m_indices.push_back( firstIndex + index );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void TextLayoutCache::BuildLayout( TextLayout& out_layout, const BitmapFont* font, const std::string& text, float scale, const Rgba& tint, bool drawDropShadow, const Rgba& shadowColor )
+{
+	out_layout.m_runs.clear();
+
+	const Vector2f shadowOffset = Vector2f( m_dropShadowOffset, -m_dropShadowOffset );
+	const int numPasses = drawDropShadow ? 2 : 1;
+
+	for ( int pass = 0; pass < numPasses; pass++ ) //Shadow pass first, so one draw per page covers the whole string.
+	{
+		const bool isShadowPass = ( pass == 0 ) && drawDropShadow;
+		const Rgba& color = isShadowPass ? shadowColor : tint;
+
+		Vector2f cursor = Vector2f::ZERO; //Lower-left, origin added at draw time.
+		const Glyph* previousGlyph = nullptr; //For kerning check.
+
+		for ( unsigned int charIndex = 0; charIndex < text.size(); charIndex++ )
+		{
+			const Glyph* currentGlyph = font->GetGlyphForChar( text[ charIndex ] );
+			if ( currentGlyph == nullptr )
+				continue; //Skips unsupported chars.
+
+			if ( previousGlyph != nullptr ) //BMFont only does kerning horizontally.
+				cursor.x += ( font->GetKerning( *previousGlyph, *currentGlyph ) * scale );
+
+			//Remember: in 2D, y+ is up, x+ is right. But positive yoffset means DOWN, though positive xoffset still means right.
+			Vector2f topLeftCorner = Vector2f( cursor.x + currentGlyph->m_xoffset * scale, cursor.y - currentGlyph->m_yoffset * scale );
+			Vector2f bottomLeftCorner = Vector2f( topLeftCorner.x, topLeftCorner.y - ( currentGlyph->m_height * scale ) );
+			Vector2f topRightCorner = Vector2f( topLeftCorner.x + ( currentGlyph->m_width * scale ), topLeftCorner.y );
+			if ( isShadowPass )
+			{
+				bottomLeftCorner += shadowOffset;
+				topRightCorner += shadowOffset;
+			}
+
+			TextLayoutRun* run = nullptr;
+			for ( TextLayoutRun& existingRun : out_layout.m_runs )
+			{
+				if ( existingRun.m_page == currentGlyph->m_page )
+					run = &existingRun;
+			}
+			if ( run == nullptr )
+			{
+				out_layout.m_runs.push_back( TextLayoutRun() );
+				run = &out_layout.m_runs.back();
+				run->m_page = currentGlyph->m_page;
+				run->m_vertices.reserve( text.size() * 4 * numPasses );
+				run->m_indices.reserve( text.size() * 6 * numPasses );
+			}
+
+			AppendQuad( *run, bottomLeftCorner, topRightCorner, font->GetTexCoordsForGlyph( *currentGlyph ), color );
+
+			cursor.x += ( currentGlyph->m_xadvance * scale ); //Move to next glyph.
+
+			previousGlyph = currentGlyph; //For next kerning check.
+		}
+	}
+}
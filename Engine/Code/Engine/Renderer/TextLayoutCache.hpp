@@ -0,0 +1,86 @@
+#pragma once
+
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Engine/Renderer/Vertexes.hpp"
+#include "Engine/Math/AABB2.hpp"
+
+
+//-----------------------------------------------------------------------------
+class BitmapFont;
+
+
+//-----------------------------------------------------------------------------
+struct TextLayoutRun //All the quads of a string that sample the same font page, shadows first so they sit under every glyph.
+{
+	int m_page;
+	std::vector< Vertex3D_PCT > m_vertices; //Relative to the string's lower-left origin.
+	std::vector< unsigned int > m_indices;
+};
+
+
+//-----------------------------------------------------------------------------
+struct TextLayout
+{
+	std::vector< TextLayoutRun > m_runs; //Almost always one, fonts rarely span pages.
+};
+
+
+//-----------------------------------------------------------------------------
+struct TextLayoutCacheStats
+{
+	TextLayoutCacheStats() { Clear(); }
+	void Clear() { m_numHits = m_numMisses = m_numEvictions = 0; }
+
+	unsigned int m_numHits;
+	unsigned int m_numMisses; //Includes hash collisions, which just rebuild the entry in place.
+	unsigned int m_numEvictions;
+};
+
+
+//-----------------------------------------------------------------------------
+//Console lines and debug overlays redraw the same strings every frame, so TheRenderer lays each out once
+//into a vertex run and reuses it until the string stops being drawn. A hit costs one hash and one compare, no allocation.
+class TextLayoutCache
+{
+public:
+	TextLayoutCache( float dropShadowOffset ) : m_dropShadowOffset( dropShadowOffset ), m_currentFrame( 0 ) {}
+
+	const TextLayout& CreateOrGetLayout( const BitmapFont* font, const std::string& text, float scale, const Rgba& tint, bool drawDropShadow, const Rgba& shadowColor );
+	void EndFrame(); //Evicts layouts that went unused for a while.
+
+	unsigned int GetNumCachedLayouts() const { return m_entries.size(); }
+	const TextLayoutCacheStats& GetLastFrameStats() const { return m_lastFrameStats; }
+	void Clear() { m_entries.clear(); } //e.g. After fonts reload.
+
+
+private:
+	static const unsigned int EVICTION_INTERVAL_FRAMES = 60;
+	static const unsigned int MAX_IDLE_FRAMES = 120;
+	static const unsigned int MAX_CACHED_LAYOUTS = 1024; //Past this, anything not drawn this frame goes at the next eviction.
+
+	struct CacheEntry
+	{
+		const BitmapFont* m_font;
+		std::string m_text;
+		float m_scale;
+		Rgba m_tint;
+		Rgba m_shadowColor;
+		bool m_drawDropShadow;
+		unsigned int m_lastUsedFrame;
+		TextLayout m_layout;
+	};
+
+	static size_t CalcKeyHash( const BitmapFont* font, const std::string& text, float scale, const Rgba& tint, bool drawDropShadow, const Rgba& shadowColor );
+	static bool DoesEntryMatch( const CacheEntry& entry, const BitmapFont* font, const std::string& text, float scale, const Rgba& tint, bool drawDropShadow, const Rgba& shadowColor );
+	void BuildLayout( TextLayout& out_layout, const BitmapFont* font, const std::string& text, float scale, const Rgba& tint, bool drawDropShadow, const Rgba& shadowColor );
+	static void AppendQuad( TextLayoutRun& run, const Vector2f& mins, const Vector2f& maxs, const AABB2f& texCoords, const Rgba& color );
+
+	float m_dropShadowOffset; //TheRenderer's, shadows go right and down by it.
+	std::unordered_map< size_t, CacheEntry > m_entries;
+	unsigned int m_currentFrame;
+	TextLayoutCacheStats m_currentFrameStats;
+	TextLayoutCacheStats m_lastFrameStats;
+};
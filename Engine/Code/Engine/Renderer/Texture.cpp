@@ -4,6 +4,7 @@
 #include "Engine/Renderer/Texture.hpp"
 #include "Engine/Error/ErrorWarningAssert.hpp"
 #include "Engine/Renderer/OpenGLExtensions.hpp"
+#include "Engine/Renderer/RenderStateCache.hpp"
 
 
 #define WIN32_LEAN_AND_MEAN
@@ -41,7 +42,7 @@ Texture::Texture( const std::string& imageFilePath )
 	glGenTextures( 1, (GLuint*)&m_openglTextureID );
 
 	// Tell OpenGL to bind (set) this as the currently active texture
-	glBindTexture( GL_TEXTURE_2D, m_openglTextureID );
+	RenderStateCache::BindTexture2D( 0, m_openglTextureID );
 
 	// Set texture clamp vs. wrap (repeat)
 	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP ); // one of: GL_CLAMP or GL_REPEAT
@@ -92,7 +93,7 @@ Texture::Texture( const std::string& textureName, const unsigned char* imageData
 	glGenTextures( 1, (GLuint*)&m_openglTextureID );
 
 	// Tell OpenGL to bind (set) this as the currently active texture
-	glBindTexture( GL_TEXTURE_2D, m_openglTextureID );
+	RenderStateCache::BindTexture2D( 0, m_openglTextureID );
 
 	// Set texture clamp vs. wrap (repeat)
 	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP ); // one of: GL_CLAMP or GL_REPEAT
@@ -155,8 +156,7 @@ Texture::Texture( const std::string& textureName, unsigned int width, unsigned i
 		ERROR_AND_DIE( "Found unsupported TextureFormat in Texture()!" );
 	}
 
-	glActiveTexture( GL_TEXTURE0 );
-	glBindTexture( textureType, m_openglTextureID ); //Can store it off as well!
+	RenderStateCache::BindTexture2D( 0, m_openglTextureID ); //textureType is always GL_TEXTURE_2D for now.
 	glTexImage2D( textureType, //What bind point you're generating the image on
 		0, // mipmap level
 		internalFormat, //how tex is stored in memory
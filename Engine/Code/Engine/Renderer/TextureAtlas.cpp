@@ -0,0 +1,545 @@
+#include "Engine/Renderer/TextureAtlas.hpp"
+
+#include "Engine/Renderer/Texture.hpp"
+#include "Engine/FileUtils/FileUtils.hpp"
+#include "Engine/FileUtils/XMLUtils.hpp"
+#include "Engine/FileUtils/XMLStreamReader.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Core/Logger.hpp"
+#include "Engine/Error/ErrorWarningAssert.hpp"
+#include "Engine/String/StringUtils.hpp"
+#include "Engine/Time/Time.hpp"
+#include <algorithm>
+#include <map>
+#include <sys/stat.h>
+#include <direct.h>
+
+#define STBI_HEADER_FILE_ONLY
+#include "ThirdParty/stb/stb_image.c"
+
+#pragma warning( push )
+#pragma warning( disable: 4996 ) //fopen in stb_image_write.
+#define STB_IMAGE_WRITE_IMPLEMENTATION //Only here, ThirdParty/stb/stb_image_write.c builds without it.
+#include "ThirdParty/stb/stb_image_write.h"
+#pragma warning( pop )
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const unsigned int ATLAS_MANIFEST_VERSION = 1; //Bump on any change below, or to the manifest's layout, to force a repack.
+static const int ATLAS_PAGE_SIZE = 2048; //Pages are trimmed to what's used, so a lone small page doesn't cost a whole 2048x2048.
+static const int ATLAS_CELL_PADDING = 1; //Texels of extruded edge around each cell, so sampling right at its border never picks up a neighbour.
+static const int MAX_ATLASED_IMAGE_SIZE = 256; //Backgrounds and title cards draw alone anyway, and would crowd the small sprites out of a page.
+static const int ATLAS_NUM_COMPONENTS = 4;
+static const char* ATLAS_MANIFEST_ROOT_TAG = "TextureAtlas";
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct AtlasSourceImage
+{
+	std::string m_filePath;
+	std::string m_stamp; //Size and last-write time, as CookedXML stamps its sources.
+	int m_pageIndex; //-1 if not atlased.
+	Vector2i m_mins; //Of the unpadded image within its page, in texels from the top-left.
+	Vector2i m_sizeInTexels;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct AtlasPageInfo
+{
+	std::string m_filePath;
+	Vector2i m_sizeInTexels;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+static std::map< std::string, TextureAtlasCell > s_cellsPerImagePath;
+static TextureAtlasStats s_atlasStats;
+
+
+//--------------------------------------------------------------------------------------------------------------
+struct SkylineSegment
+{
+	int m_x;
+	int m_y; //Top of the free space above this segment, growing down the page from row 0.
+	int m_width;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Bottom-left skyline packing: each rect goes wherever its bottom edge lands highest up the page, then leftmost.
+//Only the skyline's top edge is tracked, so space left under an overhang is lost, but sorting by height first keeps that small.
+class SkylinePage
+{
+public:
+	SkylinePage( int width, int height ) : m_width( width ), m_height( height ), m_usedSize( 0, 0 )
+	{
+		SkylineSegment wholePage = { 0, 0, width };
+		m_skyline.push_back( wholePage );
+	}
+
+	bool TryPlace( const Vector2i& size, Vector2i& out_mins );
+	const Vector2i& GetUsedSize() const { return m_usedSize; }
+
+
+private:
+	bool TryFitAtSegment( unsigned int segmentIndex, const Vector2i& size, int& out_y ) const;
+
+	int m_width;
+	int m_height;
+	Vector2i m_usedSize;
+	std::vector< SkylineSegment > m_skyline; //Left to right, always spanning the whole width.
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool SkylinePage::TryFitAtSegment( unsigned int segmentIndex, const Vector2i& size, int& out_y ) const
+{
+	int x = m_skyline[ segmentIndex ].m_x;
+	if ( x + size.x > m_width )
+		return false;
+
+	//Rests on the tallest segment it spans.
+	int y = 0;
+	int widthLeft = size.x;
+	for ( unsigned int spannedIndex = segmentIndex; widthLeft > 0; spannedIndex++ )
+	{
+		y = ( m_skyline[ spannedIndex ].m_y > y ) ? m_skyline[ spannedIndex ].m_y : y;
+		if ( y + size.y > m_height )
+			return false;
+
+		widthLeft -= m_skyline[ spannedIndex ].m_width;
+	}
+
+	out_y = y;
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool SkylinePage::TryPlace( const Vector2i& size, Vector2i& out_mins )
+{
+	int bestBottom = INT_MAX;
+	int bestSegmentIndex = -1;
+	for ( unsigned int segmentIndex = 0; segmentIndex < m_skyline.size(); segmentIndex++ )
+	{
+		int y;
+		if ( TryFitAtSegment( segmentIndex, size, y ) && ( y + size.y < bestBottom ) )
+		{
+			bestBottom = y + size.y;
+			bestSegmentIndex = (int)segmentIndex;
+			out_mins = Vector2i( m_skyline[ segmentIndex ].m_x, y );
+		}
+	}
+
+	if ( bestSegmentIndex < 0 )
+		return false;
+
+	SkylineSegment placed = { out_mins.x, bestBottom, size.x };
+	m_skyline.insert( m_skyline.begin() + bestSegmentIndex, placed );
+
+	//Trim or drop whatever the new segment now covers.
+	unsigned int coveredIndex = bestSegmentIndex + 1;
+	while ( coveredIndex < m_skyline.size() )
+	{
+		const SkylineSegment& previous = m_skyline[ coveredIndex - 1 ];
+		SkylineSegment& current = m_skyline[ coveredIndex ];
+		int overlap = ( previous.m_x + previous.m_width ) - current.m_x;
+		if ( overlap <= 0 )
+			break;
+
+		current.m_x += overlap;
+		current.m_width -= overlap;
+		if ( current.m_width > 0 )
+			break;
+
+		m_skyline.erase( m_skyline.begin() + coveredIndex );
+	}
+
+	//Merge neighbours at the same height, else the skyline fragments and later fits scan more segments.
+	for ( unsigned int segmentIndex = 1; segmentIndex < m_skyline.size(); )
+	{
+		if ( m_skyline[ segmentIndex - 1 ].m_y == m_skyline[ segmentIndex ].m_y )
+		{
+			m_skyline[ segmentIndex - 1 ].m_width += m_skyline[ segmentIndex ].m_width;
+			m_skyline.erase( m_skyline.begin() + segmentIndex );
+		}
+		else ++segmentIndex;
+	}
+
+	m_usedSize.x = ( out_mins.x + size.x > m_usedSize.x ) ? out_mins.x + size.x : m_usedSize.x;
+	m_usedSize.y = ( bestBottom > m_usedSize.y ) ? bestBottom : m_usedSize.y;
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static std::string GetCellKeyForPath( const std::string& imageFilePath )
+{
+	std::string key = GetAsLowercase( imageFilePath );
+	for ( char& c : key )
+	{
+		if ( c == '\\' )
+			c = '/';
+	}
+
+	return key;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static std::string GetSourceStamp( const std::string& filePath )
+{
+	struct __stat64 fileInfo;
+	if ( _stat64( filePath.c_str(), &fileInfo ) != 0 )
+		return std::string();
+
+	return Stringf( "%lld,%lld", (long long)fileInfo.st_mtime, (long long)fileInfo.st_size );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void GatherSourceImages( const std::string& directory, std::vector< AtlasSourceImage >& out_sources )
+{
+	std::vector< std::string > imagePaths = EnumerateFilesInDirectory( directory, "*.png" );
+	for ( const std::string& imagePath : imagePaths )
+	{
+		AtlasSourceImage source;
+		source.m_filePath = imagePath;
+		source.m_stamp = GetSourceStamp( imagePath );
+		source.m_pageIndex = -1;
+		source.m_mins = Vector2i( 0, 0 );
+		source.m_sizeInTexels = Vector2i( 0, 0 );
+		out_sources.push_back( source );
+	}
+
+	std::vector< std::string > subdirectories = EnumerateSubdirectoriesInDirectory( directory );
+	for ( const std::string& subdirectory : subdirectories )
+		GatherSourceImages( subdirectory, out_sources );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static std::string GetManifestPath()
+{
+	return Stringf( "%s/Atlas.Manifest.xml", COOKED_ATLAS_DIRECTORY );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static std::string GetPagePath( unsigned int pageIndex )
+{
+	return Stringf( "%s/Atlas.Page%u.png", COOKED_ATLAS_DIRECTORY, pageIndex );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void AddCells( const std::vector< AtlasSourceImage >& sources, const std::vector< Texture* >& pages )
+{
+	for ( const AtlasSourceImage& source : sources )
+	{
+		if ( source.m_pageIndex < 0 )
+			continue;
+
+		Texture* page = pages[ source.m_pageIndex ];
+		Vector2f pageSize( (float)page->GetWidth(), (float)page->GetHeight() );
+		Vector2f mins( (float)source.m_mins.x, (float)source.m_mins.y );
+		Vector2f maxs( (float)( source.m_mins.x + source.m_sizeInTexels.x ), (float)( source.m_mins.y + source.m_sizeInTexels.y ) );
+
+		TextureAtlasCell cell;
+		cell.m_page = page;
+		cell.m_texCoords = AABB2f( mins.x / pageSize.x, mins.y / pageSize.y, maxs.x / pageSize.x, maxs.y / pageSize.y );
+		cell.m_sizeInTexels = source.m_sizeInTexels;
+		s_cellsPerImagePath[ GetCellKeyForPath( source.m_filePath ) ] = cell;
+
+		++s_atlasStats.m_numCells;
+		s_atlasStats.m_numCellTexels += source.m_sizeInTexels.x * source.m_sizeInTexels.y;
+	}
+
+	s_atlasStats.m_numPages = pages.size();
+	for ( Texture* page : pages )
+		s_atlasStats.m_numPageTexels += page->GetWidth() * page->GetHeight();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Fails on anything that doesn't match what a fresh build would make from these exact sources.
+static bool TryLoadManifest( std::vector< AtlasSourceImage >& sources )
+{
+	if ( GetSourceStamp( GetManifestPath() ).empty() )
+		return false;
+
+	//Streamed rather than parsed into an XMLNode tree: with one Source per atlased image, the manifest grows with the game.
+	XMLStreamReader reader;
+	if ( !reader.OpenFile( GetManifestPath() ) || !reader.ReadToNextStartElement( ATLAS_MANIFEST_ROOT_TAG ) )
+		return false;
+
+	bool isSameConfig = ( reader.GetDepth() == 1 ) && ( reader.ReadAttribute( "version", 0u ) == ATLAS_MANIFEST_VERSION )
+		&& ( reader.ReadAttribute( "pageSize", 0 ) == ATLAS_PAGE_SIZE )
+		&& ( reader.ReadAttribute( "padding", -1 ) == ATLAS_CELL_PADDING )
+		&& ( reader.ReadAttribute( "maxImageSize", 0 ) == MAX_ATLASED_IMAGE_SIZE );
+	if ( !isSameConfig )
+		return false;
+
+	std::vector< AtlasPageInfo > pageInfos;
+	unsigned int sourceIndex = 0;
+	for ( ;; )
+	{
+		XMLStreamToken token = reader.ReadNext();
+		if ( token == XML_TOKEN_ERROR )
+			return false;
+
+		if ( ( token == XML_TOKEN_END_OF_DOCUMENT ) || ( ( token == XML_TOKEN_END_ELEMENT ) && ( reader.GetDepth() == 1 ) ) )
+			break;
+
+		if ( ( token != XML_TOKEN_START_ELEMENT ) || ( reader.GetDepth() != 2 ) )
+			continue;
+
+		if ( reader.GetName() == "Page" )
+		{
+			AtlasPageInfo pageInfo;
+			pageInfo.m_filePath = reader.ReadAttribute( "file", std::string() );
+			pageInfo.m_sizeInTexels = Vector2i( reader.ReadAttribute( "width", 0 ), reader.ReadAttribute( "height", 0 ) );
+			pageInfos.push_back( pageInfo );
+		}
+		else if ( reader.GetName() == "Source" )
+		{
+			//Both lists are sorted by path, so a source added, removed or touched shows up as a mismatch somewhere along here.
+			if ( sourceIndex >= sources.size() )
+				return false;
+
+			AtlasSourceImage& source = sources[ sourceIndex++ ];
+			if ( ( reader.GetAttribute( "image" ) != source.m_filePath ) || ( reader.GetAttribute( "stamp" ) != source.m_stamp ) )
+				return false;
+
+			source.m_pageIndex = reader.ReadAttribute( "page", -1 );
+			source.m_mins = Vector2i( reader.ReadAttribute( "x", 0 ), reader.ReadAttribute( "y", 0 ) );
+			source.m_sizeInTexels = Vector2i( reader.ReadAttribute( "width", 0 ), reader.ReadAttribute( "height", 0 ) );
+		}
+	}
+
+	if ( sourceIndex != sources.size() )
+		return false;
+
+	for ( const AtlasSourceImage& source : sources ) //Checked only now, since nothing makes Pages come before Sources.
+	{
+		if ( source.m_pageIndex >= (int)pageInfos.size() )
+			return false;
+	}
+
+	std::vector< Texture* > pages;
+	for ( const AtlasPageInfo& pageInfo : pageInfos )
+	{
+		Texture* page = Texture::CreateOrGetTexture( pageInfo.m_filePath );
+		if ( ( page == nullptr ) || ( page->GetTextureDimensions() != pageInfo.m_sizeInTexels ) )
+			return false;
+
+		pages.push_back( page );
+	}
+
+	AddCells( sources, pages );
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void WriteManifest( const std::vector< AtlasSourceImage >& sources, const std::vector< AtlasPageInfo >& pageInfos )
+{
+	XMLNode rootNode = XMLNode::createXMLTopNode( ATLAS_MANIFEST_ROOT_TAG );
+	rootNode.addAttribute( "version", Stringf( "%u", ATLAS_MANIFEST_VERSION ).c_str() );
+	rootNode.addAttribute( "pageSize", Stringf( "%d", ATLAS_PAGE_SIZE ).c_str() );
+	rootNode.addAttribute( "padding", Stringf( "%d", ATLAS_CELL_PADDING ).c_str() );
+	rootNode.addAttribute( "maxImageSize", Stringf( "%d", MAX_ATLASED_IMAGE_SIZE ).c_str() );
+
+	for ( const AtlasPageInfo& pageInfo : pageInfos )
+	{
+		XMLNode pageNode = rootNode.addChild( "Page" );
+		pageNode.addAttribute( "file", pageInfo.m_filePath.c_str() );
+		pageNode.addAttribute( "width", Stringf( "%d", pageInfo.m_sizeInTexels.x ).c_str() );
+		pageNode.addAttribute( "height", Stringf( "%d", pageInfo.m_sizeInTexels.y ).c_str() );
+	}
+
+	for ( const AtlasSourceImage& source : sources )
+	{
+		XMLNode sourceNode = rootNode.addChild( "Source" );
+		sourceNode.addAttribute( "image", source.m_filePath.c_str() );
+		sourceNode.addAttribute( "stamp", source.m_stamp.c_str() );
+		sourceNode.addAttribute( "page", Stringf( "%d", source.m_pageIndex ).c_str() );
+		if ( source.m_pageIndex < 0 )
+			continue;
+
+		sourceNode.addAttribute( "x", Stringf( "%d", source.m_mins.x ).c_str() );
+		sourceNode.addAttribute( "y", Stringf( "%d", source.m_mins.y ).c_str() );
+		sourceNode.addAttribute( "width", Stringf( "%d", source.m_sizeInTexels.x ).c_str() );
+		sourceNode.addAttribute( "height", Stringf( "%d", source.m_sizeInTexels.y ).c_str() );
+	}
+
+	if ( rootNode.writeToFile( GetManifestPath().c_str() ) != eXMLErrorNone )
+		Logger::PrintfWithTag( "TextureAtlas", "Failed to write %s, the atlas will be repacked next launch.", GetManifestPath().c_str() );
+
+	rootNode.deleteNodeContent();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Copies the image into its padded cell, clamping reads to its edges so the padding repeats the border texels.
+static void BlitExtrudedCell( const unsigned char* imagePixels, const Vector2i& imageSize, const Vector2i& cellMins, std::vector< unsigned char >& pagePixels, int pageWidth )
+{
+	for ( int paddedY = -ATLAS_CELL_PADDING; paddedY < imageSize.y + ATLAS_CELL_PADDING; paddedY++ )
+	{
+		int sourceY = ( paddedY < 0 ) ? 0 : ( ( paddedY >= imageSize.y ) ? imageSize.y - 1 : paddedY );
+		for ( int paddedX = -ATLAS_CELL_PADDING; paddedX < imageSize.x + ATLAS_CELL_PADDING; paddedX++ )
+		{
+			int sourceX = ( paddedX < 0 ) ? 0 : ( ( paddedX >= imageSize.x ) ? imageSize.x - 1 : paddedX );
+
+			const unsigned char* sourceTexel = imagePixels + ( ( ( sourceY * imageSize.x ) + sourceX ) * ATLAS_NUM_COMPONENTS );
+			unsigned char* pageTexel = pagePixels.data() + ( ( ( ( cellMins.y + paddedY ) * pageWidth ) + cellMins.x + paddedX ) * ATLAS_NUM_COMPONENTS );
+			memcpy( pageTexel, sourceTexel, ATLAS_NUM_COMPONENTS );
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void BuildAtlas( std::vector< AtlasSourceImage >& sources )
+{
+	//Tallest first, so each skyline row's overhangs stay small.
+	std::vector< AtlasSourceImage* > packingOrder;
+	for ( AtlasSourceImage& source : sources )
+	{
+		source.m_pageIndex = -1; //Could be left over from a manifest that failed partway.
+
+		int numComponents;
+		if ( !stbi_info( source.m_filePath.c_str(), &source.m_sizeInTexels.x, &source.m_sizeInTexels.y, &numComponents ) )
+			continue;
+
+		if ( ( source.m_sizeInTexels.x <= MAX_ATLASED_IMAGE_SIZE ) && ( source.m_sizeInTexels.y <= MAX_ATLASED_IMAGE_SIZE ) )
+			packingOrder.push_back( &source );
+	}
+
+	std::stable_sort( packingOrder.begin(), packingOrder.end(), []( const AtlasSourceImage* lhs, const AtlasSourceImage* rhs )
+	{
+		if ( lhs->m_sizeInTexels.y != rhs->m_sizeInTexels.y )
+			return lhs->m_sizeInTexels.y > rhs->m_sizeInTexels.y;
+		return lhs->m_sizeInTexels.x > rhs->m_sizeInTexels.x;
+	} );
+
+	std::vector< SkylinePage > skylinePages;
+	for ( AtlasSourceImage* source : packingOrder )
+	{
+		Vector2i paddedSize( source->m_sizeInTexels.x + ( 2 * ATLAS_CELL_PADDING ), source->m_sizeInTexels.y + ( 2 * ATLAS_CELL_PADDING ) );
+
+		Vector2i paddedMins;
+		unsigned int pageIndex = 0;
+		while ( ( pageIndex < skylinePages.size() ) && !skylinePages[ pageIndex ].TryPlace( paddedSize, paddedMins ) )
+			++pageIndex;
+
+		if ( pageIndex == skylinePages.size() ) //First-fit failed everywhere, start a new page.
+		{
+			skylinePages.push_back( SkylinePage( ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE ) );
+			bool didFit = skylinePages.back().TryPlace( paddedSize, paddedMins );
+			ASSERT_OR_DIE( didFit, "TextureAtlas image bigger than a page, lower MAX_ATLASED_IMAGE_SIZE!" );
+		}
+
+		source->m_pageIndex = (int)pageIndex;
+		source->m_mins = Vector2i( paddedMins.x + ATLAS_CELL_PADDING, paddedMins.y + ATLAS_CELL_PADDING );
+	}
+
+	_mkdir( COOKED_XML_DIRECTORY ); //Both fail harmlessly when they already exist.
+	_mkdir( COOKED_ATLAS_DIRECTORY );
+
+	std::vector< Texture* > pages;
+	std::vector< AtlasPageInfo > pageInfos;
+	for ( unsigned int pageIndex = 0; pageIndex < skylinePages.size(); pageIndex++ )
+	{
+		AtlasPageInfo pageInfo;
+		pageInfo.m_filePath = GetPagePath( pageIndex );
+		pageInfo.m_sizeInTexels = skylinePages[ pageIndex ].GetUsedSize();
+
+		std::vector< unsigned char > pagePixels( pageInfo.m_sizeInTexels.x * pageInfo.m_sizeInTexels.y * ATLAS_NUM_COMPONENTS, 0 );
+		for ( AtlasSourceImage* source : packingOrder )
+		{
+			if ( source->m_pageIndex != (int)pageIndex )
+				continue;
+
+			Vector2i loadedSize;
+			int numComponents;
+			unsigned char* imagePixels = stbi_load( source->m_filePath.c_str(), &loadedSize.x, &loadedSize.y, &numComponents, ATLAS_NUM_COMPONENTS );
+			if ( imagePixels == nullptr )
+			{
+				ERROR_RECOVERABLE( Stringf( "TextureAtlas failed to load %s, its cell will be blank!", source->m_filePath.c_str() ) );
+				continue;
+			}
+
+			BlitExtrudedCell( imagePixels, source->m_sizeInTexels, source->m_mins, pagePixels, pageInfo.m_sizeInTexels.x );
+			stbi_image_free( imagePixels );
+		}
+
+		if ( !stbi_write_png( pageInfo.m_filePath.c_str(), pageInfo.m_sizeInTexels.x, pageInfo.m_sizeInTexels.y, ATLAS_NUM_COMPONENTS, pagePixels.data(), pageInfo.m_sizeInTexels.x * ATLAS_NUM_COMPONENTS ) )
+			Logger::PrintfWithTag( "TextureAtlas", "Failed to write %s, the atlas will be repacked next launch.", pageInfo.m_filePath.c_str() );
+
+		//Named by its cache path, so later CreateOrGetTexture calls for the page find this one.
+		pages.push_back( Texture::CreateTextureFromBytes( pageInfo.m_filePath, pagePixels.data(), pageInfo.m_sizeInTexels, ATLAS_NUM_COMPONENTS ) );
+		pageInfos.push_back( pageInfo );
+	}
+
+	WriteManifest( sources, pageInfos );
+	AddCells( sources, pages );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void TextureAtlas::LoadOrBuild( const std::vector< std::string >& imageDirectories )
+{
+#ifdef TEXTURE_ATLASING_ENABLED
+	double startSeconds = GetCurrentTimeSeconds();
+
+	s_cellsPerImagePath.clear();
+	s_atlasStats.Clear();
+
+	std::vector< AtlasSourceImage > sources;
+	for ( const std::string& directory : imageDirectories )
+		GatherSourceImages( directory, sources );
+
+	std::sort( sources.begin(), sources.end(), []( const AtlasSourceImage& lhs, const AtlasSourceImage& rhs ) { return lhs.m_filePath < rhs.m_filePath; } );
+	s_atlasStats.m_numSourceImages = sources.size();
+
+	s_atlasStats.m_wasLoadedFromCache = TryLoadManifest( sources );
+	if ( !s_atlasStats.m_wasLoadedFromCache )
+		BuildAtlas( sources );
+
+	s_atlasStats.m_loadSeconds = GetCurrentTimeSeconds() - startSeconds;
+	Logger::PrintfWithTag( "TextureAtlas", "%s %u of %u images into %u pages in %.3fs.", s_atlasStats.m_wasLoadedFromCache ? "Loaded" : "Packed",
+						   s_atlasStats.m_numCells, s_atlasStats.m_numSourceImages, s_atlasStats.m_numPages, s_atlasStats.m_loadSeconds );
+#else
+	UNREFERENCED( imageDirectories );
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC const TextureAtlasCell* TextureAtlas::FindCell( const std::string& imageFilePath )
+{
+	if ( s_cellsPerImagePath.empty() )
+		return nullptr;
+
+	auto found = s_cellsPerImagePath.find( GetCellKeyForPath( imageFilePath ) );
+	return ( found != s_cellsPerImagePath.end() ) ? &found->second : nullptr;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC const TextureAtlasStats& TextureAtlas::GetStats()
+{
+	return s_atlasStats;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void TextureAtlas::PrintStats( Command& )
+{
+	float occupancy = ( s_atlasStats.m_numPageTexels > 0 ) ? ( 100.f * s_atlasStats.m_numCellTexels / s_atlasStats.m_numPageTexels ) : 0.f;
+	g_theConsole->Printf( "TextureAtlas: %u of %u images in %u pages, %.1f%% of page texels used.",
+						  s_atlasStats.m_numCells, s_atlasStats.m_numSourceImages, s_atlasStats.m_numPages, occupancy );
+	g_theConsole->Printf( "%s in %.3fs from %s.", s_atlasStats.m_wasLoadedFromCache ? "Loaded" : "Packed", s_atlasStats.m_loadSeconds, COOKED_ATLAS_DIRECTORY );
+}
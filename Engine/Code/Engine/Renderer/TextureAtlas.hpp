@@ -0,0 +1,52 @@
+#pragma once
+
+
+#include <string>
+#include <vector>
+#include "Engine/EngineCommon.hpp"
+
+
+//-----------------------------------------------------------------------------
+class Texture;
+class Command;
+
+
+//-----------------------------------------------------------------------------
+struct TextureAtlasCell
+{
+	Texture* m_page;
+	AABB2f m_texCoords; //Where the source image sits in m_page, mins top-left as with SpriteResource UVs.
+	Vector2i m_sizeInTexels; //The source image's, unpadded.
+};
+
+
+//-----------------------------------------------------------------------------
+struct TextureAtlasStats
+{
+	TextureAtlasStats() { Clear(); }
+	void Clear() { m_numSourceImages = m_numCells = m_numPages = m_numCellTexels = m_numPageTexels = 0; m_wasLoadedFromCache = false; m_loadSeconds = 0.0; }
+
+	unsigned int m_numSourceImages; //Including ones too big to atlas.
+	unsigned int m_numCells;
+	unsigned int m_numPages;
+	unsigned int m_numCellTexels; //Versus m_numPageTexels, how tightly the pages are packed.
+	unsigned int m_numPageTexels;
+	bool m_wasLoadedFromCache;
+	double m_loadSeconds;
+};
+
+
+//-----------------------------------------------------------------------------
+//Packs every small PNG under the given directories into a few page Textures with a skyline bottom-left packer, edges extruded into each cell's padding.
+//SpriteResources made from an atlased image draw from its page and cell UVs, so whole layers share one texture binding and batch.
+//Pages and a manifest of cells are cached under COOKED_ATLAS_DIRECTORY, stamped with every source's size and last-write time,
+//so later launches load the pages instead of decoding and repacking each image, until a source is added, removed or changed.
+class TextureAtlas
+{
+public:
+	static void LoadOrBuild( const std::vector< std::string >& imageDirectories ); //Main thread, before the SpriteResources are created. Searches subdirectories too.
+	static const TextureAtlasCell* FindCell( const std::string& imageFilePath ); //Null if it wasn't atlased, e.g. too big or atlasing is off.
+
+	static const TextureAtlasStats& GetStats();
+	static void PrintStats( Command& );
+};
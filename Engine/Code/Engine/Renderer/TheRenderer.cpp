@@ -24,6 +24,7 @@
 #include "Engine/String/StringUtils.hpp"
 #include "Engine/Math/AABB3.hpp"
 #include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Math/Matrix44.hpp"
 #include "Engine/Core/TheConsole.hpp"
 #include "Engine/Core/Command.hpp"
 #include "Engine/Error/ErrorWarningAssert.hpp"
@@ -46,6 +47,16 @@
 #include "Engine/Renderer/Skeleton.hpp"
 #include "Engine/Renderer/AnimationSequence.hpp"
 
+//Transient geometry
+#include "Engine/Renderer/TransientGeometryBuffer.hpp"
+#include "Engine/Renderer/TextLayoutCache.hpp"
+#include "Engine/Renderer/RenderStateCache.hpp"
+#include "Engine/Renderer/RenderQueue.hpp"
+#include "Engine/Renderer/SpriteInstanceBuffer.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+#include "Engine/Renderer/PostProcessGraph.hpp"
+#include "Engine/Renderer/DynamicResolution.hpp"
+
 
 //Minimize the amount of stalls from error checks we do. 
 //Could make wrapper around error variable to return a human-readable string rather than look it up.
@@ -107,6 +118,9 @@ TheRenderer* g_theRenderer = nullptr;
 //--------------------------------------------------------------------------------------------------------------
 //Class Static State Variables
 STATIC const float TheRenderer::DROP_SHADOW_OFFSET = 2.f;
+STATIC const unsigned int TheRenderer::TRANSIENT_VERTEX_BYTES_PER_FRAME = 2 * 1024 * 1024; //~87k Vertex3D_PCTs, a full console of glyphs is ~10k.
+STATIC const unsigned int TheRenderer::TRANSIENT_INDEX_BYTES_PER_FRAME = 1024 * 1024;
+STATIC const unsigned int TheRenderer::SPRITE_INSTANCE_BYTES_PER_FRAME = 1024 * 1024; //~26k SpriteInstances.
 STATIC const unsigned int TheRenderer::DEFAULT_TEXTURE_ID = 1;
 STATIC const unsigned int TheRenderer::DEFAULT_SAMPLER_ID = 1;
 STATIC const RenderState TheRenderer::DEFAULT_RENDER_STATE_3D = RenderState( CULL_MODE_NONE/*FOR_VR*/, BLEND_MODE_SOURCE_ALPHA, BLEND_MODE_ONE_MINUS_SOURCE_ALPHA, DEPTH_COMPARE_MODE_LESS, true );
@@ -137,6 +151,13 @@ void TheRenderer::CreateBuiltInDefaults()
 	s_defaultMaterial2D->SetMatrix4x4( "uView", false, &Matrix4x4f::IDENTITY ); //Remember screen space == NDC coordinates.
 
 	s_defaultRenderer = new STATIC MeshRenderer( nullptr, nullptr );
+
+	m_transientGeometry = new TransientGeometryBuffer( DEFAULT_RENDERER_VERTEX_DEFINITION, TRANSIENT_VERTEX_BYTES_PER_FRAME, TRANSIENT_INDEX_BYTES_PER_FRAME );
+	m_numBuffersCreatedAtFrameStart = VertexBuffer::GetNumBuffersCreated();
+
+	m_textLayoutCache = new TextLayoutCache( DROP_SHADOW_OFFSET );
+
+	m_renderQueue = new RenderQueue( TRANSIENT_VERTEX_BYTES_PER_FRAME, TRANSIENT_INDEX_BYTES_PER_FRAME, SPRITE_INSTANCE_BYTES_PER_FRAME );
 }
 
 
@@ -195,6 +216,171 @@ static void ToggleAxes( Command& )
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+static void ShowTransientGeometryStats( Command& )
+{
+	const TransientGeometryBuffer* transientGeometry = g_theRenderer->GetTransientGeometry();
+	const TransientGeometryStats& stats = transientGeometry->GetLastFrameStats();
+
+	g_theConsole->Printf( "Last frame's immediate-mode draws (batching %s):", transientGeometry->IsBatchingEnabled() ? "on" : "off" );
+	g_theConsole->Printf( "  GL buffers created: %u", g_theRenderer->GetNumBuffersCreatedLastFrame() );
+	g_theConsole->Printf( "  Draws submitted: %u, draw calls issued: %u", stats.m_numDrawsSubmitted, stats.m_numDrawCallsIssued );
+	g_theConsole->Printf( "  Oversized draws split: %u, drawn through their own Mesh: %u", stats.m_numSplitDraws, stats.m_numOversizedDraws );
+	g_theConsole->Printf( "  Orphans: %u, fence misses: %u", stats.m_numOrphans, stats.m_numFenceMisses );
+	g_theConsole->Printf( "  Uploaded: %u / %u bytes", stats.m_numBytesUploaded, transientGeometry->GetVertexBytesPerFrame() + transientGeometry->GetIndexBytesPerFrame() );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void ShowTextLayoutStats( Command& )
+{
+	const TextLayoutCache* textLayoutCache = g_theRenderer->GetTextLayoutCache();
+	const TextLayoutCacheStats& stats = textLayoutCache->GetLastFrameStats();
+
+	g_theConsole->Printf( "Last frame's DrawTextProportional2D layouts:" );
+	g_theConsole->Printf( "  Cache hits: %u, misses: %u", stats.m_numHits, stats.m_numMisses );
+	g_theConsole->Printf( "  Cached layouts: %u, evicted: %u", textLayoutCache->GetNumCachedLayouts(), stats.m_numEvictions );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void ShowUniformCacheStats( Command& )
+{
+	const UniformCacheStats& stats = ShaderProgram::GetLastFrameUniformStats();
+
+	g_theConsole->Printf( "Last frame's uniform sets:" );
+	g_theConsole->Printf( "  Set calls: %u, redundant (skipped): %u", stats.m_numSetCalls, stats.m_numRedundantSets );
+	g_theConsole->Printf( "  glUniform* uploads at Material::Bind: %u", stats.m_numUploads );
+	g_theConsole->Printf( "  GL calls avoided vs. uploading per set: %u", stats.GetNumGLCallsAvoided() );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void ShowRenderStateStats( Command& )
+{
+	const RenderStateCacheStats& stats = RenderStateCache::GetLastFrameStats();
+
+	unsigned int totalIssued = 0;
+	unsigned int totalSkipped = 0;
+	g_theConsole->Printf( "Last frame's GL state changes, issued / skipped as redundant:" );
+	for ( int typeIndex = 0; typeIndex < NUM_STATE_CHANGE_TYPES; typeIndex++ )
+	{
+		RenderStateChangeType type = (RenderStateChangeType)typeIndex;
+		g_theConsole->Printf( "  %s: %u / %u", RenderStateCache::GetStateChangeTypeName( type ), stats.m_numIssued[ type ], stats.m_numSkipped[ type ] );
+		totalIssued += stats.m_numIssued[ type ];
+		totalSkipped += stats.m_numSkipped[ type ];
+	}
+	g_theConsole->Printf( "  Total: %u / %u", totalIssued, totalSkipped );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void ShowRenderQueueStats( Command& )
+{
+	const RenderQueueStats& stats = g_theRenderer->GetRenderQueue()->GetLastSubmitStats();
+
+	g_theConsole->Printf( "Last render queue submit:" );
+	g_theConsole->Printf( "  Packets: %u, from %u command buffers", stats.m_numPackets, stats.m_numCommandBuffers );
+	g_theConsole->Printf( "  Instanced packets: %u, holding %u instances", stats.m_numInstancedPackets, stats.m_numInstances );
+	g_theConsole->Printf( "  Material changes: %u, texture changes: %u, uniform block changes: %u", stats.m_numMaterialChanges, stats.m_numTextureChanges, stats.m_numUniformBlockChanges );
+	g_theConsole->Printf( "  Oversized packets drawn through their own Mesh: %u", stats.m_numOversizedPackets );
+	g_theConsole->Printf( "  Sort: %.3fms, sort and submit: %.3fms", stats.m_sortSeconds * 1000.0, stats.m_submitSeconds * 1000.0 );
+
+	const SpriteInstanceStats& instanceStats = g_theRenderer->GetRenderQueue()->GetSpriteInstances()->GetLastFrameStats();
+	g_theConsole->Printf( "Last frame's sprite instancing:" );
+	g_theConsole->Printf( "  Draws submitted: %u, draw calls issued: %u, instances drawn: %u", instanceStats.m_numDrawsSubmitted, instanceStats.m_numDrawCallsIssued, instanceStats.m_numInstancesDrawn );
+	g_theConsole->Printf( "  Bytes uploaded: %u (%u a sprite, versus %u as transient vertices and indices)", instanceStats.m_numBytesUploaded,
+						  (unsigned int)sizeof( SpriteInstance ), (unsigned int)( ( 4 * sizeof( Vertex2D_PCT ) ) + ( 6 * sizeof( unsigned int ) ) ) );
+	g_theConsole->Printf( "  Oversized draws split: %u, orphans: %u, fence misses: %u", instanceStats.m_numSplitDraws, instanceStats.m_numOrphans, instanceStats.m_numFenceMisses );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void PostProcessAddEffect( Command& args )
+{
+	std::string effectName;
+	if ( !args.GetNextString( &effectName ) || effectName.empty() )
+	{
+		g_theConsole->Printf( "Usage: PostProcessAddEffect <Grayscale|Negative|Sepia|Vignette|any FramebufferEffect's shader program>" );
+		return;
+	}
+
+	PostProcessGraph* graph = g_theRenderer->GetPostProcessGraph();
+	if ( !graph->AddEffect( effectName ) )
+	{
+		g_theConsole->Printf( "No per-pixel or FramebufferEffect named %s.", effectName.c_str() );
+		return;
+	}
+	g_theConsole->Printf( "Added %s: %u effects in %u passes.", effectName.c_str(), graph->GetNumEffects(), graph->GetNumPasses() );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void TogglePostProcessFusion( Command& )
+{
+	PostProcessGraph* graph = g_theRenderer->GetPostProcessGraph();
+	graph->SetFusionEnabled( !graph->IsFusionEnabled() );
+	g_theConsole->Printf( "Post-process fusion %s: %u effects in %u passes.", graph->IsFusionEnabled() ? "enabled" : "disabled", graph->GetNumEffects(), graph->GetNumPasses() );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void SetDynamicResolution( Command& args )
+{
+	DynamicResolutionController* dynamicResolution = g_theRenderer->GetDynamicResolution();
+
+	float targetFrameMs;
+	float minScale;
+	args.GetNextFloat( &targetFrameMs, 0.f );
+	args.GetNextFloat( &minScale, dynamicResolution->GetMinScale() );
+	if ( targetFrameMs < 0.f || minScale <= 0.f || minScale > 1.f )
+	{
+		g_theConsole->Printf( "Usage: DynamicResolution <targetMs, 0 for off> [0 < minScale <= 1]" );
+		return;
+	}
+
+	dynamicResolution->SetEnabled( targetFrameMs > 0.f );
+	if ( !dynamicResolution->IsEnabled() )
+	{
+		g_theConsole->Printf( "Dynamic resolution disabled." );
+		return;
+	}
+
+	dynamicResolution->SetTargetFrameMs( targetFrameMs );
+	dynamicResolution->SetScaleLimits( minScale, 1.f );
+	g_theConsole->Printf( "Dynamic resolution targeting %.2fms, scale %.3f to %.3f, timed by the %s.", targetFrameMs, dynamicResolution->GetMinScale(), dynamicResolution->GetMaxScale(),
+						  dynamicResolution->IsUsingGpuTimer() ? "GPU" : "CPU frame" );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void ShowPostProcessStats( Command& )
+{
+	PostProcessGraph* graph = g_theRenderer->GetPostProcessGraph();
+	const RenderTargetPool* pool = graph->GetTargetPool();
+	const DynamicResolutionController* dynamicResolution = g_theRenderer->GetDynamicResolution();
+
+	g_theConsole->Printf( "Post-process graph %s:", g_theRenderer->IsPostProcessGraphActive() ? "active" : "inactive" );
+	for ( unsigned int effectIndex = 0; effectIndex < graph->GetNumEffects(); effectIndex++ )
+		g_theConsole->Printf( "  %u: %s", effectIndex, graph->GetEffectName( effectIndex ).c_str() );
+	g_theConsole->Printf( "  Passes: %u, fusion %s", graph->GetNumPasses(), graph->IsFusionEnabled() ? "on" : "off" );
+	g_theConsole->Printf( "  Pooled targets: %u (%u in use), %u KB, %u acquires reused", pool->GetNumTargets(), pool->GetNumTargetsInUse(),
+						  (unsigned int)( pool->GetTargetBytes() / 1024 ), pool->GetNumAcquiresReused() );
+	g_theConsole->Printf( "  Dynamic resolution %s: scale %.3f, %.2fms smoothed against %.2fms by the %s, %u changes", dynamicResolution->IsEnabled() ? "on" : "off",
+						  g_theRenderer->GetSceneResolutionScale(), dynamicResolution->GetSmoothedFrameMs(), dynamicResolution->GetTargetFrameMs(),
+						  dynamicResolution->IsUsingGpuTimer() ? "GPU" : "CPU frame", dynamicResolution->GetNumScaleChanges() );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void ToggleTransientGeometryBatching( Command& )
+{
+	TransientGeometryBuffer* transientGeometry = g_theRenderer->GetTransientGeometry();
+	transientGeometry->SetBatchingEnabled( !transientGeometry->IsBatchingEnabled() );
+	g_theConsole->Printf( "Immediate-mode draw batching %s.", transientGeometry->IsBatchingEnabled() ? "enabled" : "disabled" );
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 static void GenerateSurfacePatchByIndex( Command& args )
 {
@@ -1153,6 +1339,27 @@ static void RegisterConsoleCommands()
 	g_theConsole->RegisterCommand( "AnimationTogglePause", AnimationTogglePause );
 	g_theConsole->RegisterCommand( "ClearSkeletons", []( Command& ) { g_theRenderer->DeleteSkeletons(); } );
 	g_theConsole->RegisterCommand( "ClearAnimations", []( Command& ) { g_theRenderer->DeleteAnimations(); } );
+
+	//Transient geometry
+	g_theConsole->RegisterCommand( "TransientGeometryStats", ShowTransientGeometryStats );
+	g_theConsole->RegisterCommand( "ToggleTransientGeometryBatching", ToggleTransientGeometryBatching );
+	g_theConsole->RegisterCommand( "TextLayoutStats", ShowTextLayoutStats );
+
+	//Uniforms
+	g_theConsole->RegisterCommand( "UniformCacheStats", ShowUniformCacheStats );
+
+	//Render state
+	g_theConsole->RegisterCommand( "RenderStateStats", ShowRenderStateStats );
+	g_theConsole->RegisterCommand( "RenderQueueStats", ShowRenderQueueStats );
+
+	//Post-process
+	g_theConsole->RegisterCommand( "PostProcessAddEffect", PostProcessAddEffect );
+	g_theConsole->RegisterCommand( "PostProcessClearEffects", []( Command& ) { g_theRenderer->GetPostProcessGraph()->ClearEffects(); } );
+	g_theConsole->RegisterCommand( "TogglePostProcessFusion", TogglePostProcessFusion );
+	g_theConsole->RegisterCommand( "PostProcessStats", ShowPostProcessStats );
+	g_theConsole->RegisterCommand( "PostProcessTest", PostProcessTest );
+	g_theConsole->RegisterCommand( "DynamicResolution", SetDynamicResolution );
+	g_theConsole->RegisterCommand( "DynamicResolutionTest", DynamicResolutionTest );
 }
 #pragma endregion
 
@@ -1224,6 +1431,8 @@ void TheRenderer::RiftStartup()
 	glFramebufferRenderbuffer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, 0);
 	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
 
+	RenderStateCache::Invalidate(); //RiftUtils' swap chain setup binds textures behind the cache's back.
+
 	//Kill V-sync for OVR's compositor.
 	//wglSwapIntervalEXT(0);
 	TODO( "Not necessary? What was the benefit to this?" );
@@ -1509,6 +1718,10 @@ void TheRenderer::InitializeFBOs()
 
 	m_lastNonDefaultFBO = new FrameBuffer( m_screenWidthAsUnsignedInt, m_screenHeightAsUnsignedInt, colorFormats, &depthStencilFormat );
 
+	//Post-process graph, sharing the quad. Dynamic resolution starts off, capped at native.
+	m_postProcessGraph = new PostProcessGraph( m_defaultFboQuad );
+	m_dynamicResolution = new DynamicResolutionController( 16.6f, .5f, 1.f );
+
 #ifdef RENDER_2D_ON_WORLD_QUAD
 	//FBO:
 	const unsigned int RENDER2D_QUAD_WIDTH = m_screenWidthAsUnsignedInt;
@@ -1563,7 +1776,19 @@ TheRenderer::TheRenderer( double screenWidth, double screenHeight )
 	, m_defaultProportionalFont( nullptr )
 	, m_defaultSampler( nullptr )
 	, m_defaultTexture( nullptr )
-	, m_usingDefaultNullFBO( true )
+	, m_boundFBO( nullptr )
+	, m_currentLineWidth( 1.5f )
+	, m_currentPointSize( 1.f )
+	, m_transientGeometry( nullptr )
+	, m_numBuffersCreatedAtFrameStart( 0 )
+	, m_numBuffersCreatedLastFrame( 0 )
+	, m_textLayoutCache( nullptr )
+	, m_renderQueue( nullptr )
+	, m_postProcessGraph( nullptr )
+	, m_dynamicResolution( nullptr )
+	, m_postProcessSceneTarget( nullptr )
+	, m_postProcessSceneWidth( 0 )
+	, m_postProcessSceneHeight( 0 )
 {
 	SetScreenDimensions( screenWidth, screenHeight );
 
@@ -1571,11 +1796,29 @@ TheRenderer::TheRenderer( double screenWidth, double screenHeight )
 	DebuggerPrintf( "OpenGL Version is: %s\n", glGetString( GL_VERSION ) );
 	DebuggerPrintf( "GLSL Version is: %s\n", glGetString( GL_SHADING_LANGUAGE_VERSION ) );
 
+#ifdef ENGINE_HEADLESS
+	BindNullOpenGLExtensions(); //No context to query, see OpenGLExtensions.hpp.
+#else
 	//Managing VBOs.
 	glGenBuffers = (PFNGLGENBUFFERSPROC)wglGetProcAddress( "glGenBuffers" );
 	glBindBuffer = (PFNGLBINDBUFFERPROC)wglGetProcAddress( "glBindBuffer" );
 	glBufferData = (PFNGLBUFFERDATAPROC)wglGetProcAddress( "glBufferData" );
 	glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)wglGetProcAddress( "glDeleteBuffers" );
+	glBufferSubData = (PFNGLBUFFERSUBDATAPROC)wglGetProcAddress( "glBufferSubData" );
+	glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC)wglGetProcAddress( "glMapBufferRange" );
+	glUnmapBuffer = (PFNGLUNMAPBUFFERPROC)wglGetProcAddress( "glUnmapBuffer" );
+
+	//Fences.
+	glFenceSync = (PFNGLFENCESYNCPROC)wglGetProcAddress( "glFenceSync" );
+	glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)wglGetProcAddress( "glClientWaitSync" );
+	glDeleteSync = (PFNGLDELETESYNCPROC)wglGetProcAddress( "glDeleteSync" );
+
+	//Timer queries, core since 3.3.
+	glGenQueries = (PFNGLGENQUERIESPROC)wglGetProcAddress( "glGenQueries" );
+	glDeleteQueries = (PFNGLDELETEQUERIESPROC)wglGetProcAddress( "glDeleteQueries" );
+	glQueryCounter = (PFNGLQUERYCOUNTERPROC)wglGetProcAddress( "glQueryCounter" );
+	glGetQueryObjectiv = (PFNGLGETQUERYOBJECTIVPROC)wglGetProcAddress( "glGetQueryObjectiv" );
+	glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)wglGetProcAddress( "glGetQueryObjectui64v" );
 	
 	//Loading a shader.
 	glCreateShader = (PFNGLCREATESHADERPROC)wglGetProcAddress( "glCreateShader" );
@@ -1608,6 +1851,8 @@ TheRenderer::TheRenderer( double screenWidth, double screenHeight )
 
 	//Drawing. Already have glDrawArrays.
 	glUseProgram = (PFNGLUSEPROGRAMPROC)wglGetProcAddress( "glUseProgram" );
+	glDrawElementsInstanced = (PFNGLDRAWELEMENTSINSTANCEDPROC)wglGetProcAddress( "glDrawElementsInstanced" );
+	glVertexAttribDivisor = (PFNGLVERTEXATTRIBDIVISORPROC)wglGetProcAddress( "glVertexAttribDivisor" );
 
 	//Uniforms.
 	glGetUniformLocation = (PFNGLGETUNIFORMLOCATIONPROC)wglGetProcAddress( "glGetUniformLocation" );
@@ -1642,11 +1887,13 @@ TheRenderer::TheRenderer( double screenWidth, double screenHeight )
 	glGenerateMipmap = (PFNGLGENERATEMIPMAPPROC)wglGetProcAddress("glGenerateMipmap");
 	glFramebufferTexture2D = (PFNGLFRAMEBUFFERTEXTURE2DPROC)wglGetProcAddress("glFramebufferTexture2D");
 	glFramebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)wglGetProcAddress("glFramebufferRenderbuffer");
+#endif
 
-	glEnable( GL_BLEND );
-	glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	RenderStateCache::Invalidate(); //Needs the extensions loaded, and must precede any binds below.
+	RenderStateCache::SetCapability( GL_BLEND, true );
+	RenderStateCache::BlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 	glEnable( GL_LINE_SMOOTH );
-	glLineWidth( 1.5f );
+	glLineWidth( m_currentLineWidth );
 
 	CreateBuiltInDefaults(); //Ensure this is first to give defaults the first possible texture IDs.
 }
@@ -1661,6 +1908,8 @@ TheRenderer::~TheRenderer()
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::ClearScreenToColor( const Rgba& colorToClearTo )
 {
+	FlushImmediateDraws();
+
 	//Only seems to take floats, not uchar values. Better to pack with uchar, but costs to range map back.
 	float red = Interpolate( 0.f, 1.f, ( static_cast<float>( colorToClearTo.red ) / 255.f ) );
 	float green = Interpolate( 0.f, 1.f, ( static_cast<float>( colorToClearTo.green ) / 255.f ) );
@@ -1675,6 +1924,8 @@ void TheRenderer::ClearScreenToColor( const Rgba& colorToClearTo )
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::ClearScreenToColor( float red, float green, float blue )
 {
+	FlushImmediateDraws();
+
 	glClearColor( red, green, blue, 1.f );
 
 	glClear( GL_COLOR_BUFFER_BIT );
@@ -1684,7 +1935,9 @@ void TheRenderer::ClearScreenToColor( float red, float green, float blue )
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::ClearScreenDepthBuffer()
 {
-	glDepthMask( true );
+	FlushImmediateDraws();
+
+	RenderStateCache::DepthMask( true );
 	glClearDepth( 1.f ); //Says push all pixels to maximum far-away so that any pixel will be closer now, this is normalized 0-1.
 	glClear( GL_DEPTH_BUFFER_BIT );
 }
@@ -1693,13 +1946,16 @@ void TheRenderer::ClearScreenDepthBuffer()
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::EnableDepthTesting( bool flagValue )
 {
-	if ( flagValue ) glEnable( GL_DEPTH_TEST );
-	else glDisable( GL_DEPTH_TEST );
+	FlushImmediateDraws();
+
+	RenderStateCache::SetCapability( GL_DEPTH_TEST, flagValue );
 }
 
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::EnableAlphaTesting( bool flagValue )
 {
+	FlushImmediateDraws();
+
 	if ( flagValue ) glEnable( GL_ALPHA_TEST );
 	else glDisable( GL_ALPHA_TEST );
 }
@@ -1708,6 +1964,8 @@ void TheRenderer::EnableAlphaTesting( bool flagValue )
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::SetAlphaFunc( int alphaComparatorFunction, float alphaComparatorValue )
 {
+	FlushImmediateDraws();
+
 	glAlphaFunc( alphaComparatorFunction, alphaComparatorValue );
 }
 
@@ -1715,8 +1973,9 @@ void TheRenderer::SetAlphaFunc( int alphaComparatorFunction, float alphaComparat
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::EnableBackfaceCulling( bool flagValue )
 {
-	if ( flagValue ) glEnable( GL_CULL_FACE );
-	else glDisable( GL_CULL_FACE );
+	FlushImmediateDraws();
+
+	RenderStateCache::SetCapability( GL_CULL_FACE, flagValue );
 }
 
 
@@ -1725,7 +1984,12 @@ void TheRenderer::DrawVbo_PCT( unsigned int vboID, int numVerts, VertexGroupingR
 {
 	if ( numVerts == 0 ) return;
 
-	glBindBuffer( GL_ARRAY_BUFFER, vboID );
+	FlushImmediateDraws();
+
+	//Fixed-function path: a program or VAO left bound by the last draw would hijack the client-state arrays below.
+	RenderStateCache::UseProgram( 0 );
+	RenderStateCache::BindVertexArray( 0 );
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, vboID );
 
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glEnableClientState( GL_COLOR_ARRAY );
@@ -1741,8 +2005,6 @@ void TheRenderer::DrawVbo_PCT( unsigned int vboID, int numVerts, VertexGroupingR
 	glDisableClientState( GL_COLOR_ARRAY );
 	glDisableClientState( GL_TEXTURE_COORD_ARRAY );
 
-	glBindBuffer( GL_ARRAY_BUFFER, 0 );
-
 	UnbindTexture();
 }
 
@@ -1750,18 +2012,20 @@ void TheRenderer::DrawVbo_PCT( unsigned int vboID, int numVerts, VertexGroupingR
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::BindFBO( FrameBuffer* fbo, bool overwriteLast /*= true*/ )
 {
-	if ( ( m_usingDefaultNullFBO && fbo == nullptr ) || ( !m_usingDefaultNullFBO && m_lastNonDefaultFBO == fbo ) )
+	if ( m_boundFBO == fbo )
 		return; //Already bound.
 
+	FlushImmediateDraws();
+
 	if ( fbo == nullptr )
 	{
-		m_usingDefaultNullFBO = true;
+		m_boundFBO = nullptr;
 		glBindFramebuffer( GL_FRAMEBUFFER, NULL ); //Default.
 		glViewport( 0, 0, m_screenWidthAsUnsignedInt, m_screenHeightAsUnsignedInt );
 	}
 	else
 	{
-		m_usingDefaultNullFBO = false;
+		m_boundFBO = fbo;
 		if ( overwriteLast )
 			m_lastNonDefaultFBO = fbo; //Else we'd try to set FBO uniforms on the default nullptr FBO.
 		glBindFramebuffer( GL_FRAMEBUFFER, fbo->GetFrameBufferID() ); //WARNING: calling this line repeatedly induces rapid flicker. Solve by binding null before/after.
@@ -1793,6 +2057,8 @@ void TheRenderer::BindFBO( FrameBuffer* fbo, bool overwriteLast /*= true*/ )
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::CopyFBO( FrameBuffer* sourceFBO, FrameBuffer* targetFBO /*= nullptr*/ )
 {
+	FlushImmediateDraws();
+
 	if ( sourceFBO == nullptr )
 		return;
 
@@ -1828,34 +2094,50 @@ void TheRenderer::SetDrawColor( float red, float green, float blue, float opacit
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::SetLineWidth( float newLineWidth )
 {
+	if ( newLineWidth == m_currentLineWidth )
+		return;
+
+	FlushImmediateDraws();
 	glLineWidth( newLineWidth );
+	m_currentLineWidth = newLineWidth;
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::SetBlendFunc( int sourceBlend, int destinationBlend )
 {
-	glBlendFunc( sourceBlend, destinationBlend );
+	FlushImmediateDraws();
+
+	RenderStateCache::BlendFunc( sourceBlend, destinationBlend );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::SetRenderFlag( int flagNameToSet )
 {
-	glEnable( flagNameToSet );
+	FlushImmediateDraws();
+
+	RenderStateCache::SetCapability( flagNameToSet, true );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::SetPointSize( float thickness )
 {
+	if ( thickness == m_currentPointSize )
+		return;
+
+	FlushImmediateDraws();
 	glPointSize( thickness );
+	m_currentPointSize = thickness;
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::SetOrtho( const Vector2f& bottomLeft, const Vector2f& topRight )
 {
+	FlushImmediateDraws();
+
 	Matrix4x4f ortho( COLUMN_MAJOR );
 	ortho.ClearToOrthogonalProjection( bottomLeft.x, topRight.x, bottomLeft.y, topRight.y, -1.f, 1.f, ortho.GetOrdering() );
 	s_defaultMaterial2D->SetMatrix4x4( "uProj", false, &ortho ); //Don't transpose. Shader order is v*M*V*P.
@@ -1865,6 +2147,8 @@ void TheRenderer::SetOrtho( const Vector2f& bottomLeft, const Vector2f& topRight
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::SetPerspective( float fovDegreesY, float aspect, float nearDist, float farDist )
 {
+	FlushImmediateDraws();
+
 	Matrix4x4f persp( COLUMN_MAJOR );
 	persp.ClearToPerspectiveProjection( GetWorldChangeOfBasis( COLUMN_MAJOR ), fovDegreesY, aspect, nearDist, farDist, persp.GetOrdering() );
 	for ( const ShaderProgramRegistryPair& shaderPair : *ShaderProgram::GetRegistry() )
@@ -1877,7 +2161,7 @@ void TheRenderer::SetPerspective( float fovDegreesY, float aspect, float nearDis
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::DrawPoint( const Vector3f& position, float thickness, const Rgba& color /*= Rgba() */ )
 {
-	glPointSize( thickness );
+	SetPointSize( thickness );
 
 	UnbindTexture();
 
@@ -1889,7 +2173,7 @@ void TheRenderer::DrawPoint( const Vector3f& position, float thickness, const Rg
 void TheRenderer::DrawLine( const Vector2f& startPos, const Vector2f& endPos, 
 	const Rgba& startColor /*=Rgba()*/, const Rgba& endColor /*=Rgba()*/, float lineThickness /*= 1.f */ )
 {
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 	UnbindTexture();
 
@@ -1902,7 +2186,7 @@ void TheRenderer::DrawLine( const Vector2f& startPos, const Vector2f& endPos,
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::DrawLine( const Vector3f& startPos, const Vector3f& endPos, const Rgba& startColor /*= Rgba()*/, const Rgba& endColor /*= Rgba()*/, float lineThickness /*= 1.f */ )
 {
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 	UnbindTexture();
 
@@ -1918,7 +2202,7 @@ void TheRenderer::DrawAABB( const int vertexGroupingRule, const AABB3f& bounds,
 
 	glColor4ub( tint.red, tint.green, tint.blue, tint.alphaOpacity );
 
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 	Vertex3D_PCT vertexes[24];
 
@@ -1995,7 +2279,7 @@ void TheRenderer::DrawAABB( const int vertexGroupingRule, const AABB3f& bounds,
 void TheRenderer::DrawAABB( const int vertexGroupingRule, const AABB2f& bounds, const Texture& texture,
 	const AABB2f& texCoords /*= AABB2f(0,0,1,1)*/, const Rgba& tint  /*=Rgba()*/, float lineThickness /*= 1.f*/ )
 {
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 	s_defaultMaterial2D->SetTexture( "uTexDiffuse", texture.GetTextureID() );
 
@@ -2025,7 +2309,7 @@ void TheRenderer::DrawAABB( const int vertexGroupingRule, const AABB2f& bounds,
 {
 	UnbindTexture();
 	
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 	Vertex3D_PCT vertexes[] =
 	{
@@ -2050,7 +2334,7 @@ void TheRenderer::DrawAABB( const int vertexGroupingRule, const AABB3f& bounds,
 {
 	UnbindTexture();
 
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 
 	Vertex3D_PCT vertexes[24];
@@ -2125,7 +2409,7 @@ void TheRenderer::DrawShadedAABB( const int vertexGroupingRule, const AABB2f& bo
 {
 	UnbindTexture();
 
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 	//Note that previous color-darkening was caused by not setting materials' uTexDiffuse in UnbindTexture (color was * stone tex instead of PlainWhite tex).
 	Vertex3D_PCT vertexes[] =
@@ -2151,7 +2435,7 @@ void TheRenderer::DrawShadedAABB( const int vertexGroupingRule, const AABB3f& bo
 {
 	UnbindTexture();
 
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 	Vertex3D_PCT vertexes[ 24 ];
 
@@ -2225,7 +2509,7 @@ void TheRenderer::DrawQuad( const int vertexGroupingRule, const Vector2f& topLef
 {
 	UnbindTexture();
 
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 	Vertex3D_PCT vertexes[] =
 	{
@@ -2255,7 +2539,7 @@ void TheRenderer::DrawPolygon( const int vertexGroupingRule, const Vector2f& cen
 
 	UnbindTexture();
 
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 	for ( float radians = 0.f; radians < radiansTotal; radians += radiansPerSide ) {
 		float rotatedRadians = radians + ConvertDegreesToRadians( degreesOffset );
@@ -2316,7 +2600,7 @@ float TheRenderer::CalcTextPxWidthUpToIndex( const std::string& inputText, unsig
 		float kerningAmount; //BMFont only does kerning horizontally.
 		if ( previousGlyph != nullptr )
 		{
-			kerningAmount = previousGlyph->GetKerning( currentGlyph->m_id );
+			kerningAmount = font->GetKerning( *previousGlyph, *currentGlyph );
 			cursor.x += ( kerningAmount * scale );
 		}
 
@@ -2382,7 +2666,7 @@ void TheRenderer::DrawTextProportional3D( const Vector3f& lowerLeftOriginPos, co
 		float kerningAmount; //BMFont only does kerning horizontally.
 		if ( previousGlyph != nullptr )
 		{
-			kerningAmount = previousGlyph->GetKerning( currentGlyph->m_id );
+			kerningAmount = font->GetKerning( *previousGlyph, *currentGlyph );
 			cursor += ( textPlaneRightDir * kerningAmount * scale ); //	+ ( kerning.y * scale );
 		}
 
@@ -2397,7 +2681,7 @@ void TheRenderer::DrawTextProportional3D( const Vector3f& lowerLeftOriginPos, co
 
 		AABB3f renderBounds = AABB3f( bottomLeftCorner, topRightCorner );
 
-		AABB2f texCoords = font->GetTexCoordsForGlyph( currentGlyph->m_id );
+		const AABB2f& texCoords = font->GetTexCoordsForGlyph( *currentGlyph );
 
 		Texture* texture = font->GetFontTexture( currentGlyph->m_page );
 
@@ -2424,53 +2708,25 @@ void TheRenderer::DrawTextProportional2D( const Vector2f& lowerLeftOriginPos, co
 	if ( font == nullptr )
 		font = m_defaultProportionalFont;
 
-	Vector2f cursor = lowerLeftOriginPos; //Assuming its the lower-left.
-
-	const Glyph* previousGlyph = nullptr; //For kerning check.
+	if ( m_textLayoutCache == nullptr ) //Before CreateBuiltInDefaults finishes.
+		return;
 
-	for ( unsigned int charIndex = 0; charIndex < inputText.size(); charIndex++ )
+	//Each page's run holds every shadow quad then every glyph quad, so a string costs one draw per font page,
+	//and the transient batcher merges consecutive strings on the same page into one.
+	const TextLayout& layout = m_textLayoutCache->CreateOrGetLayout( font, inputText, scale, tint, drawDropShadow, shadowColor );
+	for ( const TextLayoutRun& run : layout.m_runs )
 	{
-		char c = inputText[ charIndex ];
-		const Glyph* currentGlyph = font->GetGlyphForChar( c ); //Use m_fontGlyphs.
-
-		if ( currentGlyph == nullptr )
-			continue; //Skips unsupported chars.
-
-		float kerningAmount; //BMFont only does kerning horizontally.
-		if ( previousGlyph != nullptr )
-		{
-			kerningAmount = previousGlyph->GetKerning( currentGlyph->m_id );
-			cursor.x += ( kerningAmount * scale ); //	+ ( kerning.y * scale );
-		}
-
-		const Vector2f offset = Vector2f( static_cast<float>( currentGlyph->m_xoffset ), static_cast<float>( currentGlyph->m_yoffset ) ); //"caching" off is good!
-		const Vector2f size = Vector2f( static_cast<float>( currentGlyph->m_width ), static_cast<float>( currentGlyph->m_height ) ); //in px, not uv == normalized texel coordinates
-
-		//Remember: in 2D, y+ is up, x+ is right. But positive yoffset means DOWN, though positive xoffset still means right.
-		const Vector2f topLeftCorner		= Vector2f( cursor.x + offset.x * scale, cursor.y - offset.y * scale );
-		const Vector2f bottomLeftCorner		= Vector2f( topLeftCorner.x,			topLeftCorner.y - ( size.y * scale ) );
-		const Vector2f bottomRightCorner	= Vector2f( bottomLeftCorner.x + ( size.x * scale ), bottomLeftCorner.y );
-		const Vector2f topRightCorner		= Vector2f( topLeftCorner.x + ( size.x * scale ),	topLeftCorner.y );
-
-		AABB2f renderBounds = AABB2f( bottomLeftCorner, topRightCorner );
-
-		AABB2f texCoords = font->GetTexCoordsForGlyph( currentGlyph->m_id );
-
-		Texture* texture = font->GetFontTexture( currentGlyph->m_page );
-
-		if ( drawDropShadow )
+		m_textScratchVertices.resize( run.m_vertices.size() );
+		for ( unsigned int vertexIndex = 0; vertexIndex < run.m_vertices.size(); vertexIndex++ )
 		{
-			AABB2f shadowRenderBounds = renderBounds;
-			Vector2f shadowOffset = Vector2f( DROP_SHADOW_OFFSET, -DROP_SHADOW_OFFSET );
-			shadowRenderBounds.mins += shadowOffset;
-			shadowRenderBounds.maxs += shadowOffset;
-			g_theRenderer->DrawAABB( VertexGroupingRule::AS_TRIANGLES, shadowRenderBounds, *texture, texCoords, shadowColor );
+			Vertex3D_PCT& vertex = m_textScratchVertices[ vertexIndex ];
+			vertex = run.m_vertices[ vertexIndex ];
+			vertex.m_position.x += lowerLeftOriginPos.x;
+			vertex.m_position.y += lowerLeftOriginPos.y;
 		}
-		DrawAABB( VertexGroupingRule::AS_TRIANGLES, renderBounds, *texture, texCoords, tint );
-
-		cursor.x += ( currentGlyph->m_xadvance * scale ); //Move to next glyph.
 
-		previousGlyph = currentGlyph; //For next kerning check.
+		BindTexture( font->GetFontTexture( run.m_page ) );
+		DrawVertexArray2D_PCT( VertexGroupingRule::AS_TRIANGLES, m_textScratchVertices.data(), m_textScratchVertices.size(), (void*)run.m_indices.data(), run.m_indices.size() );
 	}
 }
 
@@ -2512,7 +2768,7 @@ void TheRenderer::DrawAxes( float length, float lineThickness /*=1.f*/, float al
 {
 	UnbindTexture();
 
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 	DrawLine( Vector3f( 0.f, 0.f, 0.f ), Vector3f( length, 0.f, 0.f ), Rgba( 1.f, 0.f, 0.f, alphaOpacity ), Rgba( 1.f, 0.f, 0.f, alphaOpacity ), lineThickness );
 	DrawLine( Vector3f( 0.f, 0.f, 0.f ), Vector3f( 0.f, length, 0.f ), Rgba( 0.f, 1.f, 0.f, alphaOpacity ), Rgba( 0.f, 1.f, 0.f, alphaOpacity ), lineThickness );
@@ -2545,11 +2801,14 @@ void TheRenderer::DrawVertexArray3D_PCT( const int vertexGroupingRule, const Ver
 	if ( numVertices == 0 )
 		return;
 
-	DrawInstruction drawInstructions[] = { DrawInstruction( (VertexGroupingRule)vertexGroupingRule, 0, numVertices, false ) };
-	Mesh* mesh = new Mesh( BufferUsage::STATIC_DRAW, DEFAULT_RENDERER_VERTEX_DEFINITION, numVertices, vertexData, 1, drawInstructions );
-	s_defaultRenderer->SetMeshAndMaterial( std::shared_ptr<Mesh>( mesh ), s_defaultMaterial3D );
+	if ( !DrawTransientVertexArray( s_defaultMaterial3D, vertexGroupingRule, vertexData, numVertices, nullptr, 0 ) )
+	{
+		DrawInstruction drawInstructions[] = { DrawInstruction( (VertexGroupingRule)vertexGroupingRule, 0, numVertices, false ) };
+		Mesh* mesh = new Mesh( BufferUsage::STATIC_DRAW, DEFAULT_RENDERER_VERTEX_DEFINITION, numVertices, vertexData, 1, drawInstructions );
+		s_defaultRenderer->SetMeshAndMaterial( std::shared_ptr<Mesh>( mesh ), s_defaultMaterial3D );
 
-	s_defaultRenderer->Render();
+		s_defaultRenderer->Render();
+	}
 
 	UnbindTexture();
 }
@@ -2568,11 +2827,14 @@ void TheRenderer::DrawVertexArray3D_PCT( const int vertexGroupingRule, const Ver
 	if ( numVertices == 0 )
 		return;
 
-	DrawInstruction drawInstructions[] = { DrawInstruction( (VertexGroupingRule)vertexGroupingRule, 0, numIndices, true ) };
-	Mesh* mesh = new Mesh( BufferUsage::STATIC_DRAW, DEFAULT_RENDERER_VERTEX_DEFINITION, numVertices, vertexData, numIndices, indicesData, 1, drawInstructions );
-	s_defaultRenderer->SetMeshAndMaterial( std::shared_ptr<Mesh>( mesh ), s_defaultMaterial3D );
-	
-	s_defaultRenderer->Render();
+	if ( !DrawTransientVertexArray( s_defaultMaterial3D, vertexGroupingRule, vertexData, numVertices, static_cast<const unsigned int*>( indicesData ), numIndices ) )
+	{
+		DrawInstruction drawInstructions[] = { DrawInstruction( (VertexGroupingRule)vertexGroupingRule, 0, numIndices, true ) };
+		Mesh* mesh = new Mesh( BufferUsage::STATIC_DRAW, DEFAULT_RENDERER_VERTEX_DEFINITION, numVertices, vertexData, numIndices, indicesData, 1, drawInstructions );
+		s_defaultRenderer->SetMeshAndMaterial( std::shared_ptr<Mesh>( mesh ), s_defaultMaterial3D );
+
+		s_defaultRenderer->Render();
+	}
 
 	UnbindTexture();
 }
@@ -2591,18 +2853,20 @@ void TheRenderer::DrawVertexArray2D_PCT( const int vertexGroupingRule, const Ver
 	if ( numVertices == 0 )
 		return;
 
-	DrawInstruction drawInstructions[] = { DrawInstruction( (VertexGroupingRule)vertexGroupingRule, 0, numVertices, false ) };
-	Mesh* mesh = new Mesh( BufferUsage::STATIC_DRAW, DEFAULT_RENDERER_VERTEX_DEFINITION, numVertices, vertexData, 1, drawInstructions );
-	s_defaultRenderer->SetMeshAndMaterial( std::shared_ptr<Mesh>( mesh ), s_defaultMaterial2D );
-
-
 //#ifdef PLATFORM_RIFT_CV1 //Overwrite by adding in offsets based on VR HMD.
 //	int eye = g_theRenderer->GetRiftContext()->currentEye;
 //	Matrix4x4f ortho = g_theRenderer->CalcRiftOrthoProjMatrixMyBasis( eye );
 //	s_defaultMaterial2D->SetMatrix4x4( "uProj", false, &ortho );
 //#endif
 
-	s_defaultRenderer->Render();
+	if ( !DrawTransientVertexArray( s_defaultMaterial2D, vertexGroupingRule, vertexData, numVertices, nullptr, 0 ) )
+	{
+		DrawInstruction drawInstructions[] = { DrawInstruction( (VertexGroupingRule)vertexGroupingRule, 0, numVertices, false ) };
+		Mesh* mesh = new Mesh( BufferUsage::STATIC_DRAW, DEFAULT_RENDERER_VERTEX_DEFINITION, numVertices, vertexData, 1, drawInstructions );
+		s_defaultRenderer->SetMeshAndMaterial( std::shared_ptr<Mesh>( mesh ), s_defaultMaterial2D );
+
+		s_defaultRenderer->Render();
+	}
 
 	UnbindTexture();
 }
@@ -2621,22 +2885,64 @@ void TheRenderer::DrawVertexArray2D_PCT( const int vertexGroupingRule, const Ver
 	if ( numVertices == 0 )
 		return;
 
-	DrawInstruction drawInstructions[] = { DrawInstruction( (VertexGroupingRule)vertexGroupingRule, 0, numIndices, true ) };
-	Mesh* mesh = new Mesh( BufferUsage::STATIC_DRAW, DEFAULT_RENDERER_VERTEX_DEFINITION, numVertices, vertexData, numIndices, indicesData, 1, drawInstructions );
-	s_defaultRenderer->SetMeshAndMaterial( std::shared_ptr<Mesh>( mesh ), s_defaultMaterial2D );
-
 //#ifdef PLATFORM_RIFT_CV1 //Overwrite by adding in offsets based on VR HMD.
 //	int eye = g_theRenderer->GetRiftContext()->currentEye;
 //	Matrix4x4f ortho = g_theRenderer->CalcRiftOrthoProjMatrixMyBasis( eye );
 //	s_defaultMaterial2D->SetMatrix4x4( "uProj", false, &ortho );
 //#endif
 
-	s_defaultRenderer->Render();
+	if ( !DrawTransientVertexArray( s_defaultMaterial2D, vertexGroupingRule, vertexData, numVertices, static_cast<const unsigned int*>( indicesData ), numIndices ) )
+	{
+		DrawInstruction drawInstructions[] = { DrawInstruction( (VertexGroupingRule)vertexGroupingRule, 0, numIndices, true ) };
+		Mesh* mesh = new Mesh( BufferUsage::STATIC_DRAW, DEFAULT_RENDERER_VERTEX_DEFINITION, numVertices, vertexData, numIndices, indicesData, 1, drawInstructions );
+		s_defaultRenderer->SetMeshAndMaterial( std::shared_ptr<Mesh>( mesh ), s_defaultMaterial2D );
+
+		s_defaultRenderer->Render();
+	}
 
 	UnbindTexture();
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+bool TheRenderer::DrawTransientVertexArray( Material* material, const int vertexGroupingRule, const Vertex3D_PCT* vertexData, unsigned int numVertices, const unsigned int* indicesData, unsigned int numIndices )
+{
+	if ( m_transientGeometry == nullptr )
+		return false; //Fonts and such can draw before CreateBuiltInDefaults finishes.
+
+	TransientDrawKey key;
+	key.m_material = material;
+	key.m_vertexGroupingRule = (VertexGroupingRule)vertexGroupingRule;
+	key.m_diffuseTextureID = material->GetTexture( "uTexDiffuse" ); //Not m_currentTextureID, DrawAABB sets the material's directly.
+	key.m_usesIndices = ( indicesData != nullptr );
+
+	return m_transientGeometry->Draw( key, vertexData, numVertices, indicesData, numIndices );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void TheRenderer::FlushImmediateDraws()
+{
+	if ( m_transientGeometry != nullptr )
+		m_transientGeometry->Flush();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void TheRenderer::EndFrame()
+{
+	m_transientGeometry->EndFrame();
+	m_textLayoutCache->EndFrame();
+	m_renderQueue->EndFrame();
+	ShaderProgram::EndFrame();
+	RenderStateCache::EndFrame();
+
+	unsigned int numBuffersCreated = VertexBuffer::GetNumBuffersCreated();
+	m_numBuffersCreatedLastFrame = numBuffersCreated - m_numBuffersCreatedAtFrameStart;
+	m_numBuffersCreatedAtFrameStart = numBuffersCreated;
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::BindTexture( const Texture* texture )
 {
@@ -2648,7 +2954,7 @@ void TheRenderer::BindTexture( const Texture* texture )
 	s_defaultMaterial2D->SetTexture( "uTexDiffuse", texture->GetTextureID() );
 	s_defaultMaterial3D->SetTexture( "uTexDiffuse", texture->GetTextureID() );
 	
-	glBindTexture( GL_TEXTURE_2D, paramTextureID );
+	RenderStateCache::BindTexture2D( 0, paramTextureID );
 	m_currentTextureID = paramTextureID;
 }
 
@@ -2696,7 +3002,7 @@ void TheRenderer::DrawSphereGimbal( const int vertexGroupingRule, const Vector3f
 
 	UnbindTexture();
 
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 	std::vector<Vertex3D_PCT> vertexes;
 	
@@ -2764,7 +3070,7 @@ void TheRenderer::DrawCylinder( const int vertexGroupingRule, const Vector3f& ce
 {
 	UnbindTexture();
 
-	glLineWidth( lineThickness );
+	SetLineWidth( lineThickness );
 
 	std::vector<Vertex3D_PCT> vertexes;
 	float heightStep = ceil( 1.f / numSlices );
@@ -3120,6 +3426,10 @@ void TheRenderer::UpdateAndRenderPostProcess()
 		//Have one cam in scene render to the texture, and another that projects it on things. Or a drone moving the view around, while you stand still.
 	mr->SetMatrix4x4( "uProj", false, &Matrix4x4f::IDENTITY );
 
+	//A post-process graph running this effect last frame pointed these at its own targets.
+	mr->SetTexture( "uTexDiffuse", m_lastNonDefaultFBO->GetColorTextureID( 0 ) );
+	mr->SetTexture( "uTexDepth", m_lastNonDefaultFBO->GetDepthStencilTextureID() );
+
 	mr->Render();
 }
 
@@ -3279,6 +3589,8 @@ void TheRenderer::UpdateSceneMVP( const Camera3D* activeCam )
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::Update( float deltaSeconds, const Camera3D* activeCam )
 {
+	FlushImmediateDraws();
+
 	if ( g_theInput->WasKeyPressedOnce( KEY_TO_TOGGLE_ORIGIN_AXES ) )
 	{
 		Command cmd( "ToggleOriginAxes 1" );
@@ -3287,6 +3599,7 @@ void TheRenderer::Update( float deltaSeconds, const Camera3D* activeCam )
 
 	UpdateShaderTimersAndPositions( deltaSeconds, activeCam );
 	UpdateSceneMVP( activeCam );
+	m_dynamicResolution->Update( deltaSeconds );
 	UpdateLights( deltaSeconds, activeCam );
 }
 
@@ -3446,7 +3759,7 @@ void TheRenderer::ApplyAnimationToSkeleton( int numAnimation, int numSkeleton )
 
 	m_animationSequences[ numAnimation ]->ApplyMotionToSkeleton( m_skeletonVisualizations[ numSkeleton ], g_animationTimer );
 	const int MAX_BONES = 200; //In total on skeleton.
-	Matrix4x4f currentBoneTransforms[ MAX_BONES ];
+	Matrix44 currentBoneTransforms[ MAX_BONES ]; //Packed, so the upload below needn't repack them.
 	m_skeletonVisualizations.front()->GetBoneMatrices( currentBoneTransforms, MAX_BONES );
 	for ( auto& sp : *ShaderProgram::GetRegistry() )
 		sp.second->SetMatrix4x4( "uBoneMatrices[0]", true, currentBoneTransforms, MAX_BONES );
@@ -3472,6 +3785,8 @@ void TheRenderer::ApplyAnimationToSkeleton( int numAnimation, int numSkeleton )
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::PostRenderStep()
 {
+	FlushImmediateDraws();
+
 #ifdef RENDER_2D_ON_WORLD_QUAD
 	if ( g_theRenderer->IsShowingFBOs() )
 		g_theRenderer->BindFBO( m_lastNonDefaultFBO );
@@ -3488,7 +3803,9 @@ void TheRenderer::PostRenderStep()
 
 	g_theRenderer->VisualizeCurrentSkeletons();
 
-	if ( TheRenderer::IsShowingFBOs() )
+	ResolvePostProcessScene(); //In case this frame never set up a 2D view.
+
+	if ( TheRenderer::IsShowingFBOs() && !IsPostProcessGraphActive() )
 	{
 		g_theRenderer->BindFBO( nullptr );	
 		UpdateAndRenderPostProcess();
@@ -3595,6 +3912,11 @@ void TheRenderer::Shutdown()
 		delete mrPtr;
 		mrPtr = nullptr;
 	}
+	delete m_postProcessGraph; //Before its pass materials go below.
+	m_postProcessGraph = nullptr;
+	delete m_dynamicResolution;
+	m_dynamicResolution = nullptr;
+
 	FIXME( "Why does delete m_lastNonDefaultFBO crash below?" );
 	//	delete m_lastNonDefaultFBO; 
 	//	m_lastNonDefaultFBO = nullptr;
@@ -3607,6 +3929,15 @@ void TheRenderer::Shutdown()
 	Shader::DeleteShaders();
 
 	delete s_defaultRenderer;
+
+	delete m_transientGeometry;
+	m_transientGeometry = nullptr;
+
+	delete m_textLayoutCache;
+	m_textLayoutCache = nullptr;
+
+	delete m_renderQueue;
+	m_renderQueue = nullptr;
 }
 
 
@@ -3651,7 +3982,23 @@ void TheRenderer::SetupView3D( const Camera3D* activeCamera )
 	g_theRenderer->ClearScreenToColor( Rgba::BLACK ); //BG color of FBOs-off world.
 	g_theRenderer->ClearScreenDepthBuffer();
 
-	if ( g_theRenderer->IsShowingFBOs() )
+	if ( IsPostProcessGraphActive() )
+	{
+		//One screen-size target whatever the scale, with the scene in its lower-left, so scaling never reallocates.
+		if ( m_postProcessSceneTarget == nullptr )
+			m_postProcessSceneTarget = m_postProcessGraph->GetTargetPool()->Acquire( m_screenWidthAsUnsignedInt, m_screenHeightAsUnsignedInt, TextureFormat::TEXTURE_FORMAT_Rgba8, true );
+		g_theRenderer->BindFBO( m_postProcessSceneTarget, false );
+		g_theRenderer->ClearScreenToColor( Rgba::DARK_GRAY ); //BG color of FBOs-on world.
+		g_theRenderer->ClearScreenDepthBuffer();
+
+		float scale = GetSceneResolutionScale();
+		m_postProcessSceneWidth = GetMax( 1u, static_cast<unsigned int>( ( m_screenWidthAsUnsignedInt * scale ) + .5f ) );
+		m_postProcessSceneHeight = GetMax( 1u, static_cast<unsigned int>( ( m_screenHeightAsUnsignedInt * scale ) + .5f ) );
+		glViewport( 0, 0, m_postProcessSceneWidth, m_postProcessSceneHeight );
+
+		m_dynamicResolution->BeginGpuTiming( scale );
+	}
+	else if ( g_theRenderer->IsShowingFBOs() )
 	{
 		g_theRenderer->BindFBO( g_theRenderer->GetCurrentFBO() );
 		g_theRenderer->ClearScreenToColor( Rgba::DARK_GRAY ); //BG color of FBOs-on world.
@@ -3664,6 +4011,38 @@ void TheRenderer::SetupView3D( const Camera3D* activeCamera )
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+bool TheRenderer::IsPostProcessGraphActive() const
+{
+	return ( m_postProcessGraph != nullptr ) && ( ( m_postProcessGraph->GetNumEffects() > 0 ) || m_dynamicResolution->IsEnabled() );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+float TheRenderer::GetSceneResolutionScale() const
+{
+	//Fullscreen effects sample uTexDepth with screen UVs, which a sub-rect would break.
+	if ( m_postProcessGraph->DoesAnyEffectReadDepth() )
+		return 1.f;
+
+	return m_dynamicResolution->GetScale();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void TheRenderer::ResolvePostProcessScene()
+{
+	if ( m_postProcessSceneTarget == nullptr )
+		return;
+
+	m_postProcessGraph->Execute( m_postProcessSceneTarget, m_postProcessSceneWidth, m_postProcessSceneHeight, nullptr );
+	m_dynamicResolution->EndGpuTiming();
+
+	m_postProcessGraph->GetTargetPool()->Release( m_postProcessSceneTarget );
+	m_postProcessSceneTarget = nullptr;
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 Vector2f TheRenderer::GetScreenCenter() const
 {
@@ -3679,6 +4058,10 @@ Vector2f TheRenderer::GetScreenCenter() const
 //--------------------------------------------------------------------------------------------------------------
 void TheRenderer::SetupView2D( const Camera2D* activeCamera )
 {
+	FlushImmediateDraws();
+
+	ResolvePostProcessScene(); //2D then draws over the result at native resolution.
+
 #ifdef RENDER_2D_ON_WORLD_QUAD
 	g_theRenderer->BindFBO( m_render2DOnWorldQuadFBO, false );
 	g_theRenderer->ClearScreenToColor( Rgba::CYAN ); //BG color of FBOs-on world.
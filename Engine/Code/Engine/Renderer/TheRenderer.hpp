@@ -27,6 +27,11 @@ class Skeleton;
 class AnimationSequence;
 class Camera2D;
 class Camera3D;
+class TransientGeometryBuffer;
+class TextLayoutCache;
+class RenderQueue;
+class PostProcessGraph;
+class DynamicResolutionController;
 
 
 //-----------------------------------------------------------------------------
@@ -190,12 +195,28 @@ public:
 	double GetScreenWidth() const { return m_screenWidth; }
 	double GetScreenHeight() const { return m_screenHeight; }
 
+	//Immediate-mode Draw* calls are batched into m_transientGeometry, so anything changing state they rely on must flush first.
+	void FlushImmediateDraws();
+	void EndFrame(); //After the last draw of the frame, before the swap.
+	TransientGeometryBuffer* GetTransientGeometry() const { return m_transientGeometry; }
+	unsigned int GetNumBuffersCreatedLastFrame() const { return m_numBuffersCreatedLastFrame; }
+	TextLayoutCache* GetTextLayoutCache() const { return m_textLayoutCache; }
+	RenderQueue* GetRenderQueue() const { return m_renderQueue; }
+
+	//Post-process chain and dynamic resolution, both off until given effects or enabled.
+	PostProcessGraph* GetPostProcessGraph() const { return m_postProcessGraph; }
+	DynamicResolutionController* GetDynamicResolution() const { return m_dynamicResolution; }
+	bool IsPostProcessGraphActive() const;
+	float GetSceneResolutionScale() const; //1 unless dynamic resolution is on and no effect reads the scene's depth.
+
 
 private:
 
 	void CreateBuiltInDefaults();
+	bool DrawTransientVertexArray( Material* material, const int vertexGroupingRule, const Vertex3D_PCT* vertexData, unsigned int numVertices, const unsigned int* indicesData, unsigned int numIndices );
 	void DeleteFonts();
 	void DeleteTextures();
+	void ResolvePostProcessScene(); //Runs the graph over m_postProcessSceneTarget, if SetupView3D acquired one.
 
 	BitmapFont* m_defaultProportionalFont;
 	FixedBitmapFont* m_defaultMonospaceFont;
@@ -204,15 +225,31 @@ private:
 	std::shared_ptr<Mesh> m_defaultFboQuad;
 
 	unsigned int m_currentTextureID;
+	float m_currentLineWidth;
+	float m_currentPointSize;
 	FrameBuffer* m_lastNonDefaultFBO;
-	bool m_usingDefaultNullFBO;
+	FrameBuffer* m_boundFBO; //nullptr for the default framebuffer. Not always m_lastNonDefaultFBO: see BindFBO's overwriteLast.
 	std::vector< Skeleton* > m_skeletonVisualizations;
 	std::vector< AnimationSequence* > m_animationSequences;
 
 	double m_screenWidth, m_screenHeight;
 	unsigned int m_screenWidthAsUnsignedInt, m_screenHeightAsUnsignedInt;
 
+	TransientGeometryBuffer* m_transientGeometry;
+	unsigned int m_numBuffersCreatedAtFrameStart; //VertexBuffer's running total, diffed in EndFrame().
+	unsigned int m_numBuffersCreatedLastFrame;
+	TextLayoutCache* m_textLayoutCache; //DrawTextProportional2D strings, laid out once and redrawn as one vertex run each.
+	std::vector< Vertex3D_PCT > m_textScratchVertices; //A cached run moved to where it's drawn.
+	RenderQueue* m_renderQueue; //Sorted, job-recorded draws, e.g. SpriteRenderer's layers.
+	PostProcessGraph* m_postProcessGraph;
+	DynamicResolutionController* m_dynamicResolution;
+	FrameBuffer* m_postProcessSceneTarget; //From the graph's pool, between SetupView3D and SetupView2D.
+	unsigned int m_postProcessSceneWidth, m_postProcessSceneHeight; //Scaled sub-rect of it the scene covers.
+
 	static const float DROP_SHADOW_OFFSET;
+	static const unsigned int TRANSIENT_VERTEX_BYTES_PER_FRAME;
+	static const unsigned int TRANSIENT_INDEX_BYTES_PER_FRAME;
+	static const unsigned int SPRITE_INSTANCE_BYTES_PER_FRAME;
 
 #if defined(RENDER_2D_ON_WORLD_QUAD) || defined(PLATFORM_RIFT_CV1)
 private:
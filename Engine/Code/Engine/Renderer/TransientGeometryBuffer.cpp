@@ -0,0 +1,347 @@
+#include "Engine/Renderer/TransientGeometryBuffer.hpp"
+
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <gl/gl.h>
+#include "Engine/Renderer/OpenGLExtensions.hpp"
+#include "Engine/Renderer/RenderStateCache.hpp"
+#include "Engine/Renderer/Material.hpp"
+#include "Engine/Renderer/ShaderProgram.hpp"
+#include "Engine/Renderer/VertexDefinition.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Error/ErrorWarningAssert.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const char* DIFFUSE_TEXTURE_UNIFORM_NAME = "uTexDiffuse";
+
+
+//--------------------------------------------------------------------------------------------------------------
+TransientGeometryBuffer::TransientGeometryBuffer( const VertexDefinition& vertexDefinition, unsigned int vertexBytesPerFrame, unsigned int indexBytesPerFrame )
+	: m_vertexDefinition( &vertexDefinition )
+	, m_vertexSize( (unsigned int)vertexDefinition.GetVertexSize() )
+	, m_vboID( NULL )
+	, m_iboID( NULL )
+	, m_currentSegment( 0 )
+	, m_vertexHead( 0 )
+	, m_indexHead( 0 )
+	, m_isBatchingEnabled( true )
+	, m_numStagedVertices( 0 )
+{
+	ASSERT_OR_DIE( m_vertexSize > 0, "TransientGeometryBuffer needs a VertexDefinition with a nonzero size!" );
+
+	//Segment starts must land on whole vertices for glDrawArrays' first-vertex argument.
+	m_vertexSegmentSize = ( vertexBytesPerFrame / m_vertexSize ) * m_vertexSize;
+	m_indexSegmentSize = ( indexBytesPerFrame / sizeof( unsigned int ) ) * sizeof( unsigned int );
+
+	for ( unsigned int segmentIndex = 0; segmentIndex < NUM_FRAMES_IN_FLIGHT; segmentIndex++ )
+		m_segmentFences[ segmentIndex ] = nullptr;
+
+	m_stagedKey.m_material = nullptr;
+	m_stagedKey.m_vertexGroupingRule = AS_TRIANGLES;
+	m_stagedKey.m_diffuseTextureID = 0;
+	m_stagedKey.m_usesIndices = false;
+	m_stagedDiffuseTextureHandle = INVALID_UNIFORM_HANDLE;
+
+	glGenBuffers( 1, &m_vboID );
+	glGenBuffers( 1, &m_iboID );
+	ASSERT_OR_DIE( m_vboID != NULL && m_iboID != NULL, "glGenBuffers failed in TransientGeometryBuffer()" );
+
+	Orphan(); //Allocates the storage, nothing to orphan yet.
+	m_currentFrameStats.m_numOrphans = 0;
+
+	m_stagedVertices.reserve( m_vertexSegmentSize );
+	m_stagedIndices.reserve( m_indexSegmentSize / sizeof( unsigned int ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+TransientGeometryBuffer::~TransientGeometryBuffer()
+{
+	for ( unsigned int segmentIndex = 0; segmentIndex < NUM_FRAMES_IN_FLIGHT; segmentIndex++ )
+		if ( m_segmentFences[ segmentIndex ] != nullptr )
+			glDeleteSync( (GLsync)m_segmentFences[ segmentIndex ] );
+
+	for ( auto& vaoPair : m_vaoIDsPerMaterial )
+	{
+		glDeleteVertexArrays( 1, &vaoPair.second );
+		RenderStateCache::OnVertexArrayDeleted( vaoPair.second );
+	}
+
+	glDeleteBuffers( 1, &m_vboID );
+	glDeleteBuffers( 1, &m_iboID );
+	RenderStateCache::OnBufferDeleted( m_vboID );
+	RenderStateCache::OnBufferDeleted( m_iboID );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC bool TransientGeometryBuffer::IsListGroupingRule( VertexGroupingRule rule )
+{
+	return ( rule == AS_TRIANGLES ) || ( rule == AS_LINES ) || ( rule == AS_POINTS );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int TransientGeometryBuffer::GetNumVerticesPerPrimitive( VertexGroupingRule listRule )
+{
+	switch ( listRule )
+	{
+		case AS_TRIANGLES: return 3;
+		case AS_LINES: return 2;
+		default: return 1;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool TransientGeometryBuffer::Draw( const TransientDrawKey& key, const void* vertexData, unsigned int numVertices, const unsigned int* indices, unsigned int numIndices )
+{
+	++m_currentFrameStats.m_numDrawsSubmitted;
+
+	unsigned int numVertexBytes = numVertices * m_vertexSize;
+	unsigned int numIndexBytes = numIndices * sizeof( unsigned int );
+	if ( ( numVertexBytes <= m_vertexSegmentSize ) && ( numIndexBytes <= m_indexSegmentSize ) )
+	{
+		StageDraw( key, vertexData, numVertices, indices, numIndices );
+		return true;
+	}
+
+	//Indices can reach anywhere in the vertices, and strips and loops would lose their joins, so only unindexed lists split.
+	if ( key.m_usesIndices || !IsListGroupingRule( key.m_vertexGroupingRule ) )
+	{
+		++m_currentFrameStats.m_numOversizedDraws;
+		return false;
+	}
+
+	unsigned int numVerticesPerPrimitive = GetNumVerticesPerPrimitive( key.m_vertexGroupingRule );
+	unsigned int maxVerticesPerDraw = ( ( m_vertexSegmentSize / m_vertexSize ) / numVerticesPerPrimitive ) * numVerticesPerPrimitive;
+	if ( maxVerticesPerDraw == 0 )
+	{
+		++m_currentFrameStats.m_numOversizedDraws;
+		return false;
+	}
+
+	++m_currentFrameStats.m_numSplitDraws;
+
+	const unsigned char* vertexBytes = static_cast<const unsigned char*>( vertexData );
+	for ( unsigned int firstVertex = 0; firstVertex < numVertices; firstVertex += maxVerticesPerDraw )
+	{
+		unsigned int numVerticesInDraw = GetMin( maxVerticesPerDraw, numVertices - firstVertex );
+		StageDraw( key, vertexBytes + ( firstVertex * m_vertexSize ), numVerticesInDraw, nullptr, 0 );
+	}
+
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void TransientGeometryBuffer::StageDraw( const TransientDrawKey& key, const void* vertexData, unsigned int numVertices, const unsigned int* indices, unsigned int numIndices )
+{
+	unsigned int numVertexBytes = numVertices * m_vertexSize;
+	unsigned int numIndexBytes = numIndices * sizeof( unsigned int );
+
+	bool isMergeable = m_isBatchingEnabled && IsListGroupingRule( key.m_vertexGroupingRule );
+	bool fitsInBatch = ( m_stagedVertices.size() + numVertexBytes <= m_vertexSegmentSize )
+		&& ( ( m_stagedIndices.size() * sizeof( unsigned int ) ) + numIndexBytes <= m_indexSegmentSize );
+	if ( !isMergeable || !fitsInBatch || ( key != m_stagedKey ) )
+		Flush();
+
+	m_stagedKey = key;
+	if ( m_numStagedVertices == 0 ) //A new batch: have its uniforms' changes flush it from here on.
+	{
+		ShaderProgram* shaderProgram = key.m_material->GetShaderProgram();
+		shaderProgram->SetPendingTransientBatch( this );
+		m_stagedDiffuseTextureHandle = shaderProgram->GetUniformHandle( DIFFUSE_TEXTURE_UNIFORM_NAME );
+	}
+
+	const unsigned char* vertexBytes = static_cast<const unsigned char*>( vertexData );
+	m_stagedVertices.insert( m_stagedVertices.end(), vertexBytes, vertexBytes + numVertexBytes );
+
+	if ( key.m_usesIndices )
+	{
+		for ( unsigned int indexIndex = 0; indexIndex < numIndices; indexIndex++ )
+			m_stagedIndices.push_back( indices[ indexIndex ] + m_numStagedVertices );
+	}
+
+	m_numStagedVertices += numVertices;
+
+	if ( !isMergeable ) //Strips and loops can't take on any more, so don't hold them past the caller's next state change.
+		Flush();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void TransientGeometryBuffer::Flush()
+{
+	if ( m_numStagedVertices == 0 )
+		return;
+
+	Material* material = m_stagedKey.m_material;
+	material->GetShaderProgram()->ClearPendingTransientBatch( this ); //Before SetTexture below, which would call back into here.
+
+	unsigned int numVertexBytes = m_stagedVertices.size();
+	unsigned int numIndexBytes = m_stagedIndices.size() * sizeof( unsigned int );
+	if ( ( m_vertexHead + numVertexBytes > m_vertexSegmentSize ) || ( m_indexHead + numIndexBytes > m_indexSegmentSize ) )
+	{
+		Orphan(); //This frame outgrew its segment, so start over in fresh storage rather than overwrite one still in flight.
+		m_vertexHead = 0;
+		m_indexHead = 0;
+	}
+
+	unsigned int vertexOffset = ( m_currentSegment * m_vertexSegmentSize ) + m_vertexHead;
+	unsigned int firstVertex = vertexOffset / m_vertexSize;
+	unsigned int indexOffset = ( m_currentSegment * m_indexSegmentSize ) + m_indexHead;
+
+	void* mappedVertices = MapRange( GL_ARRAY_BUFFER, m_vboID, vertexOffset, numVertexBytes );
+	if ( mappedVertices != nullptr )
+	{
+		memcpy( mappedVertices, m_stagedVertices.data(), numVertexBytes );
+		glUnmapBuffer( GL_ARRAY_BUFFER );
+	}
+	else glBufferSubData( GL_ARRAY_BUFFER, vertexOffset, numVertexBytes, m_stagedVertices.data() );
+
+	if ( m_stagedKey.m_usesIndices )
+	{
+		//Rebasing onto the ring while copying, so merged draws need no glDrawElementsBaseVertex.
+		unsigned int* mappedIndices = static_cast<unsigned int*>( MapRange( GL_ARRAY_BUFFER, m_iboID, indexOffset, numIndexBytes ) );
+		if ( mappedIndices != nullptr )
+		{
+			for ( unsigned int indexIndex = 0; indexIndex < m_stagedIndices.size(); indexIndex++ )
+				mappedIndices[ indexIndex ] = m_stagedIndices[ indexIndex ] + firstVertex;
+			glUnmapBuffer( GL_ARRAY_BUFFER );
+		}
+		else
+		{
+			for ( unsigned int& index : m_stagedIndices )
+				index += firstVertex;
+			glBufferSubData( GL_ARRAY_BUFFER, indexOffset, numIndexBytes, m_stagedIndices.data() );
+		}
+	}
+
+	//The caller has likely rebound the material's texture since staging, e.g. TheRenderer::UnbindTexture after every draw.
+	unsigned int liveTextureID = material->GetTexture( DIFFUSE_TEXTURE_UNIFORM_NAME );
+	material->SetTexture( DIFFUSE_TEXTURE_UNIFORM_NAME, m_stagedKey.m_diffuseTextureID );
+
+	RenderStateCache::BindVertexArray( CreateOrGetVertexArrayForMaterial( material ) );
+	material->Bind();
+
+	unsigned int vertexGroupingRule = GetOpenGLVertexGroupingRule( m_stagedKey.m_vertexGroupingRule );
+	if ( m_stagedKey.m_usesIndices )
+		glDrawElements( vertexGroupingRule, m_stagedIndices.size(), GL_UNSIGNED_INT, (GLvoid*)indexOffset );
+	else
+		glDrawArrays( vertexGroupingRule, firstVertex, m_numStagedVertices );
+
+	material->SetTexture( DIFFUSE_TEXTURE_UNIFORM_NAME, liveTextureID );
+
+	m_vertexHead += numVertexBytes;
+	m_indexHead += numIndexBytes;
+
+	++m_currentFrameStats.m_numDrawCallsIssued;
+	m_currentFrameStats.m_numBytesUploaded += numVertexBytes + numIndexBytes;
+
+	m_stagedVertices.clear();
+	m_stagedIndices.clear();
+	m_numStagedVertices = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void TransientGeometryBuffer::OnStagedUniformChanging( int uniformHandle )
+{
+	if ( uniformHandle != m_stagedDiffuseTextureHandle )
+		Flush();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void TransientGeometryBuffer::EndFrame()
+{
+	Flush();
+
+	m_segmentFences[ m_currentSegment ] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+
+	m_currentSegment = ( m_currentSegment + 1 ) % NUM_FRAMES_IN_FLIGHT;
+	m_vertexHead = 0;
+	m_indexHead = 0;
+
+	m_lastFrameStats = m_currentFrameStats;
+	m_currentFrameStats.Clear();
+
+	GLsync nextSegmentFence = (GLsync)m_segmentFences[ m_currentSegment ];
+	if ( nextSegmentFence == nullptr )
+		return; //Orphaned since, or not yet used.
+
+	GLenum fenceStatus = glClientWaitSync( nextSegmentFence, 0, 0 ); //Zero timeout: only polling, never stalling.
+	if ( ( fenceStatus == GL_ALREADY_SIGNALED ) || ( fenceStatus == GL_CONDITION_SATISFIED ) )
+	{
+		glDeleteSync( nextSegmentFence );
+		m_segmentFences[ m_currentSegment ] = nullptr;
+		return;
+	}
+
+	//GPU is NUM_FRAMES_IN_FLIGHT behind, let the driver hand us fresh storage instead of waiting.
+	++m_currentFrameStats.m_numFenceMisses;
+	Orphan();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void TransientGeometryBuffer::Orphan()
+{
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, m_vboID );
+	glBufferData( GL_ARRAY_BUFFER, m_vertexSegmentSize * NUM_FRAMES_IN_FLIGHT, nullptr, GL_STREAM_DRAW );
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, m_iboID ); //Not GL_ELEMENT_ARRAY_BUFFER, that would rebind whatever VAO is current.
+	glBufferData( GL_ARRAY_BUFFER, m_indexSegmentSize * NUM_FRAMES_IN_FLIGHT, nullptr, GL_STREAM_DRAW );
+
+	//Old storage stays alive driver-side for any draws still reading it, so nothing left to fence.
+	for ( unsigned int segmentIndex = 0; segmentIndex < NUM_FRAMES_IN_FLIGHT; segmentIndex++ )
+	{
+		if ( m_segmentFences[ segmentIndex ] == nullptr )
+			continue;
+
+		glDeleteSync( (GLsync)m_segmentFences[ segmentIndex ] );
+		m_segmentFences[ segmentIndex ] = nullptr;
+	}
+
+	++m_currentFrameStats.m_numOrphans;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void* TransientGeometryBuffer::MapRange( unsigned int target, unsigned int bufferID, unsigned int offset, unsigned int numBytes )
+{
+	RenderStateCache::BindBuffer( target, bufferID );
+
+	//Unsynchronized is safe: the segment's fence passed, or the storage was just orphaned.
+	return glMapBufferRange( target, offset, numBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+unsigned int TransientGeometryBuffer::CreateOrGetVertexArrayForMaterial( Material* material )
+{
+	auto found = m_vaoIDsPerMaterial.find( material );
+	if ( found != m_vaoIDsPerMaterial.end() )
+		return found->second;
+
+	unsigned int vaoID;
+	glGenVertexArrays( 1, &vaoID );
+	ASSERT_OR_DIE( vaoID != NULL, "glGenVertexArrays failed in TransientGeometryBuffer::CreateOrGetVertexArrayForMaterial()" );
+
+	//As in MeshRenderer::SetMaterial, but only ever once per material since orphaning keeps the buffer names.
+	RenderStateCache::BindVertexArray( vaoID );
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, m_vboID );
+	RenderStateCache::BindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_iboID );
+
+	for ( unsigned int attributeIndex = 0; attributeIndex < m_vertexDefinition->GetNumAttributes(); attributeIndex++ )
+	{
+		const VertexAttribute* attr = m_vertexDefinition->GetAttributeAtIndex( attributeIndex );
+		material->BindInputAttribute( attr->m_attributeName.c_str(), attr->m_count, attr->m_fieldType,
+									  attr->m_normalized, m_vertexDefinition->GetVertexSize(), attr->m_offset );
+	}
+
+	m_vaoIDsPerMaterial[ material ] = vaoID;
+	return vaoID;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+
+#include <map>
+#include <vector>
+#include "Engine/EngineCommon.hpp"
+
+
+//-----------------------------------------------------------------------------
+class Material;
+class VertexDefinition;
+
+
+//-----------------------------------------------------------------------------
+struct TransientDrawKey //Everything that has to match for two immediate-mode draws to share one glDraw* call.
+{
+	Material* m_material;
+	VertexGroupingRule m_vertexGroupingRule;
+	unsigned int m_diffuseTextureID;
+	bool m_usesIndices;
+
+	bool operator==( const TransientDrawKey& other ) const
+	{
+		return ( m_material == other.m_material ) && ( m_vertexGroupingRule == other.m_vertexGroupingRule )
+			&& ( m_diffuseTextureID == other.m_diffuseTextureID ) && ( m_usesIndices == other.m_usesIndices );
+	}
+	bool operator!=( const TransientDrawKey& other ) const { return !( *this == other ); }
+};
+
+
+//-----------------------------------------------------------------------------
+struct TransientGeometryStats
+{
+	TransientGeometryStats() { Clear(); }
+	void Clear() { m_numDrawsSubmitted = m_numDrawCallsIssued = m_numSplitDraws = m_numOversizedDraws = m_numOrphans = m_numFenceMisses = m_numBytesUploaded = 0; }
+
+	unsigned int m_numDrawsSubmitted; //Calls into Draw().
+	unsigned int m_numDrawCallsIssued; //glDraw* calls after merging.
+	unsigned int m_numSplitDraws; //Too big for a frame's segment, so split into several on whole primitives.
+	unsigned int m_numOversizedDraws; //Too big and couldn't be split (indexed, strips, loops), left to the caller's old path.
+	unsigned int m_numOrphans; //glBufferData( NULL ) instead of waiting on the GPU.
+	unsigned int m_numFenceMisses; //Came back around to a segment the GPU hadn't finished reading.
+	unsigned int m_numBytesUploaded;
+};
+
+
+//-----------------------------------------------------------------------------
+//Backs TheRenderer's DrawVertexArray*_PCT calls, which used to make (and so glGenBuffers + glBufferData) a new Mesh per call.
+//One persistent VBO/IBO pair is split into a segment per frame in flight, sub-allocated front to back as batches flush.
+//EndFrame() fences the segment it just filled; a segment is only written again once its fence has passed,
+//and if it hasn't (or a frame overflows its segment) the buffers are orphaned rather than stalling on the GPU.
+//Consecutive draws with equal TransientDrawKeys are staged CPU-side and merged into one draw call. Uniforms other than the
+//keyed diffuse texture are read at flush, so the staged material's ShaderProgram flushes the batch before any of them changes.
+class TransientGeometryBuffer
+{
+public:
+	TransientGeometryBuffer( const VertexDefinition& vertexDefinition, unsigned int vertexBytesPerFrame, unsigned int indexBytesPerFrame );
+	~TransientGeometryBuffer();
+
+	//Non-indexed lists too big for a segment are split up. False if too big otherwise, caller should draw it some other way.
+	bool Draw( const TransientDrawKey& key, const void* vertexData, unsigned int numVertices, const unsigned int* indices, unsigned int numIndices );
+	void Flush(); //Issues the staged batch. Call before any state the batch's draw depends on changes.
+	void EndFrame(); //Flushes, fences this frame's segment, and moves on to the next.
+	void OnStagedUniformChanging( int uniformHandle ); //From the staged material's ShaderProgram, see SetPendingTransientBatch.
+
+	void SetBatchingEnabled( bool newVal ) { Flush(); m_isBatchingEnabled = newVal; }
+	bool IsBatchingEnabled() const { return m_isBatchingEnabled; }
+	const TransientGeometryStats& GetLastFrameStats() const { return m_lastFrameStats; }
+	unsigned int GetVertexBytesPerFrame() const { return m_vertexSegmentSize; }
+	unsigned int GetIndexBytesPerFrame() const { return m_indexSegmentSize; }
+
+
+private:
+	static const unsigned int NUM_FRAMES_IN_FLIGHT = 3;
+
+	static bool IsListGroupingRule( VertexGroupingRule rule ); //Only lists concatenate cleanly, strips and loops would join up across draws.
+	static unsigned int GetNumVerticesPerPrimitive( VertexGroupingRule listRule );
+	void StageDraw( const TransientDrawKey& key, const void* vertexData, unsigned int numVertices, const unsigned int* indices, unsigned int numIndices );
+	unsigned int CreateOrGetVertexArrayForMaterial( Material* material );
+	void Orphan();
+	void* MapRange( unsigned int target, unsigned int bufferID, unsigned int offset, unsigned int numBytes );
+
+	const VertexDefinition* m_vertexDefinition;
+	unsigned int m_vertexSize;
+	unsigned int m_vboID;
+	unsigned int m_iboID;
+	unsigned int m_vertexSegmentSize;
+	unsigned int m_indexSegmentSize;
+	std::map< Material*, unsigned int > m_vaoIDsPerMaterial; //Attribute locations differ per shader, but the buffers never change name.
+
+	unsigned int m_currentSegment;
+	unsigned int m_vertexHead; //Byte offsets within the current segment.
+	unsigned int m_indexHead;
+	void* m_segmentFences[ NUM_FRAMES_IN_FLIGHT ]; //GLsync, opaque here so this header needn't pull in GL.
+
+	bool m_isBatchingEnabled;
+	TransientDrawKey m_stagedKey;
+	int m_stagedDiffuseTextureHandle; //Changes to it don't flush: it's part of the key, and Flush sets it back for its draw.
+	std::vector< unsigned char > m_stagedVertices;
+	std::vector< unsigned int > m_stagedIndices; //Rebased to the start of the batch, rebased again onto the ring in Flush().
+	unsigned int m_numStagedVertices;
+
+	TransientGeometryStats m_currentFrameStats;
+	TransientGeometryStats m_lastFrameStats;
+};
@@ -5,7 +5,13 @@
 #include <windows.h>
 #include <gl/gl.h>
 #include "Engine/Renderer/OpenGLExtensions.hpp"
+#include "Engine/Renderer/RenderStateCache.hpp"
 #include "Engine/Error/ErrorWarningAssert.hpp"
+#include "Engine/EngineCommon.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC unsigned int VertexBuffer::s_numBuffersCreated = 0;
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -28,6 +34,7 @@ VertexBuffer::VertexBuffer( unsigned int numElements, unsigned int sizeOfElement
 	, m_bufferUsage( usage )
 {
 	glGenBuffers( 1, &m_bufferID );
+	++s_numBuffersCreated;
 
 	UpdateBuffer( data, numElements, sizeOfElementInBytes, usage );
 }
@@ -37,6 +44,7 @@ VertexBuffer::VertexBuffer( unsigned int numElements, unsigned int sizeOfElement
 VertexBuffer::~VertexBuffer()
 {
 	glDeleteBuffers( 1, &m_bufferID );
+	RenderStateCache::OnBufferDeleted( m_bufferID );
 }
 
 
@@ -48,9 +56,7 @@ void VertexBuffer::UpdateBuffer( const void* data, unsigned int numElements, uns
 	if ( bufferUsage != USE_LAST_USAGE )
 		m_bufferUsage = bufferUsage;
 
-	glBindBuffer( GL_ARRAY_BUFFER, m_bufferID );
+	RenderStateCache::BindBuffer( GL_ARRAY_BUFFER, m_bufferID );
 
 	glBufferData( GL_ARRAY_BUFFER, GetBufferSize(), data, GetOpenGLBufferUsage( m_bufferUsage ) );
-
-	glBindBuffer( GL_ARRAY_BUFFER, NULL );
 }
@@ -26,6 +26,7 @@ public:
 	inline BufferUsage GetBufferUsage() const { return m_bufferUsage; }
 	inline unsigned int GetBufferSize() const { return m_elementSize * m_numElements; }
 	void UpdateBuffer( const void* data, unsigned int numElements, unsigned int sizeOfElementInBytes, BufferUsage bufferUsage = USE_LAST_USAGE ); //void* because array can be of vertex class types, or uint indices.
+	static unsigned int GetNumBuffersCreated() { return s_numBuffersCreated; } //Running total, TheRenderer diffs it per frame.
 
 
 private:
@@ -34,4 +35,6 @@ private:
 	unsigned int m_numElements;
 	unsigned int m_elementSize; //Use VertexDefinition instead?
 	BufferUsage m_bufferUsage;
+
+	static unsigned int s_numBuffersCreated;
 };
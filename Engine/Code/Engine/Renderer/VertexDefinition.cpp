@@ -13,6 +13,7 @@ unsigned int GetOpenGLVertexFieldType( VertexFieldType engineVertexFieldType )
 	{
 	case VertexFieldType::VERTEX_FIELD_TYPE_FLOAT: return GL_FLOAT;
 	case VertexFieldType::VERTEX_FIELD_TYPE_UNSIGNED_BYTE: return GL_UNSIGNED_BYTE;
+	case VertexFieldType::VERTEX_FIELD_TYPE_UNSIGNED_SHORT: return GL_UNSIGNED_SHORT;
 	case VertexFieldType::VERTEX_FIELD_TYPE_UNSIGNED_INT: return GL_UNSIGNED_INT;
 	default: ERROR_AND_DIE( "Unsupported VertexFieldType in GetOpenGLVertexFieldType in VertexAttribute.cpp!" );
 	}
@@ -26,6 +27,7 @@ size_t VertexAttribute::GetTypeSize( VertexFieldType type ) const
 	{
 	case VERTEX_FIELD_TYPE_FLOAT: return sizeof( float );
 	case VERTEX_FIELD_TYPE_UNSIGNED_BYTE: return sizeof( unsigned char );
+	case VERTEX_FIELD_TYPE_UNSIGNED_SHORT: return sizeof( unsigned short );
 	case VERTEX_FIELD_TYPE_UNSIGNED_INT: return sizeof( unsigned int );
 	default: ERROR_AND_DIE( "Unsupported VertexFieldType in VertexAttribute::GetTypeSize!" );
 	}
@@ -8,6 +8,7 @@ enum VertexFieldType
 {
 	VERTEX_FIELD_TYPE_FLOAT,
 	VERTEX_FIELD_TYPE_UNSIGNED_BYTE,
+	VERTEX_FIELD_TYPE_UNSIGNED_SHORT,
 	VERTEX_FIELD_TYPE_UNSIGNED_INT
 };
 unsigned int GetOpenGLVertexFieldType( VertexFieldType engineVertexFieldType );
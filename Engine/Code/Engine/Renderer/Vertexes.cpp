@@ -80,6 +80,19 @@ const Vector4f Vertex3D_Superset::DEFAULT_BONE_WEIGHTS = DEFAULT_BONE_WEIGHTS;
 const Vector4<unsigned int> Vertex3D_Superset::DEFAULT_JOINT_INDICES = DEFAULT_JOINT_INDICES;
 
 
+//--------------------------------------------------------------------------------------------------------------
+const VertexAttribute SpriteInstance::ATTRIBUTES[] =
+{
+	VertexAttribute( "inInstancePosition", 2, VERTEX_FIELD_TYPE_FLOAT, false, offsetof( SpriteInstance, m_position ) ),
+	VertexAttribute( "inInstanceMinsFromPivot", 2, VERTEX_FIELD_TYPE_FLOAT, false, offsetof( SpriteInstance, m_minsFromPivot ) ),
+	VertexAttribute( "inInstanceSize", 2, VERTEX_FIELD_TYPE_FLOAT, false, offsetof( SpriteInstance, m_size ) ),
+	VertexAttribute( "inInstanceRotation", 1, VERTEX_FIELD_TYPE_FLOAT, false, offsetof( SpriteInstance, m_rotationDegrees ) ),
+	VertexAttribute( "inInstanceTint", 4, VERTEX_FIELD_TYPE_UNSIGNED_BYTE, true, offsetof( SpriteInstance, m_tint ) ),
+	VertexAttribute( "inInstanceUVRect", 4, VERTEX_FIELD_TYPE_UNSIGNED_SHORT, true, offsetof( SpriteInstance, m_uvRect ) )
+};
+const VertexDefinition SpriteInstance::DEFINITION = VertexDefinition( sizeof( SpriteInstance ), 6, ATTRIBUTES ); //Must be below attribute definition.
+
+
 //--------------------------------------------------------------------------------------------------------------
 Vertex2D_PCT::Vertex2D_PCT( const Vector2f& position, const Vector2f& texCoords /*= Vector2f::ZERO*/, const Rgba& color /*= Rgba::WHITE */ )
 	: m_position( position )
@@ -140,6 +140,26 @@ private:
 };
 
 
+struct SpriteInstance //Per-instance rather than per-vertex: the vertex shader expands one over a unit quad. See SpriteInstanceBuffer.
+{
+public:
+
+	Vector2f m_position; //World position of the pivot.
+	Vector2f m_minsFromPivot; //Unrotated bottom-left corner, scale already applied.
+	Vector2f m_size; //Virtual dimensions, scale already applied.
+	float m_rotationDegrees; //SPRITE_ANGLE_CORRECTION already applied.
+	Rgba m_tint;
+	unsigned short m_uvRect[ 4 ]; //Normalized to [0,1]: mins u, mins v, maxs u, maxs v. e.g. a cell of an atlas.
+
+	static const VertexDefinition DEFINITION;
+
+
+private:
+
+	static const VertexAttribute ATTRIBUTES[];
+};
+
+
 typedef void( VertexCopyCallback )( void* dest, const Vertex3D_Superset& src );
 VertexCopyCallback* GetCopyFunctionForVertexDefinition( const VertexDefinition* vdefn );
 void CopyToVertex3D_PCT( void* dest, const Vertex3D_Superset& src );
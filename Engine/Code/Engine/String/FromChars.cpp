@@ -0,0 +1,351 @@
+#include "Engine/String/FromChars.hpp"
+#include <limits.h>
+#include <math.h>
+
+
+//--------------------------------------------------------------------------------------------------------------
+static const double s_POWERS_OF_TEN[] = //Exactly representable in a double up to 1e22, past that we fall back on pow().
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int s_MAX_EXACT_POWER_OF_TEN = 22;
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline bool IsDigit( char c )
+{
+	return c >= '0' && c <= '9';
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline const char* SkipBlanks( const char* first, const char* last )
+{
+	while ( first < last && ( *first == ' ' || *first == '\t' ) )
+		++first;
+
+	return first;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static inline FromCharsResult MakeResult( const char* ptr, bool succeeded )
+{
+	FromCharsResult result = { ptr, succeeded };
+	return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Eats blanks then the separator, for the comma/tilde between components.
+static inline bool ConsumeSeparator( const char*& cursor, const char* last, char separator )
+{
+	const char* afterBlanks = SkipBlanks( cursor, last );
+	if ( afterBlanks >= last || *afterBlanks != separator )
+		return false;
+
+	cursor = afterBlanks + 1;
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static FromCharsResult ParseUnsignedMagnitude( const char* first, const char* last, unsigned int maxMagnitude, unsigned int& out_magnitude )
+{
+	const char* cursor = first;
+	unsigned int magnitude = 0;
+
+	while ( cursor < last && IsDigit( *cursor ) )
+	{
+		unsigned int digit = (unsigned int)( *cursor - '0' );
+		if ( magnitude > ( maxMagnitude - digit ) / 10 ) //Would overflow.
+			return MakeResult( first, false );
+
+		magnitude = magnitude * 10 + digit;
+		++cursor;
+	}
+
+	if ( cursor == first )
+		return MakeResult( first, false );
+
+	out_magnitude = magnitude;
+	return MakeResult( cursor, true );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+FromCharsResult FromChars( const char* first, const char* last, unsigned int& out_value )
+{
+	const char* cursor = SkipBlanks( first, last );
+	if ( cursor < last && *cursor == '+' )
+		++cursor;
+
+	unsigned int magnitude = 0;
+	FromCharsResult result = ParseUnsignedMagnitude( cursor, last, UINT_MAX, magnitude );
+	if ( !result.succeeded )
+		return MakeResult( first, false );
+
+	out_value = magnitude;
+	return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+FromCharsResult FromChars( const char* first, const char* last, int& out_value )
+{
+	const char* cursor = SkipBlanks( first, last );
+	bool isNegative = false;
+	if ( cursor < last && ( *cursor == '-' || *cursor == '+' ) )
+	{
+		isNegative = ( *cursor == '-' );
+		++cursor;
+	}
+
+	unsigned int maxMagnitude = isNegative ? (unsigned int)INT_MAX + 1u : (unsigned int)INT_MAX;
+	unsigned int magnitude = 0;
+	FromCharsResult result = ParseUnsignedMagnitude( cursor, last, maxMagnitude, magnitude );
+	if ( !result.succeeded )
+		return MakeResult( first, false );
+
+	out_value = isNegative ? (int)( 0u - magnitude ) : (int)magnitude;
+	return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+FromCharsResult FromChars( const char* first, const char* last, float& out_value )
+{
+	const char* cursor = SkipBlanks( first, last );
+	bool isNegative = false;
+	if ( cursor < last && ( *cursor == '-' || *cursor == '+' ) )
+	{
+		isNegative = ( *cursor == '-' );
+		++cursor;
+	}
+
+	double mantissa = 0.0;
+	int numDigits = 0;
+	int decimalExponent = 0;
+
+	while ( cursor < last && IsDigit( *cursor ) )
+	{
+		mantissa = mantissa * 10.0 + ( *cursor - '0' );
+		++numDigits;
+		++cursor;
+	}
+
+	if ( cursor < last && *cursor == '.' )
+	{
+		++cursor;
+		while ( cursor < last && IsDigit( *cursor ) )
+		{
+			mantissa = mantissa * 10.0 + ( *cursor - '0' );
+			--decimalExponent;
+			++numDigits;
+			++cursor;
+		}
+	}
+
+	if ( numDigits == 0 ) //Catches ".", "-", and "" alike.
+		return MakeResult( first, false );
+
+	//Only commit to the exponent if it has digits, else leave the 'e' for the caller like from_chars does.
+	if ( cursor < last && ( *cursor == 'e' || *cursor == 'E' ) )
+	{
+		const char* exponentCursor = cursor + 1;
+		bool isExponentNegative = false;
+		if ( exponentCursor < last && ( *exponentCursor == '-' || *exponentCursor == '+' ) )
+		{
+			isExponentNegative = ( *exponentCursor == '-' );
+			++exponentCursor;
+		}
+
+		unsigned int exponentMagnitude = 0;
+		FromCharsResult exponentResult = ParseUnsignedMagnitude( exponentCursor, last, 9999, exponentMagnitude );
+		if ( exponentResult.succeeded )
+		{
+			decimalExponent += isExponentNegative ? -(int)exponentMagnitude : (int)exponentMagnitude;
+			cursor = exponentResult.ptr;
+		}
+	}
+
+	double value = mantissa;
+	if ( decimalExponent < 0 )
+		value = ( -decimalExponent <= s_MAX_EXACT_POWER_OF_TEN ) ? mantissa / s_POWERS_OF_TEN[ -decimalExponent ] : mantissa * pow( 10.0, decimalExponent );
+	else if ( decimalExponent > 0 )
+		value = ( decimalExponent <= s_MAX_EXACT_POWER_OF_TEN ) ? mantissa * s_POWERS_OF_TEN[ decimalExponent ] : mantissa * pow( 10.0, decimalExponent );
+
+	out_value = (float)( isNegative ? -value : value );
+	return MakeResult( cursor, true );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool MatchesWordIgnoringCase( const char* cursor, const char* last, const char* lowercaseWord, size_t wordLength )
+{
+	if ( (size_t)( last - cursor ) < wordLength )
+		return false;
+
+	for ( size_t charIndex = 0; charIndex < wordLength; charIndex++ )
+	{
+		char c = cursor[ charIndex ];
+		if ( c >= 'A' && c <= 'Z' )
+			c = (char)( c - 'A' + 'a' );
+
+		if ( c != lowercaseWord[ charIndex ] )
+			return false;
+	}
+
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+FromCharsResult FromChars( const char* first, const char* last, bool& out_value )
+{
+	const char* cursor = SkipBlanks( first, last );
+
+	if ( MatchesWordIgnoringCase( cursor, last, "true", 4 ) )
+	{
+		out_value = true;
+		return MakeResult( cursor + 4, true );
+	}
+	if ( MatchesWordIgnoringCase( cursor, last, "false", 5 ) )
+	{
+		out_value = false;
+		return MakeResult( cursor + 5, true );
+	}
+	if ( cursor < last && ( *cursor == '1' || *cursor == '0' ) )
+	{
+		out_value = ( *cursor == '1' );
+		return MakeResult( cursor + 1, true );
+	}
+
+	return MakeResult( first, false );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Shared by the vector types: N components of ComponentType split on separator, all or nothing.
+template < typename ComponentType >
+static FromCharsResult ParseComponents( const char* first, const char* last, ComponentType* out_components, int numComponents, char separator )
+{
+	const char* cursor = first;
+	for ( int componentIndex = 0; componentIndex < numComponents; componentIndex++ )
+	{
+		if ( componentIndex > 0 && !ConsumeSeparator( cursor, last, separator ) )
+			return MakeResult( first, false );
+
+		FromCharsResult componentResult = FromChars( cursor, last, out_components[ componentIndex ] );
+		if ( !componentResult.succeeded )
+			return MakeResult( first, false );
+
+		cursor = componentResult.ptr;
+	}
+
+	return MakeResult( cursor, true );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+FromCharsResult FromChars( const char* first, const char* last, Vector2f& out_value )
+{
+	float components[ 2 ];
+	FromCharsResult result = ParseComponents( first, last, components, 2, ',' );
+	if ( result.succeeded )
+		out_value = Vector2f( components[ 0 ], components[ 1 ] );
+
+	return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+FromCharsResult FromChars( const char* first, const char* last, Vector2i& out_value )
+{
+	int components[ 2 ];
+	FromCharsResult result = ParseComponents( first, last, components, 2, ',' );
+	if ( result.succeeded )
+		out_value = Vector2i( components[ 0 ], components[ 1 ] );
+
+	return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+FromCharsResult FromChars( const char* first, const char* last, Vector3f& out_value )
+{
+	float components[ 3 ];
+	FromCharsResult result = ParseComponents( first, last, components, 3, ',' );
+	if ( result.succeeded )
+		out_value = Vector3f( components[ 0 ], components[ 1 ], components[ 2 ] );
+
+	return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+FromCharsResult FromChars( const char* first, const char* last, Rgba& out_value )
+{
+	unsigned int components[ 4 ] = { 0, 0, 0, 255 };
+	FromCharsResult result = ParseComponents( first, last, components, 3, ',' );
+	if ( !result.succeeded )
+		return result;
+
+	const char* afterAlpha = result.ptr;
+	if ( ConsumeSeparator( afterAlpha, last, ',' ) ) //Alpha's optional.
+	{
+		FromCharsResult alphaResult = FromChars( afterAlpha, last, components[ 3 ] );
+		if ( !alphaResult.succeeded )
+			return MakeResult( first, false );
+
+		result.ptr = alphaResult.ptr;
+	}
+
+	for ( int componentIndex = 0; componentIndex < 4; componentIndex++ )
+	{
+		if ( components[ componentIndex ] > 255 )
+			return MakeResult( first, false );
+	}
+
+	out_value = Rgba( (byte_t)components[ 0 ], (byte_t)components[ 1 ], (byte_t)components[ 2 ], (byte_t)components[ 3 ] );
+	return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+template < typename IntervalElement >
+static FromCharsResult ParseInterval( const char* first, const char* last, Interval<IntervalElement>& out_value )
+{
+	IntervalElement minInclusive;
+	FromCharsResult result = FromChars( first, last, minInclusive );
+	if ( !result.succeeded )
+		return result;
+
+	IntervalElement maxInclusive = minInclusive; //A lone value means a zero-width interval, same as the string ctor.
+	const char* afterMin = result.ptr;
+	if ( ConsumeSeparator( afterMin, last, '~' ) )
+	{
+		result = FromChars( afterMin, last, maxInclusive );
+		if ( !result.succeeded )
+			return MakeResult( first, false );
+	}
+
+	out_value.minInclusive = minInclusive;
+	out_value.maxInclusive = maxInclusive;
+	return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+FromCharsResult FromChars( const char* first, const char* last, Interval<int>& out_value )
+{
+	return ParseInterval( first, last, out_value );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+FromCharsResult FromChars( const char* first, const char* last, Interval<float>& out_value )
+{
+	return ParseInterval( first, last, out_value );
+}
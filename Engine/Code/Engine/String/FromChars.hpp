@@ -0,0 +1,72 @@
+#pragma once
+
+
+#include "Engine/String/StringView.hpp"
+#include "Engine/String/StringUtils.hpp"
+#include "Engine/Math/Vector2.hpp"
+#include "Engine/Math/Vector3.hpp"
+#include "Engine/Math/Interval.hpp"
+#include "Engine/Renderer/Rgba.hpp"
+
+
+//-----------------------------------------------------------------------------
+//std::from_chars-style parsing (v140 doesn't ship it): no allocation, no locale, no null terminator needed.
+//Each FromChars reads from [first, last) and returns where it stopped, or succeeded == false with ptr == first.
+//Leading spaces/tabs are skipped before every number, so "1, 2" and "1,2" both parse.
+struct FromCharsResult
+{
+	const char* ptr;
+	bool succeeded;
+};
+
+
+//-----------------------------------------------------------------------------
+FromCharsResult FromChars( const char* first, const char* last, int& out_value );
+FromCharsResult FromChars( const char* first, const char* last, unsigned int& out_value );
+FromCharsResult FromChars( const char* first, const char* last, float& out_value ); //Decimal and exponent forms, accumulated in double.
+FromCharsResult FromChars( const char* first, const char* last, bool& out_value ); //true/false, 1/0.
+FromCharsResult FromChars( const char* first, const char* last, Vector2f& out_value ); //"x,y"
+FromCharsResult FromChars( const char* first, const char* last, Vector2i& out_value ); //"x,y"
+FromCharsResult FromChars( const char* first, const char* last, Vector3f& out_value ); //"x,y,z"
+FromCharsResult FromChars( const char* first, const char* last, Rgba& out_value ); //"r,g,b" or "r,g,b,a" as 0-255 bytes, same as Rgba::ToString.
+FromCharsResult FromChars( const char* first, const char* last, Interval<int>& out_value ); //"min~max" or a lone "n".
+FromCharsResult FromChars( const char* first, const char* last, Interval<float>& out_value );
+
+
+//-----------------------------------------------------------------------------
+//Fallback for anything else with a string ctor: allocates, so add an overload above for anything read often.
+template < typename ValueType >
+FromCharsResult FromChars( const char* first, const char* last, ValueType& out_value )
+{
+	SetTypeFromUnwrappedString( out_value, std::string( first, last ) );
+
+	FromCharsResult result = { last, true };
+	return result;
+}
+
+
+//-----------------------------------------------------------------------------
+//Whole-string parse: succeeds only if everything but surrounding whitespace was consumed. Leaves out_value untouched on failure.
+template < typename ValueType >
+bool ParseFromStringView( const StringView& text, ValueType& out_value )
+{
+	StringView trimmed = text.GetTrimmed();
+	ValueType parsedValue = out_value;
+
+	FromCharsResult result = FromChars( trimmed.begin(), trimmed.end(), parsedValue );
+	if ( !result.succeeded || result.ptr != trimmed.end() )
+		return false;
+
+	out_value = parsedValue;
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+//Strings just copy, no trimming, to match GetXMLAttributeAsString.
+template <>
+inline bool ParseFromStringView<std::string>( const StringView& text, std::string& out_value )
+{
+	out_value.assign( text.begin(), text.size() );
+	return true;
+}
@@ -81,6 +81,18 @@ inline void SetTypeFromUnwrappedString<int>( int& destination_out, const std::st
 	destination_out = static_cast<int>( atoi( asString.c_str() ) );
 }
 
+template<>
+inline void SetTypeFromUnwrappedString<unsigned int>( unsigned int& destination_out, const std::string& asString )
+{
+	destination_out = static_cast<unsigned int>( strtoul( asString.c_str(), nullptr, 10 ) );
+}
+
+template<>
+inline void SetTypeFromUnwrappedString<bool>( bool& destination_out, const std::string& asString )
+{
+	destination_out = ( asString == "true" ) || ( atoi( asString.c_str() ) != 0 );
+}
+
 template<>
 inline void SetTypeFromUnwrappedString<char>( char& destination_out, const std::string& asString )
 {
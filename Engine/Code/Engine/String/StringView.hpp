@@ -0,0 +1,48 @@
+#pragma once
+
+
+#include <string>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+//Non-owning ( pointer, length ) window into someone else's chars, for parsing without copying. Stand-in for C++17 std::string_view.
+//Not necessarily null-terminated, so never hand m_data to a C string function.
+struct StringView
+{
+	StringView() : m_data( nullptr ), m_length( 0 ) {}
+	StringView( const char* cString ) : m_data( cString ), m_length( ( cString != nullptr ) ? strlen( cString ) : 0 ) {}
+	StringView( const char* data, size_t length ) : m_data( data ), m_length( length ) {}
+	StringView( const std::string& str ) : m_data( str.data() ), m_length( str.size() ) {}
+
+	const char* begin() const { return m_data; }
+	const char* end() const { return m_data + m_length; }
+	size_t size() const { return m_length; }
+	bool IsNull() const { return m_data == nullptr; } //i.e. the attribute/token wasn't there at all, vs. present but "".
+	bool IsEmpty() const { return m_length == 0; }
+	char operator[]( size_t index ) const { return m_data[ index ]; }
+
+	bool operator==( const StringView& other ) const { return m_length == other.m_length && ( m_length == 0 || memcmp( m_data, other.m_data, m_length ) == 0 ); }
+	bool operator!=( const StringView& other ) const { return !( *this == other ); }
+
+	StringView GetTrimmed() const; //Strips leading and trailing whitespace.
+	std::string ToString() const { return ( m_data == nullptr ) ? std::string() : std::string( m_data, m_length ); }
+
+	const char* m_data;
+	size_t m_length;
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+inline StringView StringView::GetTrimmed() const
+{
+	const char* first = begin();
+	const char* last = end();
+
+	while ( first < last && ( *first == ' ' || *first == '\t' || *first == '\n' || *first == '\r' ) )
+		++first;
+	while ( last > first && ( last[ -1 ] == ' ' || last[ -1 ] == '\t' || last[ -1 ] == '\n' || last[ -1 ] == '\r' ) )
+		--last;
+
+	return StringView( first, last - first );
+}
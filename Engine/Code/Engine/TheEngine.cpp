@@ -6,6 +6,16 @@
 #include "Engine/Audio/TheAudio.hpp"
 #include "Engine/Core/TheConsole.hpp"
 #include "Engine/Renderer/DebugRenderCommand.hpp"
+#include "Engine/Renderer/AsyncTextureLoader.hpp"
+#include "Engine/Physics/DynamicsBatch.hpp"
+#include "Engine/Physics/Cloth.hpp"
+#include "Engine/Physics/EphanovParticleSystem.hpp"
+#include "Engine/Math/NoiseBatch.hpp"
+#include "Engine/Math/Matrix44.hpp"
+#include "Engine/Memory/Callstack.hpp"
+#include "Engine/Core/ConsoleHistory.hpp"
+#include "Engine/FileUtils/XMLStreamReader.hpp"
+#include "Engine/Renderer/MeshOptimizer.hpp"
 #include "Game/TheGame.hpp"
 
 //Major Utils
@@ -34,11 +44,14 @@ static void RegisterConsoleCommands()
 	//AES A3
 	g_theConsole->RegisterCommand( "MeshSaveLastMeshBuilderMade", MeshSaveLastMeshBuilderMade );
 	g_theConsole->RegisterCommand( "MeshLoadFromFile", MeshLoadFromFile );
+	g_theConsole->RegisterCommand( "MeshBuildLODsForLastMeshBuilderMade", MeshBuildLODsForLastMeshBuilderMade );
+	g_theConsole->RegisterCommand( "MeshLODTest", MeshLODTest );
 
 	//AES A4
 	g_theConsole->RegisterCommand( "SkeletonSaveLastSkeletonMade", SkeletonSaveLastSkeletonMade );
 	g_theConsole->RegisterCommand( "SkeletonLoadFromFile", SkeletonLoadFromFile );
 	g_theConsole->RegisterCommand( "DebugRenderClearCommands", DebugRenderClearCommands );
+	g_theConsole->RegisterCommand( "DebugRenderBenchmark", DebugRenderBenchmark );
 	TODO( "Make a separate 'add' console command for each of the DebugRenderCommands!" );
 
 	//AES A5
@@ -47,6 +60,32 @@ static void RegisterConsoleCommands()
 
 	//SD5 A2
 	Logger::RegisterConsoleCommands();
+
+	//Async loading
+	g_theConsole->RegisterCommand( "AsyncTextureStats", AsyncTextureLoader::PrintStats );
+
+	//Batched physics
+	g_theConsole->RegisterCommand( "DynamicsBenchmark", DynamicsBatch::RunBenchmark );
+	g_theConsole->RegisterCommand( "ClothTest", Cloth::RunTest );
+	g_theConsole->RegisterCommand( "EphanovParticleBenchmark", EphanovParticleSystem::RunBenchmark );
+
+	//Batched noise
+	g_theConsole->RegisterCommand( "NoiseBatchTest", NoiseBatchTest );
+	g_theConsole->RegisterCommand( "NoiseBatchBenchmark", NoiseBatchBenchmark );
+
+	//SIMD math
+	g_theConsole->RegisterCommand( "Matrix44Test", Matrix44Test );
+	g_theConsole->RegisterCommand( "Matrix44Benchmark", Matrix44Benchmark );
+
+	//Callstacks
+	g_theConsole->RegisterCommand( "CallstackTest", Callstack::RunTest );
+	g_theConsole->RegisterCommand( "CallstackBenchmark", Callstack::RunBenchmark );
+
+	//Console history
+	g_theConsole->RegisterCommand( "ConsoleHistoryTest", ConsoleHistoryTest );
+
+	//XML
+	g_theConsole->RegisterCommand( "XMLStreamReaderTest", XMLStreamReaderTest );
 }
 
 
@@ -59,7 +98,7 @@ void TheEngine::Startup( double screenWidth, double screenHeight )
 
 	//Make sure Renderer ctor comes first so that default texture gets ID of 1. Args configure FBO dimensions.
 	g_theRenderer = new TheRenderer( screenWidth, screenHeight );
-	g_theDebugRenderCommands = new std::list< DebugRenderCommand* >();
+	StartupDebugCommands();
 
 	g_theAudio = new AudioSystem(); //Example usage:
 	// [static] SoundID musicID = g_theAudio->CreateOrGetSound( "Data/Audio/Yume Nikki mega mix (SD).mp3" );
@@ -69,10 +108,12 @@ void TheEngine::Startup( double screenWidth, double screenHeight )
 	g_theGame = new TheGame();
 
 	g_theInput = new TheInput();
+#ifndef ENGINE_HEADLESS //No window to take focus or own a cursor, so input stays at its all-released defaults.
 	Vector2i screenCenter = Vector2i( (int)( screenWidth / 2.0 ), (int)( screenHeight / 2.0 ) );
 	g_theInput->SetCursorSnapToPos( screenCenter );
 	g_theInput->OnGainedFocus();
 	g_theInput->HideCursor();
+#endif
 
 	g_theConsole = new TheConsole(screenWidth/2., screenHeight/2., screenWidth, screenHeight);
 	//g_theConsole = new TheConsole( 0.0, 30.0, screenWidth, screenHeight );
@@ -113,6 +154,14 @@ void TheEngine::RunFrame()
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void TheEngine::StepFrame( float fixedDeltaSeconds )
+{
+	//Fixed-timestep, update-only frame for the headless benchmark. Deterministic across machines since dt isn't wall-clock.
+	this->Update( fixedDeltaSeconds );
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 void TheEngine::Update( float deltaSeconds )
 {
@@ -131,6 +180,8 @@ void TheEngine::Update( float deltaSeconds )
 	g_theRenderer->Update( deltaSeconds, g_theGame->GetActiveCamera3D() );
 		//Update uniforms for shader timers, scene MVP, and lights.
 
+	AsyncTextureLoader::Update(); //Uploads whatever the IO threads finished decoding, within its per-frame budget.
+
 	TODO( "Explore passing in 0 to freeze, or other values to rewind, slow, etc." );
 	g_theGame->Update( deltaSeconds );
 
@@ -144,7 +195,7 @@ void TheEngine::Update( float deltaSeconds )
 void TheEngine::RenderDebug3D()
 {
 	if ( g_theRenderer->IsShowingAxes() )
-		AddDebugRenderCommand( new DebugRenderCommandBasis( Vector3f::ZERO, 1000.f, true, 0.f, DEPTH_TEST_DUAL, 10.f ) );
+		AddDebugRenderBasis( Vector3f::ZERO, 1000.f, true, 0.f, DEPTH_TEST_DUAL, 10.f );
 
 	g_theGame->RenderDebug3D();
 }
@@ -252,6 +303,8 @@ void TheEngine::Render()
 
 	g_theConsole->Render();
 
+	g_theRenderer->EndFrame(); //Flushes batched immediate-mode draws and fences their ring segment.
+
 	Profiler::Instance()->EndSample( sample );
 
 	//Main_Win32 should call TheApp's FlipAndPresent() next.
@@ -271,7 +324,7 @@ void TheEngine::Shutdown()
 	delete g_theGame;
 	delete g_theAudio;
 	delete g_theRenderer;
-	delete g_theDebugRenderCommands;
+	ShutdownDebugCommands();
 	delete g_theInput;
 	delete g_theConsole;
 
@@ -280,7 +333,6 @@ void TheEngine::Shutdown()
 	g_theAudio = nullptr;
 	g_theInput = nullptr;
 	g_theRenderer = nullptr;
-	g_theDebugRenderCommands = nullptr;
 	g_theConsole = nullptr;
 }
 
@@ -6,6 +6,7 @@ class TheEngine
 {
 public:
 	void RunFrame();
+	void StepFrame( float fixedDeltaSeconds );
 	void Startup( double screenWidth, double screenHeight );
 	void Shutdown();
 	bool IsQuitting();
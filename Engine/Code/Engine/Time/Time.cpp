@@ -1,5 +1,6 @@
 #include "Engine/Time/Time.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/RandomStream.hpp"
 #include "Engine/EngineCommon.hpp"
 
 
@@ -11,7 +12,10 @@
 //--------------------------------------------------------------------------------------------------------------
 void SeedWindowsRNG()
 {
-	srand( static_cast<unsigned int>( time( NULL ) ) );
+	unsigned int seed = static_cast<unsigned int>( time( NULL ) );
+	srand( seed );
+	RandomStream::SetThreadLocalBaseSeed( seed ); //For threads yet to draw, then this one, which likely already has.
+	RandomStream::GetThreadLocal().Seed( seed );
 }
 
 //--------------------------------------------------------------------------------------------------------------
@@ -4,6 +4,7 @@
 #include "Engine/Error/ErrorWarningAssert.hpp"
 #include "Engine/Core/TheConsole.hpp"
 #include "Engine/Renderer/MeshBuilder.hpp"
+#include "Engine/Renderer/MeshOptimizer.hpp"
 #include "Engine/Renderer/Skeleton.hpp"
 #include "Engine/Renderer/Mesh.hpp"
 #include "Engine/Renderer/ShaderProgram.hpp"
@@ -11,6 +12,7 @@
 #include "Engine/Math/MatrixStack.hpp"
 #include "Engine/Renderer/AnimationSequence.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include "Engine/Time/Time.hpp"
 #include <string>
 
 #if defined( TOOLS_BUILD )
@@ -1192,7 +1194,7 @@ void FBXLoad( Command& args )
 
 			//--//Initial Setting
 			const int MAX_BONES = 200; //In total on skeleton.
-			Matrix4x4f currentBoneTransforms[ MAX_BONES ];
+			Matrix44 currentBoneTransforms[ MAX_BONES ];
 			g_lastLoadedSkeleton->GetBoneMatrices( currentBoneTransforms, MAX_BONES );
 			for ( auto& sp : *ShaderProgram::GetRegistry() )
 				sp.second->SetMatrix4x4( "uBoneMatrices[0]", true, currentBoneTransforms, MAX_BONES );
@@ -1240,6 +1242,17 @@ void MeshSaveLastMeshBuilderMade( Command& args )
 		int outEndianMode;
 		args.GetNextInt( &outEndianMode, 0 );
 
+		int outShouldOptimize;
+		args.GetNextInt( &outShouldOptimize, 0 );
+		if ( outShouldOptimize != 0 )
+		{
+			MeshOptimizationReport report;
+			if ( g_lastLoadedMeshBuilder->Optimize( &report ) )
+				MeshOptimizer::PrintReport( report );
+			else
+				g_theConsole->Printf( "Optimization skipped, the mesh has non-triangle draws. Saving it as is." );
+		}
+
 		const char* filename = outFilename.c_str();
 
 		if ( g_lastLoadedMeshBuilder->WriteToFile( filename, false, outEndianMode ) )
@@ -1250,7 +1263,7 @@ void MeshSaveLastMeshBuilderMade( Command& args )
 	else
 	{
 		g_theConsole->Printf( "Incorrect arguments." );
-		g_theConsole->Printf( "Usage: MeshSaveLastMeshBuilderMade <filename to save to, with extension> [0/1 = Little/Big-Endian]" );
+		g_theConsole->Printf( "Usage: MeshSaveLastMeshBuilderMade <filename to save to, with extension> [0/1 = Little/Big-Endian] [0/1 = Optimize first, reports before/after]" );
 	}
 }
 
@@ -1361,6 +1374,8 @@ void MeshLoadFromFile( Command& args )
 		if ( g_lastLoadedMeshBuilder->ReadFromFile( filename, outEndianMode ) )
 		{
 			g_theConsole->Printf( "Read from file %s successful.", filename );
+			if ( !g_lastLoadedMeshBuilder->GetLODs().empty() )
+				g_theConsole->Printf( "Mesh has %u LODs, see MeshRenderer::SelectLOD.", (unsigned int)g_lastLoadedMeshBuilder->GetLODs().size() );
 			g_theRenderer->AddModel( g_lastLoadedMeshBuilder );
 		}
 		else
@@ -1376,6 +1391,50 @@ void MeshLoadFromFile( Command& args )
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void MeshBuildLODsForLastMeshBuilderMade( Command& args )
+{
+	if ( nullptr == g_lastLoadedMeshBuilder )
+	{
+		g_theConsole->Printf( "No MeshBuilder has been made and stored, use a command like FBXLoad/MeshLoadFromFile first!" );
+		return;
+	}
+
+	if ( !g_lastLoadedMeshBuilder->GetLODs().empty() )
+	{
+		g_theConsole->Printf( "The last MeshBuilder made already has LODs." );
+		return;
+	}
+
+	int outMaxNumLODs;
+	args.GetNextInt( &outMaxNumLODs, 4 );
+	float outTriangleRatioPerLOD;
+	args.GetNextFloat( &outTriangleRatioPerLOD, .5f );
+	float outMaxError;
+	args.GetNextFloat( &outMaxError, INFINITY );
+	if ( ( outMaxNumLODs < 1 ) || ( outTriangleRatioPerLOD <= 0.f ) || ( outTriangleRatioPerLOD >= 1.f ) )
+	{
+		g_theConsole->Printf( "Incorrect arguments." );
+		g_theConsole->Printf( "Usage: MeshBuildLODsForLastMeshBuilderMade [maxNumLODs = 4] [triangleRatioPerLOD in (0,1) = .5] [maxError in model units = none]" );
+		return;
+	}
+
+	//Triangle counts and error bounds per LOD, the CPU-side check on the simplifier before saving them with MeshSaveLastMeshBuilderMade.
+	double startSeconds = GetCurrentTimeSeconds();
+	unsigned int numLODs = g_lastLoadedMeshBuilder->BuildLODChain( (unsigned int)outMaxNumLODs, outTriangleRatioPerLOD, outMaxError );
+	double seconds = GetCurrentTimeSeconds() - startSeconds;
+
+	const std::vector< MeshLOD >& lods = g_lastLoadedMeshBuilder->GetLODs();
+	g_theConsole->Printf( "Built %u LOD(s) in %.2fms:", numLODs, seconds * 1000.0 );
+	for ( unsigned int lodIndex = 0; lodIndex < lods.size(); lodIndex++ )
+	{
+		const MeshLOD& lod = lods[ lodIndex ];
+		float percentOfBase = ( lods[ 0 ].m_numTriangles > 0 ) ? ( 100.f * lod.m_numTriangles / lods[ 0 ].m_numTriangles ) : 0.f;
+		g_theConsole->Printf( "  LOD %u: %u triangles (%.1f%%) in %u draw(s), max error %.5f", lodIndex, lod.m_numTriangles, percentOfBase, lod.m_numInstructions, lod.m_maxError );
+	}
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 void SkeletonLoadFromFile( Command& args )
 {
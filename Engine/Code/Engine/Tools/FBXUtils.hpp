@@ -44,5 +44,6 @@ void AnimationSaveLastAnimationMade( Command& args );
 
 
 void MeshLoadFromFile( Command& args );
+void MeshBuildLODsForLastMeshBuilderMade( Command& args );
 void SkeletonLoadFromFile( Command& args );
 void AnimationLoadFromFile( Command& args );
\ No newline at end of file
@@ -0,0 +1,219 @@
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Engine/Memory/Memory.hpp"
+#include "Engine/Core/Logger.hpp"
+#include "Engine/Tools/Profiling/Profiler.hpp"
+#include "Engine/Concurrency/JobUtils.hpp"
+#include "Engine/Core/TheConsole.hpp"
+#include "Engine/Time/Time.hpp"
+
+#include "Engine/Math/NoiseBatch.hpp"
+#include "Engine/Math/Matrix44.hpp"
+#include "Engine/Memory/Callstack.hpp"
+#include "Engine/Physics/Cloth.hpp"
+#include "Engine/Core/ConsoleHistory.hpp"
+#include "Engine/FileUtils/XMLStreamReader.hpp"
+#include "Engine/Renderer/MeshOptimizer.hpp"
+#include "Engine/Renderer/DynamicResolution.hpp"
+#include "Engine/Renderer/PostProcessGraph.hpp"
+#include "Engine/TheEngine.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Runs the engine's self-checks, the same ones behind the *Test console commands, and echoes what they print to stdout.
+//Usage (run from Run_Win32 so Data/ resolves): EngineTests.exe [nameFilter]
+//Only checks whose names contain nameFilter run. Exits with the number of checks that failed, so 0 means all passed.
+//The Headless configuration has no GL context and skips PostProcess, which reads back pixels. The others make a hidden window for one.
+static const double TEST_SCREEN_WIDTH = 1600.0; //Matches TheApp's window, for FBO sizes.
+static const double TEST_SCREEN_HEIGHT = 900.0;
+static const int NOISE_TEST_OCTAVES = 4;
+static const int CLOTH_TEST_SIZE = 64;
+#ifdef _DEBUG
+static const float CLOTH_TEST_BUDGET_MS = 40.f; //Unoptimized, so this only catches a step gone badly wrong.
+#else
+static const float CLOTH_TEST_BUDGET_MS = 4.f; //ClothTest's default.
+#endif
+static const float DYNAMIC_RESOLUTION_TEST_TARGET_MS = 16.6f;
+static const unsigned int POST_PROCESS_TEST_SIZE = 64;
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool TestNoiseBatch()
+{
+	bool didPass = RunNoiseBatchTest( 1 );
+	didPass &= RunNoiseBatchTest( NOISE_TEST_OCTAVES );
+	return didPass;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool TestCloth()
+{
+	return Cloth::RunSelfTest( CLOTH_TEST_BUDGET_MS, CLOTH_TEST_SIZE );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool TestConsoleHistory()
+{
+	return RunConsoleHistoryTest( GetMinConsoleHistoryTestLines() );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool TestDynamicResolution()
+{
+	return RunDynamicResolutionTest( DYNAMIC_RESOLUTION_TEST_TARGET_MS );
+}
+
+
+#ifndef ENGINE_HEADLESS
+//--------------------------------------------------------------------------------------------------------------
+static bool TestPostProcess()
+{
+	return RunPostProcessTest( POST_PROCESS_TEST_SIZE );
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------------------
+typedef bool( EngineTestCallback )();
+struct EngineTest
+{
+	const char* name;
+	EngineTestCallback* callback;
+};
+static const EngineTest ENGINE_TESTS[] =
+{
+	{ "NoiseBatch", TestNoiseBatch },
+	{ "Matrix44", RunMatrix44Test },
+	{ "Callstack", Callstack::RunSelfTest },
+	{ "Cloth", TestCloth },
+	{ "ConsoleHistory", TestConsoleHistory },
+	{ "XMLStreamReader", RunXMLStreamReaderTest },
+	{ "MeshLOD", RunMeshLODTest },
+	{ "DynamicResolution", TestDynamicResolution },
+#ifndef ENGINE_HEADLESS
+	{ "PostProcess", TestPostProcess },
+#endif
+};
+
+
+//--------------------------------------------------------------------------------------------------------------
+static void PrintNewConsoleLines( unsigned int& inout_lastLineNumberPrinted )
+{
+	const ConsoleHistory& history = g_theConsole->GetHistory();
+	for ( unsigned int lineIndex = 0; lineIndex < history.GetNumLines(); lineIndex++ )
+	{
+		unsigned int lineNumber = history.GetLineNumber( lineIndex );
+		if ( lineNumber <= inout_lastLineNumberPrinted )
+			continue;
+
+		printf( "%s\n", history.GetLineText( lineIndex ) );
+		inout_lastLineNumberPrinted = lineNumber;
+	}
+}
+
+
+#ifndef ENGINE_HEADLESS
+//--------------------------------------------------------------------------------------------------------------
+static HWND CreateHiddenOpenGLWindow( HGLRC& out_glRenderContext )
+{
+	//Never shown: it's only there to own a context, as every check draws into FrameBuffers.
+	WNDCLASSEX windowClassDescription;
+	memset( &windowClassDescription, 0, sizeof( windowClassDescription ) );
+	windowClassDescription.cbSize = sizeof( windowClassDescription );
+	windowClassDescription.style = CS_OWNDC;
+	windowClassDescription.lpfnWndProc = DefWindowProc;
+	windowClassDescription.hInstance = GetModuleHandle( NULL );
+	windowClassDescription.lpszClassName = TEXT( "EngineTests Window Class" );
+	RegisterClassEx( &windowClassDescription );
+
+	HWND windowHandle = CreateWindowEx( 0, windowClassDescription.lpszClassName, TEXT( "EngineTests" ), WS_OVERLAPPEDWINDOW,
+										0, 0, (int)TEST_SCREEN_WIDTH, (int)TEST_SCREEN_HEIGHT, NULL, NULL, windowClassDescription.hInstance, NULL );
+	HDC displayDeviceContext = GetDC( windowHandle );
+
+	PIXELFORMATDESCRIPTOR pixelFormatDescriptor;
+	memset( &pixelFormatDescriptor, 0, sizeof( pixelFormatDescriptor ) );
+	pixelFormatDescriptor.nSize = sizeof( pixelFormatDescriptor );
+	pixelFormatDescriptor.nVersion = 1;
+	pixelFormatDescriptor.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
+	pixelFormatDescriptor.iPixelType = PFD_TYPE_RGBA;
+	pixelFormatDescriptor.cColorBits = 24;
+	pixelFormatDescriptor.cDepthBits = 24;
+	pixelFormatDescriptor.cStencilBits = 8;
+
+	int pixelFormatCode = ChoosePixelFormat( displayDeviceContext, &pixelFormatDescriptor );
+	SetPixelFormat( displayDeviceContext, pixelFormatCode, &pixelFormatDescriptor );
+	out_glRenderContext = wglCreateContext( displayDeviceContext );
+	wglMakeCurrent( displayDeviceContext, out_glRenderContext );
+	return windowHandle;
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------------------
+int main( int argc, char* argv[] )
+{
+	const char* nameFilter = ( argc > 1 ) ? argv[ 1 ] : "";
+
+	Logger::Startup();
+	MemoryAnalytics::Startup();
+	Profiler::Instance()->Startup();
+	JobSystem::Instance()->Startup( -2, -3 ); //Same worker counts as Main_Win32, so the timed checks see the game's JobSystem.
+
+#ifndef ENGINE_HEADLESS
+	HGLRC glRenderContext = NULL;
+	HWND windowHandle = CreateHiddenOpenGLWindow( glRenderContext );
+#endif
+
+	g_theEngine = new TheEngine();
+	g_theEngine->Startup( TEST_SCREEN_WIDTH, TEST_SCREEN_HEIGHT );
+
+	unsigned int lastLineNumberPrinted = 0;
+	PrintNewConsoleLines( lastLineNumberPrinted ); //Startup's own output, ahead of the first check's.
+
+	int numRun = 0;
+	int numFailed = 0;
+	for ( const EngineTest& test : ENGINE_TESTS )
+	{
+		if ( strstr( test.name, nameFilter ) == nullptr )
+			continue;
+
+		printf( "---- %s\n", test.name );
+		double startSeconds = GetCurrentTimeSeconds();
+		bool didPass = test.callback();
+		double seconds = GetCurrentTimeSeconds() - startSeconds;
+		PrintNewConsoleLines( lastLineNumberPrinted );
+		printf( "---- %s: %s (%.2f s)\n", test.name, didPass ? "PASS" : "FAIL", seconds );
+
+		++numRun;
+		if ( !didPass )
+			++numFailed;
+	}
+#ifdef ENGINE_HEADLESS
+	if ( strstr( "PostProcess", nameFilter ) != nullptr )
+		printf( "---- PostProcess: skipped, the Headless configuration has no GL context to read pixels back from.\n" );
+#endif
+	printf( "%d of %d checks passed.\n", numRun - numFailed, numRun );
+
+	g_theEngine->Shutdown();
+	delete g_theEngine;
+	g_theEngine = nullptr;
+
+#ifndef ENGINE_HEADLESS
+	wglMakeCurrent( NULL, NULL );
+	wglDeleteContext( glRenderContext );
+	DestroyWindow( windowHandle );
+#endif
+
+	JobSystem::Instance()->Shutdown();
+	Profiler::Instance()->Shutdown();
+	MemoryAnalytics::Shutdown();
+	Logger::Shutdown();
+
+	return numFailed;
+}
@@ -6,7 +6,7 @@
 
 
 //-----------------------------------------------------------------------------
-struct XMLNode;
+class XMLStreamReader;
 
 
 //-----------------------------------------------------------------------------
@@ -18,5 +18,5 @@ public:
 	
 
 protected:
-	void PopulateFromXMLNode( const XMLNode& agentNode ) { GameEntity::PopulateFromXMLNode( agentNode ); }
+	void PopulateFromXMLStream( const XMLStreamReader& agentReader ) { GameEntity::PopulateFromXMLStream( agentReader ); }
 };
@@ -11,13 +11,13 @@ Bullet* Bullet::GetClone() const
 
 
 //--------------------------------------------------------------------------------------------------------------
-Bullet::Bullet( const XMLNode& bulletNode )
+Bullet::Bullet( const XMLStreamReader& bulletReader )
 	: GameEntity( ENTITY_TYPE_BULLET )
 	, m_lifetimeSeconds( 5.f )
 {
 	m_timeLeftSeconds = m_lifetimeSeconds;
 	m_rigidbody->AddForce( new ConstantWindForce( 5.f, Vector3f( WORLD2D_DOWN.x, WORLD2D_DOWN.y, 0.f ) ) );
-	PopulateFromXMLNode( bulletNode );
+	PopulateFromXMLStream( bulletReader );
 }
 
 
@@ -32,9 +32,20 @@ Bullet::Bullet( const Bullet& other )
 
 
 //--------------------------------------------------------------------------------------------------------------
-void Bullet::PopulateFromXMLNode( const XMLNode& bulletNode )
+void Bullet::ResetFromPrefab( const GameEntity& prefab )
 {
-	GameEntity::PopulateFromXMLNode( bulletNode );
+	GameEntity::ResetFromPrefab( prefab );
+
+	const Bullet& prefabBullet = static_cast<const Bullet&>( prefab ); //Type checked in GameEntity::ResetFromPrefab.
+	m_lifetimeSeconds = prefabBullet.m_lifetimeSeconds;
+	m_timeLeftSeconds = prefabBullet.m_timeLeftSeconds;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void Bullet::PopulateFromXMLStream( const XMLStreamReader& bulletReader )
+{
+	GameEntity::PopulateFromXMLStream( bulletReader );
 }
 
 
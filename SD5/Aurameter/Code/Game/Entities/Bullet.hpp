@@ -5,7 +5,7 @@
 
 
 //-----------------------------------------------------------------------------
-struct XMLNode;
+class XMLStreamReader;
 
 
 //-----------------------------------------------------------------------------
@@ -13,9 +13,10 @@ class Bullet : public GameEntity
 {
 public:
 	Bullet( const Bullet& other );
-	Bullet( const XMLNode& bulletNode );
+	Bullet( const XMLStreamReader& bulletReader );
 	virtual Bullet* GetClone() const override;
-	void PopulateFromXMLNode( const XMLNode& bulletNode );
+	virtual void ResetFromPrefab( const GameEntity& prefab ) override;
+	void PopulateFromXMLStream( const XMLStreamReader& bulletReader );
 
 	Bullet( const WorldCoords2D& pos, const Vector2f& vel = Vector2f::ZERO );
 	virtual void Update( float deltaSeconds ) override;
@@ -1,6 +1,6 @@
 #include "Game/Entities/Enemy.hpp"
 
-#include "Engine/FileUtils/XMLUtils.hpp"
+#include "Engine/FileUtils/XMLStreamReader.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/TheEventSystem.hpp"
 
@@ -45,55 +45,59 @@ Enemy* Enemy::GetClone() const
 
 
 //--------------------------------------------------------------------------------------------------------------
-void Enemy::PopulateFromXMLNode( const XMLNode& enemyNode )
+void Enemy::ResetFromPrefab( const GameEntity& prefab )
 {
-	Agent::PopulateFromXMLNode( enemyNode );
+	bool wasSamePrefabName = ( m_name == prefab.GetName() ); //Patterns are shared per enemy name, so skip the map copy when they match.
 
-	int numWaves = enemyNode.nChildNode( "Pattern" );
+	GameEntity::ResetFromPrefab( prefab );
 
-	for ( int waveIndex = 0; waveIndex < numWaves; waveIndex++ )
-	{
-		XMLNode patternNode = enemyNode.getChildNode( "Pattern" );
+	const Enemy& prefabEnemy = static_cast<const Enemy&>( prefab ); //Type checked in GameEntity::ResetFromPrefab.
+	m_secondsAlive = prefabEnemy.m_secondsAlive;
+	m_lastPattern = prefabEnemy.m_lastPattern;
+	if ( !wasSamePrefabName )
+		m_firingPatterns = prefabEnemy.m_firingPatterns;
+}
 
-		std::string patternName;
-		patternName = ReadXMLAttribute( patternNode, "name", patternName );
 
-		Vector2f initialVelocity = Vector2f::ZERO;
-		initialVelocity = ReadXMLAttribute( patternNode, "velocity", initialVelocity );
+//--------------------------------------------------------------------------------------------------------------
+void Enemy::PopulateFromXMLStream( XMLStreamReader& enemyReader )
+{
+	Agent::PopulateFromXMLStream( enemyReader );
+
+	//Every wave fires the first Pattern: the XMLNode loader this replaced called getChildNode( "Pattern" ) without an index,
+	//and the data now leans on that (later Patterns like Clay Golem's have no Spawns, which would trip the assert below).
+	PatternDefinition firstPattern;
+	int numWaves = 0;
+	int enemyDepth = enemyReader.GetDepth();
+	while ( enemyReader.ReadToNextChildElement( enemyDepth, "Pattern" ) )
+	{
+		if ( numWaves++ == 0 )
+			firstPattern.ReadFromXMLStream( enemyReader );
+	}
 
-		float whenToSpawnSeconds = 1.f;
-		whenToSpawnSeconds = ReadXMLAttribute( patternNode, "whenToSpawn", whenToSpawnSeconds );
+	const std::string& patternName = firstPattern.m_name;
+	float whenToSpawnSeconds = firstPattern.m_whenToSpawnSeconds;
+	int numBulletSpawns = static_cast<int>( firstPattern.m_spawns.size() );
 
+	for ( int waveIndex = 0; waveIndex < numWaves; waveIndex++ )
+	{
 		//Break out into multiple patterns if there's a delay, not sure how else to handle the per-bullet spawn delay.
-		bool doesDelayedSpawnExist = ( patternNode.getChildNodeWithAttribute( "Spawn", "spawnDelay" ).isEmpty() > 0 ) ? false : true;
-		int numBulletSpawns = patternNode.nChildNode( "Spawn" );
 		int numOneBulletPatterns = 0;
-		if ( doesDelayedSpawnExist )
+		for ( const SpawnDefinition& spawn : firstPattern.m_spawns )
 		{
-			Vector2f patternOrigin = Vector2f::ZERO;
-			patternOrigin = ReadXMLAttribute( patternNode, "origin", patternOrigin );
-
-			int delayedBulletSpawnIndex = 0; //Written to by below call.
-			XMLNode delayedBulletSpawnNode = patternNode.getChildNodeWithAttribute( "Spawn", "spawnDelay", 0, &delayedBulletSpawnIndex );
+			if ( !spawn.m_hasSpawnDelay )
+				continue;
 
-			do
-			{
-				SpawnPattern* newOneBulletPattern = SpawnPattern::CreateOneBulletPattern( Stringf( "%s - OneBulletPattern #%d Index %d", patternName.c_str(), numOneBulletPatterns, delayedBulletSpawnIndex ), patternOrigin, delayedBulletSpawnNode );
+			int delayedBulletSpawnIndex = spawn.m_childIndex + 1; //Matches the names getChildNodeWithAttribute's index gave them.
+			SpawnPattern* newOneBulletPattern = SpawnPattern::CreateOneBulletPattern( Stringf( "%s - OneBulletPattern #%d Index %d", patternName.c_str(), numOneBulletPatterns, delayedBulletSpawnIndex ), firstPattern.m_origin, spawn );
 
-				float spawnDelaySeconds = 0.f;
-				spawnDelaySeconds = ReadXMLAttribute( delayedBulletSpawnNode, "spawnDelay", spawnDelaySeconds );
+			m_firingPatterns.insert( TimeOrderedMapPair( whenToSpawnSeconds + spawn.m_spawnDelaySeconds, newOneBulletPattern ) );
 
-				m_firingPatterns.insert( TimeOrderedMapPair( whenToSpawnSeconds + spawnDelaySeconds, newOneBulletPattern ) );
-
-				++numOneBulletPatterns;
-
-				delayedBulletSpawnNode = patternNode.getChildNodeWithAttribute( "Spawn", "spawnDelay", 0, &delayedBulletSpawnIndex );
-			} 
-			while ( !delayedBulletSpawnNode.isEmpty() );
+			++numOneBulletPatterns;
 		}
 
 		ASSERT_OR_DIE( numBulletSpawns > numOneBulletPatterns, "Need at least one non-delayed bullet in a firing pattern!" );
 			//Could surround below call with an if-block instead, but it really doesn't make sense if no bullets are fired at pattern's "start".
-		m_firingPatterns.insert( TimeOrderedMapPair( whenToSpawnSeconds, SpawnPattern::CreateOrGetPattern( patternName, patternNode ) ) );
+		m_firingPatterns.insert( TimeOrderedMapPair( whenToSpawnSeconds, SpawnPattern::CreateOrGetPattern( patternName, &firstPattern ) ) );
 	}
-}
+}
\ No newline at end of file
@@ -6,7 +6,7 @@
 
 
 //-----------------------------------------------------------------------------
-struct XMLNode;
+class XMLStreamReader;
 class SpawnPattern;
 typedef std::multimap< float, SpawnPattern* > TimeOrderedMap;
 typedef std::pair< float, SpawnPattern* > TimeOrderedMapPair;
@@ -24,16 +24,17 @@ struct GameEventPatternFired : public EngineEvent
 class Enemy : public Agent
 {
 public:
-	Enemy( const XMLNode& enemyNode ) 
+	Enemy( XMLStreamReader& enemyReader ) 
 		: Agent( ENTITY_TYPE_ENEMY ) 
 		, m_secondsAlive( 0.f )
 		, m_lastPattern( 0 )
 	{ 
-		PopulateFromXMLNode( enemyNode ); 
+		PopulateFromXMLStream( enemyReader ); 
 	}
 	virtual void Update( float deltaSeconds ) override;
 	virtual Enemy* GetClone() const override;
-	void PopulateFromXMLNode( const XMLNode& enemyNode ); 
+	virtual void ResetFromPrefab( const GameEntity& prefab ) override;
+	void PopulateFromXMLStream( XMLStreamReader& enemyReader ); //Consumes the Enemy element's Pattern children.
 
 private:
 	TimeOrderedMap m_firingPatterns; //Does not need a deep copy since it's clone-and-forget usage.
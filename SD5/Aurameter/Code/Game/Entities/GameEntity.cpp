@@ -4,7 +4,7 @@
 #include "Engine/Renderer/Sprite.hpp"
 #include "Engine/Physics/PhysicsUtils.hpp"
 #include "Engine/Physics/Forces.hpp"
-#include "Engine/FileUtils/XMLUtils.hpp"
+#include "Engine/FileUtils/XMLStreamReader.hpp"
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -54,6 +54,41 @@ GameEntity::GameEntity( const GameEntity& other )
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+void GameEntity::ResetFromPrefab( const GameEntity& prefab )
+{
+	ASSERT_OR_DIE( m_entityType == prefab.m_entityType, "Recycling an entity from a prefab of another type!" );
+	bool wasSamePrefabName = ( m_name == prefab.m_name );
+
+	Entity::operator=( prefab ); //Stateless for now, but whatever it gains should recycle too.
+	m_health = prefab.m_health;
+	m_maxHealth = prefab.m_maxHealth;
+	m_hasBeenDeflected = prefab.m_hasBeenDeflected;
+	m_entityID = s_BASE_ENTITY_ID++;
+	if ( !wasSamePrefabName )
+		m_name = prefab.m_name;
+
+	m_sprite->ResetFrom( prefab.m_sprite );
+
+	//Same state the copy ctor builds, Verlet's previous acceleration included.
+	m_rigidbody->ResetMotion( WorldCoords3D( prefab.m_sprite->GetPivotSpriteRelative().x, prefab.m_sprite->GetPivotSpriteRelative().y, 0.f ) );
+
+	//Every force is reset from the prefab's, so nothing a deflector changed carries into the next life.
+	//Only reallocated if a deflector added some or a force's type differs.
+	size_t numPrefabForces = prefab.m_rigidbody->GetNumForces();
+	bool didResetForces = ( m_rigidbody->GetNumForces() == numPrefabForces );
+	for ( size_t forceIndex = 0; didResetForces && ( forceIndex < numPrefabForces ); forceIndex++ )
+		didResetForces = m_rigidbody->GetForce( forceIndex )->ResetFrom( *prefab.m_rigidbody->GetForce( forceIndex ) );
+
+	if ( !didResetForces )
+	{
+		m_rigidbody->ClearForces( false );
+		for ( size_t forceIndex = 0; forceIndex < numPrefabForces; forceIndex++ )
+			m_rigidbody->AddForce( prefab.m_rigidbody->GetForce( forceIndex )->GetCopy() );
+	}
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 GameEntity::~GameEntity()
 {
@@ -63,12 +98,11 @@ GameEntity::~GameEntity()
 
 
 //--------------------------------------------------------------------------------------------------------------
-void GameEntity::PopulateFromXMLNode( const XMLNode& entityNode )
+void GameEntity::PopulateFromXMLStream( const XMLStreamReader& entityReader )
 {
-	m_name = ReadXMLAttribute( entityNode, "name", m_name );
+	m_name = entityReader.ReadAttribute( "name", m_name );
 
-	std::string spriteResName;
-	spriteResName = ReadXMLAttribute( entityNode, "resourceName", spriteResName );
+	std::string spriteResName = entityReader.ReadAttribute( "resourceName", std::string() );
 	m_sprite = Sprite::Create( spriteResName, WorldCoords2D::ZERO );
 }
 
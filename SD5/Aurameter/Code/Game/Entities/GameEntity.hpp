@@ -10,7 +10,7 @@
 class Sprite;
 class Material;
 class LinearDynamicsState;
-struct XMLNode;
+class XMLStreamReader;
 
 
 //-----------------------------------------------------------------------------
@@ -22,6 +22,7 @@ public:
 	GameEntity( const GameEntity& other ); //To deep copy the Sprite*.
 	GameEntity( EntityType entityType, ResourceID spriteName, const WorldCoords2D& pivotPosition, const Rgba& tint = Rgba::WHITE );
 	virtual GameEntity* GetClone() const { throw new std::logic_error( "Only implemented for entities spawned in patterns: Enemy, Bullet." ); }
+	virtual void ResetFromPrefab( const GameEntity& prefab ); //Makes a recycled instance match what prefab.GetClone() would return, see EntityPool.
 	virtual ~GameEntity();
 
 	int GetHealth() const { return m_health; }
@@ -50,7 +51,7 @@ public:
 
 
 protected:
-	void PopulateFromXMLNode( const XMLNode& entityNode );
+	void PopulateFromXMLStream( const XMLStreamReader& entityReader ); //Attributes only, call on the START_ELEMENT.
 
 	int m_health;
 	int m_maxHealth;
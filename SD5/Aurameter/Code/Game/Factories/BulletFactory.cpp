@@ -1,8 +1,9 @@
 #include "Game/Factories/BulletFactory.hpp"
 #include "Game/Entities/Bullet.hpp"
+#include "Game/Factories/EntityPool.hpp"
 
 #include "Engine/FileUtils/FileUtils.hpp"
-#include "Engine/FileUtils/XMLUtils.hpp"
+#include "Engine/FileUtils/XMLStreamReader.hpp"
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -14,17 +15,21 @@ void BulletFactory::LoadAllFactories()
 {
 	//Note we may have more than one Bullets node in a file.
 	std::vector< std::string > m_bulletFiles = EnumerateFilesInDirectory( "Data/XML", "Bullets.xml" );
+	XMLStreamReader reader; //Reused across files so its buffer only grows.
 
 	for ( unsigned int bulletFileIndex = 0; bulletFileIndex < m_bulletFiles.size(); bulletFileIndex++ )
 	{
 		const char* xmlFilename = m_bulletFiles[ bulletFileIndex ].c_str();
-		XMLNode bulletsRoot = XMLNode::openFileHelper( xmlFilename, "Bullets" );
-
-		for ( int bulletIndex = 0; bulletIndex < bulletsRoot.nChildNode(); bulletIndex++ )
+		if ( !reader.OpenFileCooked( xmlFilename ) || !reader.ReadToNextStartElement( "Bullets" ) )
 		{
-			XMLNode bulletNode = bulletsRoot.getChildNode( bulletIndex );
+			ERROR_RECOVERABLE( Stringf( "Failed to find Bullets in %s!", xmlFilename ) );
+			continue;
+		}
 
-			BulletFactory* newBulletFactory = new BulletFactory( bulletNode );
+		int rootDepth = reader.GetDepth();
+		while ( reader.ReadToNextChildElement( rootDepth ) )
+		{
+			BulletFactory* newBulletFactory = new BulletFactory( reader );
 			std::string name = newBulletFactory->GetName();
 
 			if ( s_bulletFactoryRegistry.find( name ) != s_bulletFactoryRegistry.end() )
@@ -47,9 +52,9 @@ STATIC void BulletFactory::CleanupFactories()
 
 
 //--------------------------------------------------------------------------------------------------------------
-void BulletFactory::PopulateFromXMLNode( const XMLNode& bulletNode )
+void BulletFactory::PopulateFromXMLStream( const XMLStreamReader& bulletReader )
 {
-	m_templateBullet = new Bullet( bulletNode );
+	m_templateBullet = new Bullet( bulletReader );
 	m_name = m_templateBullet->GetName();
 }
 
@@ -64,7 +69,7 @@ BulletFactory::~BulletFactory()
 //--------------------------------------------------------------------------------------------------------------
 Bullet* BulletFactory::CreateBullet()
 {
-	return m_templateBullet->GetClone();
+	return static_cast<Bullet*>( EntityPool::Acquire( m_templateBullet ) );
 }
 
 
@@ -79,4 +84,29 @@ Bullet* BulletFactory::CreateBulletFromName( const BulletFactoryID& bulletName )
 	}
 
 	return found->second->CreateBullet();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void BulletFactory::CreateBulletsFromName( const BulletFactoryID& bulletName, int numBullets, std::vector<GameEntity*>& out_bullets )
+{
+	BulletRegistryMap::iterator found = s_bulletFactoryRegistry.find( bulletName );
+	if ( found == s_bulletFactoryRegistry.end() )
+	{
+		Logger::PrintfWithTag( "DEBUG", "Failed request %s sent to CreateBulletsFromName!", bulletName.c_str() );
+		return;
+	}
+
+	GameEntity* prefab = found->second->m_templateBullet;
+	out_bullets.reserve( out_bullets.size() + numBullets );
+	for ( int bulletIndex = 0; bulletIndex < numBullets; bulletIndex++ )
+		out_bullets.push_back( EntityPool::Acquire( prefab ) );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void BulletFactory::PrewarmPool( unsigned int numBulletsPerFactory )
+{
+	for ( const BulletRegistryPair& factoryPair : s_bulletFactoryRegistry )
+		EntityPool::Prewarm( factoryPair.second->m_templateBullet, numBulletsPerFactory );
 }
\ No newline at end of file
@@ -7,8 +7,9 @@
 
 //-----------------------------------------------------------------------------
 class Bullet;
+class GameEntity;
 class BulletFactory;
-struct XMLNode;
+class XMLStreamReader;
 typedef std::string BulletFactoryID;
 typedef std::pair<BulletFactoryID, BulletFactory*> BulletRegistryPair;
 typedef std::map<BulletFactoryID, BulletFactory*, std::less<std::string>, UntrackedAllocator<BulletRegistryPair> > BulletRegistryMap;
@@ -22,15 +23,17 @@ public:
 	static void CleanupFactories();
 	static const BulletRegistryMap& GetRegistry() { return s_bulletFactoryRegistry; }
 	static Bullet* CreateBulletFromName( const BulletFactoryID& name );
+	static void CreateBulletsFromName( const BulletFactoryID& name, int numBullets, std::vector<GameEntity*>& out_bullets );
+	static void PrewarmPool( unsigned int numBulletsPerFactory );
 
 
 public:
-	BulletFactory( const XMLNode& bulletNode ) { PopulateFromXMLNode( bulletNode ); }
-	void PopulateFromXMLNode( const XMLNode& bulletNode );
+	BulletFactory( const XMLStreamReader& bulletReader ) { PopulateFromXMLStream( bulletReader ); }
+	void PopulateFromXMLStream( const XMLStreamReader& bulletReader );
 	~BulletFactory();
 	
 	std::string GetName() const { return m_name; }
-	Bullet* CreateBullet();
+	Bullet* CreateBullet(); //Pooled, so free the result with EntityPool::Release rather than delete.
 
 private:
 	std::string m_name;
@@ -3,7 +3,7 @@
 #include "Game/GameCommon.hpp"
 
 #include "Engine/FileUtils/FileUtils.hpp"
-#include "Engine/FileUtils/XMLUtils.hpp"
+#include "Engine/FileUtils/XMLStreamReader.hpp"
 #include "Engine/Error/ErrorWarningAssert.hpp"
 
 
@@ -16,17 +16,21 @@ void EnemyFactory::LoadAllFactories()
 {
 	//Note we may have more than one Enemies node in a file.
 	std::vector< std::string > m_enemyFiles = EnumerateFilesInDirectory( "Data/XML", "Enemies.xml" );
+	XMLStreamReader reader; //Reused across files so its buffer only grows.
 
 	for ( unsigned int enemyFileIndex = 0; enemyFileIndex < m_enemyFiles.size(); enemyFileIndex++ )
 	{
 		const char* xmlFilename = m_enemyFiles[ enemyFileIndex ].c_str();
-		XMLNode enemiesRoot = XMLNode::openFileHelper( xmlFilename, "Enemies" );
-
-		for ( int enemyIndex = 0; enemyIndex < enemiesRoot.nChildNode(); enemyIndex++ )
+		if ( !reader.OpenFileCooked( xmlFilename ) || !reader.ReadToNextStartElement( "Enemies" ) )
 		{
-			XMLNode enemyNode = enemiesRoot.getChildNode( enemyIndex );
+			ERROR_RECOVERABLE( Stringf( "Failed to find Enemies in %s!", xmlFilename ) );
+			continue;
+		}
 
-			EnemyFactory* newEnemyFactory = new EnemyFactory( enemyNode );
+		int rootDepth = reader.GetDepth();
+		while ( reader.ReadToNextChildElement( rootDepth ) )
+		{
+			EnemyFactory* newEnemyFactory = new EnemyFactory( reader );
 			std::string name = newEnemyFactory->GetName();
 
 			if ( s_enemyFactoryRegistry.find( name ) != s_enemyFactoryRegistry.end() )
@@ -63,9 +67,9 @@ Enemy* EnemyFactory::CreateEnemyFromName( const EnemyFactoryID& enemyName )
 
 
 //--------------------------------------------------------------------------------------------------------------
-void EnemyFactory::PopulateFromXMLNode( const XMLNode& enemyNode )
+void EnemyFactory::PopulateFromXMLStream( XMLStreamReader& enemyReader )
 {
-	m_templateEnemy = new Enemy( enemyNode );
+	m_templateEnemy = new Enemy( enemyReader );
 	m_name = m_templateEnemy->GetName();
 }
 
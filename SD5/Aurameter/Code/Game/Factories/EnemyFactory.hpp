@@ -8,7 +8,7 @@
 //-----------------------------------------------------------------------------
 class Enemy;
 class EnemyFactory;
-struct XMLNode;
+class XMLStreamReader;
 typedef std::string EnemyFactoryID;
 typedef std::pair<EnemyFactoryID, EnemyFactory*> EnemyRegistryPair;
 typedef std::map<EnemyFactoryID, EnemyFactory*, std::less<std::string>, UntrackedAllocator<EnemyRegistryPair> > EnemyRegistryMap;
@@ -25,8 +25,8 @@ public:
 
 
 public:
-	EnemyFactory( const XMLNode& enemyNode ) { PopulateFromXMLNode( enemyNode ); }
-	void PopulateFromXMLNode( const XMLNode& enemyNode );
+	EnemyFactory( XMLStreamReader& enemyReader ) { PopulateFromXMLStream( enemyReader ); }
+	void PopulateFromXMLStream( XMLStreamReader& enemyReader );
 	~EnemyFactory();
 
 	std::string GetName() const { return m_name; }
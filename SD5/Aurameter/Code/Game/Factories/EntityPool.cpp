@@ -0,0 +1,135 @@
+#include "Game/Factories/EntityPool.hpp"
+#include "Game/Entities/GameEntity.hpp"
+
+#include "Engine/Renderer/Sprite.hpp"
+#include "Engine/Core/Command.hpp"
+#include "Engine/Core/TheConsole.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC std::vector<GameEntity*> EntityPool::s_freeInstances[ NUM_ENTITY_TYPES ];
+STATIC unsigned int EntityPool::s_numClonesMade[ NUM_ENTITY_TYPES ];
+STATIC unsigned int EntityPool::s_numRecycled[ NUM_ENTITY_TYPES ];
+STATIC CriticalSection EntityPool::s_poolLock;
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void EntityPool::Prewarm( const GameEntity* prefab, unsigned int numInstances )
+{
+	if ( prefab == nullptr || !IsPooledType( prefab->GetEntityType() ) )
+		return;
+
+	std::vector<GameEntity*>& freeList = s_freeInstances[ prefab->GetEntityType() ];
+	freeList.reserve( freeList.size() + numInstances );
+	for ( unsigned int instanceIndex = 0; instanceIndex < numInstances; instanceIndex++ )
+		freeList.push_back( prefab->GetClone() ); //Clones start out disabled, so no Disable() needed.
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC GameEntity* EntityPool::AcquireLocked( const GameEntity* prefab )
+{
+	EntityType entityType = prefab->GetEntityType();
+	std::vector<GameEntity*>& freeList = s_freeInstances[ entityType ];
+
+	if ( freeList.empty() )
+	{
+		++s_numClonesMade[ entityType ];
+		return prefab->GetClone(); //Note use of virtual overrides.
+	}
+
+	GameEntity* recycledEntity = freeList.back();
+	freeList.pop_back();
+	recycledEntity->ResetFromPrefab( *prefab );
+	++s_numRecycled[ entityType ];
+
+	return recycledEntity;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC GameEntity* EntityPool::Acquire( const GameEntity* prefab )
+{
+	if ( prefab == nullptr )
+		return nullptr;
+
+	if ( !IsPooledType( prefab->GetEntityType() ) )
+		return prefab->GetClone();
+
+	s_poolLock.Lock();
+	GameEntity* entity = AcquireLocked( prefab );
+	s_poolLock.Unlock();
+
+	return entity;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void EntityPool::AcquireBatch( GameEntity* const* prefabs, int numPrefabs, std::vector<GameEntity*>& out_entities )
+{
+	out_entities.reserve( out_entities.size() + numPrefabs );
+
+	s_poolLock.Lock();
+	for ( int prefabIndex = 0; prefabIndex < numPrefabs; prefabIndex++ )
+	{
+		const GameEntity* prefab = prefabs[ prefabIndex ];
+		if ( IsPooledType( prefab->GetEntityType() ) )
+			out_entities.push_back( AcquireLocked( prefab ) );
+		else
+			out_entities.push_back( prefab->GetClone() );
+	}
+	s_poolLock.Unlock();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void EntityPool::Release( GameEntity* entity )
+{
+	if ( entity == nullptr )
+		return;
+
+	if ( !IsPooledType( entity->GetEntityType() ) )
+	{
+		delete entity;
+		return;
+	}
+
+	if ( entity->GetSprite()->IsEnabled() )
+		entity->GetSprite()->Disable(); //Unregisters it so it stops rendering while it waits in the free list.
+
+	s_poolLock.Lock();
+	s_freeInstances[ entity->GetEntityType() ].push_back( entity );
+	s_poolLock.Unlock();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void EntityPool::CleanupPools()
+{
+	for ( int typeIndex = 0; typeIndex < NUM_ENTITY_TYPES; typeIndex++ )
+	{
+		for ( GameEntity* entity : s_freeInstances[ typeIndex ] )
+			delete entity;
+
+		s_freeInstances[ typeIndex ].clear();
+		s_freeInstances[ typeIndex ].shrink_to_fit();
+		s_numClonesMade[ typeIndex ] = 0;
+		s_numRecycled[ typeIndex ] = 0;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC void EntityPool::PrintStats( Command& /*args*/ )
+{
+	const char* typeNames[ NUM_ENTITY_TYPES ] = { "Player", "Enemy", "Bullet", "Deflector" };
+
+	for ( int typeIndex = 0; typeIndex < NUM_ENTITY_TYPES; typeIndex++ )
+	{
+		if ( !IsPooledType( (EntityType)typeIndex ) )
+			continue;
+
+		g_theConsole->Printf( "%s: %u free, %u clones made, %u recycled",
+			typeNames[ typeIndex ], (unsigned int)s_freeInstances[ typeIndex ].size(), s_numClonesMade[ typeIndex ], s_numRecycled[ typeIndex ] );
+	}
+}
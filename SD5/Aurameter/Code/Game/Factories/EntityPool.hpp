@@ -0,0 +1,38 @@
+#pragma once
+
+
+#include "Game/GameCommon.hpp"
+#include "Engine/Concurrency/CriticalSection.hpp"
+#include <vector>
+
+
+//-----------------------------------------------------------------------------
+class GameEntity;
+class Command;
+
+
+//-----------------------------------------------------------------------------
+//Prefab instancing for pattern-spawned entities (Enemy, Bullet).
+//Expired entities are released back into a per-EntityType free list, keeping their Sprite, LinearDynamicsState and forces,
+//then get re-stamped from whichever prefab asks next. Steady-state spawning therefore does no heap traffic.
+class EntityPool
+{
+public:
+	static void Prewarm( const GameEntity* prefab, unsigned int numInstances );
+	static GameEntity* Acquire( const GameEntity* prefab ); //Same result as prefab->GetClone(), but recycled when possible.
+	static void AcquireBatch( GameEntity* const* prefabs, int numPrefabs, std::vector<GameEntity*>& out_entities ); //One lock for a whole pattern.
+	static void Release( GameEntity* entity ); //Use in place of delete for anything that came out of Acquire.
+	static void CleanupPools();
+
+	static void PrintStats( Command& args );
+
+
+private:
+	static bool IsPooledType( EntityType entityType ) { return entityType == ENTITY_TYPE_ENEMY || entityType == ENTITY_TYPE_BULLET; }
+	static GameEntity* AcquireLocked( const GameEntity* prefab );
+
+	static std::vector<GameEntity*> s_freeInstances[ NUM_ENTITY_TYPES ];
+	static unsigned int s_numClonesMade[ NUM_ENTITY_TYPES ]; //Misses, each one a full GetClone().
+	static unsigned int s_numRecycled[ NUM_ENTITY_TYPES ]; //Hits.
+	static CriticalSection s_poolLock; //Enemy::Update fires patterns from job threads.
+};
@@ -1,10 +1,12 @@
 #include "Game/Factories/Pattern.hpp"
 #include "Game/Factories/EnemyFactory.hpp"
 #include "Game/Factories/BulletFactory.hpp"
+#include "Game/Factories/EntityPool.hpp"
 #include "Game/Entities/GameEntity.hpp"
 #include "Game/Entities/Enemy.hpp"
 #include "Game/Entities/Bullet.hpp"
 #include "Engine/Physics/PhysicsUtils.hpp"
+#include "Engine/FileUtils/XMLStreamReader.hpp"
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -12,20 +14,49 @@ STATIC PatternRegistryMap SpawnPattern::s_patternRegistry;
 
 
 //--------------------------------------------------------------------------------------------------------------
-STATIC SpawnPattern* SpawnPattern::CreateOrGetPattern( const PatternID& patternName, const XMLNode& patternNode /*= XMLNode::emptyNode()*/ )
+void PatternDefinition::ReadFromXMLStream( XMLStreamReader& reader )
+{
+	m_name = reader.ReadAttribute( "name", std::string() );
+	m_origin = reader.ReadAttribute( "origin", WorldCoords2D::ZERO );
+	m_whenToSpawnSeconds = reader.ReadAttribute( "whenToSpawn", 1.f );
+	m_spawns.clear();
+
+	int patternDepth = reader.GetDepth();
+	for ( int childIndex = 0; reader.ReadToNextChildElement( patternDepth ); childIndex++ )
+	{
+		if ( reader.GetName() != "Spawn" )
+			continue;
+
+		SpawnDefinition spawn;
+		spawn.m_offset = reader.ReadAttribute( "offset", WorldCoords2D::ZERO );
+		spawn.m_additionalVelocity = reader.ReadAttribute( "velocity", Vector2f::ZERO );
+		spawn.m_spawnsEnemy = !reader.GetAttribute( "enemy" ).IsNull();
+		spawn.m_spawnsBullet = !reader.GetAttribute( "bullet" ).IsNull();
+		spawn.m_enemyName = reader.ReadAttribute( "enemy", std::string() );
+		spawn.m_bulletName = reader.ReadAttribute( "bullet", std::string() );
+		spawn.m_hasSpawnDelay = !reader.GetAttribute( "spawnDelay" ).IsNull();
+		spawn.m_spawnDelaySeconds = reader.ReadAttribute( "spawnDelay", 0.f );
+		spawn.m_childIndex = childIndex;
+		m_spawns.push_back( spawn );
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC SpawnPattern* SpawnPattern::CreateOrGetPattern( const PatternID& patternName, const PatternDefinition* definition /*= nullptr*/ )
 {
 	PatternRegistryMap::iterator found = s_patternRegistry.find( patternName );
 	if ( found != s_patternRegistry.end() )
 		return found->second;
 
 	SpawnPattern* newPattern = nullptr;
-	if ( patternNode.isEmpty() )
+	if ( definition == nullptr )
 	{
 		newPattern = new SpawnPattern( "Uninitialized Pattern", nullptr, nullptr, 0 );
 	}
 	else
 	{
-		newPattern = CreateFromXMLNode( patternNode );
+		newPattern = CreateFromDefinition( *definition );
 	}
 
 	s_patternRegistry[ patternName ] = newPattern;
@@ -34,18 +65,15 @@ STATIC SpawnPattern* SpawnPattern::CreateOrGetPattern( const PatternID& patternN
 
 
 //--------------------------------------------------------------------------------------------------------------
-STATIC SpawnPattern* SpawnPattern::CreateOneBulletPattern( const PatternID& patternName, const WorldCoords2D& patternOrigin, const XMLNode& singleSpawnNode )
+STATIC SpawnPattern* SpawnPattern::CreateOneBulletPattern( const PatternID& patternName, const WorldCoords2D& patternOrigin, const SpawnDefinition& singleSpawn )
 {
 	WorldCoords2D* spawnOffsets = new WorldCoords2D;
-	spawnOffsets[ 0 ] = ReadXMLAttribute( singleSpawnNode, "offset", WorldCoords2D::ZERO );
+	spawnOffsets[ 0 ] = singleSpawn.m_offset;
 
 	GameEntity** spawnedEntities = new GameEntity*;
-	std::string entityFactoryName;
-	entityFactoryName = ReadXMLAttribute( singleSpawnNode, "bullet", entityFactoryName );
-	spawnedEntities[ 0 ] = BulletFactory::CreateBulletFromName( entityFactoryName );
+	spawnedEntities[ 0 ] = BulletFactory::CreateBulletFromName( singleSpawn.m_bulletName );
 
-	Vector2f additionalVelocity = Vector2f::ZERO;
-	additionalVelocity = ReadXMLAttribute( singleSpawnNode, "velocity", additionalVelocity );
+	const Vector2f& additionalVelocity = singleSpawn.m_additionalVelocity;
 	if ( additionalVelocity != Vector2f::ZERO )
 	{
 		LinearDynamicsState* lds = spawnedEntities[ 0 ]->GetLinearDynamicsState();
@@ -116,67 +144,49 @@ SpawnPattern::~SpawnPattern()
 //--------------------------------------------------------------------------------------------------------------
 void SpawnPattern::Instantiate( const WorldCoords2D& offsetFromPatternOrigin, std::vector<GameEntity*>& outEntityList )
 {
+	size_t firstSpawnedIndex = outEntityList.size();
+	EntityPool::AcquireBatch( m_emittedEntities, m_numSpawns, outEntityList );
+
 	for ( int spawnIndex = 0; spawnIndex < m_numSpawns; spawnIndex++ )
 	{
-		GameEntity* clonedEntity = m_emittedEntities[ spawnIndex ]->GetClone(); //Note use of virtual overrides.
-		clonedEntity->SetPosition( offsetFromPatternOrigin + m_patternOrigin + m_spawnOffsets[ spawnIndex ] );
-		clonedEntity->Enable();
-		outEntityList.push_back( clonedEntity );
+		GameEntity* spawnedEntity = outEntityList[ firstSpawnedIndex + spawnIndex ];
+		spawnedEntity->SetPosition( offsetFromPatternOrigin + m_patternOrigin + m_spawnOffsets[ spawnIndex ] );
+		spawnedEntity->Enable();
 	}
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
-STATIC SpawnPattern* SpawnPattern::CreateFromXMLNode( const XMLNode& patternNode )
+STATIC SpawnPattern* SpawnPattern::CreateFromDefinition( const PatternDefinition& definition )
 {
-	std::string patternName;
-	patternName = ReadXMLAttribute( patternNode, "name", patternName );
-
-	WorldCoords2D patternOrigin = WorldCoords2D::ZERO;
-	patternOrigin = ReadXMLAttribute( patternNode, "origin", patternOrigin );
-
-	int numSpawns = patternNode.nChildNode( "Spawn" );
-	int numSpawnsMinusDelayedBullets = numSpawns;
-	for ( int spawnIndex = 0; spawnIndex < numSpawns; spawnIndex++ )
+	int numSpawnsMinusDelayedBullets = 0;
+	for ( const SpawnDefinition& spawn : definition.m_spawns )
 	{
-		XMLNode spawnNode = patternNode.getChildNode( "Spawn", spawnIndex );
-		if ( spawnNode.isAttributeSet( "spawnDelay" ) )
-		{
-			--numSpawnsMinusDelayedBullets;
-			continue; //Already handled in Enemy's CreateFromXMLNode as a separate pattern.
-		}
+		if ( !spawn.m_hasSpawnDelay )
+			++numSpawnsMinusDelayedBullets; //Delayed ones are already handled in Enemy's PopulateFromXMLStream as separate patterns.
 	}
 
 	WorldCoords2D* spawnOffsets = new WorldCoords2D[ numSpawnsMinusDelayedBullets ];
 	GameEntity** spawnedEntities = new GameEntity*[ numSpawnsMinusDelayedBullets ];
 
-	int numDelayedBulletsSkipped = 0;
-	for ( int spawnIndex = 0; spawnIndex < numSpawns; spawnIndex++ )
+	int tightlyPackedIndex = 0;
+	for ( const SpawnDefinition& spawn : definition.m_spawns )
 	{
-		int tightlyPackedIndex = spawnIndex - numDelayedBulletsSkipped;
+		if ( spawn.m_hasSpawnDelay )
+			continue;
 
-		XMLNode spawnNode = patternNode.getChildNode( "Spawn", spawnIndex );
-		if ( spawnNode.isAttributeSet( "spawnDelay" ) )
-		{
-			++numDelayedBulletsSkipped;
-			continue; //Already handled in Enemy's CreateFromXMLNode as a separate pattern.
-		}
-
-		spawnOffsets[ tightlyPackedIndex ] = ReadXMLAttribute( spawnNode, "offset", WorldCoords2D::ZERO );
+		spawnOffsets[ tightlyPackedIndex ] = spawn.m_offset;
+		spawnedEntities[ tightlyPackedIndex ] = nullptr;
 
-		std::string entityFactoryName;
-		if ( spawnNode.isAttributeSet( "enemy" ) )
+		if ( spawn.m_spawnsEnemy )
 		{
-			entityFactoryName = ReadXMLAttribute( spawnNode, "enemy", entityFactoryName );
-			spawnedEntities[ tightlyPackedIndex ] = EnemyFactory::CreateEnemyFromName( entityFactoryName );
+			spawnedEntities[ tightlyPackedIndex ] = EnemyFactory::CreateEnemyFromName( spawn.m_enemyName );
 		}
-		else if ( spawnNode.isAttributeSet( "bullet" ) )
+		else if ( spawn.m_spawnsBullet )
 		{
-			entityFactoryName = ReadXMLAttribute( spawnNode, "bullet", entityFactoryName );
-			spawnedEntities[ tightlyPackedIndex ] = BulletFactory::CreateBulletFromName( entityFactoryName );
+			spawnedEntities[ tightlyPackedIndex ] = BulletFactory::CreateBulletFromName( spawn.m_bulletName );
 
-			Vector2f additionalVelocity = Vector2f::ZERO;
-			additionalVelocity = ReadXMLAttribute( spawnNode, "velocity", additionalVelocity );
+			const Vector2f& additionalVelocity = spawn.m_additionalVelocity;
 			if ( additionalVelocity != Vector2f::ZERO )
 			{
 				LinearDynamicsState* lds = spawnedEntities[ tightlyPackedIndex ]->GetLinearDynamicsState();
@@ -184,7 +194,9 @@ STATIC SpawnPattern* SpawnPattern::CreateFromXMLNode( const XMLNode& patternNode
 			}
 		}
 		else ERROR_RECOVERABLE( "Failed to find anything to spawn!" );
+
+		++tightlyPackedIndex;
 	}
 
-	return new SpawnPattern( patternName, spawnOffsets, spawnedEntities, numSpawnsMinusDelayedBullets, patternOrigin );
-}
+	return new SpawnPattern( definition.m_name, spawnOffsets, spawnedEntities, numSpawnsMinusDelayedBullets, definition.m_origin );
+}
\ No newline at end of file
@@ -2,7 +2,6 @@
 
 
 #include "Engine/Memory/UntrackedAllocator.hpp"
-#include "Engine/FileUtils/XMLUtils.hpp"
 #include "Game/GameCommon.hpp"
 #include <map>
 
@@ -10,19 +9,49 @@
 //-----------------------------------------------------------------------------
 class SpawnPattern;
 class GameEntity;
+class XMLStreamReader;
 typedef std::string PatternID;
 typedef std::pair< PatternID, SpawnPattern* > PatternRegistryPair;
 typedef std::map< PatternID, SpawnPattern*, std::less<PatternID>, UntrackedAllocator<PatternRegistryPair> > PatternRegistryMap;
 
 
+//-----------------------------------------------------------------------------
+struct SpawnDefinition //One <Spawn> of a <Pattern>.
+{
+	WorldCoords2D m_offset;
+	Vector2f m_additionalVelocity;
+	bool m_spawnsEnemy; //Checked first, as enemy="" still counts.
+	bool m_spawnsBullet;
+	std::string m_enemyName;
+	std::string m_bulletName;
+	bool m_hasSpawnDelay; //Enemy breaks these out into their own one-bullet patterns.
+	float m_spawnDelaySeconds;
+	int m_childIndex; //Among the pattern's child elements, for naming the one-bullet patterns.
+};
+
+
+//-----------------------------------------------------------------------------
+//What a <Pattern> element says, read off an XMLStreamReader before the definition files are closed,
+//so SpawnPattern and Enemy can build from it without a DOM.
+struct PatternDefinition
+{
+	void ReadFromXMLStream( XMLStreamReader& reader ); //Call on the Pattern's START_ELEMENT, consumes its children.
+
+	PatternID m_name;
+	WorldCoords2D m_origin;
+	float m_whenToSpawnSeconds; //Only read by Enemy.
+	std::vector< SpawnDefinition > m_spawns;
+};
+
+
 //-----------------------------------------------------------------------------
 class SpawnPattern
 {
 public:
-	static SpawnPattern* CreateOrGetPattern( const PatternID& patternName, const XMLNode& patternNode = XMLNode::emptyNode() );
-	static SpawnPattern* CreateOneBulletPattern( const PatternID& patternName, const WorldCoords2D& patternOrigin, const XMLNode& singleSpawnNode );
+	static SpawnPattern* CreateOrGetPattern( const PatternID& patternName, const PatternDefinition* definition = nullptr ); //Placeholder if null.
+	static SpawnPattern* CreateOneBulletPattern( const PatternID& patternName, const WorldCoords2D& patternOrigin, const SpawnDefinition& singleSpawn );
 	static void CleanupRegistry();
-	static SpawnPattern* CreateFromXMLNode( const XMLNode& patternNode );
+	static SpawnPattern* CreateFromDefinition( const PatternDefinition& definition );
 
 	SpawnPattern( const PatternID& name, WorldCoords2D* positions, GameEntity** entities, int numSpawns, const WorldCoords2D& patternOrigin = WorldCoords2D::ZERO );
 	SpawnPattern( const SpawnPattern& other );
@@ -72,6 +72,7 @@ static const unsigned int LIGHTS_IN_SCENE_MAX = 2;
 typedef std::string TerrainID;
 static const WorldCoords2D PLAYER_START_POSITION = WorldCoords2D( 0.f, -5.f );
 static const WorldCoords2D TITLE_CARD_WORLD_POSITION = WorldCoords2D( 0.f, -2.5f );
+static const unsigned int BULLET_POOL_PREWARM_PER_FACTORY = 64; //EntityPool free list shares these across all bullet types.
 extern const int BULLET_DAMAGE_AMOUNT;
 extern const int MAX_AURAMETER;
 extern const int SCORE_FOR_KILLING_ENEMY;
@@ -0,0 +1,243 @@
+#include "Game/HeadlessBenchmark.hpp"
+
+#include <stdlib.h>
+#include "Engine/TheEngine.hpp"
+#include "Engine/Time/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Memory/Memory.hpp"
+#include "Engine/Core/Logger.hpp"
+#include "Engine/FileUtils/FileUtils.hpp"
+#include "Engine/String/StringUtils.hpp"
+#include "Engine/Renderer/SpriteRenderer.hpp"
+#include "Engine/Tools/Profiling/Profiler.hpp"
+
+#include "Game/TheGame.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+STATIC const double HeadlessBenchmark::MIN_BASELINE_SECTION_MS = .05;
+
+
+//--------------------------------------------------------------------------------------------------------------
+static bool FindReportNumber( const std::string& reportJSON, const std::string& quotedKey, size_t searchFrom, double& out_value )
+{
+	//Only reads back what WriteReport writes, so no general JSON parsing: find "key": and read the number after it.
+	size_t keyPos = reportJSON.find( quotedKey + ":", searchFrom );
+	if ( keyPos == std::string::npos )
+		return false;
+
+	out_value = atof( reportJSON.c_str() + keyPos + quotedKey.size() + 1 );
+	return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+HeadlessBenchmark::HeadlessBenchmark( int numWavesToSimulate, float fixedDeltaSeconds, int maxFramesToSimulate )
+	: m_numWavesToSimulate( numWavesToSimulate )
+	, m_fixedDeltaSeconds( fixedDeltaSeconds )
+	, m_maxFramesToSimulate( maxFramesToSimulate )
+	, m_numFramesSimulated( 0 )
+	, m_numRetries( 0 )
+	, m_wallSeconds( 0.0 )
+	, m_peakNumEntities( 0 )
+	, m_peakNumParticles( 0 )
+	, m_numAllocationsDuringFrames( 0 )
+	, m_maxAllocationsInOneFrame( 0 )
+	, m_liveAllocationsAtStart( 0 )
+	, m_liveAllocationsAtEnd( 0 )
+	, m_bytesHighwaterMark( 0 )
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void HeadlessBenchmark::Run()
+{
+	Profiler* profiler = Profiler::Instance();
+	profiler->SetProfilerPaused( false ); //Takes effect on the next StartFrame.
+
+	g_theGame->BeginGameplay();
+
+	m_liveAllocationsAtStart = MemoryAnalytics::GetCurrentNumAllocations();
+	double startSeconds = GetCurrentTimeSeconds();
+
+	while ( g_theGame->GetNumWavesSpawned() < m_numWavesToSimulate && m_numFramesSimulated < m_maxFramesToSimulate )
+	{
+		profiler->StartFrame(); //Closes out the previous frame's tree, so GetLastFrame() below is complete.
+		RecordLastProfilerFrame();
+
+		unsigned int allocationsBeforeFrame = MemoryAnalytics::GetLifetimeNumAllocationCalls();
+		g_theEngine->StepFrame( m_fixedDeltaSeconds );
+		unsigned int allocationsThisFrame = MemoryAnalytics::GetLifetimeNumAllocationCalls() - allocationsBeforeFrame;
+
+		m_numAllocationsDuringFrames += allocationsThisFrame;
+		m_maxAllocationsInOneFrame = GetMax( m_maxAllocationsInOneFrame, allocationsThisFrame );
+		m_peakNumEntities = GetMax( m_peakNumEntities, (unsigned int)g_theGame->GetNumEntities() );
+		m_peakNumParticles = GetMax( m_peakNumParticles, SpriteRenderer::GetNumLiveParticles() );
+
+		if ( GetGameState() == GAME_STATE_GAMEOVER )
+		{
+			g_theGame->RetryGameplay();
+			++m_numRetries;
+		}
+
+		++m_numFramesSimulated;
+	}
+
+	profiler->StartFrame(); //Flush the final frame.
+	RecordLastProfilerFrame();
+
+	m_wallSeconds = GetCurrentTimeSeconds() - startSeconds;
+	m_liveAllocationsAtEnd = MemoryAnalytics::GetCurrentNumAllocations();
+	m_bytesHighwaterMark = MemoryAnalytics::GetCurrentHighwaterMark();
+
+	Logger::PrintfWithTag( "Benchmark", "Simulated %d frames (%d waves, %d retries) in %.3fs.",
+		m_numFramesSimulated, g_theGame->GetNumWavesSpawned(), m_numRetries, m_wallSeconds );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void HeadlessBenchmark::AccumulateSampleTimes( ProfilerSample* sample, std::map< std::string, double >& out_frameSeconds, std::map< std::string, int >& out_frameCalls ) const
+{
+	if ( sample == nullptr )
+		return;
+
+	out_frameSeconds[ sample->tag ] += PerformanceCountToSeconds( sample->elapsedPerfCount );
+	out_frameCalls[ sample->tag ] += 1;
+
+	//Children are an in-place circular list, same walk as Profiler::CreateOrUpdateRecordForSample.
+	for ( ProfilerSample* childIter = sample->children; childIter != nullptr; childIter = ( childIter->next == sample->children ) ? nullptr : childIter->next )
+		AccumulateSampleTimes( childIter, out_frameSeconds, out_frameCalls );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+void HeadlessBenchmark::RecordLastProfilerFrame()
+{
+	ProfilerSample* frameRoot = Profiler::Instance()->GetLastFrame();
+	if ( frameRoot == nullptr )
+		return;
+
+	std::map< std::string, double > frameSeconds;
+	std::map< std::string, int > frameCalls;
+	AccumulateSampleTimes( frameRoot, frameSeconds, frameCalls );
+
+	for ( const std::pair< const std::string, double >& tagTime : frameSeconds )
+	{
+		BenchmarkSectionStats& stats = m_sections[ tagTime.first ];
+		stats.totalSeconds += tagTime.second;
+		stats.maxFrameSeconds = GetMax( stats.maxFrameSeconds, tagTime.second );
+		stats.numCalls += frameCalls[ tagTime.first ];
+		++stats.numFramesPresent;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool HeadlessBenchmark::WriteReport( const char* reportFilePath ) const
+{
+	std::string json = "{\n";
+
+	json += Stringf( "\t\"numWavesRequested\": %d,\n", m_numWavesToSimulate );
+	json += Stringf( "\t\"numWavesSpawned\": %d,\n", g_theGame->GetNumWavesSpawned() );
+	json += Stringf( "\t\"fixedDeltaSeconds\": %f,\n", m_fixedDeltaSeconds );
+	json += Stringf( "\t\"numFrames\": %d,\n", m_numFramesSimulated );
+	json += Stringf( "\t\"hitFrameLimit\": %s,\n", DidHitFrameLimit() ? "true" : "false" );
+	json += Stringf( "\t\"numRetries\": %d,\n", m_numRetries );
+	json += Stringf( "\t\"wallSeconds\": %f,\n", m_wallSeconds );
+	json += Stringf( "\t\"peakEntities\": %u,\n", m_peakNumEntities );
+	json += Stringf( "\t\"peakParticles\": %u,\n", m_peakNumParticles );
+
+	json += "\t\"memory\": {\n";
+	json += Stringf( "\t\t\"allocationsDuringFrames\": %u,\n", m_numAllocationsDuringFrames );
+	json += Stringf( "\t\t\"allocationsPerFrame\": %f,\n", ( m_numFramesSimulated > 0 ) ? (double)m_numAllocationsDuringFrames / m_numFramesSimulated : 0.0 );
+	json += Stringf( "\t\t\"maxAllocationsInOneFrame\": %u,\n", m_maxAllocationsInOneFrame );
+	json += Stringf( "\t\t\"liveAllocationsAtStart\": %u,\n", m_liveAllocationsAtStart );
+	json += Stringf( "\t\t\"liveAllocationsAtEnd\": %u,\n", m_liveAllocationsAtEnd );
+	json += Stringf( "\t\t\"bytesHighwaterMark\": %u\n", m_bytesHighwaterMark );
+	json += "\t},\n";
+
+	json += "\t\"sections\": {";
+	bool isFirstSection = true;
+	for ( const std::pair< const std::string, BenchmarkSectionStats >& section : m_sections )
+	{
+		const BenchmarkSectionStats& stats = section.second;
+		json += ( isFirstSection ? "\n" : ",\n" );
+		json += Stringf( "\t\t\"%s\": { \"avgMs\": %f, \"maxMs\": %f, \"totalMs\": %f, \"calls\": %d, \"frames\": %d }",
+			section.first.c_str(),
+			( stats.numFramesPresent > 0 ) ? 1000.0 * stats.totalSeconds / stats.numFramesPresent : 0.0,
+			1000.0 * stats.maxFrameSeconds,
+			1000.0 * stats.totalSeconds,
+			stats.numCalls,
+			stats.numFramesPresent );
+		isFirstSection = false;
+	}
+	json += "\n\t}\n}\n";
+
+	std::vector< unsigned char > buffer( json.begin(), json.end() );
+	bool didSave = SaveBufferToBinaryFile( reportFilePath, buffer );
+	if ( !didSave )
+		Logger::PrintfWithTag( "Benchmark", "Failed to write report to %s!", reportFilePath );
+
+	return didSave;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool HeadlessBenchmark::CheckRegression( const char* metricName, double baselineValue, double currentValue, double maxRegressionRatio ) const
+{
+	if ( currentValue <= baselineValue * maxRegressionRatio )
+		return true;
+
+	Logger::PrintfWithTag( "Benchmark", "REGRESSION: %s is %f, baseline %f (over %.2fx).", metricName, currentValue, baselineValue, maxRegressionRatio );
+	return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool HeadlessBenchmark::CompareToBaseline( const char* baselineReportFilePath, double maxRegressionRatio ) const
+{
+	std::vector< unsigned char > buffer;
+	if ( !LoadBinaryFileIntoBuffer( baselineReportFilePath, buffer ) )
+	{
+		Logger::PrintfWithTag( "Benchmark", "Failed to read baseline report %s!", baselineReportFilePath );
+		return false;
+	}
+	std::string baselineJSON( buffer.begin(), buffer.end() );
+
+	double baselineNumFrames = 0.0;
+	double baselineWallSeconds = 0.0;
+	double baselineAllocationsPerFrame = 0.0;
+	if ( !FindReportNumber( baselineJSON, "\"numFrames\"", 0, baselineNumFrames ) || ( baselineNumFrames <= 0.0 )
+		|| !FindReportNumber( baselineJSON, "\"wallSeconds\"", 0, baselineWallSeconds )
+		|| !FindReportNumber( baselineJSON, "\"allocationsPerFrame\"", 0, baselineAllocationsPerFrame ) )
+	{
+		Logger::PrintfWithTag( "Benchmark", "Baseline report %s is missing frame, time or allocation counts!", baselineReportFilePath );
+		return false;
+	}
+
+	//Per frame, so a baseline from a different wave count or frame limit still compares.
+	bool passed = true;
+	double wallMsPerFrame = ( m_numFramesSimulated > 0 ) ? 1000.0 * m_wallSeconds / m_numFramesSimulated : 0.0;
+	double allocationsPerFrame = ( m_numFramesSimulated > 0 ) ? (double)m_numAllocationsDuringFrames / m_numFramesSimulated : 0.0;
+	passed &= CheckRegression( "wallMsPerFrame", 1000.0 * baselineWallSeconds / baselineNumFrames, wallMsPerFrame, maxRegressionRatio );
+	passed &= CheckRegression( "allocationsPerFrame", baselineAllocationsPerFrame, allocationsPerFrame, maxRegressionRatio );
+
+	size_t sectionsPos = baselineJSON.find( "\"sections\"" );
+	for ( const std::pair< const std::string, BenchmarkSectionStats >& section : m_sections )
+	{
+		double baselineAvgMs = 0.0;
+		size_t sectionPos = baselineJSON.find( "\"" + section.first + "\":", sectionsPos );
+		if ( ( sectionsPos == std::string::npos ) || ( sectionPos == std::string::npos ) )
+			continue; //New since the baseline, nothing to regress from.
+		if ( !FindReportNumber( baselineJSON, "\"avgMs\"", sectionPos, baselineAvgMs ) || ( baselineAvgMs < MIN_BASELINE_SECTION_MS ) )
+			continue;
+
+		const BenchmarkSectionStats& stats = section.second;
+		double avgMs = ( stats.numFramesPresent > 0 ) ? 1000.0 * stats.totalSeconds / stats.numFramesPresent : 0.0;
+		passed &= CheckRegression( Stringf( "sections.%s.avgMs", section.first.c_str() ).c_str(), baselineAvgMs, avgMs, maxRegressionRatio );
+	}
+
+	Logger::PrintfWithTag( "Benchmark", "%s against baseline %s at %.2fx.", passed ? "Passed" : "Failed", baselineReportFilePath, maxRegressionRatio );
+	return passed;
+}
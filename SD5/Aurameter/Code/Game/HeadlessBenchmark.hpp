@@ -0,0 +1,65 @@
+#pragma once
+
+
+#include "Game/GameCommon.hpp"
+#include <map>
+
+
+//-----------------------------------------------------------------------------
+struct ProfilerSample;
+
+
+//-----------------------------------------------------------------------------
+struct BenchmarkSectionStats
+{
+	BenchmarkSectionStats() : totalSeconds( 0.0 ), maxFrameSeconds( 0.0 ), numCalls( 0 ), numFramesPresent( 0 ) {}
+
+	double totalSeconds;
+	double maxFrameSeconds; //Worst single frame, summing every call with this tag in that frame.
+	int numCalls;
+	int numFramesPresent;
+};
+typedef std::map< std::string, BenchmarkSectionStats > BenchmarkSectionMap;
+
+
+//-----------------------------------------------------------------------------
+//Drives TheGame through N waves at a fixed dt with no window, GL context, fmod or input (see Headless configuration).
+//Assumes TheEngine::Startup has already run, and writes a JSON report for CI to diff against a baseline.
+class HeadlessBenchmark
+{
+public:
+	HeadlessBenchmark( int numWavesToSimulate, float fixedDeltaSeconds, int maxFramesToSimulate );
+	void Run();
+	bool WriteReport( const char* reportFilePath ) const;
+	bool DidHitFrameLimit() const { return m_numFramesSimulated >= m_maxFramesToSimulate; } //Waves stalled, so the numbers don't cover what was asked for.
+
+	//False if a per-frame cost is more than maxRegressionRatio times the baseline report's, logging each one that is.
+	//Compares wall time and allocations per frame, and average ms of sections the baseline spent at least MIN_BASELINE_SECTION_MS on.
+	bool CompareToBaseline( const char* baselineReportFilePath, double maxRegressionRatio ) const;
+
+private:
+	static const double MIN_BASELINE_SECTION_MS; //Below this, timer noise swamps any regression.
+
+	void RecordLastProfilerFrame();
+	bool CheckRegression( const char* metricName, double baselineValue, double currentValue, double maxRegressionRatio ) const;
+	void AccumulateSampleTimes( ProfilerSample* sample, std::map< std::string, double >& out_frameSeconds, std::map< std::string, int >& out_frameCalls ) const;
+
+	const int m_numWavesToSimulate;
+	const float m_fixedDeltaSeconds;
+	const int m_maxFramesToSimulate;
+
+	int m_numFramesSimulated;
+	int m_numRetries; //Null input means nobody dodges, so the player can die and we restart.
+	double m_wallSeconds;
+
+	unsigned int m_peakNumEntities;
+	unsigned int m_peakNumParticles;
+
+	unsigned int m_numAllocationsDuringFrames; //Excludes the benchmark's own bookkeeping between frames.
+	unsigned int m_maxAllocationsInOneFrame;
+	unsigned int m_liveAllocationsAtStart;
+	unsigned int m_liveAllocationsAtEnd;
+	unsigned int m_bytesHighwaterMark;
+
+	BenchmarkSectionMap m_sections;
+};
@@ -0,0 +1,67 @@
+#include <stdlib.h>
+
+#include "Engine/Memory/Memory.hpp"
+#include "Engine/Core/Logger.hpp"
+#include "Engine/Tools/Profiling/Profiler.hpp"
+#include "Engine/Concurrency/JobUtils.hpp"
+
+#include "Game/HeadlessBenchmark.hpp"
+#include "Engine/TheEngine.hpp"
+
+
+//--------------------------------------------------------------------------------------------------------------
+//Only built by the Headless configuration, in place of Main_Win32.cpp and TheApp.cpp.
+//Usage (run from Run_Win32 so Data/ resolves): Aurameter.exe [numWaves] [fixedDeltaSeconds] [reportPath] [maxFrames] [baselineReportPath] [maxRegressionRatio]
+//Exits nonzero if the report couldn't be written, the frame limit was hit, or with a baseline given, any per-frame cost regressed past the ratio.
+static const int DEFAULT_NUM_WAVES = 10;
+static const float DEFAULT_FIXED_DELTA_SECONDS = 1.f / 60.f;
+static const char* DEFAULT_REPORT_PATH = "BenchmarkReport.json";
+static const int DEFAULT_MAX_FRAMES = 60 * 60 * 10; //Ten simulated minutes at 60Hz, in case waves stall.
+static const double DEFAULT_MAX_REGRESSION_RATIO = 1.1;
+static const int EXIT_CODE_PASSED = 0;
+static const int EXIT_CODE_REPORT_NOT_WRITTEN = 1;
+static const int EXIT_CODE_HIT_FRAME_LIMIT = 2;
+static const int EXIT_CODE_REGRESSED = 3;
+static const double BENCHMARK_SCREEN_WIDTH = 1600.0; //Matches TheApp's window, for camera and FBO sizes.
+static const double BENCHMARK_SCREEN_HEIGHT = 900.0;
+
+
+//--------------------------------------------------------------------------------------------------------------
+int main( int argc, char* argv[] )
+{
+	int numWaves = ( argc > 1 ) ? atoi( argv[ 1 ] ) : DEFAULT_NUM_WAVES;
+	float fixedDeltaSeconds = ( argc > 2 ) ? (float)atof( argv[ 2 ] ) : DEFAULT_FIXED_DELTA_SECONDS;
+	const char* reportPath = ( argc > 3 ) ? argv[ 3 ] : DEFAULT_REPORT_PATH;
+	int maxFrames = ( argc > 4 ) ? atoi( argv[ 4 ] ) : DEFAULT_MAX_FRAMES;
+	const char* baselineReportPath = ( argc > 5 ) ? argv[ 5 ] : nullptr;
+	double maxRegressionRatio = ( argc > 6 ) ? atof( argv[ 6 ] ) : DEFAULT_MAX_REGRESSION_RATIO;
+
+	Logger::Startup();
+	MemoryAnalytics::Startup();
+	Profiler::Instance()->Startup();
+	JobSystem::Instance()->Startup( -2, -3 ); //Same worker counts as Main_Win32, so job timings stay comparable.
+
+	g_theEngine = new TheEngine();
+	g_theEngine->Startup( BENCHMARK_SCREEN_WIDTH, BENCHMARK_SCREEN_HEIGHT );
+
+	HeadlessBenchmark benchmark( numWaves, fixedDeltaSeconds, maxFrames );
+	benchmark.Run();
+	int exitCode = EXIT_CODE_PASSED;
+	if ( !benchmark.WriteReport( reportPath ) )
+		exitCode = EXIT_CODE_REPORT_NOT_WRITTEN;
+	else if ( benchmark.DidHitFrameLimit() )
+		exitCode = EXIT_CODE_HIT_FRAME_LIMIT;
+	else if ( ( baselineReportPath != nullptr ) && !benchmark.CompareToBaseline( baselineReportPath, maxRegressionRatio ) )
+		exitCode = EXIT_CODE_REGRESSED;
+
+	g_theEngine->Shutdown();
+	delete g_theEngine;
+	g_theEngine = nullptr;
+
+	JobSystem::Instance()->Shutdown();
+	Profiler::Instance()->Shutdown();
+	MemoryAnalytics::Shutdown();
+	Logger::Shutdown();
+
+	return exitCode;
+}
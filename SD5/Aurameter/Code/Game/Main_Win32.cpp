@@ -19,7 +19,7 @@ int WINAPI WinMain( HINSTANCE applicationInstanceHandle, HINSTANCE, LPSTR comman
 	Logger::Startup();
 	MemoryAnalytics::Startup();
 	Profiler::Instance()->Startup();
-	JobSystem::Instance()->Startup( -4 ); //As many as I need, minus 4.
+	JobSystem::Instance()->Startup( -2, -3 ); //All cores but the main thread's and one spare. All but one of those decode at startup, then take gameplay jobs too.
 
 	g_theApp = new TheApp();
 
@@ -12,6 +12,7 @@
 #include "Engine/Renderer/Sprite.hpp"
 #include "Engine/Renderer/SpriteResource.hpp"
 #include "Engine/Renderer/SpriteRenderer.hpp"
+#include "Engine/Renderer/AsyncTextureLoader.hpp"
 #include "Engine/Renderer/FramebufferEffect.hpp"
 
 #include "Game/GameCommon.hpp"
@@ -23,6 +24,7 @@
 #include "Game/Factories/Pattern.hpp"
 #include "Game/Factories/EnemyFactory.hpp"
 #include "Game/Factories/BulletFactory.hpp"
+#include "Game/Factories/EntityPool.hpp"
 #include "Game/World.hpp"
 
 #include "Engine/Renderer/Material.hpp"
@@ -35,6 +37,9 @@
 #include "Engine/Renderer/Particles/ParticleEmitterDefinition.hpp"
 
 #include "Engine/Concurrency/JobUtils.hpp"
+#include "Engine/Tools/Profiling/Profiler.hpp"
+#include "Engine/FileUtils/CookedXML.hpp"
+#include "Engine/Time/Time.hpp"
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -45,6 +50,7 @@ TheGame* g_theGame = nullptr;
 TheGame::TheGame()
 	: m_currentArena( -1 )
 	, m_numWaveEnemiesLeft( 0 )
+	, m_numWavesSpawned( 0 )
 	, m_fadeoutTimer( 0.f )
 	, m_FADEOUT_LENGTH_SECONDS( 15.f )
 	, m_delayBetweenWaves( SECONDS_BETWEEN_WAVES, "OnWaveTransitionEnd" )
@@ -69,16 +75,31 @@ static void RegisterConsoleCommands()
 	g_theConsole->RegisterCommand( "ToggleActiveCameraMode", TheGame::ToggleActiveCameraMode );
 	g_theConsole->RegisterCommand( "TogglePolarTranslations2D", TheGame::ToggleActiveCamType2D );
 	g_theConsole->RegisterCommand( "TogglePolarTranslations3D", TheGame::ToggleActiveCamType3D );
+	g_theConsole->RegisterCommand( "EntityPoolStats", EntityPool::PrintStats );
 }
 
 
 //--------------------------------------------------------------------------------------------------------------
 void TheGame::LoadAllXML()
 {
+	//Logged so a cooked launch can be compared against the one that cooked it.
+	CookedXMLStats cookedStatsBefore = GetCookedXMLStats();
+	double startSeconds = GetCurrentTimeSeconds();
+
 	//XML.
 	BulletFactory::LoadAllFactories();
 	EnemyFactory::LoadAllFactories(); //Depends on Bullets being loaded.
+	double loadSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	BulletFactory::PrewarmPool( BULLET_POOL_PREWARM_PER_FACTORY ); //Not XML, so left out of the timing.
+
+	startSeconds = GetCurrentTimeSeconds();
 	World::LoadAllArenas(); //Depends on Enemies being loaded.
+	loadSeconds += GetCurrentTimeSeconds() - startSeconds;
+
+	const CookedXMLStats& cookedStats = GetCookedXMLStats();
+	Logger::PrintfWithTag( "CookedXML", "Loaded definition XML in %.3fms: %u files replayed cooked, %u parsed and recooked.", loadSeconds * 1000.0,
+		cookedStats.numCacheHits - cookedStatsBefore.numCacheHits, cookedStats.numCacheMisses - cookedStatsBefore.numCacheMisses );
 }
 
 
@@ -111,6 +132,7 @@ void TheGame::Shutdown()
 	EnemyFactory::CleanupFactories();
 	BulletFactory::CleanupFactories();
 	World::CleanupRegistry();
+	EntityPool::CleanupPools(); //Before SpriteRenderer, since sprites unregister on delete.
 	SpriteRenderer::Shutdown();
 }
 
@@ -160,16 +182,29 @@ bool TheGame::UpdateMainMenu()
 	bool didUpdate = false;
 
 	if ( g_theInput->WasKeyPressedOnce( KEY_TO_BEGIN_GAME ) || g_theInput->WasButtonPressedOnce( BUTTON_TO_BEGIN_GAME, Controllers::CONTROLLER_ONE ) )
-	{
-		m_fadeoutTimer = m_FADEOUT_LENGTH_SECONDS;
-		didUpdate = SetGameState( GAME_STATE_SETUP_GAMEPLAY );
-	}
+		didUpdate = BeginGameplay();
 	TODO( "Exit is Escape key for now. What about controller? Need to figure out the isQuitting situation from code review." );
 
 	return didUpdate;
 }
 
 
+//--------------------------------------------------------------------------------------------------------------
+bool TheGame::BeginGameplay()
+{
+	m_fadeoutTimer = m_FADEOUT_LENGTH_SECONDS;
+	return SetGameState( GAME_STATE_SETUP_GAMEPLAY );
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+bool TheGame::RetryGameplay()
+{
+	DestroyGameplayEntities();
+	return SetGameState( GAME_STATE_SETUP_GAMEPLAY );
+}
+
+
 //--------------------------------------------------------------------------------------------------------------
 bool TheGame::UpdatePlaying( float deltaSeconds )
 {
@@ -228,10 +263,7 @@ bool TheGame::UpdateGameOver( float deltaSeconds )
 		didUpdate = SetGameState( GAME_STATE_CLEANUP_GAMEPLAY );
 	}
 	if ( g_theInput->WasKeyPressedOnce( KEY_TO_RETRY_GAME ) || g_theInput->WasButtonPressedOnce( BUTTON_TO_RETRY_GAME, Controllers::CONTROLLER_ONE ) )
-	{
-		DestroyGameplayEntities();
-		didUpdate = SetGameState( GAME_STATE_SETUP_GAMEPLAY );
-	}
+		didUpdate = RetryGameplay();
 
 	UNREFERENCED( deltaSeconds );
 	return didUpdate;
@@ -242,7 +274,7 @@ bool TheGame::UpdateGameOver( float deltaSeconds )
 void TheGame::DestroyGameplayEntities()
 {
 	for ( GameEntity* g : m_entities )
-		delete g;
+		EntityPool::Release( g );
 	m_entities.clear();
 
 	for ( World* w : m_arenaCycle )
@@ -259,6 +291,9 @@ void TheGame::DestroyGameplayEntities()
 //--------------------------------------------------------------------------------------------------------------
 void TheGame::UpdateSetupGameplay()
 {
+	//Collision uses sprite bounds, which come from real texel sizes, so no placeholders once play starts. Usually already done by now.
+	AsyncTextureLoader::FinishAllPending();
+
 	//Clone off a copy of the world registry in the same sequence.
 	World::CloneRegistry( m_arenaCycle );
 
@@ -293,10 +328,15 @@ bool TheGame::UpdatePlayingEntities( float deltaSeconds )
 {
 	bool didUpdate = true;
 
+	ProfilerSample* sample = Profiler::Instance()->StartSample( "TheGame::UpdatePlayingEntities" );
+
 	UpdatePlayer( deltaSeconds );
 
+	ProfilerSample* jobsSample = Profiler::Instance()->StartSample( "TheGame::UpdateEntityJobs" );
 	UpdatePlayingEntities_JobApproach( m_entities, deltaSeconds ); //Update everything via job system before applying entity-type-specific logic.
+	Profiler::Instance()->EndSample( jobsSample );
 
+	ProfilerSample* collisionSample = Profiler::Instance()->StartSample( "TheGame::CollideAndCull" );
 	for ( std::vector<GameEntity*>::iterator entityIter = m_entities.begin(); entityIter != m_entities.end(); )
 	{
 		GameEntity* currentEntity = *entityIter;
@@ -314,11 +354,14 @@ bool TheGame::UpdatePlayingEntities( float deltaSeconds )
 				m_player->AddAurameterDelta( ENTITY_TYPE_ENEMY );
 				--m_numWaveEnemiesLeft;
 			}
-			delete currentEntity;
+			EntityPool::Release( currentEntity );
 			entityIter = m_entities.erase( entityIter );
 		}
 		else ++entityIter;
 	}
+	Profiler::Instance()->EndSample( collisionSample );
+
+	Profiler::Instance()->EndSample( sample );
 
 	return didUpdate;
 }
@@ -612,7 +655,11 @@ bool TheGame::SpawnNextWave( EngineEvent* )
 		currentArena->m_currentWave = 0; //For cycling around next time.
 		AdvanceWorld();
 	}
-	else m_numWaveEnemiesLeft = currentArena->SpawnNextWave( m_entities );
+	else
+	{
+		m_numWaveEnemiesLeft = currentArena->SpawnNextWave( m_entities );
+		++m_numWavesSpawned;
+	}
 
 	return false;
 }
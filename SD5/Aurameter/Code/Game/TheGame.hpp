@@ -79,6 +79,12 @@ public:
 	
 	TerrainID GetCurrentTerrain() const;
 
+	//Also driven directly by the headless benchmark, which has no input to press start/retry with.
+	bool BeginGameplay();
+	bool RetryGameplay();
+	size_t GetNumEntities() const { return m_entities.size(); }
+	int GetNumWavesSpawned() const { return m_numWavesSpawned; }
+
 private:
 
 	static CameraMode s_activeCameraMode;
@@ -123,6 +129,7 @@ private:
 	std::vector< World* > m_arenaCycle;
 	int m_currentArena;
 	int m_numWaveEnemiesLeft;
+	int m_numWavesSpawned; //Across all arenas and retries.
 
 	float m_fadeoutTimer;
 	const float m_FADEOUT_LENGTH_SECONDS;
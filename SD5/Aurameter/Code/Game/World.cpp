@@ -1,7 +1,7 @@
 #include "Game/World.hpp"
 
 #include "Engine/FileUtils/FileUtils.hpp"
-#include "Engine/FileUtils/XMLUtils.hpp"
+#include "Engine/FileUtils/XMLStreamReader.hpp"
 #include "Engine/Renderer/AnimatedSprite.hpp"
 #include "Engine/Renderer/Sprite.hpp"
 #include "Engine/Renderer/SpriteRenderer.hpp"
@@ -16,13 +16,12 @@ STATIC ArenaRegistryVector World::s_arenaTemplateRegistry;
 
 
 //--------------------------------------------------------------------------------------------------------------
-static void GetArenaNameFromXML( const char* xmlFilename, const XMLNode& arenaNode, std::string& out_name )
+static void GetArenaNameFromXML( const char* xmlFilename, const XMLStreamReader& arenaReader, std::string& out_name )
 {
 	char arenaName[ 80 ];
 	sscanf_s( xmlFilename, "Data/XML/Arenas/%[^.].Arena.xml", &arenaName, _countof( arenaName ) );
 
-	std::string nameInsideFile;
-	nameInsideFile = ReadXMLAttribute( arenaNode, "name", nameInsideFile );
+	std::string nameInsideFile = arenaReader.ReadAttribute( "name", std::string() );
 
 	if ( nameInsideFile != "" )
 		out_name = nameInsideFile;
@@ -36,18 +35,25 @@ STATIC void World::LoadAllArenas()
 {
 	//Note we may have more than one Arena in a file.
 	std::vector< std::string > m_arenaFiles = EnumerateFilesInDirectory( "Data/XML/Arenas", "*.Arena.xml" );
+	XMLStreamReader reader; //Reused across files so its buffer only grows.
 
 	for ( unsigned int arenaFileIndex = 0; arenaFileIndex < m_arenaFiles.size(); arenaFileIndex++ )
 	{
 		const char* xmlFilename = m_arenaFiles[ arenaFileIndex ].c_str();
-		XMLNode arenasRoot = XMLNode::openFileHelper( xmlFilename, "Arenas" );
+		if ( !reader.OpenFileCooked( xmlFilename ) || !reader.ReadToNextStartElement( "Arenas" ) )
+		{
+			ERROR_RECOVERABLE( Stringf( "Failed to find Arenas in %s!", xmlFilename ) );
+			continue;
+		}
 
-		for ( int arenaIndex = 0; arenaIndex < arenasRoot.nChildNode(); arenaIndex++ )
+		int rootDepth = reader.GetDepth();
+		while ( reader.ReadToNextChildElement( rootDepth ) )
 		{
-			XMLNode arenaNode = arenasRoot.getChildNode( arenaIndex );
+			std::string arenaName; //Before the ctor reads past the Arena's attributes.
+			GetArenaNameFromXML( xmlFilename, reader, arenaName );
 
-			World* newArenaTemplate = new World( arenaNode );
-			GetArenaNameFromXML( xmlFilename, arenaNode, newArenaTemplate->m_terrain );
+			World* newArenaTemplate = new World( reader );
+			newArenaTemplate->m_terrain = arenaName;
 			s_arenaTemplateRegistry.push_back( newArenaTemplate );
 		}
 	}
@@ -107,13 +113,10 @@ World::~World()
 
 
 //--------------------------------------------------------------------------------------------------------------
-void World::PopulateFromXMLNode( const XMLNode& arenaNode )
+void World::PopulateFromXMLStream( XMLStreamReader& arenaReader )
 {
-	std::string backgroundResourceName;
-	backgroundResourceName = ReadXMLAttribute( arenaNode, "background", backgroundResourceName );
-
-	std::string titleCardResourceName;
-	titleCardResourceName = ReadXMLAttribute( arenaNode, "titleCard", titleCardResourceName );
+	std::string backgroundResourceName = arenaReader.ReadAttribute( "background", std::string() );
+	std::string titleCardResourceName = arenaReader.ReadAttribute( "titleCard", std::string() );
 
 	//Replace by an XML load-in like the above if we get to per-world transitions in polish!
 	m_transition = AnimatedSprite::Create( "WorldTransition", WorldCoords2D::ZERO );
@@ -126,18 +129,19 @@ void World::PopulateFromXMLNode( const XMLNode& arenaNode )
 	m_titleCard->SetLayerID( TITLE_CARD_LAYER_ID, "Title Card" );
 	SpriteRenderer::SetLayerVirtualSize( TITLE_CARD_LAYER_ID, 5 );
 
-	int numWaves = arenaNode.nChildNode( "Pattern" );
-	m_waves.resize( numWaves );
-
-	for ( int waveIndex = 0; waveIndex < numWaves; waveIndex++ )
+	//Every wave is the first Pattern, as with Enemy's: the XMLNode loader this replaced called getChildNode( "Pattern" ) without an index.
+	PatternDefinition firstPattern;
+	int numWaves = 0;
+	int arenaDepth = arenaReader.GetDepth();
+	while ( arenaReader.ReadToNextChildElement( arenaDepth, "Pattern" ) )
 	{
-		XMLNode patternNode = arenaNode.getChildNode( "Pattern" );
-
-		std::string patternName;
-		patternName = ReadXMLAttribute( patternNode, "name", patternName );
-
-		m_waves[ waveIndex ] = SpawnPattern::CreateOrGetPattern( patternName, patternNode );
+		if ( numWaves++ == 0 )
+			firstPattern.ReadFromXMLStream( arenaReader );
 	}
+
+	m_waves.resize( numWaves );
+	for ( int waveIndex = 0; waveIndex < numWaves; waveIndex++ )
+		m_waves[ waveIndex ] = SpawnPattern::CreateOrGetPattern( firstPattern.m_name, &firstPattern );
 }
 
 
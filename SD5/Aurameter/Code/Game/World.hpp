@@ -12,7 +12,7 @@ class SpawnPattern;
 class GameEntity;
 class EngineEvent;
 struct World;
-struct XMLNode;
+class XMLStreamReader;
 
 
 //-----------------------------------------------------------------------------
@@ -29,9 +29,9 @@ public:
 
 
 public:
-	World( const XMLNode& arenaNode ) : m_currentWave( 0 ) { PopulateFromXMLNode( arenaNode ); }
+	World( XMLStreamReader& arenaReader ) : m_currentWave( 0 ) { PopulateFromXMLStream( arenaReader ); }
 	~World();
-	void PopulateFromXMLNode( const XMLNode& arenaNode );
+	void PopulateFromXMLStream( XMLStreamReader& arenaReader ); //Consumes the Arena element's Pattern children.
 	int SpawnNextWave( std::vector<GameEntity*>& outEntityList, const WorldCoords2D& offsetFromOrigin = WorldCoords2D::ZERO );
 	bool FinishTransition( EngineEvent* eventContext );
 	bool HideBackground( EngineEvent* eventContext );
@@ -0,0 +1,16 @@
+#version 410 core
+
+//A layer tint to tint the entire layer could be sent as a uniform, e.g. fade out the UI and game layers on pause.
+//Noted that layer effects would all be shaders.
+uniform sampler2D uTexDiffuse;
+
+in vec2 passthroughUV0;
+in vec4 passthroughTintColor;
+
+out vec4 outColor;
+
+void main()
+{
+	vec4 diffuseTexColor = texture( uTexDiffuse, passthroughUV0 );
+	outColor = diffuseTexColor * passthroughTintColor;
+}
\ No newline at end of file
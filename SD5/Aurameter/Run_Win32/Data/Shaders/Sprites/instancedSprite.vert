@@ -0,0 +1,30 @@
+#version 410 core
+
+uniform mat4 uProj;
+uniform mat4 uView; //As the default shader: instances are already in world space.
+
+in vec2 inCorner; //The unit quad, shared by every instance.
+
+in vec2 inInstancePosition;
+in vec2 inInstanceMinsFromPivot;
+in vec2 inInstanceSize;
+in float inInstanceRotation;
+in vec4 inInstanceTint;
+in vec4 inInstanceUVRect;
+
+out vec2 passthroughUV0;
+out vec4 passthroughTintColor;
+
+void main()
+{
+	//Sprite::GetTransformSRT's rotation turns about the x-axis, which for sprites at z = 0 only foreshortens y.
+	//Kept identical here so sprites look the same on either path.
+	vec2 fromPivot = inInstanceMinsFromPivot + ( inCorner * inInstanceSize );
+	fromPivot.y *= cos( radians( inInstanceRotation ) );
+
+	passthroughUV0 = mix( inInstanceUVRect.xy, inInstanceUVRect.zw, vec2( inCorner.x, 1.0 - inCorner.y ) ); //Same v flip as WriteSpriteQuad.
+	passthroughTintColor = inInstanceTint;
+
+	vec4 pos = vec4( inInstancePosition + fromPivot, 0, 1 );
+	gl_Position = pos * uView * uProj;
+}
\ No newline at end of file